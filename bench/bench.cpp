@@ -0,0 +1,943 @@
+/*
+ * bench.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Host benchmark and golden image check of the image processing kernels.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+/* Usage: pyrovision_bench [-n <iterations>] [-f <max frames>] [-g <golden file>] [-u] [-t <percent>]
+ *                         [<segment.PRV> ...]
+ *
+ * Runs the pixel kernels of the firmware on the frames of SD card recordings or, without a recording, on a
+ * synthetic scene. Every kernel is checked against the CRC32 of its output in the golden file and its best time
+ * per frame is printed. -u writes a new golden file, -t also fails when a kernel is more than <percent> slower than
+ * the time in the golden file (only meaningful on the machine the file was written on).
+ */
+
+#include <esp_err.h>
+#include <esp_timer.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Application/Tasks/Lepton/paletteLUT.h"
+#include "Application/Tasks/Lepton/pixelFormat.h"
+#include "Application/Tasks/Lepton/frameStatistics.h"
+#include "Application/Tasks/Lepton/frameDenoise.h"
+#include "Application/Tasks/Lepton/frameFreeze.h"
+#include "Application/Tasks/Lepton/frameAGC.h"
+#include "Application/Tasks/Lepton/spotTracker.h"
+#include "Application/Tasks/GUI/Private/imageScaler.h"
+#include "Application/Manager/Network/Server/ImageEncoder/rawCodec.h"
+#include "Application/Manager/Network/Server/ImageEncoder/tileDiff.h"
+#include "Application/Manager/SD/sdRecorderFormat.h"
+
+/** @brief Geometry of the thermal image widget of the GUI. The scaler rotates by 180 degree like on the device.
+ */
+#define BENCH_DST_WIDTH                         240
+#define BENCH_DST_HEIGHT                        180
+
+/** @brief Synthetic scene: Lepton 3.5 radiometric frames in centi-Kelvin.
+ */
+#define BENCH_SYNTHETIC_WIDTH                   160
+#define BENCH_SYNTHETIC_HEIGHT                  120
+#define BENCH_SYNTHETIC_FRAMES                  32
+
+/** @brief Noise threshold of the tile comparison in raw counts, the default of the radiometric stream.
+ */
+#define BENCH_TILE_THRESHOLD                    8
+
+#define BENCH_DEFAULT_ITERATIONS                20
+#define BENCH_DEFAULT_MAX_FRAMES                256
+/* Set by the build to the golden file of the synthetic scene in the source tree */
+#ifndef BENCH_DEFAULT_GOLDEN
+#define BENCH_DEFAULT_GOLDEN                    "golden/synthetic.txt"
+#endif
+
+typedef struct {
+    uint16_t Width;
+    uint16_t Height;
+    size_t Count;                               /**< Number of frames. */
+    uint16_t **RAW;                             /**< RAW frames. */
+    uint16_t **RGB565;                          /**< Colorized RGB565 frames (panel byte order). */
+    uint8_t **RGB;                              /**< Colorized RGB888 frames, input of the RGB888 kernels. */
+    uint16_t Min;                               /**< Lower end of the AGC window of the whole sequence. */
+    uint16_t Max;                               /**< Upper end of the AGC window of the whole sequence. */
+    PaletteLUT_t LUT;                           /**< Lookup table for the AGC window of the whole sequence. */
+    PaletteLUT_t Rebuild;                       /**< Lookup table of the rebuild kernel. */
+    PaletteLUT_t Isotherm;                      /**< Lookup table of the rebuild kernel with isotherm bands. */
+    ImageScaler_t Scaler;
+    FrameStatistics_t Statistics;
+    FrameDenoise_t Denoise;                     /**< Temporal filter at the default strength of the firmware. */
+    uint16_t *Filtered;                         /**< RAW14 output of the temporal filter. */
+    FrameFreeze_t Freeze;                       /**< Repeated frame detection, every repeat is reported. */
+    uint32_t FreezeResult[3];                   /**< Hash, repeat and event, number of freezes. */
+    FrameStatistics_t *FrameStatistics;         /**< Statistics of every frame, input of the AGC. */
+    FrameAGC_t Equalize;                        /**< Histogram equalization at the defaults of the firmware. */
+    FrameAGC_t Local;                           /**< Local contrast at the defaults of the firmware. */
+    PaletteLUT_t AGC;                           /**< Lookup table of the AGC kernels. */
+    SpotTracker_t Spots;                        /**< Hot and cold spots of the top and bottom eighth of the scene. */
+    SpotTracker_Result_t SpotResult;
+    uint16_t *Native;                           /**< RGB565 output at the source resolution. */
+    uint8_t *Native888;                         /**< RGB888 output at the source resolution. */
+    uint16_t *Scaled;                           /**< RGB565 output at the widget resolution. */
+    uint8_t *Mask;                              /**< Change mask of the tile comparison. */
+    uint8_t *Encoded;                           /**< Output of the RAW codec. */
+    size_t EncodedSize;
+} Bench_Context_t;
+
+/** @brief              Run a kernel on one frame.
+ *  @param p_Context    Benchmark context
+ *  @param Frame        Index of the frame
+ *  @param pp_Output    Set to the output of the kernel
+ *  @return             Size of the output in bytes
+ */
+typedef size_t (*Bench_Run_t)(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output);
+
+typedef struct {
+    const char *Name;
+    Bench_Run_t Run;
+    bool isPerPixel;                            /**< true when the throughput is given in source pixels. */
+} Bench_Kernel_t;
+
+typedef struct {
+    char Name[32];
+    uint32_t CRC;
+    double Time;                                /**< Best time per frame in microseconds. */
+} Bench_Golden_t;
+
+static uint32_t _Bench_CRCTable[256];
+
+/** @brief Palette for the benchmark. The firmware palettes are part of the Lepton component, so an iron like
+ *         ramp is built from these points.
+ */
+static const uint8_t _Bench_PalettePoints[][4] = {
+    /* Index, R, G, B */
+    {0, 0, 0, 0},
+    {48, 32, 0, 140},
+    {96, 160, 0, 160},
+    {160, 240, 90, 0},
+    {224, 255, 210, 40},
+    {255, 255, 255, 255},
+};
+
+static uint8_t _Bench_Palette[256][3];
+
+static void Bench_InitCRC(void)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+
+        for (uint8_t k = 0; k < 8; k++) {
+            c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+        }
+
+        _Bench_CRCTable[i] = c;
+    }
+}
+
+static uint32_t Bench_CRC(uint32_t CRC, const void *p_Data, size_t Length)
+{
+    const uint8_t *p_Byte = reinterpret_cast<const uint8_t *>(p_Data);
+
+    CRC = ~CRC;
+    for (size_t i = 0; i < Length; i++) {
+        CRC = _Bench_CRCTable[(CRC ^ p_Byte[i]) & 0xFF] ^ (CRC >> 8);
+    }
+
+    return ~CRC;
+}
+
+static void Bench_InitPalette(void)
+{
+    for (size_t p = 0; p < (sizeof(_Bench_PalettePoints) / sizeof(_Bench_PalettePoints[0])) - 1; p++) {
+        const uint8_t *p_Start = _Bench_PalettePoints[p];
+        const uint8_t *p_End = _Bench_PalettePoints[p + 1];
+        uint32_t Span = p_End[0] - p_Start[0];
+
+        for (uint32_t i = p_Start[0]; i <= p_End[0]; i++) {
+            uint32_t Offset = i - p_Start[0];
+
+            for (uint8_t c = 0; c < 3; c++) {
+                _Bench_Palette[i][c] = static_cast<uint8_t>(((p_Start[c + 1] * (Span - Offset)) +
+                                                            (p_End[c + 1] * Offset)) / Span);
+            }
+        }
+    }
+}
+
+/** @brief          Allocate the frame list.
+ *  @param p_Context Benchmark context
+ *  @param Count    Number of frames
+ *  @return         true on success
+ */
+static bool Bench_AllocFrames(Bench_Context_t *p_Context, size_t Count)
+{
+    size_t Pixels = p_Context->Width * p_Context->Height;
+
+    p_Context->RAW = reinterpret_cast<uint16_t **>(calloc(Count, sizeof(uint16_t *)));
+    p_Context->RGB565 = reinterpret_cast<uint16_t **>(calloc(Count, sizeof(uint16_t *)));
+    p_Context->RGB = reinterpret_cast<uint8_t **>(calloc(Count, sizeof(uint8_t *)));
+    if ((p_Context->RAW == NULL) || (p_Context->RGB565 == NULL) || (p_Context->RGB == NULL)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < Count; i++) {
+        p_Context->RAW[i] = reinterpret_cast<uint16_t *>(malloc(Pixels * sizeof(uint16_t)));
+        p_Context->RGB565[i] = reinterpret_cast<uint16_t *>(malloc(Pixels * sizeof(uint16_t)));
+        p_Context->RGB[i] = reinterpret_cast<uint8_t *>(malloc(Pixels * 3));
+        if ((p_Context->RAW[i] == NULL) || (p_Context->RGB565[i] == NULL) || (p_Context->RGB[i] == NULL)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** @brief          Build the synthetic scene: a warm gradient with sensor noise and a hot spot moving through it.
+ *                  The scene only depends on integer arithmetic, so it is the same on every host.
+ *  @param p_Context Benchmark context
+ *  @return         true on success
+ */
+static bool Bench_Synthesize(Bench_Context_t *p_Context)
+{
+    uint32_t Seed = 1;
+
+    p_Context->Width = BENCH_SYNTHETIC_WIDTH;
+    p_Context->Height = BENCH_SYNTHETIC_HEIGHT;
+    p_Context->Count = BENCH_SYNTHETIC_FRAMES;
+
+    if (Bench_AllocFrames(p_Context, p_Context->Count) == false) {
+        return false;
+    }
+
+    for (size_t f = 0; f < p_Context->Count; f++) {
+        int32_t SpotX = 20 + ((f * 4) % 120);
+        int32_t SpotY = 30 + ((f * 2) % 60);
+
+        for (int32_t y = 0; y < p_Context->Height; y++) {
+            for (int32_t x = 0; x < p_Context->Width; x++) {
+                int32_t Distance = ((x - SpotX) * (x - SpotX)) + ((y - SpotY) * (y - SpotY));
+                int32_t Value = 29500 + (x * 4) + (y * 3);
+
+                /* xorshift32 */
+                Seed ^= Seed << 13;
+                Seed ^= Seed >> 17;
+                Seed ^= Seed << 5;
+                Value += static_cast<int32_t>(Seed % 31) - 15;
+
+                if (Distance < 144) {
+                    Value += (3000 * (144 - Distance)) / 144;
+                }
+
+                p_Context->RAW[f][(y * p_Context->Width) + x] = static_cast<uint16_t>(Value);
+            }
+        }
+    }
+
+    return true;
+}
+
+/** @brief              Append the frames of a recording segment.
+ *  @param p_Context    Benchmark context
+ *  @param p_Path       Path of the segment file
+ *  @param MaxFrames    Maximum number of frames in the context
+ *  @return             true on success
+ */
+static bool Bench_LoadSegment(Bench_Context_t *p_Context, const char *p_Path, size_t MaxFrames)
+{
+    SDRecorder_File_Header_t Header;
+    SDRecorder_Frame_Header_t Frame;
+    size_t Pixels;
+    size_t Base;
+    FILE *p_File;
+
+    p_File = fopen(p_Path, "rb");
+    if (p_File == NULL) {
+        fprintf(stderr, "Can not open %s!\n", p_Path);
+        return false;
+    }
+
+    if ((fread(&Header, sizeof(Header), 1, p_File) != 1) || (Header.Magic != SD_RECORDER_FILE_MAGIC) ||
+        (Header.Version != SD_RECORDER_FILE_VERSION)) {
+        fprintf(stderr, "%s is no recording segment!\n", p_Path);
+        fclose(p_File);
+        return false;
+    }
+
+    if (p_Context->Count == 0) {
+        p_Context->Width = Header.Width;
+        p_Context->Height = Header.Height;
+
+        if (Bench_AllocFrames(p_Context, MaxFrames) == false) {
+            fclose(p_File);
+            return false;
+        }
+    } else if ((Header.Width != p_Context->Width) || (Header.Height != p_Context->Height)) {
+        fprintf(stderr, "%s has a different frame size, skipped\n", p_Path);
+        fclose(p_File);
+        return true;
+    }
+
+    Pixels = p_Context->Width * p_Context->Height;
+    Base = p_Context->Count;
+
+    for (uint32_t i = 0; (i < Header.Frames) && (p_Context->Count < MaxFrames); i++) {
+        if ((fseek(p_File, Header.HeaderSize + (static_cast<long>(i) * Header.RecordSize), SEEK_SET) != 0) ||
+            (fread(&Frame, sizeof(Frame), 1, p_File) != 1) || (Frame.Magic != SD_RECORDER_FRAME_MAGIC)) {
+            fprintf(stderr, "%s: broken record %u, stopped\n", p_Path, i);
+            break;
+        }
+
+        if (fread(p_Context->RAW[p_Context->Count], sizeof(uint16_t), Pixels, p_File) != Pixels) {
+            break;
+        }
+
+        p_Context->Count++;
+    }
+
+    fclose(p_File);
+
+    printf("%s: %zu frames %ux%u\n", p_Path, p_Context->Count - Base, p_Context->Width, p_Context->Height);
+
+    return true;
+}
+
+/** @brief              Prepare the state the kernels share: the AGC window of the whole sequence, its lookup table,
+ *                      the colorized RGB888 frames and the output buffers.
+ *  @param p_Context    Benchmark context
+ *  @return             true on success
+ */
+static bool Bench_Prepare(Bench_Context_t *p_Context)
+{
+    size_t Pixels = p_Context->Width * p_Context->Height;
+
+    p_Context->FrameStatistics = reinterpret_cast<FrameStatistics_t *>(malloc(p_Context->Count *
+                                                                              sizeof(FrameStatistics_t)));
+    if (p_Context->FrameStatistics == NULL) {
+        return false;
+    }
+
+    p_Context->Min = 0xFFFF;
+    p_Context->Max = 0;
+    for (size_t f = 0; f < p_Context->Count; f++) {
+        FrameStatistics_Compute(p_Context->RAW[f], p_Context->Width, p_Context->Height, &p_Context->FrameStatistics[f]);
+        if (p_Context->FrameStatistics[f].Min < p_Context->Min) {
+            p_Context->Min = p_Context->FrameStatistics[f].Min;
+        }
+        if (p_Context->FrameStatistics[f].Max > p_Context->Max) {
+            p_Context->Max = p_Context->FrameStatistics[f].Max;
+        }
+    }
+
+    p_Context->EncodedSize = RAW_CODEC_MAX_SIZE(Pixels);
+    p_Context->Native = reinterpret_cast<uint16_t *>(malloc(Pixels * sizeof(uint16_t)));
+    p_Context->Native888 = reinterpret_cast<uint8_t *>(malloc(Pixels * 3));
+    p_Context->Scaled = reinterpret_cast<uint16_t *>(malloc(BENCH_DST_WIDTH * BENCH_DST_HEIGHT * sizeof(uint16_t)));
+    p_Context->Mask = reinterpret_cast<uint8_t *>(malloc(TILE_DIFF_MASK_SIZE(p_Context->Width, p_Context->Height)));
+    p_Context->Encoded = reinterpret_cast<uint8_t *>(malloc(p_Context->EncodedSize));
+    p_Context->Filtered = reinterpret_cast<uint16_t *>(malloc(Pixels * sizeof(uint16_t)));
+    if ((p_Context->Native == NULL) || (p_Context->Native888 == NULL) || (p_Context->Scaled == NULL) ||
+        (p_Context->Mask == NULL) || (p_Context->Encoded == NULL) || (p_Context->Filtered == NULL)) {
+        return false;
+    }
+
+    /* The panel byte order of the firmware */
+    if ((PaletteLUT_Init(&p_Context->LUT, true) != ESP_OK) || (PaletteLUT_Init(&p_Context->Rebuild, true) != ESP_OK) ||
+        (PaletteLUT_Init(&p_Context->Isotherm, true) != ESP_OK) ||
+        (ImageScaler_Configure(&p_Context->Scaler, p_Context->Width, p_Context->Height, BENCH_DST_WIDTH,
+                               BENCH_DST_HEIGHT, true) != ESP_OK) ||
+        (FrameDenoise_Init(&p_Context->Denoise, p_Context->Width, p_Context->Height, FRAME_DENOISE_MEDIUM) !=
+         ESP_OK) || (FrameFreeze_Init(&p_Context->Freeze, 1) != ESP_OK) ||
+        (PaletteLUT_Init(&p_Context->AGC, true) != ESP_OK)) {
+        return false;
+    }
+
+    FrameAGC_Config_t Config = {FRAME_AGC_HEQ, 10, 4, 64};
+    if (FrameAGC_Init(&p_Context->Equalize, p_Context->Width, p_Context->Height, &Config) != ESP_OK) {
+        return false;
+    }
+
+    Config.Mode = FRAME_AGC_LOCAL;
+    if (FrameAGC_Init(&p_Context->Local, p_Context->Width, p_Context->Height, &Config) != ESP_OK) {
+        return false;
+    }
+
+    SpotTracker_Config_t Spots;
+    Spots.Threshold[SPOT_TRACKER_HOT] = p_Context->Max - ((p_Context->Max - p_Context->Min) / 8);
+    Spots.Threshold[SPOT_TRACKER_COLD] = p_Context->Min + ((p_Context->Max - p_Context->Min) / 8);
+    Spots.Hysteresis = 20;
+    Spots.MinArea = 4;
+    Spots.Confirm = 3;
+    Spots.Clear = 5;
+    if (SpotTracker_Init(&p_Context->Spots, p_Context->Width, p_Context->Height, &Spots) != ESP_OK) {
+        return false;
+    }
+
+    /* A band above the upper quarter of the scene on top of a band between the middle third */
+    const Isotherm_Band_t Bands[] = {
+        {static_cast<uint16_t>(p_Context->Max - ((p_Context->Max - p_Context->Min) / 4)), UINT16_MAX, {0xFF, 0, 0}},
+        {static_cast<uint16_t>(p_Context->Min + ((p_Context->Max - p_Context->Min) / 3)),
+         static_cast<uint16_t>(p_Context->Max - ((p_Context->Max - p_Context->Min) / 3)), {0, 0xFF, 0}},
+    };
+    if (PaletteLUT_SetIsotherms(&p_Context->Isotherm, Bands, 2) != ESP_OK) {
+        return false;
+    }
+
+    PaletteLUT_Update(&p_Context->LUT, _Bench_Palette, p_Context->Min, p_Context->Max);
+
+    for (size_t f = 0; f < p_Context->Count; f++) {
+        for (size_t i = 0; i < Pixels; i++) {
+            p_Context->RGB565[f][i] = PaletteLUT_Map(&p_Context->LUT, p_Context->RAW[f][i]);
+        }
+
+        PixelFormat_RGB565ToRGB888(p_Context->RGB565[f], p_Context->RGB[f], Pixels, true);
+    }
+
+    return true;
+}
+
+static size_t Bench_Statistics(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    FrameStatistics_Compute(p_Context->RAW[Frame], p_Context->Width, p_Context->Height, &p_Context->Statistics);
+
+    *pp_Output = &p_Context->Statistics;
+
+    return sizeof(FrameStatistics_t);
+}
+
+static size_t Bench_Denoise(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    size_t Pixels = p_Context->Width * p_Context->Height;
+
+    /* Every pass filters the sequence from its start, so the output does not depend on the iteration */
+    if (Frame == 0) {
+        FrameDenoise_Reset(&p_Context->Denoise);
+    }
+
+    memcpy(p_Context->Filtered, p_Context->RAW[Frame], Pixels * sizeof(uint16_t));
+    FrameDenoise_Apply(&p_Context->Denoise, p_Context->Filtered);
+
+    *pp_Output = p_Context->Filtered;
+
+    return Pixels * sizeof(uint16_t);
+}
+
+static size_t Bench_Freeze(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    FrameFreeze_Event_t Event;
+    size_t Source;
+    bool isRepeat;
+
+    /* Every pass checks the sequence from its start, so the output does not depend on the iteration */
+    if (Frame == 0) {
+        FrameFreeze_Reset(&p_Context->Freeze);
+    }
+
+    /* Every fourth frame repeats the previous one like the camera during a flat field correction */
+    Source = ((Frame % 4) == 3) ? (Frame - 1) : Frame;
+
+    isRepeat = FrameFreeze_Check(&p_Context->Freeze, p_Context->RAW[Source],
+                                 p_Context->Width * p_Context->Height * sizeof(uint16_t), NULL,
+                                 static_cast<int64_t>(Frame) * 111111, &Event, NULL);
+
+    p_Context->FreezeResult[0] = p_Context->Freeze.Hash;
+    p_Context->FreezeResult[1] = (isRepeat ? 1 : 0) | (static_cast<uint32_t>(Event) << 1);
+    p_Context->FreezeResult[2] = p_Context->Freeze.Count;
+
+    *pp_Output = p_Context->FreezeResult;
+
+    return sizeof(p_Context->FreezeResult);
+}
+
+static size_t Bench_PaletteLUT(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    /* A full rebuild for a window that moves with the frame, like a fast AGC */
+    p_Context->Rebuild.isValid = false;
+    PaletteLUT_Update(&p_Context->Rebuild, _Bench_Palette, p_Context->Min + (Frame % 64), p_Context->Max - (Frame % 32));
+
+    *pp_Output = p_Context->Rebuild.RGB565;
+
+    return PALETTE_LUT_SIZE * sizeof(uint16_t);
+}
+
+/** @brief              Rebuild the lookup table with two isotherm bands for a moving window.
+ *  @param p_Context    Benchmark context
+ *  @param Frame        Index of the frame
+ *  @param pp_Output    Pointer to store the output
+ *  @return             Size of the output in bytes
+ */
+static size_t Bench_Isotherm(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    /* The same moving window as the rebuild kernel, the bands are patched after every rebuild */
+    p_Context->Isotherm.isValid = false;
+    PaletteLUT_Update(&p_Context->Isotherm, _Bench_Palette, p_Context->Min + (Frame % 64),
+                      p_Context->Max - (Frame % 32));
+
+    *pp_Output = p_Context->Isotherm.RGB565;
+
+    return PALETTE_LUT_SIZE * sizeof(uint16_t);
+}
+
+/** @brief              Run an AGC on one frame and colorize the frame with its lookup table.
+ *  @param p_Context    Benchmark context
+ *  @param p_AGC        AGC
+ *  @param Frame        Index of the frame
+ *  @return             Size of the output in bytes
+ */
+static size_t Bench_AGC(Bench_Context_t *p_Context, FrameAGC_t *p_AGC, size_t Frame)
+{
+    const uint16_t *p_Image;
+    size_t Pixels = p_Context->Width * p_Context->Height;
+
+    /* Every pass starts with the same smoothed state, so the output does not depend on the iteration */
+    if (Frame == 0) {
+        FrameAGC_Reset(p_AGC);
+        p_Context->AGC.isValid = false;
+    }
+
+    p_Image = FrameAGC_Process(p_AGC, p_Context->RAW[Frame], &p_Context->FrameStatistics[Frame], &p_Context->AGC,
+                               _Bench_Palette);
+    for (size_t i = 0; i < Pixels; i++) {
+        p_Context->Native[i] = PaletteLUT_Map(&p_Context->AGC, p_Image[i]);
+    }
+
+    return Pixels * sizeof(uint16_t);
+}
+
+static size_t Bench_Equalize(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    *pp_Output = p_Context->Native;
+
+    return Bench_AGC(p_Context, &p_Context->Equalize, Frame);
+}
+
+static size_t Bench_LocalContrast(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    *pp_Output = p_Context->Native;
+
+    return Bench_AGC(p_Context, &p_Context->Local, Frame);
+}
+
+static size_t Bench_SpotTracker(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    SpotTracker_Event_t Events[SPOT_TRACKER_KIND_COUNT];
+    const SpotTracker_Result_t *p_Result = &p_Context->SpotResult;
+    uint16_t *p_Output = p_Context->Native;
+    size_t Length;
+
+    /* Every pass tracks the sequence from its start, so the IDs do not depend on the iteration */
+    if (Frame == 0) {
+        SpotTracker_Config_t Config = p_Context->Spots.Config;
+
+        SpotTracker_Deinit(&p_Context->Spots);
+        SpotTracker_Init(&p_Context->Spots, p_Context->Width, p_Context->Height, &Config);
+    }
+
+    SpotTracker_Process(&p_Context->Spots, p_Context->RAW[Frame], &p_Context->FrameStatistics[Frame], Frame,
+                        &p_Context->SpotResult, Events);
+
+    /* The structures contain padding, so the output is the list of the fields */
+    Length = 0;
+    p_Output[Length++] = p_Result->isAlarm[SPOT_TRACKER_HOT] | (p_Result->isAlarm[SPOT_TRACKER_COLD] << 1) |
+                         (p_Result->isTruncated << 2);
+    p_Output[Length++] = p_Result->Count;
+    for (uint8_t i = 0; i < p_Result->Count; i++) {
+        const SpotTracker_Spot_t *p_Spot = &p_Result->Spots[i];
+
+        p_Output[Length++] = p_Spot->ID;
+        p_Output[Length++] = p_Spot->Kind;
+        p_Output[Length++] = p_Spot->X;
+        p_Output[Length++] = p_Spot->Y;
+        p_Output[Length++] = p_Spot->Area;
+        p_Output[Length++] = p_Spot->Peak;
+    }
+    p_Output[Length++] = static_cast<uint16_t>(p_Result->Last.Number);
+
+    *pp_Output = p_Output;
+
+    return Length * sizeof(uint16_t);
+}
+
+static size_t Bench_Colorize(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    const uint16_t *p_RAW = p_Context->RAW[Frame];
+    size_t Pixels = p_Context->Width * p_Context->Height;
+
+    for (size_t i = 0; i < Pixels; i++) {
+        p_Context->Native[i] = PaletteLUT_Map(&p_Context->LUT, p_RAW[i]);
+    }
+
+    *pp_Output = p_Context->Native;
+
+    return Pixels * sizeof(uint16_t);
+}
+
+static size_t Bench_ScaleRAW14(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    ImageScaler_ScaleRAW14(&p_Context->Scaler, p_Context->RAW[Frame], &p_Context->LUT, p_Context->Scaled);
+
+    *pp_Output = p_Context->Scaled;
+
+    return BENCH_DST_WIDTH * BENCH_DST_HEIGHT * sizeof(uint16_t);
+}
+
+static size_t Bench_ScaleRGB888(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    ImageScaler_ScaleRGB888(&p_Context->Scaler, p_Context->RGB[Frame], p_Context->Scaled);
+
+    *pp_Output = p_Context->Scaled;
+
+    return BENCH_DST_WIDTH * BENCH_DST_HEIGHT * sizeof(uint16_t);
+}
+
+static size_t Bench_ToRGB565(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    size_t Pixels = p_Context->Width * p_Context->Height;
+
+    PixelFormat_RGB888ToRGB565(p_Context->RGB[Frame], p_Context->Native, Pixels, true);
+
+    *pp_Output = p_Context->Native;
+
+    return Pixels * sizeof(uint16_t);
+}
+
+static size_t Bench_ToRGB888(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    size_t Pixels = p_Context->Width * p_Context->Height;
+
+    PixelFormat_RGB565ToRGB888(p_Context->RGB565[Frame], p_Context->Native888, Pixels, true);
+
+    *pp_Output = p_Context->Native888;
+
+    return Pixels * 3;
+}
+
+static size_t Bench_TileDiff(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    const uint16_t *p_Reference = p_Context->RAW[(Frame > 0) ? (Frame - 1) : (p_Context->Count - 1)];
+
+    TileDiff_Compare(p_Context->RAW[Frame], p_Reference, p_Context->Width, p_Context->Height, BENCH_TILE_THRESHOLD,
+                     p_Context->Mask);
+
+    *pp_Output = p_Context->Mask;
+
+    return TILE_DIFF_MASK_SIZE(p_Context->Width, p_Context->Height);
+}
+
+static size_t Bench_RawIntra(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    *pp_Output = p_Context->Encoded;
+
+    return RawCodec_Encode(p_Context->RAW[Frame], NULL, p_Context->Width, p_Context->Height, p_Context->Encoded,
+                           p_Context->EncodedSize);
+}
+
+static size_t Bench_RawDelta(Bench_Context_t *p_Context, size_t Frame, const void **pp_Output)
+{
+    const uint16_t *p_Reference = p_Context->RAW[(Frame > 0) ? (Frame - 1) : (p_Context->Count - 1)];
+
+    *pp_Output = p_Context->Encoded;
+
+    return RawCodec_Encode(p_Context->RAW[Frame], p_Reference, p_Context->Width, p_Context->Height,
+                           p_Context->Encoded, p_Context->EncodedSize);
+}
+
+/** @brief Kernels in the order of the frame path: noise reduction, statistics, AGC, colorize, display and network.
+ */
+static const Bench_Kernel_t _Bench_Kernels[] = {
+    {"temporal_denoise", Bench_Denoise, true},
+    {"frame_statistics", Bench_Statistics, true},
+    {"frame_freeze", Bench_Freeze, true},
+    {"palette_lut_rebuild", Bench_PaletteLUT, false},
+    {"palette_lut_isotherm", Bench_Isotherm, false},
+    {"colorize_rgb565", Bench_Colorize, true},
+    {"agc_heq_rgb565", Bench_Equalize, true},
+    {"agc_local_rgb565", Bench_LocalContrast, true},
+    {"spot_tracker", Bench_SpotTracker, true},
+    {"scale_raw14", Bench_ScaleRAW14, true},
+    {"scale_rgb888", Bench_ScaleRGB888, true},
+    {"rgb888_to_rgb565", Bench_ToRGB565, true},
+    {"rgb565_to_rgb888", Bench_ToRGB888, true},
+    {"tile_diff", Bench_TileDiff, true},
+    {"raw_codec_intra", Bench_RawIntra, true},
+    {"raw_codec_delta", Bench_RawDelta, true},
+};
+
+#define BENCH_KERNEL_COUNT                      (sizeof(_Bench_Kernels) / sizeof(_Bench_Kernels[0]))
+
+/** @brief              Read a golden file. Unknown lines are ignored.
+ *  @param p_Path       Path of the golden file
+ *  @param p_Golden     Entries, one per kernel
+ *  @param p_Input      Set to the CRC32 of the input frames the file was written for
+ *  @return             Number of entries or -1 if the file can not be read
+ */
+static int Bench_ReadGolden(const char *p_Path, Bench_Golden_t *p_Golden, uint32_t *p_Input)
+{
+    char Line[128];
+    int Count = 0;
+    FILE *p_File;
+
+    p_File = fopen(p_Path, "r");
+    if (p_File == NULL) {
+        return -1;
+    }
+
+    *p_Input = 0;
+    while ((fgets(Line, sizeof(Line), p_File) != NULL) && (Count < static_cast<int>(BENCH_KERNEL_COUNT))) {
+        Bench_Golden_t Entry;
+
+        if ((Line[0] == '#') || (Line[0] == '\n')) {
+            continue;
+        }
+
+        if (sscanf(Line, "input %x", p_Input) == 1) {
+            continue;
+        }
+
+        if (sscanf(Line, "%31s %x %lf", Entry.Name, &Entry.CRC, &Entry.Time) == 3) {
+            p_Golden[Count++] = Entry;
+        }
+    }
+
+    fclose(p_File);
+
+    return Count;
+}
+
+/** @brief              Write a golden file.
+ *  @param p_Path       Path of the golden file
+ *  @param p_Golden     Entries, one per kernel
+ *  @param Input        CRC32 of the input frames
+ *  @param p_Context    Benchmark context
+ *  @return             true on success
+ */
+static bool Bench_WriteGolden(const char *p_Path, const Bench_Golden_t *p_Golden, uint32_t Input,
+                              const Bench_Context_t *p_Context)
+{
+    FILE *p_File;
+
+    p_File = fopen(p_Path, "w");
+    if (p_File == NULL) {
+        fprintf(stderr, "Can not write %s!\n", p_Path);
+        return false;
+    }
+
+    fprintf(p_File, "# Written by pyrovision_bench -u: %zu frames %ux%u\n", p_Context->Count, p_Context->Width,
+            p_Context->Height);
+    fprintf(p_File, "# <kernel> <CRC32 of the output of all frames> <best time per frame in us>\n");
+    fprintf(p_File, "input %08x\n", Input);
+    for (size_t k = 0; k < BENCH_KERNEL_COUNT; k++) {
+        fprintf(p_File, "%s %08x %.2f\n", p_Golden[k].Name, p_Golden[k].CRC, p_Golden[k].Time);
+    }
+
+    fclose(p_File);
+
+    return true;
+}
+
+static const Bench_Golden_t *Bench_FindGolden(const Bench_Golden_t *p_Golden, int Count, const char *p_Name)
+{
+    for (int i = 0; i < Count; i++) {
+        if (strcmp(p_Golden[i].Name, p_Name) == 0) {
+            return &p_Golden[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void Bench_Usage(void)
+{
+    fprintf(stderr, "Usage: pyrovision_bench [-n <iterations>] [-f <max frames>] [-g <golden file>] [-u] "
+            "[-t <percent>] [<segment.PRV> ...]\n");
+}
+
+int main(int argc, char **argv)
+{
+    static Bench_Context_t Context;
+    Bench_Golden_t Golden[BENCH_KERNEL_COUNT];
+    Bench_Golden_t Result[BENCH_KERNEL_COUNT];
+    const char *p_GoldenPath = BENCH_DEFAULT_GOLDEN;
+    unsigned long Iterations = BENCH_DEFAULT_ITERATIONS;
+    unsigned long MaxFrames = BENCH_DEFAULT_MAX_FRAMES;
+    double Tolerance = -1.0;
+    bool doUpdate = false;
+    uint32_t GoldenInput = 0;
+    uint32_t Input = 0;
+    int GoldenCount;
+    int Failures = 0;
+    int Option;
+
+    while ((Option = getopt(argc, argv, "n:f:g:ut:h")) != -1) {
+        switch (Option) {
+            case 'n': {
+                Iterations = strtoul(optarg, NULL, 10);
+                break;
+            }
+            case 'f': {
+                MaxFrames = strtoul(optarg, NULL, 10);
+                break;
+            }
+            case 'g': {
+                p_GoldenPath = optarg;
+                break;
+            }
+            case 'u': {
+                doUpdate = true;
+                break;
+            }
+            case 't': {
+                Tolerance = strtod(optarg, NULL);
+                break;
+            }
+            default: {
+                Bench_Usage();
+                return 2;
+            }
+        }
+    }
+
+    if ((Iterations == 0) || (MaxFrames == 0)) {
+        Bench_Usage();
+        return 2;
+    }
+
+    Bench_InitCRC();
+    Bench_InitPalette();
+
+    if (optind < argc) {
+        for (int i = optind; i < argc; i++) {
+            if (Bench_LoadSegment(&Context, argv[i], MaxFrames) == false) {
+                return 2;
+            }
+        }
+    } else if (Bench_Synthesize(&Context) == false) {
+        fprintf(stderr, "Failed to build the synthetic scene!\n");
+        return 2;
+    }
+
+    if (Context.Count == 0) {
+        fprintf(stderr, "No frames!\n");
+        return 2;
+    }
+
+    if (Bench_Prepare(&Context) == false) {
+        fprintf(stderr, "Failed to prepare the kernels!\n");
+        return 2;
+    }
+
+    for (size_t f = 0; f < Context.Count; f++) {
+        Input = Bench_CRC(Input, Context.RAW[f], Context.Width * Context.Height * sizeof(uint16_t));
+    }
+
+    GoldenCount = doUpdate ? 0 : Bench_ReadGolden(p_GoldenPath, Golden, &GoldenInput);
+    if ((doUpdate == false) && (GoldenCount < 0)) {
+        fprintf(stderr, "Can not read %s, write it with -u\n", p_GoldenPath);
+    } else if ((doUpdate == false) && (GoldenInput != Input)) {
+        fprintf(stderr, "%s was written for other frames (input %08x, expected %08x)\n", p_GoldenPath, GoldenInput,
+                Input);
+        GoldenCount = -1;
+    }
+
+    printf("%zu frames %ux%u -> %ux%u, %lu iterations, input %08x\n\n", Context.Count, Context.Width,
+           Context.Height, BENCH_DST_WIDTH, BENCH_DST_HEIGHT, Iterations, Input);
+    printf("%-22s %10s %10s %12s  %s\n", "kernel", "us/frame", "fps", "Mpixel/s", "check");
+
+    for (size_t k = 0; k < BENCH_KERNEL_COUNT; k++) {
+        const Bench_Kernel_t *p_Kernel = &_Bench_Kernels[k];
+        const Bench_Golden_t *p_Expected;
+        const char *p_Check;
+        int64_t Best = INT64_MAX;
+        uint32_t CRC = 0;
+        double Time;
+
+        /* The check pass also warms up the caches and the lookup tables */
+        for (size_t f = 0; f < Context.Count; f++) {
+            const void *p_Output;
+            size_t Size;
+
+            Size = p_Kernel->Run(&Context, f, &p_Output);
+            CRC = Bench_CRC(CRC, p_Output, Size);
+        }
+
+        for (unsigned long i = 0; i < Iterations; i++) {
+            int64_t Start = esp_timer_get_time();
+
+            for (size_t f = 0; f < Context.Count; f++) {
+                const void *p_Output;
+
+                p_Kernel->Run(&Context, f, &p_Output);
+            }
+
+            Start = esp_timer_get_time() - Start;
+            if (Start < Best) {
+                Best = Start;
+            }
+        }
+
+        Time = static_cast<double>(Best) / Context.Count;
+
+        snprintf(Result[k].Name, sizeof(Result[k].Name), "%s", p_Kernel->Name);
+        Result[k].CRC = CRC;
+        Result[k].Time = Time;
+
+        p_Expected = (GoldenCount > 0) ? Bench_FindGolden(Golden, GoldenCount, p_Kernel->Name) : NULL;
+        if (doUpdate) {
+            p_Check = "updated";
+        } else if (p_Expected == NULL) {
+            p_Check = "no golden";
+            Failures++;
+        } else if (p_Expected->CRC != CRC) {
+            p_Check = "MISMATCH";
+            Failures++;
+        } else if ((Tolerance >= 0.0) && (Time > (p_Expected->Time * (1.0 + (Tolerance / 100.0))))) {
+            p_Check = "SLOWER";
+            Failures++;
+        } else {
+            p_Check = "ok";
+        }
+
+        if (p_Kernel->isPerPixel) {
+            printf("%-22s %10.2f %10.0f %12.2f  %s\n", p_Kernel->Name, Time, 1000000.0 / Time,
+                   (Context.Width * Context.Height) / Time, p_Check);
+        } else {
+            printf("%-22s %10.2f %10.0f %12s  %s\n", p_Kernel->Name, Time, 1000000.0 / Time, "-", p_Check);
+        }
+    }
+
+    PaletteLUT_Deinit(&Context.LUT);
+    PaletteLUT_Deinit(&Context.Rebuild);
+    PaletteLUT_Deinit(&Context.Isotherm);
+    ImageScaler_Deinit(&Context.Scaler);
+    SpotTracker_Deinit(&Context.Spots);
+
+    if (doUpdate) {
+        return Bench_WriteGolden(p_GoldenPath, Result, Input, &Context) ? 0 : 2;
+    }
+
+    if (Failures > 0) {
+        printf("\n%d kernels failed\n", Failures);
+        return 1;
+    }
+
+    return 0;
+}
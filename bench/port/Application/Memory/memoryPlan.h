@@ -0,0 +1,53 @@
+/*
+ * memoryPlan.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Host port of the memory plan for the benchmark harness.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef PORT_MEMORY_PLAN_H_
+#define PORT_MEMORY_PLAN_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+    MEMORY_REGION_FAST = 0,
+    MEMORY_REGION_DMA,
+    MEMORY_REGION_FRAME,
+    MEMORY_REGION_BULK,
+    MEMORY_REGION_COUNT,
+} MemoryPlan_Region_t;
+
+/* All regions are served by the host heap, aligned like the frame arena */
+static inline void *MemoryPlan_Alloc(MemoryPlan_Region_t Region, size_t Size, const char *p_Owner)
+{
+    (void)Region;
+    (void)p_Owner;
+
+    return aligned_alloc(16, (Size + 15) & ~static_cast<size_t>(15));
+}
+
+static inline void MemoryPlan_Free(void *p_Buffer)
+{
+    free(p_Buffer);
+}
+
+#endif /* PORT_MEMORY_PLAN_H_ */
@@ -0,0 +1,42 @@
+/*
+ * esp_err.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Host port of the ESP-IDF error codes for the benchmark harness.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef PORT_ESP_ERR_H_
+#define PORT_ESP_ERR_H_
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+
+/* Same values as ESP-IDF, so the codes in the output match the firmware log */
+#define ESP_OK                                  0
+#define ESP_FAIL                                -1
+#define ESP_ERR_NO_MEM                          0x101
+#define ESP_ERR_INVALID_ARG                     0x102
+#define ESP_ERR_INVALID_STATE                   0x103
+#define ESP_ERR_INVALID_SIZE                    0x104
+#define ESP_ERR_NOT_FOUND                       0x105
+#define ESP_ERR_NOT_SUPPORTED                   0x106
+#define ESP_ERR_TIMEOUT                         0x107
+
+#endif /* PORT_ESP_ERR_H_ */
@@ -0,0 +1,64 @@
+/*
+ * esp_heap_caps.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Host port of the ESP-IDF capability allocator for the benchmark harness.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef PORT_ESP_HEAP_CAPS_H_
+#define PORT_ESP_HEAP_CAPS_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define MALLOC_CAP_8BIT                         (1 << 2)
+#define MALLOC_CAP_DMA                          (1 << 3)
+#define MALLOC_CAP_SPIRAM                       (1 << 10)
+#define MALLOC_CAP_INTERNAL                     (1 << 11)
+#define MALLOC_CAP_DEFAULT                      (1 << 12)
+
+/* All capabilities are served by the host heap */
+static inline void *heap_caps_malloc(size_t Size, uint32_t Caps)
+{
+    (void)Caps;
+
+    return malloc(Size);
+}
+
+static inline void *heap_caps_calloc(size_t Count, size_t Size, uint32_t Caps)
+{
+    (void)Caps;
+
+    return calloc(Count, Size);
+}
+
+static inline void *heap_caps_aligned_alloc(size_t Alignment, size_t Size, uint32_t Caps)
+{
+    (void)Caps;
+
+    return aligned_alloc(Alignment, (Size + Alignment - 1) & ~(Alignment - 1));
+}
+
+static inline void heap_caps_free(void *p_Ptr)
+{
+    free(p_Ptr);
+}
+
+#endif /* PORT_ESP_HEAP_CAPS_H_ */
@@ -0,0 +1,36 @@
+/*
+ * esp_log.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Host port of the ESP-IDF logging for the benchmark harness.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef PORT_ESP_LOG_H_
+#define PORT_ESP_LOG_H_
+
+#include <stdio.h>
+
+/* Errors and warnings go to stderr, so they never mix with the results on stdout */
+#define ESP_LOGE(tag, format, ...)              fprintf(stderr, "E %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...)              fprintf(stderr, "W %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...)              do { (void)(tag); } while (0)
+#define ESP_LOGD(tag, format, ...)              do { (void)(tag); } while (0)
+#define ESP_LOGV(tag, format, ...)              do { (void)(tag); } while (0)
+
+#endif /* PORT_ESP_LOG_H_ */
@@ -0,0 +1,42 @@
+/*
+ * esp_timer.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Host port of the ESP-IDF high resolution timer for the benchmark harness.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef PORT_ESP_TIMER_H_
+#define PORT_ESP_TIMER_H_
+
+#include <stdint.h>
+#include <time.h>
+
+/** @brief  Monotonic time in microseconds, like the time since boot of the firmware.
+ *  @return Time in microseconds
+ */
+static inline int64_t esp_timer_get_time(void)
+{
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+
+    return (static_cast<int64_t>(Now.tv_sec) * 1000000) + (Now.tv_nsec / 1000);
+}
+
+#endif /* PORT_ESP_TIMER_H_ */
@@ -0,0 +1,722 @@
+/*
+ * benchmark.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: On-device benchmark suite of the benchmark firmware.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <sdkconfig.h>
+
+#ifdef BENCHMARK
+
+#include <esp_log.h>
+#include <esp_cpu.h>
+#include <esp_timer.h>
+#include <esp_chip_info.h>
+#include <esp_heap_caps.h>
+#include <esp_psram.h>
+#include <esp_idf_version.h>
+#include <esp_system.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdarg>
+#include <cstring>
+
+#include "lepton.h"
+#include "benchmark.h"
+#include "Application/Tasks/GUI/guiTask.h"
+#include "Application/Tasks/GUI/Private/imageScaler.h"
+#include "Application/Tasks/Lepton/leptonTask.h"
+#include "Application/Tasks/Lepton/paletteLUT.h"
+#include "Application/Tasks/Lepton/pixelFormat.h"
+#include "Application/Tasks/Lepton/frameStatistics.h"
+#include "Application/Manager/SD/sdManager.h"
+#include "Application/Manager/Settings/settingsManager.h"
+#include "Application/Manager/Network/Server/ImageEncoder/imageEncoder.h"
+#include "Application/Manager/Network/Server/ImageEncoder/rawCodec.h"
+#include "Application/Manager/Network/Server/ImageEncoder/tileDiff.h"
+
+/* Same scene and sizes as the host benchmark in bench/, so the results of both can be compared */
+#define BENCHMARK_WIDTH                     160
+#define BENCHMARK_HEIGHT                    120
+#define BENCHMARK_PIXELS                    (BENCHMARK_WIDTH * BENCHMARK_HEIGHT)
+#define BENCHMARK_DST_WIDTH                 240
+#define BENCHMARK_DST_HEIGHT                180
+#define BENCHMARK_FRAMES                    8
+#define BENCHMARK_TILE_THRESHOLD            8
+
+/* The slow benchmarks are repeated less often */
+#define BENCHMARK_SLOW_RUNS                 10
+#define BENCHMARK_SD_RUNS                   3
+#define BENCHMARK_SD_CHUNK_SIZE             (32 * 1024)
+#define BENCHMARK_SD_FILE                   SD_MOUNT_POINT "/bench.bin"
+
+/** @brief Buffers and parameters of the benchmarks.
+ */
+typedef struct {
+    uint16_t *RAW[BENCHMARK_FRAMES];
+    uint8_t *RGB;                               /**< RGB888 frame of the scene. */
+    uint16_t *RGB565;                           /**< RGB565 frame of the scene. */
+    uint16_t *Native;                           /**< RGB565 output. */
+    uint8_t *Native888;                         /**< RGB888 output. */
+    uint16_t *Scaled;                           /**< Display sized RGB565 output. */
+    uint8_t *Mask;
+    uint8_t *Encoded;
+    size_t EncodedSize;
+    uint8_t *Chunk;                             /**< DMA capable chunk of the SD card benchmarks. */
+    PaletteLUT_t LUT;
+    PaletteLUT_t Rebuild;
+    ImageScaler_t Scaler;
+    FrameStatistics_t Statistics;
+    uint16_t Min;
+    uint16_t Max;
+    uint32_t Frame;                             /**< Frame of the next run. */
+    uint8_t Quality;                            /**< JPEG quality of the encoder benchmark. */
+} Benchmark_Context_t;
+
+/** @brief              Benchmark function.
+ *  @param p_Context    Benchmark context
+ *  @param p_Bytes      Set to the bytes processed or transferred by the run
+ *  @return             ESP_OK on success
+ */
+typedef esp_err_t (*Benchmark_Function_t)(Benchmark_Context_t *p_Context, uint32_t *p_Bytes);
+
+typedef struct {
+    SemaphoreHandle_t Mutex;
+    int64_t Time;                               /**< Completion time of the suite in us. */
+    uint8_t Count;
+    Benchmark_Result_t Results[BENCHMARK_MAX_RESULTS];
+} Benchmark_State_t;
+
+static Benchmark_State_t _Benchmark_State;
+
+static const char *TAG = "benchmark";
+
+/** @brief              Build the synthetic scene of the host benchmark: a warm gradient with sensor noise and a hot
+ *                      spot moving through it.
+ *  @param p_Context    Benchmark context
+ */
+static void Benchmark_Synthesize(Benchmark_Context_t *p_Context)
+{
+    uint32_t Seed = 1;
+
+    for (int32_t f = 0; f < BENCHMARK_FRAMES; f++) {
+        int32_t SpotX = 20 + ((f * 4) % 120);
+        int32_t SpotY = 30 + ((f * 2) % 60);
+
+        for (int32_t y = 0; y < BENCHMARK_HEIGHT; y++) {
+            for (int32_t x = 0; x < BENCHMARK_WIDTH; x++) {
+                int32_t Distance = ((x - SpotX) * (x - SpotX)) + ((y - SpotY) * (y - SpotY));
+                int32_t Value = 29500 + (x * 4) + (y * 3);
+
+                /* xorshift32 */
+                Seed ^= Seed << 13;
+                Seed ^= Seed >> 17;
+                Seed ^= Seed << 5;
+                Value += static_cast<int32_t>(Seed % 31) - 15;
+
+                if (Distance < 144) {
+                    Value += (3000 * (144 - Distance)) / 144;
+                }
+
+                p_Context->RAW[f][(y * BENCHMARK_WIDTH) + x] = static_cast<uint16_t>(Value);
+            }
+        }
+    }
+}
+
+/** @brief              Allocate the buffers and prepare the scene, the lookup tables and the scaler.
+ *  @param p_Context    Benchmark context
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_NO_MEM if a buffer can not be allocated
+ */
+static esp_err_t Benchmark_Prepare(Benchmark_Context_t *p_Context)
+{
+    const uint32_t Caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+
+    memset(p_Context, 0, sizeof(Benchmark_Context_t));
+
+    /* The frame buffers of the application are in the PSRAM as well */
+    for (uint8_t f = 0; f < BENCHMARK_FRAMES; f++) {
+        p_Context->RAW[f] = reinterpret_cast<uint16_t *>(heap_caps_malloc(BENCHMARK_PIXELS * sizeof(uint16_t), Caps));
+        if (p_Context->RAW[f] == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    p_Context->EncodedSize = RAW_CODEC_MAX_SIZE(BENCHMARK_PIXELS);
+    p_Context->RGB = reinterpret_cast<uint8_t *>(heap_caps_malloc(BENCHMARK_PIXELS * 3, Caps));
+    p_Context->RGB565 = reinterpret_cast<uint16_t *>(heap_caps_malloc(BENCHMARK_PIXELS * sizeof(uint16_t), Caps));
+    p_Context->Native = reinterpret_cast<uint16_t *>(heap_caps_malloc(BENCHMARK_PIXELS * sizeof(uint16_t), Caps));
+    p_Context->Native888 = reinterpret_cast<uint8_t *>(heap_caps_malloc(BENCHMARK_PIXELS * 3, Caps));
+    p_Context->Scaled = reinterpret_cast<uint16_t *>(heap_caps_malloc(BENCHMARK_DST_WIDTH * BENCHMARK_DST_HEIGHT *
+                                                                      sizeof(uint16_t), Caps));
+    p_Context->Mask = reinterpret_cast<uint8_t *>(heap_caps_malloc(TILE_DIFF_MASK_SIZE(BENCHMARK_WIDTH,
+                                                                                       BENCHMARK_HEIGHT), Caps));
+    p_Context->Encoded = reinterpret_cast<uint8_t *>(heap_caps_malloc(p_Context->EncodedSize, Caps));
+    p_Context->Chunk = reinterpret_cast<uint8_t *>(heap_caps_malloc(BENCHMARK_SD_CHUNK_SIZE, MALLOC_CAP_DMA));
+    if ((p_Context->RGB == NULL) || (p_Context->RGB565 == NULL) || (p_Context->Native == NULL) ||
+        (p_Context->Native888 == NULL) || (p_Context->Scaled == NULL) || (p_Context->Mask == NULL) ||
+        (p_Context->Encoded == NULL) || (p_Context->Chunk == NULL)) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if ((PaletteLUT_Init(&p_Context->LUT, true) != ESP_OK) || (PaletteLUT_Init(&p_Context->Rebuild, true) != ESP_OK) ||
+        (ImageScaler_Configure(&p_Context->Scaler, BENCHMARK_WIDTH, BENCHMARK_HEIGHT, BENCHMARK_DST_WIDTH,
+                               BENCHMARK_DST_HEIGHT, true) != ESP_OK)) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    Benchmark_Synthesize(p_Context);
+
+    FrameStatistics_Compute(p_Context->RAW[0], BENCHMARK_WIDTH, BENCHMARK_HEIGHT, &p_Context->Statistics);
+    p_Context->Min = p_Context->Statistics.Min;
+    p_Context->Max = p_Context->Statistics.Max;
+
+    PaletteLUT_Update(&p_Context->LUT, Lepton_Palette_Iron, p_Context->Min, p_Context->Max);
+    for (uint32_t i = 0; i < BENCHMARK_PIXELS; i++) {
+        p_Context->RGB565[i] = PaletteLUT_Map(&p_Context->LUT, p_Context->RAW[0][i]);
+    }
+    PixelFormat_RGB565ToRGB888(p_Context->RGB565, p_Context->RGB, BENCHMARK_PIXELS, true);
+
+    memset(p_Context->Chunk, 0xA5, BENCHMARK_SD_CHUNK_SIZE);
+
+    return ESP_OK;
+}
+
+/** @brief              Free the buffers of the benchmarks.
+ *  @param p_Context    Benchmark context
+ */
+static void Benchmark_Release(Benchmark_Context_t *p_Context)
+{
+    for (uint8_t f = 0; f < BENCHMARK_FRAMES; f++) {
+        heap_caps_free(p_Context->RAW[f]);
+    }
+
+    heap_caps_free(p_Context->RGB);
+    heap_caps_free(p_Context->RGB565);
+    heap_caps_free(p_Context->Native);
+    heap_caps_free(p_Context->Native888);
+    heap_caps_free(p_Context->Scaled);
+    heap_caps_free(p_Context->Mask);
+    heap_caps_free(p_Context->Encoded);
+    heap_caps_free(p_Context->Chunk);
+
+    PaletteLUT_Deinit(&p_Context->LUT);
+    PaletteLUT_Deinit(&p_Context->Rebuild);
+    ImageScaler_Deinit(&p_Context->Scaler);
+}
+
+/** @brief              Get the frame of the next run and its predecessor.
+ *  @param p_Context    Benchmark context
+ *  @param pp_Reference Pointer to store the previous frame
+ *  @return             Frame
+ */
+static const uint16_t *Benchmark_NextFrame(Benchmark_Context_t *p_Context, const uint16_t **pp_Reference)
+{
+    uint32_t Frame = p_Context->Frame++ % BENCHMARK_FRAMES;
+
+    if (pp_Reference != NULL) {
+        *pp_Reference = p_Context->RAW[(Frame > 0) ? (Frame - 1) : (BENCHMARK_FRAMES - 1)];
+    }
+
+    return p_Context->RAW[Frame];
+}
+
+static esp_err_t Benchmark_Statistics(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    *p_Bytes = BENCHMARK_PIXELS * sizeof(uint16_t);
+
+    return FrameStatistics_Compute(Benchmark_NextFrame(p_Context, NULL), BENCHMARK_WIDTH, BENCHMARK_HEIGHT,
+                                   &p_Context->Statistics);
+}
+
+static esp_err_t Benchmark_PaletteLUT(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    uint32_t Frame = p_Context->Frame++;
+
+    *p_Bytes = 0;
+
+    /* Every run gets another window, an unchanged window would skip the rebuild */
+    PaletteLUT_Update(&p_Context->Rebuild, Lepton_Palette_Iron, p_Context->Min + (Frame % 64),
+                      p_Context->Max - (Frame % 32));
+
+    return ESP_OK;
+}
+
+static esp_err_t Benchmark_Colorize(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    const uint16_t *p_RAW = Benchmark_NextFrame(p_Context, NULL);
+
+    for (uint32_t i = 0; i < BENCHMARK_PIXELS; i++) {
+        p_Context->Native[i] = PaletteLUT_Map(&p_Context->LUT, p_RAW[i]);
+    }
+
+    *p_Bytes = BENCHMARK_PIXELS * sizeof(uint16_t);
+
+    return ESP_OK;
+}
+
+static esp_err_t Benchmark_LeptonColorize(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    *p_Bytes = BENCHMARK_PIXELS * 3;
+
+    return Lepton_Task_Colorize(Benchmark_NextFrame(p_Context, NULL), p_Context->Native888, BENCHMARK_WIDTH,
+                                BENCHMARK_HEIGHT);
+}
+
+static esp_err_t Benchmark_ScaleRAW14(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    ImageScaler_ScaleRAW14(&p_Context->Scaler, Benchmark_NextFrame(p_Context, NULL), &p_Context->LUT,
+                           p_Context->Scaled);
+
+    *p_Bytes = BENCHMARK_DST_WIDTH * BENCHMARK_DST_HEIGHT * sizeof(uint16_t);
+
+    return ESP_OK;
+}
+
+static esp_err_t Benchmark_ScaleRGB888(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    ImageScaler_ScaleRGB888(&p_Context->Scaler, p_Context->RGB, p_Context->Scaled);
+
+    *p_Bytes = BENCHMARK_DST_WIDTH * BENCHMARK_DST_HEIGHT * sizeof(uint16_t);
+
+    return ESP_OK;
+}
+
+static esp_err_t Benchmark_ToRGB565(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    PixelFormat_RGB888ToRGB565(p_Context->RGB, p_Context->Native, BENCHMARK_PIXELS, true);
+
+    *p_Bytes = BENCHMARK_PIXELS * sizeof(uint16_t);
+
+    return ESP_OK;
+}
+
+static esp_err_t Benchmark_ToRGB888(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    PixelFormat_RGB565ToRGB888(p_Context->RGB565, p_Context->Native888, BENCHMARK_PIXELS, true);
+
+    *p_Bytes = BENCHMARK_PIXELS * 3;
+
+    return ESP_OK;
+}
+
+static esp_err_t Benchmark_TileDiff(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    const uint16_t *p_Reference;
+    const uint16_t *p_Frame = Benchmark_NextFrame(p_Context, &p_Reference);
+
+    TileDiff_Compare(p_Frame, p_Reference, BENCHMARK_WIDTH, BENCHMARK_HEIGHT, BENCHMARK_TILE_THRESHOLD,
+                     p_Context->Mask);
+
+    *p_Bytes = BENCHMARK_PIXELS * sizeof(uint16_t);
+
+    return ESP_OK;
+}
+
+static esp_err_t Benchmark_RawIntra(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    *p_Bytes = RawCodec_Encode(Benchmark_NextFrame(p_Context, NULL), NULL, BENCHMARK_WIDTH, BENCHMARK_HEIGHT,
+                               p_Context->Encoded, p_Context->EncodedSize);
+
+    return (*p_Bytes > 0) ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
+
+static esp_err_t Benchmark_RawDelta(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    const uint16_t *p_Reference;
+    const uint16_t *p_Frame = Benchmark_NextFrame(p_Context, &p_Reference);
+
+    *p_Bytes = RawCodec_Encode(p_Frame, p_Reference, BENCHMARK_WIDTH, BENCHMARK_HEIGHT, p_Context->Encoded,
+                               p_Context->EncodedSize);
+
+    return (*p_Bytes > 0) ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
+
+static esp_err_t Benchmark_JPEG(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    Network_Thermal_Frame_t Frame;
+    Network_Encoded_Image_t Encoded;
+    esp_err_t Error;
+
+    /* Sequence 0 bypasses the cache of the encoder, so every run encodes the frame */
+    memset(&Frame, 0, sizeof(Frame));
+    Frame.buffer = p_Context->RGB;
+    Frame.raw = const_cast<uint16_t *>(Benchmark_NextFrame(p_Context, NULL));
+    Frame.width = BENCHMARK_WIDTH;
+    Frame.height = BENCHMARK_HEIGHT;
+
+    *p_Bytes = 0;
+
+    Error = ImageEncoder_EncodeWithQuality(&Frame, NETWORK_IMAGE_FORMAT_JPEG, PALETTE_IRON, p_Context->Quality,
+                                           &Encoded);
+    if (Error != ESP_OK) {
+        return Error;
+    }
+
+    *p_Bytes = Encoded.size;
+    ImageEncoder_Free(&Encoded);
+
+    return ESP_OK;
+}
+
+static esp_err_t Benchmark_Display(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    *p_Bytes = BENCHMARK_DST_WIDTH * BENCHMARK_DST_HEIGHT * sizeof(uint16_t);
+
+    return GUI_Task_FlushCanvas();
+}
+
+static esp_err_t Benchmark_SDWrite(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    FILE *File;
+    esp_err_t Error;
+
+    *p_Bytes = 0;
+
+    File = fopen(BENCHMARK_SD_FILE, "wb");
+    if (File == NULL) {
+        return ESP_FAIL;
+    }
+
+    Error = ESP_OK;
+    for (uint32_t i = 0; i < ((CONFIG_BENCHMARK_SD_SIZE_KB * 1024) / BENCHMARK_SD_CHUNK_SIZE); i++) {
+        if (fwrite(p_Context->Chunk, 1, BENCHMARK_SD_CHUNK_SIZE, File) != BENCHMARK_SD_CHUNK_SIZE) {
+            Error = ESP_FAIL;
+            break;
+        }
+
+        *p_Bytes += BENCHMARK_SD_CHUNK_SIZE;
+    }
+
+    /* The time includes the flush of the FAT and the directory entry */
+    if (fclose(File) != 0) {
+        Error = ESP_FAIL;
+    }
+
+    return Error;
+}
+
+static esp_err_t Benchmark_SDRead(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    FILE *File;
+    size_t Length;
+
+    *p_Bytes = 0;
+
+    File = fopen(BENCHMARK_SD_FILE, "rb");
+    if (File == NULL) {
+        return ESP_FAIL;
+    }
+
+    do {
+        Length = fread(p_Context->Chunk, 1, BENCHMARK_SD_CHUNK_SIZE, File);
+        *p_Bytes += Length;
+    } while (Length == BENCHMARK_SD_CHUNK_SIZE);
+
+    fclose(File);
+
+    return (*p_Bytes > 0) ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t Benchmark_CCI(Benchmark_Context_t *p_Context, uint32_t *p_Bytes)
+{
+    uint16_t FPA;
+    uint16_t AUX;
+
+    *p_Bytes = 0;
+
+    return Lepton_Task_ReadTemperature(&FPA, &AUX);
+}
+
+/** @brief              Run a benchmark after a warm up run and add the result to the report. The warm up fills the
+ *                      caches and triggers the lazy allocations.
+ *  @param p_Name       Name of the benchmark
+ *  @param Function     Benchmark function
+ *  @param p_Context    Benchmark context
+ *  @param Runs         Number of measured runs
+ */
+static void Benchmark_Measure(const char *p_Name, Benchmark_Function_t Function, Benchmark_Context_t *p_Context,
+                              uint32_t Runs)
+{
+    Benchmark_Result_t Result;
+    uint64_t Total;
+    uint32_t Bytes;
+
+    memset(&Result, 0, sizeof(Result));
+    strncpy(Result.Name, p_Name, sizeof(Result.Name) - 1);
+    Result.Best = UINT32_MAX;
+    Result.Cycles = UINT32_MAX;
+
+    Total = 0;
+    Result.Error = Function(p_Context, &Bytes);
+    for (uint32_t i = 0; (i < Runs) && (Result.Error == ESP_OK); i++) {
+        uint32_t Cycles;
+        uint32_t Time;
+        int64_t Start;
+
+        Start = esp_timer_get_time();
+        Cycles = esp_cpu_get_cycle_count();
+        Result.Error = Function(p_Context, &Bytes);
+        Cycles = esp_cpu_get_cycle_count() - Cycles;
+        Time = static_cast<uint32_t>(esp_timer_get_time() - Start);
+
+        Result.Runs++;
+        Total += Time;
+        Result.Bytes = Bytes;
+
+        if (Time < Result.Best) {
+            Result.Best = Time;
+        }
+
+        if (Time > Result.Worst) {
+            Result.Worst = Time;
+        }
+
+        /* The cycle counter wraps after about 17 s at 240 MHz */
+        if (Cycles < Result.Cycles) {
+            Result.Cycles = Cycles;
+        }
+    }
+
+    if (Result.Runs > 0) {
+        Result.Mean = Total / Result.Runs;
+    } else {
+        Result.Best = 0;
+        Result.Cycles = 0;
+    }
+
+    if (Result.Error == ESP_OK) {
+        ESP_LOGI(TAG, "%-20s %8lu cycles, best %7lu us, mean %7lu us, worst %7lu us", Result.Name, Result.Cycles,
+                 Result.Best, Result.Mean, Result.Worst);
+    } else {
+        ESP_LOGW(TAG, "%-20s failed after %lu runs: %d!", Result.Name, Result.Runs, Result.Error);
+    }
+
+    Benchmark_AddResult(&Result);
+
+    /* Gives the idle task the chance to feed the task watchdog */
+    vTaskDelay(1);
+}
+
+/** @brief          Append formatted text to a buffer.
+ *  @param p_Buffer Output buffer
+ *  @param Size     Size of the output buffer in bytes
+ *  @param p_Length Current length, set to -1 when the buffer is full
+ *  @param p_Format printf format
+ */
+static void Benchmark_Append(char *p_Buffer, size_t Size, int *p_Length, const char *p_Format, ...)
+{
+    va_list Args;
+    int Length;
+
+    if (*p_Length < 0) {
+        return;
+    }
+
+    va_start(Args, p_Format);
+    Length = vsnprintf(p_Buffer + *p_Length, Size - *p_Length, p_Format, Args);
+    va_end(Args);
+
+    if ((Length < 0) || (Length >= static_cast<int>(Size - *p_Length))) {
+        *p_Length = -1;
+    } else {
+        *p_Length += Length;
+    }
+}
+
+esp_err_t Benchmark_Run(void)
+{
+    Benchmark_Context_t *Context;
+    char *Report;
+    esp_err_t Error;
+
+    if (_Benchmark_State.Mutex == NULL) {
+        _Benchmark_State.Mutex = xSemaphoreCreateMutex();
+        if (_Benchmark_State.Mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    Context = reinterpret_cast<Benchmark_Context_t *>(heap_caps_malloc(sizeof(Benchmark_Context_t),
+                                                                        MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    if (Context == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    Error = Benchmark_Prepare(Context);
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to allocate the buffers!");
+
+        Benchmark_Release(Context);
+        heap_caps_free(Context);
+
+        return Error;
+    }
+
+    ESP_LOGI(TAG, "Running benchmarks with %u runs...", CONFIG_BENCHMARK_ITERATIONS);
+
+    /* Kernels in the order of the frame path: statistics, AGC, colorize, display and network */
+    Benchmark_Measure("frame_statistics", Benchmark_Statistics, Context, CONFIG_BENCHMARK_ITERATIONS);
+    Benchmark_Measure("palette_lut_rebuild", Benchmark_PaletteLUT, Context, CONFIG_BENCHMARK_ITERATIONS);
+    Benchmark_Measure("colorize_rgb565", Benchmark_Colorize, Context, CONFIG_BENCHMARK_ITERATIONS);
+    Benchmark_Measure("lepton_raw14_to_rgb", Benchmark_LeptonColorize, Context, CONFIG_BENCHMARK_ITERATIONS);
+    Benchmark_Measure("scale_raw14", Benchmark_ScaleRAW14, Context, CONFIG_BENCHMARK_ITERATIONS);
+    Benchmark_Measure("scale_rgb888", Benchmark_ScaleRGB888, Context, CONFIG_BENCHMARK_ITERATIONS);
+    Benchmark_Measure("rgb888_to_rgb565", Benchmark_ToRGB565, Context, CONFIG_BENCHMARK_ITERATIONS);
+    Benchmark_Measure("rgb565_to_rgb888", Benchmark_ToRGB888, Context, CONFIG_BENCHMARK_ITERATIONS);
+    Benchmark_Measure("tile_diff", Benchmark_TileDiff, Context, CONFIG_BENCHMARK_ITERATIONS);
+    Benchmark_Measure("raw_codec_intra", Benchmark_RawIntra, Context, CONFIG_BENCHMARK_ITERATIONS);
+    Benchmark_Measure("raw_codec_delta", Benchmark_RawDelta, Context, CONFIG_BENCHMARK_ITERATIONS);
+
+    /* The server initializes the encoder with the same quality later, a second init is ignored */
+    if (ImageEncoder_Init(80) == ESP_OK) {
+        static const uint8_t Qualities[] = {50, 80, 95};
+
+        for (uint8_t i = 0; i < (sizeof(Qualities) / sizeof(Qualities[0])); i++) {
+            char Name[sizeof(Benchmark_Result_t::Name)];
+
+            snprintf(Name, sizeof(Name), "jpeg_q%u", Qualities[i]);
+            Context->Quality = Qualities[i];
+            Benchmark_Measure(Name, Benchmark_JPEG, Context, BENCHMARK_SLOW_RUNS);
+        }
+    } else {
+        ESP_LOGW(TAG, "Image encoder not available, skipping JPEG!");
+    }
+
+    Benchmark_Measure("lcd_flush", Benchmark_Display, Context, BENCHMARK_SLOW_RUNS);
+
+    if (SDManager_isMounted()) {
+        Benchmark_Measure("sd_write", Benchmark_SDWrite, Context, BENCHMARK_SD_RUNS);
+        Benchmark_Measure("sd_read", Benchmark_SDRead, Context, BENCHMARK_SD_RUNS);
+
+        remove(BENCHMARK_SD_FILE);
+    } else {
+        ESP_LOGW(TAG, "No SD card, skipping SD card benchmarks!");
+    }
+
+    Benchmark_Measure("cci_read", Benchmark_CCI, Context, CONFIG_BENCHMARK_ITERATIONS);
+
+    Benchmark_Release(Context);
+    heap_caps_free(Context);
+
+    _Benchmark_State.Time = esp_timer_get_time();
+
+    /* One line, so the report can be grepped from a serial log */
+    Report = reinterpret_cast<char *>(heap_caps_malloc(BENCHMARK_REPORT_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+    if (Report != NULL) {
+        if (Benchmark_Format(Report, BENCHMARK_REPORT_SIZE) > 0) {
+            printf("BENCHMARK %s\n", Report);
+        }
+
+        heap_caps_free(Report);
+    }
+
+    ESP_LOGI(TAG, "Done. GET /api/v1/benchmark/wifi measures the Wi-Fi send throughput.");
+
+    return ESP_OK;
+}
+
+esp_err_t Benchmark_AddResult(const Benchmark_Result_t *p_Result)
+{
+    esp_err_t Error;
+    uint8_t Index;
+
+    if (p_Result == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_Benchmark_State.Mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(_Benchmark_State.Mutex, portMAX_DELAY);
+
+    for (Index = 0; Index < _Benchmark_State.Count; Index++) {
+        if (strcmp(_Benchmark_State.Results[Index].Name, p_Result->Name) == 0) {
+            break;
+        }
+    }
+
+    Error = ESP_OK;
+    if (Index < BENCHMARK_MAX_RESULTS) {
+        memcpy(&_Benchmark_State.Results[Index], p_Result, sizeof(Benchmark_Result_t));
+
+        if (Index == _Benchmark_State.Count) {
+            _Benchmark_State.Count++;
+        }
+    } else {
+        Error = ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreGive(_Benchmark_State.Mutex);
+
+    return Error;
+}
+
+int Benchmark_Format(char *p_Buffer, size_t Size)
+{
+    esp_chip_info_t Chip;
+    App_Settings_Info_t Info;
+    int Length;
+
+    if ((p_Buffer == NULL) || (_Benchmark_State.Mutex == NULL)) {
+        return -1;
+    }
+
+    esp_chip_info(&Chip);
+    memset(&Info, 0, sizeof(Info));
+    SettingsManager_GetInfo(&Info);
+
+    Length = 0;
+    Benchmark_Append(p_Buffer, Size, &Length,
+                     "{\"firmware\":\"%s\",\"serial\":%u,\"idf\":\"%s\",\"chip\":{\"model\":%d,\"revision\":%u,"
+                     "\"cores\":%u,\"cpu_mhz\":%u,\"psram\":%u},\"time_s\":%lu,\"results\":[",
+                     Info.FirmwareVersion, Info.Serial, esp_get_idf_version(), Chip.model, Chip.revision, Chip.cores,
+                     CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, esp_psram_get_size(),
+                     static_cast<uint32_t>(_Benchmark_State.Time / 1000000));
+
+    xSemaphoreTake(_Benchmark_State.Mutex, portMAX_DELAY);
+
+    for (uint8_t i = 0; i < _Benchmark_State.Count; i++) {
+        const Benchmark_Result_t *Result = &_Benchmark_State.Results[i];
+        float Throughput;
+
+        /* Bytes per us are MB/s */
+        Throughput = (Result->Best > 0) ? (static_cast<float>(Result->Bytes) / Result->Best) : 0.0f;
+
+        Benchmark_Append(p_Buffer, Size, &Length,
+                         "%s{\"name\":\"%s\",\"runs\":%lu,\"bytes\":%lu,\"cycles\":%lu,\"best_us\":%lu,"
+                         "\"mean_us\":%lu,\"worst_us\":%lu,\"mb_s\":%.2f,\"error\":%d}",
+                         (i > 0) ? "," : "", Result->Name, Result->Runs, Result->Bytes, Result->Cycles, Result->Best,
+                         Result->Mean, Result->Worst, Throughput, Result->Error);
+    }
+
+    xSemaphoreGive(_Benchmark_State.Mutex);
+
+    Benchmark_Append(p_Buffer, Size, &Length, "]}");
+
+    return Length;
+}
+
+#endif
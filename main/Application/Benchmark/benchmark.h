@@ -0,0 +1,84 @@
+/*
+ * benchmark.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: On-device benchmark suite of the benchmark firmware.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef BENCHMARK
+
+/** @brief Maximum number of results of a report.
+ */
+#define BENCHMARK_MAX_RESULTS               24
+
+/** @brief Buffer size for Benchmark_Format.
+ */
+#define BENCHMARK_REPORT_SIZE               (512 + (BENCHMARK_MAX_RESULTS * 192))
+
+/** @brief Result of one benchmark.
+ */
+typedef struct {
+    char Name[24];                              /**< Name of the benchmark, e.g. "scale_raw14". */
+    uint32_t Runs;                              /**< Number of measured runs. */
+    uint32_t Bytes;                             /**< Bytes processed or transferred per run, 0 if not applicable. */
+    uint32_t Cycles;                            /**< CPU cycles of the fastest run. */
+    uint32_t Best;                              /**< Fastest run in us. */
+    uint32_t Mean;                              /**< Mean run time in us. */
+    uint32_t Worst;                             /**< Slowest run in us. */
+    esp_err_t Error;                            /**< ESP_OK or the error that stopped the benchmark. */
+} Benchmark_Result_t;
+
+/** @brief  Run the benchmark suite: the per frame kernels on a synthetic frame, the JPEG encoder at several
+ *          qualities, the display transfer, sequential SD card writes and reads and the CCI latency. Must be
+ *          called after the init of the GUI, the SD card and the Lepton and before their tasks are started, so
+ *          the suite has the CPU, the SPI bus and the I2C bus for itself. The report is printed as a single
+ *          "BENCHMARK {...}" JSON line on the console.
+ *  @return ESP_OK on success
+ *          ESP_ERR_NO_MEM if the buffers can not be allocated
+ */
+esp_err_t Benchmark_Run(void);
+
+/** @brief          Add a result to the report or replace the result with the same name. Used for the benchmarks
+ *                  that need a client, like the Wi-Fi send throughput.
+ *  @param p_Result Result
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if p_Result is NULL
+ *                  ESP_ERR_NO_MEM if the report is full
+ */
+esp_err_t Benchmark_AddResult(const Benchmark_Result_t *p_Result);
+
+/** @brief          Write the report as JSON with the board, chip and ESP-IDF version, so reports of different
+ *                  boards and builds can be compared.
+ *  @param p_Buffer Output buffer (BENCHMARK_REPORT_SIZE bytes)
+ *  @param Size     Size of the output buffer
+ *  @return         Length of the report or -1 if it does not fit
+ */
+int Benchmark_Format(char *p_Buffer, size_t Size);
+
+#endif
+
+#endif /* BENCHMARK_H_ */
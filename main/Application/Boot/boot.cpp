@@ -0,0 +1,197 @@
+/*
+ * boot.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Parallel boot graph and boot phase timestamps.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/event_groups.h>
+
+#include <sdkconfig.h>
+
+#include "boot.h"
+
+/** @brief Context of a step task. Lives on the stack of Boot_Run, which waits for all steps.
+ */
+typedef struct {
+    const Boot_Step_t *p_Step;
+    uint32_t Bit;                               /**< BOOT_STEP() of the step. */
+    void *p_Arg;
+} Boot_Task_Context_t;
+
+typedef struct {
+    EventGroupHandle_t EventGroup;              /**< Done bits of the steps. Created once and kept, a step task may
+                                                     still return from xEventGroupSetBits when Boot_Run returns. */
+    int64_t Times[BOOT_PHASE_COUNT];            /**< Time of the phases in microseconds, 0 if not reached. */
+} Boot_State_t;
+
+static Boot_State_t _Boot_State;
+
+static portMUX_TYPE _Boot_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *_Boot_PhaseNames[BOOT_PHASE_COUNT] = {
+    "settings",
+    "devices",
+    "time",
+    "sd",
+    "gui",
+    "lepton",
+    "network",
+    "tasks",
+    "capture",
+    "first_frame",
+    "first_display",
+    "server",
+    "first_network",
+};
+
+static const char *TAG = "boot";
+
+/** @brief          Task of a boot step. Waits for the dependencies, runs the step and reports it as done.
+ *  @param p_Param  Pointer to the Boot_Task_Context_t of the step
+ */
+static void Boot_StepTask(void *p_Param)
+{
+    Boot_Task_Context_t *p_Context;
+    int64_t Start;
+
+    p_Context = reinterpret_cast<Boot_Task_Context_t *>(p_Param);
+
+    if (p_Context->p_Step->Dependencies != 0) {
+        xEventGroupWaitBits(_Boot_State.EventGroup, p_Context->p_Step->Dependencies, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+
+    Start = esp_timer_get_time();
+
+    p_Context->p_Step->Function(p_Context->p_Arg);
+
+    ESP_LOGD(TAG, "Step %s done on core %d in %lld ms", p_Context->p_Step->Name, xPortGetCoreID(),
+             (esp_timer_get_time() - Start) / 1000);
+
+    if (p_Context->p_Step->Phase >= 0) {
+        Boot_Mark(static_cast<Boot_Phase_t>(p_Context->p_Step->Phase));
+    }
+
+    /* The context must not be used after this call */
+    xEventGroupSetBits(_Boot_State.EventGroup, p_Context->Bit);
+
+    vTaskDelete(NULL);
+}
+
+esp_err_t Boot_Run(const Boot_Step_t *p_Steps, size_t Count, void *p_Arg)
+{
+    Boot_Task_Context_t Contexts[BOOT_MAX_STEPS];
+    uint32_t Started;
+
+    if ((p_Steps == NULL) || (Count == 0) || (Count > BOOT_MAX_STEPS)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* A step may only depend on the steps before it, so the graph has no cycles */
+    for (size_t i = 0; i < Count; i++) {
+        if ((p_Steps[i].Function == NULL) || ((p_Steps[i].Dependencies & ~(BOOT_STEP(i) - 1)) != 0)) {
+            ESP_LOGE(TAG, "Invalid boot step %u!", static_cast<unsigned int>(i));
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    if (_Boot_State.EventGroup == NULL) {
+        _Boot_State.EventGroup = xEventGroupCreate();
+        if (_Boot_State.EventGroup == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    xEventGroupClearBits(_Boot_State.EventGroup, BOOT_STEP(BOOT_MAX_STEPS) - 1);
+
+    Started = 0;
+    for (size_t i = 0; i < Count; i++) {
+        Contexts[i].p_Step = &p_Steps[i];
+        Contexts[i].Bit = BOOT_STEP(i);
+        Contexts[i].p_Arg = p_Arg;
+
+        if (xTaskCreatePinnedToCore(Boot_StepTask, p_Steps[i].Name, CONFIG_BOOT_TASK_STACKSIZE, &Contexts[i],
+                                    CONFIG_BOOT_TASK_PRIO, NULL, p_Steps[i].Core) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create boot task %s!", p_Steps[i].Name);
+
+            /* The steps that are already running have to finish before the contexts go out of scope */
+            break;
+        }
+
+        Started |= BOOT_STEP(i);
+    }
+
+    if (Started != 0) {
+        xEventGroupWaitBits(_Boot_State.EventGroup, Started, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+
+    return (Started == (BOOT_STEP(Count) - 1)) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void Boot_Mark(Boot_Phase_t Phase)
+{
+    int64_t Now;
+    bool isNew;
+
+    if ((Phase >= BOOT_PHASE_COUNT) || (_Boot_State.Times[Phase] != 0)) {
+        return;
+    }
+
+    Now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&_Boot_Lock);
+    isNew = (_Boot_State.Times[Phase] == 0);
+    if (isNew) {
+        _Boot_State.Times[Phase] = Now;
+    }
+    portEXIT_CRITICAL(&_Boot_Lock);
+
+    if (isNew) {
+        ESP_LOGI(TAG, "Boot phase %s reached after %lld ms", _Boot_PhaseNames[Phase], Now / 1000);
+    }
+}
+
+int64_t Boot_GetTime(Boot_Phase_t Phase)
+{
+    int64_t Time;
+
+    if (Phase >= BOOT_PHASE_COUNT) {
+        return -1;
+    }
+
+    portENTER_CRITICAL(&_Boot_Lock);
+    Time = _Boot_State.Times[Phase];
+    portEXIT_CRITICAL(&_Boot_Lock);
+
+    return (Time != 0) ? Time : -1;
+}
+
+const char *Boot_GetPhaseName(Boot_Phase_t Phase)
+{
+    if (Phase >= BOOT_PHASE_COUNT) {
+        return "unknown";
+    }
+
+    return _Boot_PhaseNames[Phase];
+}
@@ -0,0 +1,105 @@
+/*
+ * boot.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Parallel boot graph and boot phase timestamps.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef BOOT_H_
+#define BOOT_H_
+
+#include <esp_err.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** @brief Maximum number of steps of a boot graph (usable bits of a FreeRTOS event group).
+ */
+#define BOOT_MAX_STEPS                      24
+
+/** @brief Dependency mask of a single step.
+ */
+#define BOOT_STEP(Index)                    (1UL << (Index))
+
+/** @brief Boot phases. Every phase is timestamped once, when it is reached the first time.
+ */
+typedef enum {
+    BOOT_PHASE_SETTINGS = 0,                    /**< Settings loaded. */
+    BOOT_PHASE_DEVICES,                         /**< I2C, SPI, ADC, port expander and RTC ready. */
+    BOOT_PHASE_TIME,                            /**< System time set from the RTC. */
+    BOOT_PHASE_SD,                              /**< SD card mounted or found missing. */
+    BOOT_PHASE_GUI,                             /**< Display and UI initialized. */
+    BOOT_PHASE_LEPTON,                          /**< Camera found and frame pool allocated. */
+    BOOT_PHASE_NETWORK,                         /**< Network task initialized. */
+    BOOT_PHASE_TASKS,                           /**< All application tasks started. */
+    BOOT_PHASE_CAPTURE,                         /**< VoSPI capture started. */
+    BOOT_PHASE_FIRST_FRAME,                     /**< First frame published by the Lepton task. */
+    BOOT_PHASE_FIRST_DISPLAY,                   /**< First frame drawn on the display. */
+    BOOT_PHASE_SERVER,                          /**< HTTP server started. */
+    BOOT_PHASE_FIRST_NETWORK,                   /**< First frame sent to a network client. */
+    BOOT_PHASE_COUNT,
+} Boot_Phase_t;
+
+/** @brief          Function of a boot step. Errors of required components are handled inside the function.
+ *  @param p_Arg    Argument of Boot_Run
+ */
+typedef void (*Boot_Function_t)(void *p_Arg);
+
+/** @brief Step of a boot graph. Every step runs in a task of its own as soon as all its dependencies are done.
+ */
+typedef struct {
+    const char *Name;                           /**< Name of the step and its task. */
+    Boot_Function_t Function;                   /**< Function of the step. */
+    uint32_t Dependencies;                      /**< BOOT_STEP() mask of the steps that have to be done first. */
+    BaseType_t Core;                            /**< Core of the task. */
+    int8_t Phase;                               /**< Boot_Phase_t that is reached with the step, -1 for none. */
+} Boot_Step_t;
+
+/** @brief              Run a boot graph and wait until all steps are done. Steps without a dependency between
+ *                      them run in parallel on both cores.
+ *  @param p_Steps      Steps of the graph, dependencies refer to the index in this array
+ *  @param Count        Number of steps (max. BOOT_MAX_STEPS)
+ *  @param p_Arg        Argument for the step functions
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if the graph is invalid
+ *                      ESP_ERR_NO_MEM if the tasks can not be created
+ */
+esp_err_t Boot_Run(const Boot_Step_t *p_Steps, size_t Count, void *p_Arg);
+
+/** @brief          Timestamp a boot phase. Only the first call of a phase is recorded, so it can be called for
+ *                  every frame. Can be called from any task.
+ *  @param Phase    Boot phase
+ */
+void Boot_Mark(Boot_Phase_t Phase);
+
+/** @brief          Get the time of a boot phase.
+ *  @param Phase    Boot phase
+ *  @return         Time since the start of the application in microseconds, -1 if the phase was not reached
+ */
+int64_t Boot_GetTime(Boot_Phase_t Phase);
+
+/** @brief          Get the name of a boot phase.
+ *  @param Phase    Boot phase
+ *  @return         Name of the phase
+ */
+const char *Boot_GetPhaseName(Boot_Phase_t Phase);
+
+#endif /* BOOT_H_ */
@@ -0,0 +1,255 @@
+/*
+ * messageBus.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Typed in-process message bus with latest value topics and preallocated channels.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+#include <string.h>
+
+#include <sdkconfig.h>
+
+#include "messageBus.h"
+
+/** @brief Subscriber of a topic.
+ */
+typedef struct {
+    EventGroupHandle_t Group;
+    EventBits_t Bits;
+} Bus_Subscriber_t;
+
+/** @brief Latest value slot of a topic.
+ */
+typedef struct {
+    uint32_t Sequence;                          /**< Number of publishes, 0 if the topic has no value. */
+    uint8_t SubscriberCount;
+    Bus_Subscriber_t Subscribers[BUS_TOPIC_MAX_SUBSCRIBERS];
+    alignas(8) uint8_t Data[BUS_TOPIC_MAX_SIZE];
+} Bus_Slot_t;
+
+/** @brief Preallocated channel.
+ */
+typedef struct {
+    QueueHandle_t Queue;
+    StaticQueue_t Control;
+    uint8_t *p_Storage;
+    size_t MessageSize;
+    uint32_t Dropped;                           /**< Messages dropped because the channel was full. */
+} Bus_ChannelState_t;
+
+/* The value type of every topic, a publish or read with another size is rejected */
+static const size_t _Bus_TopicSize[BUS_TOPIC_COUNT] = {
+    [BUS_TOPIC_LEPTON_DEVICE] = sizeof(App_Lepton_Device_t),
+    [BUS_TOPIC_LEPTON_TEMPERATURES] = sizeof(App_Lepton_Temperatures_t),
+    [BUS_TOPIC_LEPTON_UPTIME] = sizeof(uint32_t),
+    [BUS_TOPIC_LEPTON_SPOTMETER] = sizeof(App_Lepton_ROI_Result_t),
+    [BUS_TOPIC_LEPTON_SCENE_STATISTICS] = sizeof(App_Lepton_ROI_Result_t),
+    [BUS_TOPIC_BATTERY] = sizeof(App_Devices_Battery_t),
+};
+
+static_assert(sizeof(App_Lepton_Device_t) <= BUS_TOPIC_MAX_SIZE, "Topic value too large!");
+
+static uint8_t _Bus_LeptonRequests[CONFIG_BUS_CHANNEL_DEPTH * sizeof(Bus_Request_t)];
+
+static Bus_Slot_t _Bus_Slots[BUS_TOPIC_COUNT];
+
+static Bus_ChannelState_t _Bus_Channels[BUS_CHANNEL_COUNT] = {
+    [BUS_CHANNEL_LEPTON_REQUEST] = {NULL, {}, _Bus_LeptonRequests, sizeof(Bus_Request_t), 0},
+};
+
+/* The values are small, so a copy inside the critical section is shorter than any blocking lock */
+static portMUX_TYPE _Bus_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *TAG = "bus";
+
+esp_err_t Bus_Init(void)
+{
+    for (uint8_t i = 0; i < BUS_CHANNEL_COUNT; i++) {
+        Bus_ChannelState_t *p_Channel = &_Bus_Channels[i];
+
+        if (p_Channel->Queue != NULL) {
+            continue;
+        }
+
+        p_Channel->Queue = xQueueCreateStatic(CONFIG_BUS_CHANNEL_DEPTH, p_Channel->MessageSize, p_Channel->p_Storage,
+                                              &p_Channel->Control);
+        if (p_Channel->Queue == NULL) {
+            ESP_LOGE(TAG, "Failed to create channel %u!", i);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t Bus_Publish(Bus_Topic_t Topic, const void *p_Data, size_t Size)
+{
+    Bus_Subscriber_t Subscribers[BUS_TOPIC_MAX_SUBSCRIBERS];
+    uint8_t Count;
+
+    if ((Topic >= BUS_TOPIC_COUNT) || (p_Data == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (Size != _Bus_TopicSize[Topic]) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    portENTER_CRITICAL(&_Bus_Lock);
+    memcpy(_Bus_Slots[Topic].Data, p_Data, Size);
+    _Bus_Slots[Topic].Sequence++;
+    Count = _Bus_Slots[Topic].SubscriberCount;
+    memcpy(Subscribers, _Bus_Slots[Topic].Subscribers, Count * sizeof(Bus_Subscriber_t));
+    portEXIT_CRITICAL(&_Bus_Lock);
+
+    /* Setting event bits never waits, a slow subscriber only reads a newer value */
+    for (uint8_t i = 0; i < Count; i++) {
+        xEventGroupSetBits(Subscribers[i].Group, Subscribers[i].Bits);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t Bus_Read(Bus_Topic_t Topic, void *p_Data, size_t Size, uint32_t *p_Sequence)
+{
+    uint32_t Sequence;
+
+    if ((Topic >= BUS_TOPIC_COUNT) || (p_Data == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (Size != _Bus_TopicSize[Topic]) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    portENTER_CRITICAL(&_Bus_Lock);
+    Sequence = _Bus_Slots[Topic].Sequence;
+    if (Sequence != 0) {
+        memcpy(p_Data, _Bus_Slots[Topic].Data, Size);
+    }
+    portEXIT_CRITICAL(&_Bus_Lock);
+
+    if (p_Sequence != NULL) {
+        *p_Sequence = Sequence;
+    }
+
+    return (Sequence != 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t Bus_Subscribe(Bus_Topic_t Topic, EventGroupHandle_t Group, EventBits_t Bits)
+{
+    Bus_Slot_t *p_Slot;
+    bool hasValue;
+
+    if ((Topic >= BUS_TOPIC_COUNT) || (Group == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    p_Slot = &_Bus_Slots[Topic];
+
+    portENTER_CRITICAL(&_Bus_Lock);
+    if (p_Slot->SubscriberCount >= BUS_TOPIC_MAX_SUBSCRIBERS) {
+        portEXIT_CRITICAL(&_Bus_Lock);
+
+        ESP_LOGE(TAG, "Too many subscribers of topic %u!", Topic);
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    p_Slot->Subscribers[p_Slot->SubscriberCount].Group = Group;
+    p_Slot->Subscribers[p_Slot->SubscriberCount].Bits = Bits;
+    p_Slot->SubscriberCount++;
+    hasValue = (p_Slot->Sequence != 0);
+    portEXIT_CRITICAL(&_Bus_Lock);
+
+    if (hasValue) {
+        xEventGroupSetBits(Group, Bits);
+    }
+
+    return ESP_OK;
+}
+
+void Bus_Unsubscribe(Bus_Topic_t Topic, EventGroupHandle_t Group)
+{
+    Bus_Slot_t *p_Slot;
+    uint8_t Count;
+
+    if (Topic >= BUS_TOPIC_COUNT) {
+        return;
+    }
+
+    p_Slot = &_Bus_Slots[Topic];
+
+    portENTER_CRITICAL(&_Bus_Lock);
+    Count = 0;
+    for (uint8_t i = 0; i < p_Slot->SubscriberCount; i++) {
+        if (p_Slot->Subscribers[i].Group != Group) {
+            p_Slot->Subscribers[Count++] = p_Slot->Subscribers[i];
+        }
+    }
+    p_Slot->SubscriberCount = Count;
+    portEXIT_CRITICAL(&_Bus_Lock);
+}
+
+esp_err_t Bus_Send(Bus_Channel_t Channel, const void *p_Message)
+{
+    Bus_ChannelState_t *p_Channel;
+    uint32_t Dropped;
+
+    if ((Channel >= BUS_CHANNEL_COUNT) || (p_Message == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    p_Channel = &_Bus_Channels[Channel];
+    if (p_Channel->Queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (xQueueSend(p_Channel->Queue, p_Message, 0) == pdTRUE) {
+        return ESP_OK;
+    }
+
+    portENTER_CRITICAL(&_Bus_Lock);
+    Dropped = ++p_Channel->Dropped;
+    portEXIT_CRITICAL(&_Bus_Lock);
+
+    ESP_LOGW(TAG, "Channel %u full, %lu messages dropped!", Channel, static_cast<unsigned long>(Dropped));
+
+    return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t Bus_Request(int32_t ID)
+{
+    Bus_Request_t Request;
+
+    memset(&Request, 0, sizeof(Request));
+    Request.ID = ID;
+
+    return Bus_Send(BUS_CHANNEL_LEPTON_REQUEST, &Request);
+}
+
+bool Bus_Receive(Bus_Channel_t Channel, void *p_Message, TickType_t Timeout)
+{
+    if ((Channel >= BUS_CHANNEL_COUNT) || (p_Message == NULL) || (_Bus_Channels[Channel].Queue == NULL)) {
+        return false;
+    }
+
+    return xQueueReceive(_Bus_Channels[Channel].Queue, p_Message, Timeout) == pdTRUE;
+}
@@ -0,0 +1,145 @@
+/*
+ * messageBus.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Typed in-process message bus with latest value topics and preallocated channels.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef MESSAGE_BUS_H_
+#define MESSAGE_BUS_H_
+
+#include <esp_err.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "Application/application.h"
+
+/** @brief Maximum size of a topic value in bytes.
+ */
+#define BUS_TOPIC_MAX_SIZE                      64
+
+/** @brief Maximum number of subscribers of a topic.
+ */
+#define BUS_TOPIC_MAX_SUBSCRIBERS               4
+
+/** @brief Latest value topics. A topic only keeps its newest value, a publish overwrites it and never blocks.
+ */
+typedef enum {
+    BUS_TOPIC_LEPTON_DEVICE = 0,                /**< Part and serial number of the camera, App_Lepton_Device_t.
+                                                     Published once when the camera is ready. */
+    BUS_TOPIC_LEPTON_TEMPERATURES,              /**< FPA and AUX temperature, App_Lepton_Temperatures_t. */
+    BUS_TOPIC_LEPTON_UPTIME,                    /**< Camera uptime in ms, uint32_t. */
+    BUS_TOPIC_LEPTON_SPOTMETER,                 /**< Spotmeter result, App_Lepton_ROI_Result_t. */
+    BUS_TOPIC_LEPTON_SCENE_STATISTICS,          /**< Scene statistics, App_Lepton_ROI_Result_t. */
+    BUS_TOPIC_BATTERY,                          /**< Battery reading, App_Devices_Battery_t. */
+    BUS_TOPIC_COUNT,
+} Bus_Topic_t;
+
+/** @brief Channels with a fixed number of preallocated messages. A message that does not fit is dropped.
+ */
+typedef enum {
+    BUS_CHANNEL_LEPTON_REQUEST = 0,             /**< Requests to the Lepton task, Bus_Request_t. */
+    BUS_CHANNEL_COUNT,
+} Bus_Channel_t;
+
+/** @brief Request message of BUS_CHANNEL_LEPTON_REQUEST.
+ */
+typedef struct {
+    int32_t ID;                                 /**< GUI_EVENT_REQUEST_* identifier. */
+    union {
+        App_Settings_ROI_t ROI;                 /**< ROI for GUI_EVENT_REQUEST_ROI. */
+        uint16_t Emissivity;                    /**< Emissivity (multiplied by 100) for GUI_EVENT_REQUEST_EMISSIVITY. */
+    } Data;
+} Bus_Request_t;
+
+/** @brief  Create the channels. Topics can be used without it.
+ *  @return ESP_OK on success
+ */
+esp_err_t Bus_Init(void);
+
+/** @brief          Set the value of a topic and wake up its subscribers. Never blocks, the value is copied once
+ *                  into the slot of the topic instead of a queue and a handler. Must not be called from an ISR.
+ *  @param Topic    Topic
+ *  @param p_Data   Value
+ *  @param Size     Size of the value, must match the type of the topic
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if the topic or p_Data is invalid
+ *                  ESP_ERR_INVALID_SIZE if Size does not match the topic
+ */
+esp_err_t Bus_Publish(Bus_Topic_t Topic, const void *p_Data, size_t Size);
+
+/** @brief              Get the latest value of a topic.
+ *  @param Topic        Topic
+ *  @param p_Data       Pointer to store the value
+ *  @param Size         Size of the value, must match the type of the topic
+ *  @param p_Sequence   Optional pointer to store the number of publishes of the topic
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if the topic or p_Data is invalid
+ *                      ESP_ERR_INVALID_SIZE if Size does not match the topic
+ *                      ESP_ERR_NOT_FOUND if the topic was never published
+ */
+esp_err_t Bus_Read(Bus_Topic_t Topic, void *p_Data, size_t Size, uint32_t *p_Sequence);
+
+/** @brief          Set event bits of a task with every publish of a topic. The bits are set right away when the
+ *                  topic has a value already, so a subscriber never misses a one time publish.
+ *  @param Topic    Topic
+ *  @param Group    Event group of the subscriber
+ *  @param Bits     Bits to set
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if the topic or the group is invalid
+ *                  ESP_ERR_NO_MEM if the topic has BUS_TOPIC_MAX_SUBSCRIBERS subscribers
+ */
+esp_err_t Bus_Subscribe(Bus_Topic_t Topic, EventGroupHandle_t Group, EventBits_t Bits);
+
+/** @brief          Remove all subscriptions of an event group from a topic.
+ *  @param Topic    Topic
+ *  @param Group    Event group of the subscriber
+ */
+void Bus_Unsubscribe(Bus_Topic_t Topic, EventGroupHandle_t Group);
+
+/** @brief              Send a message to a channel. Never blocks, a full channel drops the message.
+ *  @param Channel      Channel
+ *  @param p_Message    Message with the type of the channel
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if the channel or p_Message is invalid
+ *                      ESP_ERR_INVALID_STATE if the bus is not initialized
+ *                      ESP_ERR_TIMEOUT if the channel is full
+ */
+esp_err_t Bus_Send(Bus_Channel_t Channel, const void *p_Message);
+
+/** @brief      Send a request without data to the Lepton task.
+ *  @param ID   GUI_EVENT_REQUEST_* identifier
+ *  @return     ESP_OK on success, see Bus_Send
+ */
+esp_err_t Bus_Request(int32_t ID);
+
+/** @brief              Receive a message from a channel. Only one task may receive from a channel.
+ *  @param Channel      Channel
+ *  @param p_Message    Pointer to store the message
+ *  @param Timeout      Maximum wait time in ticks
+ *  @return             true when a message was received
+ */
+bool Bus_Receive(Bus_Channel_t Channel, void *p_Message, TickType_t Timeout);
+
+#endif /* MESSAGE_BUS_H_ */
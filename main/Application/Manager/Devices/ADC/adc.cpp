@@ -19,43 +19,190 @@
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <sdkconfig.h>
+
 #include <esp_log.h>
-#include <esp_adc/adc_oneshot.h>
 #include <esp_adc/adc_cali.h>
 #include <esp_adc/adc_cali_scheme.h>
 
+#ifdef CONFIG_DEVICES_ADC_CONTINUOUS
+#include <esp_adc/adc_continuous.h>
+#else
+#include <esp_adc/adc_oneshot.h>
+#endif
+
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/event_groups.h>
 #include <freertos/semphr.h>
 
+#include <string.h>
+
 #include "adc.h"
 #include "../PortExpander/portexpander.h"
 
-#include <sdkconfig.h>
+#define ADC_BATTERY_UNIT                    ADC_UNIT_1
+#define ADC_BATTERY_CHANNEL                 ADC_CHANNEL_0
+#define ADC_BATTERY_ATTEN                   ADC_ATTEN_DB_0
+
+#ifdef CONFIG_DEVICES_ADC_CONTINUOUS
+/** @brief Size of the DMA frame of one measurement.
+ */
+#define ADC_FRAME_SIZE                      (CONFIG_DEVICES_ADC_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES)
+
+/** @brief Maximum time for a burst in milliseconds. A burst of 256 samples takes 420 ms at the lowest rate.
+ */
+#define ADC_READ_TIMEOUT_MS                 500
+#endif
 
 static bool _ADC_Calib_Done = false;
 
 static adc_cali_handle_t _ADC_Calib_Handle;
+
+#ifdef CONFIG_DEVICES_ADC_CONTINUOUS
+static adc_continuous_handle_t _ADC_Handle;
+
+/* Only used by the devices task */
+static uint8_t _ADC_Frame[ADC_FRAME_SIZE];
+static uint16_t _ADC_Samples[CONFIG_DEVICES_ADC_SAMPLES];
+#else
 static adc_oneshot_unit_handle_t _ADC_Handle;
 static adc_oneshot_unit_init_cfg_t _ADC_Init_Config = {
-    .unit_id = ADC_UNIT_1,
+    .unit_id = ADC_BATTERY_UNIT,
     .clk_src = ADC_RTC_CLK_SRC_RC_FAST,
     .ulp_mode = ADC_ULP_MODE_DISABLE,
 };
 static adc_oneshot_chan_cfg_t config = {
-    .atten = ADC_ATTEN_DB_0,
+    .atten = ADC_BATTERY_ATTEN,
     .bitwidth = ADC_BITWIDTH_DEFAULT,
 };
+#endif
 
 const char *TAG = "ADC";
 
+#ifdef CONFIG_DEVICES_ADC_CONTINUOUS
+/** @brief  Create the continuous mode driver for the battery channel.
+ *  @return ESP_OK on success
+ */
+static esp_err_t ADC_InitContinuous(void)
+{
+    esp_err_t Error;
+    adc_continuous_handle_cfg_t HandleConfig;
+    adc_continuous_config_t Config;
+    adc_digi_pattern_config_t Pattern;
+
+    memset(&HandleConfig, 0, sizeof(HandleConfig));
+    HandleConfig.max_store_buf_size = ADC_FRAME_SIZE;
+    HandleConfig.conv_frame_size = ADC_FRAME_SIZE;
+    HandleConfig.flags.flush_pool = true;
+
+    Error = adc_continuous_new_handle(&HandleConfig, &_ADC_Handle);
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create continuous driver: %d!", Error);
+        return Error;
+    }
+
+    memset(&Pattern, 0, sizeof(Pattern));
+    Pattern.atten = ADC_BATTERY_ATTEN;
+    Pattern.channel = ADC_BATTERY_CHANNEL;
+    Pattern.unit = ADC_BATTERY_UNIT;
+    Pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+
+    memset(&Config, 0, sizeof(Config));
+    Config.pattern_num = 1;
+    Config.adc_pattern = &Pattern;
+    Config.sample_freq_hz = CONFIG_DEVICES_ADC_SAMPLE_FREQ;
+    Config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    Config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+
+    Error = adc_continuous_config(_ADC_Handle, &Config);
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure continuous driver: %d!", Error);
+
+        adc_continuous_deinit(_ADC_Handle);
+        _ADC_Handle = NULL;
+    }
+
+    return Error;
+}
+
+/** @brief          Sample a burst with the DMA and average the median half of it.
+ *  @param p_Raw    Pointer to store the raw value
+ *  @return         ESP_OK on success
+ */
+static esp_err_t ADC_ReadBurst(int *p_Raw)
+{
+    esp_err_t Error;
+    uint32_t Length;
+    uint32_t Count;
+    uint32_t Sum;
+
+    /* Samples from the last burst must not end up in this one */
+    adc_continuous_flush_pool(_ADC_Handle);
+
+    Error = adc_continuous_start(_ADC_Handle);
+    if (Error != ESP_OK) {
+        return Error;
+    }
+
+    Length = 0;
+    Error = adc_continuous_read(_ADC_Handle, _ADC_Frame, ADC_FRAME_SIZE, &Length, ADC_READ_TIMEOUT_MS);
+
+    adc_continuous_stop(_ADC_Handle);
+
+    if (Error != ESP_OK) {
+        return Error;
+    }
+
+    /* Sorted by insertion, the burst is small */
+    Count = 0;
+    for (uint32_t i = 0; (i + SOC_ADC_DIGI_RESULT_BYTES) <= Length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        adc_digi_output_data_t *p_Data;
+        uint16_t Value;
+        uint32_t j;
+
+        p_Data = reinterpret_cast<adc_digi_output_data_t *>(&_ADC_Frame[i]);
+        if (p_Data->type2.channel != ADC_BATTERY_CHANNEL) {
+            continue;
+        }
+
+        Value = p_Data->type2.data;
+        for (j = Count; (j > 0) && (_ADC_Samples[j - 1] > Value); j--) {
+            _ADC_Samples[j] = _ADC_Samples[j - 1];
+        }
+        _ADC_Samples[j] = Value;
+        Count++;
+    }
+
+    if (Count == 0) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    /* Drop the lowest and the highest quarter */
+    Sum = 0;
+    for (uint32_t i = Count / 4; i < (Count - (Count / 4)); i++) {
+        Sum += _ADC_Samples[i];
+    }
+
+    *p_Raw = Sum / (Count - (2 * (Count / 4)));
+
+    return ESP_OK;
+}
+#endif
+
 esp_err_t ADC_Init(void)
 {
     esp_err_t Error;
 
+#ifdef CONFIG_DEVICES_ADC_CONTINUOUS
+    Error = ADC_InitContinuous();
+    if (Error != ESP_OK) {
+        return Error;
+    }
+#else
     ESP_ERROR_CHECK(adc_oneshot_new_unit(&_ADC_Init_Config, &_ADC_Handle));
-    ESP_ERROR_CHECK(adc_oneshot_config_channel(_ADC_Handle, ADC_CHANNEL_0, &config));
+    ESP_ERROR_CHECK(adc_oneshot_config_channel(_ADC_Handle, ADC_BATTERY_CHANNEL, &config));
+#endif
 
     Error = ESP_OK;
     _ADC_Calib_Done = false;
@@ -63,9 +210,9 @@ esp_err_t ADC_Init(void)
     if (_ADC_Calib_Done == false) {
         ESP_LOGD(TAG, "calibration scheme version is %s", "Curve Fitting");
         adc_cali_curve_fitting_config_t CaliConfig = {
-            .unit_id = _ADC_Init_Config.unit_id,
-            .chan = ADC_CHANNEL_0,
-            .atten = config.atten,
+            .unit_id = ADC_BATTERY_UNIT,
+            .chan = ADC_BATTERY_CHANNEL,
+            .atten = ADC_BATTERY_ATTEN,
             .bitwidth = ADC_BITWIDTH_DEFAULT,
         };
 
@@ -91,7 +238,14 @@ esp_err_t ADC_Init(void)
 
 esp_err_t ADC_Deinit(void)
 {
+#ifdef CONFIG_DEVICES_ADC_CONTINUOUS
+    if (_ADC_Handle != NULL) {
+        adc_continuous_deinit(_ADC_Handle);
+        _ADC_Handle = NULL;
+    }
+#else
     ESP_ERROR_CHECK(adc_oneshot_del_unit(_ADC_Handle));
+#endif
 
     if (_ADC_Calib_Done) {
         return adc_cali_delete_scheme_curve_fitting(_ADC_Calib_Handle);
@@ -108,7 +262,17 @@ esp_err_t ADC_ReadBattery(int *p_Voltage)
         return ESP_ERR_INVALID_ARG;
     }
 
-    ESP_ERROR_CHECK(adc_oneshot_read(_ADC_Handle, ADC_CHANNEL_0, &Raw));
+#ifdef CONFIG_DEVICES_ADC_CONTINUOUS
+    esp_err_t Error;
+
+    Error = ADC_ReadBurst(&Raw);
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to sample the battery voltage: %d!", Error);
+        return Error;
+    }
+#else
+    ESP_ERROR_CHECK(adc_oneshot_read(_ADC_Handle, ADC_BATTERY_CHANNEL, &Raw));
+#endif
 
     if (_ADC_Calib_Done) {
         ESP_ERROR_CHECK(adc_cali_raw_to_voltage(_ADC_Calib_Handle, Raw, p_Voltage));
@@ -116,8 +280,8 @@ esp_err_t ADC_ReadBattery(int *p_Voltage)
         *p_Voltage = Raw;
     }
 
-    ESP_LOGD(TAG, "ADC%d Channel%d raw data: %d", ADC_UNIT_1, ADC_CHANNEL_0, Raw);
-    ESP_LOGD(TAG, "ADC%d Channel%d cali voltage: %d mV", ADC_UNIT_1, ADC_CHANNEL_0, *p_Voltage);
+    ESP_LOGD(TAG, "ADC%d Channel%d raw data: %d", ADC_BATTERY_UNIT, ADC_BATTERY_CHANNEL, Raw);
+    ESP_LOGD(TAG, "ADC%d Channel%d cali voltage: %d mV", ADC_BATTERY_UNIT, ADC_BATTERY_CHANNEL, *p_Voltage);
 
     return ESP_OK;
-}
\ No newline at end of file
+}
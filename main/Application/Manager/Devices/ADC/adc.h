@@ -29,10 +29,24 @@
 
 #include <esp_err.h>
 
+/** @brief  Initialize the ADC for the battery channel in the mode of CONFIG_DEVICES_ADC_ONESHOT or
+ *          CONFIG_DEVICES_ADC_CONTINUOUS.
+ *  @return ESP_OK on success
+ */
 esp_err_t ADC_Init(void);
 
+/** @brief  Deinitialize the ADC.
+ *  @return ESP_OK on success
+ */
 esp_err_t ADC_Deinit(void);
 
+/** @brief              Measure the voltage of the battery channel. In continuous mode a burst of
+ *                      CONFIG_DEVICES_ADC_SAMPLES conversions is sampled by the DMA and the median half of it is
+ *                      averaged, so single outliers are removed.
+ *  @param p_Voltage    Pointer to store the voltage at the ADC pin in mV (raw value without calibration)
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_TIMEOUT if the DMA did not deliver the samples
+ */
 esp_err_t ADC_ReadBattery(int *p_Voltage);
 
 #endif /* ADC_H_ */
\ No newline at end of file
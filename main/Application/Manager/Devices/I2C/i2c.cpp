@@ -22,12 +22,15 @@
  */
 
 #include <esp_log.h>
+#include <esp_timer.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/event_groups.h>
 #include <freertos/semphr.h>
 
+#include <string.h>
+
 #include "i2c.h"
 
 #include <sdkconfig.h>
@@ -35,11 +38,173 @@
 #define I2C_READ_ADDR(Addr)                 ((Addr << 0x01) | I2C_MASTER_READ)
 #define I2C_WRITE_ADDR(Addr)                ((Addr << 0x01) | I2C_MASTER_WRITE)
 #define I2C_WAIT                            100 / portTICK_PERIOD_MS
+#define I2C_MAX_DEVICES                     4
+#define I2C_MAX_WAITERS                     8
+
+/** @brief Bus priority of a device.
+ */
+typedef struct {
+    i2c_master_dev_handle_t Handle;
+    I2CM_Priority_t Priority;
+} I2CM_Device_t;
 
-static SemaphoreHandle_t _I2C_Mutex;
+typedef struct {
+    SemaphoreHandle_t Lock;                     /**< Protects the arbitration, only held for the bookkeeping. */
+    SemaphoreHandle_t Grant[I2CM_PRIORITY_COUNT];   /**< Hand over of the bus to a waiting task of a priority. */
+    bool isBusy;
+    TaskHandle_t Owner;                         /**< NULL while the bus is handed over. */
+    uint8_t Nesting;
+    bool isRaised;                              /**< The task priority of the owner was raised by a waiter. */
+    UBaseType_t BasePriority;                   /**< Task priority of the owner when it took the bus. */
+    uint8_t Waiting[I2CM_PRIORITY_COUNT];
+    I2CM_Device_t Devices[I2C_MAX_DEVICES];
+    uint8_t DeviceCount;
+    int64_t StartTime;                          /**< Time of I2CM_Init in us. */
+    I2CM_Counters_t Counters[I2CM_PRIORITY_COUNT];
+} I2CM_State_t;
+
+static I2CM_State_t _I2CM_State;
+
+/* Counters and device table, updated during transfers without the arbitration lock */
+static portMUX_TYPE _I2CM_Spinlock = portMUX_INITIALIZER_UNLOCKED;
 
 static const char *TAG                      = "I2C";
 
+/** @brief          Make the calling task the owner of the bus. Needs the arbitration lock.
+ *  @param Base     Task priority of the caller before it took the arbitration lock
+ */
+static void I2CM_TakeOwnership(UBaseType_t Base)
+{
+    _I2CM_State.isBusy = true;
+    _I2CM_State.Owner = xTaskGetCurrentTaskHandle();
+    _I2CM_State.Nesting = 1;
+    _I2CM_State.isRaised = false;
+    _I2CM_State.BasePriority = Base;
+}
+
+/** @brief          Take the bus. Waits until all transfers of higher priorities are done.
+ *  @param Priority Bus priority
+ *  @return         ESP_OK when successful
+ *                  ESP_ERR_INVALID_STATE when the I2C interface isn´t initialized
+ */
+static esp_err_t I2CM_Acquire(I2CM_Priority_t Priority)
+{
+    UBaseType_t Base;
+    int64_t Start;
+    uint32_t Wait;
+
+    if (_I2CM_State.Lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* Read before the arbitration lock can raise the priority of the caller */
+    Base = uxTaskPriorityGet(NULL);
+
+    xSemaphoreTake(_I2CM_State.Lock, portMAX_DELAY);
+
+    if (_I2CM_State.isBusy && (_I2CM_State.Owner == xTaskGetCurrentTaskHandle())) {
+        _I2CM_State.Nesting++;
+        xSemaphoreGive(_I2CM_State.Lock);
+
+        return ESP_OK;
+    } else if (_I2CM_State.isBusy == false) {
+        I2CM_TakeOwnership(Base);
+        xSemaphoreGive(_I2CM_State.Lock);
+
+        return ESP_OK;
+    }
+
+    /* Priority inheritance: a preempted low priority owner would otherwise block the waiting task */
+    if ((_I2CM_State.Owner != NULL) && (uxTaskPriorityGet(_I2CM_State.Owner) < Base)) {
+        vTaskPrioritySet(_I2CM_State.Owner, Base);
+        _I2CM_State.isRaised = true;
+    }
+
+    _I2CM_State.Waiting[Priority]++;
+    Start = esp_timer_get_time();
+    xSemaphoreGive(_I2CM_State.Lock);
+
+    /* The bus is handed over by the releasing task, so no other task can take it in between */
+    xSemaphoreTake(_I2CM_State.Grant[Priority], portMAX_DELAY);
+
+    Wait = static_cast<uint32_t>(esp_timer_get_time() - Start);
+
+    xSemaphoreTake(_I2CM_State.Lock, portMAX_DELAY);
+    I2CM_TakeOwnership(Base);
+    xSemaphoreGive(_I2CM_State.Lock);
+
+    portENTER_CRITICAL(&_I2CM_Spinlock);
+    _I2CM_State.Counters[Priority].Waits++;
+    _I2CM_State.Counters[Priority].WaitTime += Wait;
+    if (Wait > _I2CM_State.Counters[Priority].MaxWaitTime) {
+        _I2CM_State.Counters[Priority].MaxWaitTime = Wait;
+    }
+    portEXIT_CRITICAL(&_I2CM_Spinlock);
+
+    return ESP_OK;
+}
+
+/** @brief Release the bus. Hands it over to the highest waiting priority.
+ */
+static void I2CM_Release(void)
+{
+    xSemaphoreTake(_I2CM_State.Lock, portMAX_DELAY);
+
+    if ((_I2CM_State.isBusy == false) || (_I2CM_State.Owner != xTaskGetCurrentTaskHandle())) {
+        xSemaphoreGive(_I2CM_State.Lock);
+        ESP_LOGW(TAG, "Bus released by a task which does not own it!");
+
+        return;
+    }
+
+    _I2CM_State.Nesting--;
+    if (_I2CM_State.Nesting > 0) {
+        xSemaphoreGive(_I2CM_State.Lock);
+
+        return;
+    }
+
+    if (_I2CM_State.isRaised) {
+        vTaskPrioritySet(NULL, _I2CM_State.BasePriority);
+        _I2CM_State.isRaised = false;
+    }
+
+    _I2CM_State.Owner = NULL;
+    _I2CM_State.isBusy = false;
+
+    for (uint8_t i = 0; i < I2CM_PRIORITY_COUNT; i++) {
+        if (_I2CM_State.Waiting[i] > 0) {
+            _I2CM_State.Waiting[i]--;
+            _I2CM_State.isBusy = true;
+            xSemaphoreGive(_I2CM_State.Grant[i]);
+
+            break;
+        }
+    }
+
+    xSemaphoreGive(_I2CM_State.Lock);
+}
+
+/** @brief          Get the bus priority of a device.
+ *  @param Handle   I2C device handle
+ *  @return         Bus priority
+ */
+static I2CM_Priority_t I2CM_GetPriority(i2c_master_dev_handle_t Handle)
+{
+    I2CM_Priority_t Priority = I2CM_PRIORITY_NORMAL;
+
+    portENTER_CRITICAL(&_I2CM_Spinlock);
+    for (uint8_t i = 0; i < _I2CM_State.DeviceCount; i++) {
+        if (_I2CM_State.Devices[i].Handle == Handle) {
+            Priority = _I2CM_State.Devices[i].Priority;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&_I2CM_Spinlock);
+
+    return Priority;
+}
+
 /** @brief                  Initialize I2C master bus.
  *  @param p_Config         Pointer to I2C bus configuration
  *  @param p_Bus_Handle     Pointer to store bus handle
@@ -47,11 +212,24 @@ static const char *TAG                      = "I2C";
  */
 int32_t I2CM_Init(i2c_master_bus_config_t *p_Config, i2c_master_bus_handle_t *p_Bus_Handle)
 {
-    _I2C_Mutex = xSemaphoreCreateMutex();
-    if (_I2C_Mutex == NULL) {
-        ESP_LOGE(TAG, "Failed to create I2C mutex!");
-        return ESP_ERR_NO_MEM;
+    memset(&_I2CM_State, 0, sizeof(_I2CM_State));
+
+    _I2CM_State.Lock = xSemaphoreCreateMutex();
+    for (uint8_t i = 0; i < I2CM_PRIORITY_COUNT; i++) {
+        _I2CM_State.Grant[i] = xSemaphoreCreateCounting(I2C_MAX_WAITERS, 0);
+    }
+
+    for (uint8_t i = 0; i < I2CM_PRIORITY_COUNT; i++) {
+        if ((_I2CM_State.Lock == NULL) || (_I2CM_State.Grant[i] == NULL)) {
+            ESP_LOGE(TAG, "Failed to create I2C arbitration!");
+            I2CM_Deinit(NULL);
+
+            return ESP_ERR_NO_MEM;
+        }
     }
+
+    _I2CM_State.StartTime = esp_timer_get_time();
+
     return i2c_new_master_bus(p_Config, p_Bus_Handle);
 }
 
@@ -61,10 +239,135 @@ int32_t I2CM_Init(i2c_master_bus_config_t *p_Config, i2c_master_bus_handle_t *p_
  */
 int32_t I2CM_Deinit(i2c_master_bus_handle_t Bus_Handle)
 {
-    vSemaphoreDelete(_I2C_Mutex);
+    if (_I2CM_State.Lock != NULL) {
+        vSemaphoreDelete(_I2CM_State.Lock);
+        _I2CM_State.Lock = NULL;
+    }
+
+    for (uint8_t i = 0; i < I2CM_PRIORITY_COUNT; i++) {
+        if (_I2CM_State.Grant[i] != NULL) {
+            vSemaphoreDelete(_I2CM_State.Grant[i]);
+            _I2CM_State.Grant[i] = NULL;
+        }
+    }
+
+    _I2CM_State.DeviceCount = 0;
+
+    if (Bus_Handle == NULL) {
+        return ESP_OK;
+    }
+
     return i2c_del_master_bus(Bus_Handle);
 }
 
+esp_err_t I2CM_SetPriority(i2c_master_dev_handle_t Handle, I2CM_Priority_t Priority)
+{
+    esp_err_t Error = ESP_ERR_NO_MEM;
+
+    if ((Handle == NULL) || (Priority >= I2CM_PRIORITY_COUNT)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&_I2CM_Spinlock);
+    for (uint8_t i = 0; i < _I2CM_State.DeviceCount; i++) {
+        if (_I2CM_State.Devices[i].Handle == Handle) {
+            _I2CM_State.Devices[i].Priority = Priority;
+            Error = ESP_OK;
+            break;
+        }
+    }
+
+    if ((Error != ESP_OK) && (_I2CM_State.DeviceCount < I2C_MAX_DEVICES)) {
+        _I2CM_State.Devices[_I2CM_State.DeviceCount].Handle = Handle;
+        _I2CM_State.Devices[_I2CM_State.DeviceCount].Priority = Priority;
+        _I2CM_State.DeviceCount++;
+        Error = ESP_OK;
+    }
+    portEXIT_CRITICAL(&_I2CM_Spinlock);
+
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Device table full!");
+    }
+
+    return Error;
+}
+
+esp_err_t I2CM_Lock(I2CM_Priority_t Priority)
+{
+    if (Priority >= I2CM_PRIORITY_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return I2CM_Acquire(Priority);
+}
+
+void I2CM_Unlock(void)
+{
+    I2CM_Release();
+}
+
+int32_t I2CM_Transfer(i2c_master_dev_handle_t *p_Dev_Handle, I2CM_Priority_t Priority, const uint8_t *p_Write,
+                      uint32_t WriteLength, uint8_t *p_Read, uint32_t ReadLength)
+{
+    esp_err_t Error;
+    int64_t Start;
+    uint32_t Duration;
+
+    if ((p_Dev_Handle == NULL) || (*p_Dev_Handle == NULL) || (Priority >= I2CM_PRIORITY_COUNT) ||
+        ((WriteLength > 0) && (p_Write == NULL)) || ((ReadLength > 0) && (p_Read == NULL))) {
+        ESP_LOGE(TAG, "I2C Transfer: Invalid handle or data pointer");
+        return ESP_ERR_INVALID_ARG;
+    } else if ((WriteLength == 0) && (ReadLength == 0)) {
+        return ESP_OK;
+    }
+
+    ESP_LOGD(TAG, "Write %u bytes:", static_cast<unsigned int>(WriteLength));
+    for (uint32_t i = 0; i < WriteLength; i++) {
+        ESP_LOGD(TAG, "     Byte %u: 0x%02X", static_cast<unsigned int>(i), *(p_Write + i));
+    }
+
+    Error = I2CM_Acquire(Priority);
+    if (Error != ESP_OK) {
+        return Error;
+    }
+
+    Start = esp_timer_get_time();
+
+    if ((WriteLength > 0) && (ReadLength > 0)) {
+        Error = i2c_master_transmit_receive(*p_Dev_Handle, p_Write, WriteLength, p_Read, ReadLength, I2C_WAIT);
+    } else if (WriteLength > 0) {
+        Error = i2c_master_transmit(*p_Dev_Handle, p_Write, WriteLength, I2C_WAIT);
+    } else {
+        Error = i2c_master_receive(*p_Dev_Handle, p_Read, ReadLength, I2C_WAIT);
+    }
+
+    Duration = static_cast<uint32_t>(esp_timer_get_time() - Start);
+
+    I2CM_Release();
+
+    portENTER_CRITICAL(&_I2CM_Spinlock);
+    _I2CM_State.Counters[Priority].Transactions++;
+    _I2CM_State.Counters[Priority].BusyTime += Duration;
+    if (Error == ESP_OK) {
+        _I2CM_State.Counters[Priority].Bytes += WriteLength + ReadLength;
+    } else {
+        _I2CM_State.Counters[Priority].Errors++;
+    }
+    portEXIT_CRITICAL(&_I2CM_Spinlock);
+
+    if (Error != ESP_OK) {
+        ESP_LOGW(TAG, "I2C transfer failed: %d", Error);
+        return Error;
+    }
+
+    ESP_LOGD(TAG, "Read %u bytes:", static_cast<unsigned int>(ReadLength));
+    for (uint32_t i = 0; i < ReadLength; i++) {
+        ESP_LOGD(TAG, "     Byte %u: 0x%02X", static_cast<unsigned int>(i), *(p_Read + i));
+    }
+
+    return ESP_OK;
+}
+
 /** @brief              Write data to I2C device.
  *  @param p_Dev_Handle Pointer to device handle
  *  @param p_Data       Pointer to data to write
@@ -73,26 +376,12 @@ int32_t I2CM_Deinit(i2c_master_bus_handle_t Bus_Handle)
  */
 int32_t I2CM_Write(i2c_master_dev_handle_t *p_Dev_Handle, const uint8_t *p_Data, uint32_t Length)
 {
-    esp_err_t Error;
     if ((p_Dev_Handle == NULL) || (*p_Dev_Handle == NULL) || (p_Data == NULL)) {
         ESP_LOGE(TAG, "I2C Write: Invalid handle or data pointer");
         return ESP_ERR_INVALID_ARG;
-    } else if (Length == 0) {
-        return ESP_OK;
-    }
-    ESP_LOGD(TAG, "Write %u bytes:", static_cast<unsigned int>(Length));
-    for (uint8_t i = 0; i < Length; i++) {
-        ESP_LOGD(TAG, "     Byte %u: 0x%02X", static_cast<unsigned int>(i), *(p_Data + i));
     }
-    Error = ESP_FAIL;
-    if (xSemaphoreTake(_I2C_Mutex, portMAX_DELAY) == pdTRUE) {
-        Error = i2c_master_transmit(*p_Dev_Handle, p_Data, Length, I2C_WAIT);
-        xSemaphoreGive(_I2C_Mutex);
-        if (Error != ESP_OK) {
-            ESP_LOGW(TAG, "I2C transmit failed: %d", Error);
-        }
-    }
-    return Error;
+
+    return I2CM_Transfer(p_Dev_Handle, I2CM_GetPriority(*p_Dev_Handle), p_Data, Length, NULL, 0);
 }
 
 /** @brief              Read data from I2C device.
@@ -103,38 +392,75 @@ int32_t I2CM_Write(i2c_master_dev_handle_t *p_Dev_Handle, const uint8_t *p_Data,
  */
 int32_t I2CM_Read(i2c_master_dev_handle_t *p_Dev_Handle, uint8_t *p_Data, uint32_t Length)
 {
-    esp_err_t Error;
     if ((p_Dev_Handle == NULL) || (*p_Dev_Handle == NULL) || (p_Data == NULL)) {
         ESP_LOGE(TAG, "I2C Read: Invalid handle or data pointer");
         return ESP_ERR_INVALID_ARG;
-    } else if (Length == 0) {
-        return ESP_OK;
     }
-    ESP_LOGD(TAG, "Read %u bytes:", static_cast<unsigned int>(Length));
-    for (uint8_t i = 0; i < Length; i++) {
-        ESP_LOGD(TAG, "     Byte %u: 0x%02X", static_cast<unsigned int>(i), *(p_Data + i));
-    }
-    Error = ESP_FAIL;
-    if (xSemaphoreTake(_I2C_Mutex, portMAX_DELAY) == pdTRUE) {
-        Error = i2c_master_receive(*p_Dev_Handle, p_Data, Length, I2C_WAIT);
-        xSemaphoreGive(_I2C_Mutex);
-        if (Error != ESP_OK) {
-            ESP_LOGW(TAG, "I2C receive failed: %d", Error);
-        }
+
+    return I2CM_Transfer(p_Dev_Handle, I2CM_GetPriority(*p_Dev_Handle), NULL, 0, p_Data, Length);
+}
+
+int32_t I2CM_ReadRegisters(i2c_master_dev_handle_t *p_Dev_Handle, uint8_t Register, uint8_t *p_Data,
+                           uint32_t Length)
+{
+    if ((p_Dev_Handle == NULL) || (*p_Dev_Handle == NULL) || (p_Data == NULL) || (Length == 0)) {
+        ESP_LOGE(TAG, "I2C Read: Invalid handle or data pointer");
+        return ESP_ERR_INVALID_ARG;
     }
-    return Error;
+
+    return I2CM_Transfer(p_Dev_Handle, I2CM_GetPriority(*p_Dev_Handle), &Register, 1, p_Data, Length);
 }
 
 int32_t I2CM_ModifyRegister(i2c_master_dev_handle_t *p_Dev_Handle, uint8_t Register, uint8_t Mask, uint8_t Value)
 {
     int32_t Error;
+    I2CM_Priority_t Priority;
     uint8_t Data[2] = {Register, 0xFF};
-    Error = I2CM_Write(p_Dev_Handle, &Data[0], 1) || I2CM_Read(p_Dev_Handle, &Data[1], 1);
-    if (Error) {
+
+    if ((p_Dev_Handle == NULL) || (*p_Dev_Handle == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    Priority = I2CM_GetPriority(*p_Dev_Handle);
+
+    Error = I2CM_Lock(Priority);
+    if (Error != ESP_OK) {
         return Error;
     }
-    Data[1] &= ~Mask;
-    Data[1] |= Value;
-    ESP_LOGD(TAG, "Modify Register 0x%02X with mask 0x%02X: 0x%02X", Register, Mask, Data[1]);
-    return I2CM_Write(p_Dev_Handle, Data, sizeof(Data));
-}
\ No newline at end of file
+
+    Error = I2CM_Transfer(p_Dev_Handle, Priority, &Data[0], 1, &Data[1], 1);
+    if (Error == ESP_OK) {
+        Data[1] &= ~Mask;
+        Data[1] |= Value;
+        ESP_LOGD(TAG, "Modify Register 0x%02X with mask 0x%02X: 0x%02X", Register, Mask, Data[1]);
+        Error = I2CM_Transfer(p_Dev_Handle, Priority, Data, sizeof(Data), NULL, 0);
+    }
+
+    I2CM_Unlock();
+
+    return Error;
+}
+
+void I2CM_GetStatistics(I2CM_Statistics_t *p_Statistics)
+{
+    uint64_t BusyTime = 0;
+
+    if (p_Statistics == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&_I2CM_Spinlock);
+    memcpy(p_Statistics->Priority, _I2CM_State.Counters, sizeof(p_Statistics->Priority));
+    portEXIT_CRITICAL(&_I2CM_Spinlock);
+
+    p_Statistics->Uptime = esp_timer_get_time() - _I2CM_State.StartTime;
+
+    for (uint8_t i = 0; i < I2CM_PRIORITY_COUNT; i++) {
+        BusyTime += p_Statistics->Priority[i].BusyTime;
+    }
+
+    p_Statistics->Utilization = 0.0f;
+    if (p_Statistics->Uptime > 0) {
+        p_Statistics->Utilization = 100.0f * static_cast<float>(BusyTime) / static_cast<float>(p_Statistics->Uptime);
+    }
+}
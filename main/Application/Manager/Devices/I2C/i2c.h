@@ -31,6 +31,36 @@
 
 #include <esp_err.h>
 
+/** @brief I2C bus priorities. When the bus is released, it is handed to the highest waiting priority. Within a
+ *         priority the waiting tasks are served by their task priority.
+ */
+typedef enum {
+    I2CM_PRIORITY_HIGH = 0,                     /**< Lepton CCI. */
+    I2CM_PRIORITY_NORMAL,                       /**< RTC and devices without a priority. */
+    I2CM_PRIORITY_LOW,                          /**< Port expander. */
+    I2CM_PRIORITY_COUNT,
+} I2CM_Priority_t;
+
+/** @brief Bus counters of a priority.
+ */
+typedef struct {
+    uint32_t Transactions;                      /**< Number of transfers. */
+    uint32_t Errors;                            /**< Number of failed transfers. */
+    uint32_t Bytes;                             /**< Transferred bytes. */
+    uint32_t Waits;                             /**< Number of times the bus was owned by another task. */
+    uint32_t MaxWaitTime;                       /**< Longest wait for the bus in us. */
+    uint64_t WaitTime;                          /**< Total wait time for the bus in us. */
+    uint64_t BusyTime;                          /**< Total time of the transfers in us. */
+} I2CM_Counters_t;
+
+/** @brief I2C bus statistics.
+ */
+typedef struct {
+    I2CM_Counters_t Priority[I2CM_PRIORITY_COUNT];  /**< Counters per priority. */
+    uint64_t Uptime;                            /**< Time since I2CM_Init in us. */
+    float Utilization;                          /**< Share of the uptime with a running transfer in percent. */
+} I2CM_Statistics_t;
+
 /** @brief              Initialize the I2C driver.
  *  @param p_Config     Pointer to configuration options
  *  @param p_Bus_Handle Pointer to store the created bus handle
@@ -44,6 +74,43 @@ int32_t I2CM_Init(i2c_master_bus_config_t *p_Config, i2c_master_bus_handle_t *p_
  */
 int32_t I2CM_Deinit(i2c_master_bus_handle_t Bus_Handle);
 
+/** @brief          Set the bus priority of a device. Devices without a priority use I2CM_PRIORITY_NORMAL.
+ *  @param Handle   I2C device handle
+ *  @param Priority Bus priority
+ *  @return         ESP_OK when successful
+ *                  ESP_ERR_INVALID_ARG when an invalid argument is passed into the function
+ *                  ESP_ERR_NO_MEM when the device table is full
+ */
+esp_err_t I2CM_SetPriority(i2c_master_dev_handle_t Handle, I2CM_Priority_t Priority);
+
+/** @brief          Take the bus for a burst of transfers. The transfers of the owner do not arbitrate again, so a
+ *                  burst is never interleaved with transfers of other tasks. Calls can be nested.
+ *  @param Priority Bus priority
+ *  @return         ESP_OK when successful
+ *                  ESP_ERR_INVALID_ARG when an invalid argument is passed into the function
+ *                  ESP_ERR_INVALID_STATE when the I2C interface isn´t initialized
+ */
+esp_err_t I2CM_Lock(I2CM_Priority_t Priority);
+
+/** @brief Release the bus taken with I2CM_Lock.
+ */
+void I2CM_Unlock(void);
+
+/** @brief              Write and/or read data with an explicit bus priority. A write followed by a read is sent as
+ *                      one transaction with a repeated start.
+ *  @param p_Dev_Handle Pointer to I2C device handle
+ *  @param Priority     Bus priority
+ *  @param p_Write      Pointer to the data to write or NULL
+ *  @param WriteLength  Length of the data to write in bytes
+ *  @param p_Read       Pointer to the read buffer or NULL
+ *  @param ReadLength   Length of the data to read in bytes
+ *  @return             ESP_OK when successful
+ *                      ESP_ERR_INVALID_ARG when an invalid argument is passed into the function
+ *                      ESP_ERR_INVALID_STATE when the I2C interface isn´t initialized
+ */
+int32_t I2CM_Transfer(i2c_master_dev_handle_t *p_Dev_Handle, I2CM_Priority_t Priority, const uint8_t *p_Write,
+                      uint32_t WriteLength, uint8_t *p_Read, uint32_t ReadLength);
+
 /** @brief              Transmit data over the I2C interface.
  *  @param p_Dev_Handle Pointer to I2C device handle
  *  @param p_Data       Pointer to data
@@ -64,7 +131,20 @@ int32_t I2CM_Write(i2c_master_dev_handle_t *p_Dev_Handle, const uint8_t *p_Data,
  */
 int32_t I2CM_Read(i2c_master_dev_handle_t *p_Dev_Handle, uint8_t *p_Data, uint32_t Length);
 
-/** @brief              Modify the content of a register.
+/** @brief              Write a register address and read the registers from there in one transaction.
+ *  @param p_Dev_Handle Pointer to I2C device handle
+ *  @param Register     Start register address
+ *  @param p_Data       Pointer to the read buffer
+ *  @param Length       Number of registers to read
+ *  @return             ESP_OK when successful
+ *                      ESP_ERR_INVALID_ARG when an invalid argument is passed into the function
+ *                      ESP_ERR_INVALID_STATE when the I2C interface isn´t initialized
+ */
+int32_t I2CM_ReadRegisters(i2c_master_dev_handle_t *p_Dev_Handle, uint8_t Register, uint8_t *p_Data,
+                           uint32_t Length);
+
+/** @brief              Modify the content of a register. The read and the write are one burst, so no other task
+ *                      can change the register in between.
  *  @param p_Dev_Handle Pointer to I2C device handle
  *  @param Register     Register address
  *  @param Mask         Bit mask
@@ -75,4 +155,9 @@ int32_t I2CM_Read(i2c_master_dev_handle_t *p_Dev_Handle, uint8_t *p_Data, uint32
  */
 int32_t I2CM_ModifyRegister(i2c_master_dev_handle_t *p_Dev_Handle, uint8_t Register, uint8_t Mask, uint8_t Value);
 
+/** @brief              Get the bus statistics.
+ *  @param p_Statistics Pointer to the statistics output
+ */
+void I2CM_GetStatistics(I2CM_Statistics_t *p_Statistics);
+
 #endif /* I2C_H_ */
\ No newline at end of file
@@ -175,11 +175,46 @@ static i2c_device_config_t _Expander_I2C_Config = {
     },
 };
 
+/** @brief Copy of the registers changed at runtime. The driver never reads them back, a change is a single write.
+ */
+typedef struct {
+    uint8_t Output[2];
+    uint8_t IntMask[2];
+    uint8_t Dirty;                              /**< Output ports changed since the last write. */
+    uint8_t Batch;                              /**< Nesting depth of PortExpander_BeginUpdate. */
+} PortExpander_Shadow_t;
+
 static i2c_master_dev_handle_t _Expander_Dev_Handle;
 
+/* Only changed while the bus is owned with I2CM_Lock, which also serializes the callers */
+static PortExpander_Shadow_t _Expander_Shadow;
+
 static const char *TAG                      = "PortExpander";
 
-/** @brief          Set the pin level of the pins of a given port.
+/** @brief  Write both output registers in one transaction when an output has changed.
+ *  @return ESP_OK when successful
+ */
+static esp_err_t PortExpander_WriteOutputs(void)
+{
+    esp_err_t Error;
+    uint8_t Data[3] = {PORT_EXPANDER_REG_OUTPUT0, _Expander_Shadow.Output[0], _Expander_Shadow.Output[1]};
+
+    if (_Expander_Shadow.Dirty == 0) {
+        return ESP_OK;
+    }
+
+    Error = I2CM_Write(&_Expander_Dev_Handle, Data, sizeof(Data));
+
+    /* A failed write is repeated with the next change */
+    if (Error == ESP_OK) {
+        _Expander_Shadow.Dirty = 0;
+    }
+
+    return Error;
+}
+
+/** @brief          Set the pin level of the pins of a given port. Within PortExpander_BeginUpdate and
+ *                  PortExpander_EndUpdate only the shadow register is changed.
  *  @param Port     Target port
  *  @param Mask     Pin mask
  *  @param Level    Pin level
@@ -189,7 +224,27 @@ static const char *TAG                      = "PortExpander";
  */
 static esp_err_t PortExpander_SetPinLevel(PortDefinition_t Port, uint8_t Mask, uint8_t Level)
 {
-    return I2CM_ModifyRegister(&_Expander_Dev_Handle, PORT_EXPANDER_REG_OUTPUT0 + static_cast<uint8_t>(Port), Mask, Level);
+    esp_err_t Error;
+    uint8_t Value;
+
+    Error = I2CM_Lock(I2CM_PRIORITY_LOW);
+    if (Error != ESP_OK) {
+        return Error;
+    }
+
+    Value = (_Expander_Shadow.Output[Port] & ~Mask) | (Level & Mask);
+    if (Value != _Expander_Shadow.Output[Port]) {
+        _Expander_Shadow.Output[Port] = Value;
+        _Expander_Shadow.Dirty |= (0x01 << Port);
+    }
+
+    if (_Expander_Shadow.Batch == 0) {
+        Error = PortExpander_WriteOutputs();
+    }
+
+    I2CM_Unlock();
+
+    return Error;
 }
 
 /** @brief              Enable the interrupts for given pins.
@@ -202,8 +257,27 @@ static esp_err_t PortExpander_SetPinLevel(PortDefinition_t Port, uint8_t Mask, u
  */
 static esp_err_t PortExpander_SetInterruptMask(PortDefinition_t Port, uint8_t Mask, uint8_t EnableMask)
 {
-    return I2CM_ModifyRegister(&_Expander_Dev_Handle, PORT_EXPANDER_REG_INT_MASK0 + static_cast<uint8_t>(Port), Mask,
-                               ~EnableMask);
+    esp_err_t Error;
+    uint8_t Data[2];
+
+    Error = I2CM_Lock(I2CM_PRIORITY_LOW);
+    if (Error != ESP_OK) {
+        return Error;
+    }
+
+    Data[0] = PORT_EXPANDER_REG_INT_MASK0 + static_cast<uint8_t>(Port);
+    Data[1] = (_Expander_Shadow.IntMask[Port] & ~Mask) | (~EnableMask & Mask);
+
+    if (Data[1] != _Expander_Shadow.IntMask[Port]) {
+        Error = I2CM_Write(&_Expander_Dev_Handle, Data, sizeof(Data));
+        if (Error == ESP_OK) {
+            _Expander_Shadow.IntMask[Port] = Data[1];
+        }
+    }
+
+    I2CM_Unlock();
+
+    return Error;
 }
 
 #ifdef DEBUG
@@ -214,14 +288,12 @@ void PortExpander_DumpRegister(void)
     ESP_LOGI(TAG, "Register dump:");
 
     for (uint8_t i = 0x00; i < 0x08; i++) {
-        I2CM_Write(&_Expander_Dev_Handle, &i, sizeof(i));
-        I2CM_Read(&_Expander_Dev_Handle, &Data, sizeof(Data));
+        I2CM_ReadRegisters(&_Expander_Dev_Handle, i, &Data, sizeof(Data));
         ESP_LOGI(TAG, "    Register 0x%X: 0x%X", i, Data);
     }
 
     for (uint8_t i = 0x40; i < 0x4F; i++) {
-        I2CM_Write(&_Expander_Dev_Handle, &i, sizeof(i));
-        I2CM_Read(&_Expander_Dev_Handle, &Data, sizeof(Data));
+        I2CM_ReadRegisters(&_Expander_Dev_Handle, i, &Data, sizeof(Data));
         ESP_LOGI(TAG, "    Register 0x%X: 0x%X", i, Data);
     }
 }
@@ -237,13 +309,39 @@ esp_err_t PortExpander_Init(i2c_master_bus_config_t *p_Config, i2c_master_bus_ha
         return Error;
     }
 
+    /* The expander only switches slow signals, so it never delays a CCI command of the camera */
+    I2CM_SetPriority(_Expander_Dev_Handle, I2CM_PRIORITY_LOW);
+
     ESP_LOGI(TAG, "Configure Port Expander...");
 
-    return I2CM_Write(&_Expander_Dev_Handle, DefaultPortConfiguration, sizeof(DefaultPortConfiguration)) ||
-           I2CM_Write(&_Expander_Dev_Handle, DefaultPinConfiguration, sizeof(DefaultPinConfiguration)) ||
-           I2CM_Write(&_Expander_Dev_Handle, DefaultPullConfig, sizeof(DefaultPullConfig)) ||
-           I2CM_Write(&_Expander_Dev_Handle, DefaultLatchConfig, sizeof(DefaultLatchConfig)) ||
-           I2CM_Write(&_Expander_Dev_Handle, DefaultPolarityConfig, sizeof(DefaultPolarityConfig));
+    /* One burst, so the pins never have a half written configuration */
+    Error = I2CM_Lock(I2CM_PRIORITY_LOW);
+    if (Error != ESP_OK) {
+        return Error;
+    }
+
+    Error = I2CM_Write(&_Expander_Dev_Handle, DefaultPortConfiguration, sizeof(DefaultPortConfiguration)) ||
+            I2CM_Write(&_Expander_Dev_Handle, DefaultPinConfiguration, sizeof(DefaultPinConfiguration)) ||
+            I2CM_Write(&_Expander_Dev_Handle, DefaultPullConfig, sizeof(DefaultPullConfig)) ||
+            I2CM_Write(&_Expander_Dev_Handle, DefaultLatchConfig, sizeof(DefaultLatchConfig)) ||
+            I2CM_Write(&_Expander_Dev_Handle, DefaultPolarityConfig, sizeof(DefaultPolarityConfig));
+
+    /* The interrupt masks keep their reset value, they are read once to initialize the shadow */
+    if (Error == ESP_OK) {
+        Error = I2CM_ReadRegisters(&_Expander_Dev_Handle, PORT_EXPANDER_REG_INT_MASK0, _Expander_Shadow.IntMask,
+                                   sizeof(_Expander_Shadow.IntMask));
+    }
+
+    if (Error == ESP_OK) {
+        _Expander_Shadow.Output[0] = DefaultPinConfiguration[1];
+        _Expander_Shadow.Output[1] = DefaultPinConfiguration[2];
+        _Expander_Shadow.Dirty = 0;
+        _Expander_Shadow.Batch = 0;
+    }
+
+    I2CM_Unlock();
+
+    return Error;
 }
 
 esp_err_t PortExpander_Deinit(void)
@@ -261,6 +359,38 @@ esp_err_t PortExpander_Deinit(void)
     return ESP_OK;
 }
 
+esp_err_t PortExpander_BeginUpdate(void)
+{
+    esp_err_t Error;
+
+    Error = I2CM_Lock(I2CM_PRIORITY_LOW);
+    if (Error != ESP_OK) {
+        return Error;
+    }
+
+    _Expander_Shadow.Batch++;
+
+    return ESP_OK;
+}
+
+esp_err_t PortExpander_EndUpdate(void)
+{
+    esp_err_t Error = ESP_OK;
+
+    if (_Expander_Shadow.Batch == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    _Expander_Shadow.Batch--;
+    if (_Expander_Shadow.Batch == 0) {
+        Error = PortExpander_WriteOutputs();
+    }
+
+    I2CM_Unlock();
+
+    return Error;
+}
+
 esp_err_t PortExpander_EnableCamera(bool Enable)
 {
     return PortExpander_SetPinLevel(PORT_0, (0x01 << PIN_CAMERA), (!Enable << PIN_CAMERA));
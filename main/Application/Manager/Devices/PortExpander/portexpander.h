@@ -40,6 +40,20 @@ void PortExpander_DumpRegister(void);
 
 esp_err_t PortExpander_DefaultConfig(void);
 
+/** @brief  Start a batch of pin changes. The changes are only made in the shadow registers and written in one
+ *          transaction by PortExpander_EndUpdate. The bus is owned by the caller until then. Calls can be nested.
+ *  @return ESP_OK when successful
+ */
+esp_err_t PortExpander_BeginUpdate(void);
+
+/** @brief  End a batch of pin changes and write the changed outputs.
+ *  @return ESP_OK when successful
+ *          ESP_ERR_INVALID_STATE when no batch is running
+ */
+esp_err_t PortExpander_EndUpdate(void);
+
+esp_err_t PortExpander_EnableCamera(bool Enable);
+
 esp_err_t PortExpander_EnableLED(bool Enable);
 
 esp_err_t PortExpander_EnableBatteryVoltage(bool Enable);
@@ -129,14 +129,7 @@ static uint8_t RTC_Bin2BCD(uint8_t Bin)
  */
 static esp_err_t RTC_ReadRegister(uint8_t Register, uint8_t *p_Data)
 {
-    esp_err_t Error;
-
-    Error = I2CM_Write(_RTC_Dev_Handle, &Register, 1);
-    if (Error != ESP_OK) {
-        return Error;
-    }
-
-    return I2CM_Read(_RTC_Dev_Handle, p_Data, 1);
+    return I2CM_ReadRegisters(_RTC_Dev_Handle, Register, p_Data, 1);
 }
 
 /** @brief          Write a single register to the RTC.
@@ -159,14 +152,7 @@ static esp_err_t RTC_WriteRegister(uint8_t Register, uint8_t Data)
  */
 static esp_err_t RTC_ReadRegisters(uint8_t Register, uint8_t *p_Data, uint8_t Length)
 {
-    esp_err_t Error;
-
-    Error = I2CM_Write(_RTC_Dev_Handle, &Register, 1);
-    if (Error != ESP_OK) {
-        return Error;
-    }
-
-    return I2CM_Read(_RTC_Dev_Handle, p_Data, Length);
+    return I2CM_ReadRegisters(_RTC_Dev_Handle, Register, p_Data, Length);
 }
 
 /** @brief          Write multiple consecutive registers to the RTC.
@@ -206,6 +192,8 @@ esp_err_t RTC_Init(i2c_master_bus_config_t *p_Config, i2c_master_bus_handle_t *p
 
     _RTC_Dev_Handle = p_Dev_Handle;
 
+    I2CM_SetPriority(*p_Dev_Handle, I2CM_PRIORITY_NORMAL);
+
     ESP_LOGD(TAG, "Initialize RV8263-C8 RTC...");
 
     /* Check oscillator stop flag */
@@ -22,6 +22,8 @@
  */
 
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_memory_utils.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -29,16 +31,25 @@
 
 #include "spi.h"
 
+#include <string.h>
+
 #include <sdkconfig.h>
 
+/** @brief Transfers up to this length are polled, the interrupt and task switch would take longer. */
+#define SPI_POLLING_MAX_LENGTH              32
+
 typedef struct {
     bool isInitialized;
     SemaphoreHandle_t Mutex;
     uint32_t DeviceCount;
+    SPIM_Statistics_t Statistics;
 } SPI_Bus_State_t;
 
 static SPI_Bus_State_t _SPI_State[SOC_SPI_PERIPH_NUM];
 
+/* The statistics are updated by every task using the bus */
+static portMUX_TYPE _SPI_Statistics_Lock = portMUX_INITIALIZER_UNLOCKED;
+
 static const char *TAG = "spi-manager";
 
 /** @brief              Initialize SPI bus.
@@ -196,6 +207,23 @@ bool SPIM_IsInitialized(spi_host_device_t Host)
     return _SPI_State[Host].isInitialized;
 }
 
+/** @brief          Count a completed transaction.
+ *  @param Host     SPI host device
+ *  @param Length   Length of the transaction in bytes
+ *  @param Error    Result of the transaction
+ */
+static void SPIM_CountTransaction(spi_host_device_t Host, size_t Length, esp_err_t Error)
+{
+    portENTER_CRITICAL(&_SPI_Statistics_Lock);
+    _SPI_State[Host].Statistics.Transactions++;
+    if (Error == ESP_OK) {
+        _SPI_State[Host].Statistics.Bytes += Length;
+    } else {
+        _SPI_State[Host].Statistics.Errors++;
+    }
+    portEXIT_CRITICAL(&_SPI_Statistics_Lock);
+}
+
 esp_err_t SPIM_Transmit(spi_host_device_t Host, spi_device_handle_t Handle, uint8_t *p_Tx_Data, uint8_t *p_Rx_Data,
                         size_t Length)
 {
@@ -212,13 +240,138 @@ esp_err_t SPIM_Transmit(spi_host_device_t Host, spi_device_handle_t Handle, uint
     trans.length = Length * 8;
 
     xSemaphoreTake(_SPI_State[Host].Mutex, portMAX_DELAY);
-    Error = spi_device_polling_transmit(Handle, &trans);
+    if (Length <= SPI_POLLING_MAX_LENGTH) {
+        Error = spi_device_polling_transmit(Handle, &trans);
+    } else {
+        /* Sleeps on the transfer interrupt, so the core can run other tasks */
+        Error = spi_device_transmit(Handle, &trans);
+    }
+    xSemaphoreGive(_SPI_State[Host].Mutex);
+
+    SPIM_CountTransaction(Host, Length, Error);
+
     if (Error != ESP_OK) {
         ESP_LOGE(TAG, "SPI transmit failed: %d!", Error);
-        xSemaphoreGive(_SPI_State[Host].Mutex);
         return Error;
     }
-    xSemaphoreGive(_SPI_State[Host].Mutex);
 
     return ESP_OK;
-}
\ No newline at end of file
+}
+
+void SPIM_PrepareTransaction(SPIM_Transaction_t *p_Transaction, const uint8_t *p_Tx_Data, uint8_t *p_Rx_Data,
+                             size_t Length, SPIM_Callback_t Callback, void *p_Arg)
+{
+    if (p_Transaction == NULL) {
+        return;
+    }
+
+    memset(p_Transaction, 0, sizeof(SPIM_Transaction_t));
+    p_Transaction->Transaction.tx_buffer = p_Tx_Data;
+    p_Transaction->Transaction.rx_buffer = p_Rx_Data;
+    p_Transaction->Transaction.length = Length * 8;
+    p_Transaction->Transaction.rxlength = (p_Rx_Data != NULL) ? (Length * 8) : 0;
+    p_Transaction->Callback = Callback;
+    p_Transaction->p_Arg = p_Arg;
+}
+
+esp_err_t SPIM_Queue(spi_host_device_t Host, spi_device_handle_t Handle, SPIM_Transaction_t *p_Transaction,
+                     TickType_t Timeout)
+{
+    esp_err_t Error;
+    const spi_transaction_t *p_Trans;
+
+    if ((Handle == NULL) || (p_Transaction == NULL) || (Host >= SOC_SPI_PERIPH_NUM)) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_SPI_State[Host].isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    p_Trans = &p_Transaction->Transaction;
+
+    /* The driver would copy a buffer without DMA access into a temporary buffer for every transfer */
+    if (((p_Trans->flags & SPI_TRANS_USE_TXDATA) == 0) && (p_Trans->tx_buffer != NULL) &&
+        (esp_ptr_dma_capable(p_Trans->tx_buffer) == false)) {
+        ESP_LOGE(TAG, "TX buffer is not DMA capable!");
+        return ESP_ERR_INVALID_ARG;
+    } else if (((p_Trans->flags & SPI_TRANS_USE_RXDATA) == 0) && (p_Trans->rx_buffer != NULL) &&
+               (esp_ptr_dma_capable(p_Trans->rx_buffer) == false)) {
+        ESP_LOGE(TAG, "RX buffer is not DMA capable!");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    p_Transaction->Host = Host;
+    p_Transaction->QueueTime = esp_timer_get_time();
+
+    Error = spi_device_queue_trans(Handle, &p_Transaction->Transaction, Timeout);
+    if (Error != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to queue SPI transaction: %d", Error);
+        return Error;
+    }
+
+    portENTER_CRITICAL(&_SPI_Statistics_Lock);
+    _SPI_State[Host].Statistics.InFlight++;
+    if (_SPI_State[Host].Statistics.InFlight > _SPI_State[Host].Statistics.MaxInFlight) {
+        _SPI_State[Host].Statistics.MaxInFlight = _SPI_State[Host].Statistics.InFlight;
+    }
+    portEXIT_CRITICAL(&_SPI_Statistics_Lock);
+
+    return ESP_OK;
+}
+
+esp_err_t SPIM_GetResult(spi_device_handle_t Handle, TickType_t Timeout, SPIM_Transaction_t **pp_Transaction)
+{
+    esp_err_t Error;
+    spi_transaction_t *p_Trans;
+    SPIM_Transaction_t *p_Transaction;
+    uint32_t Latency;
+    SPIM_Statistics_t *p_Statistics;
+
+    if (Handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    Error = spi_device_get_trans_result(Handle, &p_Trans, Timeout);
+    if (Error != ESP_OK) {
+        return Error;
+    }
+
+    /* The driver descriptor is the first member of the transaction */
+    p_Transaction = reinterpret_cast<SPIM_Transaction_t *>(p_Trans);
+    Latency = static_cast<uint32_t>(esp_timer_get_time() - p_Transaction->QueueTime);
+    p_Statistics = &_SPI_State[p_Transaction->Host].Statistics;
+
+    portENTER_CRITICAL(&_SPI_Statistics_Lock);
+    if (p_Statistics->InFlight > 0) {
+        p_Statistics->InFlight--;
+    }
+    p_Statistics->TotalLatency += Latency;
+    if (Latency > p_Statistics->MaxLatency) {
+        p_Statistics->MaxLatency = Latency;
+    }
+    portEXIT_CRITICAL(&_SPI_Statistics_Lock);
+
+    SPIM_CountTransaction(p_Transaction->Host, p_Trans->length / 8, ESP_OK);
+
+    if (p_Transaction->Callback != NULL) {
+        p_Transaction->Callback(p_Transaction, ESP_OK);
+    }
+
+    if (pp_Transaction != NULL) {
+        *pp_Transaction = p_Transaction;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t SPIM_GetStatistics(spi_host_device_t Host, SPIM_Statistics_t *p_Statistics)
+{
+    if ((p_Statistics == NULL) || (Host >= SOC_SPI_PERIPH_NUM)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&_SPI_Statistics_Lock);
+    *p_Statistics = _SPI_State[Host].Statistics;
+    portEXIT_CRITICAL(&_SPI_Statistics_Lock);
+
+    return ESP_OK;
+}
@@ -32,6 +32,40 @@
 
 #include <esp_err.h>
 
+#include <freertos/FreeRTOS.h>
+
+struct SPIM_Transaction_t;
+
+/** @brief                  Completion callback of an asynchronous transaction. Called by SPIM_GetResult in the
+ *                          context of the task that collects the result, never from an interrupt.
+ *  @param p_Transaction    Completed transaction
+ *  @param Error            ESP_OK when the transfer was successful
+ */
+typedef void (*SPIM_Callback_t)(struct SPIM_Transaction_t *p_Transaction, esp_err_t Error);
+
+/** @brief Asynchronous transaction. The descriptor and its buffers are owned by the caller and must stay valid until
+ *         the result was collected. The buffers must be DMA capable, so the driver never copies them.
+ */
+typedef struct SPIM_Transaction_t {
+    spi_transaction_t Transaction;              /**< Driver descriptor. Must be the first member. */
+    SPIM_Callback_t Callback;                   /**< Optional completion callback. */
+    void *p_Arg;                                /**< User argument for the callback. */
+    spi_host_device_t Host;                     /**< Set by SPIM_Queue. */
+    int64_t QueueTime;                          /**< Set by SPIM_Queue. */
+} SPIM_Transaction_t;
+
+/** @brief Statistics of a SPI host.
+ */
+typedef struct {
+    uint32_t Transactions;                      /**< Completed transactions, synchronous and asynchronous. */
+    uint32_t Errors;                            /**< Failed transactions. */
+    uint64_t Bytes;                             /**< Transferred bytes. */
+    uint32_t InFlight;                          /**< Queued transactions without a collected result. */
+    uint32_t MaxInFlight;                       /**< Highest number of queued transactions. */
+    uint32_t MaxLatency;                        /**< Longest time from queueing to the collected result in us. */
+    uint64_t TotalLatency;                      /**< Sum of the latencies of the asynchronous transactions in us. */
+} SPIM_Statistics_t;
+
 /** @brief              Initialize the SPI bus.
  *  @param p_Config     Pointer to SPI bus configuration
  *  @param Host         SPI host device (SPI2_HOST or SPI3_HOST)
@@ -69,7 +103,8 @@ esp_err_t SPIM_RemoveDevice(spi_host_device_t Host, spi_device_handle_t Handle);
  */
 bool SPIM_IsInitialized(spi_host_device_t Host);
 
-/** @brief              Transmit data over SPI.
+/** @brief              Transmit data over SPI and wait for the end of the transfer. Short transfers are polled, longer
+ *                      ones block the caller on the transfer interrupt.
  *  @param Host         SPI host device
  *  @param Handle       Device handle
  *  @param p_Tx_Data    Pointer to data to transmit
@@ -80,4 +115,45 @@ bool SPIM_IsInitialized(spi_host_device_t Host);
 esp_err_t SPIM_Transmit(spi_host_device_t Host, spi_device_handle_t Handle, uint8_t *p_Tx_Data, uint8_t *p_Rx_Data,
                         size_t Length);
 
+/** @brief                  Prepare an asynchronous transaction.
+ *  @param p_Transaction    Caller owned transaction descriptor
+ *  @param p_Tx_Data        Pointer to DMA capable data to transmit (or NULL if not needed)
+ *  @param p_Rx_Data        Pointer to DMA capable buffer for received data (or NULL if not needed)
+ *  @param Length           Length of data to transmit/receive in bytes
+ *  @param Callback         Completion callback (or NULL)
+ *  @param p_Arg            User argument for the callback
+ */
+void SPIM_PrepareTransaction(SPIM_Transaction_t *p_Transaction, const uint8_t *p_Tx_Data, uint8_t *p_Rx_Data,
+                             size_t Length, SPIM_Callback_t Callback, void *p_Arg);
+
+/** @brief                  Queue an asynchronous transaction. The transfer runs with DMA while the caller continues,
+ *                          the result is collected with SPIM_GetResult.
+ *  @param Host             SPI host device
+ *  @param Handle           Device handle
+ *  @param p_Transaction    Prepared transaction
+ *  @param Timeout          Maximum time to wait for a free slot in the queue of the device in ticks
+ *  @return                 ESP_OK when successful
+ *                          ESP_ERR_INVALID_ARG if a buffer is not DMA capable
+ *                          ESP_ERR_TIMEOUT if the queue of the device is full
+ */
+esp_err_t SPIM_Queue(spi_host_device_t Host, spi_device_handle_t Handle, SPIM_Transaction_t *p_Transaction,
+                     TickType_t Timeout);
+
+/** @brief                  Collect the result of a queued transaction of a device and call its completion callback.
+ *                          The results are returned in queue order.
+ *  @param Handle           Device handle
+ *  @param Timeout          Maximum time to wait for the transaction in ticks
+ *  @param pp_Transaction   Pointer to store the completed transaction (or NULL if not needed)
+ *  @return                 ESP_OK when a transaction was completed
+ *                          ESP_ERR_TIMEOUT if no transaction was completed in time
+ */
+esp_err_t SPIM_GetResult(spi_device_handle_t Handle, TickType_t Timeout, SPIM_Transaction_t **pp_Transaction);
+
+/** @brief              Get the statistics of a SPI host.
+ *  @param Host         SPI host device
+ *  @param p_Statistics Pointer to the statistics output
+ *  @return             ESP_OK when successful
+ */
+esp_err_t SPIM_GetStatistics(spi_host_device_t Host, SPIM_Statistics_t *p_Statistics);
+
 #endif /* SPI_H_ */
@@ -23,6 +23,7 @@
 
 #include <esp_log.h>
 #include <esp_event.h>
+#include <esp_timer.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
@@ -44,10 +45,44 @@
 #define BATTERY_R1                          10000   /* Upper resistor */
 #define BATTERY_R2                          3300    /* Lower resistor */
 
-/** @brief Battery voltage range (in millivolts).
+/** @brief Fixed point scale of the filtered battery voltage.
  */
-#define BATTERY_MIN_VOLTAGE                 3300    /* 3.3V */
-#define BATTERY_MAX_VOLTAGE                 4200    /* 4.2V (fully charged LiPo) */
+#define BATTERY_FILTER_SCALE                16
+
+/** @brief Open circuit voltage of a LiPo cell over the state of charge.
+ */
+typedef struct {
+    int Voltage;                                /**< Open circuit voltage in mV. */
+    int Percentage;                             /**< State of charge in %. */
+} Battery_OCV_Point_t;
+
+static const Battery_OCV_Point_t _Battery_OCV_Curve[] = {
+    {3270, 0},
+    {3610, 5},
+    {3690, 10},
+    {3710, 15},
+    {3730, 20},
+    {3750, 25},
+    {3770, 30},
+    {3790, 35},
+    {3800, 40},
+    {3820, 45},
+    {3840, 50},
+    {3850, 55},
+    {3870, 60},
+    {3910, 65},
+    {3950, 70},
+    {3980, 75},
+    {4020, 80},
+    {4080, 85},
+    {4110, 90},
+    {4150, 95},
+    {4200, 100},
+};
+
+/** @brief Time the camera needs after the power up before the CCI can be used (in milliseconds).
+ */
+#define CAMERA_BOOT_TIME_MS                 2000
 
 /** @brief Default configuration for the I2C interface.
  */
@@ -88,12 +123,42 @@ typedef struct {
     bool initialized;
     i2c_master_dev_handle_t RTC_Handle;
     i2c_master_bus_handle_t I2C_Bus_Handle;
+    int64_t CameraPowerOn;                      /**< Time of the camera power up in microseconds. */
+    int32_t BatteryFiltered;                    /**< Low pass filtered battery voltage in
+                                                     1 / BATTERY_FILTER_SCALE mV, 0 before the first reading. */
 } Devices_Manager_State_t;
 
 static Devices_Manager_State_t _Devices_Manager_State;
 
 static const char *TAG = "devices-manager";
 
+/** @brief          Estimate the state of charge from the open circuit voltage.
+ *  @param Voltage  Open circuit voltage in mV
+ *  @return         State of charge in % (0-100)
+ */
+static int DevicesManager_GetStateOfCharge(int Voltage)
+{
+    const size_t Count = sizeof(_Battery_OCV_Curve) / sizeof(_Battery_OCV_Curve[0]);
+
+    if (Voltage <= _Battery_OCV_Curve[0].Voltage) {
+        return 0;
+    } else if (Voltage >= _Battery_OCV_Curve[Count - 1].Voltage) {
+        return 100;
+    }
+
+    for (size_t i = 1; i < Count; i++) {
+        const Battery_OCV_Point_t *p_Low = &_Battery_OCV_Curve[i - 1];
+        const Battery_OCV_Point_t *p_High = &_Battery_OCV_Curve[i];
+
+        if (Voltage < p_High->Voltage) {
+            return p_Low->Percentage + ((Voltage - p_Low->Voltage) * (p_High->Percentage - p_Low->Percentage) /
+                                        (p_High->Voltage - p_Low->Voltage));
+        }
+    }
+
+    return 100;
+}
+
 esp_err_t DevicesManager_Init(void)
 {
     if (_Devices_Manager_State.initialized) {
@@ -121,9 +186,9 @@ esp_err_t DevicesManager_Init(void)
         return ESP_FAIL;
     }
 
-    /* Give the camera time to power up and stabilize (Lepton requires ~1.5s boot time) */
-    ESP_LOGI(TAG, "Waiting for camera power stabilization...");
-    vTaskDelay(2000 / portTICK_PERIOD_MS);
+    /* The camera needs ~1.5 s to boot. The boot is not blocked here, the Lepton task waits for the remaining
+       time with DevicesManager_WaitForCamera */
+    _Devices_Manager_State.CameraPowerOn = esp_timer_get_time();
 
     if (RTC_Init(&_Devices_Manager_I2CM_Config, &_Devices_Manager_State.I2C_Bus_Handle,
                  &_Devices_Manager_State.RTC_Handle) != ESP_OK) {
@@ -161,6 +226,22 @@ esp_err_t DevicesManager_Deinit(void)
     return Error;
 }
 
+void DevicesManager_WaitForCamera(void)
+{
+    int64_t Remaining;
+
+    if (_Devices_Manager_State.initialized == false) {
+        ESP_LOGE(TAG, "Devices manager not initialized yet!");
+        return;
+    }
+
+    Remaining = (CAMERA_BOOT_TIME_MS * 1000LL) - (esp_timer_get_time() - _Devices_Manager_State.CameraPowerOn);
+    if (Remaining > 0) {
+        ESP_LOGI(TAG, "Waiting %lld ms for camera power stabilization...", Remaining / 1000);
+        vTaskDelay(pdMS_TO_TICKS(Remaining / 1000) + 1);
+    }
+}
+
 i2c_master_bus_handle_t DevicesManager_GetI2CBusHandle(void)
 {
     if (_Devices_Manager_State.initialized == false) {
@@ -174,6 +255,8 @@ i2c_master_bus_handle_t DevicesManager_GetI2CBusHandle(void)
 esp_err_t DevicesManager_GetBatteryVoltage(int *p_Voltage, int *p_Percentage)
 {
     int Raw;
+    int Voltage;
+    int OpenCircuit;
     esp_err_t Error;
 
     if (_Devices_Manager_State.initialized == false) {
@@ -196,18 +279,40 @@ esp_err_t DevicesManager_GetBatteryVoltage(int *p_Voltage, int *p_Percentage)
 
     PortExpander_EnableBatteryVoltage(false);
 
-    *p_Voltage = Raw * (BATTERY_R1 + BATTERY_R2) / BATTERY_R2;
+    Voltage = Raw * (BATTERY_R1 + BATTERY_R2) / BATTERY_R2;
 
-    *p_Percentage = (*p_Voltage - BATTERY_MIN_VOLTAGE) * 100 / (BATTERY_MAX_VOLTAGE - BATTERY_MIN_VOLTAGE);
-    if (*p_Percentage < 0) {
-        *p_Percentage = 0;
-    } else if (*p_Percentage > 100) {
-        *p_Percentage = 100;
+    /* First order low pass, the first reading initializes it */
+    if (_Devices_Manager_State.BatteryFiltered == 0) {
+        _Devices_Manager_State.BatteryFiltered = Voltage * BATTERY_FILTER_SCALE;
+    } else {
+        _Devices_Manager_State.BatteryFiltered += ((Voltage * BATTERY_FILTER_SCALE) -
+                                                   _Devices_Manager_State.BatteryFiltered) >>
+                                                  CONFIG_DEVICES_BATTERY_FILTER_SHIFT;
     }
 
+    *p_Voltage = _Devices_Manager_State.BatteryFiltered / BATTERY_FILTER_SCALE;
+
+    /* The voltage under load is lower than the open circuit voltage of the curve by the drop over the internal
+       resistance */
+    OpenCircuit = *p_Voltage + (CONFIG_DEVICES_BATTERY_LOAD_MA * CONFIG_DEVICES_BATTERY_RESISTANCE_MOHM / 1000);
+    *p_Percentage = DevicesManager_GetStateOfCharge(OpenCircuit);
+
+    ESP_LOGD(TAG, "Battery: %d mV, filtered %d mV, open circuit %d mV, %d%%", Voltage, *p_Voltage, OpenCircuit,
+             *p_Percentage);
+
     return ESP_OK;
 }
 
+esp_err_t DevicesManager_EnableLED(bool Enable)
+{
+    if (_Devices_Manager_State.initialized == false) {
+        ESP_LOGE(TAG, "Devices Manager not initialized yet!");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return PortExpander_EnableLED(Enable);
+}
+
 esp_err_t DevicesManager_GetRTCHandle(i2c_master_dev_handle_t *p_Handle)
 {
     if (_Devices_Manager_State.initialized == false) {
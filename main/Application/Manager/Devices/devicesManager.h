@@ -29,6 +29,7 @@
 
 #include <time.h>
 #include <stdint.h>
+#include <stdbool.h>
 
 /** @brief  Initialize the Devices Manager.
  *  @return ESP_OK on success
@@ -40,18 +41,33 @@ esp_err_t DevicesManager_Init(void);
  */
 esp_err_t DevicesManager_Deinit(void);
 
+/** @brief  Wait until the camera has finished its boot after the power up in DevicesManager_Init. Returns right
+ *          away when the boot time has already passed.
+ */
+void DevicesManager_WaitForCamera(void);
+
 /** @brief  Get the I2C bus handle.
  *  @return I2C bus handle or NULL if not initialized
  */
 i2c_master_bus_handle_t DevicesManager_GetI2CBusHandle(void);
 
-/** @brief              Get the battery voltage and percentage.
- *  @param p_Voltage    Pointer to store voltage in mV
+/** @brief              Measure the battery voltage and estimate the state of charge. The voltage is low pass
+ *                      filtered over the calls (CONFIG_DEVICES_BATTERY_FILTER_SHIFT), the state of charge is
+ *                      taken from a LiPo discharge curve after adding the drop of the typical load current over
+ *                      the internal resistance of the cell.
+ *  @param p_Voltage    Pointer to store the filtered voltage in mV
  *  @param p_Percentage Pointer to store percentage (0-100)
  *  @return             ESP_OK on success
  */
 esp_err_t DevicesManager_GetBatteryVoltage(int *p_Voltage, int *p_Percentage);
 
+/** @brief          Switch the LED. Only changes the output register when the state changes.
+ *  @param Enable   true to switch the LED on
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_STATE if the Devices Manager is not initialized
+ */
+esp_err_t DevicesManager_EnableLED(bool Enable);
+
 /** @brief          Get the RTC device handle (for Time Manager).
  *  @param p_Handle Pointer to store the RTC handle
  *  @return         ESP_OK on success
@@ -0,0 +1,863 @@
+/*
+ * flashLog.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Log structured ring of compressed snapshots in the storage partition of the flash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <sdkconfig.h>
+
+#ifdef CONFIG_FLASH_LOG
+
+#include <esp_log.h>
+#include <esp_event.h>
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+
+#include "flashLog.h"
+
+#include "Application/application.h"
+#include "Application/Manager/SD/sdManager.h"
+#include "Application/Manager/SD/sdSnapshot.h"
+#include "Application/Memory/memoryPlan.h"
+
+/** @brief The SD card of a sync is written in whole sectors, so the sync buffer is padded to them.
+ */
+#define FLASH_LOG_CARD_SECTOR               512
+
+/** @brief Entry of the record index in RAM.
+ */
+typedef struct {
+    uint32_t Sequence;
+    uint32_t Length;
+    int64_t Time;
+    uint16_t Sector;                            /**< First erase sector of the record. */
+    uint16_t Sectors;
+    bool isSynced;
+} FlashLog_Index_t;
+
+typedef struct {
+    bool isInitialized;
+    const esp_partition_t *Partition;
+    uint16_t Width;
+    uint16_t Height;
+    uint32_t SectorSize;
+    uint16_t SectorCount;
+    FlashLog_Index_t *Index;                    /**< Ring of SectorCount entries, ordered by the sequence. */
+    uint16_t First;                             /**< Oldest record in the index. */
+    uint16_t Count;
+    uint16_t Head;                              /**< First sector after the newest record. */
+    uint32_t NextSequence;
+    uint8_t *Slot;                              /**< Record header and snapshot of the pending append. */
+    size_t SlotSize;
+    bool isBusy;                                /**< The slot is owned by an append or the writer. */
+    bool isPending;                             /**< The slot holds a record for the writer. */
+    bool isSyncRequested;
+    bool isSyncing;
+    TaskHandle_t Task;
+    SemaphoreHandle_t Mutex;                    /**< Protects the index and the reads of records. */
+    FlashLog_Status_t Status;
+} FlashLog_State_t;
+
+static FlashLog_State_t _FlashLog_State;
+static portMUX_TYPE _FlashLog_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *TAG = "flash-log";
+
+/** @brief              Calculate the CRC of a record header.
+ *  @param p_Header     Pointer to the header
+ *  @return             CRC-32 of the fields before HeaderCRC
+ */
+static uint32_t FlashLog_HeaderCRC(const FlashLog_Record_Header_t *p_Header)
+{
+    return esp_rom_crc32_le(0, reinterpret_cast<const uint8_t *>(p_Header),
+                            offsetof(FlashLog_Record_Header_t, HeaderCRC));
+}
+
+/** @brief              Get an entry of the index.
+ *  @param Position     Position counted from the oldest record
+ *  @return             Pointer to the entry
+ */
+static FlashLog_Index_t *FlashLog_GetIndex(uint16_t Position)
+{
+    return &_FlashLog_State.Index[(_FlashLog_State.First + Position) % _FlashLog_State.SectorCount];
+}
+
+/** @brief      Compare two index entries by the sequence for qsort.
+ */
+static int FlashLog_CompareIndex(const void *p_A, const void *p_B)
+{
+    uint32_t A = reinterpret_cast<const FlashLog_Index_t *>(p_A)->Sequence;
+    uint32_t B = reinterpret_cast<const FlashLog_Index_t *>(p_B)->Sequence;
+
+    return (A > B) - (A < B);
+}
+
+/** @brief  Build the index from the record headers. A valid header is only written after its snapshot, so the
+ *          scan reads a single header per record and skips the sectors of the record.
+ */
+static void FlashLog_Scan(void)
+{
+    FlashLog_Record_Header_t Header;
+    FlashLog_Index_t *p_Newest;
+    uint16_t Sector;
+
+    _FlashLog_State.First = 0;
+    _FlashLog_State.Count = 0;
+    _FlashLog_State.Head = 0;
+    _FlashLog_State.NextSequence = 1;
+
+    Sector = 0;
+    while (Sector < _FlashLog_State.SectorCount) {
+        if ((esp_partition_read(_FlashLog_State.Partition, Sector * _FlashLog_State.SectorSize, &Header,
+                                sizeof(Header)) != ESP_OK) ||
+            (Header.Magic != FLASH_LOG_MAGIC) || (Header.HeaderCRC != FlashLog_HeaderCRC(&Header)) ||
+            (Header.Sectors == 0) || ((Sector + Header.Sectors) > _FlashLog_State.SectorCount) ||
+            ((sizeof(Header) + Header.Length) > (Header.Sectors * _FlashLog_State.SectorSize))) {
+            Sector++;
+            continue;
+        }
+
+        _FlashLog_State.Index[_FlashLog_State.Count].Sequence = Header.Sequence;
+        _FlashLog_State.Index[_FlashLog_State.Count].Length = Header.Length;
+        _FlashLog_State.Index[_FlashLog_State.Count].Time = Header.Time;
+        _FlashLog_State.Index[_FlashLog_State.Count].Sector = Sector;
+        _FlashLog_State.Index[_FlashLog_State.Count].Sectors = Header.Sectors;
+        _FlashLog_State.Index[_FlashLog_State.Count].isSynced = (Header.Synced != 0xFFFFFFFF);
+        _FlashLog_State.Count++;
+
+        Sector += Header.Sectors;
+    }
+
+    if (_FlashLog_State.Count == 0) {
+        return;
+    }
+
+    /* The records follow each other around the ring, the new ones continue after the newest */
+    qsort(_FlashLog_State.Index, _FlashLog_State.Count, sizeof(FlashLog_Index_t), FlashLog_CompareIndex);
+
+    p_Newest = &_FlashLog_State.Index[_FlashLog_State.Count - 1];
+    _FlashLog_State.Head = (p_Newest->Sector + p_Newest->Sectors) % _FlashLog_State.SectorCount;
+    _FlashLog_State.NextSequence = p_Newest->Sequence + 1;
+}
+
+/** @brief              Check if a new record fits without overwriting the oldest record. The live records cover
+ *                      the sectors from the oldest record to Head around the ring, the rest is free.
+ *  @param Start        First sector of the new record, Head or 0 when the record does not fit before the end
+ *  @param Sectors      Number of sectors of the new record
+ *  @return             true if the sectors are free
+ */
+static bool FlashLog_Fits(uint16_t Start, uint16_t Sectors)
+{
+    uint16_t Tail;
+
+    if (_FlashLog_State.Count == 0) {
+        return true;
+    }
+
+    Tail = FlashLog_GetIndex(0)->Sector;
+
+    if (Start == _FlashLog_State.Head) {
+        if (Tail > _FlashLog_State.Head) {
+            return (Tail - _FlashLog_State.Head) >= Sectors;
+        }
+
+        /* Tail == Head with records is a full ring */
+        return Tail < _FlashLog_State.Head;
+    }
+
+    /* A wrap skips the sectors from Head to the end, the oldest record must not be behind Head */
+    return (Tail < _FlashLog_State.Head) && (Tail >= Sectors);
+}
+
+/** @brief  Remove the oldest record. The magic is cleared without an erase, so the record does not come back
+ *          with the next scan when its sectors are skipped by a wrap. Needs the mutex.
+ */
+static void FlashLog_DropOldest(void)
+{
+    FlashLog_Index_t *p_Oldest = FlashLog_GetIndex(0);
+    uint32_t Zero = 0;
+
+    if (esp_partition_write(_FlashLog_State.Partition, p_Oldest->Sector * _FlashLog_State.SectorSize, &Zero,
+                            sizeof(Zero)) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to invalidate record %u!", static_cast<unsigned int>(p_Oldest->Sequence));
+    }
+
+    if (p_Oldest->isSynced == false) {
+        ESP_LOGW(TAG, "Record %u overwritten before it was synced!", static_cast<unsigned int>(p_Oldest->Sequence));
+
+        portENTER_CRITICAL(&_FlashLog_Lock);
+        _FlashLog_State.Status.Overwritten++;
+        portEXIT_CRITICAL(&_FlashLog_Lock);
+    }
+
+    _FlashLog_State.First = (_FlashLog_State.First + 1) % _FlashLog_State.SectorCount;
+    _FlashLog_State.Count--;
+}
+
+/** @brief              Mark a record as synced by clearing its Synced word. Needs the mutex.
+ *  @param p_Entry      Index entry of the record
+ *  @return             ESP_OK on success
+ */
+static esp_err_t FlashLog_MarkRecord(FlashLog_Index_t *p_Entry)
+{
+    uint32_t Zero = 0;
+    esp_err_t Error;
+
+    Error = esp_partition_write(_FlashLog_State.Partition, (p_Entry->Sector * _FlashLog_State.SectorSize) +
+                                offsetof(FlashLog_Record_Header_t, Synced), &Zero, sizeof(Zero));
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to mark record %u: %d!", static_cast<unsigned int>(p_Entry->Sequence), Error);
+        return Error;
+    }
+
+    p_Entry->isSynced = true;
+
+    return ESP_OK;
+}
+
+/** @brief              Read the snapshot of a record and check its CRC.
+ *  @param p_Entry      Index entry of the record
+ *  @param p_Buffer     Pointer to the buffer, at least p_Entry->Length bytes
+ *  @return             ESP_OK on success
+ */
+static esp_err_t FlashLog_ReadRecord(const FlashLog_Index_t *p_Entry, uint8_t *p_Buffer)
+{
+    FlashLog_Record_Header_t Header;
+    size_t Address;
+
+    Address = p_Entry->Sector * _FlashLog_State.SectorSize;
+
+    if ((esp_partition_read(_FlashLog_State.Partition, Address, &Header, sizeof(Header)) != ESP_OK) ||
+        (esp_partition_read(_FlashLog_State.Partition, Address + sizeof(Header), p_Buffer, p_Entry->Length) !=
+         ESP_OK)) {
+        ESP_LOGE(TAG, "Failed to read record %u!", static_cast<unsigned int>(p_Entry->Sequence));
+        return ESP_FAIL;
+    }
+
+    if (esp_rom_crc32_le(0, p_Buffer, p_Entry->Length) != Header.CRC) {
+        ESP_LOGW(TAG, "CRC error in record %u!", static_cast<unsigned int>(p_Entry->Sequence));
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    return ESP_OK;
+}
+
+/** @brief  Write the record of the slot. The flash is erased and programmed one sector at a time with a pause in
+ *          between, because every operation suspends the caches of both cores. The header is written last.
+ *  @return ESP_OK on success
+ */
+static esp_err_t FlashLog_WriteRecord(void)
+{
+    FlashLog_Record_Header_t *p_Header = reinterpret_cast<FlashLog_Record_Header_t *>(_FlashLog_State.Slot);
+    FlashLog_Index_t *p_Entry;
+    const uint8_t *p_Data;
+    size_t Address;
+    size_t Remaining;
+    uint16_t Sectors;
+    uint16_t Start;
+    esp_err_t Error;
+
+    Sectors = (sizeof(FlashLog_Record_Header_t) + p_Header->Length + _FlashLog_State.SectorSize - 1) /
+              _FlashLog_State.SectorSize;
+    if (Sectors > _FlashLog_State.SectorCount) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    Start = ((_FlashLog_State.Head + Sectors) > _FlashLog_State.SectorCount) ? 0 : _FlashLog_State.Head;
+
+    /* Every sector is erased once per pass around the ring, which levels the wear over the partition */
+    xSemaphoreTake(_FlashLog_State.Mutex, portMAX_DELAY);
+    while (FlashLog_Fits(Start, Sectors) == false) {
+        FlashLog_DropOldest();
+    }
+    xSemaphoreGive(_FlashLog_State.Mutex);
+
+    for (uint16_t i = 0; i < Sectors; i++) {
+        Error = esp_partition_erase_range(_FlashLog_State.Partition, (Start + i) * _FlashLog_State.SectorSize,
+                                          _FlashLog_State.SectorSize);
+        if (Error != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to erase sector %u: %d!", Start + i, Error);
+            return Error;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_FLASH_LOG_PAUSE_MS));
+    }
+
+    p_Header->CRC = esp_rom_crc32_le(0, _FlashLog_State.Slot + sizeof(FlashLog_Record_Header_t), p_Header->Length);
+    p_Header->Sectors = Sectors;
+    p_Header->HeaderCRC = FlashLog_HeaderCRC(p_Header);
+
+    p_Data = _FlashLog_State.Slot + sizeof(FlashLog_Record_Header_t);
+    Address = (Start * _FlashLog_State.SectorSize) + sizeof(FlashLog_Record_Header_t);
+    Remaining = p_Header->Length;
+
+    while (Remaining > 0) {
+        size_t Length = _FlashLog_State.SectorSize - (Address % _FlashLog_State.SectorSize);
+
+        if (Length > Remaining) {
+            Length = Remaining;
+        }
+
+        Error = esp_partition_write(_FlashLog_State.Partition, Address, p_Data, Length);
+        if (Error != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to write record %u: %d!", static_cast<unsigned int>(p_Header->Sequence), Error);
+            return Error;
+        }
+
+        p_Data += Length;
+        Address += Length;
+        Remaining -= Length;
+
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_FLASH_LOG_PAUSE_MS));
+    }
+
+    /* Commit */
+    Error = esp_partition_write(_FlashLog_State.Partition, Start * _FlashLog_State.SectorSize, p_Header,
+                                sizeof(FlashLog_Record_Header_t));
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write the header of record %u: %d!", static_cast<unsigned int>(p_Header->Sequence),
+                 Error);
+        return Error;
+    }
+
+    xSemaphoreTake(_FlashLog_State.Mutex, portMAX_DELAY);
+    p_Entry = FlashLog_GetIndex(_FlashLog_State.Count);
+    p_Entry->Sequence = p_Header->Sequence;
+    p_Entry->Length = p_Header->Length;
+    p_Entry->Time = p_Header->Time;
+    p_Entry->Sector = Start;
+    p_Entry->Sectors = Sectors;
+    p_Entry->isSynced = false;
+    _FlashLog_State.Count++;
+    _FlashLog_State.Head = (Start + Sectors) % _FlashLog_State.SectorCount;
+    xSemaphoreGive(_FlashLog_State.Mutex);
+
+    ESP_LOGI(TAG, "Record %u written to sector %u (%u bytes)", static_cast<unsigned int>(p_Header->Sequence), Start,
+             static_cast<unsigned int>(p_Header->Length));
+
+    return ESP_OK;
+}
+
+/** @brief          Copy the oldest record that is not synced to the SD card.
+ *  @param p_Buffer Pointer to the sync buffer of SlotSize bytes
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_NOT_FOUND if all records are synced
+ *                  ESP_ERR_INVALID_STATE if no card is mounted
+ */
+static esp_err_t FlashLog_SyncOne(uint8_t *p_Buffer)
+{
+    FlashLog_Index_t Entry;
+    char Path[SD_SNAPSHOT_PATH_MAX];
+    size_t Padded;
+    bool isFound = false;
+    esp_err_t Error;
+
+    if (SDManager_isMounted() == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(&Entry, 0, sizeof(Entry));
+
+    xSemaphoreTake(_FlashLog_State.Mutex, portMAX_DELAY);
+    for (uint16_t i = 0; i < _FlashLog_State.Count; i++) {
+        if (FlashLog_GetIndex(i)->isSynced == false) {
+            Entry = *FlashLog_GetIndex(i);
+            isFound = true;
+            break;
+        }
+    }
+    xSemaphoreGive(_FlashLog_State.Mutex);
+
+    if (isFound == false) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    /* Only this task erases records, so the record stays valid without the mutex */
+    Error = FlashLog_ReadRecord(&Entry, p_Buffer);
+    if (Error == ESP_OK) {
+        Padded = (Entry.Length + FLASH_LOG_CARD_SECTOR - 1) & ~static_cast<size_t>(FLASH_LOG_CARD_SECTOR - 1);
+        memset(p_Buffer + Entry.Length, 0, Padded - Entry.Length);
+
+        Error = SDSnapshot_Save(p_Buffer, Entry.Length, Path, sizeof(Path));
+        if (Error != ESP_OK) {
+            return Error;
+        }
+
+        ESP_LOGI(TAG, "Record %u synced to %s", static_cast<unsigned int>(Entry.Sequence), Path);
+
+        portENTER_CRITICAL(&_FlashLog_Lock);
+        _FlashLog_State.Status.Synced++;
+        portEXIT_CRITICAL(&_FlashLog_Lock);
+    } else if (Error != ESP_ERR_INVALID_CRC) {
+        return Error;
+    }
+
+    /* A corrupted record is marked as well, it would block the sync of the newer records forever */
+    xSemaphoreTake(_FlashLog_State.Mutex, portMAX_DELAY);
+    for (uint16_t i = 0; i < _FlashLog_State.Count; i++) {
+        if (FlashLog_GetIndex(i)->Sequence == Entry.Sequence) {
+            Error = FlashLog_MarkRecord(FlashLog_GetIndex(i));
+            break;
+        }
+    }
+    xSemaphoreGive(_FlashLog_State.Mutex);
+
+    return Error;
+}
+
+/** @brief          Writer task. Writes the pending record first and syncs the records between two appends.
+ *  @param p_Param  Unused
+ */
+static void FlashLog_Task(void *p_Param)
+{
+    uint8_t *p_Buffer;
+    bool isPending;
+    bool isSyncRequested;
+    esp_err_t Error;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        portENTER_CRITICAL(&_FlashLog_Lock);
+        isPending = _FlashLog_State.isPending;
+        portEXIT_CRITICAL(&_FlashLog_Lock);
+
+        if (isPending) {
+            Error = FlashLog_WriteRecord();
+
+            portENTER_CRITICAL(&_FlashLog_Lock);
+            if (Error == ESP_OK) {
+                _FlashLog_State.Status.Appended++;
+            }
+            _FlashLog_State.Status.Error = Error;
+            _FlashLog_State.isPending = false;
+            _FlashLog_State.isBusy = false;
+            portEXIT_CRITICAL(&_FlashLog_Lock);
+
+            /* A card that is mounted now gets the record right away */
+            if (SDManager_isMounted()) {
+                FlashLog_Sync();
+            }
+        }
+
+        portENTER_CRITICAL(&_FlashLog_Lock);
+        isSyncRequested = _FlashLog_State.isSyncRequested;
+        _FlashLog_State.isSyncing = isSyncRequested;
+        portEXIT_CRITICAL(&_FlashLog_Lock);
+
+        if (isSyncRequested == false) {
+            continue;
+        }
+
+        p_Buffer = reinterpret_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, _FlashLog_State.SlotSize,
+                                                                "flash_log_sync"));
+        if (p_Buffer == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate the sync buffer!");
+            Error = ESP_ERR_NO_MEM;
+        } else {
+            /* One record at a time, a new append is written before the next record is copied */
+            do {
+                Error = FlashLog_SyncOne(p_Buffer);
+
+                portENTER_CRITICAL(&_FlashLog_Lock);
+                isPending = _FlashLog_State.isPending;
+                isSyncRequested = _FlashLog_State.isSyncRequested;
+                portEXIT_CRITICAL(&_FlashLog_Lock);
+            } while ((Error == ESP_OK) && isSyncRequested && (isPending == false));
+
+            MemoryPlan_Free(p_Buffer);
+        }
+
+        portENTER_CRITICAL(&_FlashLog_Lock);
+        if ((Error != ESP_OK) || (isSyncRequested == false)) {
+            _FlashLog_State.isSyncRequested = false;
+        }
+
+        if ((Error != ESP_OK) && (Error != ESP_ERR_NOT_FOUND)) {
+            _FlashLog_State.Status.Error = Error;
+        }
+        _FlashLog_State.isSyncing = false;
+        portEXIT_CRITICAL(&_FlashLog_Lock);
+
+        if (Error == ESP_ERR_NOT_FOUND) {
+            ESP_LOGD(TAG, "All records synced");
+        } else if ((Error != ESP_OK) && (Error != ESP_ERR_INVALID_STATE)) {
+            ESP_LOGE(TAG, "Sync failed: %d!", Error);
+        }
+
+        /* The pending append or the rest of the sync */
+        if (isPending || ((Error == ESP_OK) && isSyncRequested)) {
+            xTaskNotifyGive(_FlashLog_State.Task);
+        }
+    }
+}
+
+/** @brief          SD card event handler. A mounted card starts a sync.
+ *  @param p_Args   Unused
+ *  @param Base     Event base
+ *  @param ID       Event ID
+ *  @param p_Data   Unused
+ */
+static void FlashLog_On_SD_Event(void *p_Args, esp_event_base_t Base, int32_t ID, void *p_Data)
+{
+    if (ID == SD_EVENT_MOUNTED) {
+        FlashLog_Sync();
+    }
+}
+
+esp_err_t FlashLog_Init(uint16_t Width, uint16_t Height)
+{
+    uint16_t Pending = 0;
+
+    if (_FlashLog_State.isInitialized) {
+        ESP_LOGW(TAG, "Already initialized");
+        return ESP_OK;
+    }
+
+    if ((Width == 0) || (Height == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(&_FlashLog_State, 0, sizeof(_FlashLog_State));
+
+    _FlashLog_State.Partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                         FLASH_LOG_PARTITION);
+    if (_FlashLog_State.Partition == NULL) {
+        ESP_LOGE(TAG, "No %s partition!", FLASH_LOG_PARTITION);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    _FlashLog_State.Width = Width;
+    _FlashLog_State.Height = Height;
+    _FlashLog_State.SectorSize = _FlashLog_State.Partition->erase_size;
+    _FlashLog_State.SectorCount = _FlashLog_State.Partition->size / _FlashLog_State.SectorSize;
+
+    /* A record fills at least one sector, so there are never more records than sectors */
+    _FlashLog_State.Index = reinterpret_cast<FlashLog_Index_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME,
+                                                                                  _FlashLog_State.SectorCount *
+                                                                                  sizeof(FlashLog_Index_t),
+                                                                                  "flash_log_index"));
+
+    /* The sync buffer of the same size is padded to the card sectors, SDSnapshot_GetMaxSize already is */
+    _FlashLog_State.SlotSize = sizeof(FlashLog_Record_Header_t) + SDSnapshot_GetMaxSize(Width, Height, 0);
+    _FlashLog_State.Slot = reinterpret_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME,
+                                                                        _FlashLog_State.SlotSize,
+                                                                        "flash_log_slot"));
+    _FlashLog_State.Mutex = xSemaphoreCreateMutex();
+
+    if ((_FlashLog_State.Index == NULL) || (_FlashLog_State.Slot == NULL) || (_FlashLog_State.Mutex == NULL)) {
+        ESP_LOGE(TAG, "Failed to allocate the log!");
+        goto FlashLog_Init_Error;
+    }
+
+    FlashLog_Scan();
+
+    for (uint16_t i = 0; i < _FlashLog_State.Count; i++) {
+        if (FlashLog_GetIndex(i)->isSynced == false) {
+            Pending++;
+        }
+    }
+
+    if (xTaskCreatePinnedToCore(FlashLog_Task, "Flash_Log", CONFIG_FLASH_LOG_TASK_STACKSIZE, NULL,
+                                CONFIG_FLASH_LOG_TASK_PRIO, &_FlashLog_State.Task,
+                                CONFIG_FLASH_LOG_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create the writer task!");
+        goto FlashLog_Init_Error;
+    }
+
+    esp_event_handler_register(SD_EVENTS, SD_EVENT_MOUNTED, FlashLog_On_SD_Event, NULL);
+
+    _FlashLog_State.isInitialized = true;
+
+    ESP_LOGI(TAG, "Flash log initialized: %u records in %u sectors, %u not synced", _FlashLog_State.Count,
+             _FlashLog_State.SectorCount, Pending);
+
+    /* The card of the boot is mounted before the handler is registered */
+    if (SDManager_isMounted()) {
+        FlashLog_Sync();
+    }
+
+    return ESP_OK;
+
+FlashLog_Init_Error:
+    if (_FlashLog_State.Mutex != NULL) {
+        vSemaphoreDelete(_FlashLog_State.Mutex);
+        _FlashLog_State.Mutex = NULL;
+    }
+
+    if (_FlashLog_State.Slot != NULL) {
+        MemoryPlan_Free(_FlashLog_State.Slot);
+        _FlashLog_State.Slot = NULL;
+    }
+
+    if (_FlashLog_State.Index != NULL) {
+        MemoryPlan_Free(_FlashLog_State.Index);
+        _FlashLog_State.Index = NULL;
+    }
+
+    return ESP_ERR_NO_MEM;
+}
+
+void FlashLog_Deinit(void)
+{
+    bool isIdle;
+
+    if (_FlashLog_State.isInitialized == false) {
+        return;
+    }
+
+    esp_event_handler_unregister(SD_EVENTS, SD_EVENT_MOUNTED, FlashLog_On_SD_Event);
+
+    /* Wait until the writer has written the pending record and finished the current copy */
+    do {
+        portENTER_CRITICAL(&_FlashLog_Lock);
+        _FlashLog_State.isSyncRequested = false;
+        isIdle = (_FlashLog_State.isBusy == false) && (_FlashLog_State.isSyncing == false);
+        if (isIdle) {
+            _FlashLog_State.isInitialized = false;
+        }
+        portEXIT_CRITICAL(&_FlashLog_Lock);
+
+        if (isIdle == false) {
+            vTaskDelay(10 / portTICK_PERIOD_MS);
+        }
+    } while (isIdle == false);
+
+    xSemaphoreTake(_FlashLog_State.Mutex, portMAX_DELAY);
+    vTaskDelete(_FlashLog_State.Task);
+    _FlashLog_State.Task = NULL;
+    xSemaphoreGive(_FlashLog_State.Mutex);
+
+    vSemaphoreDelete(_FlashLog_State.Mutex);
+    _FlashLog_State.Mutex = NULL;
+
+    MemoryPlan_Free(_FlashLog_State.Slot);
+    _FlashLog_State.Slot = NULL;
+
+    MemoryPlan_Free(_FlashLog_State.Index);
+    _FlashLog_State.Index = NULL;
+}
+
+esp_err_t FlashLog_Append(const FramePool_Frame_t *p_Frame, const Lepton_FluxLinearParams_t *p_Flux,
+                          uint32_t *p_Sequence)
+{
+    FlashLog_Record_Header_t *p_Header;
+    uint32_t Sequence;
+    size_t Length;
+    bool isBusy;
+
+    if ((p_Frame == NULL) || (p_Frame->hasRAW == false)) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_FlashLog_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    } else if ((p_Frame->Width != _FlashLog_State.Width) || (p_Frame->Height != _FlashLog_State.Height)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&_FlashLog_Lock);
+    isBusy = _FlashLog_State.isBusy;
+    if (isBusy) {
+        _FlashLog_State.Status.Busy++;
+    } else {
+        _FlashLog_State.isBusy = true;
+    }
+    Sequence = _FlashLog_State.NextSequence;
+    portEXIT_CRITICAL(&_FlashLog_Lock);
+
+    if (isBusy) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    /* The writer task only adds the CRCs, so the flash is never touched in the context of the caller */
+    memset(_FlashLog_State.Slot, 0, sizeof(FlashLog_Record_Header_t) + SD_SNAPSHOT_HEADER_SIZE);
+    Length = SDSnapshot_Build(p_Frame, p_Flux, NULL, 0, true, _FlashLog_State.Slot + sizeof(FlashLog_Record_Header_t),
+                              _FlashLog_State.SlotSize - sizeof(FlashLog_Record_Header_t));
+    if (Length == 0) {
+        portENTER_CRITICAL(&_FlashLog_Lock);
+        _FlashLog_State.isBusy = false;
+        portEXIT_CRITICAL(&_FlashLog_Lock);
+
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    p_Header = reinterpret_cast<FlashLog_Record_Header_t *>(_FlashLog_State.Slot);
+    p_Header->Magic = FLASH_LOG_MAGIC;
+    p_Header->Sequence = Sequence;
+    p_Header->Length = Length;
+    p_Header->Time = p_Frame->Time;
+    p_Header->Reserved = 0xFFFF;
+    p_Header->Synced = 0xFFFFFFFF;
+
+    portENTER_CRITICAL(&_FlashLog_Lock);
+    _FlashLog_State.NextSequence = Sequence + 1;
+    _FlashLog_State.isPending = true;
+    portEXIT_CRITICAL(&_FlashLog_Lock);
+
+    xTaskNotifyGive(_FlashLog_State.Task);
+
+    if (p_Sequence != NULL) {
+        *p_Sequence = Sequence;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t FlashLog_GetStatus(FlashLog_Status_t *p_Status)
+{
+    if (p_Status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(p_Status, 0, sizeof(FlashLog_Status_t));
+
+    if (_FlashLog_State.isInitialized == false) {
+        return ESP_OK;
+    }
+
+    portENTER_CRITICAL(&_FlashLog_Lock);
+    *p_Status = _FlashLog_State.Status;
+    portEXIT_CRITICAL(&_FlashLog_Lock);
+
+    p_Status->isAvailable = true;
+    p_Status->Capacity = _FlashLog_State.Partition->size;
+    p_Status->Used = 0;
+    p_Status->Records = 0;
+    p_Status->Pending = 0;
+
+    xSemaphoreTake(_FlashLog_State.Mutex, portMAX_DELAY);
+    for (uint16_t i = 0; i < _FlashLog_State.Count; i++) {
+        const FlashLog_Index_t *p_Entry = FlashLog_GetIndex(i);
+
+        p_Status->Used += p_Entry->Sectors * _FlashLog_State.SectorSize;
+        p_Status->Records++;
+
+        if (p_Entry->isSynced == false) {
+            p_Status->Pending++;
+        }
+    }
+    xSemaphoreGive(_FlashLog_State.Mutex);
+
+    return ESP_OK;
+}
+
+size_t FlashLog_List(FlashLog_Entry_t *p_Entries, size_t Max)
+{
+    size_t Count = 0;
+
+    if ((p_Entries == NULL) || (_FlashLog_State.isInitialized == false)) {
+        return 0;
+    }
+
+    xSemaphoreTake(_FlashLog_State.Mutex, portMAX_DELAY);
+    for (uint16_t i = 0; (i < _FlashLog_State.Count) && (Count < Max); i++) {
+        const FlashLog_Index_t *p_Entry = FlashLog_GetIndex(i);
+
+        p_Entries[Count].Sequence = p_Entry->Sequence;
+        p_Entries[Count].Length = p_Entry->Length;
+        p_Entries[Count].Time = p_Entry->Time;
+        p_Entries[Count].isSynced = p_Entry->isSynced;
+        Count++;
+    }
+    xSemaphoreGive(_FlashLog_State.Mutex);
+
+    return Count;
+}
+
+esp_err_t FlashLog_Read(uint32_t Sequence, uint8_t *p_Buffer, size_t Size, size_t *p_Length)
+{
+    esp_err_t Error = ESP_ERR_NOT_FOUND;
+
+    if (_FlashLog_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* The mutex keeps the writer from overwriting the record during the read */
+    xSemaphoreTake(_FlashLog_State.Mutex, portMAX_DELAY);
+    for (uint16_t i = 0; i < _FlashLog_State.Count; i++) {
+        const FlashLog_Index_t *p_Entry = FlashLog_GetIndex(i);
+
+        if (p_Entry->Sequence != Sequence) {
+            continue;
+        }
+
+        if (p_Length != NULL) {
+            *p_Length = p_Entry->Length;
+        }
+
+        if ((p_Buffer == NULL) || (Size < p_Entry->Length)) {
+            Error = ESP_ERR_INVALID_SIZE;
+        } else {
+            Error = FlashLog_ReadRecord(p_Entry, p_Buffer);
+        }
+
+        break;
+    }
+    xSemaphoreGive(_FlashLog_State.Mutex);
+
+    return Error;
+}
+
+esp_err_t FlashLog_MarkSynced(uint32_t Sequence)
+{
+    esp_err_t Error = ESP_OK;
+
+    if (_FlashLog_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(_FlashLog_State.Mutex, portMAX_DELAY);
+    for (uint16_t i = 0; i < _FlashLog_State.Count; i++) {
+        FlashLog_Index_t *p_Entry = FlashLog_GetIndex(i);
+
+        if (p_Entry->Sequence > Sequence) {
+            break;
+        }
+
+        if ((p_Entry->isSynced == false) && (FlashLog_MarkRecord(p_Entry) != ESP_OK)) {
+            Error = ESP_FAIL;
+        }
+    }
+    xSemaphoreGive(_FlashLog_State.Mutex);
+
+    return Error;
+}
+
+void FlashLog_Sync(void)
+{
+    if (_FlashLog_State.Task == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&_FlashLog_Lock);
+    _FlashLog_State.isSyncRequested = true;
+    portEXIT_CRITICAL(&_FlashLog_Lock);
+
+    xTaskNotifyGive(_FlashLog_State.Task);
+}
+
+#endif /* CONFIG_FLASH_LOG */
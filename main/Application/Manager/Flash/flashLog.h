@@ -0,0 +1,159 @@
+/*
+ * flashLog.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Log structured ring of compressed snapshots in the storage partition of the flash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef FLASHLOG_H_
+#define FLASHLOG_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "lepton.h"
+#include "Application/Tasks/Lepton/framePool.h"
+
+/** @brief Label of the data partition of the log.
+ */
+#define FLASH_LOG_PARTITION                 "storage"
+
+/** @brief Magic of a record header ("PVFL") (little endian).
+ */
+#define FLASH_LOG_MAGIC                     0x4C465650
+
+/** @brief Header at the start of the first sector of a record (little endian). The snapshot (see sdSnapshot.h)
+ *         follows the header and the record fills whole erase sectors. The header is written after the snapshot,
+ *         so a record without a valid header was interrupted and its sectors are free.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t Magic;                             /**< FLASH_LOG_MAGIC. Cleared to 0 without an erase when the record
+                                                     is overwritten. */
+    uint32_t Sequence;                          /**< Number of the record, counts up over the whole lifetime. */
+    uint32_t Length;                            /**< Length of the snapshot in bytes. */
+    uint32_t CRC;                               /**< CRC-32 (IEEE 802.3, as zlib) of the snapshot. */
+    int64_t Time;                               /**< Wall clock time of the capture in microseconds since
+                                                     1970-01-01 UTC. 0 if the time was not set. */
+    uint16_t Sectors;                           /**< Number of erase sectors of the record. */
+    uint16_t Reserved;                          /**< 0xFFFF. */
+    uint32_t HeaderCRC;                         /**< CRC-32 of the fields above. */
+    uint32_t Synced;                            /**< 0xFFFFFFFF until the snapshot is copied to the SD card or
+                                                     acknowledged by a client, then 0 (written without an erase). */
+} FlashLog_Record_Header_t;
+
+/** @brief Entry of the record list.
+ */
+typedef struct {
+    uint32_t Sequence;                          /**< Number of the record. */
+    uint32_t Length;                            /**< Length of the snapshot in bytes. */
+    int64_t Time;                               /**< Wall clock time of the capture in microseconds since
+                                                     1970-01-01 UTC. 0 if the time was not set. */
+    bool isSynced;                              /**< The snapshot is on the SD card or was acknowledged. */
+} FlashLog_Entry_t;
+
+/** @brief Status of the log.
+ */
+typedef struct {
+    bool isAvailable;                           /**< The partition was found and indexed. */
+    uint32_t Capacity;                          /**< Size of the partition in bytes. */
+    uint32_t Used;                              /**< Bytes used by the records. */
+    uint32_t Records;                           /**< Number of records. */
+    uint32_t Pending;                           /**< Records that are not synced. */
+    uint32_t Appended;                          /**< Records written since the boot. */
+    uint32_t Busy;                              /**< Snapshots rejected since the boot, because the previous one was
+                                                     still being written. */
+    uint32_t Overwritten;                       /**< Records overwritten before they were synced. */
+    uint32_t Synced;                            /**< Records copied to the SD card since the boot. */
+    esp_err_t Error;                            /**< Error of the last write or sync, ESP_OK otherwise. */
+} FlashLog_Status_t;
+
+/** @brief          Initialize the log and index the records of the partition. Only the record headers are read,
+ *                  one read per record. Starts a sync when a card is mounted.
+ *  @param Width    Width of the frames in pixels
+ *  @param Height   Height of the frames in pixels
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if the frame size is invalid
+ *                  ESP_ERR_NOT_FOUND if there is no storage partition
+ *                  ESP_ERR_NO_MEM if the buffers or the writer task can not be created
+ */
+esp_err_t FlashLog_Init(uint16_t Width, uint16_t Height);
+
+/** @brief Deinitialize the log. Waits for the write of a pending snapshot.
+ */
+void FlashLog_Deinit(void);
+
+/** @brief              Store a compressed snapshot of a frame. The snapshot is assembled in the buffer of the writer
+ *                      task and the call returns before the flash is touched, a busy writer rejects the snapshot.
+ *                      The oldest records are overwritten when the partition is full.
+ *  @param p_Frame      Pointer to the frame with RAW14 data
+ *  @param p_Flux       Pointer to the radiometric parameters of the camera. NULL to omit the FLUX chunk
+ *  @param p_Sequence   Pointer to store the number of the record. Can be NULL
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if the frame has no RAW14 data or a different size
+ *                      ESP_ERR_INVALID_STATE if the log is not available
+ *                      ESP_ERR_NOT_FINISHED if the previous snapshot is still being written
+ */
+esp_err_t FlashLog_Append(const FramePool_Frame_t *p_Frame, const Lepton_FluxLinearParams_t *p_Flux,
+                          uint32_t *p_Sequence);
+
+/** @brief              Get the status of the log.
+ *  @param p_Status     Pointer to store the status
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if p_Status is NULL
+ */
+esp_err_t FlashLog_GetStatus(FlashLog_Status_t *p_Status);
+
+/** @brief              List the records, the oldest first.
+ *  @param p_Entries    Pointer to the list
+ *  @param Max          Maximum number of entries
+ *  @return             Number of entries in the list
+ */
+size_t FlashLog_List(FlashLog_Entry_t *p_Entries, size_t Max);
+
+/** @brief              Read the snapshot of a record and check its CRC.
+ *  @param Sequence     Number of the record
+ *  @param p_Buffer     Pointer to the buffer for the snapshot. Can be NULL with a Size of 0 to get the length
+ *  @param Size         Size of the buffer in bytes
+ *  @param p_Length     Pointer to store the length of the snapshot. Can be NULL
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_STATE if the log is not available
+ *                      ESP_ERR_NOT_FOUND if there is no such record
+ *                      ESP_ERR_INVALID_SIZE if the buffer is too small, p_Length contains the required size
+ *                      ESP_ERR_INVALID_CRC if the record is corrupted
+ *                      ESP_FAIL if the flash can not be read
+ */
+esp_err_t FlashLog_Read(uint32_t Sequence, uint8_t *p_Buffer, size_t Size, size_t *p_Length);
+
+/** @brief              Mark the records up to a number as synced, e.g. after a client downloaded them. Synced
+ *                      records stay readable until they are overwritten, but are no longer copied to the SD card.
+ *  @param Sequence     Number of the last synced record
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_STATE if the log is not available
+ *                      ESP_FAIL if a record can not be marked
+ */
+esp_err_t FlashLog_MarkSynced(uint32_t Sequence);
+
+/** @brief Copy the records that are not synced to the SD card in the background. Called for every card mount.
+ */
+void FlashLog_Sync(void);
+
+#endif /* FLASHLOG_H_ */
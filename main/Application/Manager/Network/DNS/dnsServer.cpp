@@ -34,6 +34,7 @@
 #include <string.h>
 
 #include "dnsServer.h"
+#include "Application/Topology/topology.h"
 
 #define DNS_PORT            53
 #define DNS_BUFFER_SIZE     512
@@ -183,10 +184,10 @@ esp_err_t DNS_Server_Start(void)
         return ESP_FAIL;
     }
 
-    /* Start DNS server task on CPU 1 to avoid blocking IDLE0 */
+    /* The default layout runs the DNS server on CPU 1 to avoid blocking IDLE0 */
     _DNS_Server_State.isRunning = true;
 
-    if (xTaskCreatePinnedToCore(DNS_Server_Task, "DNS_Server", 4096, NULL, 3, &_DNS_Server_State.Task, 1) != pdPASS) {
+    if (Topology_CreateTask(TOPOLOGY_TASK_DNS, DNS_Server_Task, NULL, &_DNS_Server_State.Task) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to create DNS server task!");
 
         close(_DNS_Server_State.Socket);
@@ -33,16 +33,15 @@
 #include <string.h>
 
 #include "provisionHandlers.h"
+#include "wifiScan.h"
+#include "../Server/WebAssets/webAssets.h"
 #include "../networkTypes.h"
 #include "../networkManager.h"
 #include "../../Settings/settingsManager.h"
+#include "Application/Memory/memoryPlan.h"
 
 static const char *TAG = "ProvisionHandlers";
 
-/* Embed HTML file */
-extern const uint8_t provision_html_start[] asm("_binary_provision_html_start");
-extern const uint8_t provision_html_end[] asm("_binary_provision_html_end");
-
 /** @brief              Send JSON response.
  *  @param p_Request    HTTP request handle
  *  @param p_JSON       JSON object to send
@@ -73,10 +72,14 @@ static esp_err_t send_JSON_Response(httpd_req_t *p_Request, cJSON *p_JSON, int S
 
 esp_err_t Provision_Handler_Root(httpd_req_t *p_Request)
 {
-    httpd_resp_set_type(p_Request, "text/html");
-    httpd_resp_set_hdr(p_Request, "Cache-Control", "no-cache");
+    const WebAssets_Asset_t *Asset;
+
+    Asset = WebAssets_Find("/provision.html");
+    if (Asset == NULL) {
+        return httpd_resp_send_404(p_Request);
+    }
 
-    return httpd_resp_send(p_Request, (const char *)provision_html_start, provision_html_end - provision_html_start);
+    return WebAssets_Send(p_Request, Asset);
 }
 
 esp_err_t Provision_Handler_CaptivePortal(httpd_req_t *p_Request)
@@ -109,64 +112,38 @@ esp_err_t Provision_Handler_CaptivePortal(httpd_req_t *p_Request)
 
 esp_err_t Provision_Handler_Scan(httpd_req_t *p_Request)
 {
-    wifi_scan_config_t ScanConfig;
-    uint16_t APCount = 0;
-    esp_err_t Error;
-
-    memset(&ScanConfig, 0, sizeof(ScanConfig));
-
-    /* Start async scan */
-    Error = esp_wifi_scan_start(&ScanConfig, false);
-    if (Error != ESP_OK) {
-        cJSON *Response;
-
-        ESP_LOGW(TAG, "Scan start failed: %d", Error);
-
-        Response = cJSON_CreateObject();
-        cJSON_AddArrayToObject(Response, "networks");
-
-        return send_JSON_Response(p_Request, Response, 200);
-    }
-
-    /* Wait for scan to complete (max 10 seconds) */
-    for (uint8_t i = 0; i < 100; i++) {
-        vTaskDelay(100 / portTICK_PERIOD_MS);
-        if (esp_wifi_scan_get_ap_num(&APCount) == ESP_OK) {
-            break;
-        }
-    }
-
-    if (APCount == 0) {
-        cJSON *Response;
+    WiFiScan_Result_t *Result;
+    cJSON *Response;
+    cJSON *Networks;
 
-        Response = cJSON_CreateObject();
-        cJSON_AddArrayToObject(Response, "networks");
-        return send_JSON_Response(p_Request, Response, 200);
-    }
-
-    wifi_ap_record_t *APList = (wifi_ap_record_t *)malloc(sizeof(wifi_ap_record_t) * APCount);
-    if (APList == NULL) {
+    /* The results come from the background scan, so the request never waits for the radio */
+    Result = reinterpret_cast<WiFiScan_Result_t *>(malloc(sizeof(WiFiScan_Result_t)));
+    if (Result == NULL) {
         httpd_resp_send_500(p_Request);
         return ESP_ERR_NO_MEM;
     }
 
-    esp_wifi_scan_get_ap_records(&APCount, APList);
+    WiFiScan_Get(Result);
 
-    cJSON *Response = cJSON_CreateObject();
-    cJSON *Networks = cJSON_AddArrayToObject(Response, "networks");
+    Response = cJSON_CreateObject();
+    Networks = cJSON_AddArrayToObject(Response, "networks");
 
-    for (uint16_t i = 0; i < APCount; i++) {
+    for (uint8_t i = 0; i < Result->Count; i++) {
         cJSON *Network = cJSON_CreateObject();
-        cJSON_AddStringToObject(Network, "ssid", (const char *)APList[i].ssid);
-        cJSON_AddNumberToObject(Network, "rssi", APList[i].rssi);
-        cJSON_AddNumberToObject(Network, "channel", APList[i].primary);
+        cJSON_AddStringToObject(Network, "ssid", Result->Networks[i].SSID);
+        cJSON_AddNumberToObject(Network, "rssi", Result->Networks[i].RSSI);
+        cJSON_AddNumberToObject(Network, "channel", Result->Networks[i].Channel);
         cJSON_AddStringToObject(Network, "auth",
-                                APList[i].authmode == WIFI_AUTH_OPEN ? "open" : "secured");
+                                Result->Networks[i].AuthMode == WIFI_AUTH_OPEN ? "open" : "secured");
 
         cJSON_AddItemToArray(Networks, Network);
     }
 
-    free(APList);
+    cJSON_AddBoolToObject(Response, "scanning", Result->isScanning);
+    cJSON_AddBoolToObject(Response, "stale", Result->isStale);
+    cJSON_AddNumberToObject(Response, "age_s", Result->Age / 1000);
+
+    free(Result);
 
     return send_JSON_Response(p_Request, Response, 200);
 }
@@ -188,7 +165,7 @@ esp_err_t Provision_Handler_Connect(httpd_req_t *p_Request)
         return ESP_FAIL;
     }
 
-    Buffer = (char *)heap_caps_malloc(ContentLen + 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    Buffer = reinterpret_cast<char *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, ContentLen + 1, "http_body"));
     if (Buffer == NULL) {
         httpd_resp_send_500(p_Request);
         return ESP_ERR_NO_MEM;
@@ -196,7 +173,7 @@ esp_err_t Provision_Handler_Connect(httpd_req_t *p_Request)
 
     Received = httpd_req_recv(p_Request, Buffer, ContentLen);
     if (Received <= 0) {
-        free(Buffer);
+        MemoryPlan_Free(Buffer);
         httpd_resp_send_err(p_Request, HTTPD_400_BAD_REQUEST, "Failed to read request");
         return ESP_FAIL;
     }
@@ -204,7 +181,7 @@ esp_err_t Provision_Handler_Connect(httpd_req_t *p_Request)
     Buffer[Received] = '\0';
 
     JSON = cJSON_Parse(Buffer);
-    free(Buffer);
+    MemoryPlan_Free(Buffer);
 
     if (JSON == NULL) {
         httpd_resp_send_err(p_Request, HTTPD_400_BAD_REQUEST, "Invalid JSON");
@@ -35,6 +35,7 @@
 #include "../Server/server.h"
 #include "../DNS/dnsServer.h"
 #include "provisioning.h"
+#include "wifiScan.h"
 
 typedef struct {
     bool isInitialized;
@@ -283,6 +284,12 @@ esp_err_t Provisioning_Start(void)
 
         vTaskDelay(100 / portTICK_PERIOD_MS);
 
+        /* Scan in the background, so the portal has a network list before the first request */
+        Error = WiFiScan_Start();
+        if (Error != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to start WiFi scan: %d!", Error);
+        }
+
         /* Start HTTP server with minimal configuration for provisioning */
         ServerConfig.Port = 80;
         ServerConfig.MaxClients = 1;  /* Only one client for provisioning */
@@ -294,6 +301,7 @@ esp_err_t Provisioning_Start(void)
         if (Error != ESP_OK) {
             ESP_LOGE(TAG, "Failed to init HTTP server: 0x%x!", Error);
 
+            WiFiScan_Stop();
             esp_wifi_stop();
 
             return Error;
@@ -304,6 +312,7 @@ esp_err_t Provisioning_Start(void)
             ESP_LOGE(TAG, "Failed to start HTTP server: 0x%x!", Error);
 
             HTTP_Server_Deinit();
+            WiFiScan_Stop();
             esp_wifi_stop();
 
             return Error;
@@ -399,6 +408,8 @@ esp_err_t Provisioning_Stop(void)
         ESP_LOGD(TAG, "Stopping HTTP server");
         HTTP_Server_Stop();
 
+        WiFiScan_Stop();
+
         /* Stop WiFi completely - this closes all sockets and makes httpd_stop return quickly */
         ESP_LOGD(TAG, "Stopping WiFi");
         esp_wifi_stop();
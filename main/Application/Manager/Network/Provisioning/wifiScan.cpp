@@ -0,0 +1,286 @@
+/*
+ * wifiScan.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Cached background WiFi scan for the provisioning portal.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_event.h>
+#include <esp_timer.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "wifiScan.h"
+
+typedef struct {
+    bool isStarted;
+    bool isScanning;
+    bool hasResults;
+    esp_timer_handle_t Timer;                   /**< Periodic refresh of the results. */
+    esp_event_handler_instance_t Handler;
+    uint32_t ScanTime;                          /**< Time of the last completed scan in ms. */
+    uint8_t Count;
+    WiFiScan_Network_t Networks[CONFIG_NETWORK_PROV_SCAN_MAX];
+} WiFiScan_State_t;
+
+static WiFiScan_State_t _WiFiScan_State;
+
+/* The results are written from the event loop and read from the HTTP server task */
+static portMUX_TYPE _WiFiScan_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *TAG = "wifi_scan";
+
+/** @brief              Add an access point to a sorted list. Every SSID is listed once with its strongest access point.
+ *  @param p_Networks   Sorted list
+ *  @param p_Count      Number of networks in the list
+ *  @param p_Record     Access point of the scan
+ */
+static void WiFiScan_Insert(WiFiScan_Network_t *p_Networks, uint8_t *p_Count, const wifi_ap_record_t *p_Record)
+{
+    uint8_t Index;
+
+    /* Hidden networks can not be selected in the portal */
+    if (p_Record->ssid[0] == '\0') {
+        return;
+    }
+
+    for (uint8_t i = 0; i < *p_Count; i++) {
+        if (strncmp(p_Networks[i].SSID, reinterpret_cast<const char *>(p_Record->ssid), sizeof(p_Networks[i].SSID)) ==
+            0) {
+            if (p_Record->rssi <= p_Networks[i].RSSI) {
+                return;
+            }
+
+            /* Remove the weaker entry, the SSID is inserted again at its new position */
+            memmove(&p_Networks[i], &p_Networks[i + 1], (*p_Count - i - 1) * sizeof(WiFiScan_Network_t));
+            (*p_Count)--;
+
+            break;
+        }
+    }
+
+    Index = 0;
+    while ((Index < *p_Count) && (p_Networks[Index].RSSI >= p_Record->rssi)) {
+        Index++;
+    }
+
+    if (Index >= CONFIG_NETWORK_PROV_SCAN_MAX) {
+        return;
+    }
+
+    if (*p_Count == CONFIG_NETWORK_PROV_SCAN_MAX) {
+        (*p_Count)--;
+    }
+
+    memmove(&p_Networks[Index + 1], &p_Networks[Index], (*p_Count - Index) * sizeof(WiFiScan_Network_t));
+
+    memset(&p_Networks[Index], 0, sizeof(WiFiScan_Network_t));
+    strncpy(p_Networks[Index].SSID, reinterpret_cast<const char *>(p_Record->ssid), sizeof(p_Networks[Index].SSID) - 1);
+    p_Networks[Index].RSSI = p_Record->rssi;
+    p_Networks[Index].Channel = p_Record->primary;
+    p_Networks[Index].AuthMode = p_Record->authmode;
+
+    (*p_Count)++;
+}
+
+/** @brief                  Scan done event handler. Moves the results of the driver into the cache.
+ *  @param p_HandlerArgs    Unused
+ *  @param Base             Event base
+ *  @param ID               Event ID
+ *  @param p_Data           Event data
+ */
+static void on_WiFiScan_Done(void *p_HandlerArgs, esp_event_base_t Base, int32_t ID, void *p_Data)
+{
+    wifi_event_sta_scan_done_t *Event;
+    /* Only used by the event loop task, static to keep it off the small event loop stack */
+    static WiFiScan_Network_t Networks[CONFIG_NETWORK_PROV_SCAN_MAX];
+    wifi_ap_record_t *Records;
+    uint16_t Number;
+    uint8_t Count;
+
+    Event = reinterpret_cast<wifi_event_sta_scan_done_t *>(p_Data);
+    Count = 0;
+
+    Number = 0;
+    esp_wifi_scan_get_ap_num(&Number);
+
+    Records = NULL;
+    if ((Event->status == 0) && (Number > 0)) {
+        Records = reinterpret_cast<wifi_ap_record_t *>(malloc(Number * sizeof(wifi_ap_record_t)));
+    }
+
+    if (Records != NULL) {
+        /* Reading the records also frees them in the driver */
+        if (esp_wifi_scan_get_ap_records(&Number, Records) == ESP_OK) {
+            for (uint16_t i = 0; i < Number; i++) {
+                WiFiScan_Insert(Networks, &Count, &Records[i]);
+            }
+        }
+
+        free(Records);
+    } else {
+        esp_wifi_clear_ap_list();
+    }
+
+    portENTER_CRITICAL(&_WiFiScan_Lock);
+    if (Event->status == 0) {
+        memcpy(_WiFiScan_State.Networks, Networks, Count * sizeof(WiFiScan_Network_t));
+        _WiFiScan_State.Count = Count;
+        _WiFiScan_State.ScanTime = esp_timer_get_time() / 1000;
+        _WiFiScan_State.hasResults = true;
+    }
+    _WiFiScan_State.isScanning = false;
+    portEXIT_CRITICAL(&_WiFiScan_Lock);
+
+    if (Event->status == 0) {
+        ESP_LOGD(TAG, "Scan done, %u networks", Count);
+    } else {
+        ESP_LOGW(TAG, "Scan failed!");
+    }
+}
+
+/** @brief          Refresh timer callback.
+ *  @param p_Arg    Unused
+ */
+static void on_WiFiScan_Timer(void *p_Arg)
+{
+    WiFiScan_Trigger();
+}
+
+esp_err_t WiFiScan_Start(void)
+{
+    esp_err_t Error;
+
+    if (_WiFiScan_State.isStarted) {
+        return WiFiScan_Trigger();
+    }
+
+    if (_WiFiScan_State.Timer == NULL) {
+        const esp_timer_create_args_t TimerArgs = {
+            .callback = on_WiFiScan_Timer,
+            .arg = NULL,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "wifi_scan",
+            .skip_unhandled_events = true,
+        };
+
+        Error = esp_timer_create(&TimerArgs, &_WiFiScan_State.Timer);
+        if (Error != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create refresh timer!");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    Error = esp_event_handler_instance_register(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, &on_WiFiScan_Done, NULL,
+                                                &_WiFiScan_State.Handler);
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register scan handler!");
+        return Error;
+    }
+
+    _WiFiScan_State.isStarted = true;
+
+    esp_timer_start_periodic(_WiFiScan_State.Timer, CONFIG_NETWORK_PROV_SCAN_INTERVAL * 1000000ULL);
+
+    return WiFiScan_Trigger();
+}
+
+void WiFiScan_Stop(void)
+{
+    if (_WiFiScan_State.isStarted == false) {
+        return;
+    }
+
+    esp_timer_stop(_WiFiScan_State.Timer);
+
+    if (_WiFiScan_State.isScanning) {
+        esp_wifi_scan_stop();
+    }
+
+    esp_event_handler_instance_unregister(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, _WiFiScan_State.Handler);
+    _WiFiScan_State.Handler = NULL;
+
+    portENTER_CRITICAL(&_WiFiScan_Lock);
+    _WiFiScan_State.isScanning = false;
+    _WiFiScan_State.isStarted = false;
+    portEXIT_CRITICAL(&_WiFiScan_Lock);
+}
+
+esp_err_t WiFiScan_Trigger(void)
+{
+    wifi_scan_config_t ScanConfig;
+    esp_err_t Error;
+
+    portENTER_CRITICAL(&_WiFiScan_Lock);
+    if ((_WiFiScan_State.isStarted == false) || _WiFiScan_State.isScanning) {
+        bool isStarted = _WiFiScan_State.isStarted;
+
+        portEXIT_CRITICAL(&_WiFiScan_Lock);
+
+        return isStarted ? ESP_OK : ESP_ERR_INVALID_STATE;
+    }
+    _WiFiScan_State.isScanning = true;
+    portEXIT_CRITICAL(&_WiFiScan_Lock);
+
+    memset(&ScanConfig, 0, sizeof(ScanConfig));
+
+    Error = esp_wifi_scan_start(&ScanConfig, false);
+    if (Error != ESP_OK) {
+        ESP_LOGW(TAG, "Scan start failed: %d", Error);
+
+        portENTER_CRITICAL(&_WiFiScan_Lock);
+        _WiFiScan_State.isScanning = false;
+        portEXIT_CRITICAL(&_WiFiScan_Lock);
+    }
+
+    return Error;
+}
+
+esp_err_t WiFiScan_Get(WiFiScan_Result_t *p_Result)
+{
+    uint32_t Now;
+    bool doScan;
+
+    if (p_Result == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    Now = esp_timer_get_time() / 1000;
+
+    portENTER_CRITICAL(&_WiFiScan_Lock);
+    memcpy(p_Result->Networks, _WiFiScan_State.Networks, _WiFiScan_State.Count * sizeof(WiFiScan_Network_t));
+    p_Result->Count = _WiFiScan_State.Count;
+    p_Result->isScanning = _WiFiScan_State.isScanning;
+    p_Result->Age = _WiFiScan_State.hasResults ? (Now - _WiFiScan_State.ScanTime) : 0;
+    p_Result->isStale = (_WiFiScan_State.hasResults == false) ||
+                        (p_Result->Age >= (CONFIG_NETWORK_PROV_SCAN_INTERVAL * 1000UL));
+    doScan = p_Result->isStale && _WiFiScan_State.isStarted && (_WiFiScan_State.isScanning == false);
+    portEXIT_CRITICAL(&_WiFiScan_Lock);
+
+    /* The request is answered with the old results, the next one gets the new ones */
+    if (doScan && (WiFiScan_Trigger() == ESP_OK)) {
+        p_Result->isScanning = true;
+    }
+
+    return ESP_OK;
+}
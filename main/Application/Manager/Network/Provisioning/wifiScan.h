@@ -0,0 +1,79 @@
+/*
+ * wifiScan.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Cached background WiFi scan for the provisioning portal.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef WIFISCAN_H_
+#define WIFISCAN_H_
+
+#include <esp_err.h>
+#include <esp_wifi.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <sdkconfig.h>
+
+/** @brief Network found by the scan.
+ */
+typedef struct {
+    char SSID[33];
+    int8_t RSSI;                                /**< Strongest access point of the SSID in dBm. */
+    uint8_t Channel;
+    wifi_auth_mode_t AuthMode;
+} WiFiScan_Network_t;
+
+/** @brief Copy of the scan cache.
+ */
+typedef struct {
+    uint8_t Count;                              /**< Number of networks, sorted by the RSSI. */
+    bool isScanning;                            /**< A scan is running, the networks are from the previous one. */
+    bool isStale;                               /**< No scan was completed yet or the results are older than the
+                                                     refresh interval. */
+    uint32_t Age;                               /**< Age of the results in ms, 0 if there are none. */
+    WiFiScan_Network_t Networks[CONFIG_NETWORK_PROV_SCAN_MAX];
+} WiFiScan_Result_t;
+
+/** @brief  Start the first scan and refresh the results every CONFIG_NETWORK_PROV_SCAN_INTERVAL seconds. The
+ *          station interface has to be started.
+ *  @return ESP_OK on success
+ *          ESP_ERR_NO_MEM if the refresh timer can not be created
+ */
+esp_err_t WiFiScan_Start(void);
+
+/** @brief Stop the refresh and a running scan. The results are kept for the next start.
+ */
+void WiFiScan_Stop(void);
+
+/** @brief  Start a scan unless one is already running. All requests during a scan share it.
+ *  @return ESP_OK when a scan is running
+ *          ESP_ERR_INVALID_STATE if the scanner is not started
+ */
+esp_err_t WiFiScan_Trigger(void);
+
+/** @brief          Get a copy of the cached results. Never waits for a scan, a stale result starts a new one.
+ *  @param p_Result Pointer to store the results
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if p_Result is NULL
+ */
+esp_err_t WiFiScan_Get(WiFiScan_Result_t *p_Result);
+
+#endif /* WIFISCAN_H_ */
@@ -0,0 +1,283 @@
+/*
+ * backfillRing.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Ring of the recent RAW frames for the backfill of resumed WebSocket streams.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <sdkconfig.h>
+
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+
+#include <esp_log.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include <cstring>
+
+#include "backfillRing.h"
+#include "../ImageEncoder/imageEncoder.h"
+#include "Application/Memory/memoryPlan.h"
+
+/** @brief Metadata of a frame in the ring. The pixels are in the slot of the same index.
+ */
+typedef struct {
+    uint32_t Sequence;
+    uint32_t Timestamp;                         /**< Capture time in milliseconds. */
+    int64_t Time;                               /**< Capture time in microseconds since 1970-01-01 UTC, 0 if not set. */
+} BackfillRing_Entry_t;
+
+typedef struct {
+    bool isInitialized;
+    SemaphoreHandle_t Lock;                     /**< Held while a slot is written or encoded. */
+    uint16_t Capacity;
+    uint16_t Head;                              /**< Slot of the oldest frame. */
+    uint16_t Count;
+    uint16_t Width;                             /**< Geometry of the frames in the buffer, 0 without buffer. */
+    uint16_t Height;
+    uint16_t *Pixels;                           /**< Capacity slots of Width * Height pixels. */
+    BackfillRing_Entry_t *Entries;
+} BackfillRing_State_t;
+
+static BackfillRing_State_t _BackfillRing_State;
+
+static const char *TAG = "backfill_ring";
+
+/** @brief          Get the pixels of a slot.
+ *  @param Slot     Slot index
+ *  @return         Pointer to the pixels
+ */
+static uint16_t *BackfillRing_GetPixels(uint16_t Slot)
+{
+    return _BackfillRing_State.Pixels +
+           (static_cast<size_t>(Slot) * _BackfillRing_State.Width * _BackfillRing_State.Height);
+}
+
+/** @brief          Allocate the buffer for a frame geometry. The frames of another geometry are dropped.
+ *                  Call with the lock taken.
+ *  @param Width    Frame width in pixels
+ *  @param Height   Frame height in pixels
+ *  @return         ESP_OK on success
+ */
+static esp_err_t BackfillRing_Allocate(uint16_t Width, uint16_t Height)
+{
+    size_t Size;
+
+    if ((_BackfillRing_State.Pixels != NULL) && (_BackfillRing_State.Width == Width) &&
+        (_BackfillRing_State.Height == Height)) {
+        return ESP_OK;
+    }
+
+    MemoryPlan_Free(_BackfillRing_State.Pixels);
+    _BackfillRing_State.Pixels = NULL;
+    _BackfillRing_State.Width = 0;
+    _BackfillRing_State.Height = 0;
+    _BackfillRing_State.Head = 0;
+    _BackfillRing_State.Count = 0;
+
+    Size = static_cast<size_t>(_BackfillRing_State.Capacity) * Width * Height * sizeof(uint16_t);
+    _BackfillRing_State.Pixels = reinterpret_cast<uint16_t *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, Size,
+                                                                               "backfill_ring"));
+    if (_BackfillRing_State.Pixels == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %u bytes for %u frames!", static_cast<unsigned int>(Size),
+                 _BackfillRing_State.Capacity);
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    _BackfillRing_State.Width = Width;
+    _BackfillRing_State.Height = Height;
+
+    ESP_LOGI(TAG, "Ring of %u frames (%u x %u) allocated", _BackfillRing_State.Capacity, Width, Height);
+
+    return ESP_OK;
+}
+
+esp_err_t BackfillRing_Init(uint16_t Capacity)
+{
+    size_t Size;
+
+    if (_BackfillRing_State.isInitialized) {
+        return ESP_OK;
+    } else if (Capacity == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(&_BackfillRing_State, 0, sizeof(_BackfillRing_State));
+
+    _BackfillRing_State.Lock = xSemaphoreCreateMutex();
+    if (_BackfillRing_State.Lock == NULL) {
+        ESP_LOGE(TAG, "Failed to create lock!");
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* The metadata is small, only the pixels wait for the first frame */
+    Size = Capacity * sizeof(BackfillRing_Entry_t);
+    _BackfillRing_State.Entries = reinterpret_cast<BackfillRing_Entry_t *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, Size,
+                                                                                            "backfill_entries"));
+    if (_BackfillRing_State.Entries == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate entries!");
+        vSemaphoreDelete(_BackfillRing_State.Lock);
+        _BackfillRing_State.Lock = NULL;
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    _BackfillRing_State.Capacity = Capacity;
+    _BackfillRing_State.isInitialized = true;
+
+    return ESP_OK;
+}
+
+void BackfillRing_Deinit(void)
+{
+    if (_BackfillRing_State.isInitialized == false) {
+        return;
+    }
+
+    xSemaphoreTake(_BackfillRing_State.Lock, portMAX_DELAY);
+    _BackfillRing_State.isInitialized = false;
+    MemoryPlan_Free(_BackfillRing_State.Pixels);
+    MemoryPlan_Free(_BackfillRing_State.Entries);
+    _BackfillRing_State.Pixels = NULL;
+    _BackfillRing_State.Entries = NULL;
+    xSemaphoreGive(_BackfillRing_State.Lock);
+
+    vSemaphoreDelete(_BackfillRing_State.Lock);
+    _BackfillRing_State.Lock = NULL;
+}
+
+esp_err_t BackfillRing_Record(const Network_Thermal_Frame_t *p_Frame)
+{
+    BackfillRing_Entry_t *Entry;
+    uint16_t Slot;
+    esp_err_t Error;
+
+    if (p_Frame == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_BackfillRing_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    } else if ((p_Frame->raw == NULL) || (p_Frame->sequence == 0)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    xSemaphoreTake(_BackfillRing_State.Lock, portMAX_DELAY);
+
+    /* The frame is offered again for every notification that did not bring a new frame */
+    if (_BackfillRing_State.Count > 0) {
+        Slot = (_BackfillRing_State.Head + _BackfillRing_State.Count - 1) % _BackfillRing_State.Capacity;
+        if (_BackfillRing_State.Entries[Slot].Sequence == p_Frame->sequence) {
+            xSemaphoreGive(_BackfillRing_State.Lock);
+
+            return ESP_OK;
+        }
+    }
+
+    Error = BackfillRing_Allocate(p_Frame->width, p_Frame->height);
+    if (Error != ESP_OK) {
+        xSemaphoreGive(_BackfillRing_State.Lock);
+
+        return Error;
+    }
+
+    if (_BackfillRing_State.Count == _BackfillRing_State.Capacity) {
+        _BackfillRing_State.Head = (_BackfillRing_State.Head + 1) % _BackfillRing_State.Capacity;
+        _BackfillRing_State.Count--;
+    }
+
+    Slot = (_BackfillRing_State.Head + _BackfillRing_State.Count) % _BackfillRing_State.Capacity;
+    Entry = &_BackfillRing_State.Entries[Slot];
+    Entry->Sequence = p_Frame->sequence;
+    Entry->Timestamp = p_Frame->timestamp;
+    Entry->Time = p_Frame->time;
+    memcpy(BackfillRing_GetPixels(Slot), p_Frame->raw,
+           static_cast<size_t>(p_Frame->width) * p_Frame->height * sizeof(uint16_t));
+    _BackfillRing_State.Count++;
+
+    xSemaphoreGive(_BackfillRing_State.Lock);
+
+    return ESP_OK;
+}
+
+esp_err_t BackfillRing_Encode(uint32_t Sequence, Network_Encoded_Image_t *p_Encoded)
+{
+    Network_Thermal_Frame_t Frame;
+    esp_err_t Error;
+
+    if (p_Encoded == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_BackfillRing_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(_BackfillRing_State.Lock, portMAX_DELAY);
+
+    /* The lock keeps the slot from being replaced while it is encoded */
+    Error = ESP_ERR_NOT_FOUND;
+    for (uint16_t i = 0; i < _BackfillRing_State.Count; i++) {
+        uint16_t Slot = (_BackfillRing_State.Head + i) % _BackfillRing_State.Capacity;
+        const BackfillRing_Entry_t *Entry = &_BackfillRing_State.Entries[Slot];
+
+        /* Sequence numbers compared across a wrap around */
+        if (static_cast<int32_t>(Entry->Sequence - Sequence) < 0) {
+            continue;
+        }
+
+        memset(&Frame, 0, sizeof(Frame));
+        Frame.raw = BackfillRing_GetPixels(Slot);
+        Frame.width = _BackfillRing_State.Width;
+        Frame.height = _BackfillRing_State.Height;
+        Frame.sequence = Entry->Sequence;
+        Frame.timestamp = Entry->Timestamp;
+        Frame.time = Entry->Time;
+
+        Error = ImageEncoder_EncodeKeyframe(&Frame, p_Encoded);
+        break;
+    }
+
+    xSemaphoreGive(_BackfillRing_State.Lock);
+
+    return Error;
+}
+
+bool BackfillRing_GetRange(uint32_t *p_Oldest, uint32_t *p_Newest)
+{
+    bool isFilled;
+
+    if ((p_Oldest == NULL) || (p_Newest == NULL) || (_BackfillRing_State.isInitialized == false)) {
+        return false;
+    }
+
+    xSemaphoreTake(_BackfillRing_State.Lock, portMAX_DELAY);
+
+    isFilled = _BackfillRing_State.Count > 0;
+    if (isFilled) {
+        *p_Oldest = _BackfillRing_State.Entries[_BackfillRing_State.Head].Sequence;
+        *p_Newest = _BackfillRing_State.Entries[(_BackfillRing_State.Head + _BackfillRing_State.Count - 1) %
+                                                _BackfillRing_State.Capacity].Sequence;
+    }
+
+    xSemaphoreGive(_BackfillRing_State.Lock);
+
+    return isFilled;
+}
+
+#endif /* CONFIG_NETWORK_WS_BACKFILL */
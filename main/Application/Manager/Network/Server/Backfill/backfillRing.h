@@ -0,0 +1,75 @@
+/*
+ * backfillRing.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Ring of the recent RAW frames for the backfill of resumed WebSocket streams.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef BACKFILL_RING_H_
+#define BACKFILL_RING_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../../networkTypes.h"
+
+/** @brief          Initialize the ring. The buffer is allocated in the PSRAM with the first recorded frame, so the
+ *                  ring costs no memory until a stream needs it.
+ *  @param Capacity Number of frames of the ring
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if Capacity is 0
+ *                  ESP_ERR_NO_MEM if the lock can not be created
+ */
+esp_err_t BackfillRing_Init(uint16_t Capacity);
+
+/** @brief Deinitialize the ring and free the buffer.
+ */
+void BackfillRing_Deinit(void);
+
+/** @brief          Copy a frame into the ring. The oldest frame is replaced when the ring is full. Frames without
+ *                  RAW data or sequence number and frames that are already in the ring are skipped. Call with the
+ *                  mutex of the frame taken.
+ *  @param p_Frame  Thermal frame
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_NOT_SUPPORTED if the frame has no RAW data or no sequence number
+ *                  ESP_ERR_NO_MEM if the buffer can not be allocated
+ */
+esp_err_t BackfillRing_Record(const Network_Thermal_Frame_t *p_Frame);
+
+/** @brief              Encode the oldest frame of the ring with a sequence number of at least Sequence as
+ *                      radiometric keyframe, see ImageEncoder_EncodeKeyframe. The sequence number of the frame is in
+ *                      the sequence of the image, it is larger than Sequence when the frames in between are gone.
+ *  @param Sequence     First wanted sequence number
+ *  @param p_Encoded    Pointer to store the keyframe, must be returned with ImageEncoder_Free
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_NOT_FOUND if the ring has no such frame yet
+ *                      ESP_ERR_NO_MEM if the encoder pool has no buffer
+ */
+esp_err_t BackfillRing_Encode(uint32_t Sequence, Network_Encoded_Image_t *p_Encoded);
+
+/** @brief              Get the sequence numbers of the frames in the ring.
+ *  @param p_Oldest     Pointer to store the sequence number of the oldest frame
+ *  @param p_Newest     Pointer to store the sequence number of the newest frame
+ *  @return             false if the ring is empty
+ */
+bool BackfillRing_GetRange(uint32_t *p_Oldest, uint32_t *p_Newest);
+
+#endif /* BACKFILL_RING_H_ */
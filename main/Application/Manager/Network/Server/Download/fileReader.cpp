@@ -0,0 +1,286 @@
+/*
+ * fileReader.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Read-ahead file reader for the SD card downloads.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sdkconfig.h>
+
+#include "fileReader.h"
+
+/** @brief Read job for the reader task.
+ */
+typedef struct {
+    FileReader_File_t *p_File;
+    uint8_t Index;                              /**< Buffer to fill. */
+} FileReader_Job_t;
+
+/** @brief Filled buffer for the owner of a file.
+ */
+typedef struct {
+    uint8_t Index;
+    int32_t Length;                             /**< Number of valid bytes, 0 at the end of the file, -1 on error. */
+} FileReader_Block_t;
+
+struct FileReader_File_t {
+    bool isActive;
+    int File;
+    uint32_t Position;                          /**< Next byte to read. Only used by the reader task. */
+    uint32_t Remaining;                         /**< Bytes left to read. Only used by the reader task. */
+    uint8_t *Buffers[FILE_READER_BUFFERS];
+    QueueHandle_t DoneQueue;                    /**< Filled buffers for the owner of the file. */
+    uint8_t Queued;                             /**< Buffers owned by the reader task. Only used by the owner. */
+    int8_t Held;                                /**< Buffer returned by the last read, -1 if none. */
+};
+
+typedef struct {
+    TaskHandle_t Task;
+    QueueHandle_t JobQueue;                     /**< Read jobs of all files, served in order. */
+    FileReader_File_t Files[CONFIG_NETWORK_DOWNLOAD_MAX];
+} FileReader_State_t;
+
+static FileReader_State_t _FileReader_State;
+
+/* Protects the file slots, Open and Close are called from the HTTP server task and the download tasks */
+static portMUX_TYPE _FileReader_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *TAG = "file_reader";
+
+/** @brief          Reader task. Fills the buffers of all open files, so the SD card is read while the previous
+ *                  buffer is sent.
+ *  @param p_Param  Unused
+ */
+static void FileReader_Task(void *p_Param)
+{
+    FileReader_Job_t Job;
+
+    while (true) {
+        FileReader_File_t *p_File;
+        FileReader_Block_t Block;
+        size_t Length;
+
+        xQueueReceive(_FileReader_State.JobQueue, &Job, portMAX_DELAY);
+
+        p_File = Job.p_File;
+        Length = (p_File->Remaining < CONFIG_NETWORK_DOWNLOAD_CHUNK_SIZE) ? p_File->Remaining :
+                 CONFIG_NETWORK_DOWNLOAD_CHUNK_SIZE;
+
+        Block.Index = Job.Index;
+        Block.Length = 0;
+
+        if (Length > 0) {
+            ssize_t Read;
+
+            Read = pread(p_File->File, p_File->Buffers[Job.Index], Length, p_File->Position);
+            if (Read <= 0) {
+                ESP_LOGE(TAG, "Failed to read at %u!", static_cast<unsigned int>(p_File->Position));
+
+                /* Every following job of this file reports the error too */
+                p_File->Remaining = 0;
+                Block.Length = -1;
+            } else {
+                p_File->Position += Read;
+                p_File->Remaining -= Read;
+                Block.Length = Read;
+            }
+        }
+
+        xQueueSend(p_File->DoneQueue, &Block, portMAX_DELAY);
+    }
+}
+
+/** @brief          Hand a buffer to the reader task.
+ *  @param p_File   Pointer to the file
+ *  @param Index    Buffer to fill
+ */
+static void FileReader_Queue(FileReader_File_t *p_File, uint8_t Index)
+{
+    FileReader_Job_t Job;
+
+    Job.p_File = p_File;
+    Job.Index = Index;
+
+    p_File->Queued++;
+    xQueueSend(_FileReader_State.JobQueue, &Job, portMAX_DELAY);
+}
+
+/** @brief          Close the file, free the buffers and the queue and release the slot.
+ *  @param p_File   Pointer to the file
+ */
+static void FileReader_Free(FileReader_File_t *p_File)
+{
+    for (uint8_t i = 0; i < FILE_READER_BUFFERS; i++) {
+        if (p_File->Buffers[i] != NULL) {
+            heap_caps_free(p_File->Buffers[i]);
+            p_File->Buffers[i] = NULL;
+        }
+    }
+
+    if (p_File->DoneQueue != NULL) {
+        vQueueDelete(p_File->DoneQueue);
+        p_File->DoneQueue = NULL;
+    }
+
+    if (p_File->File >= 0) {
+        close(p_File->File);
+        p_File->File = -1;
+    }
+
+    portENTER_CRITICAL(&_FileReader_Lock);
+    p_File->isActive = false;
+    portEXIT_CRITICAL(&_FileReader_Lock);
+}
+
+esp_err_t FileReader_Open(const char *p_Path, uint32_t Offset, uint32_t Length, FileReader_Handle_t *p_Handle)
+{
+    FileReader_File_t *p_File = NULL;
+
+    if ((p_Path == NULL) || (p_Handle == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&_FileReader_Lock);
+    for (uint8_t i = 0; i < CONFIG_NETWORK_DOWNLOAD_MAX; i++) {
+        if (_FileReader_State.Files[i].isActive == false) {
+            p_File = &_FileReader_State.Files[i];
+            p_File->isActive = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&_FileReader_Lock);
+
+    if (p_File == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    p_File->Position = Offset;
+    p_File->Remaining = Length;
+    p_File->Queued = 0;
+    p_File->Held = -1;
+
+    p_File->File = open(p_Path, O_RDONLY);
+    if (p_File->File < 0) {
+        FileReader_Free(p_File);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    p_File->DoneQueue = xQueueCreate(FILE_READER_BUFFERS, sizeof(FileReader_Block_t));
+    if (p_File->DoneQueue == NULL) {
+        FileReader_Free(p_File);
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (uint8_t i = 0; i < FILE_READER_BUFFERS; i++) {
+        p_File->Buffers[i] = reinterpret_cast<uint8_t *>(heap_caps_malloc(CONFIG_NETWORK_DOWNLOAD_CHUNK_SIZE,
+                                                                          MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL));
+        if (p_File->Buffers[i] == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate read buffer!");
+            FileReader_Free(p_File);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    /* Only the HTTP server task opens files, so the task is never created twice */
+    if (_FileReader_State.Task == NULL) {
+        _FileReader_State.JobQueue = xQueueCreate(CONFIG_NETWORK_DOWNLOAD_MAX * FILE_READER_BUFFERS,
+                                                  sizeof(FileReader_Job_t));
+        if ((_FileReader_State.JobQueue == NULL) ||
+            (xTaskCreatePinnedToCore(FileReader_Task, "File_Reader", CONFIG_NETWORK_DOWNLOAD_TASK_STACKSIZE, NULL,
+                                     CONFIG_NETWORK_DOWNLOAD_TASK_PRIO, &_FileReader_State.Task,
+                                     CONFIG_NETWORK_DOWNLOAD_TASK_CORE) != pdPASS)) {
+            ESP_LOGE(TAG, "Failed to create reader task!");
+
+            if (_FileReader_State.JobQueue != NULL) {
+                vQueueDelete(_FileReader_State.JobQueue);
+                _FileReader_State.JobQueue = NULL;
+            }
+
+            _FileReader_State.Task = NULL;
+            FileReader_Free(p_File);
+
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    /* Both buffers are read ahead before the first block is requested */
+    for (uint8_t i = 0; i < FILE_READER_BUFFERS; i++) {
+        FileReader_Queue(p_File, i);
+    }
+
+    *p_Handle = p_File;
+
+    return ESP_OK;
+}
+
+esp_err_t FileReader_Read(FileReader_Handle_t Handle, const uint8_t **pp_Data, size_t *p_Length)
+{
+    FileReader_Block_t Block;
+
+    if ((Handle == NULL) || (pp_Data == NULL) || (p_Length == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* The previous block has been sent, so its buffer is refilled while the next one is sent */
+    if (Handle->Held >= 0) {
+        FileReader_Queue(Handle, Handle->Held);
+        Handle->Held = -1;
+    }
+
+    xQueueReceive(Handle->DoneQueue, &Block, portMAX_DELAY);
+    Handle->Queued--;
+    Handle->Held = Block.Index;
+
+    if (Block.Length < 0) {
+        return ESP_FAIL;
+    }
+
+    *pp_Data = Handle->Buffers[Block.Index];
+    *p_Length = Block.Length;
+
+    return ESP_OK;
+}
+
+void FileReader_Close(FileReader_Handle_t Handle)
+{
+    FileReader_Block_t Block;
+
+    if (Handle == NULL) {
+        return;
+    }
+
+    /* The reader task may still write into the buffers of the queued jobs */
+    while (Handle->Queued > 0) {
+        xQueueReceive(Handle->DoneQueue, &Block, portMAX_DELAY);
+        Handle->Queued--;
+    }
+
+    FileReader_Free(Handle);
+}
@@ -0,0 +1,71 @@
+/*
+ * fileReader.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Read-ahead file reader for the SD card downloads.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef FILE_READER_H_
+#define FILE_READER_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** @brief Number of read buffers of a file. One buffer is sent while the reader task fills the other one.
+ */
+#define FILE_READER_BUFFERS                     2
+
+/** @brief Handle of an open file.
+ */
+typedef struct FileReader_File_t *FileReader_Handle_t;
+
+/** @brief              Open a file and start reading ahead. The buffers of CONFIG_NETWORK_DOWNLOAD_CHUNK_SIZE bytes
+ *                      are allocated from the DMA capable internal RAM, so the SD driver reads straight into them.
+ *                      The reader task is created with the first file and serves all open files in turn.
+ *  @param p_Path       Path of the file
+ *  @param Offset       First byte to read
+ *  @param Length       Number of bytes to read
+ *  @param p_Handle     Pointer to store the handle
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if a parameter is NULL
+ *                      ESP_ERR_NOT_FOUND if the file can not be opened
+ *                      ESP_ERR_NO_MEM if all CONFIG_NETWORK_DOWNLOAD_MAX files are open or the buffers or the task
+ *                      can not be allocated
+ */
+esp_err_t FileReader_Open(const char *p_Path, uint32_t Offset, uint32_t Length, FileReader_Handle_t *p_Handle);
+
+/** @brief              Get the next block of the file. The block of the previous call is handed back to the reader
+ *                      task, so it is only valid until the next call. Blocks while the reader task fills the buffer.
+ *  @param Handle       Handle from FileReader_Open
+ *  @param pp_Data      Pointer to store the data
+ *  @param p_Length     Pointer to store the length of the data, 0 at the end of the file
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if a parameter is NULL
+ *                      ESP_FAIL if the file can not be read
+ */
+esp_err_t FileReader_Read(FileReader_Handle_t Handle, const uint8_t **pp_Data, size_t *p_Length);
+
+/** @brief          Close a file. Waits for a running read of the reader task, then the buffers are freed.
+ *  @param Handle   Handle from FileReader_Open
+ */
+void FileReader_Close(FileReader_Handle_t Handle);
+
+#endif /* FILE_READER_H_ */
@@ -25,53 +25,1211 @@
 #include <esp_heap_caps.h>
 #include <esp_jpeg_enc.h>
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
 #include <cstring>
 
+#include <sdkconfig.h>
+
 #include "imageEncoder.h"
+#include "rawCodec.h"
+#include "tileDiff.h"
 
 #include "lepton.h"
+#include "Application/Tasks/Lepton/frameProducts.h"
+#include "Application/Tasks/Lepton/leptonTask.h"
+#include "Application/Tasks/Lepton/isotherm.h"
+#include "Application/Trace/trace.h"
+#include "Application/Memory/memoryPlan.h"
+
+/** @brief Long-lived JPEG encoder handle for one configuration.
+ */
+typedef struct {
+    jpeg_enc_handle_t Handle;
+    uint16_t Width;
+    uint16_t Height;
+    uint8_t Quality;
+    jpeg_subsampling_t Subsampling;
+    uint32_t LastUsed;
+} ImageEncoder_Context_t;
+
+/** @brief Preallocated output buffer.
+ */
+typedef struct {
+    uint8_t *Data;
+    size_t Capacity;
+    uint8_t RefCount;                           /**< Number of encoded images and cache entries using the buffer. */
+} ImageEncoder_Buffer_t;
+
+#ifdef CONFIG_LEPTON_ISOTHERMS
+/** @brief Entry of the index table. The lower byte is the palette index, the upper byte the isotherm band + 1 or 0.
+ */
+typedef uint16_t ImageEncoder_Index_t;
+#else
+typedef uint8_t ImageEncoder_Index_t;
+#endif
+
+/** @brief Encoded image of a frame.
+ */
+typedef struct {
+    bool isValid;
+    uint32_t Sequence;                          /**< Sequence number of the encoded frame. */
+    Network_ImageFormat_t Format;
+    Server_Palette_t Palette;
+    uint8_t Quality;
+    Network_ImageLevel_t Level;
+    Network_ImageWindow_t Window;               /**< Clipped crop window, Width 0 for the full frame. */
+    Network_Encoded_Image_t Image;              /**< Encoded image, holds one buffer reference. */
+} ImageEncoder_CacheEntry_t;
+
+/** @brief Pyramid level of the current frame.
+ */
+typedef struct {
+    uint32_t Sequence;                          /**< Sequence number of the frame of the level, 0 if not built. */
+    bool isRAW;                                 /**< true if Data holds RAW pixels, false for RGB888 pixels. */
+    uint8_t *Data;
+    size_t Size;                                /**< Size of Data in bytes. */
+} ImageEncoder_Level_t;
 
 typedef struct {
     bool isInitialized;
     uint8_t JpegQuality;
+    uint32_t UseCounter;
+    size_t ObservedSize;                        /**< Largest JPEG size seen so far. */
+    uint32_t CacheHits;
+    uint32_t CacheMisses;
+    SemaphoreHandle_t Mutex;
+    ImageEncoder_Context_t Contexts[IMAGE_ENCODER_MAX_CONTEXTS];
+    ImageEncoder_Buffer_t Buffers[IMAGE_ENCODER_POOL_BUFFERS];
+    ImageEncoder_CacheEntry_t Cache[IMAGE_ENCODER_CACHE_ENTRIES];
+    uint8_t Palettes[PALETTE_COUNT][256][3];    /**< Palette colors, part of .bss and therefore in internal SRAM. */
+    ImageEncoder_Index_t *IndexLUT;             /**< RAW to palette index table with IMAGE_ENCODER_INDEX_LUT_SIZE
+                                                     entries. */
+    bool isIndexValid;                          /**< true when IndexLUT matches IndexMin and IndexMax. */
+    uint16_t IndexMin;                          /**< Lower end of the AGC window of IndexLUT. */
+    uint16_t IndexMax;                          /**< Upper end of the AGC window of IndexLUT. */
+    uint16_t IndexEnd;                          /**< Last IndexLUT entry inside the AGC window. */
+    uint8_t IndexShift;                         /**< Right shift applied to (Raw - IndexMin) before the lookup. */
+#ifdef CONFIG_LEPTON_ISOTHERMS
+    Isotherm_Set_t Isotherms;                   /**< Bands patched into IndexLUT. */
+#endif
+    uint8_t *Scratch;                           /**< Colorized RGB888 frame for the JPEG encoder. */
+    size_t ScratchSize;
+    uint16_t *Keyframe;                         /**< RAW frame the radiometric delta frames refer to. */
+    size_t KeyframeSize;                        /**< Number of pixels of Keyframe. */
+    uint32_t KeyframeSequence;
+    uint16_t KeyframeAge;                       /**< Delta frames since the keyframe. */
+    bool isKeyframeRequested;
+    ImageEncoder_Level_t Levels[NETWORK_IMAGE_LEVEL_COUNT];     /**< Pyramid of the current frame, the native level
+                                                                     is the frame itself. */
+    ImageEncoder_Level_t Region;                /**< Crop window of the current frame. */
+    Network_ImageWindow_t RegionWindow;         /**< Clipped window of Region. */
 } ImageEncoder_State_t;
 
-static ImageEncoder_State_t _Encoder_State;
+#define IMAGE_ENCODER_INDEX_LUT_SIZE            (1 << IMAGE_ENCODER_INDEX_LUT_BITS)
+
+static ImageEncoder_State_t _Encoder_State;
+
+static const char *TAG = "image_encoder";
+
+/** @brief Palette names in the order of Server_Palette_t.
+ */
+static const char *const _Encoder_PaletteNames[PALETTE_COUNT] = {
+    "iron",
+    "gray",
+    "rainbow",
+    "custom",
+};
+
+/** @brief Names of the image formats, indexed by Network_ImageFormat_t.
+ */
+static const char *const _Encoder_FormatNames[] = {
+    "jpeg",
+    "png",
+    "raw",
+    "indexed",
+    "palette",
+    "radiometric",
+    "temperature",
+};
+
+/** @brief Names of the pyramid levels, indexed by Network_ImageLevel_t.
+ */
+static const char *const _Encoder_LevelNames[NETWORK_IMAGE_LEVEL_COUNT] = {
+    "native",
+    "half",
+    "double",
+};
+
+/** @brief              Box filter an image to half its width and height. Every output pixel is the mean of 2x2
+ *                      input pixels, an odd last row or column is dropped.
+ *  @param p_Src        Input image
+ *  @param Width        Input width
+ *  @param Height       Input height
+ *  @param p_Dst        Output image ((Width / 2) * (Height / 2) pixels)
+ */
+template <typename Pixel_t, uint8_t Channels>
+static void ImageEncoder_Halve(const Pixel_t *p_Src, uint16_t Width, uint16_t Height, Pixel_t *p_Dst)
+{
+    size_t Stride = static_cast<size_t>(Width) * Channels;
+
+    for (uint16_t y = 0; y < (Height / 2); y++) {
+        const Pixel_t *p_Top = p_Src + (2 * y * Stride);
+        const Pixel_t *p_Bottom = p_Top + Stride;
+
+        for (uint16_t x = 0; x < (Width / 2); x++) {
+            for (uint8_t c = 0; c < Channels; c++) {
+                uint32_t Sum = static_cast<uint32_t>(p_Top[c]) + p_Top[Channels + c] + p_Bottom[c] +
+                               p_Bottom[Channels + c];
+
+                *p_Dst++ = static_cast<Pixel_t>((Sum + 2) / 4);
+            }
+
+            p_Top += 2 * Channels;
+            p_Bottom += 2 * Channels;
+        }
+    }
+}
+
+/** @brief              Bilinear interpolate an image to double its width and height. The output pixels lie at a
+ *                      quarter of an input pixel around the input pixel centers, so every output pixel mixes its
+ *                      input pixel with 9/16 and the neighbours towards it with 3/16 and 1/16.
+ *  @param p_Src        Input image
+ *  @param Width        Input width
+ *  @param Height       Input height
+ *  @param p_Dst        Output image ((Width * 2) * (Height * 2) pixels)
+ */
+template <typename Pixel_t, uint8_t Channels>
+static void ImageEncoder_Double(const Pixel_t *p_Src, uint16_t Width, uint16_t Height, Pixel_t *p_Dst)
+{
+    size_t Stride = static_cast<size_t>(Width) * Channels;
+
+    for (uint32_t Y = 0; Y < (2 * static_cast<uint32_t>(Height)); Y++) {
+        uint16_t y0 = Y / 2;
+        uint16_t y1;
+
+        /* Even rows lean towards the row above, odd rows towards the row below. The edges repeat */
+        if (Y & 0x01) {
+            y1 = (y0 + 1 < Height) ? (y0 + 1) : y0;
+        } else {
+            y1 = (y0 > 0) ? (y0 - 1) : y0;
+        }
+
+        const Pixel_t *p_Near = p_Src + (y0 * Stride);
+        const Pixel_t *p_Far = p_Src + (y1 * Stride);
+
+        for (uint32_t X = 0; X < (2 * static_cast<uint32_t>(Width)); X++) {
+            uint16_t x0 = X / 2;
+            uint16_t x1;
+
+            if (X & 0x01) {
+                x1 = (x0 + 1 < Width) ? (x0 + 1) : x0;
+            } else {
+                x1 = (x0 > 0) ? (x0 - 1) : x0;
+            }
+
+            for (uint8_t c = 0; c < Channels; c++) {
+                uint32_t Sum = (9 * static_cast<uint32_t>(p_Near[(x0 * Channels) + c])) +
+                               (3 * static_cast<uint32_t>(p_Near[(x1 * Channels) + c])) +
+                               (3 * static_cast<uint32_t>(p_Far[(x0 * Channels) + c])) +
+                               static_cast<uint32_t>(p_Far[(x1 * Channels) + c]);
+
+                *p_Dst++ = static_cast<Pixel_t>((Sum + 8) / 16);
+            }
+        }
+    }
+}
+
+/** @brief              Cut a region from an image and bilinear scale it by the zoom of the window. The output pixels
+ *                      lie at the centers of Zoom x Zoom subpixels of the input pixels, so zoom 2 mixes like
+ *                      ImageEncoder_Double and zoom 1 is a plain crop. Pixels outside of the region but inside of
+ *                      the image take part in the interpolation at the edges of the region.
+ *  @param p_Src        Input image
+ *  @param Width        Input width
+ *  @param Height       Input height
+ *  @param p_Window     Clipped window
+ *  @param p_Dst        Output image ((Window width * Zoom) * (Window height * Zoom) pixels)
+ */
+template <typename Pixel_t, uint8_t Channels>
+static void ImageEncoder_Zoom(const Pixel_t *p_Src, uint16_t Width, uint16_t Height,
+                              const Network_ImageWindow_t *p_Window, Pixel_t *p_Dst)
+{
+    size_t Stride = static_cast<size_t>(Width) * Channels;
+    int32_t Span = 2 * p_Window->Zoom;
+
+    for (uint32_t Y = 0; Y < (static_cast<uint32_t>(p_Window->Height) * p_Window->Zoom); Y++) {
+        /* Position of the output row in 1 / Span input rows, the left and upper edges can start before row 0 */
+        int32_t Py = (Span * p_Window->Y) + (2 * static_cast<int32_t>(Y)) + 1 - p_Window->Zoom;
+        int32_t y0 = (Py >= 0) ? (Py / Span) : -1;
+        int32_t Wy = Py - (y0 * Span);
+        const Pixel_t *p_Top = p_Src + (((y0 < 0) ? 0 : y0) * Stride);
+        const Pixel_t *p_Bottom = p_Src + ((((y0 + 1) < Height) ? (y0 + 1) : (Height - 1)) * Stride);
+
+        for (uint32_t X = 0; X < (static_cast<uint32_t>(p_Window->Width) * p_Window->Zoom); X++) {
+            int32_t Px = (Span * p_Window->X) + (2 * static_cast<int32_t>(X)) + 1 - p_Window->Zoom;
+            int32_t x0 = (Px >= 0) ? (Px / Span) : -1;
+            int32_t Wx = Px - (x0 * Span);
+            uint32_t Left = ((x0 < 0) ? 0 : x0) * Channels;
+            uint32_t Right = (((x0 + 1) < Width) ? (x0 + 1) : (Width - 1)) * Channels;
+
+            for (uint8_t c = 0; c < Channels; c++) {
+                uint32_t Upper = ((Span - Wx) * static_cast<uint32_t>(p_Top[Left + c])) +
+                                 (Wx * static_cast<uint32_t>(p_Top[Right + c]));
+                uint32_t Lower = ((Span - Wx) * static_cast<uint32_t>(p_Bottom[Left + c])) +
+                                 (Wx * static_cast<uint32_t>(p_Bottom[Right + c]));
+                uint32_t Sum = ((Span - Wy) * Upper) + (Wy * Lower);
+
+                *p_Dst++ = static_cast<Pixel_t>((Sum + ((Span * Span) / 2)) / (Span * Span));
+            }
+        }
+    }
+}
+
+/** @brief          Get the crop window of a frame. The region is built once per frame and window, all formats and
+ *                  palettes of the window share it. Call with the mutex taken.
+ *  @param p_Frame  Thermal frame
+ *  @param p_Window Clipped window
+ *  @param p_Region Pointer to store the frame of the region. The frame has no frame pool slot, so the AGC window is
+ *                  taken from the pixels of the region
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_NO_MEM if the region can not be allocated
+ */
+static esp_err_t ImageEncoder_GetRegion(const Network_Thermal_Frame_t *p_Frame, const Network_ImageWindow_t *p_Window,
+                                        Network_Thermal_Frame_t *p_Region)
+{
+    ImageEncoder_Level_t *p_Buffer;
+    uint16_t Width;
+    uint16_t Height;
+    size_t Size;
+    bool isRAW;
+
+    Width = p_Window->Width * p_Window->Zoom;
+    Height = p_Window->Height * p_Window->Zoom;
+
+    isRAW = (p_Frame->raw != NULL);
+    Size = static_cast<size_t>(Width) * Height * (isRAW ? sizeof(uint16_t) : 3);
+    p_Buffer = &_Encoder_State.Region;
+
+    if ((p_Frame->sequence == 0) || (p_Buffer->Sequence != p_Frame->sequence) || (p_Buffer->isRAW != isRAW) ||
+        (ImageEncoder_isSameWindow(&_Encoder_State.RegionWindow, p_Window) == false)) {
+        if (p_Buffer->Size < Size) {
+            MemoryPlan_Free(p_Buffer->Data);
+            p_Buffer->Size = 0;
+
+            p_Buffer->Data = reinterpret_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, Size, "encoder_region"));
+            if (p_Buffer->Data == NULL) {
+                ESP_LOGE(TAG, "Failed to allocate crop window!");
+                p_Buffer->Sequence = 0;
+                return ESP_ERR_NO_MEM;
+            }
+
+            p_Buffer->Size = Size;
+        }
+
+        if (isRAW) {
+            ImageEncoder_Zoom<uint16_t, 1>(p_Frame->raw, p_Frame->width, p_Frame->height, p_Window,
+                                           reinterpret_cast<uint16_t *>(p_Buffer->Data));
+        } else {
+            ImageEncoder_Zoom<uint8_t, 3>(p_Frame->buffer, p_Frame->width, p_Frame->height, p_Window, p_Buffer->Data);
+        }
+
+        p_Buffer->Sequence = p_Frame->sequence;
+        p_Buffer->isRAW = isRAW;
+        _Encoder_State.RegionWindow = *p_Window;
+    }
+
+    *p_Region = *p_Frame;
+    p_Region->width = Width;
+    p_Region->height = Height;
+    p_Region->raw = isRAW ? reinterpret_cast<uint16_t *>(p_Buffer->Data) : NULL;
+    p_Region->buffer = isRAW ? NULL : p_Buffer->Data;
+
+    /* The statistics of the slot cover the full frame, the colors of a region use its own range */
+    p_Region->frame = NULL;
+
+    return ESP_OK;
+}
+
+/** @brief          Get a pyramid level of a frame. The level is built once per frame, all formats and palettes of
+ *                  the frame share it. Call with the mutex taken.
+ *  @param p_Frame  Thermal frame
+ *  @param Level    Pyramid level
+ *  @param p_Level  Pointer to store the frame of the level. The pixels of the level replace the pixels of the frame,
+ *                  the statistics are the ones of the frame
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if the frame is too small for the level
+ *                  ESP_ERR_NO_MEM if the level can not be allocated
+ */
+static esp_err_t ImageEncoder_GetLevel(const Network_Thermal_Frame_t *p_Frame, Network_ImageLevel_t Level,
+                                       Network_Thermal_Frame_t *p_Level)
+{
+    ImageEncoder_Level_t *p_Pyramid;
+    uint16_t Width;
+    uint16_t Height;
+    size_t Size;
+    bool isRAW;
+
+    *p_Level = *p_Frame;
+
+    if (Level == NETWORK_IMAGE_LEVEL_NATIVE) {
+        return ESP_OK;
+    }
+
+    if (Level == NETWORK_IMAGE_LEVEL_HALF) {
+        Width = p_Frame->width / 2;
+        Height = p_Frame->height / 2;
+    } else {
+        Width = p_Frame->width * 2;
+        Height = p_Frame->height * 2;
+    }
+
+    if ((Width == 0) || (Height == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* The RAW pixels keep every format of the level available. Frames without RAW data scale their colors */
+    isRAW = (p_Frame->raw != NULL);
+    Size = static_cast<size_t>(Width) * Height * (isRAW ? sizeof(uint16_t) : 3);
+    p_Pyramid = &_Encoder_State.Levels[Level];
+
+    if ((p_Frame->sequence == 0) || (p_Pyramid->Sequence != p_Frame->sequence) || (p_Pyramid->isRAW != isRAW)) {
+        if (p_Pyramid->Size < Size) {
+            MemoryPlan_Free(p_Pyramid->Data);
+            p_Pyramid->Size = 0;
+
+            p_Pyramid->Data = reinterpret_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, Size,
+                                                                           "encoder_pyramid"));
+            if (p_Pyramid->Data == NULL) {
+                ESP_LOGE(TAG, "Failed to allocate pyramid level %s!", _Encoder_LevelNames[Level]);
+                p_Pyramid->Sequence = 0;
+                return ESP_ERR_NO_MEM;
+            }
+
+            p_Pyramid->Size = Size;
+        }
+
+        if (isRAW && (Level == NETWORK_IMAGE_LEVEL_HALF)) {
+            ImageEncoder_Halve<uint16_t, 1>(p_Frame->raw, p_Frame->width, p_Frame->height,
+                                            reinterpret_cast<uint16_t *>(p_Pyramid->Data));
+        } else if (isRAW) {
+            ImageEncoder_Double<uint16_t, 1>(p_Frame->raw, p_Frame->width, p_Frame->height,
+                                             reinterpret_cast<uint16_t *>(p_Pyramid->Data));
+        } else if (Level == NETWORK_IMAGE_LEVEL_HALF) {
+            ImageEncoder_Halve<uint8_t, 3>(p_Frame->buffer, p_Frame->width, p_Frame->height, p_Pyramid->Data);
+        } else {
+            ImageEncoder_Double<uint8_t, 3>(p_Frame->buffer, p_Frame->width, p_Frame->height, p_Pyramid->Data);
+        }
+
+        p_Pyramid->Sequence = p_Frame->sequence;
+        p_Pyramid->isRAW = isRAW;
+    }
+
+    p_Level->width = Width;
+    p_Level->height = Height;
+    p_Level->raw = isRAW ? reinterpret_cast<uint16_t *>(p_Pyramid->Data) : NULL;
+    p_Level->buffer = isRAW ? NULL : p_Pyramid->Data;
+
+    return ESP_OK;
+}
+
+/** @brief          Rebuild the RAW to palette index table when the AGC window has changed. The table does not
+ *                  depend on the palette, so all palettes share it. Call with the mutex taken.
+ *  @param Min      Lower end of the AGC window in raw counts
+ *  @param Max      Upper end of the AGC window in raw counts
+ */
+static void ImageEncoder_UpdateIndexLUT(uint16_t Min, uint16_t Max)
+{
+    uint32_t Span;
+    uint32_t Step;
+    uint32_t Accumulator;
+    uint8_t Shift;
+
+#ifdef CONFIG_LEPTON_ISOTHERMS
+    if (Isotherm_GetRevision() != _Encoder_State.Isotherms.Revision) {
+        Isotherm_Get(&_Encoder_State.Isotherms);
+        _Encoder_State.isIndexValid = false;
+    }
+#endif
+
+    if (_Encoder_State.isIndexValid && (_Encoder_State.IndexMin == Min) && (_Encoder_State.IndexMax == Max)) {
+        return;
+    }
+
+    Span = (Max > Min) ? (Max - Min) : 1;
+
+    /* Radiometric frames use the full 16 bit range. Wide windows are covered with a coarser step */
+    Shift = 0;
+    while ((Span >> Shift) >= IMAGE_ENCODER_INDEX_LUT_SIZE) {
+        Shift++;
+    }
+
+    _Encoder_State.IndexEnd = Span >> Shift;
+
+    /* Palette index = Offset * 255 / Span in 16.16 fixed point */
+    Step = (255UL << 16) / Span;
+    Accumulator = 0;
+    for (uint32_t i = 0; i <= _Encoder_State.IndexEnd; i++) {
+        uint32_t Index;
+
+        Index = Accumulator >> 16;
+        _Encoder_State.IndexLUT[i] = (Index < 255) ? Index : 255;
+        Accumulator += Step << Shift;
+    }
+
+    /* Entries above the window are never read, the lookup saturates at IndexEnd */
+    _Encoder_State.IndexLUT[_Encoder_State.IndexEnd] = 255;
+
+#ifdef CONFIG_LEPTON_ISOTHERMS
+    /* The last band first, so the first band is on top. The palette index is kept for the indexed stream */
+    for (uint8_t b = _Encoder_State.Isotherms.Count; b > 0; b--) {
+        const Isotherm_Band_t *p_Band = &_Encoder_State.Isotherms.Bands[b - 1];
+        uint32_t First;
+        uint32_t Last;
+
+        if (Isotherm_GetEntries(p_Band->Low, p_Band->High, Min, Shift, _Encoder_State.IndexEnd + 1, &First, &Last)) {
+            for (uint32_t i = First; i <= Last; i++) {
+                _Encoder_State.IndexLUT[i] = (b << 8) | (_Encoder_State.IndexLUT[i] & 0xFF);
+            }
+        }
+    }
+#endif
+
+    _Encoder_State.IndexMin = Min;
+    _Encoder_State.IndexMax = Max;
+    _Encoder_State.IndexShift = Shift;
+    _Encoder_State.isIndexValid = true;
+}
+
+/** @brief          Get the AGC window of a frame and prepare the index table for it. Call with the mutex taken.
+ *  @param p_Frame  Thermal frame with RAW data
+ *  @param p_Min    Pointer to store the lower end of the window
+ *  @param p_Max    Pointer to store the upper end of the window
+ */
+static void ImageEncoder_PrepareWindow(const Network_Thermal_Frame_t *p_Frame, uint16_t *p_Min, uint16_t *p_Max)
+{
+    size_t Count;
+    uint16_t Min;
+    uint16_t Max;
+
+    Count = p_Frame->width * p_Frame->height;
+
+    /* Use the AGC window of the frame statistics and scan the frame if there are none */
+    if (FrameProducts_Require(p_Frame->frame, FRAME_PRODUCT_STATISTICS) == ESP_OK) {
+        Min = p_Frame->frame->Statistics.Min;
+        Max = p_Frame->frame->Statistics.Max;
+    } else {
+        Min = UINT16_MAX;
+        Max = 0;
+        for (size_t i = 0; i < Count; i++) {
+            Min = (p_Frame->raw[i] < Min) ? p_Frame->raw[i] : Min;
+            Max = (p_Frame->raw[i] > Max) ? p_Frame->raw[i] : Max;
+        }
+    }
+
+    ImageEncoder_UpdateIndexLUT(Min, Max);
+
+    *p_Min = Min;
+    *p_Max = Max;
+}
+
+/** @brief          Map a raw value to its palette index. ImageEncoder_PrepareWindow must be called before.
+ *  @param Raw      Raw value
+ *  @return         Palette index
+ */
+static inline ImageEncoder_Index_t ImageEncoder_MapIndex(uint16_t Raw)
+{
+    uint32_t Offset;
+
+    Offset = (Raw > _Encoder_State.IndexMin) ? (static_cast<uint32_t>(Raw - _Encoder_State.IndexMin) >>
+                                                _Encoder_State.IndexShift) : 0;
+
+    return _Encoder_State.IndexLUT[(Offset < _Encoder_State.IndexEnd) ? Offset : _Encoder_State.IndexEnd];
+}
+
+/** @brief          Get the color of an index table entry.
+ *  @param Colors   Palette
+ *  @param Index    Entry of the index table
+ *  @return         RGB888 color of the palette or of the isotherm band
+ */
+static inline const uint8_t *ImageEncoder_GetColor(const uint8_t (*Colors)[3], ImageEncoder_Index_t Index)
+{
+#ifdef CONFIG_LEPTON_ISOTHERMS
+    if (Index > 0xFF) {
+        return _Encoder_State.Isotherms.Bands[(Index >> 8) - 1].Color;
+    }
+#endif
+
+    return Colors[Index];
+}
+
+/** @brief          Colorize the RAW data of a frame with a palette. Call with the mutex taken.
+ *  @param p_Frame  Thermal frame with RAW data
+ *  @param Palette  Color palette
+ *  @param p_Output RGB888 output (width * height * 3 bytes)
+ */
+static void ImageEncoder_ApplyPalette(const Network_Thermal_Frame_t *p_Frame, Server_Palette_t Palette,
+                                      uint8_t *p_Output)
+{
+    const uint8_t (*Colors)[3];
+    size_t Count;
+    uint16_t Min;
+    uint16_t Max;
+
+    Count = p_Frame->width * p_Frame->height;
+
+    ImageEncoder_PrepareWindow(p_Frame, &Min, &Max);
+
+    Colors = _Encoder_State.Palettes[Palette];
+
+    for (size_t i = 0; i < Count; i++) {
+        const uint8_t *Color = ImageEncoder_GetColor(Colors, ImageEncoder_MapIndex(p_Frame->raw[i]));
+
+        p_Output[0] = Color[0];
+        p_Output[1] = Color[1];
+        p_Output[2] = Color[2];
+        p_Output += 3;
+    }
+}
+
+/** @brief              Get an encoder handle for a configuration. Handles are kept open and the least
+ *                      recently used one is closed when all contexts are in use. Call with the mutex taken.
+ *  @param Width        Image width
+ *  @param Height       Image height
+ *  @param Quality      JPEG quality (1-100)
+ *  @param Subsampling  Chroma subsampling
+ *  @return             Encoder handle or NULL on error
+ */
+static jpeg_enc_handle_t ImageEncoder_GetContext(uint16_t Width, uint16_t Height, uint8_t Quality,
+                                                 jpeg_subsampling_t Subsampling)
+{
+    ImageEncoder_Context_t *Context = NULL;
+    jpeg_error_t Error;
+
+    _Encoder_State.UseCounter++;
+
+    for (uint8_t i = 0; i < IMAGE_ENCODER_MAX_CONTEXTS; i++) {
+        ImageEncoder_Context_t *Candidate = &_Encoder_State.Contexts[i];
+
+        if ((Candidate->Handle != NULL) && (Candidate->Width == Width) && (Candidate->Height == Height) &&
+            (Candidate->Quality == Quality) && (Candidate->Subsampling == Subsampling)) {
+            Candidate->LastUsed = _Encoder_State.UseCounter;
+
+            return Candidate->Handle;
+        }
+
+        /* Remember a free or the least recently used context */
+        if ((Context == NULL) || (Candidate->Handle == NULL) ||
+            ((Context->Handle != NULL) && (Candidate->LastUsed < Context->LastUsed))) {
+            Context = Candidate;
+        }
+    }
+
+    if (Context->Handle != NULL) {
+        ESP_LOGD(TAG, "Closing JPEG encoder %ux%u q=%u", Context->Width, Context->Height, Context->Quality);
+        jpeg_enc_close(Context->Handle);
+        Context->Handle = NULL;
+    }
+
+    jpeg_enc_config_t enc_config = {
+        .width = Width,
+        .height = Height,
+        .src_type = JPEG_PIXEL_FORMAT_RGB888,
+        .subsampling = Subsampling,
+        .quality = Quality,
+        .rotate = JPEG_ROTATE_0D,
+#ifdef CONFIG_NETWORK_ENCODER_HFM_TASK
+        .task_enable = true,
+        .hfm_task_priority = CONFIG_NETWORK_ENCODER_HFM_TASK_PRIO,
+        .hfm_task_core = CONFIG_NETWORK_ENCODER_HFM_TASK_CORE,
+#else
+        .task_enable = false,
+        .hfm_task_priority = 0,
+        .hfm_task_core = 0,
+#endif
+    };
+
+    Error = jpeg_enc_open(&enc_config, &Context->Handle);
+    if (Error != JPEG_ERR_OK) {
+        ESP_LOGE(TAG, "Failed to open JPEG encoder: %d!", Error);
+        Context->Handle = NULL;
+
+        return NULL;
+    }
+
+    ESP_LOGD(TAG, "Opened JPEG encoder %ux%u q=%u", Width, Height, Quality);
+
+    Context->Width = Width;
+    Context->Height = Height;
+    Context->Quality = Quality;
+    Context->Subsampling = Subsampling;
+    Context->LastUsed = _Encoder_State.UseCounter;
+
+    return Context->Handle;
+}
+
+/** @brief          Take an output buffer of at least Size bytes from the pool. Buffers only grow, so after
+ *                  a few frames no allocation happens anymore. Call with the mutex taken.
+ *  @param Size     Required size in bytes
+ *  @param p_Encoded Encoded image to attach the buffer to
+ *  @return         ESP_OK on success
+ */
+static esp_err_t ImageEncoder_AcquireBuffer(size_t Size, Network_Encoded_Image_t *p_Encoded)
+{
+    ImageEncoder_Buffer_t *Buffer = NULL;
+
+    /* Prefer a free buffer that is large enough already */
+    for (uint8_t i = 0; i < IMAGE_ENCODER_POOL_BUFFERS; i++) {
+        ImageEncoder_Buffer_t *Candidate = &_Encoder_State.Buffers[i];
+
+        if (Candidate->RefCount > 0) {
+            continue;
+        }
+
+        if ((Buffer == NULL) || ((Candidate->Capacity >= Size) && (Buffer->Capacity < Size)) ||
+            ((Candidate->Capacity >= Size) && (Candidate->Capacity < Buffer->Capacity))) {
+            Buffer = Candidate;
+        }
+    }
+
+    if (Buffer == NULL) {
+        /* All buffers are held by slow clients */
+        ESP_LOGD(TAG, "Output pool exhausted, allocating %u bytes", static_cast<unsigned int>(Size));
+
+        p_Encoded->data = reinterpret_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, Size, "encoded_image"));
+        p_Encoded->capacity = Size;
+        p_Encoded->isPooled = false;
+
+        return (p_Encoded->data != NULL) ? ESP_OK : ESP_ERR_NO_MEM;
+    }
+
+    if (Buffer->Capacity < Size) {
+        uint8_t *Data;
+
+        /* Round up to reduce the number of growth steps */
+        Size = (Size + 4095) & ~static_cast<size_t>(4095);
+
+        Data = reinterpret_cast<uint8_t *>(heap_caps_realloc(Buffer->Data, Size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+        if (Data == NULL) {
+            ESP_LOGE(TAG, "Failed to grow output buffer to %u bytes!", static_cast<unsigned int>(Size));
+            return ESP_ERR_NO_MEM;
+        }
+
+        Buffer->Data = Data;
+        Buffer->Capacity = Size;
+    }
+
+    Buffer->RefCount = 1;
+    p_Encoded->data = Buffer->Data;
+    p_Encoded->capacity = Buffer->Capacity;
+    p_Encoded->isPooled = true;
+
+    return ESP_OK;
+}
+
+/** @brief          Find the pool buffer of an encoded image. Call with the mutex taken.
+ *  @param p_Encoded Encoded image holding the buffer
+ *  @return         Pointer to the pool buffer or NULL if the image does not use the pool
+ */
+static ImageEncoder_Buffer_t *ImageEncoder_FindBuffer(const Network_Encoded_Image_t *p_Encoded)
+{
+    if ((p_Encoded->data == NULL) || (p_Encoded->isPooled == false)) {
+        return NULL;
+    }
+
+    for (uint8_t i = 0; i < IMAGE_ENCODER_POOL_BUFFERS; i++) {
+        if (_Encoder_State.Buffers[i].Data == p_Encoded->data) {
+            return &_Encoder_State.Buffers[i];
+        }
+    }
+
+    return NULL;
+}
+
+/** @brief          Drop one reference of an output buffer. The buffer returns to the pool with the last
+ *                  reference. Call with the mutex taken.
+ *  @param p_Encoded Encoded image holding the buffer
+ */
+static void ImageEncoder_ReleaseBuffer(Network_Encoded_Image_t *p_Encoded)
+{
+    if (p_Encoded->data == NULL) {
+        return;
+    }
+
+    if (p_Encoded->isPooled) {
+        ImageEncoder_Buffer_t *Buffer = ImageEncoder_FindBuffer(p_Encoded);
+
+        if ((Buffer != NULL) && (Buffer->RefCount > 0)) {
+            Buffer->RefCount--;
+        }
+    } else {
+        MemoryPlan_Free(p_Encoded->data);
+    }
+
+    p_Encoded->data = NULL;
+    p_Encoded->capacity = 0;
+    p_Encoded->isPooled = false;
+}
+
+/** @brief              Drop all cache entries that do not belong to a frame. Call with the mutex taken.
+ *  @param Sequence     Sequence number of the frame to keep, 0 to drop all entries
+ */
+static void ImageEncoder_EvictCache(uint32_t Sequence)
+{
+    for (uint8_t i = 0; i < IMAGE_ENCODER_CACHE_ENTRIES; i++) {
+        ImageEncoder_CacheEntry_t *Entry = &_Encoder_State.Cache[i];
+
+        if (Entry->isValid && ((Sequence == 0) || (Entry->Sequence != Sequence))) {
+            ImageEncoder_ReleaseBuffer(&Entry->Image);
+            Entry->isValid = false;
+        }
+    }
+}
+
+/** @brief              Look up an encoded image in the cache and take a buffer reference for the caller.
+ *                      Call with the mutex taken.
+ *  @param Sequence     Frame sequence number
+ *  @param Format       Image format
+ *  @param Palette      Color palette
+ *  @param Quality      JPEG quality
+ *  @param Level        Pyramid level
+ *  @param p_Window     Clipped crop window
+ *  @param p_Encoded    Output encoded image
+ *  @return             true on a cache hit
+ */
+static bool ImageEncoder_LookupCache(uint32_t Sequence, Network_ImageFormat_t Format, Server_Palette_t Palette,
+                                     uint8_t Quality, Network_ImageLevel_t Level, const Network_ImageWindow_t *p_Window,
+                                     Network_Encoded_Image_t *p_Encoded)
+{
+    for (uint8_t i = 0; i < IMAGE_ENCODER_CACHE_ENTRIES; i++) {
+        ImageEncoder_CacheEntry_t *Entry = &_Encoder_State.Cache[i];
+        ImageEncoder_Buffer_t *Buffer;
+
+        if ((Entry->isValid == false) || (Entry->Sequence != Sequence) || (Entry->Format != Format) ||
+            (Entry->Palette != Palette) || (Entry->Quality != Quality) || (Entry->Level != Level) ||
+            (ImageEncoder_isSameWindow(&Entry->Window, p_Window) == false)) {
+            continue;
+        }
+
+        Buffer = ImageEncoder_FindBuffer(&Entry->Image);
+        if (Buffer == NULL) {
+            Entry->isValid = false;
+            continue;
+        }
+
+        Buffer->RefCount++;
+        *p_Encoded = Entry->Image;
+
+        return true;
+    }
+
+    return false;
+}
+
+/** @brief              Store an encoded image in the cache. The cache takes its own buffer reference.
+ *                      Images outside of the pool are not cached. Call with the mutex taken.
+ *  @param Sequence     Frame sequence number
+ *  @param Format       Requested image format
+ *  @param Palette      Color palette
+ *  @param Quality      JPEG quality
+ *  @param Level        Pyramid level
+ *  @param p_Window     Clipped crop window
+ *  @param p_Encoded    Encoded image
+ */
+static void ImageEncoder_InsertCache(uint32_t Sequence, Network_ImageFormat_t Format, Server_Palette_t Palette,
+                                     uint8_t Quality, Network_ImageLevel_t Level, const Network_ImageWindow_t *p_Window,
+                                     const Network_Encoded_Image_t *p_Encoded)
+{
+    ImageEncoder_Buffer_t *Buffer;
+    ImageEncoder_CacheEntry_t *Entry = NULL;
+
+    Buffer = ImageEncoder_FindBuffer(p_Encoded);
+    if (Buffer == NULL) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < IMAGE_ENCODER_CACHE_ENTRIES; i++) {
+        if (_Encoder_State.Cache[i].isValid == false) {
+            Entry = &_Encoder_State.Cache[i];
+            break;
+        }
+    }
+
+    /* All entries hold other variants of this frame. Replace the first one */
+    if (Entry == NULL) {
+        Entry = &_Encoder_State.Cache[0];
+        ImageEncoder_ReleaseBuffer(&Entry->Image);
+    }
+
+    Buffer->RefCount++;
+
+    Entry->Sequence = Sequence;
+    Entry->Format = Format;
+    Entry->Palette = Palette;
+    Entry->Quality = Quality;
+    Entry->Level = Level;
+    Entry->Window = *p_Window;
+    Entry->Image = *p_Encoded;
+    Entry->isValid = true;
+}
+
+/** @brief          PackBits encode a buffer.
+ *  @param p_Input  Input data
+ *  @param Length   Input length
+ *  @param p_Output Output buffer
+ *  @param Capacity Size of the output buffer
+ *  @return         Encoded length or 0 if the output does not fit
+ */
+static size_t ImageEncoder_PackBits(const uint8_t *p_Input, size_t Length, uint8_t *p_Output, size_t Capacity)
+{
+    size_t In = 0;
+    size_t Out = 0;
+
+    while (In < Length) {
+        size_t Run = 1;
+
+        while (((In + Run) < Length) && (Run < 129) && (p_Input[In + Run] == p_Input[In])) {
+            Run++;
+        }
+
+        if (Run >= 2) {
+            if ((Out + 2) > Capacity) {
+                return 0;
+            }
+
+            p_Output[Out++] = static_cast<uint8_t>(Run + 126);
+            p_Output[Out++] = p_Input[In];
+            In += Run;
+        } else {
+            size_t Literal = 1;
+
+            /* Extend the literal until a run of at least two starts */
+            while (((In + Literal) < Length) && (Literal < 128) &&
+                   (((In + Literal + 1) >= Length) || (p_Input[In + Literal] != p_Input[In + Literal + 1]))) {
+                Literal++;
+            }
+
+            if ((Out + 1 + Literal) > Capacity) {
+                return 0;
+            }
+
+            p_Output[Out++] = static_cast<uint8_t>(Literal - 1);
+            memcpy(&p_Output[Out], &p_Input[In], Literal);
+            Out += Literal;
+            In += Literal;
+        }
+    }
+
+    return Out;
+}
+
+/** @brief          Build an indexed frame. Call with the mutex taken.
+ *  @param p_Frame  Thermal frame with RAW data
+ *  @param Palette  Palette the client should use
+ *  @param p_Encoded Output encoded image
+ *  @return         ESP_OK on success
+ */
+static esp_err_t ImageEncoder_EncodeIndexed(const Network_Thermal_Frame_t *p_Frame, Server_Palette_t Palette,
+                                            Network_Encoded_Image_t *p_Encoded)
+{
+    ImageEncoder_Indexed_Header_t Header;
+    size_t Count;
+    size_t Packed;
+    uint16_t Min;
+    uint16_t Max;
+    uint8_t *Indices;
+
+    if (p_Frame->raw == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    Count = p_Frame->width * p_Frame->height;
+
+    if (ImageEncoder_AcquireBuffer(sizeof(ImageEncoder_Indexed_Header_t) + Count, p_Encoded) != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* Map into the scratch buffer first, the indices are only kept if the run length encoding does not pay off */
+    if (_Encoder_State.ScratchSize < Count) {
+        MemoryPlan_Free(_Encoder_State.Scratch);
+        _Encoder_State.ScratchSize = 0;
+
+        _Encoder_State.Scratch = reinterpret_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, Count * 3,
+                                                                              "encoder_scratch"));
+        if (_Encoder_State.Scratch == NULL) {
+            ImageEncoder_ReleaseBuffer(p_Encoded);
+            return ESP_ERR_NO_MEM;
+        }
+
+        _Encoder_State.ScratchSize = Count * 3;
+    }
+
+    Indices = _Encoder_State.Scratch;
+
+    memset(&Header, 0, sizeof(Header));
+    ImageEncoder_PrepareWindow(p_Frame, &Min, &Max);
+
+    for (size_t i = 0; i < Count; i++) {
+        Indices[i] = static_cast<uint8_t>(ImageEncoder_MapIndex(p_Frame->raw[i]));
+    }
+
+    Packed = ImageEncoder_PackBits(Indices, Count, p_Encoded->data + sizeof(ImageEncoder_Indexed_Header_t), Count - 1);
+    if (Packed > 0) {
+        Header.Flags = IMAGE_ENCODER_INDEXED_FLAG_RLE;
+        Header.Size = Packed;
+    } else {
+        memcpy(p_Encoded->data + sizeof(ImageEncoder_Indexed_Header_t), Indices, Count);
+        Header.Size = Count;
+    }
+
+    Header.Magic = IMAGE_ENCODER_INDEXED_MAGIC;
+    Header.Version = IMAGE_ENCODER_INDEXED_VERSION;
+    Header.Width = p_Frame->width;
+    Header.Height = p_Frame->height;
+    Header.Sequence = p_Frame->sequence;
+    Header.Min = Min;
+    Header.Max = Max;
+    Header.Palette = Palette;
+    memcpy(p_Encoded->data, &Header, sizeof(Header));
+
+    p_Encoded->size = sizeof(ImageEncoder_Indexed_Header_t) + Header.Size;
+    p_Encoded->format = NETWORK_IMAGE_FORMAT_INDEXED;
+    p_Encoded->width = p_Frame->width;
+    p_Encoded->height = p_Frame->height;
+
+    return ESP_OK;
+}
+
+/** @brief              Code the changed tiles of a radiometric delta frame. Call with the mutex taken.
+ *  @param p_Frame      Thermal frame with RAW data
+ *  @param p_Payload    Payload of the encoded frame
+ *  @param Capacity     Size of the payload
+ *  @param p_Header     Header of the encoded frame
+ *  @return             true when the frame is coded as tiles
+ */
+static bool ImageEncoder_EncodeTiles(const Network_Thermal_Frame_t *p_Frame, uint8_t *p_Payload, size_t Capacity,
+                                     ImageEncoder_Radiometric_Header_t *p_Header)
+{
+#ifdef CONFIG_NETWORK_ENCODER_TILES
+    size_t MaskSize;
+    size_t Tiles;
+    size_t Packed;
+
+    MaskSize = TILE_DIFF_MASK_SIZE(p_Frame->width, p_Frame->height);
+    if (Capacity <= MaskSize) {
+        return false;
+    }
+
+    Tiles = TileDiff_Compare(p_Frame->raw, _Encoder_State.Keyframe, p_Frame->width, p_Frame->height,
+                             CONFIG_NETWORK_ENCODER_TILE_THRESHOLD, p_Payload);
+    Packed = RawCodec_EncodeTiles(p_Frame->raw, _Encoder_State.Keyframe, p_Frame->width, p_Frame->height, p_Payload,
+                                  p_Payload + MaskSize, Capacity - MaskSize);
+
+    /* A frame without changed tiles is the mask only */
+    if ((Tiles > 0) && (Packed == 0)) {
+        return false;
+    }
+
+    p_Header->Flags = IMAGE_ENCODER_RADIOMETRIC_FLAG_RICE | IMAGE_ENCODER_RADIOMETRIC_FLAG_TILES;
+    p_Header->Tiles = Tiles;
+    p_Header->TileSize = TILE_DIFF_SIZE;
+    p_Header->Size = MaskSize + Packed;
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+/** @brief              Build a radiometric frame. Every CONFIG_NETWORK_ENCODER_KEYFRAME_INTERVAL frames, on request
+ *                      and on geometry changes the frame is a keyframe, all other frames are coded as the difference
+ *                      to the last keyframe. Call with the mutex taken.
+ *  @param p_Frame      Thermal frame with RAW data
+ *  @param isStandalone true to build a keyframe that does not become the keyframe of the stream
+ *  @param p_Encoded    Output encoded image
+ *  @return             ESP_OK on success
+ */
+static esp_err_t ImageEncoder_EncodeRadiometric(const Network_Thermal_Frame_t *p_Frame, bool isStandalone,
+                                                Network_Encoded_Image_t *p_Encoded)
+{
+    ImageEncoder_Radiometric_Header_t Header;
+    size_t Count;
+    size_t Packed;
+    bool isKeyframe;
+    uint16_t Min;
+    uint16_t Max;
+    uint16_t Mean;
+    uint8_t *Payload;
+
+    if (p_Frame->raw == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    Count = p_Frame->width * p_Frame->height;
+
+    if (ImageEncoder_AcquireBuffer(sizeof(ImageEncoder_Radiometric_Header_t) + (Count * sizeof(uint16_t)),
+                                   p_Encoded) != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if ((isStandalone == false) && (_Encoder_State.KeyframeSize != Count)) {
+        MemoryPlan_Free(_Encoder_State.Keyframe);
+        _Encoder_State.KeyframeSize = 0;
+
+        _Encoder_State.Keyframe = reinterpret_cast<uint16_t *>(MemoryPlan_Alloc(MEMORY_REGION_BULK,
+                                                                                Count * sizeof(uint16_t),
+                                                                                "encoder_keyframe"));
+        if (_Encoder_State.Keyframe == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate keyframe buffer!");
+            ImageEncoder_ReleaseBuffer(p_Encoded);
+            return ESP_ERR_NO_MEM;
+        }
+
+        _Encoder_State.KeyframeSize = Count;
+        _Encoder_State.isKeyframeRequested = true;
+    }
+
+    /* The same frame is encoded again when its cache entry is gone, it must stay a keyframe then */
+    isKeyframe = isStandalone || _Encoder_State.isKeyframeRequested ||
+                 (p_Frame->sequence == _Encoder_State.KeyframeSequence) ||
+                 (_Encoder_State.KeyframeAge >= (CONFIG_NETWORK_ENCODER_KEYFRAME_INTERVAL - 1));
+
+    if (FrameProducts_Require(p_Frame->frame, FRAME_PRODUCT_STATISTICS) == ESP_OK) {
+        Min = p_Frame->frame->Statistics.Min;
+        Max = p_Frame->frame->Statistics.Max;
+        Mean = static_cast<uint16_t>(p_Frame->frame->Statistics.Mean + 0.5f);
+    } else {
+        uint32_t Sum = 0;
+
+        Min = UINT16_MAX;
+        Max = 0;
+        for (size_t i = 0; i < Count; i++) {
+            Min = (p_Frame->raw[i] < Min) ? p_Frame->raw[i] : Min;
+            Max = (p_Frame->raw[i] > Max) ? p_Frame->raw[i] : Max;
+            Sum += p_Frame->raw[i];
+        }
+
+        Mean = static_cast<uint16_t>(Sum / Count);
+    }
+
+    memset(&Header, 0, sizeof(Header));
+    Payload = p_Encoded->data + sizeof(ImageEncoder_Radiometric_Header_t);
 
-static const char *TAG = "image_encoder";
+    /* Delta frames only carry the tiles that differ from the keyframe if enabled */
+    if ((isKeyframe == false) && ImageEncoder_EncodeTiles(p_Frame, Payload, (Count * sizeof(uint16_t)) - 1, &Header)) {
+        _Encoder_State.KeyframeAge++;
+    } else {
+        /* Keyframes are coded against their own neighbours, delta frames against the keyframe */
+        Packed = RawCodec_Encode(p_Frame->raw, isKeyframe ? NULL : _Encoder_State.Keyframe, p_Frame->width,
+                                 p_Frame->height, Payload, (Count * sizeof(uint16_t)) - 1);
+        if (Packed > 0) {
+            Header.Flags = IMAGE_ENCODER_RADIOMETRIC_FLAG_RICE;
+            Header.Size = Packed;
+        } else {
+            /* Plain pixels of the frame. The ESP32-S3 is little endian like the header. The frame does not depend
+               on the keyframe anymore, so it becomes the new keyframe */
+            memcpy(Payload, p_Frame->raw, Count * sizeof(uint16_t));
+            Header.Size = Count * sizeof(uint16_t);
+            isKeyframe = true;
+        }
 
-/** @brief              Get palette lookup table.
- *  @param palette      Palette type.
- *  @return             Pointer to palette array.
- */
-static const uint8_t (*ImageEncoder_GetPalette(Server_Palette_t palette))[3] {
-    switch (palette)
-    {
-        case PALETTE_IRON:
-            return Lepton_Palette_Iron;
-        case PALETTE_RAINBOW:
-            return Lepton_Palette_Rainbow;
-        case PALETTE_GRAY:
-        default:
-            return NULL; /* Use grayscale formula */
+        if (isKeyframe && isStandalone) {
+            Header.Flags |= IMAGE_ENCODER_RADIOMETRIC_FLAG_KEY;
+        } else if (isKeyframe) {
+            memcpy(_Encoder_State.Keyframe, p_Frame->raw, Count * sizeof(uint16_t));
+            _Encoder_State.KeyframeSequence = p_Frame->sequence;
+            _Encoder_State.KeyframeAge = 0;
+            _Encoder_State.isKeyframeRequested = false;
+
+            Header.Flags |= IMAGE_ENCODER_RADIOMETRIC_FLAG_KEY;
+        } else {
+            _Encoder_State.KeyframeAge++;
+        }
     }
+
+    Header.Magic = IMAGE_ENCODER_RADIOMETRIC_MAGIC;
+    Header.Version = IMAGE_ENCODER_RADIOMETRIC_VERSION;
+    Header.Width = p_Frame->width;
+    Header.Height = p_Frame->height;
+    Header.Sequence = p_Frame->sequence;
+    Header.Reference = isKeyframe ? p_Frame->sequence : _Encoder_State.KeyframeSequence;
+    Header.Timestamp = p_Frame->timestamp;
+    Header.Time = p_Frame->time;
+    Header.Min = Min;
+    Header.Max = Max;
+    Header.Mean = Mean;
+    memcpy(p_Encoded->data, &Header, sizeof(Header));
+
+    p_Encoded->size = sizeof(ImageEncoder_Radiometric_Header_t) + Header.Size;
+    p_Encoded->format = NETWORK_IMAGE_FORMAT_RADIOMETRIC;
+    p_Encoded->isKeyframe = isKeyframe;
+    p_Encoded->width = p_Frame->width;
+    p_Encoded->height = p_Frame->height;
+
+    return ESP_OK;
 }
 
-/** @brief          Apply color palette to thermal frame.
- *  @param p_Frame  Pointer to thermal frame (with RGB888 buffer)
- *  @param palette  Color palette (currently ignored, frame already has correct colors)
- *  @param p_Output Output RGB buffer (width * height * 3 bytes)
+/** @brief          Build a temperature map. Radiometric frames already hold centi-Kelvin, so the pixels are copied
+ *                  unchanged and only the header adds the radiometric parameters of the camera. Call with the mutex
+ *                  taken.
+ *  @param p_Frame  Thermal frame with RAW data
+ *  @param p_Encoded Output encoded image
  *  @return         ESP_OK on success
  */
-static esp_err_t ImageEncoder_ApplyPalette(const Network_Thermal_Frame_t *p_Frame,
-                                           Server_Palette_t palette,
-                                           uint8_t *p_Output)
+static esp_err_t ImageEncoder_EncodeTemperature(const Network_Thermal_Frame_t *p_Frame,
+                                                Network_Encoded_Image_t *p_Encoded)
 {
-    if ((p_Frame == NULL) || (p_Output == NULL) || (p_Frame->buffer == NULL)) {
-        return ESP_ERR_INVALID_ARG;
+    ImageEncoder_Temperature_Header_t Header;
+    Lepton_FluxLinearParams_t FluxParams;
+    size_t Count;
+
+    if (p_Frame->raw == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    Count = p_Frame->width * p_Frame->height;
+
+    if (ImageEncoder_AcquireBuffer(sizeof(ImageEncoder_Temperature_Header_t) + (Count * sizeof(uint16_t)),
+                                   p_Encoded) != ESP_OK) {
+        return ESP_ERR_NO_MEM;
     }
 
-    memcpy(p_Output, p_Frame->buffer, p_Frame->width * p_Frame->height * 3);
+    memset(&Header, 0, sizeof(Header));
+
+    if (FrameProducts_Require(p_Frame->frame, FRAME_PRODUCT_STATISTICS) == ESP_OK) {
+        Header.Min = p_Frame->frame->Statistics.Min;
+        Header.Max = p_Frame->frame->Statistics.Max;
+    } else {
+        Header.Min = UINT16_MAX;
+        for (size_t i = 0; i < Count; i++) {
+            Header.Min = (p_Frame->raw[i] < Header.Min) ? p_Frame->raw[i] : Header.Min;
+            Header.Max = (p_Frame->raw[i] > Header.Max) ? p_Frame->raw[i] : Header.Max;
+        }
+    }
+
+    /* Only a cached copy of the worker, no CCI transfer */
+    if (Lepton_Task_GetFluxParameters(&FluxParams) == ESP_OK) {
+        Header.Emissivity = FluxParams.SceneEmissivity;
+        Header.Background = FluxParams.TBkgK;
+    }
+
+    Header.Magic = IMAGE_ENCODER_TEMPERATURE_MAGIC;
+    Header.Version = IMAGE_ENCODER_TEMPERATURE_VERSION;
+    Header.Width = p_Frame->width;
+    Header.Height = p_Frame->height;
+    Header.Sequence = p_Frame->sequence;
+    Header.Timestamp = p_Frame->timestamp;
+    Header.Time = p_Frame->time;
+    Header.Size = Count * sizeof(uint16_t);
+    memcpy(p_Encoded->data, &Header, sizeof(Header));
+
+    /* The ESP32-S3 is little endian like the header */
+    memcpy(p_Encoded->data + sizeof(ImageEncoder_Temperature_Header_t), p_Frame->raw, Header.Size);
+
+    p_Encoded->size = sizeof(ImageEncoder_Temperature_Header_t) + Header.Size;
+    p_Encoded->format = NETWORK_IMAGE_FORMAT_TEMPERATURE;
+    p_Encoded->width = p_Frame->width;
+    p_Encoded->height = p_Frame->height;
 
     return ESP_OK;
 }
@@ -87,44 +1245,46 @@ static esp_err_t ImageEncoder_ApplyPalette(const Network_Thermal_Frame_t *p_Fram
 static esp_err_t ImageEncoder_EncodeJPEG(const uint8_t *p_RGB, uint16_t width, uint16_t height,
                                          uint8_t quality, Network_Encoded_Image_t *p_Encoded)
 {
-    jpeg_enc_config_t enc_config = {
-        .width = width,
-        .height = height,
-        .src_type = JPEG_PIXEL_FORMAT_RGB888,
-        .subsampling = JPEG_SUBSAMPLE_420,
-        .quality = quality,
-        .rotate = JPEG_ROTATE_0D,
-        .task_enable = false,
-        .hfm_task_priority = 0,
-        .hfm_task_core = 0,
-    };
+    jpeg_enc_handle_t encoder;
+    jpeg_error_t err;
+    size_t Estimate;
+    int out_size = 0;
 
-    jpeg_enc_handle_t encoder = NULL;
-    jpeg_error_t err = jpeg_enc_open(&enc_config, &encoder);
-    if (err != JPEG_ERR_OK) {
-        ESP_LOGE(TAG, "Failed to open JPEG encoder: %d!", err);
+    encoder = ImageEncoder_GetContext(width, height, quality, JPEG_SUBSAMPLE_420);
+    if (encoder == NULL) {
         return ESP_FAIL;
     }
-    ;
-    p_Encoded->data = (uint8_t *)heap_caps_malloc(width * height * 3, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    if (p_Encoded->data == NULL) {
-        jpeg_enc_close(encoder);
+
+    /* Size the output from the largest frame seen so far plus 25 % headroom. Start with one byte per pixel */
+    Estimate = (_Encoder_State.ObservedSize > 0) ? (_Encoder_State.ObservedSize + (_Encoder_State.ObservedSize / 4)) :
+               (static_cast<size_t>(width) * height);
+
+    if (ImageEncoder_AcquireBuffer(Estimate, p_Encoded) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to allocate JPEG output buffer!");
         return ESP_ERR_NO_MEM;
     }
 
-    int out_size = 0;
-    err = jpeg_enc_process(encoder, p_RGB, width * height * 3, p_Encoded->data, width * height * 3, &out_size);
+    /* The encoder reads the caller buffer directly, no scratch copy */
+    err = jpeg_enc_process(encoder, p_RGB, width * height * 3, p_Encoded->data, p_Encoded->capacity, &out_size);
+    if (err != JPEG_ERR_OK) {
+        /* The estimate was too small for this frame, retry once with the worst case size */
+        ImageEncoder_ReleaseBuffer(p_Encoded);
 
-    jpeg_enc_close(encoder);
+        if (ImageEncoder_AcquireBuffer(width * height * 3, p_Encoded) == ESP_OK) {
+            err = jpeg_enc_process(encoder, p_RGB, width * height * 3, p_Encoded->data, p_Encoded->capacity, &out_size);
+        }
+    }
 
     if (err != JPEG_ERR_OK) {
-        heap_caps_free(p_Encoded->data);
-        p_Encoded->data = NULL;
+        ImageEncoder_ReleaseBuffer(p_Encoded);
         ESP_LOGE(TAG, "JPEG encoding failed: %d!", err);
         return ESP_FAIL;
     }
 
+    if (static_cast<size_t>(out_size) > _Encoder_State.ObservedSize) {
+        _Encoder_State.ObservedSize = out_size;
+    }
+
     p_Encoded->size = out_size;
     p_Encoded->format = NETWORK_IMAGE_FORMAT_JPEG;
     p_Encoded->width = width;
@@ -142,6 +1302,39 @@ esp_err_t ImageEncoder_Init(uint8_t Quality)
 
     ESP_LOGD(TAG, "Initializing image encoder, quality=%d", Quality);
 
+    memset(&_Encoder_State, 0, sizeof(_Encoder_State));
+
+    /* The index table is read once per pixel, so keep it out of the PSRAM cache if possible */
+    _Encoder_State.IndexLUT = reinterpret_cast<ImageEncoder_Index_t *>(MemoryPlan_Alloc(MEMORY_REGION_FAST,
+                                                                                        IMAGE_ENCODER_INDEX_LUT_SIZE *
+                                                                                        sizeof(ImageEncoder_Index_t),
+                                                                                        "encoder_index_lut"));
+    if (_Encoder_State.IndexLUT == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate index table!");
+        return ESP_ERR_NO_MEM;
+    }
+
+    _Encoder_State.Mutex = xSemaphoreCreateMutex();
+    if (_Encoder_State.Mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex!");
+        MemoryPlan_Free(_Encoder_State.IndexLUT);
+        _Encoder_State.IndexLUT = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    memcpy(_Encoder_State.Palettes[PALETTE_IRON], Lepton_Palette_Iron, sizeof(_Encoder_State.Palettes[PALETTE_IRON]));
+    memcpy(_Encoder_State.Palettes[PALETTE_RAINBOW], Lepton_Palette_Rainbow,
+           sizeof(_Encoder_State.Palettes[PALETTE_RAINBOW]));
+    for (uint32_t i = 0; i < 256; i++) {
+        _Encoder_State.Palettes[PALETTE_GRAY][i][0] = i;
+        _Encoder_State.Palettes[PALETTE_GRAY][i][1] = i;
+        _Encoder_State.Palettes[PALETTE_GRAY][i][2] = i;
+    }
+
+    /* The custom palette is gray until it is set */
+    memcpy(_Encoder_State.Palettes[PALETTE_CUSTOM], _Encoder_State.Palettes[PALETTE_GRAY],
+           sizeof(_Encoder_State.Palettes[PALETTE_CUSTOM]));
+
     _Encoder_State.JpegQuality = Quality;
     if (_Encoder_State.JpegQuality < 1) {
         _Encoder_State.JpegQuality = 1;
@@ -162,6 +1355,53 @@ void ImageEncoder_Deinit(void)
         return;
     }
 
+    xSemaphoreTake(_Encoder_State.Mutex, portMAX_DELAY);
+
+    ImageEncoder_EvictCache(0);
+
+    for (uint8_t i = 0; i < IMAGE_ENCODER_MAX_CONTEXTS; i++) {
+        if (_Encoder_State.Contexts[i].Handle != NULL) {
+            jpeg_enc_close(_Encoder_State.Contexts[i].Handle);
+            _Encoder_State.Contexts[i].Handle = NULL;
+        }
+    }
+
+    for (uint8_t i = 0; i < IMAGE_ENCODER_POOL_BUFFERS; i++) {
+        if (_Encoder_State.Buffers[i].RefCount > 0) {
+            ESP_LOGW(TAG, "Output buffer %u still in use during deinit!", i);
+        }
+
+        heap_caps_free(_Encoder_State.Buffers[i].Data);
+        _Encoder_State.Buffers[i].Data = NULL;
+        _Encoder_State.Buffers[i].Capacity = 0;
+        _Encoder_State.Buffers[i].RefCount = 0;
+    }
+
+    MemoryPlan_Free(_Encoder_State.Scratch);
+    _Encoder_State.Scratch = NULL;
+    _Encoder_State.ScratchSize = 0;
+
+    MemoryPlan_Free(_Encoder_State.IndexLUT);
+    _Encoder_State.IndexLUT = NULL;
+    _Encoder_State.isIndexValid = false;
+
+    MemoryPlan_Free(_Encoder_State.Keyframe);
+    _Encoder_State.Keyframe = NULL;
+    _Encoder_State.KeyframeSize = 0;
+
+    for (uint8_t i = 0; i < NETWORK_IMAGE_LEVEL_COUNT; i++) {
+        MemoryPlan_Free(_Encoder_State.Levels[i].Data);
+        memset(&_Encoder_State.Levels[i], 0, sizeof(ImageEncoder_Level_t));
+    }
+
+    MemoryPlan_Free(_Encoder_State.Region.Data);
+    memset(&_Encoder_State.Region, 0, sizeof(ImageEncoder_Level_t));
+    memset(&_Encoder_State.RegionWindow, 0, sizeof(Network_ImageWindow_t));
+
+    xSemaphoreGive(_Encoder_State.Mutex);
+
+    vSemaphoreDelete(_Encoder_State.Mutex);
+    _Encoder_State.Mutex = NULL;
     _Encoder_State.isInitialized = false;
 
     ESP_LOGD(TAG, "Image encoder deinitialized");
@@ -171,33 +1411,159 @@ esp_err_t ImageEncoder_Encode(const Network_Thermal_Frame_t *p_Frame,
                               Network_ImageFormat_t Format,
                               Server_Palette_t Palette,
                               Network_Encoded_Image_t *p_Encoded)
+{
+    return ImageEncoder_EncodeWithQuality(p_Frame, Format, Palette, 0, p_Encoded);
+}
+
+esp_err_t ImageEncoder_EncodeWithQuality(const Network_Thermal_Frame_t *p_Frame,
+                                         Network_ImageFormat_t Format,
+                                         Server_Palette_t Palette,
+                                         uint8_t Quality,
+                                         Network_Encoded_Image_t *p_Encoded)
+{
+    return ImageEncoder_EncodeLevel(p_Frame, Format, Palette, Quality, NETWORK_IMAGE_LEVEL_NATIVE, p_Encoded);
+}
+
+esp_err_t ImageEncoder_EncodeLevel(const Network_Thermal_Frame_t *p_Frame,
+                                   Network_ImageFormat_t Format,
+                                   Server_Palette_t Palette,
+                                   uint8_t Quality,
+                                   Network_ImageLevel_t Level,
+                                   Network_Encoded_Image_t *p_Encoded)
+{
+    return ImageEncoder_EncodeView(p_Frame, Format, Palette, Quality, Level, NULL, p_Encoded);
+}
+
+esp_err_t ImageEncoder_EncodeView(const Network_Thermal_Frame_t *p_Frame,
+                                  Network_ImageFormat_t Format,
+                                  Server_Palette_t Palette,
+                                  uint8_t Quality,
+                                  Network_ImageLevel_t Level,
+                                  const Network_ImageWindow_t *p_Window,
+                                  Network_Encoded_Image_t *p_Encoded)
 {
     esp_err_t Error;
+    size_t pixel_count;
+    Network_Thermal_Frame_t LevelFrame;
+    Network_ImageWindow_t Window;
+    bool isRegion;
 
-    if ((p_Frame == NULL) || (p_Encoded == NULL)) {
+    if ((p_Frame == NULL) || (p_Encoded == NULL) || ((p_Frame->buffer == NULL) && (p_Frame->raw == NULL))) {
         return ESP_ERR_INVALID_ARG;
+    } else if (_Encoder_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
     }
 
     memset(p_Encoded, 0, sizeof(Network_Encoded_Image_t));
 
-    size_t pixel_count = p_Frame->width * p_Frame->height;
+    if ((Palette >= PALETTE_COUNT) || (Format == NETWORK_IMAGE_FORMAT_PALETTE) ||
+        (Level >= NETWORK_IMAGE_LEVEL_COUNT)) {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-    uint8_t *rgb_buffer = (uint8_t *)heap_caps_malloc(pixel_count * 3, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    if (rgb_buffer == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate RGB buffer!");
-        return ESP_ERR_NO_MEM;
+    /* Also covers the wait for the encoder and the cache hits, the slice ends with every return below */
+    TRACE_SCOPE(TRACE_EVENT_ENCODE, Format);
+
+    xSemaphoreTake(_Encoder_State.Mutex, portMAX_DELAY);
+
+    /* Only JPEG has a quality and radiometric frames have no colors, so these requests share one cache entry.
+       This also keeps the keyframe interval independent of the number of clients */
+    if ((Format == NETWORK_IMAGE_FORMAT_RADIOMETRIC) || (Format == NETWORK_IMAGE_FORMAT_TEMPERATURE)) {
+        Palette = PALETTE_IRON;
+
+        /* Scaled pixels are no measurement anymore and the keyframe belongs to the native frame */
+        Level = NETWORK_IMAGE_LEVEL_NATIVE;
+        p_Window = NULL;
+    }
+
+    /* A window replaces the pyramid level, a window of the full frame without zoom is the native level */
+    memset(&Window, 0, sizeof(Window));
+    if (p_Window != NULL) {
+        Window = *p_Window;
+    }
+
+    isRegion = ImageEncoder_ClipWindow(p_Frame->width, p_Frame->height, &Window);
+    if (isRegion) {
+        Level = NETWORK_IMAGE_LEVEL_NATIVE;
+    }
+
+    if (Format != NETWORK_IMAGE_FORMAT_JPEG) {
+        Quality = 0;
+    } else if (Quality == 0) {
+        Quality = _Encoder_State.JpegQuality;
+    } else if (Quality > 100) {
+        Quality = 100;
+    }
+
+    /* Frames without a sequence number can not be identified, so they are never cached */
+    if (p_Frame->sequence != 0) {
+        /* A newer frame makes all cached images stale */
+        ImageEncoder_EvictCache(p_Frame->sequence);
+
+        if (ImageEncoder_LookupCache(p_Frame->sequence, Format, Palette, Quality, Level, &Window, p_Encoded)) {
+            _Encoder_State.CacheHits++;
+            xSemaphoreGive(_Encoder_State.Mutex);
+
+            return ESP_OK;
+        }
+
+        _Encoder_State.CacheMisses++;
     }
 
-    Error = ImageEncoder_ApplyPalette(p_Frame, Palette, rgb_buffer);
+    /* The encoders below see the region or the pyramid level as the frame */
+    if (isRegion) {
+        Error = ImageEncoder_GetRegion(p_Frame, &Window, &LevelFrame);
+    } else {
+        Error = ImageEncoder_GetLevel(p_Frame, Level, &LevelFrame);
+    }
     if (Error != ESP_OK) {
-        heap_caps_free(rgb_buffer);
+        xSemaphoreGive(_Encoder_State.Mutex);
+
         return Error;
     }
 
+    p_Frame = &LevelFrame;
+    pixel_count = p_Frame->width * p_Frame->height;
+
     switch (Format) {
         case NETWORK_IMAGE_FORMAT_JPEG: {
-            Error = ImageEncoder_EncodeJPEG(rgb_buffer, p_Frame->width, p_Frame->height,
-                                            _Encoder_State.JpegQuality, p_Encoded);
+            const uint8_t *Source = p_Frame->buffer;
+
+            if (p_Frame->raw != NULL) {
+                /* The colorized frame is only needed until the encoder has read it, so keep one scratch buffer */
+                if (_Encoder_State.ScratchSize < (pixel_count * 3)) {
+                    MemoryPlan_Free(_Encoder_State.Scratch);
+                    _Encoder_State.ScratchSize = 0;
+
+                    _Encoder_State.Scratch = reinterpret_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_BULK,
+                                                                                          pixel_count * 3,
+                                                                                          "encoder_scratch"));
+                    if (_Encoder_State.Scratch == NULL) {
+                        ESP_LOGE(TAG, "Failed to allocate RGB buffer!");
+                        Error = ESP_ERR_NO_MEM;
+                        break;
+                    }
+
+                    _Encoder_State.ScratchSize = pixel_count * 3;
+                }
+
+                ImageEncoder_ApplyPalette(p_Frame, Palette, _Encoder_State.Scratch);
+                Source = _Encoder_State.Scratch;
+            }
+
+            Error = ImageEncoder_EncodeJPEG(Source, p_Frame->width, p_Frame->height, Quality, p_Encoded);
+            break;
+        }
+        case NETWORK_IMAGE_FORMAT_INDEXED: {
+            Error = ImageEncoder_EncodeIndexed(p_Frame, Palette, p_Encoded);
+            break;
+        }
+        case NETWORK_IMAGE_FORMAT_RADIOMETRIC: {
+            Error = ImageEncoder_EncodeRadiometric(p_Frame, false, p_Encoded);
+            break;
+        }
+        case NETWORK_IMAGE_FORMAT_TEMPERATURE: {
+            Error = ImageEncoder_EncodeTemperature(p_Frame, p_Encoded);
             break;
         }
         case NETWORK_IMAGE_FORMAT_PNG: {
@@ -207,36 +1573,340 @@ esp_err_t ImageEncoder_Encode(const Network_Thermal_Frame_t *p_Frame,
         }
         case NETWORK_IMAGE_FORMAT_RAW:
         default: {
-            /* Return raw RGB data */
-            p_Encoded->data = rgb_buffer;
+            /* Return raw RGB data. The frame buffer is only valid while the frame mutex is held, so copy it */
+            Error = ImageEncoder_AcquireBuffer(pixel_count * 3, p_Encoded);
+            if (Error != ESP_OK) {
+                break;
+            }
+
+            if (p_Frame->raw != NULL) {
+                ImageEncoder_ApplyPalette(p_Frame, Palette, p_Encoded->data);
+            } else {
+                memcpy(p_Encoded->data, p_Frame->buffer, pixel_count * 3);
+            }
             p_Encoded->size = pixel_count * 3;
             p_Encoded->format = NETWORK_IMAGE_FORMAT_RAW;
             p_Encoded->width = p_Frame->width;
             p_Encoded->height = p_Frame->height;
 
-            return ESP_OK;
+            break;
         }
     }
 
-    heap_caps_free(rgb_buffer);
+    if (Error == ESP_OK) {
+        /* Lets the senders trace the latency of the source frame */
+        p_Encoded->sequence = p_Frame->sequence;
+        p_Encoded->timestamp = p_Frame->timestamp;
+        p_Encoded->time = p_Frame->time;
+    }
+
+    if ((Error == ESP_OK) && (p_Frame->sequence != 0)) {
+        ImageEncoder_InsertCache(p_Frame->sequence, Format, Palette, Quality, Level, &Window, p_Encoded);
+    }
+
+    xSemaphoreGive(_Encoder_State.Mutex);
+
+    return Error;
+}
+
+esp_err_t ImageEncoder_EncodePalette(Server_Palette_t Palette, Network_Encoded_Image_t *p_Encoded)
+{
+    ImageEncoder_Palette_Header_t Header;
+    esp_err_t Error;
+
+    if ((p_Encoded == NULL) || (Palette >= PALETTE_COUNT)) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_Encoder_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(p_Encoded, 0, sizeof(Network_Encoded_Image_t));
+
+    xSemaphoreTake(_Encoder_State.Mutex, portMAX_DELAY);
+
+    Error = ImageEncoder_AcquireBuffer(sizeof(Header) + sizeof(_Encoder_State.Palettes[Palette]), p_Encoded);
+    if (Error == ESP_OK) {
+        Header.Magic = IMAGE_ENCODER_PALETTE_MAGIC;
+        Header.Version = IMAGE_ENCODER_INDEXED_VERSION;
+        Header.Palette = Palette;
+
+        memcpy(p_Encoded->data, &Header, sizeof(Header));
+        memcpy(p_Encoded->data + sizeof(Header), _Encoder_State.Palettes[Palette], sizeof(_Encoder_State.Palettes[Palette]));
+
+        p_Encoded->size = sizeof(Header) + sizeof(_Encoder_State.Palettes[Palette]);
+        p_Encoded->format = NETWORK_IMAGE_FORMAT_PALETTE;
+    }
+
+    xSemaphoreGive(_Encoder_State.Mutex);
+
+    return Error;
+}
+
+esp_err_t ImageEncoder_EncodeKeyframe(const Network_Thermal_Frame_t *p_Frame, Network_Encoded_Image_t *p_Encoded)
+{
+    esp_err_t Error;
+
+    if ((p_Frame == NULL) || (p_Encoded == NULL) || (p_Frame->raw == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_Encoder_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(p_Encoded, 0, sizeof(Network_Encoded_Image_t));
+
+    TRACE_SCOPE(TRACE_EVENT_ENCODE, NETWORK_IMAGE_FORMAT_RADIOMETRIC);
+
+    /* Not cached, the cache entry of the sequence number belongs to the live frame */
+    xSemaphoreTake(_Encoder_State.Mutex, portMAX_DELAY);
+
+    Error = ImageEncoder_EncodeRadiometric(p_Frame, true, p_Encoded);
+    if (Error == ESP_OK) {
+        p_Encoded->sequence = p_Frame->sequence;
+        p_Encoded->timestamp = p_Frame->timestamp;
+        p_Encoded->time = p_Frame->time;
+    }
+
+    xSemaphoreGive(_Encoder_State.Mutex);
 
     return Error;
 }
 
+void ImageEncoder_RequestKeyframe(void)
+{
+    if (_Encoder_State.isInitialized == false) {
+        return;
+    }
+
+    xSemaphoreTake(_Encoder_State.Mutex, portMAX_DELAY);
+    _Encoder_State.isKeyframeRequested = true;
+    xSemaphoreGive(_Encoder_State.Mutex);
+}
+
+esp_err_t ImageEncoder_Retain(const Network_Encoded_Image_t *p_Encoded, Network_Encoded_Image_t *p_Copy)
+{
+    ImageEncoder_Buffer_t *Buffer;
+
+    if ((p_Encoded == NULL) || (p_Copy == NULL) || (p_Encoded->data == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_Encoder_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(_Encoder_State.Mutex, portMAX_DELAY);
+
+    Buffer = ImageEncoder_FindBuffer(p_Encoded);
+    if (Buffer != NULL) {
+        Buffer->RefCount++;
+        *p_Copy = *p_Encoded;
+
+        xSemaphoreGive(_Encoder_State.Mutex);
+
+        return ESP_OK;
+    }
+
+    xSemaphoreGive(_Encoder_State.Mutex);
+
+    /* Heap fallback buffers have no reference count */
+    *p_Copy = *p_Encoded;
+    p_Copy->data = reinterpret_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, p_Encoded->size, "encoded_image"));
+    if (p_Copy->data == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    memcpy(p_Copy->data, p_Encoded->data, p_Encoded->size);
+    p_Copy->capacity = p_Encoded->size;
+    p_Copy->isPooled = false;
+
+    return ESP_OK;
+}
+
 void ImageEncoder_Free(Network_Encoded_Image_t *p_Encoded)
 {
-    if (p_Encoded == NULL) {
+    if ((p_Encoded == NULL) || (p_Encoded->data == NULL)) {
         return;
     }
 
-    if (p_Encoded->data != NULL) {
-        heap_caps_free(p_Encoded->data);
-        p_Encoded->data = NULL;
+    if (_Encoder_State.Mutex != NULL) {
+        xSemaphoreTake(_Encoder_State.Mutex, portMAX_DELAY);
+        ImageEncoder_ReleaseBuffer(p_Encoded);
+        xSemaphoreGive(_Encoder_State.Mutex);
+    } else {
+        ImageEncoder_ReleaseBuffer(p_Encoded);
     }
 
     p_Encoded->size = 0;
 }
 
+esp_err_t ImageEncoder_SetCustomPalette(const uint8_t p_Palette[256][3])
+{
+    if (p_Palette == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_Encoder_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(_Encoder_State.Mutex, portMAX_DELAY);
+
+    memcpy(_Encoder_State.Palettes[PALETTE_CUSTOM], p_Palette, sizeof(_Encoder_State.Palettes[PALETTE_CUSTOM]));
+
+    /* Cached images with the old custom colors are stale now */
+    ImageEncoder_EvictCache(0);
+
+    xSemaphoreGive(_Encoder_State.Mutex);
+
+    return ESP_OK;
+}
+
+bool ImageEncoder_GetPaletteByName(const char *p_Name, Server_Palette_t *p_Palette)
+{
+    if ((p_Name == NULL) || (p_Palette == NULL)) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < PALETTE_COUNT; i++) {
+        if (strcmp(p_Name, _Encoder_PaletteNames[i]) == 0) {
+            *p_Palette = static_cast<Server_Palette_t>(i);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char *ImageEncoder_GetPaletteName(Server_Palette_t Palette)
+{
+    return (Palette < PALETTE_COUNT) ? _Encoder_PaletteNames[Palette] : "unknown";
+}
+
+bool ImageEncoder_GetFormatByName(const char *p_Name, Network_ImageFormat_t *p_Format)
+{
+    if ((p_Name == NULL) || (p_Format == NULL)) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < (sizeof(_Encoder_FormatNames) / sizeof(_Encoder_FormatNames[0])); i++) {
+        if (strcmp(p_Name, _Encoder_FormatNames[i]) == 0) {
+            *p_Format = static_cast<Network_ImageFormat_t>(i);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char *ImageEncoder_GetFormatName(Network_ImageFormat_t Format)
+{
+    if (static_cast<size_t>(Format) >= (sizeof(_Encoder_FormatNames) / sizeof(_Encoder_FormatNames[0]))) {
+        return "unknown";
+    }
+
+    return _Encoder_FormatNames[Format];
+}
+
+bool ImageEncoder_GetLevelByName(const char *p_Name, Network_ImageLevel_t *p_Level)
+{
+    if ((p_Name == NULL) || (p_Level == NULL)) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < NETWORK_IMAGE_LEVEL_COUNT; i++) {
+        if (strcmp(p_Name, _Encoder_LevelNames[i]) == 0) {
+            *p_Level = static_cast<Network_ImageLevel_t>(i);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ImageEncoder_ClipWindow(uint16_t Width, uint16_t Height, Network_ImageWindow_t *p_Window)
+{
+    uint16_t X;
+    uint16_t Y;
+    uint16_t RegionWidth;
+    uint16_t RegionHeight;
+    uint8_t Zoom;
+
+    if (p_Window == NULL) {
+        return false;
+    }
+
+    if ((p_Window->Width == 0) || (p_Window->Height == 0) || (p_Window->X >= Width) || (p_Window->Y >= Height) ||
+        (Width < IMAGE_ENCODER_MIN_WINDOW) || (Height < IMAGE_ENCODER_MIN_WINDOW)) {
+        memset(p_Window, 0, sizeof(Network_ImageWindow_t));
+        return false;
+    }
+
+    X = p_Window->X;
+    Y = p_Window->Y;
+    RegionWidth = (p_Window->Width < (Width - X)) ? p_Window->Width : (Width - X);
+    RegionHeight = (p_Window->Height < (Height - Y)) ? p_Window->Height : (Height - Y);
+
+    /* Small regions at the right or lower edge grow towards the frame */
+    if (RegionWidth < IMAGE_ENCODER_MIN_WINDOW) {
+        RegionWidth = IMAGE_ENCODER_MIN_WINDOW;
+        X = ((X + RegionWidth) > Width) ? (Width - RegionWidth) : X;
+    }
+
+    if (RegionHeight < IMAGE_ENCODER_MIN_WINDOW) {
+        RegionHeight = IMAGE_ENCODER_MIN_WINDOW;
+        Y = ((Y + RegionHeight) > Height) ? (Height - RegionHeight) : Y;
+    }
+
+    /* Even sizes keep the chroma subsampling of the JPEG encoder aligned */
+    RegionWidth &= ~0x01;
+    RegionHeight &= ~0x01;
+
+    Zoom = (p_Window->Zoom == 0) ? 1 : p_Window->Zoom;
+    Zoom = (Zoom > IMAGE_ENCODER_MAX_ZOOM) ? IMAGE_ENCODER_MAX_ZOOM : Zoom;
+    while ((Zoom > 1) && (((RegionWidth * Zoom) > (2 * Width)) || ((RegionHeight * Zoom) > (2 * Height)))) {
+        Zoom--;
+    }
+
+    if ((X == 0) && (Y == 0) && (RegionWidth == Width) && (RegionHeight == Height) && (Zoom == 1)) {
+        memset(p_Window, 0, sizeof(Network_ImageWindow_t));
+        return false;
+    }
+
+    p_Window->X = X;
+    p_Window->Y = Y;
+    p_Window->Width = RegionWidth;
+    p_Window->Height = RegionHeight;
+    p_Window->Zoom = Zoom;
+
+    return true;
+}
+
+bool ImageEncoder_isSameWindow(const Network_ImageWindow_t *p_A, const Network_ImageWindow_t *p_B)
+{
+    return (p_A->X == p_B->X) && (p_A->Y == p_B->Y) && (p_A->Width == p_B->Width) && (p_A->Height == p_B->Height) &&
+           (p_A->Zoom == p_B->Zoom);
+}
+
+const char *ImageEncoder_GetLevelName(Network_ImageLevel_t Level)
+{
+    return (Level < NETWORK_IMAGE_LEVEL_COUNT) ? _Encoder_LevelNames[Level] : "unknown";
+}
+
+void ImageEncoder_GetCacheStatistics(uint32_t *p_Hits, uint32_t *p_Misses)
+{
+    if (p_Hits != NULL) {
+        *p_Hits = _Encoder_State.CacheHits;
+    }
+
+    if (p_Misses != NULL) {
+        *p_Misses = _Encoder_State.CacheMisses;
+    }
+}
+
+uint8_t ImageEncoder_GetQuality(void)
+{
+    return _Encoder_State.JpegQuality;
+}
+
 void ImageEncoder_SetQuality(uint8_t Quality)
 {
     _Encoder_State.JpegQuality = Quality;
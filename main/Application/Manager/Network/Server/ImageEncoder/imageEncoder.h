@@ -28,6 +28,154 @@
 
 #include "../../networkTypes.h"
 
+/** @brief Number of JPEG encoder handles that are kept open (one per size, quality and subsampling).
+ */
+#define IMAGE_ENCODER_MAX_CONTEXTS              4
+
+/** @brief Number of output buffers, allocated on first use. A buffer is shared by all users of an encoded image and by
+ *         the cache and returns to the pool when the last of them has freed it. The encode pipeline holds up to two
+ *         frames with one image per palette and pyramid level.
+ */
+#define IMAGE_ENCODER_POOL_BUFFERS              10
+
+/** @brief Number of encoded images of the current frame that are cached (one per format, palette, quality and
+ *         pyramid level).
+ */
+#define IMAGE_ENCODER_CACHE_ENTRIES             6
+
+/** @brief Largest scale of a crop window. A window is also never scaled beyond twice the width and height of the
+ *         frame, like the double pyramid level.
+ */
+#define IMAGE_ENCODER_MAX_ZOOM                  4
+
+/** @brief Smallest width and height of a crop window in pixels of the native frame.
+ */
+#define IMAGE_ENCODER_MIN_WINDOW                8
+
+/** @brief Number of index bits of the RAW to palette index lookup table.
+ */
+#define IMAGE_ENCODER_INDEX_LUT_BITS            14
+
+/** @brief Magic of an indexed frame ("PI").
+ */
+#define IMAGE_ENCODER_INDEXED_MAGIC             0x4950
+
+/** @brief Magic of a palette message ("PL").
+ */
+#define IMAGE_ENCODER_PALETTE_MAGIC             0x4C50
+
+/** @brief Version of the indexed frame and palette messages.
+ */
+#define IMAGE_ENCODER_INDEXED_VERSION           1
+
+/** @brief Flag of an indexed frame: the indices are PackBits run length encoded.
+ *         A control byte n < 128 is followed by n + 1 literal indices, a control byte n >= 128 by one index that
+ *         repeats n - 126 times.
+ */
+#define IMAGE_ENCODER_INDEXED_FLAG_RLE          (1 << 0)
+
+/** @brief Header of an indexed frame (NETWORK_IMAGE_FORMAT_INDEXED), little endian. The header is followed by Size
+ *         bytes of palette indices, row by row. Index 0 is Min and index 255 is Max in raw counts
+ *         (centi-Kelvin for radiometric frames).
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t Magic;                             /**< IMAGE_ENCODER_INDEXED_MAGIC. */
+    uint8_t Version;                            /**< IMAGE_ENCODER_INDEXED_VERSION. */
+    uint8_t Flags;                              /**< IMAGE_ENCODER_INDEXED_FLAG_* */
+    uint16_t Width;
+    uint16_t Height;
+    uint32_t Sequence;                          /**< Frame sequence number. */
+    uint16_t Min;                               /**< Raw value of index 0. */
+    uint16_t Max;                               /**< Raw value of index 255. */
+    uint8_t Palette;                            /**< Server_Palette_t the client should use. */
+    uint8_t Reserved[3];
+    uint32_t Size;                              /**< Number of payload bytes after the header. */
+} ImageEncoder_Indexed_Header_t;
+
+/** @brief Header of a palette message (NETWORK_IMAGE_FORMAT_PALETTE), followed by 256 RGB888 colors.
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t Magic;                             /**< IMAGE_ENCODER_PALETTE_MAGIC. */
+    uint8_t Version;                            /**< IMAGE_ENCODER_INDEXED_VERSION. */
+    uint8_t Palette;                            /**< Server_Palette_t of the colors. */
+} ImageEncoder_Palette_Header_t;
+
+/** @brief Magic of a radiometric frame ("PR").
+ */
+#define IMAGE_ENCODER_RADIOMETRIC_MAGIC         0x5250
+
+/** @brief Version of the radiometric frame. Version 2 adds the UTC capture time.
+ */
+#define IMAGE_ENCODER_RADIOMETRIC_VERSION       2
+
+/** @brief Flag of a radiometric frame: the frame is a keyframe. The pixels of other frames are the difference to the
+ *         keyframe with the sequence number Reference.
+ */
+#define IMAGE_ENCODER_RADIOMETRIC_FLAG_KEY      (1 << 0)
+
+/** @brief Flag of a radiometric frame: the payload is Rice coded, see RawCodec_Encode. Without the flag the payload
+ *         holds the plain 16 bit pixels of the frame.
+ */
+#define IMAGE_ENCODER_RADIOMETRIC_FLAG_RICE     (1 << 1)
+
+/** @brief Flag of a radiometric frame: the payload starts with a change mask of TileSize tiles (see TileDiff_Compare),
+ *         followed by the Rice coded differences of the changed tiles only (see RawCodec_EncodeTiles). All other
+ *         tiles are equal to the keyframe within CONFIG_NETWORK_ENCODER_TILE_THRESHOLD.
+ */
+#define IMAGE_ENCODER_RADIOMETRIC_FLAG_TILES    (1 << 2)
+
+/** @brief Header of a radiometric frame (NETWORK_IMAGE_FORMAT_RADIOMETRIC), little endian. The header is followed
+ *         by Size bytes of payload. Pixels are raw counts (centi-Kelvin for radiometric frames).
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t Magic;                             /**< IMAGE_ENCODER_RADIOMETRIC_MAGIC. */
+    uint8_t Version;                            /**< IMAGE_ENCODER_RADIOMETRIC_VERSION. */
+    uint8_t Flags;                              /**< IMAGE_ENCODER_RADIOMETRIC_FLAG_* */
+    uint16_t Width;
+    uint16_t Height;
+    uint32_t Sequence;                          /**< Frame sequence number. */
+    uint32_t Reference;                         /**< Sequence number of the keyframe, Sequence for a keyframe. */
+    uint32_t Timestamp;                         /**< Capture time in milliseconds. */
+    uint16_t Min;                               /**< Minimum of the frame in raw counts. */
+    uint16_t Max;                               /**< Maximum of the frame in raw counts. */
+    uint16_t Mean;                              /**< Mean of the frame in raw counts. */
+    uint16_t Tiles;                             /**< Number of changed tiles, 0 without IMAGE_ENCODER_RADIOMETRIC_FLAG_TILES. */
+    uint8_t TileSize;                           /**< Edge length of a tile in pixels, 0 without IMAGE_ENCODER_RADIOMETRIC_FLAG_TILES. */
+    uint8_t Reserved[3];
+    int64_t Time;                               /**< Capture time in microseconds since 1970-01-01 UTC, 0 if the
+                                                     time of the camera is not set. */
+    uint32_t Size;                              /**< Number of payload bytes after the header. */
+} ImageEncoder_Radiometric_Header_t;
+
+/** @brief Magic of a temperature map ("PM"), the telemetry message uses "PT".
+ */
+#define IMAGE_ENCODER_TEMPERATURE_MAGIC         0x4D50
+
+/** @brief Version of the temperature map. Version 2 adds the UTC capture time.
+ */
+#define IMAGE_ENCODER_TEMPERATURE_VERSION       2
+
+/** @brief Header of a temperature map (NETWORK_IMAGE_FORMAT_TEMPERATURE), little endian. The header is followed by
+ *         Width * Height unsigned 16 bit temperatures in centi-Kelvin, row by row. The radiometric parameters are the
+ *         ones of the camera when the map was built, 0 if they are unknown.
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t Magic;                             /**< IMAGE_ENCODER_TEMPERATURE_MAGIC. */
+    uint8_t Version;                            /**< IMAGE_ENCODER_TEMPERATURE_VERSION. */
+    uint8_t Reserved;
+    uint16_t Width;
+    uint16_t Height;
+    uint32_t Sequence;                          /**< Frame sequence number. */
+    uint32_t Timestamp;                         /**< Capture time in milliseconds. */
+    uint16_t Min;                               /**< Minimum of the frame in centi-Kelvin. */
+    uint16_t Max;                               /**< Maximum of the frame in centi-Kelvin. */
+    uint16_t Emissivity;                        /**< Scene emissivity of the camera, scaled by 8192. */
+    uint16_t Background;                        /**< Background temperature of the camera in centi-Kelvin. */
+    int64_t Time;                               /**< Capture time in microseconds since 1970-01-01 UTC, 0 if the
+                                                     time of the camera is not set. */
+    uint32_t Size;                              /**< Number of payload bytes after the header. */
+} ImageEncoder_Temperature_Header_t;
+
 /** @brief          Initialize the image encoder.
  *  @param Quality  JPEG quality (1-100)
  *  @return         ESP_OK on success
@@ -39,6 +187,11 @@ esp_err_t ImageEncoder_Init(uint8_t Quality);
 void ImageEncoder_Deinit(void);
 
 /** @brief              Encode a thermal frame to the specified format.
+ *                      Frames with RAW data are colorized with the requested palette over the AGC window of the
+ *                      frame. Frames without RAW data use the colors of the RGB buffer.
+ *                      The output uses a buffer of the encoder pool and must be returned with ImageEncoder_Free.
+ *                      Frames with a sequence number are encoded only once per format, palette and quality. Later
+ *                      calls for the same frame share the cached image until a newer frame is encoded.
  *  @param p_Frame      Pointer to thermal frame data
  *  @param Format       Output image format
  *  @param Palette      Color palette to use
@@ -50,11 +203,180 @@ esp_err_t ImageEncoder_Encode(const Network_Thermal_Frame_t *p_Frame,
                               Server_Palette_t Palette,
                               Network_Encoded_Image_t *p_Encoded);
 
+/** @brief              Encode a thermal frame with a JPEG quality other than the default quality.
+ *                      See ImageEncoder_Encode.
+ *  @param p_Frame      Pointer to thermal frame data
+ *  @param Format       Output image format
+ *  @param Palette      Color palette to use
+ *  @param Quality      JPEG quality (1-100), 0 for the default quality
+ *  @param p_Encoded    Pointer to store encoded image data
+ *  @return             ESP_OK on success
+ */
+esp_err_t ImageEncoder_EncodeWithQuality(const Network_Thermal_Frame_t *p_Frame,
+                                         Network_ImageFormat_t Format,
+                                         Server_Palette_t Palette,
+                                         uint8_t Quality,
+                                         Network_Encoded_Image_t *p_Encoded);
+
+/** @brief              Encode a pyramid level of a thermal frame. The level is built once per frame from the native
+ *                      frame and shared by all formats and palettes. Radiometric frames and temperature maps are
+ *                      measurement data and always use the native level. See ImageEncoder_Encode.
+ *  @param p_Frame      Pointer to thermal frame data
+ *  @param Format       Output image format
+ *  @param Palette      Color palette to use
+ *  @param Quality      JPEG quality (1-100), 0 for the default quality
+ *  @param Level        Pyramid level
+ *  @param p_Encoded    Pointer to store encoded image data
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if the level is unknown
+ *                      ESP_ERR_NO_MEM if the level can not be allocated
+ */
+esp_err_t ImageEncoder_EncodeLevel(const Network_Thermal_Frame_t *p_Frame,
+                                   Network_ImageFormat_t Format,
+                                   Server_Palette_t Palette,
+                                   uint8_t Quality,
+                                   Network_ImageLevel_t Level,
+                                   Network_Encoded_Image_t *p_Encoded);
+
+/** @brief              Encode a crop window or a pyramid level of a thermal frame. The region of the window is cut
+ *                      from the RAW frame and bilinear scaled by its zoom, before the colors are applied, so only the
+ *                      pixels of the region are colorized and encoded. The AGC window of the colors and of the
+ *                      indexed format follows the region. The region is built once per frame and window and shared
+ *                      by all formats and palettes. Radiometric frames and temperature maps are measurement data
+ *                      and always use the full native frame. See ImageEncoder_EncodeLevel.
+ *  @param p_Frame      Pointer to thermal frame data
+ *  @param Format       Output image format
+ *  @param Palette      Color palette to use
+ *  @param Quality      JPEG quality (1-100), 0 for the default quality
+ *  @param Level        Pyramid level, used if the window selects the full frame
+ *  @param p_Window     Crop window, clipped with ImageEncoder_ClipWindow. NULL for the full frame
+ *  @param p_Encoded    Pointer to store encoded image data
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if the level is unknown
+ *                      ESP_ERR_NO_MEM if the region or the level can not be allocated
+ */
+esp_err_t ImageEncoder_EncodeView(const Network_Thermal_Frame_t *p_Frame,
+                                  Network_ImageFormat_t Format,
+                                  Server_Palette_t Palette,
+                                  uint8_t Quality,
+                                  Network_ImageLevel_t Level,
+                                  const Network_ImageWindow_t *p_Window,
+                                  Network_Encoded_Image_t *p_Encoded);
+
+/** @brief              Clip a crop window to a frame. The region is moved into the frame and grown to
+ *                      IMAGE_ENCODER_MIN_WINDOW, the width and height are rounded down to even numbers and the zoom
+ *                      is lowered until the output fits into twice the frame size.
+ *  @param Width        Frame width
+ *  @param Height       Frame height
+ *  @param p_Window     Window to clip. Set to 0 if it selects the full frame without zoom
+ *  @return             true if the window selects a region or a zoom
+ */
+bool ImageEncoder_ClipWindow(uint16_t Width, uint16_t Height, Network_ImageWindow_t *p_Window);
+
+/** @brief          Compare two crop windows.
+ *  @param p_A      First window
+ *  @param p_B      Second window
+ *  @return         true if both windows select the same region with the same zoom
+ */
+bool ImageEncoder_isSameWindow(const Network_ImageWindow_t *p_A, const Network_ImageWindow_t *p_B);
+
+/** @brief              Build a palette message for clients of the indexed format. The message must be returned
+ *                      with ImageEncoder_Free.
+ *  @param Palette      Color palette
+ *  @param p_Encoded    Pointer to store the message
+ *  @return             ESP_OK on success
+ */
+esp_err_t ImageEncoder_EncodePalette(Server_Palette_t Palette, Network_Encoded_Image_t *p_Encoded);
+
+/** @brief              Encode a radiometric keyframe of a frame outside of the stream, e.g. a frame of the backfill
+ *                      ring. The keyframe of the stream and the cache stay untouched, so the delta frames of the other
+ *                      clients are not affected. The output must be returned with ImageEncoder_Free.
+ *  @param p_Frame      Thermal frame with RAW data. The frame pool slot can be NULL
+ *  @param p_Encoded    Pointer to store the keyframe
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if the frame has no RAW data
+ *                      ESP_ERR_NO_MEM if the encoder pool has no buffer
+ */
+esp_err_t ImageEncoder_EncodeKeyframe(const Network_Thermal_Frame_t *p_Frame, Network_Encoded_Image_t *p_Encoded);
+
+/** @brief  Encode the next radiometric frame as keyframe. Used by streams with clients that have no keyframe yet.
+ */
+void ImageEncoder_RequestKeyframe(void);
+
+/** @brief              Take an additional reference on an encoded image. Both images must be freed with
+ *                      ImageEncoder_Free. Images outside of the buffer pool are copied.
+ *  @param p_Encoded    Pointer to the encoded image
+ *  @param p_Copy       Pointer to store the new reference
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if an image is NULL or empty
+ *                      ESP_ERR_NO_MEM if the copy can not be allocated
+ */
+esp_err_t ImageEncoder_Retain(const Network_Encoded_Image_t *p_Encoded, Network_Encoded_Image_t *p_Copy);
+
 /** @brief              Free encoded image data.
  *  @param p_Encoded    Pointer to encoded image structure
  */
 void ImageEncoder_Free(Network_Encoded_Image_t *p_Encoded);
 
+/** @brief              Set the colors of PALETTE_CUSTOM. The palette is copied.
+ *  @param p_Palette    Palette with 256 RGB888 entries, index 0 is the coldest color
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if p_Palette is NULL
+ *                      ESP_ERR_INVALID_STATE if the encoder is not initialized
+ */
+esp_err_t ImageEncoder_SetCustomPalette(const uint8_t p_Palette[256][3]);
+
+/** @brief              Get a palette from its name ("iron", "gray", "rainbow" or "custom").
+ *  @param p_Name       Palette name
+ *  @param p_Palette    Pointer to store the palette
+ *  @return             true if the name is known
+ */
+bool ImageEncoder_GetPaletteByName(const char *p_Name, Server_Palette_t *p_Palette);
+
+/** @brief          Get the name of a palette, see ImageEncoder_GetPaletteByName.
+ *  @param Palette  Color palette
+ *  @return         Name of the palette or "unknown"
+ */
+const char *ImageEncoder_GetPaletteName(Server_Palette_t Palette);
+
+/** @brief              Get an image format from its name ("jpeg", "png", "raw", "indexed", "palette", "radiometric"
+ *                      or "temperature").
+ *  @param p_Name       Format name
+ *  @param p_Format     Pointer to store the format
+ *  @return             true if the name is known
+ */
+bool ImageEncoder_GetFormatByName(const char *p_Name, Network_ImageFormat_t *p_Format);
+
+/** @brief          Get the name of an image format, see ImageEncoder_GetFormatByName.
+ *  @param Format   Image format
+ *  @return         Name of the format or "unknown"
+ */
+const char *ImageEncoder_GetFormatName(Network_ImageFormat_t Format);
+
+/** @brief              Get a pyramid level from its name ("native", "half" or "double").
+ *  @param p_Name       Level name
+ *  @param p_Level      Pointer to store the level
+ *  @return             true if the name is known
+ */
+bool ImageEncoder_GetLevelByName(const char *p_Name, Network_ImageLevel_t *p_Level);
+
+/** @brief          Get the name of a pyramid level, see ImageEncoder_GetLevelByName.
+ *  @param Level    Pyramid level
+ *  @return         Name of the level or "unknown"
+ */
+const char *ImageEncoder_GetLevelName(Network_ImageLevel_t Level);
+
+/** @brief          Get the number of cache hits and misses since initialization.
+ *  @param p_Hits   Pointer to store the number of requests served from the cache (optional)
+ *  @param p_Misses Pointer to store the number of requests that had to be encoded (optional)
+ */
+void ImageEncoder_GetCacheStatistics(uint32_t *p_Hits, uint32_t *p_Misses);
+
+/** @brief  Get the default JPEG encoding quality.
+ *  @return Quality value (1-100)
+ */
+uint8_t ImageEncoder_GetQuality(void);
+
 /** @brief          Set JPEG encoding quality.
  *  @param Quality  Quality value (1-100)
  */
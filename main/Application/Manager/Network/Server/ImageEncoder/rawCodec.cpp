@@ -0,0 +1,255 @@
+/*
+ * rawCodec.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Lossless Rice coder for RAW14 frames.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include "rawCodec.h"
+#include "tileDiff.h"
+
+/** @brief MSB first bit writer.
+ */
+typedef struct {
+    uint8_t *p_Output;
+    size_t Capacity;
+    size_t Length;
+    uint32_t Accumulator;
+    uint8_t Bits;                               /**< Number of pending bits in Accumulator. */
+    bool isOverflow;
+    uint16_t Block[RAW_CODEC_BLOCK_SIZE];       /**< Residuals of the current block. */
+    size_t Fill;                                /**< Number of residuals in Block. */
+} RawCodec_Writer_t;
+
+/** @brief          Append bits to the output.
+ *  @param p_Writer Bit writer
+ *  @param Value    Bits to write, right aligned
+ *  @param Count    Number of bits (at most 24)
+ */
+static inline void RawCodec_Put(RawCodec_Writer_t *p_Writer, uint32_t Value, uint8_t Count)
+{
+    p_Writer->Accumulator = (p_Writer->Accumulator << Count) | (Value & ((1UL << Count) - 1));
+    p_Writer->Bits += Count;
+
+    while (p_Writer->Bits >= 8) {
+        p_Writer->Bits -= 8;
+
+        if (p_Writer->Length >= p_Writer->Capacity) {
+            p_Writer->isOverflow = true;
+            return;
+        }
+
+        p_Writer->p_Output[p_Writer->Length++] = static_cast<uint8_t>(p_Writer->Accumulator >> p_Writer->Bits);
+    }
+}
+
+/** @brief          Get the zigzag mapped residual of a pixel.
+ *  @param Value    Pixel value
+ *  @param Predict  Predicted value
+ *  @return         Zigzag mapped residual
+ */
+static inline uint16_t RawCodec_Residual(uint16_t Value, uint16_t Predict)
+{
+    int16_t Delta = static_cast<int16_t>(Value - Predict);
+
+    return static_cast<uint16_t>((static_cast<uint16_t>(Delta) << 1) ^ static_cast<uint16_t>(Delta >> 15));
+}
+
+/** @brief          Median edge predictor of LOCO-I.
+ *  @param Left     Left neighbour
+ *  @param Up       Upper neighbour
+ *  @param UpLeft   Upper left neighbour
+ *  @return         Predicted value
+ */
+static inline uint16_t RawCodec_Predict(uint16_t Left, uint16_t Up, uint16_t UpLeft)
+{
+    uint16_t Min = (Left < Up) ? Left : Up;
+    uint16_t Max = (Left < Up) ? Up : Left;
+
+    if (UpLeft >= Max) {
+        return Min;
+    } else if (UpLeft <= Min) {
+        return Max;
+    }
+
+    return Left + Up - UpLeft;
+}
+
+/** @brief          Write one block of residuals.
+ *  @param p_Writer Bit writer
+ *  @param p_Block  Residuals
+ *  @param Count    Number of residuals
+ */
+static void RawCodec_WriteBlock(RawCodec_Writer_t *p_Writer, const uint16_t *p_Block, size_t Count)
+{
+    uint32_t Sum = 0;
+    uint8_t K = 0;
+
+    for (size_t i = 0; i < Count; i++) {
+        Sum += p_Block[i];
+    }
+
+    /* 2^k close to the mean residual keeps the quotients small */
+    while ((K < 15) && ((static_cast<uint32_t>(Count) << (K + 1)) <= Sum)) {
+        K++;
+    }
+
+    RawCodec_Put(p_Writer, K, 4);
+
+    for (size_t i = 0; (i < Count) && (p_Writer->isOverflow == false); i++) {
+        uint32_t Quotient = p_Block[i] >> K;
+
+        if (Quotient >= RAW_CODEC_ESCAPE) {
+            RawCodec_Put(p_Writer, (1UL << RAW_CODEC_ESCAPE) - 1, RAW_CODEC_ESCAPE);
+            RawCodec_Put(p_Writer, p_Block[i], 16);
+        } else {
+            /* Ones, terminating zero and the low bits in one or two writes */
+            if ((Quotient + 1 + K) <= 24) {
+                RawCodec_Put(p_Writer, (((1UL << Quotient) - 1) << (K + 1)) | (p_Block[i] & ((1UL << K) - 1)),
+                             Quotient + 1 + K);
+            } else {
+                RawCodec_Put(p_Writer, ((1UL << Quotient) - 1) << 1, Quotient + 1);
+                RawCodec_Put(p_Writer, p_Block[i], K);
+            }
+        }
+    }
+}
+
+/** @brief              Prepare a bit writer.
+ *  @param p_Writer     Bit writer
+ *  @param p_Output     Output buffer
+ *  @param Capacity     Size of the output buffer
+ */
+static void RawCodec_Start(RawCodec_Writer_t *p_Writer, uint8_t *p_Output, size_t Capacity)
+{
+    p_Writer->p_Output = p_Output;
+    p_Writer->Capacity = Capacity;
+    p_Writer->Length = 0;
+    p_Writer->Accumulator = 0;
+    p_Writer->Bits = 0;
+    p_Writer->isOverflow = false;
+    p_Writer->Fill = 0;
+}
+
+/** @brief              Add a residual and write the block when it is full.
+ *  @param p_Writer     Bit writer
+ *  @param Value        Pixel value
+ *  @param Predict      Predicted value
+ */
+static inline void RawCodec_Add(RawCodec_Writer_t *p_Writer, uint16_t Value, uint16_t Predict)
+{
+    p_Writer->Block[p_Writer->Fill++] = RawCodec_Residual(Value, Predict);
+
+    if (p_Writer->Fill == RAW_CODEC_BLOCK_SIZE) {
+        RawCodec_WriteBlock(p_Writer, p_Writer->Block, p_Writer->Fill);
+        p_Writer->Fill = 0;
+    }
+}
+
+/** @brief              Write the last block and pad the last byte with zeros.
+ *  @param p_Writer     Bit writer
+ *  @return             Encoded length or 0 if the output does not fit
+ */
+static size_t RawCodec_Finish(RawCodec_Writer_t *p_Writer)
+{
+    if (p_Writer->Fill > 0) {
+        RawCodec_WriteBlock(p_Writer, p_Writer->Block, p_Writer->Fill);
+        p_Writer->Fill = 0;
+    }
+
+    if (p_Writer->Bits > 0) {
+        RawCodec_Put(p_Writer, 0, 8 - p_Writer->Bits);
+    }
+
+    return p_Writer->isOverflow ? 0 : p_Writer->Length;
+}
+
+size_t RawCodec_Encode(const uint16_t *p_Frame, const uint16_t *p_Reference, uint16_t Width, uint16_t Height,
+                       uint8_t *p_Output, size_t Capacity)
+{
+    RawCodec_Writer_t Writer;
+    size_t Count;
+
+    if ((p_Frame == NULL) || (p_Output == NULL) || (Width == 0) || (Height == 0)) {
+        return 0;
+    }
+
+    RawCodec_Start(&Writer, p_Output, Capacity);
+
+    Count = static_cast<size_t>(Width) * Height;
+
+    for (size_t i = 0; (i < Count) && (Writer.isOverflow == false); i++) {
+        uint16_t Predict;
+
+        if (p_Reference != NULL) {
+            Predict = p_Reference[i];
+        } else if (i < Width) {
+            /* First row, predict from the left */
+            Predict = (i == 0) ? 0 : p_Frame[i - 1];
+        } else if ((i % Width) == 0) {
+            /* First column, predict from above */
+            Predict = p_Frame[i - Width];
+        } else {
+            Predict = RawCodec_Predict(p_Frame[i - 1], p_Frame[i - Width], p_Frame[i - Width - 1]);
+        }
+
+        RawCodec_Add(&Writer, p_Frame[i], Predict);
+    }
+
+    return RawCodec_Finish(&Writer);
+}
+
+size_t RawCodec_EncodeTiles(const uint16_t *p_Frame, const uint16_t *p_Reference, uint16_t Width, uint16_t Height,
+                            const uint8_t *p_Mask, uint8_t *p_Output, size_t Capacity)
+{
+    RawCodec_Writer_t Writer;
+    size_t Tile = 0;
+
+    if ((p_Frame == NULL) || (p_Reference == NULL) || (p_Mask == NULL) || (p_Output == NULL)) {
+        return 0;
+    }
+
+    RawCodec_Start(&Writer, p_Output, Capacity);
+
+    for (uint16_t TileY = 0; TileY < Height; TileY += TILE_DIFF_SIZE) {
+        uint16_t Rows = ((Height - TileY) < TILE_DIFF_SIZE) ? (Height - TileY) : TILE_DIFF_SIZE;
+
+        for (uint16_t TileX = 0; TileX < Width; TileX += TILE_DIFF_SIZE, Tile++) {
+            uint16_t Columns = ((Width - TileX) < TILE_DIFF_SIZE) ? (Width - TileX) : TILE_DIFF_SIZE;
+
+            if ((p_Mask[Tile / 8] & (1 << (Tile % 8))) == 0) {
+                continue;
+            }
+
+            for (uint16_t y = 0; y < Rows; y++) {
+                size_t Offset = ((TileY + y) * Width) + TileX;
+
+                for (uint16_t x = 0; x < Columns; x++) {
+                    RawCodec_Add(&Writer, p_Frame[Offset + x], p_Reference[Offset + x]);
+                }
+            }
+
+            if (Writer.isOverflow) {
+                return 0;
+            }
+        }
+    }
+
+    return RawCodec_Finish(&Writer);
+}
@@ -0,0 +1,78 @@
+/*
+ * rawCodec.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Lossless Rice coder for RAW14 frames.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef RAW_CODEC_H_
+#define RAW_CODEC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** @brief Number of residuals sharing one Rice parameter.
+ */
+#define RAW_CODEC_BLOCK_SIZE                    32
+
+/** @brief Length of the unary prefix that marks an escaped residual.
+ */
+#define RAW_CODEC_ESCAPE                        24
+
+/** @brief Maximum size of an encoded frame with Count pixels.
+ *         Every residual is escaped in the worst case, plus the block parameters and the final byte.
+ */
+#define RAW_CODEC_MAX_SIZE(Count)               ((((Count) * (RAW_CODEC_ESCAPE + 16)) + ((((Count) / RAW_CODEC_BLOCK_SIZE) + 1) * 4)) / 8 + 1)
+
+/** @brief                  Encode a frame as Rice coded residuals.
+ *                          Without a reference the residual of a pixel is the difference to the median edge
+ *                          prediction from its left, upper and upper left neighbours. With a reference the residual
+ *                          is the difference to the pixel at the same position in the reference frame.
+ *                          The residuals are zigzag mapped (0, -1, 1, -2, ... to 0, 1, 2, 3, ...) and written
+ *                          MSB first in blocks of RAW_CODEC_BLOCK_SIZE values. Every block starts with a 4 bit Rice
+ *                          parameter k, followed per value by the unary quotient (value >> k) as ones terminated
+ *                          by a zero and the k low bits. A quotient of RAW_CODEC_ESCAPE or more is written as
+ *                          RAW_CODEC_ESCAPE ones without terminator and the 16 bit value.
+ *  @param p_Frame          Frame (Width * Height)
+ *  @param p_Reference      Reference frame (Width * Height) or NULL for an intra coded frame
+ *  @param Width            Frame width in pixels
+ *  @param Height           Frame height in pixels
+ *  @param p_Output         Output buffer
+ *  @param Capacity         Size of the output buffer
+ *  @return                 Encoded length or 0 if the output does not fit
+ */
+size_t RawCodec_Encode(const uint16_t *p_Frame, const uint16_t *p_Reference, uint16_t Width, uint16_t Height,
+                       uint8_t *p_Output, size_t Capacity);
+
+/** @brief              Encode the changed tiles of a frame as Rice coded differences to a reference frame.
+ *                      The tiles are written in row major order, the pixels of a tile row by row, in the bitstream
+ *                      format of RawCodec_Encode. The residuals of all tiles share one bitstream.
+ *  @param p_Frame      Frame (Width * Height)
+ *  @param p_Reference  Reference frame (Width * Height)
+ *  @param Width        Frame width in pixels
+ *  @param Height       Frame height in pixels
+ *  @param p_Mask       Change mask of TileDiff_Compare
+ *  @param p_Output     Output buffer
+ *  @param Capacity     Size of the output buffer
+ *  @return             Encoded length or 0 if the output does not fit
+ */
+size_t RawCodec_EncodeTiles(const uint16_t *p_Frame, const uint16_t *p_Reference, uint16_t Width, uint16_t Height,
+                            const uint8_t *p_Mask, uint8_t *p_Output, size_t Capacity);
+
+#endif /* RAW_CODEC_H_ */
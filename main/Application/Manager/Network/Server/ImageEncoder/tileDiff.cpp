@@ -0,0 +1,74 @@
+/*
+ * tileDiff.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Tile based change detection for RAW14 frames.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <string.h>
+
+#include "tileDiff.h"
+
+size_t TileDiff_Compare(const uint16_t *p_Frame, const uint16_t *p_Reference, uint16_t Width, uint16_t Height,
+                        uint16_t Threshold, uint8_t *p_Mask)
+{
+    size_t Changed = 0;
+    size_t Tile = 0;
+
+    if ((p_Frame == NULL) || (p_Reference == NULL) || (p_Mask == NULL)) {
+        return 0;
+    }
+
+    memset(p_Mask, 0, TILE_DIFF_MASK_SIZE(Width, Height));
+
+    for (uint16_t TileY = 0; TileY < Height; TileY += TILE_DIFF_SIZE) {
+        uint16_t Rows = ((Height - TileY) < TILE_DIFF_SIZE) ? (Height - TileY) : TILE_DIFF_SIZE;
+
+        for (uint16_t TileX = 0; TileX < Width; TileX += TILE_DIFF_SIZE, Tile++) {
+            uint16_t Columns = ((Width - TileX) < TILE_DIFF_SIZE) ? (Width - TileX) : TILE_DIFF_SIZE;
+            uint32_t Limit = static_cast<uint32_t>(Threshold) * Rows * Columns;
+            uint32_t Peak = static_cast<uint32_t>(Threshold) * 4;
+            uint32_t Sum = 0;
+            bool isChanged = false;
+
+            /* Stop at the first row that decides the tile, most tiles of a moving scene are decided early */
+            for (uint16_t y = 0; (y < Rows) && (isChanged == false); y++) {
+                const uint16_t *Frame = &p_Frame[((TileY + y) * Width) + TileX];
+                const uint16_t *Reference = &p_Reference[((TileY + y) * Width) + TileX];
+                uint32_t Max = 0;
+
+                for (uint16_t x = 0; x < Columns; x++) {
+                    uint32_t Difference = (Frame[x] > Reference[x]) ? (Frame[x] - Reference[x]) : (Reference[x] - Frame[x]);
+
+                    Sum += Difference;
+                    Max = (Difference > Max) ? Difference : Max;
+                }
+
+                isChanged = (Sum > Limit) || (Max > Peak);
+            }
+
+            if (isChanged) {
+                p_Mask[Tile / 8] |= (1 << (Tile % 8));
+                Changed++;
+            }
+        }
+    }
+
+    return Changed;
+}
@@ -0,0 +1,56 @@
+/*
+ * tileDiff.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Tile based change detection for RAW14 frames.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef TILE_DIFF_H_
+#define TILE_DIFF_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** @brief Edge length of a tile in pixels. Tiles at the right and bottom border can be smaller.
+ */
+#define TILE_DIFF_SIZE                          16
+
+/** @brief Number of tiles per row / column.
+ */
+#define TILE_DIFF_COUNT(Length)                 (((Length) + TILE_DIFF_SIZE - 1) / TILE_DIFF_SIZE)
+
+/** @brief Size of a change mask in bytes. Bit (n % 8) of byte (n / 8) is tile n in row major order.
+ */
+#define TILE_DIFF_MASK_SIZE(Width, Height)      (((TILE_DIFF_COUNT(Width) * TILE_DIFF_COUNT(Height)) + 7) / 8)
+
+/** @brief              Compare a frame with a reference frame tile by tile. A tile has changed when the mean absolute
+ *                      difference of its pixels is above Threshold or a single pixel differs by more than
+ *                      4 * Threshold, so small hot spots are not averaged away.
+ *  @param p_Frame      Frame (Width * Height)
+ *  @param p_Reference  Reference frame (Width * Height)
+ *  @param Width        Frame width in pixels
+ *  @param Height       Frame height in pixels
+ *  @param Threshold    Noise threshold in raw counts
+ *  @param p_Mask       Change mask with TILE_DIFF_MASK_SIZE(Width, Height) bytes
+ *  @return             Number of changed tiles
+ */
+size_t TileDiff_Compare(const uint16_t *p_Frame, const uint16_t *p_Reference, uint16_t Width, uint16_t Height,
+                        uint16_t Threshold, uint8_t *p_Mask);
+
+#endif /* TILE_DIFF_H_ */
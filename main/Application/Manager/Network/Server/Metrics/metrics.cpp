@@ -0,0 +1,533 @@
+/*
+ * metrics.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Runtime performance metrics of the tasks, heaps and the event loop.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <sdkconfig.h>
+
+#ifdef CONFIG_NETWORK_METRICS
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_event.h>
+#include <esp_heap_caps.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdarg>
+#include <cstring>
+
+#include "metrics.h"
+
+#if !CONFIG_FREERTOS_USE_TRACE_FACILITY || !CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+#error "The metrics need CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS!"
+#endif
+
+ESP_EVENT_DEFINE_BASE(METRICS_EVENTS);
+
+/** @brief Events of the metrics module.
+ */
+enum {
+    METRICS_EVENT_PROBE,                        /**< Probe to measure the queueing delay of the event loop. */
+};
+
+/** @brief Run time of a task at the previous snapshot.
+ */
+typedef struct {
+    TaskHandle_t Handle;
+    configRUN_TIME_COUNTER_TYPE RunTime;
+} Metrics_RunTime_t;
+
+typedef struct {
+    bool isInitialized;
+    SemaphoreHandle_t Mutex;
+    esp_event_handler_instance_t Handler;
+    configRUN_TIME_COUNTER_TYPE TotalRunTime;   /**< Run time counter at the previous snapshot. */
+    uint16_t PreviousCount;
+    Metrics_RunTime_t Previous[CONFIG_NETWORK_METRICS_MAX_TASKS];
+    configRUN_TIME_COUNTER_TYPE IdleRunTime[portNUM_PROCESSORS];    /**< Idle task run time at the previous
+                                                                         snapshot. */
+    bool isProbePending;
+    int64_t ProbeTime;                          /**< Time the pending probe was posted in us. */
+    uint32_t EventLag;
+    uint32_t EventLagMax;
+    uint32_t EventFull;
+} Metrics_State_t;
+
+static Metrics_State_t _Metrics_State;
+
+/* The probe is received by the event loop task, the snapshots are built by the HTTP server and VISA tasks */
+static portMUX_TYPE _Metrics_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *_Metrics_HeapNames[METRICS_HEAP_COUNT] = {
+    "internal",
+    "psram",
+};
+
+static const uint32_t _Metrics_HeapCaps[METRICS_HEAP_COUNT] = {
+    MALLOC_CAP_INTERNAL,
+    MALLOC_CAP_SPIRAM,
+};
+
+static const char *TAG = "metrics";
+
+/** @brief                  Event handler of the event loop probe.
+ *  @param p_HandlerArgs    Unused
+ *  @param Base             Event base
+ *  @param ID               Event ID
+ *  @param p_Data           Event data
+ */
+static void on_Metrics_Probe(void *p_HandlerArgs, esp_event_base_t Base, int32_t ID, void *p_Data)
+{
+    int64_t Now;
+
+    Now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&_Metrics_Lock);
+    if (_Metrics_State.isProbePending) {
+        _Metrics_State.EventLag = static_cast<uint32_t>(Now - _Metrics_State.ProbeTime);
+        if (_Metrics_State.EventLag > _Metrics_State.EventLagMax) {
+            _Metrics_State.EventLagMax = _Metrics_State.EventLag;
+        }
+
+        _Metrics_State.isProbePending = false;
+    }
+    portEXIT_CRITICAL(&_Metrics_Lock);
+}
+
+/** @brief              Report the event loop probe and post the next one. The queue depth of the default event
+ *                      loop is not accessible, the time an event waits in the queue is measured instead.
+ *  @param p_Snapshot   Snapshot to store the event loop metrics
+ */
+static void Metrics_Probe(Metrics_Snapshot_t *p_Snapshot)
+{
+    int64_t Now;
+    bool doPost;
+
+    Now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&_Metrics_Lock);
+    /* A probe that is still queued is at least as late as its age */
+    if (_Metrics_State.isProbePending) {
+        uint32_t Age = static_cast<uint32_t>(Now - _Metrics_State.ProbeTime);
+
+        p_Snapshot->EventLag = (Age > _Metrics_State.EventLag) ? Age : _Metrics_State.EventLag;
+    } else {
+        p_Snapshot->EventLag = _Metrics_State.EventLag;
+    }
+    p_Snapshot->EventLagMax = (p_Snapshot->EventLag > _Metrics_State.EventLagMax) ? p_Snapshot->EventLag :
+                              _Metrics_State.EventLagMax;
+
+    doPost = (_Metrics_State.isProbePending == false);
+    if (doPost) {
+        _Metrics_State.isProbePending = true;
+        _Metrics_State.ProbeTime = Now;
+    }
+    portEXIT_CRITICAL(&_Metrics_Lock);
+
+    /* Never wait, a full queue is what the probe is looking for */
+    if (doPost && (esp_event_post(METRICS_EVENTS, METRICS_EVENT_PROBE, NULL, 0, 0) != ESP_OK)) {
+        portENTER_CRITICAL(&_Metrics_Lock);
+        _Metrics_State.isProbePending = false;
+        _Metrics_State.EventFull++;
+        portEXIT_CRITICAL(&_Metrics_Lock);
+    }
+
+    p_Snapshot->EventFull = _Metrics_State.EventFull;
+}
+
+/** @brief          Copy a task name, characters that need an escape in JSON or Prometheus labels are replaced.
+ *  @param p_Dest   Destination with configMAX_TASK_NAME_LEN characters
+ *  @param p_Name   Task name
+ */
+static void Metrics_CopyName(char *p_Dest, const char *p_Name)
+{
+    size_t i;
+
+    for (i = 0; (i < (configMAX_TASK_NAME_LEN - 1)) && (p_Name[i] != '\0'); i++) {
+        p_Dest[i] = ((p_Name[i] == '"') || (p_Name[i] == '\\') || (p_Name[i] < ' ')) ? '_' : p_Name[i];
+    }
+
+    p_Dest[i] = '\0';
+}
+
+/** @brief          Append formatted text to a buffer.
+ *  @param p_Buffer Output buffer
+ *  @param Size     Size of the output buffer in bytes
+ *  @param p_Length Current length, set to -1 when the buffer is full
+ *  @param p_Format printf format
+ */
+static void Metrics_Append(char *p_Buffer, size_t Size, int *p_Length, const char *p_Format, ...)
+{
+    va_list Args;
+    int Length;
+
+    if (*p_Length < 0) {
+        return;
+    }
+
+    va_start(Args, p_Format);
+    Length = vsnprintf(p_Buffer + *p_Length, Size - *p_Length, p_Format, Args);
+    va_end(Args);
+
+    if ((Length < 0) || (Length >= static_cast<int>(Size - *p_Length))) {
+        *p_Length = -1;
+    } else {
+        *p_Length += Length;
+    }
+}
+
+/** @brief              Serialize a snapshot as compact JSON.
+ *  @param p_Snapshot   Snapshot
+ *  @param p_Buffer     Output buffer
+ *  @param Size         Size of the output buffer in bytes
+ *  @return             Length of the output, -1 if the buffer is too small
+ */
+static int Metrics_FormatJSON(const Metrics_Snapshot_t *p_Snapshot, char *p_Buffer, size_t Size)
+{
+    int Length = 0;
+
+    Metrics_Append(p_Buffer, Size, &Length, "{\"uptime_s\":%lu,\"tasks_total\":%u,\"tasks\":[",
+                   static_cast<unsigned long>(p_Snapshot->Uptime / 1000), p_Snapshot->TaskTotal);
+
+    /* [name, core, priority, cpu %, stack free] */
+    for (uint16_t i = 0; i < p_Snapshot->TaskCount; i++) {
+        const Metrics_Task_t *Task = &p_Snapshot->Tasks[i];
+
+        Metrics_Append(p_Buffer, Size, &Length, "%s[\"%s\",%d,%u,%.1f,%lu]", (i > 0) ? "," : "", Task->Name,
+                       Task->Core, Task->Priority, Task->CPU / 10.0, static_cast<unsigned long>(Task->StackFree));
+    }
+
+    Metrics_Append(p_Buffer, Size, &Length, "],\"cores\":[");
+
+    /* Load in % */
+    for (uint8_t i = 0; i < portNUM_PROCESSORS; i++) {
+        Metrics_Append(p_Buffer, Size, &Length, "%s%.1f", (i > 0) ? "," : "", p_Snapshot->CoreLoad[i] / 10.0);
+    }
+
+    Metrics_Append(p_Buffer, Size, &Length, "],\"heap\":{");
+
+    /* [free, largest block, minimum free] */
+    for (uint8_t i = 0; i < METRICS_HEAP_COUNT; i++) {
+        const Metrics_HeapInfo_t *Heap = &p_Snapshot->Heaps[i];
+
+        Metrics_Append(p_Buffer, Size, &Length, "%s\"%s\":[%lu,%lu,%lu]", (i > 0) ? "," : "", _Metrics_HeapNames[i],
+                       static_cast<unsigned long>(Heap->Free), static_cast<unsigned long>(Heap->Largest),
+                       static_cast<unsigned long>(Heap->Minimum));
+    }
+
+    Metrics_Append(p_Buffer, Size, &Length, "},\"event_loop\":{\"lag_us\":%lu,\"max_lag_us\":%lu,\"full\":%lu},",
+                   static_cast<unsigned long>(p_Snapshot->EventLag),
+                   static_cast<unsigned long>(p_Snapshot->EventLagMax),
+                   static_cast<unsigned long>(p_Snapshot->EventFull));
+
+    Metrics_Append(p_Buffer, Size, &Length, "\"http_workers\":{\"workers\":%u,\"depth\":%u,\"max_depth\":%u,"
+                   "\"max_wait_ms\":%lu,\"classes\":{", p_Snapshot->Workers.Workers, p_Snapshot->Workers.Depth,
+                   p_Snapshot->Workers.MaxDepth, static_cast<unsigned long>(p_Snapshot->Workers.MaxWait));
+
+    /* [active, limit, done, rejected] */
+    for (uint8_t i = 0; i < HTTP_WORKERS_CLASS_COUNT; i++) {
+        const HTTP_Workers_ClassStatus_t *Class = &p_Snapshot->Workers.Classes[i];
+
+        Metrics_Append(p_Buffer, Size, &Length, "%s\"%s\":[%u,%u,%lu,%lu]", (i > 0) ? "," : "",
+                       HTTP_Workers_GetClassName(static_cast<HTTP_Workers_Class_t>(i)), Class->Active, Class->Limit,
+                       static_cast<unsigned long>(Class->Done), static_cast<unsigned long>(Class->Rejected));
+    }
+
+    Metrics_Append(p_Buffer, Size, &Length, "}}}");
+
+    return Length;
+}
+
+/** @brief              Serialize a snapshot in the Prometheus text exposition format.
+ *  @param p_Snapshot   Snapshot
+ *  @param p_Buffer     Output buffer
+ *  @param Size         Size of the output buffer in bytes
+ *  @return             Length of the output, -1 if the buffer is too small
+ */
+static int Metrics_FormatPrometheus(const Metrics_Snapshot_t *p_Snapshot, char *p_Buffer, size_t Size)
+{
+    int Length = 0;
+
+    Metrics_Append(p_Buffer, Size, &Length, "# TYPE pyrovision_uptime_seconds gauge\n"
+                   "pyrovision_uptime_seconds %.3f\n"
+                   "# TYPE pyrovision_tasks gauge\n"
+                   "pyrovision_tasks %u\n", p_Snapshot->Uptime / 1000.0, p_Snapshot->TaskTotal);
+
+    /* Rates are computed by the collector from the run time counter, the share is the window of the last scrape */
+    Metrics_Append(p_Buffer, Size, &Length, "# TYPE pyrovision_task_runtime_seconds_total counter\n");
+    for (uint16_t i = 0; i < p_Snapshot->TaskCount; i++) {
+        Metrics_Append(p_Buffer, Size, &Length, "pyrovision_task_runtime_seconds_total{task=\"%s\",core=\"%d\"} %.6f\n",
+                       p_Snapshot->Tasks[i].Name, p_Snapshot->Tasks[i].Core, p_Snapshot->Tasks[i].RunTime / 1000000.0);
+    }
+
+    Metrics_Append(p_Buffer, Size, &Length, "# TYPE pyrovision_task_cpu_ratio gauge\n");
+    for (uint16_t i = 0; i < p_Snapshot->TaskCount; i++) {
+        Metrics_Append(p_Buffer, Size, &Length, "pyrovision_task_cpu_ratio{task=\"%s\"} %.3f\n",
+                       p_Snapshot->Tasks[i].Name, p_Snapshot->Tasks[i].CPU / 1000.0);
+    }
+
+    Metrics_Append(p_Buffer, Size, &Length, "# TYPE pyrovision_core_load_ratio gauge\n");
+    for (uint8_t i = 0; i < portNUM_PROCESSORS; i++) {
+        Metrics_Append(p_Buffer, Size, &Length, "pyrovision_core_load_ratio{core=\"%u\"} %.3f\n", i,
+                       p_Snapshot->CoreLoad[i] / 1000.0);
+    }
+
+    Metrics_Append(p_Buffer, Size, &Length, "# TYPE pyrovision_task_stack_free_bytes gauge\n");
+    for (uint16_t i = 0; i < p_Snapshot->TaskCount; i++) {
+        Metrics_Append(p_Buffer, Size, &Length, "pyrovision_task_stack_free_bytes{task=\"%s\"} %lu\n",
+                       p_Snapshot->Tasks[i].Name, static_cast<unsigned long>(p_Snapshot->Tasks[i].StackFree));
+    }
+
+    Metrics_Append(p_Buffer, Size, &Length, "# TYPE pyrovision_heap_free_bytes gauge\n");
+    for (uint8_t i = 0; i < METRICS_HEAP_COUNT; i++) {
+        Metrics_Append(p_Buffer, Size, &Length, "pyrovision_heap_free_bytes{heap=\"%s\"} %lu\n", _Metrics_HeapNames[i],
+                       static_cast<unsigned long>(p_Snapshot->Heaps[i].Free));
+    }
+
+    Metrics_Append(p_Buffer, Size, &Length, "# TYPE pyrovision_heap_largest_block_bytes gauge\n");
+    for (uint8_t i = 0; i < METRICS_HEAP_COUNT; i++) {
+        Metrics_Append(p_Buffer, Size, &Length, "pyrovision_heap_largest_block_bytes{heap=\"%s\"} %lu\n",
+                       _Metrics_HeapNames[i], static_cast<unsigned long>(p_Snapshot->Heaps[i].Largest));
+    }
+
+    Metrics_Append(p_Buffer, Size, &Length, "# TYPE pyrovision_heap_minimum_free_bytes gauge\n");
+    for (uint8_t i = 0; i < METRICS_HEAP_COUNT; i++) {
+        Metrics_Append(p_Buffer, Size, &Length, "pyrovision_heap_minimum_free_bytes{heap=\"%s\"} %lu\n",
+                       _Metrics_HeapNames[i], static_cast<unsigned long>(p_Snapshot->Heaps[i].Minimum));
+    }
+
+    Metrics_Append(p_Buffer, Size, &Length, "# TYPE pyrovision_event_loop_lag_seconds gauge\n"
+                   "pyrovision_event_loop_lag_seconds %.6f\n"
+                   "# TYPE pyrovision_event_loop_lag_max_seconds gauge\n"
+                   "pyrovision_event_loop_lag_max_seconds %.6f\n"
+                   "# TYPE pyrovision_event_loop_full_total counter\n"
+                   "pyrovision_event_loop_full_total %lu\n",
+                   p_Snapshot->EventLag / 1000000.0, p_Snapshot->EventLagMax / 1000000.0,
+                   static_cast<unsigned long>(p_Snapshot->EventFull));
+
+    Metrics_Append(p_Buffer, Size, &Length, "# TYPE pyrovision_http_queue_depth gauge\n"
+                   "pyrovision_http_queue_depth %u\n"
+                   "# TYPE pyrovision_http_queue_depth_max gauge\n"
+                   "pyrovision_http_queue_depth_max %u\n"
+                   "# TYPE pyrovision_http_queue_wait_max_seconds gauge\n"
+                   "pyrovision_http_queue_wait_max_seconds %.3f\n",
+                   p_Snapshot->Workers.Depth, p_Snapshot->Workers.MaxDepth, p_Snapshot->Workers.MaxWait / 1000.0);
+
+    Metrics_Append(p_Buffer, Size, &Length, "# TYPE pyrovision_http_requests_active gauge\n");
+    for (uint8_t i = 0; i < HTTP_WORKERS_CLASS_COUNT; i++) {
+        Metrics_Append(p_Buffer, Size, &Length, "pyrovision_http_requests_active{class=\"%s\"} %u\n",
+                       HTTP_Workers_GetClassName(static_cast<HTTP_Workers_Class_t>(i)),
+                       p_Snapshot->Workers.Classes[i].Active);
+    }
+
+    Metrics_Append(p_Buffer, Size, &Length, "# TYPE pyrovision_http_requests_total counter\n");
+    for (uint8_t i = 0; i < HTTP_WORKERS_CLASS_COUNT; i++) {
+        Metrics_Append(p_Buffer, Size, &Length, "pyrovision_http_requests_total{class=\"%s\"} %lu\n",
+                       HTTP_Workers_GetClassName(static_cast<HTTP_Workers_Class_t>(i)),
+                       static_cast<unsigned long>(p_Snapshot->Workers.Classes[i].Done));
+    }
+
+    Metrics_Append(p_Buffer, Size, &Length, "# TYPE pyrovision_http_requests_rejected_total counter\n");
+    for (uint8_t i = 0; i < HTTP_WORKERS_CLASS_COUNT; i++) {
+        Metrics_Append(p_Buffer, Size, &Length, "pyrovision_http_requests_rejected_total{class=\"%s\"} %lu\n",
+                       HTTP_Workers_GetClassName(static_cast<HTTP_Workers_Class_t>(i)),
+                       static_cast<unsigned long>(p_Snapshot->Workers.Classes[i].Rejected));
+    }
+
+    return Length;
+}
+
+esp_err_t Metrics_Init(void)
+{
+    esp_err_t Error;
+
+    if (_Metrics_State.isInitialized) {
+        ESP_LOGW(TAG, "Already initialized");
+        return ESP_OK;
+    }
+
+    memset(&_Metrics_State, 0, sizeof(_Metrics_State));
+
+    _Metrics_State.Mutex = xSemaphoreCreateMutex();
+    if (_Metrics_State.Mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex!");
+        return ESP_ERR_NO_MEM;
+    }
+
+    Error = esp_event_handler_instance_register(METRICS_EVENTS, METRICS_EVENT_PROBE, &on_Metrics_Probe, NULL,
+                                                &_Metrics_State.Handler);
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register probe handler!");
+
+        vSemaphoreDelete(_Metrics_State.Mutex);
+        _Metrics_State.Mutex = NULL;
+
+        return Error;
+    }
+
+    _Metrics_State.isInitialized = true;
+
+    return ESP_OK;
+}
+
+void Metrics_Deinit(void)
+{
+    if (_Metrics_State.isInitialized == false) {
+        return;
+    }
+
+    esp_event_handler_instance_unregister(METRICS_EVENTS, METRICS_EVENT_PROBE, _Metrics_State.Handler);
+    _Metrics_State.Handler = NULL;
+
+    vSemaphoreDelete(_Metrics_State.Mutex);
+    _Metrics_State.Mutex = NULL;
+
+    _Metrics_State.isInitialized = false;
+}
+
+esp_err_t Metrics_Get(Metrics_Snapshot_t *p_Snapshot)
+{
+    TaskStatus_t *Status;
+    configRUN_TIME_COUNTER_TYPE TotalRunTime;
+    configRUN_TIME_COUNTER_TYPE Window;
+    configRUN_TIME_COUNTER_TYPE CoreWindow;
+    UBaseType_t Capacity;
+    UBaseType_t Count;
+
+    if (p_Snapshot == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_Metrics_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* Some headroom for tasks that are created while the array is allocated */
+    Capacity = uxTaskGetNumberOfTasks() + 4;
+    Status = reinterpret_cast<TaskStatus_t *>(malloc(Capacity * sizeof(TaskStatus_t)));
+    if (Status == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(p_Snapshot, 0, sizeof(Metrics_Snapshot_t));
+
+    xSemaphoreTake(_Metrics_State.Mutex, portMAX_DELAY);
+
+    TotalRunTime = 0;
+    Count = uxTaskGetSystemState(Status, Capacity, &TotalRunTime);
+
+    /* The counter runs once for both cores, every core adds its own share */
+    Window = (TotalRunTime - _Metrics_State.TotalRunTime) * portNUM_PROCESSORS;
+
+    p_Snapshot->Uptime = esp_timer_get_time() / 1000;
+    p_Snapshot->TaskTotal = Count;
+    p_Snapshot->TaskCount = (Count > CONFIG_NETWORK_METRICS_MAX_TASKS) ? CONFIG_NETWORK_METRICS_MAX_TASKS : Count;
+
+    for (uint16_t i = 0; i < p_Snapshot->TaskCount; i++) {
+        Metrics_Task_t *Task = &p_Snapshot->Tasks[i];
+        configRUN_TIME_COUNTER_TYPE Previous = 0;
+        configRUN_TIME_COUNTER_TYPE Delta;
+        BaseType_t Core;
+
+        /* A task that is not in the previous snapshot was created after it */
+        for (uint16_t j = 0; j < _Metrics_State.PreviousCount; j++) {
+            if (_Metrics_State.Previous[j].Handle == Status[i].xHandle) {
+                Previous = _Metrics_State.Previous[j].RunTime;
+                break;
+            }
+        }
+
+        Delta = (Status[i].ulRunTimeCounter >= Previous) ? (Status[i].ulRunTimeCounter - Previous) : 0;
+
+        Core = xTaskGetCoreID(Status[i].xHandle);
+
+        Metrics_CopyName(Task->Name, Status[i].pcTaskName);
+        Task->Core = (Core == tskNO_AFFINITY) ? -1 : static_cast<int8_t>(Core);
+        Task->Priority = static_cast<uint8_t>(Status[i].uxCurrentPriority);
+        Task->CPU = (Window > 0) ? static_cast<uint16_t>((Delta * 1000) / Window) : 0;
+        Task->CPU = (Task->CPU > 1000) ? 1000 : Task->CPU;
+        Task->RunTime = Status[i].ulRunTimeCounter;
+        Task->StackFree = Status[i].usStackHighWaterMark * sizeof(StackType_t);
+
+        _Metrics_State.Previous[i].Handle = Status[i].xHandle;
+        _Metrics_State.Previous[i].RunTime = Status[i].ulRunTimeCounter;
+    }
+
+    /* The idle tasks are searched in all tasks, they can be behind the tasks of the snapshot */
+    CoreWindow = TotalRunTime - _Metrics_State.TotalRunTime;
+    for (uint8_t i = 0; i < portNUM_PROCESSORS; i++) {
+        TaskHandle_t Idle = xTaskGetIdleTaskHandleForCore(i);
+
+        for (UBaseType_t j = 0; j < Count; j++) {
+            configRUN_TIME_COUNTER_TYPE Delta;
+
+            if (Status[j].xHandle != Idle) {
+                continue;
+            }
+
+            Delta = (Status[j].ulRunTimeCounter >= _Metrics_State.IdleRunTime[i]) ?
+                    (Status[j].ulRunTimeCounter - _Metrics_State.IdleRunTime[i]) : 0;
+            Delta = (Delta > CoreWindow) ? CoreWindow : Delta;
+
+            p_Snapshot->CoreLoad[i] = (CoreWindow > 0) ?
+                                      static_cast<uint16_t>(1000 - ((Delta * 1000) / CoreWindow)) : 0;
+            _Metrics_State.IdleRunTime[i] = Status[j].ulRunTimeCounter;
+            break;
+        }
+    }
+
+    _Metrics_State.PreviousCount = p_Snapshot->TaskCount;
+    _Metrics_State.TotalRunTime = TotalRunTime;
+
+    Metrics_Probe(p_Snapshot);
+
+    xSemaphoreGive(_Metrics_State.Mutex);
+
+    free(Status);
+
+    for (uint8_t i = 0; i < METRICS_HEAP_COUNT; i++) {
+        p_Snapshot->Heaps[i].Free = heap_caps_get_free_size(_Metrics_HeapCaps[i]);
+        p_Snapshot->Heaps[i].Largest = heap_caps_get_largest_free_block(_Metrics_HeapCaps[i]);
+        p_Snapshot->Heaps[i].Minimum = heap_caps_get_minimum_free_size(_Metrics_HeapCaps[i]);
+    }
+
+    HTTP_Workers_GetStatus(&p_Snapshot->Workers);
+
+    return ESP_OK;
+}
+
+int Metrics_Format(const Metrics_Snapshot_t *p_Snapshot, Metrics_Format_t Format, char *p_Buffer, size_t Size)
+{
+    if ((p_Snapshot == NULL) || (p_Buffer == NULL) || (Size == 0)) {
+        return -1;
+    }
+
+    if (Format == METRICS_FORMAT_PROMETHEUS) {
+        return Metrics_FormatPrometheus(p_Snapshot, p_Buffer, Size);
+    }
+
+    return Metrics_FormatJSON(p_Snapshot, p_Buffer, Size);
+}
+
+#endif /* CONFIG_NETWORK_METRICS */
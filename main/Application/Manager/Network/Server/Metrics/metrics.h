@@ -0,0 +1,125 @@
+/*
+ * metrics.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Runtime performance metrics of the tasks, heaps and the event loop.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <esp_err.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <sdkconfig.h>
+
+#include "../Workers/httpWorkers.h"
+
+#ifdef CONFIG_NETWORK_METRICS
+
+/** @brief Size of an output buffer that fits a snapshot with CONFIG_NETWORK_METRICS_MAX_TASKS in every format.
+ */
+#define METRICS_BUFFER_SIZE                     (2048 + (CONFIG_NETWORK_METRICS_MAX_TASKS * 192))
+
+/** @brief Output formats of a metrics snapshot.
+ */
+typedef enum {
+    METRICS_FORMAT_JSON,                        /**< Compact JSON object. */
+    METRICS_FORMAT_PROMETHEUS,                  /**< Prometheus text exposition format. */
+} Metrics_Format_t;
+
+/** @brief Heaps of a metrics snapshot.
+ */
+typedef enum {
+    METRICS_HEAP_INTERNAL,
+    METRICS_HEAP_PSRAM,
+    METRICS_HEAP_COUNT,
+} Metrics_Heap_t;
+
+/** @brief Runtime metrics of a task.
+ */
+typedef struct {
+    char Name[configMAX_TASK_NAME_LEN];
+    int8_t Core;                                /**< Core of the task, -1 if it is not pinned. */
+    uint8_t Priority;                           /**< Current priority. */
+    uint16_t CPU;                               /**< Share of the CPU time of both cores since the previous
+                                                     snapshot in 0.1 %. */
+    uint64_t RunTime;                           /**< Run time since boot in us. */
+    uint32_t StackFree;                         /**< Stack high water mark in bytes. */
+} Metrics_Task_t;
+
+/** @brief Free memory of a heap.
+ */
+typedef struct {
+    uint32_t Free;                              /**< Free bytes. */
+    uint32_t Largest;                           /**< Largest free block in bytes. */
+    uint32_t Minimum;                           /**< Minimum free bytes since boot. */
+} Metrics_HeapInfo_t;
+
+/** @brief Metrics snapshot.
+ */
+typedef struct {
+    uint32_t Uptime;                            /**< Time since boot in ms. */
+    uint16_t TaskCount;                         /**< Number of tasks in Tasks. */
+    uint16_t TaskTotal;                         /**< Number of tasks of the system, can exceed TaskCount. */
+    Metrics_Task_t Tasks[CONFIG_NETWORK_METRICS_MAX_TASKS];
+    uint16_t CoreLoad[portNUM_PROCESSORS];      /**< Load of every core since the previous snapshot in 0.1 %, the
+                                                     time its idle task did not run. */
+    Metrics_HeapInfo_t Heaps[METRICS_HEAP_COUNT];
+    uint32_t EventLag;                          /**< Queueing delay of the latest event loop probe in us. */
+    uint32_t EventLagMax;                       /**< Maximum queueing delay since boot in us. */
+    uint32_t EventFull;                         /**< Probes that did not fit into the event queue. */
+    HTTP_Workers_Status_t Workers;              /**< Queue and request classes of the HTTP worker pool. */
+} Metrics_Snapshot_t;
+
+/** @brief  Initialize the metrics and register the event loop probe. The default event loop must exist.
+ *  @return ESP_OK on success
+ */
+esp_err_t Metrics_Init(void);
+
+/** @brief Deinitialize the metrics.
+ */
+void Metrics_Deinit(void);
+
+/** @brief              Build a metrics snapshot. The CPU share covers the time since the previous call by any
+ *                      caller, so the first snapshot reports the share since boot.
+ *  @param p_Snapshot   Pointer to store the snapshot
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if p_Snapshot is NULL
+ *                      ESP_ERR_INVALID_STATE if the module is not initialized
+ */
+esp_err_t Metrics_Get(Metrics_Snapshot_t *p_Snapshot);
+
+/** @brief              Serialize a metrics snapshot.
+ *  @param p_Snapshot   Snapshot
+ *  @param Format       Output format
+ *  @param p_Buffer     Output buffer
+ *  @param Size         Size of the output buffer in bytes
+ *  @return             Length of the output without the terminating zero, -1 if the buffer is too small
+ */
+int Metrics_Format(const Metrics_Snapshot_t *p_Snapshot, Metrics_Format_t Format, char *p_Buffer, size_t Size);
+
+#endif /* CONFIG_NETWORK_METRICS */
+
+#endif /* METRICS_H_ */
@@ -0,0 +1,328 @@
+/*
+ * otaWriter.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Double buffered firmware writer for OTA updates.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_event.h>
+#include <esp_ota_ops.h>
+#include <esp_heap_caps.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <cstring>
+
+#include <sdkconfig.h>
+
+#include "otaWriter.h"
+#include "../../networkTypes.h"
+
+/** @brief Filled buffer for the writer task. A NULL buffer ends the task.
+ */
+typedef struct {
+    uint8_t *Buffer;
+    size_t Length;
+} OTAWriter_Chunk_t;
+
+typedef struct {
+    bool isActive;
+    const esp_partition_t *Partition;
+    esp_ota_handle_t Handle;
+    uint8_t *Buffers[OTA_WRITER_BUFFERS];
+    QueueHandle_t FreeQueue;                    /**< Empty buffers for the receiver. */
+    QueueHandle_t FullQueue;                    /**< Filled buffers for the writer task. */
+    SemaphoreHandle_t Done;                     /**< Given by the writer task when it has ended. */
+    TaskHandle_t Task;
+    volatile esp_err_t Error;                   /**< First error of the writer task. */
+    size_t Size;
+    size_t Written;
+    uint32_t ProgressTime;                      /**< Time of the last progress event in ms. */
+} OTAWriter_State_t;
+
+static OTAWriter_State_t _OTAWriter_State;
+
+static const char *TAG = "ota_writer";
+
+/** @brief Post a progress event, at most every CONFIG_NETWORK_OTA_PROGRESS_INTERVAL ms and for the last chunk.
+ */
+static void OTAWriter_PostProgress(void)
+{
+    uint32_t Now;
+    Network_Event_OTA_Progress_t Progress;
+
+    Now = esp_timer_get_time() / 1000;
+    if (((Now - _OTAWriter_State.ProgressTime) < CONFIG_NETWORK_OTA_PROGRESS_INTERVAL) &&
+        (_OTAWriter_State.Written < _OTAWriter_State.Size)) {
+        return;
+    }
+
+    Progress.bytes_written = _OTAWriter_State.Written;
+    Progress.total_bytes = _OTAWriter_State.Size;
+
+    /* Do not wait for the event loop, the next event carries the newer progress anyway */
+    esp_event_post(NETWORK_EVENTS, NETWORK_EVENT_OTA_PROGRESS, &Progress, sizeof(Progress), 0);
+
+    ESP_LOGD(TAG, "OTA progress: %lu/%lu bytes", Progress.bytes_written, Progress.total_bytes);
+
+    _OTAWriter_State.ProgressTime = Now;
+}
+
+/** @brief          Writer task. Writes the filled buffers to the flash while the next buffer is received.
+ *  @param p_Param  Unused
+ */
+static void OTAWriter_Task(void *p_Param)
+{
+    OTAWriter_Chunk_t Chunk;
+
+    while (true) {
+        xQueueReceive(_OTAWriter_State.FullQueue, &Chunk, portMAX_DELAY);
+        if (Chunk.Buffer == NULL) {
+            break;
+        }
+
+        /* After an error the buffers are only returned, so the receiver does not block */
+        if (_OTAWriter_State.Error == ESP_OK) {
+            esp_err_t Error;
+
+            Error = esp_ota_write(_OTAWriter_State.Handle, Chunk.Buffer, Chunk.Length);
+            if (Error != ESP_OK) {
+                ESP_LOGE(TAG, "esp_ota_write failed: %d!", Error);
+                _OTAWriter_State.Error = Error;
+            } else {
+                _OTAWriter_State.Written += Chunk.Length;
+                OTAWriter_PostProgress();
+            }
+        }
+
+        xQueueSend(_OTAWriter_State.FreeQueue, &Chunk.Buffer, portMAX_DELAY);
+    }
+
+    xSemaphoreGive(_OTAWriter_State.Done);
+
+    vTaskDelete(NULL);
+}
+
+/** @brief Stop the writer task and wait until it has ended.
+ */
+static void OTAWriter_StopTask(void)
+{
+    OTAWriter_Chunk_t Chunk;
+
+    if (_OTAWriter_State.Task == NULL) {
+        return;
+    }
+
+    Chunk.Buffer = NULL;
+    Chunk.Length = 0;
+    xQueueSend(_OTAWriter_State.FullQueue, &Chunk, portMAX_DELAY);
+    xSemaphoreTake(_OTAWriter_State.Done, portMAX_DELAY);
+
+    _OTAWriter_State.Task = NULL;
+}
+
+/** @brief Free the buffers, the queues and the semaphore.
+ */
+static void OTAWriter_Free(void)
+{
+    for (uint8_t i = 0; i < OTA_WRITER_BUFFERS; i++) {
+        if (_OTAWriter_State.Buffers[i] != NULL) {
+            heap_caps_free(_OTAWriter_State.Buffers[i]);
+            _OTAWriter_State.Buffers[i] = NULL;
+        }
+    }
+
+    if (_OTAWriter_State.FreeQueue != NULL) {
+        vQueueDelete(_OTAWriter_State.FreeQueue);
+        _OTAWriter_State.FreeQueue = NULL;
+    }
+
+    if (_OTAWriter_State.FullQueue != NULL) {
+        vQueueDelete(_OTAWriter_State.FullQueue);
+        _OTAWriter_State.FullQueue = NULL;
+    }
+
+    if (_OTAWriter_State.Done != NULL) {
+        vSemaphoreDelete(_OTAWriter_State.Done);
+        _OTAWriter_State.Done = NULL;
+    }
+
+    _OTAWriter_State.isActive = false;
+}
+
+esp_err_t OTAWriter_Begin(size_t Size)
+{
+    esp_err_t Error;
+
+    if (_OTAWriter_State.isActive) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(&_OTAWriter_State, 0, sizeof(_OTAWriter_State));
+
+    _OTAWriter_State.Partition = esp_ota_get_next_update_partition(NULL);
+    if (_OTAWriter_State.Partition == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    } else if ((Size == 0) || (Size > _OTAWriter_State.Partition->size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    _OTAWriter_State.isActive = true;
+    _OTAWriter_State.Size = Size;
+
+    for (uint8_t i = 0; i < OTA_WRITER_BUFFERS; i++) {
+        _OTAWriter_State.Buffers[i] = reinterpret_cast<uint8_t *>(heap_caps_malloc(
+                                          CONFIG_NETWORK_OTA_CHUNK_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+        if (_OTAWriter_State.Buffers[i] == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate OTA buffer!");
+            OTAWriter_Free();
+
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    _OTAWriter_State.FreeQueue = xQueueCreate(OTA_WRITER_BUFFERS, sizeof(uint8_t *));
+    _OTAWriter_State.FullQueue = xQueueCreate(OTA_WRITER_BUFFERS + 1, sizeof(OTAWriter_Chunk_t));
+    _OTAWriter_State.Done = xSemaphoreCreateBinary();
+    if ((_OTAWriter_State.FreeQueue == NULL) || (_OTAWriter_State.FullQueue == NULL) ||
+        (_OTAWriter_State.Done == NULL)) {
+        ESP_LOGE(TAG, "Failed to create OTA queues!");
+        OTAWriter_Free();
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (uint8_t i = 0; i < OTA_WRITER_BUFFERS; i++) {
+        xQueueSend(_OTAWriter_State.FreeQueue, &_OTAWriter_State.Buffers[i], 0);
+    }
+
+    /* Erase each sector right before it is written instead of the whole partition up front */
+    Error = esp_ota_begin(_OTAWriter_State.Partition, OTA_WITH_SEQUENTIAL_WRITES, &_OTAWriter_State.Handle);
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "esp_ota_begin failed: %d!", Error);
+        OTAWriter_Free();
+
+        return Error;
+    }
+
+    if (xTaskCreatePinnedToCore(OTAWriter_Task, "OTA_Writer", CONFIG_NETWORK_OTA_TASK_STACKSIZE, NULL,
+                                CONFIG_NETWORK_OTA_TASK_PRIO, &_OTAWriter_State.Task,
+                                CONFIG_NETWORK_OTA_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create OTA writer task!");
+        _OTAWriter_State.Task = NULL;
+        esp_ota_abort(_OTAWriter_State.Handle);
+        OTAWriter_Free();
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "OTA update started, partition: %s, size: %u bytes", _OTAWriter_State.Partition->label,
+             static_cast<unsigned int>(Size));
+
+    esp_event_post(NETWORK_EVENTS, NETWORK_EVENT_OTA_STARTED, NULL, 0, portMAX_DELAY);
+
+    return ESP_OK;
+}
+
+esp_err_t OTAWriter_GetBuffer(uint8_t **pp_Buffer)
+{
+    if ((_OTAWriter_State.isActive == false) || (pp_Buffer == NULL)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xQueueReceive(_OTAWriter_State.FreeQueue, pp_Buffer, portMAX_DELAY);
+
+    return (_OTAWriter_State.Error == ESP_OK) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t OTAWriter_Submit(uint8_t *p_Buffer, size_t Length)
+{
+    OTAWriter_Chunk_t Chunk;
+
+    if ((_OTAWriter_State.isActive == false) || (p_Buffer == NULL) || (Length > CONFIG_NETWORK_OTA_CHUNK_SIZE)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    Chunk.Buffer = p_Buffer;
+    Chunk.Length = Length;
+    xQueueSend(_OTAWriter_State.FullQueue, &Chunk, portMAX_DELAY);
+
+    return (_OTAWriter_State.Error == ESP_OK) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t OTAWriter_Finish(void)
+{
+    esp_err_t Error;
+
+    if (_OTAWriter_State.isActive == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    OTAWriter_StopTask();
+
+    Error = _OTAWriter_State.Error;
+    if (Error != ESP_OK) {
+        esp_ota_abort(_OTAWriter_State.Handle);
+    } else {
+        /* esp_ota_end releases the handle also on failure */
+        Error = esp_ota_end(_OTAWriter_State.Handle);
+        if (Error != ESP_OK) {
+            ESP_LOGE(TAG, "esp_ota_end failed: %d!", Error);
+        } else {
+            Error = esp_ota_set_boot_partition(_OTAWriter_State.Partition);
+            if (Error != ESP_OK) {
+                ESP_LOGE(TAG, "esp_ota_set_boot_partition failed: %d!", Error);
+            }
+        }
+    }
+
+    OTAWriter_Free();
+
+    if (Error != ESP_OK) {
+        esp_event_post(NETWORK_EVENTS, NETWORK_EVENT_OTA_FAILED, NULL, 0, portMAX_DELAY);
+
+        return Error;
+    }
+
+    ESP_LOGI(TAG, "OTA update written");
+
+    esp_event_post(NETWORK_EVENTS, NETWORK_EVENT_OTA_COMPLETED, NULL, 0, portMAX_DELAY);
+
+    return ESP_OK;
+}
+
+void OTAWriter_Abort(void)
+{
+    if (_OTAWriter_State.isActive == false) {
+        return;
+    }
+
+    OTAWriter_StopTask();
+    esp_ota_abort(_OTAWriter_State.Handle);
+    OTAWriter_Free();
+
+    ESP_LOGW(TAG, "OTA update aborted");
+
+    esp_event_post(NETWORK_EVENTS, NETWORK_EVENT_OTA_FAILED, NULL, 0, portMAX_DELAY);
+}
@@ -0,0 +1,74 @@
+/*
+ * otaWriter.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Double buffered firmware writer for OTA updates.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef OTA_WRITER_H_
+#define OTA_WRITER_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** @brief Number of receive buffers. One buffer is filled while the other one is written to the flash.
+ */
+#define OTA_WRITER_BUFFERS                      2
+
+/** @brief              Start an update. Allocates the buffers, opens the next OTA partition and starts the writer
+ *                      task. The partition is erased sector by sector while the image is written, so the receive does
+ *                      not wait for an erase of the whole partition.
+ *  @param Size         Size of the image in bytes
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_STATE if an update is running
+ *                      ESP_ERR_NOT_FOUND if there is no OTA partition
+ *                      ESP_ERR_INVALID_SIZE if the image does not fit into the partition
+ *                      ESP_ERR_NO_MEM if the buffers or the task can not be created
+ */
+esp_err_t OTAWriter_Begin(size_t Size);
+
+/** @brief              Get an empty buffer of CONFIG_NETWORK_OTA_CHUNK_SIZE bytes. Blocks while both buffers are
+ *                      in use.
+ *  @param pp_Buffer    Pointer to store the buffer
+ *  @return             ESP_OK on success
+ *                      ESP_FAIL if the writer has failed
+ */
+esp_err_t OTAWriter_GetBuffer(uint8_t **pp_Buffer);
+
+/** @brief              Pass a filled buffer to the writer task.
+ *  @param p_Buffer     Buffer from OTAWriter_GetBuffer
+ *  @param Length       Number of valid bytes in the buffer
+ *  @return             ESP_OK on success
+ *                      ESP_FAIL if the writer has failed
+ */
+esp_err_t OTAWriter_Submit(uint8_t *p_Buffer, size_t Length);
+
+/** @brief  Wait for all buffers to be written, validate the image and select it as boot partition.
+ *  @return ESP_OK on success
+ *          Error of the first failed flash write or of the validation otherwise
+ */
+esp_err_t OTAWriter_Finish(void);
+
+/** @brief Abort the update and free all resources.
+ */
+void OTAWriter_Abort(void);
+
+#endif /* OTA_WRITER_H_ */
@@ -0,0 +1,831 @@
+/*
+ * rtpStreamer.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: RTP over UDP output of the thermal stream for unicast and multicast receivers.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_random.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <sdkconfig.h>
+
+#include "rtpStreamer.h"
+#include "../ImageEncoder/imageEncoder.h"
+#include "../Telemetry/telemetry.h"
+#include "../../networkManager.h"
+
+/** @brief Size of the fixed RTP header without CSRCs.
+ */
+#define RTP_STREAMER_HEADER_SIZE            12
+
+/** @brief Size of the RFC 2435 main JPEG header.
+ */
+#define RTP_STREAMER_JPEG_HEADER_SIZE       8
+
+/** @brief Size of the RFC 2435 restart marker header.
+ */
+#define RTP_STREAMER_RESTART_HEADER_SIZE    4
+
+/** @brief Size of the RFC 2435 quantization table header with two 8 bit tables.
+ */
+#define RTP_STREAMER_QTABLE_HEADER_SIZE     (4 + 128)
+
+/** @brief Q value of RFC 2435 for tables that are sent in-band with every frame. The quality of the encoder can
+ *         change at any time, so a receiver never has to guess the tables.
+ */
+#define RTP_STREAMER_JPEG_Q_INBAND          255
+
+/** @brief Retries of a packet when the send buffers of lwIP are full.
+ */
+#define RTP_STREAMER_SEND_RETRIES           3
+
+/** @brief Maximum wait for the stream task to stop in milliseconds.
+ */
+#define RTP_STREAMER_STOP_TIMEOUT_MS        2000
+
+/** @brief JPEG of the encoder, reduced to the parts RFC 2435 sends.
+ */
+typedef struct {
+    uint8_t Type;                               /**< 0 for 4:2:2, 1 for 4:2:0, +64 with restart markers. */
+    uint16_t Width;
+    uint16_t Height;
+    uint16_t RestartInterval;                   /**< MCUs per restart interval, 0 without restart markers. */
+    const uint8_t *Tables[2];                   /**< Luma and chroma quantization table in zigzag order. */
+    const uint8_t *Scan;                        /**< Entropy coded data. */
+    size_t ScanSize;
+} RTPStreamer_JPEG_t;
+
+typedef struct {
+    bool isInitialized;
+    bool isRunning;
+    RTPStreamer_Config_t Config;
+    TaskHandle_t Task;
+    SemaphoreHandle_t Mutex;                    /**< Protects the configuration and the counters. */
+    Network_Thermal_Frame_t *ThermalFrame;
+    int Socket;
+    struct sockaddr_in Destination;
+    uint32_t SSRC;
+    uint16_t SequenceNumber;
+    uint32_t LastSequence;                      /**< Sequence number of the last sent thermal frame. */
+    uint32_t LastFrameTime;                     /**< Time of the last sent frame in ms. */
+    uint32_t PaletteAge;                        /**< Frames since the last palette message. */
+    Server_Palette_t SentPalette;               /**< Palette of the last palette message, PALETTE_COUNT if none. */
+    bool hasWarned;                             /**< The JPEG of the encoder can not be sent with RFC 2435. */
+    RTPStreamer_Status_t Status;
+    uint8_t Packet[CONFIG_NETWORK_RTP_PACKET_SIZE];
+} RTPStreamer_State_t;
+
+static RTPStreamer_State_t _RTPStreamer_State;
+
+static const char *TAG = "rtp_streamer";
+
+/** @brief          Read a big endian 16 bit value.
+ *  @param p_Data   Pointer to the value
+ *  @return         Value
+ */
+static inline uint16_t RTP_Read16(const uint8_t *p_Data)
+{
+    return (static_cast<uint16_t>(p_Data[0]) << 8) | p_Data[1];
+}
+
+/** @brief          Write a big endian 16 bit value.
+ *  @param p_Data   Pointer to the value
+ *  @param Value    Value
+ */
+static inline void RTP_Write16(uint8_t *p_Data, uint16_t Value)
+{
+    p_Data[0] = Value >> 8;
+    p_Data[1] = Value & 0xFF;
+}
+
+/** @brief          Write a big endian 32 bit value.
+ *  @param p_Data   Pointer to the value
+ *  @param Value    Value
+ */
+static inline void RTP_Write32(uint8_t *p_Data, uint32_t Value)
+{
+    p_Data[0] = Value >> 24;
+    p_Data[1] = (Value >> 16) & 0xFF;
+    p_Data[2] = (Value >> 8) & 0xFF;
+    p_Data[3] = Value & 0xFF;
+}
+
+/** @brief          Split a baseline JPEG into the headers of RFC 2435 and the entropy coded data. The Huffman tables
+ *                  are not sent, RFC 2435 uses the tables of the JPEG standard like the encoder.
+ *  @param p_Data   JPEG file
+ *  @param Size     Size of the file in bytes
+ *  @param p_JPEG   Pointer to store the parts
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_SIZE if the file is truncated
+ *                  ESP_ERR_NOT_SUPPORTED if the JPEG can not be described by RFC 2435
+ */
+static esp_err_t RTP_ParseJPEG(const uint8_t *p_Data, size_t Size, RTPStreamer_JPEG_t *p_JPEG)
+{
+    size_t Offset;
+    bool hasFrame = false;
+
+    memset(p_JPEG, 0, sizeof(RTPStreamer_JPEG_t));
+
+    if ((Size < 4) || (p_Data[0] != 0xFF) || (p_Data[1] != 0xD8)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    Offset = 2;
+    while ((Offset + 4) <= Size) {
+        const uint8_t *Segment;
+        uint16_t Length;
+        uint8_t Marker;
+
+        if (p_Data[Offset] != 0xFF) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+
+        Marker = p_Data[Offset + 1];
+
+        /* Fill bytes in front of a marker */
+        if (Marker == 0xFF) {
+            Offset++;
+            continue;
+        }
+
+        Length = RTP_Read16(&p_Data[Offset + 2]);
+        if ((Length < 2) || ((Offset + 2 + Length) > Size)) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+
+        Segment = &p_Data[Offset + 4];
+        Length -= 2;
+
+        switch (Marker) {
+            /* DQT, one or more tables */
+            case 0xDB: {
+                for (uint16_t i = 0; i < Length; i += 65) {
+                    if (((Segment[i] >> 4) != 0) || ((i + 65) > Length)) {
+                        /* 16 bit tables exist for 12 bit JPEGs only */
+                        return ESP_ERR_NOT_SUPPORTED;
+                    }
+
+                    if ((Segment[i] & 0x0F) < 2) {
+                        p_JPEG->Tables[Segment[i] & 0x0F] = &Segment[i + 1];
+                    }
+                }
+
+                break;
+            }
+            /* SOF0, baseline frame */
+            case 0xC0: {
+                if ((Length < 15) || (Segment[0] != 8) || (Segment[5] != 3)) {
+                    return ESP_ERR_NOT_SUPPORTED;
+                }
+
+                p_JPEG->Height = RTP_Read16(&Segment[1]);
+                p_JPEG->Width = RTP_Read16(&Segment[3]);
+
+                /* Y with table 0, Cb and Cr at full MCU size with table 1 */
+                if ((Segment[8] != 0) || (Segment[10] != 0x11) || (Segment[11] != 1) || (Segment[13] != 0x11) ||
+                    (Segment[14] != 1)) {
+                    return ESP_ERR_NOT_SUPPORTED;
+                }
+
+                if (Segment[7] == 0x21) {
+                    p_JPEG->Type = 0;
+                } else if (Segment[7] == 0x22) {
+                    p_JPEG->Type = 1;
+                } else {
+                    return ESP_ERR_NOT_SUPPORTED;
+                }
+
+                hasFrame = true;
+
+                break;
+            }
+            /* DRI */
+            case 0xDD: {
+                if (Length < 2) {
+                    return ESP_ERR_INVALID_SIZE;
+                }
+
+                p_JPEG->RestartInterval = RTP_Read16(Segment);
+
+                break;
+            }
+            /* SOS, the entropy coded data follows up to the EOI */
+            case 0xDA: {
+                if ((hasFrame == false) || (p_JPEG->Tables[0] == NULL) || (p_JPEG->Tables[1] == NULL)) {
+                    return ESP_ERR_NOT_SUPPORTED;
+                }
+
+                Offset += 4 + Length;
+                p_JPEG->Scan = &p_Data[Offset];
+                p_JPEG->ScanSize = Size - Offset;
+
+                /* The receiver adds the EOI itself */
+                if ((p_JPEG->ScanSize >= 2) && (p_Data[Size - 2] == 0xFF) && (p_Data[Size - 1] == 0xD9)) {
+                    p_JPEG->ScanSize -= 2;
+                }
+
+                if (p_JPEG->RestartInterval != 0) {
+                    p_JPEG->Type += 64;
+                }
+
+                /* The size is sent in multiples of 8 pixels with 8 bit */
+                if (((p_JPEG->Width % 8) != 0) || ((p_JPEG->Height % 8) != 0) || (p_JPEG->Width > 2040) ||
+                    (p_JPEG->Height > 2040)) {
+                    return ESP_ERR_NOT_SUPPORTED;
+                }
+
+                return ESP_OK;
+            }
+            /* All other frame types, e.g. progressive or arithmetic */
+            case 0xC1:
+            case 0xC2:
+            case 0xC3:
+            case 0xC5:
+            case 0xC6:
+            case 0xC7:
+            case 0xC9:
+            case 0xCA:
+            case 0xCB:
+            case 0xCD:
+            case 0xCE:
+            case 0xCF: {
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+            default: {
+                break;
+            }
+        }
+
+        Offset += 4 + Length;
+    }
+
+    return ESP_ERR_INVALID_SIZE;
+}
+
+/** @brief              Send one packet with the RTP header. The payload is in the packet buffer after the header.
+ *  @param PayloadType  RTP payload type
+ *  @param Timestamp    RTP timestamp
+ *  @param isLast       true to set the marker bit
+ *  @param Length       Length of the payload
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_NO_MEM if the send buffers stay full
+ *                      ESP_FAIL on socket errors
+ */
+static esp_err_t RTP_SendPacket(uint8_t PayloadType, uint32_t Timestamp, bool isLast, size_t Length)
+{
+    uint8_t *Packet = _RTPStreamer_State.Packet;
+
+    /* Version 2, no padding, no extension, no CSRC */
+    Packet[0] = 0x80;
+    Packet[1] = (isLast ? 0x80 : 0x00) | PayloadType;
+    RTP_Write16(&Packet[2], _RTPStreamer_State.SequenceNumber);
+    RTP_Write32(&Packet[4], Timestamp);
+    RTP_Write32(&Packet[8], _RTPStreamer_State.SSRC);
+
+    Length += RTP_STREAMER_HEADER_SIZE;
+
+    for (uint8_t i = 0; i <= RTP_STREAMER_SEND_RETRIES; i++) {
+        if (sendto(_RTPStreamer_State.Socket, Packet, Length, 0,
+                   reinterpret_cast<const struct sockaddr *>(&_RTPStreamer_State.Destination),
+                   sizeof(_RTPStreamer_State.Destination)) == static_cast<ssize_t>(Length)) {
+            _RTPStreamer_State.SequenceNumber++;
+
+            xSemaphoreTake(_RTPStreamer_State.Mutex, portMAX_DELAY);
+            _RTPStreamer_State.Status.Packets++;
+            _RTPStreamer_State.Status.Bytes += Length;
+            xSemaphoreGive(_RTPStreamer_State.Mutex);
+
+            return ESP_OK;
+        } else if ((errno != ENOMEM) && (errno != ENOBUFS)) {
+            ESP_LOGW(TAG, "Send failed: %d!", errno);
+            return ESP_FAIL;
+        }
+
+        /* The WiFi driver drains the buffers within a few ms */
+        vTaskDelay(1);
+    }
+
+    return ESP_ERR_NO_MEM;
+}
+
+/** @brief              Send a JPEG with the RFC 2435 payload format. The quantization tables are sent in-band with
+ *                      every frame.
+ *  @param p_Image      Encoded JPEG
+ *  @param Timestamp    RTP timestamp
+ *  @return             ESP_OK on success
+ */
+static esp_err_t RTP_SendJPEG(const Network_Encoded_Image_t *p_Image, uint32_t Timestamp)
+{
+    RTPStreamer_JPEG_t JPEG;
+    size_t Offset;
+    esp_err_t Error;
+
+    Error = RTP_ParseJPEG(p_Image->data, p_Image->size, &JPEG);
+    if (Error != ESP_OK) {
+        if (_RTPStreamer_State.hasWarned == false) {
+            ESP_LOGW(TAG, "JPEG %ux%u can not be sent with RFC 2435: %d!", p_Image->width, p_Image->height, Error);
+            _RTPStreamer_State.hasWarned = true;
+        }
+
+        return Error;
+    }
+
+    Offset = 0;
+    do {
+        uint8_t *Payload = &_RTPStreamer_State.Packet[RTP_STREAMER_HEADER_SIZE];
+        size_t Length;
+        size_t Chunk;
+
+        Payload[0] = 0;
+        Payload[1] = (Offset >> 16) & 0xFF;
+        Payload[2] = (Offset >> 8) & 0xFF;
+        Payload[3] = Offset & 0xFF;
+        Payload[4] = JPEG.Type;
+        Payload[5] = RTP_STREAMER_JPEG_Q_INBAND;
+        Payload[6] = JPEG.Width / 8;
+        Payload[7] = JPEG.Height / 8;
+        Length = RTP_STREAMER_JPEG_HEADER_SIZE;
+
+        if (JPEG.RestartInterval != 0) {
+            /* The fragments are not aligned to the restart intervals: F = 1, L = 1, count = 0x3FFF */
+            RTP_Write16(&Payload[Length], JPEG.RestartInterval);
+            RTP_Write16(&Payload[Length + 2], 0xFFFF);
+            Length += RTP_STREAMER_RESTART_HEADER_SIZE;
+        }
+
+        if (Offset == 0) {
+            Payload[Length] = 0;
+            Payload[Length + 1] = 0;
+            RTP_Write16(&Payload[Length + 2], 128);
+            memcpy(&Payload[Length + 4], JPEG.Tables[0], 64);
+            memcpy(&Payload[Length + 4 + 64], JPEG.Tables[1], 64);
+            Length += RTP_STREAMER_QTABLE_HEADER_SIZE;
+        }
+
+        Chunk = sizeof(_RTPStreamer_State.Packet) - RTP_STREAMER_HEADER_SIZE - Length;
+        if (Chunk > (JPEG.ScanSize - Offset)) {
+            Chunk = JPEG.ScanSize - Offset;
+        }
+
+        memcpy(&Payload[Length], &JPEG.Scan[Offset], Chunk);
+        Offset += Chunk;
+
+        Error = RTP_SendPacket(RTP_STREAMER_PAYLOAD_JPEG, Timestamp, Offset >= JPEG.ScanSize, Length + Chunk);
+        if (Error != ESP_OK) {
+            return Error;
+        }
+    } while (Offset < JPEG.ScanSize);
+
+    return ESP_OK;
+}
+
+/** @brief              Send an encoded image with the fragmented dynamic payload type.
+ *  @param p_Image      Encoded image
+ *  @param Timestamp    RTP timestamp
+ *  @return             ESP_OK on success
+ */
+static esp_err_t RTP_SendFragments(const Network_Encoded_Image_t *p_Image, uint32_t Timestamp)
+{
+    const size_t MaxChunk = sizeof(_RTPStreamer_State.Packet) - RTP_STREAMER_HEADER_SIZE -
+                            sizeof(RTPStreamer_Fragment_Header_t);
+    size_t Offset;
+    esp_err_t Error;
+
+    Offset = 0;
+    do {
+        uint8_t *Payload = &_RTPStreamer_State.Packet[RTP_STREAMER_HEADER_SIZE];
+        size_t Chunk;
+
+        Chunk = (p_Image->size - Offset) < MaxChunk ? (p_Image->size - Offset) : MaxChunk;
+
+        RTP_Write32(&Payload[0], Offset);
+        RTP_Write32(&Payload[4], p_Image->size);
+        memcpy(&Payload[sizeof(RTPStreamer_Fragment_Header_t)], &p_Image->data[Offset], Chunk);
+        Offset += Chunk;
+
+        Error = RTP_SendPacket(RTP_STREAMER_PAYLOAD_DYNAMIC, Timestamp, Offset >= p_Image->size,
+                               sizeof(RTPStreamer_Fragment_Header_t) + Chunk);
+        if (Error != ESP_OK) {
+            return Error;
+        }
+    } while (Offset < p_Image->size);
+
+    return ESP_OK;
+}
+
+/** @brief              Send the palette of the indexed format when it changed and every CONFIG_NETWORK_RTP_REFRESH
+ *                      frames, so receivers that join late or lost it can show the frames.
+ *  @param p_Config     Stream configuration
+ *  @param Timestamp    RTP timestamp of the next frame
+ */
+static void RTP_RefreshPalette(const RTPStreamer_Config_t *p_Config, uint32_t Timestamp)
+{
+    Network_Encoded_Image_t Palette;
+
+    if ((_RTPStreamer_State.SentPalette == p_Config->Palette) &&
+        (_RTPStreamer_State.PaletteAge < CONFIG_NETWORK_RTP_REFRESH)) {
+        _RTPStreamer_State.PaletteAge++;
+        return;
+    }
+
+    if (ImageEncoder_EncodePalette(p_Config->Palette, &Palette) != ESP_OK) {
+        return;
+    }
+
+    if (RTP_SendFragments(&Palette, Timestamp) == ESP_OK) {
+        _RTPStreamer_State.SentPalette = p_Config->Palette;
+        _RTPStreamer_State.PaletteAge = 1;
+
+        xSemaphoreTake(_RTPStreamer_State.Mutex, portMAX_DELAY);
+        _RTPStreamer_State.Status.Refreshes++;
+        xSemaphoreGive(_RTPStreamer_State.Mutex);
+    }
+
+    ImageEncoder_Free(&Palette);
+}
+
+/** @brief          Stream task. Encodes every due frame once with the encoder cache and sends it to the
+ *                  destination, independent of the number of receivers.
+ *  @param p_Param  Unused
+ */
+static void RTP_StreamTask(void *p_Param)
+{
+    ESP_LOGD(TAG, "RTP stream task started");
+
+    while (_RTPStreamer_State.isRunning) {
+        RTPStreamer_Config_t Config;
+        Network_Encoded_Image_t Image;
+        Network_Thermal_Frame_t *Frame;
+        uint32_t Timestamp;
+        uint32_t Now;
+        esp_err_t Error;
+
+        /* Wait for the next frame, time out to notice a stopped stream */
+        ulTaskNotifyTake(pdTRUE, 1000 / portTICK_PERIOD_MS);
+
+        xSemaphoreTake(_RTPStreamer_State.Mutex, portMAX_DELAY);
+        Config = _RTPStreamer_State.Config;
+        Frame = _RTPStreamer_State.ThermalFrame;
+        xSemaphoreGive(_RTPStreamer_State.Mutex);
+
+        Now = esp_timer_get_time() / 1000;
+
+        if ((_RTPStreamer_State.isRunning == false) || (Frame == NULL) ||
+            ((Now - _RTPStreamer_State.LastFrameTime) < (1000 / Config.FPS))) {
+            continue;
+        }
+
+        if (xSemaphoreTake(Frame->mutex, 100 / portTICK_PERIOD_MS) != pdTRUE) {
+            continue;
+        }
+
+        if (Frame->sequence == _RTPStreamer_State.LastSequence) {
+            xSemaphoreGive(Frame->mutex);
+            continue;
+        }
+
+        /* Same cache as the WebSocket and HTTP clients, a variant they use is not encoded again */
+        Error = ImageEncoder_EncodeWithQuality(Frame, Config.Format, Config.Palette, Config.Quality, &Image);
+
+        _RTPStreamer_State.LastSequence = Frame->sequence;
+        Timestamp = Frame->timestamp * (RTP_STREAMER_CLOCK_RATE / 1000);
+
+        xSemaphoreGive(Frame->mutex);
+
+        if (Error != ESP_OK) {
+            continue;
+        }
+
+        _RTPStreamer_State.LastFrameTime = Now;
+
+        if (Config.Format == NETWORK_IMAGE_FORMAT_INDEXED) {
+            RTP_RefreshPalette(&Config, Timestamp);
+        }
+
+        if (Config.Format == NETWORK_IMAGE_FORMAT_JPEG) {
+            Error = RTP_SendJPEG(&Image, Timestamp);
+        } else {
+            Error = RTP_SendFragments(&Image, Timestamp);
+        }
+
+        ImageEncoder_Free(&Image);
+
+        xSemaphoreTake(_RTPStreamer_State.Mutex, portMAX_DELAY);
+        if (Error == ESP_OK) {
+            _RTPStreamer_State.Status.Frames++;
+        } else {
+            _RTPStreamer_State.Status.Dropped++;
+        }
+        xSemaphoreGive(_RTPStreamer_State.Mutex);
+
+        if (Error == ESP_OK) {
+            Telemetry_FrameSent();
+        }
+    }
+
+    close(_RTPStreamer_State.Socket);
+    _RTPStreamer_State.Socket = -1;
+
+    ESP_LOGD(TAG, "RTP stream task stopped");
+
+    _RTPStreamer_State.Task = NULL;
+
+    vTaskDelete(NULL);
+}
+
+/** @brief          Open the socket of a stream.
+ *  @param p_Config Stream configuration
+ *  @return         ESP_OK on success
+ */
+static esp_err_t RTP_OpenSocket(const RTPStreamer_Config_t *p_Config)
+{
+    bool isMulticast;
+
+    memset(&_RTPStreamer_State.Destination, 0, sizeof(_RTPStreamer_State.Destination));
+    _RTPStreamer_State.Destination.sin_family = AF_INET;
+    _RTPStreamer_State.Destination.sin_port = htons(p_Config->Port);
+    inet_aton(p_Config->Address, &_RTPStreamer_State.Destination.sin_addr);
+
+    isMulticast = (ntohl(_RTPStreamer_State.Destination.sin_addr.s_addr) >> 28) == 0x0E;
+
+    _RTPStreamer_State.Socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (_RTPStreamer_State.Socket < 0) {
+        ESP_LOGE(TAG, "Failed to create socket: %d!", errno);
+        return ESP_FAIL;
+    }
+
+    if (isMulticast) {
+        uint8_t TTL = p_Config->TTL;
+        uint8_t Loop = 0;
+
+        setsockopt(_RTPStreamer_State.Socket, IPPROTO_IP, IP_MULTICAST_TTL, &TTL, sizeof(TTL));
+        setsockopt(_RTPStreamer_State.Socket, IPPROTO_IP, IP_MULTICAST_LOOP, &Loop, sizeof(Loop));
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t RTPStreamer_Init(void)
+{
+    if (_RTPStreamer_State.isInitialized) {
+        return ESP_OK;
+    }
+
+    _RTPStreamer_State.Mutex = xSemaphoreCreateMutex();
+    if (_RTPStreamer_State.Mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex!");
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* One synchronization source for the whole uptime, a restarted stream stays the same source for receivers */
+    _RTPStreamer_State.SSRC = esp_random();
+    _RTPStreamer_State.SequenceNumber = esp_random() & 0xFFFF;
+    _RTPStreamer_State.Socket = -1;
+    RTPStreamer_GetDefaultConfig(&_RTPStreamer_State.Config);
+    _RTPStreamer_State.isInitialized = true;
+
+    ESP_LOGD(TAG, "RTP streamer initialized");
+
+    return ESP_OK;
+}
+
+void RTPStreamer_Deinit(void)
+{
+    if (_RTPStreamer_State.isInitialized == false) {
+        return;
+    }
+
+    RTPStreamer_Stop();
+
+    vSemaphoreDelete(_RTPStreamer_State.Mutex);
+    _RTPStreamer_State.Mutex = NULL;
+    _RTPStreamer_State.isInitialized = false;
+}
+
+esp_err_t RTPStreamer_Start(const RTPStreamer_Config_t *p_Config)
+{
+    struct in_addr Address;
+    esp_err_t Error;
+
+    if (p_Config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_RTPStreamer_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if ((inet_aton(p_Config->Address, &Address) == 0) || (Address.s_addr == htonl(INADDR_ANY)) ||
+        (p_Config->Port == 0) || (p_Config->FPS < 1) || (p_Config->FPS > 30) ||
+        (p_Config->Format == NETWORK_IMAGE_FORMAT_PALETTE) || (p_Config->Palette >= PALETTE_COUNT) ||
+        (p_Config->Quality > 100)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* A new configuration restarts the stream, the source and the sequence numbers continue */
+    RTPStreamer_Stop();
+
+    /* The old task still owns the socket */
+    if (_RTPStreamer_State.Task != NULL) {
+        ESP_LOGE(TAG, "Stream task did not stop!");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    Error = RTP_OpenSocket(p_Config);
+    if (Error != ESP_OK) {
+        return Error;
+    }
+
+    xSemaphoreTake(_RTPStreamer_State.Mutex, portMAX_DELAY);
+    _RTPStreamer_State.Config = *p_Config;
+    memset(&_RTPStreamer_State.Status, 0, sizeof(_RTPStreamer_State.Status));
+    xSemaphoreGive(_RTPStreamer_State.Mutex);
+
+    _RTPStreamer_State.LastSequence = 0;
+    _RTPStreamer_State.LastFrameTime = 0;
+    _RTPStreamer_State.SentPalette = PALETTE_COUNT;
+    _RTPStreamer_State.PaletteAge = 0;
+    _RTPStreamer_State.hasWarned = false;
+    _RTPStreamer_State.isRunning = true;
+
+    /* Receivers of the delta coded radiometric frames need a keyframe to start with */
+    if (p_Config->Format == NETWORK_IMAGE_FORMAT_RADIOMETRIC) {
+        ImageEncoder_RequestKeyframe();
+    }
+
+    if (xTaskCreatePinnedToCore(RTP_StreamTask, "RTP_Stream", CONFIG_NETWORK_RTP_TASK_STACKSIZE, NULL,
+                                CONFIG_NETWORK_RTP_TASK_PRIO, &_RTPStreamer_State.Task,
+                                CONFIG_NETWORK_RTP_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create stream task!");
+
+        _RTPStreamer_State.isRunning = false;
+        close(_RTPStreamer_State.Socket);
+        _RTPStreamer_State.Socket = -1;
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "RTP stream to %s:%u started", p_Config->Address, p_Config->Port);
+
+    return ESP_OK;
+}
+
+void RTPStreamer_Stop(void)
+{
+    uint32_t Start;
+
+    if (_RTPStreamer_State.Task == NULL) {
+        return;
+    }
+
+    _RTPStreamer_State.isRunning = false;
+    xTaskNotifyGive(_RTPStreamer_State.Task);
+
+    Start = esp_timer_get_time() / 1000;
+    while ((_RTPStreamer_State.Task != NULL) &&
+           (((esp_timer_get_time() / 1000) - Start) < RTP_STREAMER_STOP_TIMEOUT_MS)) {
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+
+    ESP_LOGI(TAG, "RTP stream stopped");
+}
+
+bool RTPStreamer_isRunning(void)
+{
+    return _RTPStreamer_State.isRunning;
+}
+
+esp_err_t RTPStreamer_GetStatus(RTPStreamer_Status_t *p_Status)
+{
+    if (p_Status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_RTPStreamer_State.isInitialized == false) {
+        memset(p_Status, 0, sizeof(RTPStreamer_Status_t));
+        return ESP_OK;
+    }
+
+    xSemaphoreTake(_RTPStreamer_State.Mutex, portMAX_DELAY);
+    *p_Status = _RTPStreamer_State.Status;
+    p_Status->Config = _RTPStreamer_State.Config;
+    xSemaphoreGive(_RTPStreamer_State.Mutex);
+
+    p_Status->isRunning = _RTPStreamer_State.isRunning;
+    p_Status->SSRC = _RTPStreamer_State.SSRC;
+
+    return ESP_OK;
+}
+
+void RTPStreamer_GetDefaultConfig(RTPStreamer_Config_t *p_Config)
+{
+    memset(p_Config, 0, sizeof(RTPStreamer_Config_t));
+    strncpy(p_Config->Address, CONFIG_NETWORK_RTP_ADDRESS, sizeof(p_Config->Address) - 1);
+    p_Config->Port = CONFIG_NETWORK_RTP_PORT;
+    p_Config->TTL = CONFIG_NETWORK_RTP_TTL;
+    p_Config->Format = NETWORK_IMAGE_FORMAT_JPEG;
+    p_Config->Palette = PALETTE_IRON;
+    p_Config->Quality = 0;
+    p_Config->FPS = CONFIG_NETWORK_RTP_FPS;
+}
+
+int RTPStreamer_GetSDP(char *p_Buffer, size_t Size)
+{
+    RTPStreamer_Config_t Config;
+    esp_netif_ip_info_t IP;
+    char Origin[16] = "0.0.0.0";
+    char Connection[24];
+    int Length;
+
+    if ((p_Buffer == NULL) || (_RTPStreamer_State.isRunning == false)) {
+        return -1;
+    }
+
+    xSemaphoreTake(_RTPStreamer_State.Mutex, portMAX_DELAY);
+    Config = _RTPStreamer_State.Config;
+    xSemaphoreGive(_RTPStreamer_State.Mutex);
+
+    if (NetworkManager_GetIP(&IP) == ESP_OK) {
+        snprintf(Origin, sizeof(Origin), IPSTR, IP2STR(&IP.ip));
+    }
+
+    /* Multicast addresses carry the TTL */
+    if ((ntohl(inet_addr(Config.Address)) >> 28) == 0x0E) {
+        snprintf(Connection, sizeof(Connection), "%s/%u", Config.Address, Config.TTL);
+    } else {
+        snprintf(Connection, sizeof(Connection), "%s", Config.Address);
+    }
+
+    Length = snprintf(p_Buffer, Size, "v=0\r\n"
+                      "o=- %u 1 IN IP4 %s\r\n"
+                      "s=PyroVision\r\n"
+                      "c=IN IP4 %s\r\n"
+                      "t=0 0\r\n",
+                      static_cast<unsigned int>(_RTPStreamer_State.SSRC), Origin, Connection);
+
+    if ((Length > 0) && (static_cast<size_t>(Length) < Size)) {
+        if (Config.Format == NETWORK_IMAGE_FORMAT_JPEG) {
+            Length += snprintf(p_Buffer + Length, Size - Length, "m=video %u RTP/AVP %u\r\n"
+                               "a=framerate:%u\r\n", Config.Port, RTP_STREAMER_PAYLOAD_JPEG, Config.FPS);
+        } else {
+            Length += snprintf(p_Buffer + Length, Size - Length, "m=video %u RTP/AVP %u\r\n"
+                               "a=rtpmap:%u X-PYROVISION/%u\r\n"
+                               "a=fmtp:%u format=%s\r\n"
+                               "a=framerate:%u\r\n", Config.Port, RTP_STREAMER_PAYLOAD_DYNAMIC,
+                               RTP_STREAMER_PAYLOAD_DYNAMIC, RTP_STREAMER_CLOCK_RATE, RTP_STREAMER_PAYLOAD_DYNAMIC,
+                               ImageEncoder_GetFormatName(Config.Format), Config.FPS);
+        }
+    }
+
+    if ((Length < 0) || (static_cast<size_t>(Length) >= Size)) {
+        return -1;
+    }
+
+    return Length;
+}
+
+void RTPStreamer_SetThermalFrame(Network_Thermal_Frame_t *p_Frame)
+{
+    if (_RTPStreamer_State.Mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(_RTPStreamer_State.Mutex, portMAX_DELAY);
+    _RTPStreamer_State.ThermalFrame = p_Frame;
+    xSemaphoreGive(_RTPStreamer_State.Mutex);
+}
+
+void RTPStreamer_NotifyFrameReady(void)
+{
+    TaskHandle_t Task = _RTPStreamer_State.Task;
+
+    if (Task != NULL) {
+        xTaskNotifyGive(Task);
+    }
+}
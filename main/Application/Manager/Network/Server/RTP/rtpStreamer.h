@@ -0,0 +1,140 @@
+/*
+ * rtpStreamer.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: RTP over UDP output of the thermal stream for unicast and multicast receivers.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef RTP_STREAMER_H_
+#define RTP_STREAMER_H_
+
+#include <esp_err.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../../networkTypes.h"
+
+/** @brief RTP payload type of JPEG frames (RFC 2435).
+ */
+#define RTP_STREAMER_PAYLOAD_JPEG           26
+
+/** @brief Dynamic RTP payload type of all other formats. The payload starts with RTPStreamer_Fragment_Header_t.
+ */
+#define RTP_STREAMER_PAYLOAD_DYNAMIC        96
+
+/** @brief RTP clock rate of the video payloads in Hz.
+ */
+#define RTP_STREAMER_CLOCK_RATE             90000
+
+/** @brief Fragment header of the dynamic payload type, big endian like the RTP header. Every encoded image (see
+ *         Websocket.md for the formats) is split into fragments and the last fragment has the marker bit set. The
+ *         image starts with its own magic, so a receiver tells the palette messages of the indexed format from the
+ *         frames.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t Offset;                            /**< Offset of the fragment in the image in bytes. */
+    uint32_t Size;                              /**< Size of the whole image in bytes. */
+} RTPStreamer_Fragment_Header_t;
+
+/** @brief Stream configuration.
+ */
+typedef struct {
+    char Address[16];                           /**< Unicast or multicast IPv4 address of the receivers. */
+    uint16_t Port;                              /**< UDP port of the receivers, even by RTP convention. */
+    uint8_t TTL;                                /**< Time to live of multicast packets. */
+    Network_ImageFormat_t Format;               /**< Any format except NETWORK_IMAGE_FORMAT_PALETTE. */
+    Server_Palette_t Palette;
+    uint8_t Quality;                            /**< JPEG quality, 0 for the default quality. */
+    uint8_t FPS;                                /**< Maximum frame rate, 1 to 30. */
+} RTPStreamer_Config_t;
+
+/** @brief Stream status and counters since the start of the stream.
+ */
+typedef struct {
+    bool isRunning;
+    RTPStreamer_Config_t Config;
+    uint32_t SSRC;                              /**< Synchronization source of the stream. */
+    uint32_t Frames;                            /**< Sent frames. */
+    uint32_t Packets;                           /**< Sent packets. */
+    uint64_t Bytes;                             /**< Sent UDP payload bytes. */
+    uint32_t Dropped;                           /**< Frames given up because the send buffers were full. */
+    uint32_t Refreshes;                         /**< Palette messages of the indexed format. */
+} RTPStreamer_Status_t;
+
+/** @brief  Initialize the RTP streamer.
+ *  @return ESP_OK on success
+ *          ESP_ERR_NO_MEM if the mutex can not be created
+ */
+esp_err_t RTPStreamer_Init(void);
+
+/** @brief Deinitialize the RTP streamer. A running stream is stopped.
+ */
+void RTPStreamer_Deinit(void);
+
+/** @brief          Start a stream or change the configuration of the running stream. The cost of the stream does not
+ *                  depend on the number of receivers, every frame is encoded and sent once.
+ *  @param p_Config Stream configuration
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if the configuration is invalid
+ *                  ESP_ERR_INVALID_STATE if the streamer is not initialized or the old stream does not stop
+ *                  ESP_ERR_NO_MEM if the stream task can not be created
+ *                  ESP_FAIL if the socket can not be created
+ */
+esp_err_t RTPStreamer_Start(const RTPStreamer_Config_t *p_Config);
+
+/** @brief Stop the stream.
+ */
+void RTPStreamer_Stop(void);
+
+/** @brief  Check if a stream is running.
+ *  @return true if running
+ */
+bool RTPStreamer_isRunning(void);
+
+/** @brief              Get the status of the stream.
+ *  @param p_Status     Pointer to store the status
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if p_Status is NULL
+ */
+esp_err_t RTPStreamer_GetStatus(RTPStreamer_Status_t *p_Status);
+
+/** @brief          Get the default stream configuration from the Kconfig options.
+ *  @param p_Config Pointer to store the configuration
+ */
+void RTPStreamer_GetDefaultConfig(RTPStreamer_Config_t *p_Config);
+
+/** @brief              Build the session description (RFC 4566) of the running stream, e.g. for VLC or ffplay.
+ *  @param p_Buffer     Output buffer
+ *  @param Size         Size of the output buffer
+ *  @return             Length of the description or -1 if no stream is running or the buffer is too small
+ */
+int RTPStreamer_GetSDP(char *p_Buffer, size_t Size);
+
+/** @brief          Set the thermal frame of the stream.
+ *  @param p_Frame  Pointer to thermal frame data
+ */
+void RTPStreamer_SetThermalFrame(Network_Thermal_Frame_t *p_Frame);
+
+/** @brief Wake up the stream task for a new frame. Never blocks.
+ */
+void RTPStreamer_NotifyFrameReady(void);
+
+#endif /* RTP_STREAMER_H_ */
@@ -0,0 +1,337 @@
+/*
+ * telemetry.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Shared telemetry snapshot for the HTTP and WebSocket server.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_system.h>
+#include <esp_wifi.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "telemetry.h"
+#include "Application/application.h"
+#include "Application/Bus/messageBus.h"
+#include "Application/Manager/SD/sdManager.h"
+#include "Application/Tasks/Lepton/frameLatency.h"
+#include "Application/Tasks/Lepton/leptonTask.h"
+
+typedef struct {
+    bool isInitialized;
+    bool isBuilt;
+    SemaphoreHandle_t Mutex;
+    Network_Thermal_Frame_t *ThermalFrame;
+    Telemetry_Snapshot_t Snapshot;
+    uint32_t BuildTime;                         /**< Time of the last build in ms. */
+    uint32_t SlowTime;                          /**< Time of the last update of the slow sources in ms. */
+    bool hasSDFree;
+    uint32_t SDFree;                            /**< Free space of the SD card in MB. */
+} Telemetry_State_t;
+
+/** @brief Timing of the last WiFi connection. Kept outside of the state, the connection is reported before the
+ *         server and the telemetry are initialized.
+ */
+typedef struct {
+    bool isFastConnect;
+    bool isFramePending;                        /**< No frame was sent since the connection. */
+    uint32_t ConnectTime;                       /**< Connection attempt to IP address in ms. */
+    uint32_t ConnectedAt;                       /**< Time of the connection in ms. */
+    int32_t FirstFrameTime;                     /**< Connection to the first streamed frame in ms, -1 if none. */
+} Telemetry_Connection_t;
+
+static Telemetry_State_t _Telemetry_State;
+
+static Telemetry_Connection_t _Telemetry_Connection = {
+    .isFastConnect = false,
+    .isFramePending = false,
+    .ConnectTime = 0,
+    .ConnectedAt = 0,
+    .FirstFrameTime = -1,
+};
+
+/* The connection is reported from the network task, which must not wait while a snapshot reads the SD card */
+static portMUX_TYPE _Telemetry_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *TAG = "telemetry";
+
+/** @brief          Convert a temperature into the 0.01 degree Celsius of the binary message.
+ *  @param Celsius  Temperature in degree Celsius
+ *  @return         Temperature in 0.01 degree Celsius
+ */
+static int16_t Telemetry_ToCenti(float Celsius)
+{
+    float Value;
+
+    Value = Celsius * 100.0f;
+    if (Value > 32767.0f) {
+        return 32767;
+    } else if (Value < -32768.0f) {
+        return -32768;
+    }
+
+    return static_cast<int16_t>((Value < 0.0f) ? (Value - 0.5f) : (Value + 0.5f));
+}
+
+/** @brief      Read all sources and serialize the snapshot. Call with the mutex taken.
+ *  @param Now  Current time in ms
+ */
+static void Telemetry_Build(uint32_t Now)
+{
+    Telemetry_Packet_t *Packet;
+    App_Lepton_Temperatures_t Temperatures;
+    App_Devices_Battery_t Battery;
+    wifi_ap_record_t APInfo;
+    Telemetry_Connection_t Connection;
+    App_Lepton_Capture_t Capture;
+    bool hasTemperatures;
+    bool hasBattery;
+    int Length;
+
+    Packet = &_Telemetry_State.Snapshot.Packet;
+
+    /* The FPA temperature is read over the CCI and the free space from the FAT, both change slowly */
+    if ((_Telemetry_State.isBuilt == false) || ((Now - _Telemetry_State.SlowTime) >= TELEMETRY_SLOW_INTERVAL_MS)) {
+        uint64_t Total;
+        uint64_t Free;
+
+        Bus_Request(GUI_EVENT_REQUEST_FPA_AUX_TEMP);
+
+        _Telemetry_State.hasSDFree = (SDManager_GetFreeSpace(&Total, &Free) == ESP_OK);
+        _Telemetry_State.SDFree = _Telemetry_State.hasSDFree ? static_cast<uint32_t>(Free / (1024 * 1024)) : 0;
+        _Telemetry_State.SlowTime = Now;
+    }
+
+    /* The sensor temperature and the battery are the latest values on the bus */
+    hasTemperatures = (Bus_Read(BUS_TOPIC_LEPTON_TEMPERATURES, &Temperatures, sizeof(Temperatures), NULL) == ESP_OK);
+    hasBattery = (Bus_Read(BUS_TOPIC_BATTERY, &Battery, sizeof(Battery), NULL) == ESP_OK);
+
+    taskENTER_CRITICAL(&_Telemetry_Lock);
+    Connection = _Telemetry_Connection;
+    taskEXIT_CRITICAL(&_Telemetry_Lock);
+
+    Lepton_Task_GetCapture(&Capture);
+
+    Packet->Magic = TELEMETRY_MAGIC;
+    Packet->Version = TELEMETRY_VERSION;
+    Packet->Counter++;
+    Packet->Timestamp = Now;
+
+    /* Keep the frame statistics of the last snapshot while the frame is locked for a new frame */
+    if ((_Telemetry_State.ThermalFrame != NULL) &&
+        (xSemaphoreTake(_Telemetry_State.ThermalFrame->mutex, 10 / portTICK_PERIOD_MS) == pdTRUE)) {
+        Packet->Sequence = _Telemetry_State.ThermalFrame->sequence;
+        Packet->Min = Telemetry_ToCenti(_Telemetry_State.ThermalFrame->temp_min);
+        Packet->Max = Telemetry_ToCenti(_Telemetry_State.ThermalFrame->temp_max);
+        Packet->Mean = Telemetry_ToCenti(_Telemetry_State.ThermalFrame->temp_avg);
+        xSemaphoreGive(_Telemetry_State.ThermalFrame->mutex);
+
+        Packet->Flags |= TELEMETRY_FLAG_FRAME;
+    }
+
+    if (hasTemperatures) {
+        Packet->FPA = Telemetry_ToCenti(Temperatures.FPA);
+        Packet->AUX = Telemetry_ToCenti(Temperatures.AUX);
+        Packet->Flags |= TELEMETRY_FLAG_SENSOR;
+    }
+
+    if (hasBattery) {
+        Packet->Battery = static_cast<uint16_t>(Battery.Voltage);
+        Packet->BatteryPercent = static_cast<uint8_t>(Battery.Percentage);
+        Packet->Flags |= TELEMETRY_FLAG_BATTERY;
+    }
+
+    if (esp_wifi_sta_get_ap_info(&APInfo) == ESP_OK) {
+        Packet->RSSI = APInfo.rssi;
+        Packet->Flags |= TELEMETRY_FLAG_WIFI;
+    } else {
+        Packet->RSSI = 0;
+        Packet->Flags &= ~TELEMETRY_FLAG_WIFI;
+    }
+
+    if (_Telemetry_State.hasSDFree) {
+        Packet->SDFree = _Telemetry_State.SDFree;
+        Packet->Flags |= TELEMETRY_FLAG_SDCARD;
+    } else {
+        Packet->SDFree = 0;
+        Packet->Flags &= ~TELEMETRY_FLAG_SDCARD;
+    }
+
+    Packet->FreeHeap = esp_get_free_heap_size();
+
+    /* The JSON keeps the keys of the former HTTP and WebSocket responses */
+    Length = snprintf(_Telemetry_State.Snapshot.JSON, sizeof(_Telemetry_State.Snapshot.JSON),
+                      "{\"uptime_s\":%lu,\"flags\":%u,\"sequence\":%lu,"
+                      "\"temp\":%.2f,\"temp_min\":%.2f,\"temp_max\":%.2f,"
+                      "\"sensor_temp_c\":%.2f,\"aux_temp_c\":%.2f,\"supply_voltage_v\":%.3f,\"battery_percent\":%u,"
+                      "\"wifi_rssi_dbm\":%d,\"free_heap\":%lu,\"sdcard\":{\"present\":%s,\"free_mb\":%lu},"
+                      "\"wifi\":{\"connect_ms\":%lu,\"first_frame_ms\":%ld,\"fast\":%s},"
+                      "\"capture\":{\"lost\":%s,\"frames\":%lu,\"timeouts\":%lu,\"resyncs\":%lu,\"sync_ms\":%lu,"
+                      "\"last_resync_ms\":%lu,\"max_resync_ms\":%lu},\"pipeline\":{",
+                      static_cast<unsigned long>(Now / 1000),
+                      Packet->Flags,
+                      static_cast<unsigned long>(Packet->Sequence),
+                      Packet->Mean / 100.0,
+                      Packet->Min / 100.0,
+                      Packet->Max / 100.0,
+                      Packet->FPA / 100.0,
+                      Packet->AUX / 100.0,
+                      Packet->Battery / 1000.0,
+                      Packet->BatteryPercent,
+                      Packet->RSSI,
+                      static_cast<unsigned long>(Packet->FreeHeap),
+                      SDManager_isCardPresent() ? "true" : "false",
+                      static_cast<unsigned long>(Packet->SDFree),
+                      static_cast<unsigned long>(Connection.ConnectTime),
+                      static_cast<long>(Connection.FirstFrameTime),
+                      Connection.isFastConnect ? "true" : "false",
+                      Capture.isLost ? "true" : "false",
+                      static_cast<unsigned long>(Capture.Frames),
+                      static_cast<unsigned long>(Capture.Timeouts),
+                      static_cast<unsigned long>(Capture.Resyncs),
+                      static_cast<unsigned long>(Capture.SyncTime),
+                      static_cast<unsigned long>(Capture.LastResync),
+                      static_cast<unsigned long>(Capture.MaxResync));
+
+    /* Latency of every pipeline stage as [p50, p99, max] in ms and the dropped frames */
+    for (uint8_t i = 0; (i < FRAME_LATENCY_STAGE_COUNT) && (Length > 0) &&
+                        (Length < static_cast<int>(sizeof(_Telemetry_State.Snapshot.JSON))); i++) {
+        FrameLatency_Stats_t Stats;
+
+        FrameLatency_Get(static_cast<FrameLatency_Stage_t>(i), &Stats);
+
+        Length += snprintf(_Telemetry_State.Snapshot.JSON + Length, sizeof(_Telemetry_State.Snapshot.JSON) - Length,
+                           "%s\"%s\":[%.1f,%.1f,%.1f,%lu]", (i > 0) ? "," : "",
+                           FrameLatency_GetStageName(static_cast<FrameLatency_Stage_t>(i)), Stats.P50 / 1000.0,
+                           Stats.P99 / 1000.0, Stats.Max / 1000.0, static_cast<unsigned long>(Stats.Drops));
+    }
+
+    if ((Length > 0) && (Length < static_cast<int>(sizeof(_Telemetry_State.Snapshot.JSON)))) {
+        Length += snprintf(_Telemetry_State.Snapshot.JSON + Length, sizeof(_Telemetry_State.Snapshot.JSON) - Length,
+                           "}}");
+    }
+
+    if ((Length < 0) || (Length >= static_cast<int>(sizeof(_Telemetry_State.Snapshot.JSON)))) {
+        ESP_LOGE(TAG, "Telemetry JSON truncated!");
+
+        Length = snprintf(_Telemetry_State.Snapshot.JSON, sizeof(_Telemetry_State.Snapshot.JSON), "{}");
+    }
+
+    _Telemetry_State.Snapshot.JSONLength = static_cast<size_t>(Length);
+    _Telemetry_State.BuildTime = Now;
+    _Telemetry_State.isBuilt = true;
+}
+
+esp_err_t Telemetry_Init(void)
+{
+    if (_Telemetry_State.isInitialized) {
+        ESP_LOGW(TAG, "Already initialized");
+        return ESP_OK;
+    }
+
+    memset(&_Telemetry_State, 0, sizeof(_Telemetry_State));
+
+    _Telemetry_State.Mutex = xSemaphoreCreateMutex();
+    if (_Telemetry_State.Mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex!");
+        return ESP_ERR_NO_MEM;
+    }
+
+    _Telemetry_State.isInitialized = true;
+
+    return ESP_OK;
+}
+
+void Telemetry_Deinit(void)
+{
+    if (_Telemetry_State.Mutex != NULL) {
+        vSemaphoreDelete(_Telemetry_State.Mutex);
+        _Telemetry_State.Mutex = NULL;
+    }
+
+    _Telemetry_State.isInitialized = false;
+}
+
+void Telemetry_SetConnection(uint32_t ConnectTime, bool isFastConnect)
+{
+    taskENTER_CRITICAL(&_Telemetry_Lock);
+    _Telemetry_Connection.isFastConnect = isFastConnect;
+    _Telemetry_Connection.isFramePending = true;
+    _Telemetry_Connection.ConnectTime = ConnectTime;
+    _Telemetry_Connection.ConnectedAt = esp_timer_get_time() / 1000;
+    _Telemetry_Connection.FirstFrameTime = -1;
+    taskEXIT_CRITICAL(&_Telemetry_Lock);
+}
+
+void Telemetry_FrameSent(void)
+{
+    uint32_t Now;
+
+    /* Called for every frame, so the lock is only taken for the first one */
+    if (_Telemetry_Connection.isFramePending == false) {
+        return;
+    }
+
+    Now = esp_timer_get_time() / 1000;
+
+    taskENTER_CRITICAL(&_Telemetry_Lock);
+    if (_Telemetry_Connection.isFramePending) {
+        _Telemetry_Connection.FirstFrameTime = static_cast<int32_t>(Now - _Telemetry_Connection.ConnectedAt);
+        _Telemetry_Connection.isFramePending = false;
+    }
+    taskEXIT_CRITICAL(&_Telemetry_Lock);
+
+    ESP_LOGI(TAG, "First frame streamed %ld ms after the connection",
+             static_cast<long>(_Telemetry_Connection.FirstFrameTime));
+}
+
+void Telemetry_SetThermalFrame(Network_Thermal_Frame_t *p_Frame)
+{
+    _Telemetry_State.ThermalFrame = p_Frame;
+}
+
+esp_err_t Telemetry_Get(uint32_t MaxAge, Telemetry_Snapshot_t *p_Snapshot)
+{
+    uint32_t Now;
+
+    if (p_Snapshot == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_Telemetry_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(_Telemetry_State.Mutex, portMAX_DELAY);
+
+    Now = esp_timer_get_time() / 1000;
+    if ((_Telemetry_State.isBuilt == false) || ((Now - _Telemetry_State.BuildTime) >= MaxAge)) {
+        Telemetry_Build(Now);
+    }
+
+    memcpy(p_Snapshot, &_Telemetry_State.Snapshot, sizeof(Telemetry_Snapshot_t));
+
+    xSemaphoreGive(_Telemetry_State.Mutex);
+
+    return ESP_OK;
+}
@@ -0,0 +1,126 @@
+/*
+ * telemetry.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Shared telemetry snapshot for the HTTP and WebSocket server.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "../../networkTypes.h"
+
+/** @brief Magic of a binary telemetry message ("PT").
+ */
+#define TELEMETRY_MAGIC                         0x5450
+
+/** @brief Version of the binary telemetry message.
+ */
+#define TELEMETRY_VERSION                       1
+
+/** @brief Flags of the binary telemetry message. A flag is set when the matching fields hold a valid value.
+ */
+#define TELEMETRY_FLAG_FRAME                    (1 << 0)
+#define TELEMETRY_FLAG_SENSOR                   (1 << 1)
+#define TELEMETRY_FLAG_BATTERY                  (1 << 2)
+#define TELEMETRY_FLAG_WIFI                     (1 << 3)
+#define TELEMETRY_FLAG_SDCARD                   (1 << 4)
+
+/** @brief Minimum age of a snapshot in ms before it is built again. All requests within this time share one snapshot.
+ */
+#define TELEMETRY_MAX_AGE_MS                    100
+
+/** @brief Interval in ms of the slow sources (FPA / AUX temperature and SD card free space).
+ */
+#define TELEMETRY_SLOW_INTERVAL_MS              5000
+
+/** @brief Size of the cached JSON object in bytes.
+ */
+#define TELEMETRY_JSON_SIZE                     1024
+
+/** @brief Binary telemetry message (little endian). Temperatures are in 0.01 degree Celsius.
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t Magic;                             /**< TELEMETRY_MAGIC. */
+    uint8_t Version;                            /**< TELEMETRY_VERSION. */
+    uint8_t Flags;                              /**< TELEMETRY_FLAG_* */
+    uint32_t Counter;                           /**< Snapshot counter. */
+    uint32_t Timestamp;                         /**< Time since boot in ms. */
+    uint32_t Sequence;                          /**< Sequence number of the latest thermal frame. */
+    int16_t Min;                                /**< Minimum scene temperature. */
+    int16_t Max;                                /**< Maximum scene temperature. */
+    int16_t Mean;                               /**< Mean scene temperature. */
+    int16_t FPA;                                /**< Focal plane array temperature. */
+    int16_t AUX;                                /**< Auxiliary (housing) temperature. */
+    uint16_t Battery;                           /**< Battery voltage in mV. */
+    uint8_t BatteryPercent;                     /**< Battery charge in percent. */
+    int8_t RSSI;                                /**< WiFi RSSI in dBm. */
+    uint32_t SDFree;                            /**< Free space of the SD card in MB. */
+    uint32_t FreeHeap;                          /**< Free heap in bytes. */
+} Telemetry_Packet_t;
+
+/** @brief Telemetry snapshot, serialized once for all clients.
+ */
+typedef struct {
+    Telemetry_Packet_t Packet;                  /**< Binary message. */
+    char JSON[TELEMETRY_JSON_SIZE];             /**< JSON object with the same values. */
+    size_t JSONLength;                          /**< Length of JSON without the terminating zero. */
+} Telemetry_Snapshot_t;
+
+/** @brief  Initialize the telemetry snapshot and subscribe to the sensor and battery events.
+ *  @return ESP_OK on success
+ */
+esp_err_t Telemetry_Init(void);
+
+/** @brief Deinitialize the telemetry snapshot.
+ */
+void Telemetry_Deinit(void);
+
+/** @brief          Set the thermal frame used for the frame statistics.
+ *  @param p_Frame  Pointer to thermal frame data
+ */
+void Telemetry_SetThermalFrame(Network_Thermal_Frame_t *p_Frame);
+
+/** @brief                  Report a new WiFi connection. Can be called before Telemetry_Init, the time to the first
+ *                          streamed frame is measured from this call.
+ *  @param ConnectTime      Time from the start of the connection attempt to the IP address in ms
+ *  @param isFastConnect    true if the access point of the last connection was used without a scan
+ */
+void Telemetry_SetConnection(uint32_t ConnectTime, bool isFastConnect);
+
+/** @brief Report a frame that was sent to a network client. Only the first frame after a connection is used.
+ */
+void Telemetry_FrameSent(void);
+
+/** @brief              Get the current snapshot. The snapshot is built again when it is older than MaxAge.
+ *  @param MaxAge       Maximum age of the snapshot in ms
+ *  @param p_Snapshot   Pointer to store a copy of the snapshot
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if p_Snapshot is NULL
+ *                      ESP_ERR_INVALID_STATE if the module is not initialized
+ */
+esp_err_t Telemetry_Get(uint32_t MaxAge, Telemetry_Snapshot_t *p_Snapshot);
+
+#endif /* TELEMETRY_H_ */
@@ -29,73 +29,127 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <math.h>
 
 #include "visaCommands.h"
+#include "../../ImageEncoder/imageEncoder.h"
+#include "Application/Boot/boot.h"
+#include "Application/Trace/trace.h"
+#include "Application/Memory/memoryPlan.h"
+#include "Application/Topology/topology.h"
+#include "Application/Manager/Settings/settingsManager.h"
+#include "Application/Manager/Devices/devicesManager.h"
+#include "Application/Tasks/Lepton/frameRecorder.h"
+#include "Application/Tasks/Lepton/frameProducts.h"
+#include "Application/Tasks/Lepton/frameLatency.h"
+#include "Application/Tasks/Lepton/frameReplay.h"
+#include "Application/Tasks/Lepton/frameDenoise.h"
+#include "Application/Tasks/Lepton/frameAGC.h"
+#include "Application/Tasks/Lepton/isotherm.h"
+#include "Application/Manager/SD/sdManager.h"
+#include "Application/Manager/SD/sdRecorder.h"
+#include "Application/Manager/SD/sdSnapshot.h"
+#include "Application/Manager/SD/sdTimeLapse.h"
+#include "Application/Manager/Flash/flashLog.h"
+#include "Application/Tasks/Lepton/leptonTask.h"
+#include "Application/Tasks/GUI/guiTask.h"
+#include "../../Metrics/metrics.h"
 
 #include "sdkconfig.h"
 
-/** @brief Error queue */
-#define ERROR_QUEUE_SIZE        10
+/** @brief Maximum length of a program message */
+#define VISA_MAX_MESSAGE_LENGTH             256
 
-static int _error_queue[ERROR_QUEUE_SIZE];
-static size_t _error_count = 0;
+/** @brief Maximum number of parameters of a single command */
+#define VISA_MAX_PARAMETERS                 8
 
-/** @brief Operation complete flag */
-static bool _operation_complete = true;
+/** @brief Maximum length of a complete header including the path of a compound command */
+#define VISA_MAX_HEADER_LENGTH              64
 
-static const char *TAG = "VISA-Commands";
+/** @brief FNV-1a parameters of the header hash */
+#define VISA_HASH_OFFSET                    2166136261u
+#define VISA_HASH_PRIME                     16777619u
 
-/** @brief          Push error to queue
- *  @param Error    Error code
+/** @brief Parameters and response buffer of a single command.
  */
-static void VISA_PushError(int Error)
-{
-    if (_error_count < ERROR_QUEUE_SIZE) {
-        _error_queue[_error_count++] = Error;
-    }
-}
+typedef struct {
+    char *Params[VISA_MAX_PARAMETERS];      /**< Parameters of the command */
+    int Count;                              /**< Number of parameters */
+    char *Response;                         /**< Response buffer */
+    size_t MaxLen;                          /**< Maximum response length */
+    VISACommands_Block_t *p_Block;          /**< Binary block of the response */
+    int Suffix;                             /**< Numeric suffix of the header, 1 if omitted */
+} VISA_Request_t;
+
+/** @brief Command handler.
+ */
+typedef int (*VISA_Handler_t)(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request);
 
-/** @brief          Check if string is a query (ends with ?)
- *  @param Command  Command string
- *  @return         true if query, false otherwise
+/** @brief Declaration of a command.
+ *         The header uses the SCPI notation. The upper case part of a mnemonic is the short form, the whole mnemonic
+ *         is the long form. '|' separates alternative mnemonics and a trailing '#' allows a numeric suffix
+ *         (e.g. ROI3), which defaults to 1 when it is omitted.
  */
-static bool VISA_IsQuery(const char *Command)
-{
-    size_t len = strlen(Command);
-    return ((len > 0) && (Command[len - 1] == '?'));
-}
+typedef struct {
+    const char *Header;                     /**< Header without the query mark */
+    VISA_Handler_t Set;                     /**< Handler of the command, NULL if there is no command form */
+    VISA_Handler_t Query;                   /**< Handler of the query, NULL if there is no query form */
+} VISA_Command_t;
 
-/** @brief          Parse command into tokens
- *  @param Command  Command string
- *  @param Tokens   Array to store tokens
- *  @param MaxTokens Maximum number of tokens
- *  @return         Number of tokens parsed
+/** @brief Entry of the dispatch table. Maps the hash of an accepted header to the command.
  */
-static int VISA_ParseCommand(char *Command, char **Tokens, int MaxTokens)
-{
-    int count = 0;
-    char *token = strtok(Command, " \t:");
+typedef struct {
+    uint32_t Hash;                          /**< Hash of the upper case header */
+    uint8_t Command;                        /**< Index in the command list */
+} VISA_Dispatch_Entry_t;
 
-    while ((token != NULL) && (count < MaxTokens)) {
-        Tokens[count++] = token;
-        token = strtok(NULL, " \t:");
-    }
+/** @brief Dispatch table, sorted by hash.
+ */
+template <size_t N> struct VISA_Dispatch_Table_t {
+    VISA_Dispatch_Entry_t Entries[N];       /**< Entries, sorted by hash */
+};
+
+/** @brief Names of the image formats, indexed by VISACommands_Image_Format_t */
+static const char *_image_format_names[] = {"RAW", "RGB", "JPEG"};
+
+/** @brief Names of the palettes, indexed by Server_Palette_t */
+static const char *_image_palette_names[] = {"IRON", "GRAY", "RAINBOW", "CUSTOM"};
+
+#ifdef CONFIG_GUI_THERMAL_RAW_LUT
+/** @brief Names of the AGC modes of the display, indexed by FrameAGC_Mode_t */
+static const char *_display_agc_names[] = {"LINEAR", "CLIP", "HEQ", "LOCAL"};
+#endif
+
+#ifdef CONFIG_LEPTON_DENOISE
+/** @brief Names of the noise reduction strengths, indexed by FrameDenoise_Strength_t */
+static const char *_image_denoise_names[] = {"OFF", "LOW", "MEDIUM", "HIGH"};
+#endif
+
+static const char *TAG = "VISA-Commands";
 
-    return count;
+/** @brief           Push error to the queue of a session
+ *  @param p_Session Session
+ *  @param Error     Error code
+ */
+static void VISA_PushError(VISACommands_Session_t *p_Session, int Error)
+{
+    if (p_Session->ErrorCount < VISA_ERROR_QUEUE_SIZE) {
+        p_Session->Errors[p_Session->ErrorCount++] = Error;
+    }
 }
 
 /* ===== IEEE 488.2 Common Commands ===== */
 
-/** @brief          *IDN? - Identification query
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length
+/** @brief           *IDN? - Identification query
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
  */
-static int VISA_CMD_IDN(char *Response, size_t MaxLen)
+static int VISA_CMD_IDN(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
     return 0;
     /*
-    return snprintf(Response, MaxLen, "%s,%s,%s,%u.%u.%u\n",
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%s,%s,%s,%u.%u.%u\n",
                     CONFIG_NETWORK_VISA_DEVICE_MANUFACTURER,
                     CONFIG_NETWORK_VISA_DEVICE_MODEL,
                     CONFIG_NETWORK_VISA_DEVICE_SERIAL,
@@ -103,50 +157,61 @@ static int VISA_CMD_IDN(char *Response, size_t MaxLen)
     */
 }
 
-/** @brief          *RST - Reset device
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length
+/** @brief           *RST - Reset device
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
  */
-static int VISA_CMD_RST(char *Response, size_t MaxLen)
+static int VISA_CMD_RST(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
     ESP_LOGI(TAG, "Device reset requested");
 
     /* TODO: Implement actual reset logic */
     // Reset managers to default state
 
-    _operation_complete = true;
+    p_Session->ImageFormat = VISA_COMMANDS_IMAGE_FORMAT_RAW;
+    p_Session->ImagePalette = PALETTE_IRON;
+    FramePool_Release(p_Session->CapturedFrame);
+    p_Session->CapturedFrame = NULL;
+
+    p_Session->OperationComplete = true;
     return 0; /* No response for command */
 }
 
-/** @brief          *CLS - Clear status
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length
+/** @brief           *CLS - Clear status
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
  */
-static int VISA_CMD_CLS(char *Response, size_t MaxLen)
+static int VISA_CMD_CLS(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
-    VISACommands_ClearErrors();
-    _operation_complete = true;
+    VISACommands_ClearErrors(p_Session);
+    p_Session->OperationComplete = true;
     return 0; /* No response */
 }
 
-/** @brief          *OPC? - Operation complete query
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length
+/** @brief           *OPC? - Operation complete query
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
  */
-static int VISA_CMD_OPC(char *Response, size_t MaxLen)
+static int VISA_CMD_OPC(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
-    return snprintf(Response, MaxLen, "%d\n", _operation_complete ? 1 : 0);
+    /* A burst is recorded by the Lepton task, so its completion is polled here */
+    if (p_Session->isBurstPending && (FrameRecorder_GetStatus(NULL, NULL) == false)) {
+        p_Session->isBurstPending = false;
+        p_Session->OperationComplete = true;
+    }
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%d\n", p_Session->OperationComplete ? 1 : 0);
 }
 
-/** @brief          *TST? - Self-test query
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length
+/** @brief           *TST? - Self-test query
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
  */
-static int VISA_CMD_TST(char *Response, size_t MaxLen)
+static int VISA_CMD_TST(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
     /* Perform basic self-test */
     /* 0 = pass, non-zero = fail */
@@ -157,359 +222,2548 @@ static int VISA_CMD_TST(char *Response, size_t MaxLen)
     // Check display
     // Check memory
 
-    return snprintf(Response, MaxLen, "%d\n", result);
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%d\n", result);
 }
 
-/** @brief          SYSTem:ERRor? - Get error from queue
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length
+/** @brief           SYSTem:ERRor? - Get error from queue
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
  */
-static int VISA_CMD_SYST_ERR(char *Response, size_t MaxLen)
+static int VISA_CMD_SYST_ERR(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
-    int error = VISACommands_GetError();
+    int error = VISACommands_GetError(p_Session);
 
     if (error == SCPI_ERROR_NO_ERROR) {
-        return snprintf(Response, MaxLen, "0,\"No error\"\n");
+        return snprintf(p_Request->Response, p_Request->MaxLen, "0,\"No error\"\n");
     } else {
-        return snprintf(Response, MaxLen, "%d,\"Error %d\"\n", error, error);
+        return snprintf(p_Request->Response, p_Request->MaxLen, "%d,\"Error %d\"\n", error, error);
+    }
+}
+
+/** @brief           SYSTem:VERSion? - Get SCPI version
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SYST_VERS(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    return snprintf(p_Request->Response, p_Request->MaxLen, "1999.0\n"); /* SCPI-99 */
+}
+
+/** @brief           SYSTem:BOOT? - Get the boot phase times
+ *                   Returns the time of every Boot_Phase_t after the start of the application in ms, -1 for
+ *                   phases that were not reached yet.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SYST_BOOT(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    int Length = 0;
+
+    for (uint8_t i = 0; i < BOOT_PHASE_COUNT; i++) {
+        int64_t Time;
+
+        Time = Boot_GetTime(static_cast<Boot_Phase_t>(i));
+
+        Length += snprintf(p_Request->Response + Length, p_Request->MaxLen - Length, "%s%ld", (i > 0) ? "," : "",
+                           (Time < 0) ? -1L : static_cast<long>(Time / 1000));
+        if (Length >= static_cast<int>(p_Request->MaxLen)) {
+            return p_Request->MaxLen - 1;
+        }
+    }
+
+    return Length + snprintf(p_Request->Response + Length, p_Request->MaxLen - Length, "\n");
+}
+
+/** @brief           SYSTem:MEMory? - Get the usage of the memory plan
+ *                   Returns <arena size>,<arena used> in bytes, followed by <bytes>,<peak>,<buffers>,<fallbacks> for
+ *                   every MemoryPlan_Region_t (fast, dma, frame, bulk).
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SYST_MEM(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    MemoryPlan_Status_t Status;
+    int Length;
+
+    MemoryPlan_GetStatus(&Status);
+
+    Length = snprintf(p_Request->Response, p_Request->MaxLen, "%lu,%lu", static_cast<unsigned long>(Status.ArenaSize),
+                      static_cast<unsigned long>(Status.ArenaUsed));
+
+    for (uint8_t i = 0; i < MEMORY_REGION_COUNT; i++) {
+        if (Length >= static_cast<int>(p_Request->MaxLen)) {
+            return p_Request->MaxLen - 1;
+        }
+
+        Length += snprintf(p_Request->Response + Length, p_Request->MaxLen - Length, ",%lu,%lu,%lu,%lu",
+                           static_cast<unsigned long>(Status.Regions[i].Bytes),
+                           static_cast<unsigned long>(Status.Regions[i].Peak),
+                           static_cast<unsigned long>(Status.Regions[i].Count),
+                           static_cast<unsigned long>(Status.Regions[i].Fallbacks));
+    }
+
+    if (Length >= static_cast<int>(p_Request->MaxLen)) {
+        return p_Request->MaxLen - 1;
+    }
+
+    return Length + snprintf(p_Request->Response + Length, p_Request->MaxLen - Length, "\n");
+}
+
+/** @brief           SYSTem:LATency? - Get the frame latency of the pipeline stages
+ *                   Returns p50,p99,max in us and the dropped frames for every FrameLatency_Stage_t (publish,
+ *                   colorize, scale, display, encode, send), measured from the VoSPI frame.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SYST_LAT(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    int Length = 0;
+
+    for (uint8_t i = 0; i < FRAME_LATENCY_STAGE_COUNT; i++) {
+        FrameLatency_Stats_t Stats;
+
+        FrameLatency_Get(static_cast<FrameLatency_Stage_t>(i), &Stats);
+
+        Length += snprintf(p_Request->Response + Length, p_Request->MaxLen - Length, "%s%lu,%lu,%lu,%lu",
+                           (i > 0) ? "," : "", static_cast<unsigned long>(Stats.P50),
+                           static_cast<unsigned long>(Stats.P99), static_cast<unsigned long>(Stats.Max),
+                           static_cast<unsigned long>(Stats.Drops));
+        if (Length >= static_cast<int>(p_Request->MaxLen)) {
+            return p_Request->MaxLen - 1;
+        }
+    }
+
+    return Length + snprintf(p_Request->Response + Length, p_Request->MaxLen - Length, "\n");
+}
+
+/** @brief           SYSTem:LATency:RESet - Clear the latency histograms and drop counters
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SYST_LAT_RES(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    FrameLatency_Reset();
+
+    return 0; /* No response for command */
+}
+
+#ifdef CONFIG_NETWORK_METRICS
+/** @brief           SYSTem:PERFormance? - Get the runtime metrics
+ *                   Returns free,largest block,minimum free of the internal heap and the PSRAM in bytes, the event
+ *                   loop lag in us and the full event queue count, followed by name,CPU share in 0.1 %,free stack
+ *                   in bytes for every task that fits into the response.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SYST_PERF(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    Metrics_Snapshot_t *Snapshot;
+    int Length;
+
+    Snapshot = reinterpret_cast<Metrics_Snapshot_t *>(malloc(sizeof(Metrics_Snapshot_t)));
+    if ((Snapshot == NULL) || (Metrics_Get(Snapshot) != ESP_OK)) {
+        free(Snapshot);
+
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
+
+    Length = snprintf(p_Request->Response, p_Request->MaxLen, "%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu",
+                      static_cast<unsigned long>(Snapshot->Heaps[METRICS_HEAP_INTERNAL].Free),
+                      static_cast<unsigned long>(Snapshot->Heaps[METRICS_HEAP_INTERNAL].Largest),
+                      static_cast<unsigned long>(Snapshot->Heaps[METRICS_HEAP_INTERNAL].Minimum),
+                      static_cast<unsigned long>(Snapshot->Heaps[METRICS_HEAP_PSRAM].Free),
+                      static_cast<unsigned long>(Snapshot->Heaps[METRICS_HEAP_PSRAM].Largest),
+                      static_cast<unsigned long>(Snapshot->Heaps[METRICS_HEAP_PSRAM].Minimum),
+                      static_cast<unsigned long>(Snapshot->EventLag), static_cast<unsigned long>(Snapshot->EventFull));
+
+    /* Only complete tasks, the line terminator needs 2 bytes */
+    for (uint16_t i = 0; i < Snapshot->TaskCount; i++) {
+        int Entry;
+
+        Entry = snprintf(p_Request->Response + Length, p_Request->MaxLen - Length, ",%s,%u,%lu",
+                         Snapshot->Tasks[i].Name, Snapshot->Tasks[i].CPU,
+                         static_cast<unsigned long>(Snapshot->Tasks[i].StackFree));
+        if ((Length + Entry + 2) > static_cast<int>(p_Request->MaxLen)) {
+            break;
+        }
+
+        Length += Entry;
+    }
+
+    free(Snapshot);
+
+    return Length + snprintf(p_Request->Response + Length, p_Request->MaxLen - Length, "\n");
+}
+
+/** @brief           SYSTem:CPU? - Get the load of the cores
+ *                   Returns the load of every core in 0.1 % since the previous metrics snapshot of any client.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SYST_CPU(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    Metrics_Snapshot_t *Snapshot;
+    int Length = 0;
+
+    Snapshot = reinterpret_cast<Metrics_Snapshot_t *>(malloc(sizeof(Metrics_Snapshot_t)));
+    if ((Snapshot == NULL) || (Metrics_Get(Snapshot) != ESP_OK)) {
+        free(Snapshot);
+
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
+
+    for (uint8_t i = 0; i < portNUM_PROCESSORS; i++) {
+        Length += snprintf(p_Request->Response + Length, p_Request->MaxLen - Length, "%s%u", (i > 0) ? "," : "",
+                           Snapshot->CoreLoad[i]);
+    }
+
+    free(Snapshot);
+
+    return Length + snprintf(p_Request->Response + Length, p_Request->MaxLen - Length, "\n");
+}
+#endif
+
+/** @brief          Parse a value of a task layout.
+ *  @param p_Value  Value or DEFault to keep the Kconfig default
+ *  @param Min      Minimum of the value
+ *  @param Max      Maximum of the value
+ *  @param p_Result Pointer to store the value, SETTINGS_TASK_DEFAULT for DEFault
+ *  @param p_isSet  Pointer to store if the value is not DEFault
+ *  @return         true on success
+ */
+static bool VISA_ParseTaskValue(const char *p_Value, long Min, long Max, long *p_Result, bool *p_isSet)
+{
+    char *end;
+
+    if ((strcasecmp(p_Value, "DEF") == 0) || (strcasecmp(p_Value, "DEFault") == 0)) {
+        *p_Result = SETTINGS_TASK_DEFAULT;
+        *p_isSet = false;
+
+        return true;
+    }
+
+    *p_Result = strtol(p_Value, &end, 10);
+    *p_isSet = true;
+
+    return (end != p_Value) && (*end == '\0') && (*p_Result >= Min) && (*p_Result <= Max);
+}
+
+/** @brief           SYSTem:TASK<n> - Set the layout of a task of the topology
+ *                   Accepts <core>,<priority>,<stack size> with core -1 for no core, or DEFault for the whole layout.
+ *                   Every value can be DEFault to keep the Kconfig default, omitted values are DEFault. n is the
+ *                   Topology_Task_t + 1 (1 Lepton, 2 GUI, 3 network, 4 devices, 5 WebSocket broadcast, 6 WebSocket
+ *                   encoder, 7 VISA, 8 DNS). The layout is stored in the settings and used when the task is
+ *                   created next, i.e. after a restart for most tasks.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SYST_TASK(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    App_Settings_Tasks_t Tasks;
+    App_Settings_Task_t *p_Task;
+    long Values[3] = {SETTINGS_TASK_DEFAULT, SETTINGS_TASK_DEFAULT, SETTINGS_TASK_DEFAULT};
+    static const long Min[3] = {-1, 1, 2048};
+    static const long Max[3] = {portNUM_PROCESSORS - 1, configMAX_PRIORITIES - 1, UINT16_MAX};
+
+    if (p_Request->Count < 1) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
+        return SCPI_ERROR_MISSING_PARAMETER;
+    }
+
+    if ((p_Request->Suffix < 1) || (p_Request->Suffix > TOPOLOGY_TASK_COUNT) || (p_Request->Count > 3) ||
+        (SettingsManager_GetTasks(&Tasks) != ESP_OK)) {
+        VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+        return SCPI_ERROR_DATA_OUT_OF_RANGE;
+    }
+
+    p_Task = &Tasks.Task[p_Request->Suffix - 1];
+
+    for (uint8_t i = 0; i < p_Request->Count; i++) {
+        bool isSet;
+
+        if (VISA_ParseTaskValue(p_Request->Params[i], Min[i], Max[i], &Values[i], &isSet) == false) {
+            VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+            return SCPI_ERROR_DATA_OUT_OF_RANGE;
+        }
+
+        /* The stored core is core + 1, so 0 is free for the default */
+        if ((i == 0) && isSet) {
+            Values[0] = (Values[0] < 0) ? SETTINGS_TASK_CORE_ANY : (Values[0] + 1);
+        }
+    }
+
+    p_Task->Core = static_cast<uint8_t>(Values[0]);
+    p_Task->Priority = static_cast<uint8_t>(Values[1]);
+    p_Task->StackSize = static_cast<uint16_t>(Values[2]);
+
+    if (SettingsManager_UpdateTasks(&Tasks) != ESP_OK) {
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
+
+    ESP_LOGI(TAG, "Layout of %s set to %u,%u,%u", Topology_GetName(static_cast<Topology_Task_t>(p_Request->Suffix - 1)),
+             p_Task->Core, p_Task->Priority, p_Task->StackSize);
+
+    return 0; /* Success */
+}
+
+/** @brief           SYSTem:TASK<n>? - Get the layout of a task of the topology
+ *                   Returns <name>,<core>,<priority>,<stack size>,<settings> with core -1 for no core and settings 1
+ *                   if a value comes from the settings. This is the layout the task gets when it is created next.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SYST_TASK_Query(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    Topology_Layout_t Layout;
+
+    if ((p_Request->Suffix < 1) ||
+        (Topology_GetLayout(static_cast<Topology_Task_t>(p_Request->Suffix - 1), &Layout) != ESP_OK)) {
+        VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+        return SCPI_ERROR_DATA_OUT_OF_RANGE;
+    }
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%s,%d,%u,%lu,%d\n", Layout.Name,
+                    (Layout.Core == tskNO_AFFINITY) ? -1 : static_cast<int>(Layout.Core),
+                    static_cast<unsigned int>(Layout.Priority), static_cast<unsigned long>(Layout.StackSize),
+                    Layout.isOverridden ? 1 : 0);
+}
+
+#ifdef CONFIG_TRACE
+/** @brief           SYSTem:TRACe:TRIGger - Copy the event trace ring for the download with GET /api/v1/trace
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SYST_TRAC_TRIG(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    if (Trace_Trigger() != ESP_OK) {
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
     }
+
+    return 0; /* No response for command */
 }
 
-/** @brief          SYSTem:VERSion? - Get SCPI version
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length
+/** @brief           SYSTem:TRACe:COUNt? - Get the number of records of the last trigger
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
  */
-static int VISA_CMD_SYST_VERS(char *Response, size_t MaxLen)
+static int VISA_CMD_SYST_TRAC_COUN(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
-    return snprintf(Response, MaxLen, "1999.0\n"); /* SCPI-99 */
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%lu\n", static_cast<unsigned long>(Trace_GetCount()));
 }
+#endif
 
 /* ===== Device-Specific Commands ===== */
 
-/** @brief          SENSe:TEMPerature? - Get sensor temperature
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length
+/** @brief           SENSe:TEMPerature? - Get sensor temperature
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
  */
-static int VISA_CMD_SENS_TEMP(char *Response, size_t MaxLen)
+static int VISA_CMD_SENS_TEMP(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
     /* TODO: Get actual temperature from Lepton manager */
     float temperature = 25.5f; /* Placeholder */
 
-    return snprintf(Response, MaxLen, "%.2f\n", temperature);
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%.2f\n", temperature);
 }
 
-/** @brief          SENSe:IMAGE:CAPTure - Capture image
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length
+/** @brief           SENSe:IMAGE:CAPTure - Capture image
+ *                   Holds a reference on the latest frame of the frame pool until the next capture, so every
+ *                   following SENSe:IMAGe:DATA? returns the same frame.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
  */
-static int VISA_CMD_SENS_IMG_CAPT(char *Response, size_t MaxLen)
+static int VISA_CMD_SENS_IMG_CAPT(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
-    /* TODO: Trigger image capture */
-    ESP_LOGI(TAG, "Image capture triggered");
+    FramePool_Frame_t *Frame;
+
+    Frame = FramePool_GetLatest();
+    if (Frame == NULL) {
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
 
-    _operation_complete = false;
-    /* Capture happens asynchronously */
-    /* Set _operation_complete = true when done */
+    FramePool_Release(p_Session->CapturedFrame);
+    p_Session->CapturedFrame = Frame;
+
+    ESP_LOGD(TAG, "Image captured, sequence %lu", p_Session->CapturedFrame->Sequence);
+
+    /* The frame is already in the pool, so the capture is complete immediately */
+    p_Session->OperationComplete = true;
 
     return 0; /* No immediate response */
 }
 
-/** @brief          SENSe:IMAGE:DATA? - Get captured image data
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length or negative for binary data
+/** @brief           SENSe:IMAGE:DATA? - Get captured image data
+ *                   The response is an IEEE 488.2 definite length block (#<n><length><data>). Only the block header
+ *                   is written to the response, the data is sent straight from the frame pool or the encoder buffer.
+ *                   Without a previous capture the latest frame is used.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
  */
-static int VISA_CMD_SENS_IMG_DATA(char *Response, size_t MaxLen)
+static int VISA_CMD_SENS_IMG_DATA(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
-    /* TODO: Get actual image data */
-    /* This should return binary data in IEEE 488.2 format */
-    /* Format: #<n><length><data> where n = digits in length */
-
-    /* Example with dummy data */
-    uint8_t *image_data = (uint8_t *)heap_caps_malloc(1024, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    if (image_data == NULL) {
-        VISA_PushError(SCPI_ERROR_OUT_OF_MEMORY);
-        return SCPI_ERROR_OUT_OF_MEMORY;
+    FramePool_Frame_t *Frame;
+    VISACommands_Block_t *p_Block = p_Request->p_Block;
+    char length[16];
+    int digits;
+
+    Frame = (p_Session->CapturedFrame != NULL) ? FramePool_Retain(p_Session->CapturedFrame) : FramePool_GetLatest();
+    if (Frame == NULL) {
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
     }
 
-    size_t image_size = 1024; /* Placeholder */
-    memset(image_data, 0xAA, image_size); /* Dummy data */
+    switch (p_Session->ImageFormat) {
+        case VISA_COMMANDS_IMAGE_FORMAT_RAW: {
+            if (Frame->hasRAW == false) {
+                FramePool_Release(Frame);
+                VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+                return SCPI_ERROR_EXECUTION_ERROR;
+            }
+
+            p_Block->Data = reinterpret_cast<const uint8_t *>(Frame->RAW);
+            p_Block->Length = Frame->Width * Frame->Height * sizeof(uint16_t);
+            p_Block->Frame = Frame;
+
+            break;
+        }
+        case VISA_COMMANDS_IMAGE_FORMAT_RGB: {
+            if (FrameProducts_Require(Frame, FRAME_PRODUCT_RGB) != ESP_OK) {
+                FramePool_Release(Frame);
+                VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+                return SCPI_ERROR_EXECUTION_ERROR;
+            }
+
+            p_Block->Data = Frame->RGB;
+            p_Block->Length = Frame->Width * Frame->Height * 3;
+            p_Block->Frame = Frame;
+
+            break;
+        }
+        case VISA_COMMANDS_IMAGE_FORMAT_JPEG: {
+            Network_Thermal_Frame_t Thermal;
+            esp_err_t Error;
+
+            /* The encoder reads the pool slot, so the JPEG is shared with the HTTP and WebSocket clients */
+            memset(&Thermal, 0, sizeof(Thermal));
+            Thermal.buffer = Frame->RGB;
+            Thermal.raw = Frame->hasRAW ? Frame->RAW : NULL;
+            Thermal.width = Frame->Width;
+            Thermal.height = Frame->Height;
+            Thermal.sequence = Frame->Sequence;
+            Thermal.frame = Frame;
+            Thermal.timestamp = static_cast<uint32_t>(Frame->Timestamp / 1000);
+            Thermal.time = Frame->Time;
+
+            Error = ImageEncoder_Encode(&Thermal, NETWORK_IMAGE_FORMAT_JPEG, p_Session->ImagePalette, &p_Block->Image);
+            FramePool_Release(Frame);
+
+            if (Error != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to encode image: %d!", Error);
+                VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+                return SCPI_ERROR_EXECUTION_ERROR;
+            }
 
-    /* Format binary block header */
-    char header[32];
-    int digits = snprintf(header, sizeof(header), "%zu", image_size);
-    int header_len = snprintf(Response, MaxLen, "#%d%zu", digits, image_size);
+            p_Block->Data = p_Block->Image.data;
+            p_Block->Length = p_Block->Image.size;
 
-    /* Copy image data after header */
-    if ((header_len + image_size) < MaxLen) {
-        memcpy(Response + header_len, image_data, image_size);
-        free(image_data);
-        return header_len + image_size;
+            break;
+        }
     }
 
-    free(image_data);
-    VISA_PushError(SCPI_ERROR_OUT_OF_MEMORY);
-    return SCPI_ERROR_OUT_OF_MEMORY;
+    digits = snprintf(length, sizeof(length), "%u", static_cast<unsigned int>(p_Block->Length));
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "#%d%s", digits, length);
 }
 
-/** @brief          SENSe:IMAGE:FORMat - Set image format
- *  @param Tokens   Command tokens
- *  @param Count    Token count
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length
+/** @brief           SENSe:IMAGE:FORMat - Set image format
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
  */
-static int VISA_CMD_SENS_IMG_FORM(char **Tokens, int Count, char *Response, size_t MaxLen)
+static int VISA_CMD_SENS_IMG_FORM(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
-    if (Count < 4) {
-        VISA_PushError(SCPI_ERROR_MISSING_PARAMETER);
+    if (p_Request->Count < 1) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
         return SCPI_ERROR_MISSING_PARAMETER;
     }
 
-    const char *format = Tokens[3];
+    const char *format = p_Request->Params[0];
 
     ESP_LOGI(TAG, "Set image format: %s", format);
 
-    /* TODO: Set actual format */
-    /* Valid: JPEG, PNG, RAW */
+    /* Valid: RAW, RGB, JPEG */
+    for (uint8_t i = 0; i < (sizeof(_image_format_names) / sizeof(_image_format_names[0])); i++) {
+        if (strcasecmp(format, _image_format_names[i]) == 0) {
+            p_Session->ImageFormat = static_cast<VISACommands_Image_Format_t>(i);
 
-    if ((strcasecmp(format, "JPEG") == 0) ||
-        (strcasecmp(format, "PNG") == 0) ||
-        (strcasecmp(format, "RAW") == 0)) {
-        return 0; /* Success */
-    } else {
-        VISA_PushError(SCPI_ERROR_DATA_OUT_OF_RANGE);
-        return SCPI_ERROR_DATA_OUT_OF_RANGE;
+            return 0; /* Success */
+        }
     }
+
+    VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+    return SCPI_ERROR_DATA_OUT_OF_RANGE;
+}
+
+/** @brief           SENSe:IMAGE:FORMat? - Get image format
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SENS_IMG_FORM_Query(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%s\n", _image_format_names[p_Session->ImageFormat]);
 }
 
-/** @brief          SENSe:IMAGE:PALette - Set color palette
- *  @param Tokens   Command tokens
- *  @param Count    Token count
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length
+/** @brief           SENSe:IMAGE:PALette - Set color palette
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
  */
-static int VISA_CMD_SENS_IMG_PAL(char **Tokens, int Count, char *Response, size_t MaxLen)
+static int VISA_CMD_SENS_IMG_PAL(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
-    if (Count < 4) {
-        VISA_PushError(SCPI_ERROR_MISSING_PARAMETER);
+    if (p_Request->Count < 1) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
         return SCPI_ERROR_MISSING_PARAMETER;
     }
 
-    const char *palette = Tokens[3];
+    const char *palette = p_Request->Params[0];
 
     ESP_LOGI(TAG, "Set palette: %s", palette);
 
-    /* TODO: Set actual palette */
-    /* Valid: IRON, GRAY, RAINBOW */
+    /* Valid: IRON, GRAY, RAINBOW, CUSTOM. Used for JPEG images */
+    for (uint8_t i = 0; i < PALETTE_COUNT; i++) {
+        if (strcasecmp(palette, _image_palette_names[i]) == 0) {
+            p_Session->ImagePalette = static_cast<Server_Palette_t>(i);
 
-    if ((strcasecmp(palette, "IRON") == 0) ||
-        (strcasecmp(palette, "GRAY") == 0) ||
-        (strcasecmp(palette, "RAINBOW") == 0)) {
-        return 0; /* Success */
-    } else {
-        VISA_PushError(SCPI_ERROR_DATA_OUT_OF_RANGE);
-        return SCPI_ERROR_DATA_OUT_OF_RANGE;
+            return 0; /* Success */
+        }
     }
+
+    VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+    return SCPI_ERROR_DATA_OUT_OF_RANGE;
+}
+
+/** @brief           SENSe:IMAGE:PALette? - Get color palette
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SENS_IMG_PAL_Query(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%s\n", _image_palette_names[p_Session->ImagePalette]);
 }
 
-/** @brief          DISPlay:LED:STATe - Set LED state
- *  @param Tokens   Command tokens
- *  @param Count    Token count
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length
+#ifdef CONFIG_LEPTON_DENOISE
+/** @brief           SENSe:IMAGE:DENoise - Set the strength of the temporal noise reduction
+ *                   Accepts OFF, LOW, MEDIUM, HIGH or 0 to 3. Changes the frames of every consumer, not only the
+ *                   images of this session.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
  */
-static int VISA_CMD_DISP_LED_STAT(char **Tokens, int Count, char *Response, size_t MaxLen)
+static int VISA_CMD_SENS_IMG_DEN(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
-    if (Count < 4) {
-        VISA_PushError(SCPI_ERROR_MISSING_PARAMETER);
+    const char *strength;
+
+    if (p_Request->Count < 1) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
         return SCPI_ERROR_MISSING_PARAMETER;
     }
 
-    const char *state = Tokens[3];
+    strength = p_Request->Params[0];
 
-    ESP_LOGI(TAG, "Set LED state: %s", state);
+    for (uint8_t i = 0; i < FRAME_DENOISE_COUNT; i++) {
+        if ((strcasecmp(strength, _image_denoise_names[i]) == 0) ||
+            ((strength[0] == ('0' + i)) && (strength[1] == '\0'))) {
+            ESP_LOGI(TAG, "Set noise reduction: %s", _image_denoise_names[i]);
 
-    /* TODO: Control actual LED */
-    /* Valid: ON, OFF, BLINK */
+            Lepton_Task_SetDenoise(i);
 
-    if ((strcasecmp(state, "ON") == 0) ||
-        (strcasecmp(state, "OFF") == 0) ||
-        (strcasecmp(state, "BLINK") == 0)) {
-        return 0; /* Success */
-    } else {
-        VISA_PushError(SCPI_ERROR_DATA_OUT_OF_RANGE);
-        return SCPI_ERROR_DATA_OUT_OF_RANGE;
+            return 0; /* Success */
+        }
     }
+
+    VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+    return SCPI_ERROR_DATA_OUT_OF_RANGE;
 }
 
-/** @brief          DISPlay:LED:BRIGhtness - Set LED brightness
- *  @param Tokens   Command tokens
- *  @param Count    Token count
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length
+/** @brief           SENSe:IMAGE:DENoise? - Get the strength of the temporal noise reduction
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
  */
-static int VISA_CMD_DISP_LED_BRIG(char **Tokens, int Count, char *Response, size_t MaxLen)
+static int VISA_CMD_SENS_IMG_DEN_Query(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
-    if (Count < 4) {
-        VISA_PushError(SCPI_ERROR_MISSING_PARAMETER);
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%s\n", _image_denoise_names[Lepton_Task_GetDenoise()]);
+}
+#endif
+
+/** @brief           SENSe:IMAGe:BURSt - Record consecutive frames
+ *                   Starts a burst of n frames in the burst recorder. The frames are recorded by the Lepton task
+ *                   without gaps while the display and the streams keep running. *OPC? returns 1 when the burst
+ *                   is complete.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SENS_IMG_BURS(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    esp_err_t Error;
+    int count;
+
+    if (p_Request->Count < 1) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
         return SCPI_ERROR_MISSING_PARAMETER;
     }
 
-    int brightness = atoi(Tokens[3]);
-
-    if ((brightness < 0) || (brightness > 255)) {
-        VISA_PushError(SCPI_ERROR_DATA_OUT_OF_RANGE);
+    count = atoi(p_Request->Params[0]);
+    if ((count <= 0) || (count > UINT16_MAX)) {
+        VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
         return SCPI_ERROR_DATA_OUT_OF_RANGE;
     }
 
-    ESP_LOGI(TAG, "Set LED brightness: %d", brightness);
+    Error = FrameRecorder_Start(static_cast<uint16_t>(count));
+    if (Error == ESP_ERR_INVALID_SIZE) {
+        VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+        return SCPI_ERROR_DATA_OUT_OF_RANGE;
+    } else if (Error == ESP_ERR_NOT_SUPPORTED) {
+        VISA_PushError(p_Session, SCPI_ERROR_HARDWARE_MISSING);
+        return SCPI_ERROR_HARDWARE_MISSING;
+    } else if (Error != ESP_OK) {
+        /* Burst of another client is running or being read */
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
 
-    /* TODO: Set actual LED brightness */
+    p_Session->isBurstPending = true;
+    p_Session->OperationComplete = false;
 
-    return 0; /* Success */
+    return 0; /* No immediate response */
 }
 
-esp_err_t VISACommands_Init(void)
+/** @brief           SENSe:IMAGe:BURSt? - Get burst progress
+ *                   Returns <recorded>,<requested>,<record size in bytes>.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SENS_IMG_BURS_Query(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
-    VISACommands_ClearErrors();
-    _operation_complete = true;
+    uint16_t recorded;
+    uint16_t requested;
 
-    ESP_LOGI(TAG, "VISA command handler initialized");
-    return ESP_OK;
+    FrameRecorder_GetStatus(&recorded, &requested);
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%u,%u,%u\n", recorded, requested,
+                    static_cast<unsigned int>(FrameRecorder_GetRecordSize()));
 }
 
-esp_err_t VISACommands_Deinit(void)
+/** @brief           SENSe:IMAGe:BURSt:DATA? - Get all frames of the last burst
+ *                   The response is one IEEE 488.2 definite length block with all recorded frames back to back.
+ *                   Every frame is a FrameRecorder_Header_t followed by the RAW14 pixels. The block is sent
+ *                   straight from the burst buffer.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SENS_IMG_BURS_DATA(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
 {
-    VISACommands_ClearErrors();
+    VISACommands_Block_t *p_Block = p_Request->p_Block;
+    esp_err_t Error;
+    char length[16];
+    int digits;
+
+    Error = FrameRecorder_Lock(&p_Block->Data, &p_Block->Length);
+    if (Error != ESP_OK) {
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
 
-    ESP_LOGI(TAG, "VISA command handler deinitialized");
-    return ESP_OK;
+    p_Block->isBurst = true;
+
+    digits = snprintf(length, sizeof(length), "%u", static_cast<unsigned int>(p_Block->Length));
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "#%d%s", digits, length);
 }
 
-int VISACommands_Execute(const char *Command, char *Response, size_t MaxLen)
+/* ===== Measurement Commands ===== */
+
+/** @brief               Get the frame of a measurement.
+ *  @param p_Session     Session
+ *  @param p_Request     Request with the parameters and the response buffer
+ *  @param SequenceParam Index of the parameter with the frame sequence number (FETCh),
+ *                       -1 for the latest frame (MEASure)
+ *  @param pp_Frame      Pointer to store the frame reference. Must be released with FramePool_Release.
+ *  @return              0 on success, error code otherwise
+ */
+static int VISA_GetMeasurementFrame(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request, int SequenceParam,
+                                    FramePool_Frame_t **pp_Frame)
 {
-    if ((Command == NULL) || (Response == NULL)) {
-        return SCPI_ERROR_COMMAND_ERROR;
-    }
+    if (SequenceParam < 0) {
+        *pp_Frame = FramePool_GetLatest();
+        if (*pp_Frame == NULL) {
+            VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+            return SCPI_ERROR_EXECUTION_ERROR;
+        }
 
-    /* Make a copy for parsing */
-    char cmd_copy[256];
-    strncpy(cmd_copy, Command, sizeof(cmd_copy) - 1);
-    cmd_copy[sizeof(cmd_copy) - 1] = '\0';
+        return 0;
+    }
 
-    /* Convert to uppercase for comparison */
-    char *tokens[16];
-    int token_count = VISA_ParseCommand(cmd_copy, tokens, 16);
+    if (p_Request->Count <= SequenceParam) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
+        return SCPI_ERROR_MISSING_PARAMETER;
+    }
 
-    if (token_count == 0) {
-        VISA_PushError(SCPI_ERROR_COMMAND_ERROR);
-        return SCPI_ERROR_COMMAND_ERROR;
+    /* Only the last few frames are still in the pool, older or future frames are stale */
+    *pp_Frame = FramePool_Find(strtoul(p_Request->Params[SequenceParam], NULL, 10));
+    if (*pp_Frame == NULL) {
+        VISA_PushError(p_Session, SCPI_ERROR_DATA_STALE);
+        return SCPI_ERROR_DATA_STALE;
     }
 
-    /* Check for queries */
-    bool is_query = VISA_IsQuery(tokens[token_count - 1]);
+    return 0;
+}
 
-    /* Remove ? from last token if query */
-    if (is_query) {
-        size_t len = strlen(tokens[token_count - 1]);
-        if (len > 0) {
-            tokens[token_count - 1][len - 1] = '\0';
-        }
-    }
+/** @brief           Write the scene statistics of a frame.
+ *                   Returns <min>,<max>,<mean>,<stddev>,<min x>,<min y>,<max x>,<max y> in Degree Celsius / Kelvin.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @param p_Frame   Frame of the measurement
+ *  @return          Response length
+ */
+static int VISA_WriteScene(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request,
+                           const FramePool_Frame_t *p_Frame)
+{
+    const FrameStatistics_t *p_Statistics = &p_Frame->Statistics;
 
-    /* IEEE 488.2 Common Commands */
-    if (strcmp(tokens[0], "*IDN") == 0) {
-        if (is_query) {
-            return VISA_CMD_IDN(Response, MaxLen);
-        }
-    } else if (strcmp(tokens[0], "*RST") == 0) {
-        return VISA_CMD_RST(Response, MaxLen);
-    } else if (strcmp(tokens[0], "*CLS") == 0) {
-        return VISA_CMD_CLS(Response, MaxLen);
-    } else if (strcmp(tokens[0], "*OPC") == 0) {
-        if (is_query) {
-            return VISA_CMD_OPC(Response, MaxLen);
-        }
-    } else if (strcmp(tokens[0], "*TST") == 0) {
-        if (is_query) {
-            return VISA_CMD_TST(Response, MaxLen);
-        }
+    if (FrameProducts_Require(p_Frame, FRAME_PRODUCT_STATISTICS) != ESP_OK) {
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
     }
-    /* SCPI System Commands */
-    else if ((strcasecmp(tokens[0], "SYST") == 0) || (strcasecmp(tokens[0], "SYSTem") == 0)) {
-        if ((token_count >= 2) && (strcasecmp(tokens[1], "ERR") == 0 || strcasecmp(tokens[1], "ERRor") == 0)) {
-            if (is_query) {
-                return VISA_CMD_SYST_ERR(Response, MaxLen);
-            }
-        } else if ((token_count >= 2) && (strcasecmp(tokens[1], "VERS") == 0 || strcasecmp(tokens[1], "VERSion") == 0)) {
-            if (is_query) {
-                return VISA_CMD_SYST_VERS(Response, MaxLen);
-            }
-        }
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%.2f,%.2f,%.2f,%.3f,%u,%u,%u,%u\n",
+                    FrameStatistics_RawToCelsius(p_Statistics->Min), FrameStatistics_RawToCelsius(p_Statistics->Max),
+                    FrameStatistics_RawToCelsius(p_Statistics->Mean), sqrtf(p_Statistics->Variance) * 0.01f,
+                    p_Statistics->MinX, p_Statistics->MinY, p_Statistics->MaxX, p_Statistics->MaxY);
+}
+
+/** @brief           Write the ROI result of a frame. The ROI is selected with the numeric suffix of the header.
+ *                   Returns <valid>,<pixels>,<min>,<max>,<mean>,<stddev> in Degree Celsius / Kelvin.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @param p_Frame   Frame of the measurement
+ *  @return          Response length
+ */
+static int VISA_WriteROI(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request,
+                         const FramePool_Frame_t *p_Frame)
+{
+    const ROIEngine_Result_t *p_Result;
+
+    if ((p_Request->Suffix < 1) || (p_Request->Suffix > ROI_ENGINE_MAX_ROIS)) {
+        VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+        return SCPI_ERROR_DATA_OUT_OF_RANGE;
     }
-    /* Device-Specific Commands - SENSe */
-    else if ((strcasecmp(tokens[0], "SENS") == 0) || (strcasecmp(tokens[0], "SENSe") == 0)) {
-        if ((token_count >= 2) && (strcasecmp(tokens[1], "TEMP") == 0 || strcasecmp(tokens[1], "TEMPerature") == 0)) {
-            if (is_query) {
-                return VISA_CMD_SENS_TEMP(Response, MaxLen);
-            }
-        } else if ((token_count >= 2) && (strcasecmp(tokens[1], "IMG") == 0 || strcasecmp(tokens[1], "IMAGE") == 0)) {
-            if ((token_count >= 3) && (strcasecmp(tokens[2], "CAPT") == 0 || strcasecmp(tokens[2], "CAPTure") == 0)) {
-                return VISA_CMD_SENS_IMG_CAPT(Response, MaxLen);
-            } else if ((token_count >= 3) && (strcasecmp(tokens[2], "DATA") == 0)) {
-                if (is_query) {
-                    return VISA_CMD_SENS_IMG_DATA(Response, MaxLen);
-                }
-            } else if ((token_count >= 3) && (strcasecmp(tokens[2], "FORM") == 0 || strcasecmp(tokens[2], "FORMat") == 0)) {
-                return VISA_CMD_SENS_IMG_FORM(tokens, token_count, Response, MaxLen);
-            } else if ((token_count >= 3) && (strcasecmp(tokens[2], "PAL") == 0 || strcasecmp(tokens[2], "PALette") == 0)) {
-                return VISA_CMD_SENS_IMG_PAL(tokens, token_count, Response, MaxLen);
-            }
-        }
+
+    if (FrameProducts_Require(p_Frame, FRAME_PRODUCT_ROI) != ESP_OK) {
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
     }
-    /* Device-Specific Commands - DISPlay */
-    else if ((strcasecmp(tokens[0], "DISP") == 0) || (strcasecmp(tokens[0], "DISPlay") == 0)) {
-        if ((token_count >= 2) && (strcasecmp(tokens[1], "LED") == 0)) {
-            if ((token_count >= 3) && (strcasecmp(tokens[2], "STAT") == 0 || strcasecmp(tokens[2], "STATe") == 0)) {
-                return VISA_CMD_DISP_LED_STAT(tokens, token_count, Response, MaxLen);
-            } else if ((token_count >= 3) && (strcasecmp(tokens[2], "BRIG") == 0 || strcasecmp(tokens[2], "BRIGhtness") == 0)) {
-                return VISA_CMD_DISP_LED_BRIG(tokens, token_count, Response, MaxLen);
-            }
-        }
+
+    p_Result = &p_Frame->ROI[p_Request->Suffix - 1];
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%d,%lu,%.2f,%.2f,%.2f,%.3f\n", p_Result->isValid ? 1 : 0,
+                    static_cast<unsigned long>(p_Result->Pixels), p_Result->Min, p_Result->Max, p_Result->Mean,
+                    p_Result->StdDev);
+}
+
+/** @brief           Write the histogram of a frame.
+ *                   Returns <min>,<bin width>,<block> with the temperature of bin 0 in Degree Celsius, the bin width
+ *                   in Kelvin and a definite length block with FRAME_STATISTICS_HISTOGRAM_BINS 16 bit little endian
+ *                   pixel counts. The block is sent straight from the frame, which is kept referenced by the block.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @param p_Frame   Frame of the measurement. The reference is handed over to the block on success.
+ *  @return          Response length
+ */
+static int VISA_WriteHistogram(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request,
+                               FramePool_Frame_t *p_Frame)
+{
+    VISACommands_Block_t *p_Block = p_Request->p_Block;
+    char length[16];
+    int digits;
+
+    if (FrameProducts_Require(p_Frame, FRAME_PRODUCT_STATISTICS) != ESP_OK) {
+        FramePool_Release(p_Frame);
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
     }
 
-    /* Command not found */
-    VISA_PushError(SCPI_ERROR_UNDEFINED_HEADER);
-    return SCPI_ERROR_UNDEFINED_HEADER;
+    p_Block->Data = reinterpret_cast<const uint8_t *>(p_Frame->Statistics.Histogram);
+    p_Block->Length = sizeof(p_Frame->Statistics.Histogram);
+    p_Block->Frame = p_Frame;
+
+    digits = snprintf(length, sizeof(length), "%u", static_cast<unsigned int>(p_Block->Length));
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%.2f,%.4f,#%d%s",
+                    FrameStatistics_RawToCelsius(p_Frame->Statistics.Min), p_Frame->Statistics.BinWidth * 0.01f,
+                    digits, length);
 }
 
-int VISACommands_GetError(void)
+/** @brief           Write the temperature of a single pixel of a frame in Degree Celsius.
+ *                   The column and the row are the first two parameters.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @param p_Frame   Frame of the measurement
+ *  @return          Response length
+ */
+static int VISA_WritePixel(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request,
+                           const FramePool_Frame_t *p_Frame)
 {
-    if (_error_count > 0) {
-        int error = _error_queue[0];
+    int x;
+    int y;
 
-        /* Shift queue */
-        for (size_t i = 1; i < _error_count; i++) {
-            _error_queue[i - 1] = _error_queue[i];
-        }
-        _error_count--;
+    if (p_Request->Count < 2) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
+        return SCPI_ERROR_MISSING_PARAMETER;
+    }
 
-        return error;
+    x = atoi(p_Request->Params[0]);
+    y = atoi(p_Request->Params[1]);
+    if ((x < 0) || (x >= p_Frame->Width) || (y < 0) || (y >= p_Frame->Height)) {
+        VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+        return SCPI_ERROR_DATA_OUT_OF_RANGE;
     }
 
-    return SCPI_ERROR_NO_ERROR;
+    if (p_Frame->hasRAW == false) {
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%.2f\n",
+                    FrameStatistics_RawToCelsius(p_Frame->RAW[(y * p_Frame->Width) + x]));
+}
+
+/** @brief           Write the temperature map of a frame as IEEE 488.2 definite length block. The block holds an
+ *                   ImageEncoder_Temperature_Header_t followed by the temperatures in centi-Kelvin and is shared
+ *                   with the HTTP and WebSocket clients through the encoder cache.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @param p_Frame   Frame of the measurement
+ *  @return          Response length
+ */
+static int VISA_WriteTemperature(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request,
+                                 FramePool_Frame_t *p_Frame)
+{
+    VISACommands_Block_t *p_Block = p_Request->p_Block;
+    Network_Thermal_Frame_t Thermal;
+    char length[16];
+    int digits;
+
+    if (p_Frame->hasRAW == false) {
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
+
+    memset(&Thermal, 0, sizeof(Thermal));
+    Thermal.buffer = p_Frame->RGB;
+    Thermal.raw = p_Frame->RAW;
+    Thermal.width = p_Frame->Width;
+    Thermal.height = p_Frame->Height;
+    Thermal.sequence = p_Frame->Sequence;
+    Thermal.frame = p_Frame;
+    Thermal.timestamp = static_cast<uint32_t>(p_Frame->Timestamp / 1000);
+    Thermal.time = p_Frame->Time;
+
+    if (ImageEncoder_Encode(&Thermal, NETWORK_IMAGE_FORMAT_TEMPERATURE, PALETTE_IRON, &p_Block->Image) != ESP_OK) {
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
+
+    p_Block->Data = p_Block->Image.data;
+    p_Block->Length = p_Block->Image.size;
+
+    digits = snprintf(length, sizeof(length), "%u", static_cast<unsigned int>(p_Block->Length));
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "#%d%s", digits, length);
+}
+
+/** @brief           MEASure:SCENe? - Scene statistics of the latest frame
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_MEAS_SCEN(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    FramePool_Frame_t *Frame;
+    int Error;
+
+    Error = VISA_GetMeasurementFrame(p_Session, p_Request, -1, &Frame);
+    if (Error != 0) {
+        return Error;
+    }
+
+    Error = VISA_WriteScene(p_Session, p_Request, Frame);
+    FramePool_Release(Frame);
+
+    return Error;
+}
+
+/** @brief           FETCh:SCENe? <sequence> - Scene statistics of a recent frame
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_FETC_SCEN(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    FramePool_Frame_t *Frame;
+    int Error;
+
+    Error = VISA_GetMeasurementFrame(p_Session, p_Request, 0, &Frame);
+    if (Error != 0) {
+        return Error;
+    }
+
+    Error = VISA_WriteScene(p_Session, p_Request, Frame);
+    FramePool_Release(Frame);
+
+    return Error;
+}
+
+/** @brief           MEASure:ROI<n>? - ROI result of the latest frame
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_MEAS_ROI(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    FramePool_Frame_t *Frame;
+    int Error;
+
+    Error = VISA_GetMeasurementFrame(p_Session, p_Request, -1, &Frame);
+    if (Error != 0) {
+        return Error;
+    }
+
+    Error = VISA_WriteROI(p_Session, p_Request, Frame);
+    FramePool_Release(Frame);
+
+    return Error;
+}
+
+/** @brief           FETCh:ROI<n>? <sequence> - ROI result of a recent frame
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_FETC_ROI(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    FramePool_Frame_t *Frame;
+    int Error;
+
+    Error = VISA_GetMeasurementFrame(p_Session, p_Request, 0, &Frame);
+    if (Error != 0) {
+        return Error;
+    }
+
+    Error = VISA_WriteROI(p_Session, p_Request, Frame);
+    FramePool_Release(Frame);
+
+    return Error;
+}
+
+/** @brief           MEASure:HISTogram? - Histogram of the latest frame
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_MEAS_HIST(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    FramePool_Frame_t *Frame;
+    int Error;
+
+    Error = VISA_GetMeasurementFrame(p_Session, p_Request, -1, &Frame);
+    if (Error != 0) {
+        return Error;
+    }
+
+    return VISA_WriteHistogram(p_Session, p_Request, Frame);
+}
+
+/** @brief           FETCh:HISTogram? <sequence> - Histogram of a recent frame
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_FETC_HIST(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    FramePool_Frame_t *Frame;
+    int Error;
+
+    Error = VISA_GetMeasurementFrame(p_Session, p_Request, 0, &Frame);
+    if (Error != 0) {
+        return Error;
+    }
+
+    return VISA_WriteHistogram(p_Session, p_Request, Frame);
+}
+
+/** @brief           MEASure:PIXel? <x>,<y> - Pixel temperature of the latest frame
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_MEAS_PIX(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    FramePool_Frame_t *Frame;
+    int Error;
+
+    Error = VISA_GetMeasurementFrame(p_Session, p_Request, -1, &Frame);
+    if (Error != 0) {
+        return Error;
+    }
+
+    Error = VISA_WritePixel(p_Session, p_Request, Frame);
+    FramePool_Release(Frame);
+
+    return Error;
+}
+
+/** @brief           FETCh:PIXel? <x>,<y>,<sequence> - Pixel temperature of a recent frame
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_FETC_PIX(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    FramePool_Frame_t *Frame;
+    int Error;
+
+    Error = VISA_GetMeasurementFrame(p_Session, p_Request, 2, &Frame);
+    if (Error != 0) {
+        return Error;
+    }
+
+    Error = VISA_WritePixel(p_Session, p_Request, Frame);
+    FramePool_Release(Frame);
+
+    return Error;
+}
+
+/** @brief           MEASure:TEMPerature? - Temperature map of the latest frame
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_MEAS_TEMP(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    FramePool_Frame_t *Frame;
+    int Error;
+
+    Error = VISA_GetMeasurementFrame(p_Session, p_Request, -1, &Frame);
+    if (Error != 0) {
+        return Error;
+    }
+
+    Error = VISA_WriteTemperature(p_Session, p_Request, Frame);
+    FramePool_Release(Frame);
+
+    return Error;
+}
+
+/** @brief           FETCh:TEMPerature? <sequence> - Temperature map of a recent frame
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_FETC_TEMP(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    FramePool_Frame_t *Frame;
+    int Error;
+
+    Error = VISA_GetMeasurementFrame(p_Session, p_Request, 0, &Frame);
+    if (Error != 0) {
+        return Error;
+    }
+
+    Error = VISA_WriteTemperature(p_Session, p_Request, Frame);
+    FramePool_Release(Frame);
+
+    return Error;
+}
+
+/** @brief           FETCh:SEQuence? - Sequence number of the latest frame, to be used with the FETCh queries
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_FETC_SEQ(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%lu\n",
+                    static_cast<unsigned long>(FramePool_GetSequence()));
+}
+
+#ifdef CONFIG_LEPTON_SPOTS
+/** @brief Names of the spot kinds, indexed by SpotTracker_Kind_t */
+static const char *_spot_kind_names[] = {"HOT", "COLD"};
+
+/** @brief           Set the threshold of a spot alarm. Accepts a temperature in Degree Celsius or OFF.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @param Kind      Kind of the alarm
+ *  @return          Response length
+ */
+static int VISA_SetSpotThreshold(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request,
+                                 SpotTracker_Kind_t Kind)
+{
+    char *end;
+    float celsius;
+    long raw;
+
+    if (p_Request->Count < 1) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
+        return SCPI_ERROR_MISSING_PARAMETER;
+    }
+
+    if (strcasecmp(p_Request->Params[0], "OFF") == 0) {
+        ESP_LOGI(TAG, "Disable %s spot alarm", _spot_kind_names[Kind]);
+
+        Lepton_Task_SetSpotThreshold(Kind, 0);
+
+        return 0; /* Success */
+    }
+
+    celsius = strtof(p_Request->Params[0], &end);
+    raw = lroundf((celsius + 273.15f) * 100.0f);
+    if ((end == p_Request->Params[0]) || (*end != '\0') || (raw < 1) || (raw > UINT16_MAX)) {
+        VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+        return SCPI_ERROR_DATA_OUT_OF_RANGE;
+    }
+
+    ESP_LOGI(TAG, "Set %s spot alarm: %.2f C", _spot_kind_names[Kind], celsius);
+
+    Lepton_Task_SetSpotThreshold(Kind, static_cast<uint16_t>(raw));
+
+    return 0; /* Success */
+}
+
+/** @brief           Get the threshold of a spot alarm in Degree Celsius, OFF if the alarm is disabled.
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @param Kind      Kind of the alarm
+ *  @return          Response length
+ */
+static int VISA_GetSpotThreshold(VISA_Request_t *p_Request, SpotTracker_Kind_t Kind)
+{
+    uint16_t threshold = Lepton_Task_GetSpotThreshold(Kind);
+
+    if (threshold == 0) {
+        return snprintf(p_Request->Response, p_Request->MaxLen, "OFF\n");
+    }
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%.2f\n", FrameStatistics_RawToCelsius(threshold));
+}
+
+/** @brief           SENSe:SPOT:HOT - Set the threshold of the hot spot alarm in Degree Celsius or OFF
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SENS_SPOT_HOT(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    return VISA_SetSpotThreshold(p_Session, p_Request, SPOT_TRACKER_HOT);
+}
+
+/** @brief           SENSe:SPOT:HOT? - Get the threshold of the hot spot alarm
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SENS_SPOT_HOT_Query(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    return VISA_GetSpotThreshold(p_Request, SPOT_TRACKER_HOT);
+}
+
+/** @brief           SENSe:SPOT:COLD - Set the threshold of the cold spot alarm in Degree Celsius or OFF
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SENS_SPOT_COLD(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    return VISA_SetSpotThreshold(p_Session, p_Request, SPOT_TRACKER_COLD);
+}
+
+/** @brief           SENSe:SPOT:COLD? - Get the threshold of the cold spot alarm
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_SENS_SPOT_COLD_Query(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    return VISA_GetSpotThreshold(p_Request, SPOT_TRACKER_COLD);
+}
+
+/** @brief           FETCh:SPOT? - Tracked spots of the latest frame
+ *                   Returns <sequence>,<count>,<truncated> followed by <id>,<HOT|COLD>,<x>,<y>,<area>,<peak> per
+ *                   spot, the position of the peak in pixels and the peak in Degree Celsius.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_FETC_SPOT(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    SpotTracker_Result_t result;
+    int length;
+
+    if (Lepton_Task_GetSpots(&result) != ESP_OK) {
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
+
+    length = snprintf(p_Request->Response, p_Request->MaxLen, "%lu,%u,%u", static_cast<unsigned long>(result.Sequence),
+                      result.Count, result.isTruncated ? 1 : 0);
+
+    for (uint8_t i = 0; (i < result.Count) && (length < static_cast<int>(p_Request->MaxLen)); i++) {
+        const SpotTracker_Spot_t *p_Spot = &result.Spots[i];
+
+        length += snprintf(&p_Request->Response[length], p_Request->MaxLen - length, ",%u,%s,%u,%u,%u,%.2f",
+                           p_Spot->ID, _spot_kind_names[p_Spot->Kind], p_Spot->X, p_Spot->Y, p_Spot->Area,
+                           FrameStatistics_RawToCelsius(p_Spot->Peak));
+    }
+
+    if (length < static_cast<int>(p_Request->MaxLen)) {
+        length += snprintf(&p_Request->Response[length], p_Request->MaxLen - length, "\n");
+    }
+
+    return length;
+}
+
+/** @brief           STATus:ALARm? - State of the spot alarms
+ *                   Returns <hot>,<cold>,<events> with 1 for a raised alarm and the number of alarm changes since
+ *                   the boot.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_STAT_ALAR(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    SpotTracker_Result_t result;
+
+    if (Lepton_Task_GetSpots(&result) != ESP_OK) {
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%u,%u,%lu\n", result.isAlarm[SPOT_TRACKER_HOT] ? 1 : 0,
+                    result.isAlarm[SPOT_TRACKER_COLD] ? 1 : 0, static_cast<unsigned long>(result.Last.Number));
+}
+#endif
+
+#ifdef CONFIG_LEPTON_FFC
+/** @brief           STATus:FFC? - State of the flat field correction
+ *                   Returns <active>,<number>,<frames>,<duration>,<dropped> with 1 while the camera repeats its
+ *                   frames, the number, the repeated frames and the duration in ms of the latest correction and
+ *                   the repeated frames dropped since the boot.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_STAT_FFC(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    App_Lepton_FFC_t ffc;
+
+    if (Lepton_Task_GetFFC(&ffc) != ESP_OK) {
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%u,%lu,%lu,%lu,%lu\n", ffc.isActive ? 1 : 0,
+                    static_cast<unsigned long>(ffc.Number), static_cast<unsigned long>(ffc.Frames),
+                    static_cast<unsigned long>(ffc.Duration), static_cast<unsigned long>(ffc.Dropped));
+}
+#endif
+
+/* ===== Mass Memory Commands ===== */
+
+/** @brief           MMEMory:RECord - Start or stop the SD card recording
+ *                   ON or 1 starts a new recording, OFF or 0 stops it. The remaining frames are written in the
+ *                   background, MMEMory:RECord? reports 0 when the files are closed.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_MMEM_REC(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    esp_err_t Error;
+    const char *state;
+
+    if (p_Request->Count < 1) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
+        return SCPI_ERROR_MISSING_PARAMETER;
+    }
+
+    state = p_Request->Params[0];
+
+    if ((strcasecmp(state, "ON") == 0) || (strcmp(state, "1") == 0)) {
+        Error = SDRecorder_Start();
+    } else if ((strcasecmp(state, "OFF") == 0) || (strcmp(state, "0") == 0)) {
+        Error = SDRecorder_Stop();
+    } else {
+        VISA_PushError(p_Session, SCPI_ERROR_DATA_TYPE_ERROR);
+        return SCPI_ERROR_DATA_TYPE_ERROR;
+    }
+
+    if (Error == ESP_ERR_NOT_SUPPORTED) {
+        VISA_PushError(p_Session, SCPI_ERROR_HARDWARE_MISSING);
+        return SCPI_ERROR_HARDWARE_MISSING;
+    } else if (Error != ESP_OK) {
+        /* No card, or the recording is already running or stopped */
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
+
+    return 0; /* No immediate response */
+}
+
+/** @brief           MMEMory:RECord? - Get the state of the SD card recording
+ *                   Returns <active>,<recording>,<segment>,<written frames>,<backlog>,<max backlog>,<capacity>,
+ *                   <dropped frames>,<written bytes>,<error>.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_MMEM_REC_Query(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    SDRecorder_Status_t status;
+
+    SDRecorder_GetStatus(&status);
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%d,%u,%u,%lu,%lu,%lu,%lu,%lu,%llu,%d\n",
+                    status.isActive ? 1 : 0, status.Recording, status.Segment,
+                    static_cast<unsigned long>(status.Frames), static_cast<unsigned long>(status.Backlog),
+                    static_cast<unsigned long>(status.MaxBacklog), static_cast<unsigned long>(status.Capacity),
+                    static_cast<unsigned long>(status.Dropped), static_cast<unsigned long long>(status.Bytes),
+                    status.Error);
+}
+
+/** @brief           MMEMory:SNAPshot - Save a radiometric snapshot to the SD card
+ *                   The captured frame or the latest frame is saved with the RAW14 data, the flux parameters of the
+ *                   camera, the ROI results and a JPEG preview in the palette of SENSe:IMAGe:PALette. Without a card
+ *                   the snapshot goes to the flash log without a preview and is copied to the next mounted card.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_MMEM_SNAP(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    FramePool_Frame_t *Frame;
+    Network_Thermal_Frame_t Thermal;
+    Network_Encoded_Image_t Preview;
+    Lepton_FluxLinearParams_t FluxParams;
+    bool hasFluxParams;
+    esp_err_t Error;
+
+    Frame = (p_Session->CapturedFrame != NULL) ? FramePool_Retain(p_Session->CapturedFrame) : FramePool_GetLatest();
+    if ((Frame == NULL) || (Frame->hasRAW == false)) {
+        FramePool_Release(Frame);
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
+
+    hasFluxParams = (Lepton_Task_GetFluxParameters(&FluxParams) == ESP_OK);
+
+#ifdef CONFIG_FLASH_LOG
+    if (SDManager_isMounted() == false) {
+        uint32_t Sequence;
+
+        Error = FlashLog_Append(Frame, hasFluxParams ? &FluxParams : NULL, &Sequence);
+        FramePool_Release(Frame);
+
+        if (Error != ESP_OK) {
+            /* No flash log or the previous snapshot is still written */
+            VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+            return SCPI_ERROR_EXECUTION_ERROR;
+        }
+
+        snprintf(p_Session->SnapshotPath, sizeof(p_Session->SnapshotPath), "flash:%u",
+                 static_cast<unsigned int>(Sequence));
+
+        return 0; /* No immediate response */
+    }
+#endif
+
+    memset(&Thermal, 0, sizeof(Thermal));
+    Thermal.buffer = Frame->RGB;
+    Thermal.raw = Frame->RAW;
+    Thermal.width = Frame->Width;
+    Thermal.height = Frame->Height;
+    Thermal.sequence = Frame->Sequence;
+    Thermal.frame = Frame;
+    Thermal.timestamp = static_cast<uint32_t>(Frame->Timestamp / 1000);
+    Thermal.time = Frame->Time;
+
+    /* A snapshot without a preview is still complete, the preview can be rendered from the RAW14 data */
+    memset(&Preview, 0, sizeof(Preview));
+    if (ImageEncoder_Encode(&Thermal, NETWORK_IMAGE_FORMAT_JPEG, p_Session->ImagePalette, &Preview) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to encode the snapshot preview!");
+    }
+
+    Error = SDSnapshot_Write(Frame, hasFluxParams ? &FluxParams : NULL, Preview.data, Preview.size,
+                             p_Session->SnapshotPath, sizeof(p_Session->SnapshotPath));
+
+    if (Preview.data != NULL) {
+        ImageEncoder_Free(&Preview);
+    }
+
+    FramePool_Release(Frame);
+
+    if (Error != ESP_OK) {
+        /* No card or the card is full */
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
+
+    return 0; /* No immediate response */
+}
+
+/** @brief           MMEMory:SNAPshot? - Get the path of the last snapshot of this session
+ *                   Returns the quoted path, "flash:<record>" for the flash log or an empty string if no snapshot
+ *                   was saved.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_MMEM_SNAP_Query(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    return snprintf(p_Request->Response, p_Request->MaxLen, "\"%s\"\n", p_Session->SnapshotPath);
+}
+
+/** @brief           MMEMory:TLAPse <interval>[,<count>] - Start a time-lapse schedule
+ *                   Takes a snapshot every <interval> minutes, <count> times or without a limit if omitted or 0.
+ *                   The device enters the deep sleep after the command, the schedule ends with a reset.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_MMEM_TLAP(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    int interval;
+    int count;
+    esp_err_t Error;
+
+    if (p_Request->Count < 1) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
+        return SCPI_ERROR_MISSING_PARAMETER;
+    }
+
+    interval = atoi(p_Request->Params[0]);
+    count = (p_Request->Count > 1) ? atoi(p_Request->Params[1]) : 0;
+
+    if ((interval < 1) || (interval > SD_TIMELAPSE_INTERVAL_MAX) || (count < 0)) {
+        VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+        return SCPI_ERROR_DATA_OUT_OF_RANGE;
+    }
+
+    Error = SDTimeLapse_Start(static_cast<uint16_t>(interval), static_cast<uint32_t>(count));
+    if (Error != ESP_OK) {
+        /* No card or a recording is running */
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
+
+    return 0; /* No immediate response */
+}
+
+/** @brief           MMEMory:TLAPse? - Get the state of the last time-lapse schedule
+ *                   Returns <active>,<interval>,<count>,<shots>,<wake to capture ms>,<awake ms>,<error>.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_MMEM_TLAP_Query(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    SDTimeLapse_Status_t status;
+
+    SDTimeLapse_GetStatus(&status);
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%d,%u,%lu,%lu,%lu,%lu,%d\n",
+                    status.isActive ? 1 : 0, status.Interval, static_cast<unsigned long>(status.Count),
+                    static_cast<unsigned long>(status.Shots), static_cast<unsigned long>(status.WakeToCapture),
+                    static_cast<unsigned long>(status.Awake), status.Error);
+}
+
+#ifdef CONFIG_LEPTON_REPLAY
+/** @brief           MMEMory:REPLay "<path>"[,<rate>[,<loop>]] - Replay a recording instead of the VoSPI frames
+ *                   <path> is a recording directory or a single segment, <rate> the frame rate in Hz or 0 for the
+ *                   timing of the recording. HOST replays the binary records of the WebSocket, OFF or 0 stops.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_MMEM_REPL(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    char Path[64];
+    const char *param;
+    size_t length;
+    int rate;
+    esp_err_t Error;
+
+    if (p_Request->Count < 1) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
+        return SCPI_ERROR_MISSING_PARAMETER;
+    }
+
+    param = p_Request->Params[0];
+
+    if ((strcasecmp(param, "OFF") == 0) || (strcmp(param, "0") == 0)) {
+        Error = FrameReplay_Stop();
+    } else if (strcasecmp(param, "HOST") == 0) {
+        Error = FrameReplay_StartHost();
+    } else {
+        /* The path is a string parameter, the quotes are part of the parameter */
+        length = strlen(param);
+        if ((length >= 2) && ((param[0] == '"') || (param[0] == '\'')) && (param[length - 1] == param[0])) {
+            param++;
+            length -= 2;
+        }
+
+        if ((length == 0) || (length >= sizeof(Path))) {
+            VISA_PushError(p_Session, SCPI_ERROR_DATA_TYPE_ERROR);
+            return SCPI_ERROR_DATA_TYPE_ERROR;
+        }
+
+        memcpy(Path, param, length);
+        Path[length] = '\0';
+
+        rate = (p_Request->Count > 1) ? atoi(p_Request->Params[1]) : 0;
+        if ((rate < 0) || (rate > 27)) {
+            VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+            return SCPI_ERROR_DATA_OUT_OF_RANGE;
+        }
+
+        Error = FrameReplay_StartFile(Path, static_cast<uint16_t>(rate),
+                                      (p_Request->Count > 2) && ((strcasecmp(p_Request->Params[2], "ON") == 0) ||
+                                                                 (strcmp(p_Request->Params[2], "1") == 0)));
+    }
+
+    if (Error != ESP_OK) {
+        /* No recording at this path, or a replay is already running */
+        VISA_PushError(p_Session, SCPI_ERROR_EXECUTION_ERROR);
+        return SCPI_ERROR_EXECUTION_ERROR;
+    }
+
+    return 0; /* No immediate response */
+}
+
+/** @brief           MMEMory:REPLay? - Get the state of the replay
+ *                   Returns <source>,<rate>,<loop>,<frames>,<dropped frames>,<invalid records> with the source
+ *                   OFF, SD or HOST.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_MMEM_REPL_Query(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    FrameReplay_Status_t status;
+    static const char *Sources[] = {"OFF", "SD", "HOST"};
+
+    FrameReplay_GetStatus(&status);
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%s,%u,%d,%lu,%lu,%lu\n",
+                    Sources[status.Source], status.Rate, status.isLoop ? 1 : 0,
+                    static_cast<unsigned long>(status.Frames), static_cast<unsigned long>(status.Dropped),
+                    static_cast<unsigned long>(status.Errors));
+}
+#endif
+
+/** @brief           DISPlay:LED:STATe - Set LED state
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_DISP_LED_STAT(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    if (p_Request->Count < 1) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
+        return SCPI_ERROR_MISSING_PARAMETER;
+    }
+
+    const char *state = p_Request->Params[0];
+
+    ESP_LOGI(TAG, "Set LED state: %s", state);
+
+    /* Valid: ON, OFF, BLINK */
+
+    if ((strcasecmp(state, "ON") == 0) || (strcasecmp(state, "OFF") == 0)) {
+        /* Costs no bus transfer when the LED is already in this state */
+        if (DevicesManager_EnableLED(strcasecmp(state, "ON") == 0) != ESP_OK) {
+            VISA_PushError(p_Session, SCPI_ERROR_HARDWARE_ERROR);
+            return SCPI_ERROR_HARDWARE_ERROR;
+        }
+
+        return 0; /* Success */
+    } else if (strcasecmp(state, "BLINK") == 0) {
+        /* TODO: Blink the LED */
+        return 0; /* Success */
+    } else {
+        VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+        return SCPI_ERROR_DATA_OUT_OF_RANGE;
+    }
+}
+
+/** @brief           DISPlay:LED:BRIGhtness - Set LED brightness
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_DISP_LED_BRIG(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    if (p_Request->Count < 1) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
+        return SCPI_ERROR_MISSING_PARAMETER;
+    }
+
+    int brightness = atoi(p_Request->Params[0]);
+
+    if ((brightness < 0) || (brightness > 255)) {
+        VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+        return SCPI_ERROR_DATA_OUT_OF_RANGE;
+    }
+
+    ESP_LOGI(TAG, "Set LED brightness: %d", brightness);
+
+    /* TODO: Set actual LED brightness */
+
+    return 0; /* Success */
+}
+
+#ifdef CONFIG_GUI_THERMAL_RAW_LUT
+/** @brief           DISPlay:AGC - Set the software AGC of the thermal view
+ *                   Accepts LINEAR, CLIP, HEQ, LOCAL or 0 to 3. Only changes the display, the RAW14 data and the
+ *                   images of the network are not affected.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_DISP_AGC(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    const char *mode;
+
+    if (p_Request->Count < 1) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
+        return SCPI_ERROR_MISSING_PARAMETER;
+    }
+
+    mode = p_Request->Params[0];
+
+    for (uint8_t i = 0; i < FRAME_AGC_COUNT; i++) {
+        if ((strcasecmp(mode, _display_agc_names[i]) == 0) || ((mode[0] == ('0' + i)) && (mode[1] == '\0'))) {
+            ESP_LOGI(TAG, "Set display AGC: %s", _display_agc_names[i]);
+
+            GUI_Task_SetAGC(i);
+
+            return 0; /* Success */
+        }
+    }
+
+    VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+    return SCPI_ERROR_DATA_OUT_OF_RANGE;
+}
+
+/** @brief           DISPlay:AGC? - Get the software AGC of the thermal view
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_DISP_AGC_Query(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%s\n", _display_agc_names[GUI_Task_GetAGC()]);
+}
+#endif
+
+#ifdef CONFIG_LEPTON_ISOTHERMS
+/** @brief          Parse an end of an isotherm band.
+ *  @param p_Value  Temperature in Degree Celsius, MIN or MAX
+ *  @param p_Raw    Pointer to store the raw value
+ *  @return         true on success
+ */
+static bool VISA_ParseIsothermEnd(const char *p_Value, uint16_t *p_Raw)
+{
+    char *end;
+    long raw;
+
+    if (strcasecmp(p_Value, "MIN") == 0) {
+        *p_Raw = 0;
+        return true;
+    }
+
+    if (strcasecmp(p_Value, "MAX") == 0) {
+        *p_Raw = UINT16_MAX;
+        return true;
+    }
+
+    raw = lroundf((strtof(p_Value, &end) + 273.15f) * 100.0f);
+    if ((end == p_Value) || (*end != '\0') || (raw < 0) || (raw > UINT16_MAX)) {
+        return false;
+    }
+
+    *p_Raw = static_cast<uint16_t>(raw);
+
+    return true;
+}
+
+/** @brief           DISPlay:ISOTherm<n> - Set or remove an isotherm band
+ *                   Accepts <low>,<high>[,<RRGGBB>] with the ends in Degree Celsius or MIN / MAX, e.g. 60,MAX
+ *                   paints everything above 60 Degree Celsius, or OFF to remove the band. The color is red if
+ *                   omitted. n = number of bands + 1 adds a band, band 1 is painted on top. Changes the display
+ *                   and the JPEG images of every consumer.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_DISP_ISOT(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    Isotherm_Set_t set;
+    Isotherm_Band_t *p_Band;
+    uint8_t index;
+
+    if (p_Request->Count < 1) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
+        return SCPI_ERROR_MISSING_PARAMETER;
+    }
+
+    Isotherm_Get(&set);
+
+    if ((p_Request->Suffix < 1) || (p_Request->Suffix > ISOTHERM_MAX_BANDS) || (p_Request->Suffix > (set.Count + 1))) {
+        VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+        return SCPI_ERROR_DATA_OUT_OF_RANGE;
+    }
+
+    index = p_Request->Suffix - 1;
+
+    if (strcasecmp(p_Request->Params[0], "OFF") == 0) {
+        if (index < set.Count) {
+            memmove(&set.Bands[index], &set.Bands[index + 1], (set.Count - index - 1) * sizeof(Isotherm_Band_t));
+            set.Count--;
+
+            ESP_LOGI(TAG, "Remove isotherm %d", p_Request->Suffix);
+        }
+
+        Isotherm_Set(set.Bands, set.Count);
+
+        return 0; /* Success */
+    }
+
+    if (p_Request->Count < 2) {
+        VISA_PushError(p_Session, SCPI_ERROR_MISSING_PARAMETER);
+        return SCPI_ERROR_MISSING_PARAMETER;
+    }
+
+    p_Band = &set.Bands[index];
+
+    if ((VISA_ParseIsothermEnd(p_Request->Params[0], &p_Band->Low) == false) ||
+        (VISA_ParseIsothermEnd(p_Request->Params[1], &p_Band->High) == false) || (p_Band->Low > p_Band->High)) {
+        VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+        return SCPI_ERROR_DATA_OUT_OF_RANGE;
+    }
+
+    p_Band->Color[0] = 0xFF;
+    p_Band->Color[1] = 0;
+    p_Band->Color[2] = 0;
+
+    if (p_Request->Count > 2) {
+        char *end;
+        unsigned long rgb = strtoul(p_Request->Params[2], &end, 16);
+
+        if ((end == p_Request->Params[2]) || (*end != '\0') || (rgb > 0xFFFFFF)) {
+            VISA_PushError(p_Session, SCPI_ERROR_DATA_OUT_OF_RANGE);
+            return SCPI_ERROR_DATA_OUT_OF_RANGE;
+        }
+
+        p_Band->Color[0] = (rgb >> 16) & 0xFF;
+        p_Band->Color[1] = (rgb >> 8) & 0xFF;
+        p_Band->Color[2] = rgb & 0xFF;
+    }
+
+    if (index == set.Count) {
+        set.Count++;
+    }
+
+    ESP_LOGI(TAG, "Set isotherm %d: %u - %u", p_Request->Suffix, p_Band->Low, p_Band->High);
+
+    Isotherm_Set(set.Bands, set.Count);
+
+    return 0; /* Success */
+}
+
+/** @brief           DISPlay:ISOTherm<n>? - Get an isotherm band
+ *                   Returns <low>,<high>,<RRGGBB> with the ends in Degree Celsius or MIN / MAX, OFF if there is no
+ *                   band n.
+ *  @param p_Session Session
+ *  @param p_Request Request with the parameters and the response buffer
+ *  @return          Response length
+ */
+static int VISA_CMD_DISP_ISOT_Query(VISACommands_Session_t *p_Session, VISA_Request_t *p_Request)
+{
+    Isotherm_Set_t set;
+    const Isotherm_Band_t *p_Band;
+    char low[16];
+    char high[16];
+
+    Isotherm_Get(&set);
+
+    if ((p_Request->Suffix < 1) || (p_Request->Suffix > set.Count)) {
+        return snprintf(p_Request->Response, p_Request->MaxLen, "OFF\n");
+    }
+
+    p_Band = &set.Bands[p_Request->Suffix - 1];
+
+    if (p_Band->Low == 0) {
+        snprintf(low, sizeof(low), "MIN");
+    } else {
+        snprintf(low, sizeof(low), "%.2f", FrameStatistics_RawToCelsius(p_Band->Low));
+    }
+
+    if (p_Band->High == UINT16_MAX) {
+        snprintf(high, sizeof(high), "MAX");
+    } else {
+        snprintf(high, sizeof(high), "%.2f", FrameStatistics_RawToCelsius(p_Band->High));
+    }
+
+    return snprintf(p_Request->Response, p_Request->MaxLen, "%s,%s,%02X%02X%02X\n", low, high, p_Band->Color[0],
+                    p_Band->Color[1], p_Band->Color[2]);
+}
+#endif
+
+/* ===== Command Dispatch ===== */
+
+/** @brief All supported commands. New commands are only added here, the dispatch table is generated from this list.
+ */
+static constexpr VISA_Command_t _VISA_Commands[] = {
+    /* IEEE 488.2 Common Commands */
+    {"*IDN",                        NULL,                      VISA_CMD_IDN},
+    {"*RST",                        VISA_CMD_RST,              NULL},
+    {"*CLS",                        VISA_CMD_CLS,              NULL},
+    {"*OPC",                        NULL,                      VISA_CMD_OPC},
+    {"*TST",                        NULL,                      VISA_CMD_TST},
+
+    /* SCPI System Commands */
+    {"SYSTem:ERRor",                NULL,                      VISA_CMD_SYST_ERR},
+    {"SYSTem:VERSion",              NULL,                      VISA_CMD_SYST_VERS},
+    {"SYSTem:BOOT",                 NULL,                      VISA_CMD_SYST_BOOT},
+    {"SYSTem:MEMory",               NULL,                      VISA_CMD_SYST_MEM},
+    {"SYSTem:LATency",              NULL,                      VISA_CMD_SYST_LAT},
+    {"SYSTem:LATency:RESet",        VISA_CMD_SYST_LAT_RES,     NULL},
+#ifdef CONFIG_NETWORK_METRICS
+    {"SYSTem:PERFormance",          NULL,                      VISA_CMD_SYST_PERF},
+    {"SYSTem:CPU",                  NULL,                      VISA_CMD_SYST_CPU},
+#endif
+    {"SYSTem:TASK#",                VISA_CMD_SYST_TASK,        VISA_CMD_SYST_TASK_Query},
+#ifdef CONFIG_TRACE
+    {"SYSTem:TRACe:TRIGger",        VISA_CMD_SYST_TRAC_TRIG,   NULL},
+    {"SYSTem:TRACe:COUNt",          NULL,                      VISA_CMD_SYST_TRAC_COUN},
+#endif
+#ifdef CONFIG_LEPTON_SPOTS
+    {"STATus:ALARm",                NULL,                      VISA_CMD_STAT_ALAR},
+#endif
+#ifdef CONFIG_LEPTON_FFC
+    {"STATus:FFC",                  NULL,                      VISA_CMD_STAT_FFC},
+#endif
+
+    /* Device-Specific Commands - SENSe */
+    {"SENSe:TEMPerature",           NULL,                      VISA_CMD_SENS_TEMP},
+    {"SENSe:IMG|IMAGE:CAPTure",     VISA_CMD_SENS_IMG_CAPT,    NULL},
+    {"SENSe:IMG|IMAGE:DATA",        NULL,                      VISA_CMD_SENS_IMG_DATA},
+    {"SENSe:IMG|IMAGE:FORMat",      VISA_CMD_SENS_IMG_FORM,    VISA_CMD_SENS_IMG_FORM_Query},
+    {"SENSe:IMG|IMAGE:PALette",     VISA_CMD_SENS_IMG_PAL,     VISA_CMD_SENS_IMG_PAL_Query},
+#ifdef CONFIG_LEPTON_DENOISE
+    {"SENSe:IMG|IMAGE:DENoise",     VISA_CMD_SENS_IMG_DEN,     VISA_CMD_SENS_IMG_DEN_Query},
+#endif
+    {"SENSe:IMG|IMAGE:BURSt",       VISA_CMD_SENS_IMG_BURS,    VISA_CMD_SENS_IMG_BURS_Query},
+    {"SENSe:IMG|IMAGE:BURSt:DATA",  NULL,                      VISA_CMD_SENS_IMG_BURS_DATA},
+#ifdef CONFIG_LEPTON_SPOTS
+    {"SENSe:SPOT:HOT",              VISA_CMD_SENS_SPOT_HOT,    VISA_CMD_SENS_SPOT_HOT_Query},
+    {"SENSe:SPOT:COLD",             VISA_CMD_SENS_SPOT_COLD,   VISA_CMD_SENS_SPOT_COLD_Query},
+#endif
+
+    /* Device-Specific Commands - MEASure / FETCh */
+    {"MEASure:SCENe",               NULL,                      VISA_CMD_MEAS_SCEN},
+    {"MEASure:ROI#",                NULL,                      VISA_CMD_MEAS_ROI},
+    {"MEASure:HISTogram",           NULL,                      VISA_CMD_MEAS_HIST},
+    {"MEASure:PIXel",               NULL,                      VISA_CMD_MEAS_PIX},
+    {"MEASure:TEMPerature",         NULL,                      VISA_CMD_MEAS_TEMP},
+    {"FETCh:SCENe",                 NULL,                      VISA_CMD_FETC_SCEN},
+    {"FETCh:ROI#",                  NULL,                      VISA_CMD_FETC_ROI},
+    {"FETCh:HISTogram",             NULL,                      VISA_CMD_FETC_HIST},
+    {"FETCh:PIXel",                 NULL,                      VISA_CMD_FETC_PIX},
+    {"FETCh:TEMPerature",           NULL,                      VISA_CMD_FETC_TEMP},
+    {"FETCh:SEQuence",              NULL,                      VISA_CMD_FETC_SEQ},
+#ifdef CONFIG_LEPTON_SPOTS
+    {"FETCh:SPOT",                  NULL,                      VISA_CMD_FETC_SPOT},
+#endif
+
+    /* Device-Specific Commands - MMEMory */
+    {"MMEMory:RECord",              VISA_CMD_MMEM_REC,         VISA_CMD_MMEM_REC_Query},
+    {"MMEMory:SNAPshot",            VISA_CMD_MMEM_SNAP,        VISA_CMD_MMEM_SNAP_Query},
+    {"MMEMory:TLAPse",              VISA_CMD_MMEM_TLAP,        VISA_CMD_MMEM_TLAP_Query},
+#ifdef CONFIG_LEPTON_REPLAY
+    {"MMEMory:REPLay",              VISA_CMD_MMEM_REPL,        VISA_CMD_MMEM_REPL_Query},
+#endif
+
+    /* Device-Specific Commands - DISPlay */
+    {"DISPlay:LED:STATe",           VISA_CMD_DISP_LED_STAT,    NULL},
+    {"DISPlay:LED:BRIGhtness",      VISA_CMD_DISP_LED_BRIG,    NULL},
+#ifdef CONFIG_GUI_THERMAL_RAW_LUT
+    {"DISPlay:AGC",                 VISA_CMD_DISP_AGC,         VISA_CMD_DISP_AGC_Query},
+#endif
+#ifdef CONFIG_LEPTON_ISOTHERMS
+    {"DISPlay:ISOTherm#",           VISA_CMD_DISP_ISOT,        VISA_CMD_DISP_ISOT_Query},
+#endif
+};
+
+#define VISA_COMMAND_COUNT                  (sizeof(_VISA_Commands) / sizeof(_VISA_Commands[0]))
+
+/** @brief      Feed a character into the header hash. The hash is case insensitive.
+ *  @param Hash Current hash
+ *  @param c    Character
+ *  @return     New hash
+ */
+static constexpr uint32_t VISA_HashChar(uint32_t Hash, char c)
+{
+    return (Hash ^ static_cast<uint8_t>(((c >= 'a') && (c <= 'z')) ? (c - 'a' + 'A') : c)) * VISA_HASH_PRIME;
+}
+
+/** @brief      Check if a character ends a mnemonic alternative of a command declaration.
+ *  @param c    Character
+ *  @return     true at the end of the alternative
+ */
+static constexpr bool VISA_isAlternativeEnd(char c)
+{
+    return (c == '\0') || (c == ':') || (c == '|');
+}
+
+/** @brief               Get the number of accepted forms of a mnemonic alternative. An alternative with lower case
+ *                       letters has a short and a long form.
+ *  @param p_Alternative Start of the alternative
+ *  @return              1 or 2
+ */
+static constexpr size_t VISA_AlternativeForms(const char *p_Alternative)
+{
+    for (const char *c = p_Alternative; VISA_isAlternativeEnd(*c) == false; c++) {
+        if ((*c >= 'a') && (*c <= 'z')) {
+            return 2;
+        }
+    }
+
+    return 1;
+}
+
+/** @brief               Get the start of the next alternative of the same mnemonic.
+ *  @param p_Alternative Start of the alternative
+ *  @return              Start of the next alternative, NULL if it was the last alternative of the mnemonic
+ */
+static constexpr const char *VISA_NextAlternative(const char *p_Alternative)
+{
+    while (VISA_isAlternativeEnd(*p_Alternative) == false) {
+        p_Alternative++;
+    }
+
+    return (*p_Alternative == '|') ? (p_Alternative + 1) : NULL;
+}
+
+/** @brief              Get the number of accepted forms of a mnemonic over all of its alternatives.
+ *  @param p_Mnemonic   Start of the mnemonic
+ *  @return             Number of forms
+ */
+static constexpr size_t VISA_MnemonicForms(const char *p_Mnemonic)
+{
+    size_t forms = 0;
+
+    for (const char *alternative = p_Mnemonic; alternative != NULL; alternative = VISA_NextAlternative(alternative)) {
+        forms += VISA_AlternativeForms(alternative);
+    }
+
+    return forms;
+}
+
+/** @brief              Get the start of the next mnemonic of a command declaration.
+ *  @param p_Mnemonic   Start of the mnemonic
+ *  @return             Start of the next mnemonic, NULL if it was the last mnemonic
+ */
+static constexpr const char *VISA_NextMnemonic(const char *p_Mnemonic)
+{
+    while ((*p_Mnemonic != '\0') && (*p_Mnemonic != ':')) {
+        p_Mnemonic++;
+    }
+
+    return (*p_Mnemonic == ':') ? (p_Mnemonic + 1) : NULL;
+}
+
+/** @brief          Get the number of accepted headers of a command declaration.
+ *  @param Header   Header of the declaration
+ *  @return         Number of headers
+ */
+static constexpr size_t VISA_HeaderForms(const char *Header)
+{
+    size_t forms = 1;
+
+    for (const char *mnemonic = Header; mnemonic != NULL; mnemonic = VISA_NextMnemonic(mnemonic)) {
+        forms *= VISA_MnemonicForms(mnemonic);
+    }
+
+    return forms;
+}
+
+/** @brief              Hash one accepted header of a command declaration.
+ *  @param Header       Header of the declaration
+ *  @param Combination  Index of the header, 0 to VISA_HeaderForms() - 1. Every mnemonic selects its form with one
+ *                      digit of the mixed radix number.
+ *  @return             Hash of the header
+ */
+static constexpr uint32_t VISA_HeaderHash(const char *Header, size_t Combination)
+{
+    uint32_t hash = VISA_HASH_OFFSET;
+
+    for (const char *mnemonic = Header; mnemonic != NULL; mnemonic = VISA_NextMnemonic(mnemonic)) {
+        const char *alternative = mnemonic;
+        size_t form = Combination % VISA_MnemonicForms(mnemonic);
+        bool isShort = false;
+
+        if (mnemonic != Header) {
+            hash = VISA_HashChar(hash, ':');
+        }
+
+        Combination /= VISA_MnemonicForms(mnemonic);
+
+        while (form >= VISA_AlternativeForms(alternative)) {
+            form -= VISA_AlternativeForms(alternative);
+            alternative = VISA_NextAlternative(alternative);
+        }
+
+        /* Form 0 of an alternative with two forms is the short form */
+        isShort = (VISA_AlternativeForms(alternative) == 2) && (form == 0);
+
+        /* The numeric suffix is not part of the hash */
+        for (const char *c = alternative; VISA_isAlternativeEnd(*c) == false; c++) {
+            if ((*c == '#') || (isShort && (*c >= 'a') && (*c <= 'z'))) {
+                continue;
+            }
+
+            hash = VISA_HashChar(hash, *c);
+        }
+    }
+
+    return hash;
+}
+
+/** @brief  Get the number of entries of the dispatch table.
+ *  @return Number of accepted headers of all commands
+ */
+static constexpr size_t VISA_DispatchSize(void)
+{
+    size_t size = 0;
+
+    for (const VISA_Command_t &command : _VISA_Commands) {
+        size += VISA_HeaderForms(command.Header);
+    }
+
+    return size;
+}
+
+#define VISA_DISPATCH_SIZE                  VISA_DispatchSize()
+
+/** @brief  Build the dispatch table with every accepted header of every command, sorted by hash.
+ *  @return Dispatch table
+ */
+static constexpr VISA_Dispatch_Table_t<VISA_DISPATCH_SIZE> VISA_BuildDispatchTable(void)
+{
+    VISA_Dispatch_Table_t<VISA_DISPATCH_SIZE> table{};
+    size_t count = 0;
+
+    for (size_t i = 0; i < VISA_COMMAND_COUNT; i++) {
+        for (size_t j = 0; j < VISA_HeaderForms(_VISA_Commands[i].Header); j++) {
+            VISA_Dispatch_Entry_t entry{VISA_HeaderHash(_VISA_Commands[i].Header, j), static_cast<uint8_t>(i)};
+            size_t k = count++;
+
+            /* Insertion sort */
+            while ((k > 0) && (table.Entries[k - 1].Hash > entry.Hash)) {
+                table.Entries[k] = table.Entries[k - 1];
+                k--;
+            }
+
+            table.Entries[k] = entry;
+        }
+    }
+
+    return table;
+}
+
+/** @brief          Check that no two headers of the dispatch table have the same hash.
+ *  @param Table    Dispatch table
+ *  @return         true if all hashes are unique
+ */
+static constexpr bool VISA_isDispatchUnique(const VISA_Dispatch_Table_t<VISA_DISPATCH_SIZE> &Table)
+{
+    for (size_t i = 1; i < VISA_DISPATCH_SIZE; i++) {
+        if (Table.Entries[i - 1].Hash == Table.Entries[i].Hash) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static constexpr VISA_Dispatch_Table_t<VISA_DISPATCH_SIZE> _VISA_Dispatch = VISA_BuildDispatchTable();
+
+static_assert(VISA_COMMAND_COUNT <= UINT8_MAX, "Too many VISA commands for the dispatch table");
+static_assert(VISA_isDispatchUnique(_VISA_Dispatch), "Hash collision in the VISA command list, change a header!");
+
+/** @brief            Get the length of a received mnemonic without its numeric suffix.
+ *  @param p_Mnemonic Received mnemonic
+ *  @param Length     Length of the received mnemonic
+ *  @return           Length without the trailing digits
+ */
+static size_t VISA_StripSuffix(const char *p_Mnemonic, size_t Length)
+{
+    while ((Length > 1) && isdigit(static_cast<unsigned char>(p_Mnemonic[Length - 1]))) {
+        Length--;
+    }
+
+    return Length;
+}
+
+/** @brief               Compare a received mnemonic with one alternative of a command declaration.
+ *  @param p_Alternative Start of the alternative
+ *  @param p_Mnemonic    Received mnemonic
+ *  @param Length        Length of the received mnemonic
+ *  @return              true if the mnemonic is the short or the long form of the alternative
+ */
+static bool VISA_MatchAlternative(const char *p_Alternative, const char *p_Mnemonic, size_t Length)
+{
+    size_t stripped = VISA_StripSuffix(p_Mnemonic, Length);
+    bool hasSuffix = false;
+    size_t i = 0;
+    const char *c;
+
+    for (c = p_Alternative; VISA_isAlternativeEnd(*c) == false; c++) {
+        hasSuffix |= (*c == '#');
+    }
+
+    /* Digits at the end are only allowed where the declaration has a suffix */
+    if (hasSuffix) {
+        Length = stripped;
+    } else if (stripped != Length) {
+        return false;
+    }
+
+    /* Long form */
+    for (c = p_Alternative; (VISA_isAlternativeEnd(*c) == false) && (*c != '#') && (i < Length); c++, i++) {
+        if (toupper(static_cast<unsigned char>(*c)) != toupper(static_cast<unsigned char>(p_Mnemonic[i]))) {
+            break;
+        }
+    }
+
+    if ((VISA_isAlternativeEnd(*c) || (*c == '#')) && (i == Length)) {
+        return true;
+    }
+
+    /* Short form, the upper case letters of the alternative */
+    i = 0;
+    for (c = p_Alternative; VISA_isAlternativeEnd(*c) == false; c++) {
+        if (islower(static_cast<unsigned char>(*c)) || (*c == '#')) {
+            continue;
+        }
+
+        if ((i >= Length) || (*c != toupper(static_cast<unsigned char>(p_Mnemonic[i])))) {
+            return false;
+        }
+
+        i++;
+    }
+
+    return (i == Length);
+}
+
+/** @brief          Check a received header against a command declaration. Resolves hash collisions with headers
+ *                  that are not in the command list.
+ *  @param Pattern  Header of the declaration
+ *  @param Header   Received header
+ *  @return         true if the header is accepted by the declaration
+ */
+static bool VISA_MatchHeader(const char *Pattern, const char *Header)
+{
+    const char *mnemonic = Pattern;
+
+    while (mnemonic != NULL) {
+        size_t length = strcspn(Header, ":");
+        bool isMatch = false;
+
+        for (const char *alternative = mnemonic; alternative != NULL;
+             alternative = VISA_NextAlternative(alternative)) {
+            if (VISA_MatchAlternative(alternative, Header, length)) {
+                isMatch = true;
+
+                break;
+            }
+        }
+
+        if (isMatch == false) {
+            return false;
+        }
+
+        mnemonic = VISA_NextMnemonic(mnemonic);
+        Header += length;
+
+        if ((mnemonic != NULL) != (*Header == ':')) {
+            return false;
+        }
+
+        if (*Header == ':') {
+            Header++;
+        }
+    }
+
+    return true;
+}
+
+/** @brief          Find the command of a received header.
+ *  @param Header   Complete header without the query mark
+ *  @param p_Suffix Pointer to store the numeric suffix of the header, 1 if there is none
+ *  @return         Command or NULL if the header is unknown
+ */
+static const VISA_Command_t *VISA_FindCommand(const char *Header, int *p_Suffix)
+{
+    uint32_t hash = VISA_HASH_OFFSET;
+    size_t low = 0;
+    size_t high = VISA_DISPATCH_SIZE;
+    const char *mnemonic = Header;
+
+    *p_Suffix = 1;
+
+    /* Hash the mnemonics without their numeric suffix, like the declarations */
+    while (true) {
+        size_t length = strcspn(mnemonic, ":");
+        size_t stripped = VISA_StripSuffix(mnemonic, length);
+
+        for (size_t i = 0; i < stripped; i++) {
+            hash = VISA_HashChar(hash, mnemonic[i]);
+        }
+
+        if (stripped != length) {
+            *p_Suffix = atoi(mnemonic + stripped);
+        }
+
+        if (mnemonic[length] == '\0') {
+            break;
+        }
+
+        hash = VISA_HashChar(hash, ':');
+        mnemonic += length + 1;
+    }
+
+    /* Binary search in the sorted dispatch table */
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+
+        if (_VISA_Dispatch.Entries[mid].Hash < hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if ((low < VISA_DISPATCH_SIZE) && (_VISA_Dispatch.Entries[low].Hash == hash)) {
+        const VISA_Command_t *p_Command = &_VISA_Commands[_VISA_Dispatch.Entries[low].Command];
+
+        if (VISA_MatchHeader(p_Command->Header, Header)) {
+            return p_Command;
+        }
+    }
+
+    return NULL;
+}
+
+/** @brief          Remove leading and trailing whitespace.
+ *  @param String   String, modified in place
+ *  @return         Start of the trimmed string
+ */
+static char *VISA_Trim(char *String)
+{
+    char *end;
+
+    while (isspace(static_cast<unsigned char>(*String))) {
+        String++;
+    }
+
+    end = String + strlen(String);
+    while ((end > String) && isspace(static_cast<unsigned char>(*(end - 1)))) {
+        *(--end) = '\0';
+    }
+
+    return String;
+}
+
+/** @brief           Split a string at the first separator outside of a quoted string.
+ *  @param String    String, the separator is replaced by a terminator
+ *  @param Separator Separator character
+ *  @return          Start of the remaining string, NULL if there is no separator
+ */
+static char *VISA_Split(char *String, char Separator)
+{
+    char quote = '\0';
+
+    for (char *c = String; *c != '\0'; c++) {
+        if (quote != '\0') {
+            if (*c == quote) {
+                quote = '\0';
+            }
+        } else if ((*c == '"') || (*c == '\'')) {
+            quote = *c;
+        } else if (*c == Separator) {
+            *c = '\0';
+
+            return c + 1;
+        }
+    }
+
+    return NULL;
+}
+
+/** @brief           Execute a single command of a program message.
+ *  @param p_Session Session
+ *  @param Unit      Command with header and parameters, modified in place
+ *  @param Path      Header path of the previous command of the message, updated for the next command
+ *  @param p_Request Request with the response buffer
+ *  @return          Response length or error code
+ */
+static int VISA_ExecuteUnit(VISACommands_Session_t *p_Session, char *Unit, char *Path, VISA_Request_t *p_Request)
+{
+    char header[VISA_MAX_HEADER_LENGTH];
+    const VISA_Command_t *p_Command;
+    VISA_Handler_t Handler;
+    char *params;
+    char *last;
+    size_t len;
+    bool isQuery;
+    bool isCommon;
+    int written;
+
+    /* The header ends at the first whitespace, everything behind are the parameters */
+    params = Unit + strcspn(Unit, " \t");
+    if (*params != '\0') {
+        *params++ = '\0';
+    }
+
+    len = strlen(Unit);
+    isQuery = (len > 0) && (Unit[len - 1] == '?');
+    if (isQuery) {
+        Unit[--len] = '\0';
+    }
+
+    /* A header with a leading colon starts at the root, common commands do not change the path */
+    isCommon = (Unit[0] == '*');
+    if (Unit[0] == ':') {
+        Unit++;
+        Path[0] = '\0';
+    }
+
+    written = snprintf(header, sizeof(header), "%s%s", isCommon ? "" : Path, Unit);
+    if ((written <= 0) || (written >= static_cast<int>(sizeof(header)))) {
+        VISA_PushError(p_Session, SCPI_ERROR_COMMAND_HEADER_ERROR);
+        return SCPI_ERROR_COMMAND_HEADER_ERROR;
+    }
+
+    p_Command = VISA_FindCommand(header, &p_Request->Suffix);
+    Handler = (p_Command == NULL) ? NULL : (isQuery ? p_Command->Query : p_Command->Set);
+    if (Handler == NULL) {
+        VISA_PushError(p_Session, SCPI_ERROR_UNDEFINED_HEADER);
+        return SCPI_ERROR_UNDEFINED_HEADER;
+    }
+
+    /* The following command of a compound message is relative to the path of this one */
+    if (isCommon == false) {
+        last = strrchr(header, ':');
+        len = (last == NULL) ? 0 : (last - header + 1);
+        memcpy(Path, header, len);
+        Path[len] = '\0';
+    }
+
+    p_Request->Count = 0;
+    params = VISA_Trim(params);
+    while ((*params != '\0') && (p_Request->Count < VISA_MAX_PARAMETERS)) {
+        char *next = VISA_Split(params, ',');
+
+        p_Request->Params[p_Request->Count++] = VISA_Trim(params);
+
+        if (next == NULL) {
+            break;
+        }
+
+        params = next;
+    }
+
+    return Handler(p_Session, p_Request);
+}
+
+esp_err_t VISACommands_Init(void)
+{
+    ESP_LOGI(TAG, "VISA command handler initialized (%u commands, %u headers)",
+             static_cast<unsigned int>(VISA_COMMAND_COUNT), static_cast<unsigned int>(VISA_DISPATCH_SIZE));
+    return ESP_OK;
+}
+
+esp_err_t VISACommands_Deinit(void)
+{
+    ESP_LOGI(TAG, "VISA command handler deinitialized");
+    return ESP_OK;
+}
+
+void VISACommands_InitSession(VISACommands_Session_t *p_Session)
+{
+    memset(p_Session, 0, sizeof(VISACommands_Session_t));
+
+    p_Session->OperationComplete = true;
+    p_Session->ImageFormat = VISA_COMMANDS_IMAGE_FORMAT_RAW;
+    p_Session->ImagePalette = PALETTE_IRON;
+}
+
+void VISACommands_DeinitSession(VISACommands_Session_t *p_Session)
+{
+    FramePool_Release(p_Session->CapturedFrame);
+    p_Session->CapturedFrame = NULL;
+
+    VISACommands_ClearErrors(p_Session);
+}
+
+int VISACommands_Execute(VISACommands_Session_t *p_Session, const char *Command, char *Response, size_t MaxLen,
+                         VISACommands_Block_t *p_Block)
+{
+    char message[VISA_MAX_MESSAGE_LENGTH];
+    char path[VISA_MAX_HEADER_LENGTH] = "";
+    VISA_Request_t request;
+    size_t used = 0;
+    char *unit;
+
+    if ((p_Session == NULL) || (Command == NULL) || (Response == NULL) || (p_Block == NULL)) {
+        return SCPI_ERROR_COMMAND_ERROR;
+    }
+
+    memset(p_Block, 0, sizeof(VISACommands_Block_t));
+
+    /* Make a copy for parsing */
+    strncpy(message, Command, sizeof(message) - 1);
+    message[sizeof(message) - 1] = '\0';
+
+    request.p_Block = p_Block;
+
+    /* A program message can hold several commands, separated by ';' */
+    unit = message;
+    while (unit != NULL) {
+        char *next = VISA_Split(unit, ';');
+        int len;
+
+        unit = VISA_Trim(unit);
+        if (*unit == '\0') {
+            unit = next;
+
+            continue;
+        }
+
+        /* The block data is sent after the text, so a block response must be the last response of the message */
+        if (p_Block->Data != NULL) {
+            VISACommands_ReleaseBlock(p_Block);
+            VISA_PushError(p_Session, SCPI_ERROR_QUERY_ERROR);
+            return SCPI_ERROR_QUERY_ERROR;
+        }
+
+        request.Response = Response + used;
+        request.MaxLen = MaxLen - used;
+
+        len = VISA_ExecuteUnit(p_Session, unit, path, &request);
+        if (len < 0) {
+            /* The rest of the message is not executed after an error */
+            VISACommands_ReleaseBlock(p_Block);
+            return len;
+        }
+
+        if (len >= static_cast<int>(request.MaxLen)) {
+            VISACommands_ReleaseBlock(p_Block);
+            VISA_PushError(p_Session, SCPI_ERROR_OUT_OF_MEMORY);
+            return SCPI_ERROR_OUT_OF_MEMORY;
+        }
+
+        if (len > 0) {
+            /* Responses of a compound message are separated by ';' and share one terminator */
+            if ((used > 0) && (Response[used - 1] == '\n')) {
+                Response[used - 1] = ';';
+            }
+
+            used += len;
+        }
+
+        unit = next;
+    }
+
+    return used;
+}
+
+int VISACommands_GetError(VISACommands_Session_t *p_Session)
+{
+    if (p_Session->ErrorCount > 0) {
+        int error = p_Session->Errors[0];
+
+        /* Shift queue */
+        for (size_t i = 1; i < p_Session->ErrorCount; i++) {
+            p_Session->Errors[i - 1] = p_Session->Errors[i];
+        }
+        p_Session->ErrorCount--;
+
+        return error;
+    }
+
+    return SCPI_ERROR_NO_ERROR;
+}
+
+void VISACommands_ReleaseBlock(VISACommands_Block_t *p_Block)
+{
+    if (p_Block == NULL) {
+        return;
+    }
+
+    FramePool_Release(p_Block->Frame);
+
+    if (p_Block->Image.data != NULL) {
+        ImageEncoder_Free(&p_Block->Image);
+    }
+
+    if (p_Block->isBurst) {
+        FrameRecorder_Unlock();
+    }
+
+    memset(p_Block, 0, sizeof(VISACommands_Block_t));
 }
 
-void VISACommands_ClearErrors(void)
+void VISACommands_ClearErrors(VISACommands_Session_t *p_Session)
 {
-    _error_count = 0;
-    memset(_error_queue, 0, sizeof(_error_queue));
+    p_Session->ErrorCount = 0;
+    memset(p_Session->Errors, 0, sizeof(p_Session->Errors));
 }
@@ -27,6 +27,10 @@
 #include <esp_err.h>
 
 #include <stddef.h>
+#include <stdbool.h>
+
+#include "../../../networkTypes.h"
+#include "Application/Manager/SD/sdSnapshot.h"
 
 /** @brief Standard SCPI error codes */
 #define SCPI_ERROR_NO_ERROR                 0       /**< No error */
@@ -41,12 +45,48 @@
 #define SCPI_ERROR_UNDEFINED_HEADER         -113    /**< Undefined header */
 #define SCPI_ERROR_EXECUTION_ERROR          -200    /**< Execution error */
 #define SCPI_ERROR_DATA_OUT_OF_RANGE        -222    /**< Data out of range */
+#define SCPI_ERROR_DATA_STALE               -230    /**< Data corrupt or stale */
 #define SCPI_ERROR_HARDWARE_MISSING         -241    /**< Hardware missing */
 #define SCPI_ERROR_HARDWARE_ERROR           -240    /**< Hardware error */
 #define SCPI_ERROR_SYSTEM_ERROR             -300    /**< System error */
 #define SCPI_ERROR_OUT_OF_MEMORY            -350    /**< Out of memory */
 #define SCPI_ERROR_QUERY_ERROR              -400    /**< Query error */
 
+/** @brief Maximum number of queued errors per session */
+#define VISA_ERROR_QUEUE_SIZE               10
+
+/** @brief Image formats of SENSe:IMAGe:FORMat */
+typedef enum {
+    VISA_COMMANDS_IMAGE_FORMAT_RAW = 0,     /**< RAW14, 16 bit little endian per pixel */
+    VISA_COMMANDS_IMAGE_FORMAT_RGB,         /**< RGB888 */
+    VISA_COMMANDS_IMAGE_FORMAT_JPEG,        /**< JPEG */
+} VISACommands_Image_Format_t;
+
+/** @brief Command state of a single client connection. Every client has its own error queue and image settings, so
+ *         parallel clients do not see the errors or the captures of each other.
+ */
+typedef struct {
+    int Errors[VISA_ERROR_QUEUE_SIZE];      /**< Error queue, oldest error first */
+    size_t ErrorCount;                      /**< Number of queued errors */
+    bool OperationComplete;                 /**< Operation complete flag for *OPC? */
+    VISACommands_Image_Format_t ImageFormat; /**< Format of SENSe:IMAGe:DATA? */
+    Server_Palette_t ImagePalette;          /**< Palette of SENSe:IMAGe:DATA? */
+    FramePool_Frame_t *CapturedFrame;       /**< Frame of the last SENSe:IMAGe:CAPTure, NULL if none */
+    bool isBurstPending;                    /**< Burst of this session is running, *OPC? reports 0 until done */
+    char SnapshotPath[SD_SNAPSHOT_PATH_MAX]; /**< Path of the last MMEMory:SNAPshot, empty if none */
+} VISACommands_Session_t;
+
+/** @brief Binary block of a response. The text part of the response holds the IEEE 488.2 definite length block header,
+ *         the block data is sent from Data afterwards without a copy.
+ */
+typedef struct {
+    const uint8_t *Data;                    /**< Block data, NULL if the response has no block */
+    size_t Length;                          /**< Length of the block data in bytes */
+    FramePool_Frame_t *Frame;               /**< Frame reference that keeps Data valid, NULL if none */
+    Network_Encoded_Image_t Image;          /**< Encoded image that keeps Data valid, data is NULL if none */
+    bool isBurst;                           /**< Data points to the locked frames of the burst recorder */
+} VISACommands_Block_t;
+
 /** @brief          Initialize command handler
  *  @return         ESP_OK on success, error code otherwise
  */
@@ -57,21 +97,42 @@ esp_err_t VISACommands_Init(void);
  */
 esp_err_t VISACommands_Deinit(void);
 
-/** @brief          Execute VISA/SCPI command
- *  @param Command  Command string
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length or error code
+/** @brief           Initialize the command state of a new client connection
+ *  @param p_Session Pointer to the session
+ */
+void VISACommands_InitSession(VISACommands_Session_t *p_Session);
+
+/** @brief           Release the captured frame and clear the error queue of a closed client connection
+ *  @param p_Session Pointer to the session
+ */
+void VISACommands_DeinitSession(VISACommands_Session_t *p_Session);
+
+/** @brief           Execute VISA/SCPI command
+ *  @param p_Session Session of the client
+ *  @param Command   Command string
+ *  @param Response  Response buffer
+ *  @param MaxLen    Maximum response length
+ *  @param p_Block   Pointer to store the binary block of the response. Must be released with
+ *                   VISACommands_ReleaseBlock after the block was sent.
+ *  @return          Response length or error code
+ */
+int VISACommands_Execute(VISACommands_Session_t *p_Session, const char *Command, char *Response, size_t MaxLen,
+                         VISACommands_Block_t *p_Block);
+
+/** @brief          Release the frame or the encoded image of a binary block.
+ *  @param p_Block  Pointer to the block
  */
-int VISACommands_Execute(const char *Command, char *Response, size_t MaxLen);
+void VISACommands_ReleaseBlock(VISACommands_Block_t *p_Block);
 
-/** @brief          Get last error from error queue
- *  @return         Error code
+/** @brief           Get the oldest error from the error queue of a session
+ *  @param p_Session Pointer to the session
+ *  @return          Error code
  */
-int VISACommands_GetError(void);
+int VISACommands_GetError(VISACommands_Session_t *p_Session);
 
-/** @brief          Clear error queue
+/** @brief           Clear the error queue of a session
+ *  @param p_Session Pointer to the session
  */
-void VISACommands_ClearErrors(void);
+void VISACommands_ClearErrors(VISACommands_Session_t *p_Session);
 
 #endif /* VISA_COMMANDS_H_ */
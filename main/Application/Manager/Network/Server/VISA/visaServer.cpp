@@ -22,7 +22,9 @@
  */
 
 #include <string.h>
+#include <fcntl.h>
 #include <sys/socket.h>
+#include <sys/select.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
@@ -34,117 +36,319 @@
 
 #include "visaServer.h"
 #include "Private/visaCommands.h"
+#include "Application/Topology/topology.h"
 
 static const char *TAG = "VISA-Server";
 
+/** @brief Connection of a single client.
+ */
+typedef struct {
+    int Socket;                                 /**< Client socket, -1 if the slot is free */
+    VISACommands_Session_t Commands;            /**< Error queue and image settings of the client */
+    char RxBuffer[VISA_MAX_COMMAND_LENGTH];     /**< Received data until the next line terminator */
+    size_t RxLength;                            /**< Number of bytes in RxBuffer */
+    bool isDiscarding;                          /**< Drop data until the next line terminator */
+    char TxBuffer[VISA_MAX_RESPONSE_LENGTH];    /**< Text part of the pending response */
+    size_t TxLength;                            /**< Length of the text part */
+    size_t TxOffset;                            /**< Number of sent bytes of the text part */
+    VISACommands_Block_t Block;                 /**< Binary block of the pending response */
+    size_t BlockOffset;                         /**< Number of sent bytes of the block */
+    bool isTrailerPending;                      /**< Line terminator after the block is not sent yet */
+    int64_t LastActivity;                       /**< Time of the last received or sent data in us */
+} VISA_Session_t;
+
 typedef struct {
-    int ListenSocket;                   /**< Listening socket */
-    TaskHandle_t ServerTask;            /**< Server task handle */
-    bool isRunning;                     /**< Server running flag */
-    bool isInitialized;                 /**< Initialization flag */
-    SemaphoreHandle_t Mutex;            /**< Thread safety mutex */
+    int ListenSocket;                           /**< Listening socket */
+    TaskHandle_t ServerTask;                    /**< Server task handle */
+    bool isRunning;                             /**< Server running flag */
+    bool isInitialized;                         /**< Initialization flag */
+    SemaphoreHandle_t Mutex;                    /**< Thread safety mutex */
+    VISA_Session_t Sessions[VISA_MAX_CLIENTS];  /**< Client connections */
 } VISA_Server_State_t;
 
 static VISA_Server_State_t _VISA_Server_State;
 
-/** @brief          Process VISA command and generate response
- *  @param Command  Received command string
- *  @param Response Response buffer
- *  @param MaxLen   Maximum response length
- *  @return         Response length or error code
+/** @brief              Check if a session has a response that is not sent completely.
+ *  @param p_Session    Pointer to the session
+ *  @return             true if data is pending
+ */
+static bool VISA_isTxPending(const VISA_Session_t *p_Session)
+{
+    return (p_Session->TxOffset < p_Session->TxLength) || (p_Session->BlockOffset < p_Session->Block.Length) ||
+           p_Session->isTrailerPending;
+}
+
+/** @brief              Process a single command line and queue the response of the session.
+ *  @param p_Session    Pointer to the session
+ *  @param Command      Received command string without the line terminator
  */
-static int VISA_ProcessCommand(const char *Command, char *Response, size_t MaxLen)
+static void VISA_ProcessCommand(VISA_Session_t *p_Session, char *Command)
 {
-    char cmd_buffer[VISA_MAX_COMMAND_LENGTH];
+    int response_len;
+    size_t len;
 
-    if ((Command == NULL) || (Response == NULL)) {
-        return VISA_ERR_INVALID_ARG;
+    /* Remove trailing carriage return */
+    len = strlen(Command);
+    while ((len > 0) && (Command[len - 1] == '\r')) {
+        Command[--len] = '\0';
+    }
+
+    if (len == 0) {
+        return;
     }
 
     ESP_LOGD(TAG, "Processing command: %s", Command);
 
-    /* Remove trailing newline/carriage return */
-    strncpy(cmd_buffer, Command, sizeof(cmd_buffer) - 1);
-    cmd_buffer[sizeof(cmd_buffer) - 1] = '\0';
+    response_len = VISACommands_Execute(&p_Session->Commands, Command, p_Session->TxBuffer,
+                                        sizeof(p_Session->TxBuffer), &p_Session->Block);
 
-    size_t len = strlen(cmd_buffer);
-    while ((len > 0) && ((cmd_buffer[len - 1] == '\n') || (cmd_buffer[len - 1] == '\r'))) {
-        cmd_buffer[--len] = '\0';
-    }
+    p_Session->TxOffset = 0;
+    p_Session->BlockOffset = 0;
+
+    if (response_len > 0) {
+        p_Session->TxLength = response_len;
 
-    return VISACommands_Execute(cmd_buffer, Response, MaxLen);
+        /* A binary block follows its header straight from the frame buffer */
+        p_Session->isTrailerPending = (p_Session->Block.Data != NULL);
+    } else if (response_len < 0) {
+        /* Error response */
+        p_Session->TxLength = snprintf(p_Session->TxBuffer, sizeof(p_Session->TxBuffer), "ERROR: %d\n", response_len);
+    } else {
+        p_Session->TxLength = 0;
+    }
 }
 
-/** @brief              Handle client connection.
- *  @param ClientSocket Client socket descriptor
+/** @brief              Process all complete command lines of the receive buffer. Processing stops as soon as a
+ *                      response is pending, so the responses keep the order of the commands.
+ *  @param p_Session    Pointer to the session
  */
-static void VISA_HandleClient(int ClientSocket)
+static void VISA_ProcessLines(VISA_Session_t *p_Session)
 {
-    char rx_buffer[VISA_MAX_COMMAND_LENGTH];
-    char tx_buffer[VISA_MAX_RESPONSE_LENGTH];
-    struct timeval timeout;
+    while (VISA_isTxPending(p_Session) == false) {
+        char *end;
+        size_t line_len;
+
+        end = static_cast<char *>(memchr(p_Session->RxBuffer, '\n', p_Session->RxLength));
+        if (end == NULL) {
+            /* A command without terminator that fills the whole buffer can never complete */
+            if (p_Session->RxLength >= (sizeof(p_Session->RxBuffer) - 1)) {
+                ESP_LOGW(TAG, "Command too long, discarded");
+
+                p_Session->RxLength = 0;
+                p_Session->isDiscarding = true;
+                p_Session->TxOffset = 0;
+                p_Session->TxLength = snprintf(p_Session->TxBuffer, sizeof(p_Session->TxBuffer), "ERROR: %d\n",
+                                               SCPI_ERROR_COMMAND_ERROR);
+            }
 
-    timeout.tv_sec = VISA_SOCKET_TIMEOUT_MS / 1000;
-    timeout.tv_usec = (VISA_SOCKET_TIMEOUT_MS % 1000) * 1000;
+            return;
+        }
 
-    setsockopt(ClientSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-    setsockopt(ClientSocket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        *end = '\0';
+        line_len = (end - p_Session->RxBuffer) + 1;
 
-    ESP_LOGI(TAG, "Client connected");
+        VISA_ProcessCommand(p_Session, p_Session->RxBuffer);
 
-    while (_VISA_Server_State.isRunning) {
-        int len;
+        p_Session->RxLength -= line_len;
+        memmove(p_Session->RxBuffer, p_Session->RxBuffer + line_len, p_Session->RxLength);
+    }
+}
 
-        memset(rx_buffer, 0, sizeof(rx_buffer));
+/** @brief              Send as much of the pending response as the socket accepts without blocking.
+ *  @param p_Session    Pointer to the session
+ *  @return             false if the connection has failed
+ */
+static bool VISA_Flush(VISA_Session_t *p_Session)
+{
+    if (VISA_isTxPending(p_Session) == false) {
+        return true;
+    }
 
-        len = recv(ClientSocket, rx_buffer, sizeof(rx_buffer) - 1, 0);
+    while (VISA_isTxPending(p_Session)) {
+        const uint8_t *p_Data;
+        size_t *p_Offset;
+        size_t remaining;
+        size_t trailer_offset = 0;
+        int sent;
+
+        if (p_Session->TxOffset < p_Session->TxLength) {
+            p_Data = reinterpret_cast<const uint8_t *>(p_Session->TxBuffer) + p_Session->TxOffset;
+            p_Offset = &p_Session->TxOffset;
+            remaining = p_Session->TxLength - p_Session->TxOffset;
+        } else if (p_Session->BlockOffset < p_Session->Block.Length) {
+            p_Data = p_Session->Block.Data + p_Session->BlockOffset;
+            p_Offset = &p_Session->BlockOffset;
+            remaining = p_Session->Block.Length - p_Session->BlockOffset;
+        } else {
+            p_Data = reinterpret_cast<const uint8_t *>("\n");
+            p_Offset = &trailer_offset;
+            remaining = 1;
+        }
 
-        if (len < 0) {
+        sent = send(p_Session->Socket, p_Data, (remaining > VISA_BLOCK_CHUNK_SIZE) ? VISA_BLOCK_CHUNK_SIZE : remaining,
+                    MSG_DONTWAIT);
+        if (sent < 0) {
             if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
-                /* Timeout, continue */
-                continue;
+                return true;
             }
 
-            ESP_LOGE(TAG, "recv failed: errno %d!", errno);
+            ESP_LOGE(TAG, "send failed: %d!", errno);
 
-            break;
-        } else if (len == 0) {
-            ESP_LOGI(TAG, "Client disconnected");
+            return false;
+        }
 
-            break;
+        *p_Offset += sent;
+        p_Session->LastActivity = esp_timer_get_time();
+
+        if (p_Offset == &trailer_offset) {
+            p_Session->isTrailerPending = false;
+        }
+    }
+
+    /* Response complete, release the frame of the block and continue with the buffered commands */
+    ESP_LOGD(TAG, "Sent %u + %u bytes", static_cast<unsigned int>(p_Session->TxLength),
+             static_cast<unsigned int>(p_Session->Block.Length));
+
+    VISACommands_ReleaseBlock(&p_Session->Block);
+    p_Session->TxLength = 0;
+    p_Session->TxOffset = 0;
+    p_Session->BlockOffset = 0;
+
+    return true;
+}
+
+/** @brief              Process the buffered commands of a session and send their responses until the socket does
+ *                      not accept more data or no complete command is left.
+ *  @param p_Session    Pointer to the session
+ *  @return             false if the connection has failed
+ */
+static bool VISA_Service(VISA_Session_t *p_Session)
+{
+    do {
+        VISA_ProcessLines(p_Session);
+
+        if (VISA_Flush(p_Session) == false) {
+            return false;
         }
+    } while ((VISA_isTxPending(p_Session) == false) &&
+             (memchr(p_Session->RxBuffer, '\n', p_Session->RxLength) != NULL));
 
-        rx_buffer[len] = '\0';
-        ESP_LOGD(TAG, "Received: %s", rx_buffer);
+    return true;
+}
 
-        /* Process command */
-        memset(tx_buffer, 0, sizeof(tx_buffer));
-        int response_len = VISA_ProcessCommand(rx_buffer, tx_buffer, sizeof(tx_buffer));
+/** @brief              Receive data from a client and process the complete command lines.
+ *  @param p_Session    Pointer to the session
+ *  @return             false if the client has disconnected or the connection has failed
+ */
+static bool VISA_Receive(VISA_Session_t *p_Session)
+{
+    int len;
 
-        if (response_len > 0) {
-            int sent;
+    len = recv(p_Session->Socket, p_Session->RxBuffer + p_Session->RxLength,
+               sizeof(p_Session->RxBuffer) - 1 - p_Session->RxLength, MSG_DONTWAIT);
+    if (len < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            return true;
+        }
 
-            /* Send response */
-            sent = send(ClientSocket, tx_buffer, response_len, 0);
-            if (sent < 0) {
-                ESP_LOGE(TAG, "send failed: %d!", errno);
+        ESP_LOGE(TAG, "recv failed: errno %d!", errno);
 
-                break;
-            }
+        return false;
+    } else if (len == 0) {
+        ESP_LOGI(TAG, "Client disconnected");
+
+        return false;
+    }
+
+    p_Session->LastActivity = esp_timer_get_time();
 
-            ESP_LOGD(TAG, "Sent %d bytes", sent);
-        } else if (response_len < 0) {
-            /* Error response */
-            snprintf(tx_buffer, sizeof(tx_buffer), "ERROR: %d\n", response_len);
-            send(ClientSocket, tx_buffer, strlen(tx_buffer), 0);
+    if (p_Session->isDiscarding) {
+        char *end;
+
+        /* Drop the rest of an overlong command */
+        end = static_cast<char *>(memchr(p_Session->RxBuffer, '\n', len));
+        if (end == NULL) {
+            return true;
         }
+
+        len -= (end - p_Session->RxBuffer) + 1;
+        memmove(p_Session->RxBuffer, end + 1, len);
+        p_Session->isDiscarding = false;
     }
 
-    close(ClientSocket);
+    p_Session->RxLength += len;
+
+    return VISA_Service(p_Session);
+}
+
+/** @brief              Close a client connection and free the session slot.
+ *  @param p_Session    Pointer to the session
+ */
+static void VISA_CloseSession(VISA_Session_t *p_Session)
+{
+    if (p_Session->Socket < 0) {
+        return;
+    }
+
+    close(p_Session->Socket);
+    p_Session->Socket = -1;
+
+    VISACommands_ReleaseBlock(&p_Session->Block);
+    VISACommands_DeinitSession(&p_Session->Commands);
+
     ESP_LOGI(TAG, "Client connection closed");
 }
 
-/** @brief          VISA server task.
+/** @brief              Accept a new client and assign it to a free session slot.
+ */
+static void VISA_Accept(void)
+{
+    struct sockaddr_in source_addr;
+    socklen_t addr_len = sizeof(source_addr);
+    VISA_Session_t *p_Session = NULL;
+    int Socket;
+    char addr_str[16];
+
+    Socket = accept(_VISA_Server_State.ListenSocket, (struct sockaddr *)&source_addr, &addr_len);
+    if (Socket < 0) {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+            ESP_LOGE(TAG, "Unable to accept connection: errno %d!", errno);
+        }
+
+        return;
+    }
+
+    inet_ntop(AF_INET, &source_addr.sin_addr, addr_str, sizeof(addr_str));
+
+    for (size_t i = 0; i < VISA_MAX_CLIENTS; i++) {
+        if (_VISA_Server_State.Sessions[i].Socket < 0) {
+            p_Session = &_VISA_Server_State.Sessions[i];
+
+            break;
+        }
+    }
+
+    if (p_Session == NULL) {
+        ESP_LOGW(TAG, "Client from %s rejected, all %d sessions in use", addr_str, VISA_MAX_CLIENTS);
+
+        close(Socket);
+
+        return;
+    }
+
+    fcntl(Socket, F_SETFL, fcntl(Socket, F_GETFL, 0) | O_NONBLOCK);
+
+    memset(p_Session, 0, sizeof(VISA_Session_t));
+    p_Session->Socket = Socket;
+    p_Session->LastActivity = esp_timer_get_time();
+    VISACommands_InitSession(&p_Session->Commands);
+
+    ESP_LOGI(TAG, "Client connected from %s:%d", addr_str, ntohs(source_addr.sin_port));
+}
+
+/** @brief          VISA server task. Serves all clients with a single select() loop. A client only waits for readable
+ *                  data while no response is pending and for a writable socket while a response is pending, so a
+ *                  slow reader of a large image does not block the other clients.
  *  @param p_Args   Task arguments (unused)
  */
 static void VISA_ServerTask(void *p_Args)
@@ -157,11 +361,16 @@ static void VISA_ServerTask(void *p_Args)
     dest_addr.sin_family = AF_INET;
     dest_addr.sin_port = htons(VISA_SERVER_PORT);
 
+    for (size_t i = 0; i < VISA_MAX_CLIENTS; i++) {
+        _VISA_Server_State.Sessions[i].Socket = -1;
+    }
+
     _VISA_Server_State.ListenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
     if (_VISA_Server_State.ListenSocket < 0) {
         ESP_LOGE(TAG, "Unable to create socket: %d!", errno);
 
         _VISA_Server_State.isRunning = false;
+        _VISA_Server_State.ServerTask = NULL;
         vTaskDelete(NULL);
 
         return;
@@ -174,7 +383,9 @@ static void VISA_ServerTask(void *p_Args)
         ESP_LOGE(TAG, "Socket unable to bind: %d!", errno);
 
         close(_VISA_Server_State.ListenSocket);
+        _VISA_Server_State.ListenSocket = -1;
         _VISA_Server_State.isRunning = false;
+        _VISA_Server_State.ServerTask = NULL;
         vTaskDelete(NULL);
 
         return;
@@ -185,36 +396,98 @@ static void VISA_ServerTask(void *p_Args)
         ESP_LOGE(TAG, "Error occurred during listen: %d!", errno);
 
         close(_VISA_Server_State.ListenSocket);
+        _VISA_Server_State.ListenSocket = -1;
         _VISA_Server_State.isRunning = false;
+        _VISA_Server_State.ServerTask = NULL;
         vTaskDelete(NULL);
 
         return;
     }
 
+    fcntl(_VISA_Server_State.ListenSocket, F_SETFL, fcntl(_VISA_Server_State.ListenSocket, F_GETFL, 0) | O_NONBLOCK);
+
     ESP_LOGI(TAG, "VISA server listening on port %d", VISA_SERVER_PORT);
 
     while (_VISA_Server_State.isRunning) {
-        struct sockaddr_in source_addr;
-        socklen_t addr_len = sizeof(source_addr);
-        int Socket;
-        char addr_str[16];
+        fd_set read_set;
+        fd_set write_set;
+        struct timeval timeout;
+        int max_fd;
+        int64_t now;
 
-        Socket = accept(_VISA_Server_State.ListenSocket, (struct sockaddr *)&source_addr, &addr_len);
+        FD_ZERO(&read_set);
+        FD_ZERO(&write_set);
 
-        if (Socket < 0) {
-            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+        FD_SET(_VISA_Server_State.ListenSocket, &read_set);
+        max_fd = _VISA_Server_State.ListenSocket;
+
+        for (size_t i = 0; i < VISA_MAX_CLIENTS; i++) {
+            VISA_Session_t *p_Session = &_VISA_Server_State.Sessions[i];
+
+            if (p_Session->Socket < 0) {
                 continue;
             }
 
-            ESP_LOGE(TAG, "Unable to accept connection: errno %d!", errno);
+            if (VISA_isTxPending(p_Session)) {
+                FD_SET(p_Session->Socket, &write_set);
+            } else {
+                FD_SET(p_Session->Socket, &read_set);
+            }
+
+            if (p_Session->Socket > max_fd) {
+                max_fd = p_Session->Socket;
+            }
+        }
+
+        /* The timeout is needed to notice a stop request */
+        timeout.tv_sec = VISA_SELECT_TIMEOUT_MS / 1000;
+        timeout.tv_usec = (VISA_SELECT_TIMEOUT_MS % 1000) * 1000;
+
+        Error = select(max_fd + 1, &read_set, &write_set, NULL, &timeout);
+        if (Error < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            ESP_LOGE(TAG, "select failed: errno %d!", errno);
 
             break;
         }
 
-        inet_ntop(AF_INET, &source_addr.sin_addr, addr_str, sizeof(addr_str));
-        ESP_LOGI(TAG, "Client connected from %s:%d", addr_str, ntohs(source_addr.sin_port));
+        now = esp_timer_get_time();
+
+        for (size_t i = 0; i < VISA_MAX_CLIENTS; i++) {
+            VISA_Session_t *p_Session = &_VISA_Server_State.Sessions[i];
+            bool isOk = true;
+
+            if (p_Session->Socket < 0) {
+                continue;
+            }
 
-        VISA_HandleClient(Socket);
+            if (FD_ISSET(p_Session->Socket, &write_set)) {
+                /* Once the response is sent, the commands that arrived meanwhile are processed */
+                isOk = VISA_Flush(p_Session) && VISA_Service(p_Session);
+            } else if (FD_ISSET(p_Session->Socket, &read_set)) {
+                isOk = VISA_Receive(p_Session);
+            } else if (VISA_isTxPending(p_Session) &&
+                       ((now - p_Session->LastActivity) > (VISA_SOCKET_TIMEOUT_MS * 1000LL))) {
+                ESP_LOGW(TAG, "Client does not read the response, closing connection");
+
+                isOk = false;
+            }
+
+            if (isOk == false) {
+                VISA_CloseSession(p_Session);
+            }
+        }
+
+        if (FD_ISSET(_VISA_Server_State.ListenSocket, &read_set)) {
+            VISA_Accept();
+        }
+    }
+
+    for (size_t i = 0; i < VISA_MAX_CLIENTS; i++) {
+        VISA_CloseSession(&_VISA_Server_State.Sessions[i]);
     }
 
     close(_VISA_Server_State.ListenSocket);
@@ -222,6 +495,8 @@ static void VISA_ServerTask(void *p_Args)
     _VISA_Server_State.isRunning = false;
 
     ESP_LOGI(TAG, "VISA server stopped");
+
+    _VISA_Server_State.ServerTask = NULL;
     vTaskDelete(NULL);
 }
 
@@ -302,16 +577,7 @@ esp_err_t VISAServer_Start(void)
 
     _VISA_Server_State.isRunning = true;
 
-    BaseType_t result = xTaskCreate(
-                            VISA_ServerTask,
-                            "visa_server",
-                            4096,
-                            NULL,
-                            5,
-                            &_VISA_Server_State.ServerTask
-                        );
-
-    if (result != pdPASS) {
+    if (Topology_CreateTask(TOPOLOGY_TASK_VISA, VISA_ServerTask, NULL, &_VISA_Server_State.ServerTask) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to create server task!");
         _VISA_Server_State.isRunning = false;
         xSemaphoreGive(_VISA_Server_State.Mutex);
@@ -336,16 +602,13 @@ esp_err_t VISAServer_Stop(void)
 
     _VISA_Server_State.isRunning = false;
 
-    if (_VISA_Server_State.ListenSocket >= 0) {
-        shutdown(_VISA_Server_State.ListenSocket, SHUT_RDWR);
-        close(_VISA_Server_State.ListenSocket);
-        _VISA_Server_State.ListenSocket = -1;
+    /* The task closes all sockets itself when it leaves the select() loop */
+    for (uint32_t i = 0; (i < VISA_STOP_RETRIES) && (_VISA_Server_State.ServerTask != NULL); i++) {
+        vTaskDelay(pdMS_TO_TICKS(VISA_SELECT_TIMEOUT_MS / 5));
     }
 
-    /* Wait for task to terminate */
     if (_VISA_Server_State.ServerTask != NULL) {
-        vTaskDelay(pdMS_TO_TICKS(100));
-        _VISA_Server_State.ServerTask = NULL;
+        ESP_LOGW(TAG, "Server task did not terminate in time!");
     }
 
     xSemaphoreGive(_VISA_Server_State.Mutex);
@@ -35,7 +35,10 @@
 #define VISA_MAX_COMMAND_LENGTH             256     /**< Maximum command length */
 #define VISA_MAX_RESPONSE_LENGTH            1024    /**< Maximum response length */
 #define VISA_MAX_CLIENTS                    4       /**< Maximum concurrent clients */
-#define VISA_SOCKET_TIMEOUT_MS              5000    /**< Socket timeout in milliseconds */
+#define VISA_SOCKET_TIMEOUT_MS              5000    /**< Close a client that does not read a response for this time */
+#define VISA_SELECT_TIMEOUT_MS              500     /**< Maximum wait of the select() loop in milliseconds */
+#define VISA_STOP_RETRIES                   15      /**< Number of polls while waiting for the task to stop */
+#define VISA_BLOCK_CHUNK_SIZE               4096    /**< Bytes per send of a binary block */
 
 /** @brief VISA error codes */
 typedef enum {
@@ -0,0 +1,130 @@
+/*
+ * webAssets.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Pre-compressed static files of the web interface.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+
+#include <string.h>
+
+#include <sdkconfig.h>
+
+#include "webAssets.h"
+
+#define WEBASSETS_STRINGIFY(x)              #x
+#define WEBASSETS_TO_STRING(x)              WEBASSETS_STRINGIFY(x)
+
+static const char *TAG = "web_assets";
+
+/** @brief              Check if the client has the current version of a file.
+ *  @param p_Request    HTTP request handle
+ *  @param p_Asset      Requested file
+ *  @return             true if the If-None-Match header contains the ETag of the file
+ */
+static bool WebAssets_IsKnown(httpd_req_t *p_Request, const WebAssets_Asset_t *p_Asset)
+{
+    char Header[64] = {0};
+
+    if (httpd_req_get_hdr_value_str(p_Request, "If-None-Match", Header, sizeof(Header)) != ESP_OK) {
+        return false;
+    }
+
+    /* Also matches weak ETags of proxies and lists of ETags */
+    return strstr(Header, p_Asset->ETag) != NULL;
+}
+
+/** @brief              GET handler of a file. The file is the user context of the handler.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t WebAssets_Handler(httpd_req_t *p_Request)
+{
+    return WebAssets_Send(p_Request, reinterpret_cast<const WebAssets_Asset_t *>(p_Request->user_ctx));
+}
+
+const WebAssets_Asset_t *WebAssets_Find(const char *p_URI)
+{
+    size_t Length;
+
+    if (p_URI == NULL) {
+        return NULL;
+    }
+
+    Length = strcspn(p_URI, "?#");
+
+    for (size_t i = 0; i < WebAssets_Count; i++) {
+        if ((strncmp(WebAssets_Table[i].URI, p_URI, Length) == 0) && (WebAssets_Table[i].URI[Length] == '\0')) {
+            return &WebAssets_Table[i];
+        }
+    }
+
+    return NULL;
+}
+
+esp_err_t WebAssets_Send(httpd_req_t *p_Request, const WebAssets_Asset_t *p_Asset)
+{
+    if ((p_Request == NULL) || (p_Asset == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    httpd_resp_set_hdr(p_Request, "ETag", p_Asset->ETag);
+    httpd_resp_set_hdr(p_Request, "Cache-Control",
+                       "public, max-age=" WEBASSETS_TO_STRING(CONFIG_NETWORK_WEB_ASSETS_MAX_AGE));
+
+    if (WebAssets_IsKnown(p_Request, p_Asset)) {
+        ESP_LOGD(TAG, "%s not modified", p_Asset->URI);
+
+        httpd_resp_set_status(p_Request, "304 Not Modified");
+
+        return httpd_resp_send(p_Request, NULL, 0);
+    }
+
+    /* Every browser accepts gzip, so the file is never stored uncompressed */
+    httpd_resp_set_type(p_Request, p_Asset->Type);
+    httpd_resp_set_hdr(p_Request, "Content-Encoding", "gzip");
+    httpd_resp_set_hdr(p_Request, "Vary", "Accept-Encoding");
+
+    return httpd_resp_send(p_Request, reinterpret_cast<const char *>(p_Asset->Data), p_Asset->Length);
+}
+
+esp_err_t WebAssets_Register(httpd_handle_t Handle)
+{
+    esp_err_t Error;
+
+    /* One handler per file instead of a wildcard, so the files never hide the WebSocket or API handlers */
+    for (size_t i = 0; i < WebAssets_Count; i++) {
+        httpd_uri_t URI;
+
+        memset(&URI, 0, sizeof(URI));
+        URI.uri = WebAssets_Table[i].URI;
+        URI.method = HTTP_GET;
+        URI.handler = WebAssets_Handler;
+        URI.user_ctx = const_cast<WebAssets_Asset_t *>(&WebAssets_Table[i]);
+
+        Error = httpd_register_uri_handler(Handle, &URI);
+        if (Error != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to register %s: %d!", WebAssets_Table[i].URI, Error);
+            return Error;
+        }
+    }
+
+    return ESP_OK;
+}
@@ -0,0 +1,68 @@
+/*
+ * webAssets.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Pre-compressed static files of the web interface.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef WEBASSETS_H_
+#define WEBASSETS_H_
+
+#include <esp_err.h>
+#include <esp_http_server.h>
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** @brief Static file of the web interface. The table is generated by scripts/web_assets.py from the files in
+ *         webserver/ at build time.
+ */
+typedef struct {
+    const char *URI;                            /**< URI of the file, e.g. "/provision.html". */
+    const char *Type;                           /**< Content type. */
+    const char *ETag;                           /**< Quoted hash of the uncompressed content. */
+    const uint8_t *Data;                        /**< gzip compressed content. */
+    size_t Length;                              /**< Length of the compressed content in bytes. */
+} WebAssets_Asset_t;
+
+extern const WebAssets_Asset_t WebAssets_Table[];
+extern const size_t WebAssets_Count;
+
+/** @brief          Find a file of the web interface.
+ *  @param p_URI    URI of the file, a query string is ignored
+ *  @return         Pointer to the file or NULL if there is no file with this URI
+ */
+const WebAssets_Asset_t *WebAssets_Find(const char *p_URI);
+
+/** @brief              Send a file compressed with Content-Encoding gzip, ETag and Cache-Control headers. A
+ *                      request with a matching If-None-Match header is answered with 304.
+ *  @param p_Request    HTTP request handle
+ *  @param p_Asset      File to send
+ *  @return             ESP_OK on success
+ */
+esp_err_t WebAssets_Send(httpd_req_t *p_Request, const WebAssets_Asset_t *p_Asset);
+
+/** @brief          Register a GET handler for every file of the web interface. Needs WebAssets_Count URI
+ *                  handlers of the server.
+ *  @param Handle   HTTP server handle
+ *  @return         ESP_OK on success
+ */
+esp_err_t WebAssets_Register(httpd_handle_t Handle);
+
+#endif /* WEBASSETS_H_ */
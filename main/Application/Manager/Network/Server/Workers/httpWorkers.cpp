@@ -0,0 +1,284 @@
+/*
+ * httpWorkers.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Worker pool for the HTTP requests that would block the httpd task.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+
+#include <cstring>
+
+#include <sdkconfig.h>
+
+#include "httpWorkers.h"
+
+/** @brief Request in the queue of the workers. A job without handler stops the worker that takes it.
+ */
+typedef struct {
+    httpd_req_t *Request;                       /**< Detached asynchronous request. */
+    HTTP_Workers_Handler_t Handler;
+    HTTP_Workers_Class_t Class;
+    uint32_t Queued;                            /**< Time the request was queued in ms. */
+} HTTP_Workers_Job_t;
+
+/** @brief Name and limit of a request class.
+ */
+typedef struct {
+    const char *Name;
+    uint8_t Limit;                              /**< Requests of the class that are queued or running at once. */
+} HTTP_Workers_ClassInfo_t;
+
+typedef struct {
+    bool isInitialized;
+    QueueHandle_t Queue;
+    TaskHandle_t Workers[CONFIG_NETWORK_HTTP_WORKERS];
+    HTTP_Workers_Status_t Status;
+} HTTP_Workers_State_t;
+
+/** @brief Classes in the order of HTTP_Workers_Class_t. Only one firmware upload fits into the OTA writer and a
+ *         transfer holds the SD card or the flash for its whole response, so these classes take one worker at most.
+ */
+static const HTTP_Workers_ClassInfo_t _HTTP_Workers_Classes[HTTP_WORKERS_CLASS_COUNT] = {
+    {"image",       CONFIG_NETWORK_HTTP_WORKERS},
+    {"update",      1},
+    {"transfer",    1},
+};
+
+static HTTP_Workers_State_t _HTTP_Workers_State;
+
+/* Counters are updated by the httpd task and the workers */
+static portMUX_TYPE _HTTP_Workers_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *TAG = "http_workers";
+
+/** @brief          Worker task. Serves the requests of the queue until it takes a job without handler.
+ *  @param p_Param  Index of the worker
+ */
+static void HTTP_Workers_Task(void *p_Param)
+{
+    uint8_t Index = static_cast<uint8_t>(reinterpret_cast<uintptr_t>(p_Param));
+    HTTP_Workers_Job_t Job;
+
+    ESP_LOGD(TAG, "Worker %u started on core %d", Index, xPortGetCoreID());
+
+    while (true) {
+        uint32_t Wait;
+        esp_err_t Error;
+
+        if (xQueueReceive(_HTTP_Workers_State.Queue, &Job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        if (Job.Handler == NULL) {
+            break;
+        }
+
+        Wait = static_cast<uint32_t>(esp_timer_get_time() / 1000) - Job.Queued;
+
+        portENTER_CRITICAL(&_HTTP_Workers_Lock);
+        _HTTP_Workers_State.Status.Depth--;
+        if (Wait > _HTTP_Workers_State.Status.MaxWait) {
+            _HTTP_Workers_State.Status.MaxWait = Wait;
+        }
+        portEXIT_CRITICAL(&_HTTP_Workers_Lock);
+
+        Error = Job.Handler(Job.Request);
+        if (Error != ESP_OK) {
+            ESP_LOGD(TAG, "Request %s of class %s failed: %d", Job.Request->uri, _HTTP_Workers_Classes[Job.Class].Name,
+                     Error);
+        }
+
+        httpd_req_async_handler_complete(Job.Request);
+
+        portENTER_CRITICAL(&_HTTP_Workers_Lock);
+        _HTTP_Workers_State.Status.Classes[Job.Class].Active--;
+        _HTTP_Workers_State.Status.Classes[Job.Class].Done++;
+        portEXIT_CRITICAL(&_HTTP_Workers_Lock);
+    }
+
+    _HTTP_Workers_State.Workers[Index] = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t HTTP_Workers_Init(void)
+{
+    if (_HTTP_Workers_State.isInitialized) {
+        return ESP_OK;
+    }
+
+    memset(&_HTTP_Workers_State, 0, sizeof(_HTTP_Workers_State));
+
+    for (uint8_t i = 0; i < HTTP_WORKERS_CLASS_COUNT; i++) {
+        _HTTP_Workers_State.Status.Classes[i].Limit = _HTTP_Workers_Classes[i].Limit;
+    }
+
+    _HTTP_Workers_State.Queue = xQueueCreate(CONFIG_NETWORK_HTTP_WORKER_QUEUE, sizeof(HTTP_Workers_Job_t));
+    if (_HTTP_Workers_State.Queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create queue!");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (uint8_t i = 0; i < CONFIG_NETWORK_HTTP_WORKERS; i++) {
+        if (xTaskCreatePinnedToCore(HTTP_Workers_Task, "HTTP_Worker", CONFIG_NETWORK_HTTP_WORKER_TASK_STACKSIZE,
+                                    reinterpret_cast<void *>(static_cast<uintptr_t>(i)),
+                                    CONFIG_NETWORK_HTTP_WORKER_TASK_PRIO, &_HTTP_Workers_State.Workers[i],
+                                    CONFIG_NETWORK_HTTP_WORKER_TASK_CORE) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create worker %u!", i);
+
+            _HTTP_Workers_State.Status.Workers = i;
+            _HTTP_Workers_State.isInitialized = true;
+            HTTP_Workers_Deinit();
+
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    _HTTP_Workers_State.Status.Workers = CONFIG_NETWORK_HTTP_WORKERS;
+    _HTTP_Workers_State.isInitialized = true;
+
+    return ESP_OK;
+}
+
+void HTTP_Workers_Deinit(void)
+{
+    HTTP_Workers_Job_t Stop;
+
+    if (_HTTP_Workers_State.isInitialized == false) {
+        return;
+    }
+
+    /* New requests run in place from now on, every worker takes one stop job after the queued requests */
+    _HTTP_Workers_State.isInitialized = false;
+
+    memset(&Stop, 0, sizeof(Stop));
+    for (uint8_t i = 0; i < _HTTP_Workers_State.Status.Workers; i++) {
+        xQueueSend(_HTTP_Workers_State.Queue, &Stop, portMAX_DELAY);
+    }
+
+    for (uint8_t i = 0; i < CONFIG_NETWORK_HTTP_WORKERS; i++) {
+        while (_HTTP_Workers_State.Workers[i] != NULL) {
+            vTaskDelay(10 / portTICK_PERIOD_MS);
+        }
+    }
+
+    vQueueDelete(_HTTP_Workers_State.Queue);
+    _HTTP_Workers_State.Queue = NULL;
+    _HTTP_Workers_State.Status.Workers = 0;
+}
+
+esp_err_t HTTP_Workers_Run(httpd_req_t *p_Request, HTTP_Workers_Class_t Class, HTTP_Workers_Handler_t Handler)
+{
+    HTTP_Workers_ClassStatus_t *p_Class;
+    HTTP_Workers_Job_t Job;
+    bool isAccepted;
+
+    if ((p_Request == NULL) || (Handler == NULL) || (Class >= HTTP_WORKERS_CLASS_COUNT)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if ((_HTTP_Workers_State.isInitialized == false) || HTTP_Workers_isWorker()) {
+        return Handler(p_Request);
+    }
+
+    p_Class = &_HTTP_Workers_State.Status.Classes[Class];
+
+    /* The httpd task is the only producer, so the free space of the queue can only grow until the send */
+    portENTER_CRITICAL(&_HTTP_Workers_Lock);
+    isAccepted = (p_Class->Active < p_Class->Limit) && (uxQueueSpacesAvailable(_HTTP_Workers_State.Queue) > 0);
+    if (isAccepted) {
+        p_Class->Active++;
+    } else {
+        p_Class->Rejected++;
+    }
+    portEXIT_CRITICAL(&_HTTP_Workers_Lock);
+
+    if (isAccepted == false) {
+        ESP_LOGW(TAG, "Request %s of class %s rejected, %u active!", p_Request->uri, _HTTP_Workers_Classes[Class].Name,
+                 p_Class->Active);
+
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    /* Without the memory for the copy the request is served by the httpd task as before */
+    if (httpd_req_async_handler_begin(p_Request, &Job.Request) != ESP_OK) {
+        esp_err_t Error;
+
+        ESP_LOGW(TAG, "Failed to detach request %s!", p_Request->uri);
+
+        Error = Handler(p_Request);
+
+        portENTER_CRITICAL(&_HTTP_Workers_Lock);
+        p_Class->Active--;
+        portEXIT_CRITICAL(&_HTTP_Workers_Lock);
+
+        return Error;
+    }
+
+    Job.Handler = Handler;
+    Job.Class = Class;
+    Job.Queued = static_cast<uint32_t>(esp_timer_get_time() / 1000);
+
+    portENTER_CRITICAL(&_HTTP_Workers_Lock);
+    _HTTP_Workers_State.Status.Depth++;
+    if (_HTTP_Workers_State.Status.Depth > _HTTP_Workers_State.Status.MaxDepth) {
+        _HTTP_Workers_State.Status.MaxDepth = _HTTP_Workers_State.Status.Depth;
+    }
+    portEXIT_CRITICAL(&_HTTP_Workers_Lock);
+
+    xQueueSend(_HTTP_Workers_State.Queue, &Job, portMAX_DELAY);
+
+    return ESP_OK;
+}
+
+bool HTTP_Workers_isWorker(void)
+{
+    TaskHandle_t Current = xTaskGetCurrentTaskHandle();
+
+    for (uint8_t i = 0; i < CONFIG_NETWORK_HTTP_WORKERS; i++) {
+        if ((_HTTP_Workers_State.Workers[i] != NULL) && (_HTTP_Workers_State.Workers[i] == Current)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+esp_err_t HTTP_Workers_GetStatus(HTTP_Workers_Status_t *p_Status)
+{
+    if (p_Status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&_HTTP_Workers_Lock);
+    *p_Status = _HTTP_Workers_State.Status;
+    portEXIT_CRITICAL(&_HTTP_Workers_Lock);
+
+    return ESP_OK;
+}
+
+const char *HTTP_Workers_GetClassName(HTTP_Workers_Class_t Class)
+{
+    return (Class < HTTP_WORKERS_CLASS_COUNT) ? _HTTP_Workers_Classes[Class].Name : "unknown";
+}
@@ -0,0 +1,109 @@
+/*
+ * httpWorkers.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Worker pool for the HTTP requests that would block the httpd task.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef HTTP_WORKERS_H_
+#define HTTP_WORKERS_H_
+
+#include <esp_err.h>
+#include <esp_http_server.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Classes of the requests on the worker pool. Every class has its own limit of requests that are queued or
+ *         running, so one kind of request can not take all workers.
+ */
+typedef enum {
+    HTTP_WORKERS_CLASS_IMAGE = 0,               /**< Encoded images (GET /api/v1/image). */
+    HTTP_WORKERS_CLASS_UPDATE,                  /**< Firmware uploads (POST /api/v1/update). */
+    HTTP_WORKERS_CLASS_TRANSFER,                /**< Large responses from the SD card, the flash log or the trace. */
+    HTTP_WORKERS_CLASS_COUNT,
+} HTTP_Workers_Class_t;
+
+/** @brief              Handler of a request on a worker.
+ *  @param p_Request    Request, a copy of httpd_req_async_handler_begin
+ *  @return             ESP_OK on success
+ */
+typedef esp_err_t (*HTTP_Workers_Handler_t)(httpd_req_t *p_Request);
+
+/** @brief Counters of a request class.
+ */
+typedef struct {
+    uint8_t Active;                             /**< Requests that are queued or running. */
+    uint8_t Limit;                              /**< Maximum of Active, more requests are rejected. */
+    uint32_t Done;                              /**< Requests served by a worker since the start. */
+    uint32_t Rejected;                          /**< Requests rejected since the start. */
+} HTTP_Workers_ClassStatus_t;
+
+/** @brief Counters of the worker pool.
+ */
+typedef struct {
+    uint8_t Workers;                            /**< Number of worker tasks, 0 if the pool is not running. */
+    uint8_t Depth;                              /**< Requests waiting for a worker. */
+    uint8_t MaxDepth;                           /**< Maximum of Depth since the start. */
+    uint32_t MaxWait;                           /**< Longest wait of a request for a worker in ms. */
+    HTTP_Workers_ClassStatus_t Classes[HTTP_WORKERS_CLASS_COUNT];
+} HTTP_Workers_Status_t;
+
+/** @brief  Start the CONFIG_NETWORK_HTTP_WORKERS worker tasks.
+ *  @return ESP_OK on success
+ *          ESP_ERR_NO_MEM if the queue or a task can not be created
+ */
+esp_err_t HTTP_Workers_Init(void);
+
+/** @brief Stop the worker tasks. The requests in the queue are served before.
+ */
+void HTTP_Workers_Deinit(void);
+
+/** @brief              Serve a request on the worker pool. Call from the handler of the httpd task. The request is
+ *                      detached with httpd_req_async_handler_begin and Handler runs on a worker, so the httpd task is
+ *                      free for the next request right away. Handler runs in place on a worker, without the pool
+ *                      or when the request can not be detached.
+ *  @param p_Request    HTTP request handle
+ *  @param Class        Request class
+ *  @param Handler      Handler of the request
+ *  @return             ESP_OK if the request is queued, the return value of Handler if it runs in place
+ *                      ESP_ERR_NOT_FINISHED if the class is at its limit or the queue is full. The request is not
+ *                      answered, the caller should answer with 503
+ */
+esp_err_t HTTP_Workers_Run(httpd_req_t *p_Request, HTTP_Workers_Class_t Class, HTTP_Workers_Handler_t Handler);
+
+/** @brief  Check if the caller is a worker task.
+ *  @return true on a worker task
+ */
+bool HTTP_Workers_isWorker(void);
+
+/** @brief              Get the counters of the worker pool.
+ *  @param p_Status     Pointer to store the counters
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if p_Status is NULL
+ */
+esp_err_t HTTP_Workers_GetStatus(HTTP_Workers_Status_t *p_Status);
+
+/** @brief          Get the name of a request class.
+ *  @param Class    Request class
+ *  @return         Name of the class or "unknown"
+ */
+const char *HTTP_Workers_GetClassName(HTTP_Workers_Class_t Class);
+
+#endif /* HTTP_WORKERS_H_ */
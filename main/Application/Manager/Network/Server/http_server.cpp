@@ -25,21 +25,75 @@
 #include <esp_timer.h>
 #include <esp_ota_ops.h>
 #include <esp_system.h>
-#include <esp_wifi.h>
-#include <esp_heap_caps.h>
 
 #include <sys/time.h>
+#include <sys/stat.h>
+#include <dirent.h>
 
 #include <cJSON.h>
+#include <cstdlib>
 #include <cstring>
 
 #include "http_server.h"
 #include "../networkTypes.h"
 #include "ImageEncoder/imageEncoder.h"
+#include "Telemetry/telemetry.h"
+#include "Metrics/metrics.h"
+#include "RTP/rtpStreamer.h"
+#include "OTA/otaWriter.h"
+#include "Download/fileReader.h"
+#include "WebAssets/webAssets.h"
+#include "Workers/httpWorkers.h"
+#include "Application/Boot/boot.h"
+#include "Application/Topology/topology.h"
+#include "Application/Trace/trace.h"
+#include "Application/Memory/memoryPlan.h"
+#include "Application/Benchmark/benchmark.h"
+#include "Application/Manager/SD/sdManager.h"
+#include "Application/Manager/SD/sdSnapshot.h"
+#include "Application/Manager/Flash/flashLog.h"
+#include "Application/Manager/Time/timeManager.h"
 #include "../Provisioning/provisionHandlers.h"
 
 #define HTTP_SERVER_API_BASE_PATH           "/api/v1"
 #define HTTP_SERVER_API_KEY_HEADER          "X-API-Key"
+#define HTTP_SERVER_STREAM_BOUNDARY         "pyrovision-frame"
+
+/** @brief MJPEG stream of one client. The request is detached from the httpd task and served by a task of its own.
+ */
+typedef struct {
+    bool isActive;
+    httpd_req_t *Request;                   /**< Detached asynchronous request. */
+    TaskHandle_t Task;
+    Server_Palette_t Palette;
+    Network_ImageLevel_t Level;             /**< Pyramid level of the stream. */
+    Network_ImageWindow_t Window;           /**< Crop window of the stream, Width 0 for the full frame. */
+    uint32_t Sequence;                      /**< Sequence number of the last sent frame. */
+} HTTP_Stream_t;
+
+/** @brief Download of one SD card file. The request is detached from the httpd task and served by a task of its own.
+ */
+typedef struct {
+    bool isActive;
+    httpd_req_t *Request;                   /**< Detached asynchronous request. */
+    TaskHandle_t Task;
+    FileReader_Handle_t Reader;
+    char ContentRange[48];                  /**< Value of the Content-Range header, valid until the response is sent. */
+    char Disposition[48];                   /**< Value of the Content-Disposition header. */
+} HTTP_Download_t;
+
+/** @brief Long poll of one client. The request is detached from the httpd task and answered by the wait task.
+ */
+typedef struct {
+    bool isActive;
+    httpd_req_t *Request;                   /**< Detached asynchronous request. */
+    Network_ImageFormat_t Format;
+    Server_Palette_t Palette;
+    Network_ImageWindow_t Window;           /**< Crop window, Width 0 for the full frame. */
+    uint32_t Sequence;                      /**< The request is answered with the first frame after this one. */
+    uint32_t Known;                         /**< Sequence number of the If-None-Match ETag, 0 if none. */
+    uint32_t Deadline;                      /**< End of the wait in ms. */
+} HTTP_Waiter_t;
 
 typedef struct {
     bool isInitialized;
@@ -49,6 +103,12 @@ typedef struct {
     Network_Thermal_Frame_t *ThermalFrame;
     uint32_t RequestCount;
     uint32_t StartTime;
+    HTTP_Stream_t Streams[HTTP_SERVER_MAX_STREAMS];
+    HTTP_Waiter_t Waiters[HTTP_SERVER_MAX_WAITERS];
+    HTTP_Download_t Downloads[CONFIG_NETWORK_DOWNLOAD_MAX];
+    TaskHandle_t WaitTask;                  /**< Task of the long polls, created with the first long poll. */
+    SemaphoreHandle_t StreamMutex;          /**< Protects the task handles of the streams, the long polls and the
+                                                 downloads. */
 } HTTP_Server_State_t;
 
 static HTTP_Server_State_t _HTTPServer_State;
@@ -133,6 +193,30 @@ static esp_err_t HTTP_Server_SendError(httpd_req_t *p_Request, int StatusCode, c
     return Error;
 }
 
+/** @brief              Serve a request on the worker pool. A rejected request is answered with 503 and Retry-After,
+ *                      so the client backs off instead of holding a socket of the httpd task.
+ *  @param p_Request    HTTP request handle
+ *  @param Class        Request class
+ *  @param Handler      Handler of the request
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Server_RunWorker(httpd_req_t *p_Request, HTTP_Workers_Class_t Class,
+                                       HTTP_Workers_Handler_t Handler)
+{
+    esp_err_t Error;
+
+    Error = HTTP_Workers_Run(p_Request, Class, Handler);
+    if (Error != ESP_ERR_NOT_FINISHED) {
+        return Error;
+    }
+
+    _HTTPServer_State.RequestCount++;
+
+    httpd_resp_set_hdr(p_Request, "Retry-After", "1");
+
+    return HTTP_Server_SendError(p_Request, 503, "Server busy");
+}
+
 /** @brief              Parse JSON from request body.
  *  @param p_Request    HTTP request handle
  *  @return             cJSON object or NULL on error
@@ -144,20 +228,20 @@ static cJSON *HTTP_Server_ParseJSON(httpd_req_t *p_Request)
         return NULL;
     }
 
-    char *Buffer = (char *)heap_caps_malloc(ContentLen + 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    char *Buffer = reinterpret_cast<char *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, ContentLen + 1, "http_body"));
     if (Buffer == NULL) {
         return NULL;
     }
 
     int Received = httpd_req_recv(p_Request, Buffer, ContentLen);
     if (Received != ContentLen) {
-        free(Buffer);
+        MemoryPlan_Free(Buffer);
         return NULL;
     }
 
     Buffer[ContentLen] = '\0';
     cJSON *Json = cJSON_Parse(Buffer);
-    free(Buffer);
+    MemoryPlan_Free(Buffer);
 
     return Json;
 }
@@ -189,12 +273,8 @@ static esp_err_t HTTP_Handler_Time(httpd_req_t *p_Request)
         return HTTP_Server_SendError(p_Request, 400, "Missing epoch field");
     }
 
-    /* Set system time */
-    struct timeval tv = {
-        .tv_sec = (time_t)epoch->valuedouble,
-        .tv_usec = 0,
-    };
-    settimeofday(&tv, NULL);
+    /* Set system time, the time manager takes the new time for the frame timestamps */
+    TimeManager_SetTimestamp((time_t)epoch->valuedouble);
 
     /* Set timezone if provided */
     if (cJSON_IsString(timezone) && (timezone->valuestring != NULL)) {
@@ -206,234 +286,1689 @@ static esp_err_t HTTP_Handler_Time(httpd_req_t *p_Request)
 
     cJSON_Delete(json);
 
-    /* Send response */
-    cJSON *response = cJSON_CreateObject();
-    cJSON_AddStringToObject(response, "status", "ok");
+    /* Send response */
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "status", "ok");
+    Error = HTTP_Server_SendJSON(p_Request, response, 200);
+    cJSON_Delete(response);
+
+    return Error;
+}
+
+/** @brief              Build the ETag of an image. The ETag changes with every frame, images of a crop window
+ *                      carry the window.
+ *  @param p_Buffer     Output buffer
+ *  @param Size         Size of the output buffer
+ *  @param Sequence     Frame sequence number
+ *  @param Format       Image format
+ *  @param Palette      Color palette
+ *  @param p_Window     Crop window
+ */
+static void HTTP_Server_GetETag(char *p_Buffer, size_t Size, uint32_t Sequence, Network_ImageFormat_t Format,
+                               Server_Palette_t Palette, const Network_ImageWindow_t *p_Window)
+{
+    if (p_Window->Width == 0) {
+        snprintf(p_Buffer, Size, "\"%u-%d-%d\"", static_cast<unsigned int>(Sequence), Format, Palette);
+    } else {
+        snprintf(p_Buffer, Size, "\"%u-%d-%d-%u.%u.%u.%u.%u\"", static_cast<unsigned int>(Sequence), Format, Palette,
+                 p_Window->X, p_Window->Y, p_Window->Width, p_Window->Height, p_Window->Zoom);
+    }
+}
+
+/** @brief              Get the frame sequence number of the If-None-Match header of a request.
+ *  @param p_Request    HTTP request handle
+ *  @param Format       Requested image format
+ *  @param Palette      Requested color palette
+ *  @param p_Window     Requested crop window
+ *  @return             Sequence number or 0 if the header is missing or belongs to another format, palette or
+ *                      window
+ */
+static uint32_t HTTP_Server_GetKnownSequence(httpd_req_t *p_Request, Network_ImageFormat_t Format,
+                                            Server_Palette_t Palette, const Network_ImageWindow_t *p_Window)
+{
+    char Header[64] = {0};
+    char ETag[48];
+    const char *p_Tag;
+    unsigned int Sequence;
+
+    if (httpd_req_get_hdr_value_str(p_Request, "If-None-Match", Header, sizeof(Header)) != ESP_OK) {
+        return 0;
+    }
+
+    /* Weak ETags of proxies are compared like strong ones */
+    p_Tag = (strncmp(Header, "W/", 2) == 0) ? (Header + 2) : Header;
+    if (sscanf(p_Tag, "\"%u-", &Sequence) != 1) {
+        return 0;
+    }
+
+    HTTP_Server_GetETag(ETag, sizeof(ETag), Sequence, Format, Palette, p_Window);
+
+    return (strcmp(p_Tag, ETag) == 0) ? Sequence : 0;
+}
+
+/** @brief              Send the current thermal frame as image or 304 if the client has the frame already.
+ *  @param p_Request    HTTP request handle
+ *  @param Format       Image format
+ *  @param Palette      Color palette
+ *  @param p_Window     Crop window
+ *  @param Known        Sequence number of the frame the client has, 0 if none
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Server_SendImage(httpd_req_t *p_Request, Network_ImageFormat_t Format, Server_Palette_t Palette,
+                                       const Network_ImageWindow_t *p_Window, uint32_t Known)
+{
+    esp_err_t Error;
+    Network_Encoded_Image_t encoded;
+    char ETag[48];
+    char Time[24];
+
+    if (xSemaphoreTake(_HTTPServer_State.ThermalFrame->mutex, 100 / portTICK_PERIOD_MS) != pdTRUE) {
+        return HTTP_Server_SendError(p_Request, 503, "Frame busy");
+    }
+
+    HTTP_Server_GetETag(ETag, sizeof(ETag), _HTTPServer_State.ThermalFrame->sequence, Format, Palette, p_Window);
+
+    /* Repeated requests for the same frame are answered without encoding */
+    if ((Known != 0) && (Known == _HTTPServer_State.ThermalFrame->sequence)) {
+        xSemaphoreGive(_HTTPServer_State.ThermalFrame->mutex);
+
+        httpd_resp_set_status(p_Request, "304 Not Modified");
+        httpd_resp_set_hdr(p_Request, "ETag", ETag);
+
+        if (_HTTPServer_State.Config.EnableCORS) {
+            httpd_resp_set_hdr(p_Request, "Access-Control-Allow-Origin", "*");
+        }
+
+        return httpd_resp_send(p_Request, NULL, 0);
+    }
+
+    Error = ImageEncoder_EncodeView(_HTTPServer_State.ThermalFrame, Format, Palette, 0, NETWORK_IMAGE_LEVEL_NATIVE,
+                                    p_Window, &encoded);
+
+    xSemaphoreGive(_HTTPServer_State.ThermalFrame->mutex);
+
+    if (Error == ESP_ERR_NOT_SUPPORTED) {
+        return HTTP_Server_SendError(p_Request, 400, "Format not available for this frame");
+    } else if (Error != ESP_OK) {
+        return HTTP_Server_SendError(p_Request, 500, "Image encoding failed");
+    }
+
+    /* Set content type */
+    switch (Format) {
+        case NETWORK_IMAGE_FORMAT_JPEG:
+            httpd_resp_set_type(p_Request, "image/jpeg");
+            break;
+        case NETWORK_IMAGE_FORMAT_PNG:
+            httpd_resp_set_type(p_Request, "image/png");
+            break;
+        case NETWORK_IMAGE_FORMAT_RAW:
+        case NETWORK_IMAGE_FORMAT_INDEXED:
+        case NETWORK_IMAGE_FORMAT_TEMPERATURE:
+        default:
+            httpd_resp_set_type(p_Request, "application/octet-stream");
+            break;
+    }
+
+    /* httpd keeps a pointer to the value, ETag stays valid until the response is sent */
+    httpd_resp_set_hdr(p_Request, "ETag", ETag);
+    httpd_resp_set_hdr(p_Request, "Cache-Control", "no-cache");
+
+    /* UTC capture time in microseconds, omitted while the time of the camera is not set */
+    if (encoded.time != 0) {
+        snprintf(Time, sizeof(Time), "%lld", static_cast<long long>(encoded.time));
+        httpd_resp_set_hdr(p_Request, "X-Capture-Time", Time);
+    }
+
+    if (_HTTPServer_State.Config.EnableCORS) {
+        httpd_resp_set_hdr(p_Request, "Access-Control-Allow-Origin", "*");
+        httpd_resp_set_hdr(p_Request, "Access-Control-Expose-Headers", "ETag, X-Capture-Time");
+    }
+
+    /* Send image data */
+    Error = httpd_resp_send(p_Request, (const char *)encoded.data, encoded.size);
+    if (Error == ESP_OK) {
+        Boot_Mark(BOOT_PHASE_FIRST_NETWORK);
+        Telemetry_FrameSent();
+    }
+
+    ImageEncoder_Free(&encoded);
+
+    return Error;
+}
+
+/** @brief          Wait task function. Answers the long polls with the next frame or at the end of their wait time.
+ *  @param p_Param  Task parameter (unused)
+ */
+static void HTTP_WaitTask(void *p_Param)
+{
+    ESP_LOGD(TAG, "Long poll task started");
+
+    while (_HTTPServer_State.isRunning) {
+        uint32_t Now;
+        uint32_t Sequence;
+
+        /* Wake up with every frame and in between for the deadlines */
+        ulTaskNotifyTake(pdTRUE, 100 / portTICK_PERIOD_MS);
+
+        if (_HTTPServer_State.ThermalFrame == NULL) {
+            continue;
+        }
+
+        Now = esp_timer_get_time() / 1000;
+        Sequence = _HTTPServer_State.ThermalFrame->sequence;
+
+        for (uint8_t i = 0; i < HTTP_SERVER_MAX_WAITERS; i++) {
+            HTTP_Waiter_t *Waiter = &_HTTPServer_State.Waiters[i];
+
+            /* Only this task completes a waiter, so the slot can be read without the mutex */
+            if ((Waiter->isActive == false) || (Waiter->Request == NULL) ||
+                ((Sequence == Waiter->Sequence) && (static_cast<int32_t>(Now - Waiter->Deadline) < 0))) {
+                continue;
+            }
+
+            HTTP_Server_SendImage(Waiter->Request, Waiter->Format, Waiter->Palette, &Waiter->Window, Waiter->Known);
+            httpd_req_async_handler_complete(Waiter->Request);
+
+            xSemaphoreTake(_HTTPServer_State.StreamMutex, portMAX_DELAY);
+            Waiter->Request = NULL;
+            Waiter->isActive = false;
+            xSemaphoreGive(_HTTPServer_State.StreamMutex);
+        }
+    }
+
+    /* Release the pending requests of a stopped server */
+    xSemaphoreTake(_HTTPServer_State.StreamMutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < HTTP_SERVER_MAX_WAITERS; i++) {
+        HTTP_Waiter_t *Waiter = &_HTTPServer_State.Waiters[i];
+
+        if (Waiter->isActive && (Waiter->Request != NULL)) {
+            HTTP_Server_SendError(Waiter->Request, 503, "Server stopped");
+            httpd_req_async_handler_complete(Waiter->Request);
+        }
+
+        Waiter->Request = NULL;
+        Waiter->isActive = false;
+    }
+
+    _HTTPServer_State.WaitTask = NULL;
+    xSemaphoreGive(_HTTPServer_State.StreamMutex);
+
+    ESP_LOGD(TAG, "Long poll task stopped");
+
+    vTaskDelete(NULL);
+}
+
+/** @brief              Hand a request over to the wait task.
+ *  @param p_Request    HTTP request handle
+ *  @param Format       Image format
+ *  @param Palette      Color palette
+ *  @param p_Window     Crop window
+ *  @param Known        Sequence number of the If-None-Match ETag, 0 if none
+ *  @param Wait         Wait time in ms
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Server_StartWait(httpd_req_t *p_Request, Network_ImageFormat_t Format, Server_Palette_t Palette,
+                                       const Network_ImageWindow_t *p_Window, uint32_t Known, uint32_t Wait)
+{
+    HTTP_Waiter_t *Waiter = NULL;
+    httpd_req_t *Request;
+
+    if (httpd_req_async_handler_begin(p_Request, &Request) != ESP_OK) {
+        return HTTP_Server_SendError(p_Request, 500, "Failed to start long poll");
+    }
+
+    xSemaphoreTake(_HTTPServer_State.StreamMutex, portMAX_DELAY);
+
+    if (_HTTPServer_State.WaitTask == NULL) {
+        if (Topology_CreateTask(TOPOLOGY_TASK_HTTP_WAIT, HTTP_WaitTask, NULL, &_HTTPServer_State.WaitTask) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create long poll task!");
+            _HTTPServer_State.WaitTask = NULL;
+        }
+    }
+
+    if (_HTTPServer_State.WaitTask != NULL) {
+        for (uint8_t i = 0; i < HTTP_SERVER_MAX_WAITERS; i++) {
+            if (_HTTPServer_State.Waiters[i].isActive == false) {
+                Waiter = &_HTTPServer_State.Waiters[i];
+                Waiter->Format = Format;
+                Waiter->Palette = Palette;
+                Waiter->Window = *p_Window;
+                Waiter->Sequence = _HTTPServer_State.ThermalFrame->sequence;
+                Waiter->Known = Known;
+                Waiter->Deadline = (esp_timer_get_time() / 1000) + Wait;
+                Waiter->Request = Request;
+                Waiter->isActive = true;
+                break;
+            }
+        }
+    }
+
+    xSemaphoreGive(_HTTPServer_State.StreamMutex);
+
+    /* Answer immediately if no slot is free */
+    if (Waiter == NULL) {
+        HTTP_Server_SendImage(Request, Format, Palette, p_Window, Known);
+        httpd_req_async_handler_complete(Request);
+    }
+
+    return ESP_OK;
+}
+
+/** @brief              Parse the crop window of a query: "crop" as "x,y,width,height" in pixels of the native frame
+ *                      and "zoom" (1 to IMAGE_ENCODER_MAX_ZOOM). The encoder clips the window to the frame.
+ *  @param p_Query      Query string
+ *  @param p_Window     Pointer to store the window, Width 0 without "crop"
+ */
+static void HTTP_Server_ParseWindow(const char *p_Query, Network_ImageWindow_t *p_Window)
+{
+    char param[32];
+    unsigned int Region[4];
+
+    memset(p_Window, 0, sizeof(Network_ImageWindow_t));
+
+    if ((httpd_query_key_value(p_Query, "crop", param, sizeof(param)) != ESP_OK) ||
+        (sscanf(param, "%u,%u,%u,%u", &Region[0], &Region[1], &Region[2], &Region[3]) != 4)) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < 4; i++) {
+        Region[i] = (Region[i] > UINT16_MAX) ? UINT16_MAX : Region[i];
+    }
+
+    p_Window->X = Region[0];
+    p_Window->Y = Region[1];
+    p_Window->Width = Region[2];
+    p_Window->Height = Region[3];
+    p_Window->Zoom = 1;
+
+    if (httpd_query_key_value(p_Query, "zoom", param, sizeof(param)) == ESP_OK) {
+        unsigned long Zoom = strtoul(param, NULL, 10);
+
+        p_Window->Zoom = (Zoom > IMAGE_ENCODER_MAX_ZOOM) ? IMAGE_ENCODER_MAX_ZOOM : static_cast<uint8_t>(Zoom);
+    }
+}
+
+/** @brief              Parse the query of an image request.
+ *  @param p_Request    HTTP request handle
+ *  @param p_Format     Pointer to store the image format, JPEG without "format"
+ *  @param p_Palette    Pointer to store the color palette, iron without "palette"
+ *  @param p_Window     Pointer to store the crop window, see HTTP_Server_ParseWindow
+ *  @param p_Wait       Pointer to store the wait time in ms, 0 without "wait"
+ */
+static void HTTP_Server_ParseImageQuery(httpd_req_t *p_Request, Network_ImageFormat_t *p_Format,
+                                        Server_Palette_t *p_Palette, Network_ImageWindow_t *p_Window, uint32_t *p_Wait)
+{
+    char query[128] = {0};
+
+    *p_Format = NETWORK_IMAGE_FORMAT_JPEG;
+    *p_Palette = PALETTE_IRON;
+    *p_Wait = 0;
+    memset(p_Window, 0, sizeof(Network_ImageWindow_t));
+
+    if (httpd_req_get_url_query_str(p_Request, query, sizeof(query)) == ESP_OK) {
+        char param[32];
+        if (httpd_query_key_value(query, "format", param, sizeof(param)) == ESP_OK) {
+            if (strcmp(param, "png") == 0) {
+                *p_Format = NETWORK_IMAGE_FORMAT_PNG;
+            } else if (strcmp(param, "raw") == 0) {
+                *p_Format = NETWORK_IMAGE_FORMAT_RAW;
+            } else if (strcmp(param, "indexed") == 0) {
+                *p_Format = NETWORK_IMAGE_FORMAT_INDEXED;
+            } else if (strcmp(param, "temperature") == 0) {
+                *p_Format = NETWORK_IMAGE_FORMAT_TEMPERATURE;
+            }
+        }
+        if (httpd_query_key_value(query, "palette", param, sizeof(param)) == ESP_OK) {
+            /* Unknown names keep the default palette */
+            ImageEncoder_GetPaletteByName(param, p_Palette);
+        }
+        if (httpd_query_key_value(query, "wait", param, sizeof(param)) == ESP_OK) {
+            *p_Wait = strtoul(param, NULL, 10);
+            *p_Wait = (*p_Wait > HTTP_SERVER_MAX_WAIT_MS) ? HTTP_SERVER_MAX_WAIT_MS : *p_Wait;
+        }
+
+        HTTP_Server_ParseWindow(query, p_Window);
+    }
+}
+
+/** @brief              Encode and send the image of a request on a worker.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Worker_Image(httpd_req_t *p_Request)
+{
+    Network_ImageFormat_t format;
+    Server_Palette_t palette;
+    Network_ImageWindow_t window;
+    uint32_t Wait;
+
+    HTTP_Server_ParseImageQuery(p_Request, &format, &palette, &window, &Wait);
+
+    return HTTP_Server_SendImage(p_Request, format, palette, &window,
+                                 HTTP_Server_GetKnownSequence(p_Request, format, palette, &window));
+}
+
+/** @brief              Handler for GET /api/v1/image.
+ *                      Optional query parameters: "format", "palette", "crop", "zoom" and "wait". Every frame has
+ *                      its own ETag, a request with the ETag of the current frame in If-None-Match gets 304
+ *                      without encoding. With "wait" (in ms) a request for the current frame is answered with the
+ *                      next frame or at the end of the wait time, so pollers follow the frame rate of the camera.
+ *                      The encoding runs on the worker pool.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Handler_Image(httpd_req_t *p_Request)
+{
+    Network_ImageFormat_t format;
+    Server_Palette_t palette;
+    Network_ImageWindow_t window;
+    uint32_t Wait;
+    uint32_t Known;
+
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    } else if (_HTTPServer_State.ThermalFrame == NULL) {
+        return HTTP_Server_SendError(p_Request, 503, "No thermal data available");
+    }
+
+    HTTP_Server_ParseImageQuery(p_Request, &format, &palette, &window, &Wait);
+    Known = HTTP_Server_GetKnownSequence(p_Request, format, palette, &window);
+
+    /* Wait for the next frame if the client has the current one or asks for the next one without an ETag */
+    if ((Wait > 0) && ((Known == 0) || (Known == _HTTPServer_State.ThermalFrame->sequence))) {
+        return HTTP_Server_StartWait(p_Request, format, palette, &window, Known, Wait);
+    }
+
+    return HTTP_Server_RunWorker(p_Request, HTTP_WORKERS_CLASS_IMAGE, HTTP_Worker_Image);
+}
+
+/** @brief              Handler for GET /api/v1/telemetry.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Handler_Telemetry(httpd_req_t *p_Request)
+{
+    Telemetry_Snapshot_t Snapshot;
+
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    }
+
+    /* The snapshot is shared with the WebSocket clients and already serialized */
+    if (Telemetry_Get(TELEMETRY_MAX_AGE_MS, &Snapshot) != ESP_OK) {
+        return HTTP_Server_SendError(p_Request, 503, "Telemetry not available");
+    }
+
+    httpd_resp_set_type(p_Request, "application/json");
+    httpd_resp_set_hdr(p_Request, "Cache-Control", "no-cache");
+
+    if (_HTTPServer_State.Config.EnableCORS) {
+        httpd_resp_set_hdr(p_Request, "Access-Control-Allow-Origin", "*");
+    }
+
+    return httpd_resp_send(p_Request, Snapshot.JSON, Snapshot.JSONLength);
+}
+
+#ifdef CONFIG_NETWORK_RTP
+/** @brief              Send the status of the RTP stream.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Server_SendRTPStatus(httpd_req_t *p_Request)
+{
+    RTPStreamer_Status_t Status;
+    esp_err_t Error;
+
+    RTPStreamer_GetStatus(&Status);
+
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response, "running", Status.isRunning);
+    cJSON_AddStringToObject(response, "address", Status.Config.Address);
+    cJSON_AddNumberToObject(response, "port", Status.Config.Port);
+    cJSON_AddNumberToObject(response, "ttl", Status.Config.TTL);
+    cJSON_AddStringToObject(response, "format", ImageEncoder_GetFormatName(Status.Config.Format));
+    cJSON_AddStringToObject(response, "palette", ImageEncoder_GetPaletteName(Status.Config.Palette));
+    cJSON_AddNumberToObject(response, "quality", Status.Config.Quality);
+    cJSON_AddNumberToObject(response, "fps", Status.Config.FPS);
+    cJSON_AddNumberToObject(response, "ssrc", Status.SSRC);
+    cJSON_AddNumberToObject(response, "frames", Status.Frames);
+    cJSON_AddNumberToObject(response, "packets", Status.Packets);
+    cJSON_AddNumberToObject(response, "bytes", static_cast<double>(Status.Bytes));
+    cJSON_AddNumberToObject(response, "dropped", Status.Dropped);
+    cJSON_AddNumberToObject(response, "refreshes", Status.Refreshes);
+
+    Error = HTTP_Server_SendJSON(p_Request, response, 200);
+    cJSON_Delete(response);
+
+    return Error;
+}
+
+/** @brief              Handler for GET /api/v1/rtp.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Handler_RTPStatus(httpd_req_t *p_Request)
+{
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    }
+
+    return HTTP_Server_SendRTPStatus(p_Request);
+}
+
+/** @brief              Handler for POST /api/v1/rtp. Starts, changes or stops the RTP stream with "enable" and the
+ *                      optional "address", "port", "ttl", "format", "palette", "quality" and "fps". Missing fields
+ *                      keep the current configuration.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Handler_RTPControl(httpd_req_t *p_Request)
+{
+    RTPStreamer_Status_t Status;
+    RTPStreamer_Config_t Config;
+    cJSON *item;
+    bool isEnabled;
+
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    }
+
+    cJSON *json = HTTP_Server_ParseJSON(p_Request);
+    if (json == NULL) {
+        return HTTP_Server_SendError(p_Request, 400, "Invalid JSON");
+    }
+
+    RTPStreamer_GetStatus(&Status);
+    Config = Status.Config;
+    isEnabled = true;
+
+    item = cJSON_GetObjectItem(json, "enable");
+    if (cJSON_IsBool(item)) {
+        isEnabled = cJSON_IsTrue(item);
+    }
+
+    item = cJSON_GetObjectItem(json, "address");
+    if (cJSON_IsString(item) && (item->valuestring != NULL)) {
+        strncpy(Config.Address, item->valuestring, sizeof(Config.Address) - 1);
+        Config.Address[sizeof(Config.Address) - 1] = '\0';
+    }
+
+    item = cJSON_GetObjectItem(json, "port");
+    if (cJSON_IsNumber(item)) {
+        Config.Port = ((item->valueint > 0) && (item->valueint <= 65535)) ? item->valueint : 0;
+    }
+
+    item = cJSON_GetObjectItem(json, "ttl");
+    if (cJSON_IsNumber(item)) {
+        Config.TTL = ((item->valueint >= 1) && (item->valueint <= 255)) ? item->valueint : 1;
+    }
+
+    item = cJSON_GetObjectItem(json, "format");
+    if (cJSON_IsString(item) && (ImageEncoder_GetFormatByName(item->valuestring, &Config.Format) == false)) {
+        cJSON_Delete(json);
+        return HTTP_Server_SendError(p_Request, 400, "Unknown format");
+    }
+
+    item = cJSON_GetObjectItem(json, "palette");
+    if (cJSON_IsString(item)) {
+        /* Unknown names keep the palette */
+        ImageEncoder_GetPaletteByName(item->valuestring, &Config.Palette);
+    }
+
+    item = cJSON_GetObjectItem(json, "quality");
+    if (cJSON_IsNumber(item)) {
+        Config.Quality = ((item->valueint >= 0) && (item->valueint <= 100)) ? item->valueint : 0;
+    }
+
+    item = cJSON_GetObjectItem(json, "fps");
+    if (cJSON_IsNumber(item)) {
+        Config.FPS = ((item->valueint >= 1) && (item->valueint <= 30)) ? item->valueint : 0;
+    }
+
+    cJSON_Delete(json);
+
+    if (isEnabled == false) {
+        RTPStreamer_Stop();
+    } else {
+        esp_err_t Error = RTPStreamer_Start(&Config);
+
+        if (Error == ESP_ERR_INVALID_ARG) {
+            return HTTP_Server_SendError(p_Request, 400, "Invalid stream configuration");
+        } else if (Error != ESP_OK) {
+            return HTTP_Server_SendError(p_Request, 500, "Failed to start the RTP stream");
+        }
+    }
+
+    return HTTP_Server_SendRTPStatus(p_Request);
+}
+
+/** @brief              Handler for GET /api/v1/rtp.sdp. Answers with the session description of the running stream,
+ *                      which VLC, ffplay or GStreamer open directly.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Handler_RTPSDP(httpd_req_t *p_Request)
+{
+    char SDP[384];
+    int Length;
+
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    }
+
+    Length = RTPStreamer_GetSDP(SDP, sizeof(SDP));
+    if (Length < 0) {
+        return HTTP_Server_SendError(p_Request, 404, "No RTP stream");
+    }
+
+    httpd_resp_set_type(p_Request, "application/sdp");
+    httpd_resp_set_hdr(p_Request, "Cache-Control", "no-cache");
+
+    if (_HTTPServer_State.Config.EnableCORS) {
+        httpd_resp_set_hdr(p_Request, "Access-Control-Allow-Origin", "*");
+    }
+
+    return httpd_resp_send(p_Request, SDP, Length);
+}
+#endif
+
+#ifdef CONFIG_FLASH_LOG
+/** @brief              Send the status and the records of the flash log, the oldest record first.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Server_SendFlashLog(httpd_req_t *p_Request)
+{
+    FlashLog_Status_t Status;
+    FlashLog_Entry_t *Entries = NULL;
+    size_t Count = 0;
+    esp_err_t Error;
+
+    FlashLog_GetStatus(&Status);
+    if (Status.isAvailable == false) {
+        return HTTP_Server_SendError(p_Request, 503, "No flash log");
+    }
+
+    if (Status.Records > 0) {
+        Entries = reinterpret_cast<FlashLog_Entry_t *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, Status.Records *
+                                                                        sizeof(FlashLog_Entry_t), "flash_log_list"));
+        if (Entries == NULL) {
+            return HTTP_Server_SendError(p_Request, 500, "Out of memory");
+        }
+
+        Count = FlashLog_List(Entries, Status.Records);
+    }
+
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddNumberToObject(response, "capacity", Status.Capacity);
+    cJSON_AddNumberToObject(response, "used", Status.Used);
+    cJSON_AddNumberToObject(response, "pending", Status.Pending);
+    cJSON_AddNumberToObject(response, "appended", Status.Appended);
+    cJSON_AddNumberToObject(response, "busy", Status.Busy);
+    cJSON_AddNumberToObject(response, "overwritten", Status.Overwritten);
+    cJSON_AddNumberToObject(response, "synced", Status.Synced);
+    cJSON_AddNumberToObject(response, "error", Status.Error);
+
+    cJSON *records = cJSON_AddArrayToObject(response, "records");
+    for (size_t i = 0; i < Count; i++) {
+        cJSON *record = cJSON_CreateObject();
+
+        /* UTC capture time in microseconds, 0 while the time of the camera was not set */
+        cJSON_AddNumberToObject(record, "sequence", Entries[i].Sequence);
+        cJSON_AddNumberToObject(record, "time", static_cast<double>(Entries[i].Time));
+        cJSON_AddNumberToObject(record, "length", Entries[i].Length);
+        cJSON_AddBoolToObject(record, "synced", Entries[i].isSynced);
+        cJSON_AddItemToArray(records, record);
+    }
+
+    if (Entries != NULL) {
+        MemoryPlan_Free(Entries);
+    }
+
+    Error = HTTP_Server_SendJSON(p_Request, response, 200);
+    cJSON_Delete(response);
+
+    return Error;
+}
+
+/** @brief              Handler for GET /api/v1/flashlog.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Handler_FlashLogList(httpd_req_t *p_Request)
+{
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    }
+
+    return HTTP_Server_SendFlashLog(p_Request);
+}
+
+/** @brief              Handler for POST /api/v1/flashlog. "synced" marks the records up to this sequence number as
+ *                      synced after a client downloaded them, "sync" copies the remaining records to the SD card.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Handler_FlashLogControl(httpd_req_t *p_Request)
+{
+    cJSON *item;
+
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    }
+
+    cJSON *json = HTTP_Server_ParseJSON(p_Request);
+    if (json == NULL) {
+        return HTTP_Server_SendError(p_Request, 400, "Invalid JSON");
+    }
+
+    item = cJSON_GetObjectItem(json, "synced");
+    if (cJSON_IsNumber(item) && (item->valuedouble >= 0) && (FlashLog_MarkSynced(static_cast<uint32_t>(item->valuedouble)) != ESP_OK)) {
+        cJSON_Delete(json);
+        return HTTP_Server_SendError(p_Request, 500, "Failed to mark the records");
+    }
+
+    item = cJSON_GetObjectItem(json, "sync");
+    if (cJSON_IsTrue(item)) {
+        FlashLog_Sync();
+    }
+
+    cJSON_Delete(json);
+
+    return HTTP_Server_SendFlashLog(p_Request);
+}
+
+/** @brief              Worker for GET /api/v1/flashlog/record.
+ *                      Sends the snapshot (see sdSnapshot.h) of the record in the "seq" query parameter.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Worker_FlashLogRecord(httpd_req_t *p_Request)
+{
+    char query[32] = {0};
+    char param[16];
+    char Disposition[48];
+    char Time[24];
+    uint8_t *Buffer;
+    uint32_t Sequence;
+    size_t Length = 0;
+    esp_err_t Error;
+
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    }
+
+    if ((httpd_req_get_url_query_str(p_Request, query, sizeof(query)) != ESP_OK) ||
+        (httpd_query_key_value(query, "seq", param, sizeof(param)) != ESP_OK)) {
+        return HTTP_Server_SendError(p_Request, 400, "Missing seq");
+    }
+
+    Sequence = strtoul(param, NULL, 10);
+
+    Error = FlashLog_Read(Sequence, NULL, 0, &Length);
+    if (Error == ESP_ERR_NOT_FOUND) {
+        return HTTP_Server_SendError(p_Request, 404, "Record not found");
+    } else if (Error != ESP_ERR_INVALID_SIZE) {
+        return HTTP_Server_SendError(p_Request, 503, "No flash log");
+    }
+
+    Buffer = reinterpret_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, Length, "flash_log_record"));
+    if (Buffer == NULL) {
+        return HTTP_Server_SendError(p_Request, 500, "Out of memory");
+    }
+
+    /* The record can be overwritten between the two calls */
+    Error = FlashLog_Read(Sequence, Buffer, Length, &Length);
+    if (Error != ESP_OK) {
+        MemoryPlan_Free(Buffer);
+
+        if (Error == ESP_ERR_INVALID_CRC) {
+            return HTTP_Server_SendError(p_Request, 500, "Corrupted record");
+        }
+
+        return HTTP_Server_SendError(p_Request, 404, "Record not found");
+    }
+
+    snprintf(Disposition, sizeof(Disposition), "attachment; filename=\"FLASH%05u.PVS\"",
+             static_cast<unsigned int>(Sequence));
+
+    httpd_resp_set_type(p_Request, "application/octet-stream");
+    httpd_resp_set_hdr(p_Request, "Content-Disposition", Disposition);
+
+    /* The snapshot header has the time as well, the header saves a client the parsing */
+    snprintf(Time, sizeof(Time), "%lld",
+             static_cast<long long>(reinterpret_cast<const SDSnapshot_Header_t *>(Buffer)->Time));
+    httpd_resp_set_hdr(p_Request, "X-Capture-Time", Time);
+
+    if (_HTTPServer_State.Config.EnableCORS) {
+        httpd_resp_set_hdr(p_Request, "Access-Control-Allow-Origin", "*");
+        httpd_resp_set_hdr(p_Request, "Access-Control-Expose-Headers", "X-Capture-Time");
+    }
+
+    Error = httpd_resp_send(p_Request, reinterpret_cast<const char *>(Buffer), Length);
+    MemoryPlan_Free(Buffer);
+
+    return Error;
+}
+
+/** @brief              Handler for GET /api/v1/flashlog/record. Runs HTTP_Worker_FlashLogRecord on the worker pool.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Handler_FlashLogRecord(httpd_req_t *p_Request)
+{
+    return HTTP_Server_RunWorker(p_Request, HTTP_WORKERS_CLASS_TRANSFER, HTTP_Worker_FlashLogRecord);
+}
+#endif
+
+#ifdef CONFIG_NETWORK_METRICS
+/** @brief              Handler for GET /api/v1/metrics. Answers in the Prometheus text format with
+ *                      ?format=prometheus or when the Accept header of the collector asks for text/plain.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Handler_Metrics(httpd_req_t *p_Request)
+{
+    Metrics_Snapshot_t *Snapshot;
+    Metrics_Format_t Format;
+    char *Buffer;
+    char query[32];
+    char param[16];
+    char Accept[192];
+    esp_err_t Error;
+    int Length;
+
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    }
+
+    Format = METRICS_FORMAT_JSON;
+
+    /* A truncated header still holds the preferred types of the collector */
+    Error = httpd_req_get_hdr_value_str(p_Request, "Accept", Accept, sizeof(Accept));
+    if (((Error == ESP_OK) || (Error == ESP_ERR_HTTPD_RESULT_TRUNC)) && (strstr(Accept, "text/plain") != NULL) &&
+        (strstr(Accept, "text/html") == NULL)) {
+        Format = METRICS_FORMAT_PROMETHEUS;
+    }
+
+    if ((httpd_req_get_url_query_str(p_Request, query, sizeof(query)) == ESP_OK) &&
+        (httpd_query_key_value(query, "format", param, sizeof(param)) == ESP_OK)) {
+        Format = (strcmp(param, "prometheus") == 0) ? METRICS_FORMAT_PROMETHEUS : METRICS_FORMAT_JSON;
+    }
+
+    Snapshot = reinterpret_cast<Metrics_Snapshot_t *>(malloc(sizeof(Metrics_Snapshot_t)));
+    Buffer = reinterpret_cast<char *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, METRICS_BUFFER_SIZE, "metrics_report"));
+    if ((Snapshot == NULL) || (Buffer == NULL)) {
+        free(Snapshot);
+        MemoryPlan_Free(Buffer);
+
+        return HTTP_Server_SendError(p_Request, 500, "Out of memory");
+    }
+
+    Length = -1;
+    if (Metrics_Get(Snapshot) == ESP_OK) {
+        Length = Metrics_Format(Snapshot, Format, Buffer, METRICS_BUFFER_SIZE);
+    }
+
+    free(Snapshot);
+
+    if (Length < 0) {
+        MemoryPlan_Free(Buffer);
+
+        return HTTP_Server_SendError(p_Request, 503, "Metrics not available");
+    }
+
+    if (Format == METRICS_FORMAT_PROMETHEUS) {
+        httpd_resp_set_type(p_Request, "text/plain; version=0.0.4; charset=utf-8");
+    } else {
+        httpd_resp_set_type(p_Request, "application/json");
+    }
+    httpd_resp_set_hdr(p_Request, "Cache-Control", "no-cache");
+
+    if (_HTTPServer_State.Config.EnableCORS) {
+        httpd_resp_set_hdr(p_Request, "Access-Control-Allow-Origin", "*");
+    }
+
+    Error = httpd_resp_send(p_Request, Buffer, Length);
+
+    MemoryPlan_Free(Buffer);
+
+    return Error;
+}
+#endif
+
+#ifdef CONFIG_TRACE
+/** @brief              Send a part of the trace export as HTTP chunk.
+ *  @param p_Data       Data
+ *  @param Length       Length of the data in bytes
+ *  @param p_Arg        HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Server_SendTraceChunk(const char *p_Data, size_t Length, void *p_Arg)
+{
+    return httpd_resp_send_chunk(reinterpret_cast<httpd_req_t *>(p_Arg), p_Data, Length);
+}
+
+/** @brief              Handler for POST /api/v1/trace. Copies the trace ring for the download.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Handler_TraceTrigger(httpd_req_t *p_Request)
+{
+    cJSON *response;
+    esp_err_t Error;
+
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    }
+
+    if (Trace_Trigger() != ESP_OK) {
+        return HTTP_Server_SendError(p_Request, 503, "Trace not available");
+    }
+
+    response = cJSON_CreateObject();
+    cJSON_AddNumberToObject(response, "records", Trace_GetCount());
+
+    Error = HTTP_Server_SendJSON(p_Request, response, 200);
+    cJSON_Delete(response);
+
+    return Error;
+}
+
+/** @brief              Worker for GET /api/v1/trace. Downloads the copy of the last trigger as Chrome trace JSON.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Worker_TraceDownload(httpd_req_t *p_Request)
+{
+    esp_err_t Error;
+
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    }
+
+    if (Trace_GetCount() == 0) {
+        return HTTP_Server_SendError(p_Request, 404, "No trace triggered");
+    }
+
+    httpd_resp_set_type(p_Request, "application/json");
+    httpd_resp_set_hdr(p_Request, "Content-Disposition", "attachment; filename=\"pyrovision_trace.json\"");
+    httpd_resp_set_hdr(p_Request, "Cache-Control", "no-cache");
+
+    if (_HTTPServer_State.Config.EnableCORS) {
+        httpd_resp_set_hdr(p_Request, "Access-Control-Allow-Origin", "*");
+    }
+
+    Error = Trace_Export(HTTP_Server_SendTraceChunk, p_Request);
+    if (Error != ESP_OK) {
+        ESP_LOGW(TAG, "Trace download aborted: %d", Error);
+        return Error;
+    }
+
+    return httpd_resp_send_chunk(p_Request, NULL, 0);
+}
+
+/** @brief              Handler for GET /api/v1/trace. Runs HTTP_Worker_TraceDownload on the worker pool.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Handler_TraceDownload(httpd_req_t *p_Request)
+{
+    return HTTP_Server_RunWorker(p_Request, HTTP_WORKERS_CLASS_TRANSFER, HTTP_Worker_TraceDownload);
+}
+#endif
+
+#ifdef BENCHMARK
+/** @brief Size of a chunk of the Wi-Fi benchmark.
+ */
+#define HTTP_SERVER_BENCHMARK_CHUNK_SIZE    4096
+
+/** @brief              Handler for GET /api/v1/benchmark. Answers with the report of the benchmark firmware.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Handler_Benchmark(httpd_req_t *p_Request)
+{
+    char *Buffer;
+    esp_err_t Error;
+    int Length;
+
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    }
+
+    Buffer = reinterpret_cast<char *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, BENCHMARK_REPORT_SIZE, "benchmark_report"));
+    if (Buffer == NULL) {
+        return HTTP_Server_SendError(p_Request, 500, "Out of memory");
+    }
+
+    Length = Benchmark_Format(Buffer, BENCHMARK_REPORT_SIZE);
+    if (Length < 0) {
+        MemoryPlan_Free(Buffer);
+
+        return HTTP_Server_SendError(p_Request, 503, "Benchmark not available");
+    }
+
+    httpd_resp_set_type(p_Request, "application/json");
+    httpd_resp_set_hdr(p_Request, "Cache-Control", "no-cache");
+
+    if (_HTTPServer_State.Config.EnableCORS) {
+        httpd_resp_set_hdr(p_Request, "Access-Control-Allow-Origin", "*");
+    }
+
+    Error = httpd_resp_send(p_Request, Buffer, Length);
+
+    MemoryPlan_Free(Buffer);
+
+    return Error;
+}
+
+/** @brief              Worker for GET /api/v1/benchmark/wifi. Sends CONFIG_BENCHMARK_WIFI_SIZE_KB of data and adds
+ *                      the send throughput to the report. The client should discard the data as fast as possible.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Worker_BenchmarkWiFi(httpd_req_t *p_Request)
+{
+    Benchmark_Result_t Result;
+    char *Chunk;
+    int64_t Start;
+    esp_err_t Error;
+
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    }
+
+    Chunk = reinterpret_cast<char *>(malloc(HTTP_SERVER_BENCHMARK_CHUNK_SIZE));
+    if (Chunk == NULL) {
+        return HTTP_Server_SendError(p_Request, 500, "Out of memory");
+    }
+
+    memset(Chunk, 0xA5, HTTP_SERVER_BENCHMARK_CHUNK_SIZE);
+    memset(&Result, 0, sizeof(Result));
+    strncpy(Result.Name, "wifi_send", sizeof(Result.Name) - 1);
+
+    httpd_resp_set_type(p_Request, "application/octet-stream");
+    httpd_resp_set_hdr(p_Request, "Cache-Control", "no-cache");
+
+    if (_HTTPServer_State.Config.EnableCORS) {
+        httpd_resp_set_hdr(p_Request, "Access-Control-Allow-Origin", "*");
+    }
+
+    Error = ESP_OK;
+    Start = esp_timer_get_time();
+    for (uint32_t i = 0; i < ((CONFIG_BENCHMARK_WIFI_SIZE_KB * 1024) / HTTP_SERVER_BENCHMARK_CHUNK_SIZE); i++) {
+        Error = httpd_resp_send_chunk(p_Request, Chunk, HTTP_SERVER_BENCHMARK_CHUNK_SIZE);
+        if (Error != ESP_OK) {
+            break;
+        }
+
+        Result.Bytes += HTTP_SERVER_BENCHMARK_CHUNK_SIZE;
+    }
+
+    Result.Best = static_cast<uint32_t>(esp_timer_get_time() - Start);
+    Result.Mean = Result.Best;
+    Result.Worst = Result.Best;
+    Result.Runs = 1;
+    Result.Error = Error;
+
+    free(Chunk);
+
+    Benchmark_AddResult(&Result);
+    ESP_LOGI(TAG, "Wi-Fi benchmark: %lu bytes in %lu us", Result.Bytes, Result.Best);
+
+    if (Error != ESP_OK) {
+        return Error;
+    }
+
+    return httpd_resp_send_chunk(p_Request, NULL, 0);
+}
+
+/** @brief              Handler for GET /api/v1/benchmark/wifi. Runs HTTP_Worker_BenchmarkWiFi on the worker pool.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Handler_BenchmarkWiFi(httpd_req_t *p_Request)
+{
+    return HTTP_Server_RunWorker(p_Request, HTTP_WORKERS_CLASS_TRANSFER, HTTP_Worker_BenchmarkWiFi);
+}
+#endif
+
+/** @brief              Worker for POST /api/v1/update (OTA).
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Worker_Update(httpd_req_t *p_Request)
+{
+    size_t content_len;
+    size_t total_received = 0;
+    esp_err_t Error;
+
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    }
+
+    content_len = p_Request->content_len;
+
+    Error = OTAWriter_Begin(content_len);
+    if (Error == ESP_ERR_INVALID_STATE) {
+        return HTTP_Server_SendError(p_Request, 409, "OTA update already running");
+    } else if (Error == ESP_ERR_NOT_FOUND) {
+        return HTTP_Server_SendError(p_Request, 500, "No OTA partition found");
+    } else if (Error == ESP_ERR_INVALID_SIZE) {
+        return HTTP_Server_SendError(p_Request, 413, "Invalid firmware size");
+    } else if (Error != ESP_OK) {
+        return HTTP_Server_SendError(p_Request, 500, "OTA begin failed");
+    }
+
+    /* Receive into one buffer while the writer task writes the other one to the flash */
+    while (total_received < content_len) {
+        uint8_t *buffer;
+        size_t filled = 0;
+
+        if (OTAWriter_GetBuffer(&buffer) != ESP_OK) {
+            OTAWriter_Abort();
+
+            return HTTP_Server_SendError(p_Request, 500, "OTA write failed");
+        }
+
+        while ((filled < CONFIG_NETWORK_OTA_CHUNK_SIZE) && ((total_received + filled) < content_len)) {
+            size_t remaining;
+            int received;
+
+            remaining = content_len - total_received - filled;
+            if (remaining > (CONFIG_NETWORK_OTA_CHUNK_SIZE - filled)) {
+                remaining = CONFIG_NETWORK_OTA_CHUNK_SIZE - filled;
+            }
+
+            received = httpd_req_recv(p_Request, reinterpret_cast<char *>(&buffer[filled]), remaining);
+            if (received <= 0) {
+                if (received == HTTPD_SOCK_ERR_TIMEOUT) {
+                    continue;
+                }
+
+                OTAWriter_Abort();
+
+                return HTTP_Server_SendError(p_Request, 500, "Receive failed");
+            }
+
+            filled += received;
+        }
+
+        if (OTAWriter_Submit(buffer, filled) != ESP_OK) {
+            OTAWriter_Abort();
+
+            return HTTP_Server_SendError(p_Request, 500, "OTA write failed");
+        }
+
+        total_received += filled;
+    }
+
+    Error = OTAWriter_Finish();
+    if (Error == ESP_ERR_OTA_VALIDATE_FAILED) {
+        return HTTP_Server_SendError(p_Request, 400, "Invalid firmware image");
+    } else if (Error != ESP_OK) {
+        return HTTP_Server_SendError(p_Request, 500, "OTA write failed");
+    }
+
+    ESP_LOGI(TAG, "OTA update successful, rebooting...");
+
+    /* Send response */
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "status", "updating");
+    cJSON_AddStringToObject(response, "message", "Firmware upload successful. Device will reboot after update.");
+    Error = HTTP_Server_SendJSON(p_Request, response, 200);
+    cJSON_Delete(response);
+
+    /* Reboot after response is sent */
+    vTaskDelay(1000 / portTICK_PERIOD_MS);
+    esp_restart();
+
+    return Error;
+}
+
+/** @brief              Handler for POST /api/v1/update. Runs HTTP_Worker_Update on the worker pool.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Handler_Update(httpd_req_t *p_Request)
+{
+    return HTTP_Server_RunWorker(p_Request, HTTP_WORKERS_CLASS_UPDATE, HTTP_Worker_Update);
+}
+
+/** @brief          Stream task. Sends every new frame of the thermal frame as one part of the multipart response.
+ *                  The JPEG comes from the encoder cache, so all streams and WebSocket clients with the same palette,
+ *                  pyramid level and crop window share one encode.
+ *  @param p_Param  Pointer to the HTTP_Stream_t of the stream
+ */
+static void HTTP_StreamTask(void *p_Param)
+{
+    HTTP_Stream_t *Stream = reinterpret_cast<HTTP_Stream_t *>(p_Param);
+    Network_Encoded_Image_t encoded;
+    char part[96];
+
+    ESP_LOGD(TAG, "MJPEG stream started");
+
+    while (_HTTPServer_State.isRunning && Stream->isActive) {
+        esp_err_t Error;
+        int length;
+
+        /* Wait for the next frame, time out to notice a stopped server */
+        ulTaskNotifyTake(pdTRUE, 1000 / portTICK_PERIOD_MS);
+
+        if ((_HTTPServer_State.ThermalFrame == NULL) ||
+            (xSemaphoreTake(_HTTPServer_State.ThermalFrame->mutex, 100 / portTICK_PERIOD_MS) != pdTRUE)) {
+            continue;
+        }
+
+        if (_HTTPServer_State.ThermalFrame->sequence == Stream->Sequence) {
+            xSemaphoreGive(_HTTPServer_State.ThermalFrame->mutex);
+            continue;
+        }
+
+        Stream->Sequence = _HTTPServer_State.ThermalFrame->sequence;
+        Error = ImageEncoder_EncodeView(_HTTPServer_State.ThermalFrame, NETWORK_IMAGE_FORMAT_JPEG, Stream->Palette, 0,
+                                        Stream->Level, &Stream->Window, &encoded);
+
+        xSemaphoreGive(_HTTPServer_State.ThermalFrame->mutex);
+
+        if (Error != ESP_OK) {
+            continue;
+        }
+
+        length = snprintf(part, sizeof(part), "--" HTTP_SERVER_STREAM_BOUNDARY "\r\nContent-Type: image/jpeg\r\n"
+                          "Content-Length: %u\r\n\r\n", static_cast<unsigned int>(encoded.size));
+
+        Error = httpd_resp_send_chunk(Stream->Request, part, length);
+        if (Error == ESP_OK) {
+            Error = httpd_resp_send_chunk(Stream->Request, (const char *)encoded.data, encoded.size);
+        }
+
+        if (Error == ESP_OK) {
+            Error = httpd_resp_send_chunk(Stream->Request, "\r\n", 2);
+        }
+
+        ImageEncoder_Free(&encoded);
+
+        if (Error != ESP_OK) {
+            ESP_LOGD(TAG, "MJPEG stream closed by client");
+            break;
+        }
+
+        Boot_Mark(BOOT_PHASE_FIRST_NETWORK);
+        Telemetry_FrameSent();
+    }
+
+    httpd_req_async_handler_complete(Stream->Request);
+
+    xSemaphoreTake(_HTTPServer_State.StreamMutex, portMAX_DELAY);
+    Stream->Request = NULL;
+    Stream->Task = NULL;
+    Stream->isActive = false;
+    xSemaphoreGive(_HTTPServer_State.StreamMutex);
+
+    ESP_LOGD(TAG, "MJPEG stream stopped");
+
+    vTaskDelete(NULL);
+}
+
+/** @brief              MJPEG stream handler (multipart/x-mixed-replace). The request is handed over to a stream
+ *                      task, so the httpd task is free for other requests.
+ *                      Optional query parameters: "palette", "level" ("half", "native" or "double"), "crop" and
+ *                      "zoom" (see HTTP_Server_ParseWindow). A crop window replaces the level.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Handler_Stream(httpd_req_t *p_Request)
+{
+    char query[128] = {0};
+    Server_Palette_t palette = PALETTE_IRON;
+    Network_ImageLevel_t level = NETWORK_IMAGE_LEVEL_NATIVE;
+    Network_ImageWindow_t window;
+    HTTP_Stream_t *Stream = NULL;
+    uint8_t MaxStreams;
+
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    } else if (_HTTPServer_State.ThermalFrame == NULL) {
+        return HTTP_Server_SendError(p_Request, 503, "No thermal data available");
+    }
+
+    if (httpd_req_get_url_query_str(p_Request, query, sizeof(query)) == ESP_OK) {
+        char param[32];
+
+        if (httpd_query_key_value(query, "palette", param, sizeof(param)) == ESP_OK) {
+            /* Unknown names keep the default palette */
+            ImageEncoder_GetPaletteByName(param, &palette);
+        }
+
+        if (httpd_query_key_value(query, "level", param, sizeof(param)) == ESP_OK) {
+            /* Unknown names keep the native level */
+            ImageEncoder_GetLevelByName(param, &level);
+        }
+    }
+
+    HTTP_Server_ParseWindow(query, &window);
+
+    /* Reserve a stream slot, the number of streams is limited by the client limit of the server */
+    MaxStreams = (_HTTPServer_State.Config.MaxClients < HTTP_SERVER_MAX_STREAMS) ? _HTTPServer_State.Config.MaxClients :
+                 HTTP_SERVER_MAX_STREAMS;
+
+    xSemaphoreTake(_HTTPServer_State.StreamMutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < MaxStreams; i++) {
+        if (_HTTPServer_State.Streams[i].isActive == false) {
+            Stream = &_HTTPServer_State.Streams[i];
+            Stream->isActive = true;
+            break;
+        }
+    }
+    xSemaphoreGive(_HTTPServer_State.StreamMutex);
+
+    if (Stream == NULL) {
+        return HTTP_Server_SendError(p_Request, 503, "Too many streams");
+    }
+
+    Stream->Palette = palette;
+    Stream->Level = level;
+    Stream->Window = window;
+    Stream->Sequence = 0;
+
+    httpd_resp_set_type(p_Request, "multipart/x-mixed-replace;boundary=" HTTP_SERVER_STREAM_BOUNDARY);
+    httpd_resp_set_hdr(p_Request, "Cache-Control", "no-cache, no-store");
+
+    if (_HTTPServer_State.Config.EnableCORS) {
+        httpd_resp_set_hdr(p_Request, "Access-Control-Allow-Origin", "*");
+    }
+
+    if (httpd_req_async_handler_begin(p_Request, &Stream->Request) != ESP_OK) {
+        Stream->isActive = false;
+        return HTTP_Server_SendError(p_Request, 500, "Failed to start stream");
+    }
+
+    if (Topology_CreateTask(TOPOLOGY_TASK_HTTP_STREAM, HTTP_StreamTask, Stream, &Stream->Task) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create stream task!");
+        httpd_req_async_handler_complete(Stream->Request);
+        Stream->Request = NULL;
+        Stream->isActive = false;
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+/** @brief              Get the SD card path of the "path" query parameter. The path must be absolute and must not leave
+ *                      the mount point.
+ *  @param p_Query      Query string of the request
+ *  @param p_Path       Pointer to store the path with the mount point
+ *  @param Size         Size of the path buffer
+ *  @param p_Default    Path to use when the parameter is missing, NULL if it is required
+ *  @return             true if the path is valid
+ */
+static bool HTTP_Server_GetSDPath(const char *p_Query, char *p_Path, size_t Size, const char *p_Default)
+{
+    char Param[HTTP_SERVER_MAX_PATH] = {0};
+
+    if ((p_Query == NULL) || (httpd_query_key_value(p_Query, "path", Param, sizeof(Param)) != ESP_OK)) {
+        if (p_Default == NULL) {
+            return false;
+        }
+
+        snprintf(Param, sizeof(Param), "%s", p_Default);
+    }
+
+    if ((Param[0] != '/') || (strstr(Param, "..") != NULL) || (strchr(Param, '\\') != NULL)) {
+        return false;
+    }
+
+    /* The root directory has no trailing slash in the VFS */
+    if (strcmp(Param, "/") == 0) {
+        Param[0] = '\0';
+    }
+
+    return (snprintf(p_Path, Size, "%s%s", SD_MOUNT_POINT, Param) < static_cast<int>(Size));
+}
+
+/** @brief              Worker for GET /api/v1/sd/files.
+ *                      Lists one page of a directory of the SD card. Optional query parameters: "path" (default /),
+ *                      "offset" (first entry, default 0) and "count" (default and maximum
+ *                      HTTP_SERVER_MAX_LIST_ENTRIES).
+ *                      "more" is true if the directory has entries after the page.
+ *  @param p_Request    HTTP request handle
+ *  @return             ESP_OK on success
+ */
+static esp_err_t HTTP_Worker_SDFiles(httpd_req_t *p_Request)
+{
+    char query[HTTP_SERVER_MAX_PATH + 64] = {0};
+    char Path[HTTP_SERVER_MAX_PATH + 16];
+    char EntryPath[HTTP_SERVER_MAX_PATH + 32];
+    uint32_t Offset = 0;
+    uint32_t Count = HTTP_SERVER_MAX_LIST_ENTRIES;
+    uint32_t Index = 0;
+    uint32_t Listed = 0;
+    bool hasQuery;
+    bool hasMore = false;
+    struct dirent *Entry;
+    esp_err_t Error;
+    DIR *Directory;
+
+    _HTTPServer_State.RequestCount++;
+
+    if (HTTP_Server_CheckAuth(p_Request) == false) {
+        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    } else if (SDManager_isMounted() == false) {
+        return HTTP_Server_SendError(p_Request, 503, "No SD card");
+    }
+
+    hasQuery = (httpd_req_get_url_query_str(p_Request, query, sizeof(query)) == ESP_OK);
+    if (HTTP_Server_GetSDPath(hasQuery ? query : NULL, Path, sizeof(Path), "/") == false) {
+        return HTTP_Server_SendError(p_Request, 400, "Invalid path");
+    }
+
+    if (hasQuery) {
+        char param[16];
+
+        if (httpd_query_key_value(query, "offset", param, sizeof(param)) == ESP_OK) {
+            Offset = strtoul(param, NULL, 10);
+        }
+        if (httpd_query_key_value(query, "count", param, sizeof(param)) == ESP_OK) {
+            Count = strtoul(param, NULL, 10);
+            Count = ((Count == 0) || (Count > HTTP_SERVER_MAX_LIST_ENTRIES)) ? HTTP_SERVER_MAX_LIST_ENTRIES : Count;
+        }
+    }
+
+    Directory = opendir(Path);
+    if (Directory == NULL) {
+        return HTTP_Server_SendError(p_Request, 404, "Directory not found");
+    }
+
+    cJSON *response = cJSON_CreateObject();
+    cJSON *entries = cJSON_AddArrayToObject(response, "entries");
+
+    /* FAT can not seek in a directory, the entries before the page are skipped without a stat */
+    while ((Entry = readdir(Directory)) != NULL) {
+        struct stat Info;
+        cJSON *item;
+
+        if (Index++ < Offset) {
+            continue;
+        } else if (Listed >= Count) {
+            hasMore = true;
+            break;
+        }
+
+        snprintf(EntryPath, sizeof(EntryPath), "%s/%s", Path, Entry->d_name);
+
+        item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", Entry->d_name);
+        cJSON_AddBoolToObject(item, "dir", Entry->d_type == DT_DIR);
+        cJSON_AddNumberToObject(item, "size", (stat(EntryPath, &Info) == 0) ? Info.st_size : 0);
+        cJSON_AddItemToArray(entries, item);
+
+        Listed++;
+    }
+
+    closedir(Directory);
+
+    cJSON_AddStringToObject(response, "path", (Path[strlen(SD_MOUNT_POINT)] != '\0') ? &Path[strlen(SD_MOUNT_POINT)] :
+                            "/");
+    cJSON_AddNumberToObject(response, "offset", Offset);
+    cJSON_AddNumberToObject(response, "count", Listed);
+    cJSON_AddBoolToObject(response, "more", hasMore);
+
     Error = HTTP_Server_SendJSON(p_Request, response, 200);
     cJSON_Delete(response);
 
     return Error;
 }
 
-/** @brief              Handler for GET /api/v1/image.
+/** @brief              Handler for GET /api/v1/sd/files. Runs HTTP_Worker_SDFiles on the worker pool.
  *  @param p_Request    HTTP request handle
  *  @return             ESP_OK on success
  */
-static esp_err_t HTTP_Handler_Image(httpd_req_t *p_Request)
+static esp_err_t HTTP_Handler_SDFiles(httpd_req_t *p_Request)
 {
-    esp_err_t Error;
-    Network_Encoded_Image_t encoded;
-    char query[128] = {0};
-    Network_ImageFormat_t format = NETWORK_IMAGE_FORMAT_JPEG;
-    Server_Palette_t palette = PALETTE_IRON;
-
-    _HTTPServer_State.RequestCount++;
+    return HTTP_Server_RunWorker(p_Request, HTTP_WORKERS_CLASS_TRANSFER, HTTP_Worker_SDFiles);
+}
 
-    if (HTTP_Server_CheckAuth(p_Request) == false) {
-        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
-    } else if (_HTTPServer_State.ThermalFrame == NULL) {
-        return HTTP_Server_SendError(p_Request, 503, "No thermal data available");
-    }
+/** @brief              Parse a single byte range of a Range header (bytes=first-last, bytes=first- or bytes=-suffix).
+ *  @param p_Header     Value of the Range header
+ *  @param Size         Size of the file in bytes
+ *  @param p_Offset     Pointer to store the first byte
+ *  @param p_Length     Pointer to store the number of bytes
+ *  @return             1 for a valid range, 0 if the header is ignored (several ranges), -1 if the range is not
+ *                      satisfiable
+ */
+static int HTTP_Server_ParseRange(const char *p_Header, uint32_t Size, uint32_t *p_Offset, uint32_t *p_Length)
+{
+    const char *p_Spec;
+    char *p_End;
+    unsigned long First;
+    unsigned long Last;
 
-    if (httpd_req_get_url_query_str(p_Request, query, sizeof(query)) == ESP_OK) {
-        char param[32];
-        if (httpd_query_key_value(query, "format", param, sizeof(param)) == ESP_OK) {
-            if (strcmp(param, "png") == 0) {
-                format = NETWORK_IMAGE_FORMAT_PNG;
-            } else if (strcmp(param, "raw") == 0) {
-                format = NETWORK_IMAGE_FORMAT_RAW;
-            }
-        }
-        if (httpd_query_key_value(query, "palette", param, sizeof(param)) == ESP_OK) {
-            if (strcmp(param, "gray") == 0) {
-                palette = PALETTE_GRAY;
-            } else if (strcmp(param, "rainbow") == 0) {
-                palette = PALETTE_RAINBOW;
-            }
-        }
+    if ((strncmp(p_Header, "bytes=", 6) != 0) || (strchr(p_Header, ',') != NULL)) {
+        return 0;
     }
 
-    if (xSemaphoreTake(_HTTPServer_State.ThermalFrame->mutex, 100 / portTICK_PERIOD_MS) != pdTRUE) {
-        return HTTP_Server_SendError(p_Request, 503, "Frame busy");
-    }
+    p_Spec = p_Header + 6;
 
-    Error = ImageEncoder_Encode(_HTTPServer_State.ThermalFrame, format, palette, &encoded);
+    if (*p_Spec == '-') {
+        /* Suffix range, the last n bytes */
+        Last = strtoul(p_Spec + 1, &p_End, 10);
+        if ((p_End == (p_Spec + 1)) || (Last == 0) || (Size == 0)) {
+            return -1;
+        }
 
-    xSemaphoreGive(_HTTPServer_State.ThermalFrame->mutex);
+        Last = (Last > Size) ? Size : Last;
+        *p_Offset = Size - Last;
+        *p_Length = Last;
 
-    if (Error != ESP_OK) {
-        return HTTP_Server_SendError(p_Request, 500, "Image encoding failed");
+        return 1;
     }
 
-    /* Set content type */
-    switch (format) {
-        case NETWORK_IMAGE_FORMAT_JPEG:
-            httpd_resp_set_type(p_Request, "image/jpeg");
-            break;
-        case NETWORK_IMAGE_FORMAT_PNG:
-            httpd_resp_set_type(p_Request, "image/png");
-            break;
-        case NETWORK_IMAGE_FORMAT_RAW:
-            httpd_resp_set_type(p_Request, "application/octet-stream");
-            break;
+    First = strtoul(p_Spec, &p_End, 10);
+    if ((p_End == p_Spec) || (*p_End != '-') || (First >= Size)) {
+        return -1;
     }
 
-    if (_HTTPServer_State.Config.EnableCORS) {
-        httpd_resp_set_hdr(p_Request, "Access-Control-Allow-Origin", "*");
+    p_Spec = p_End + 1;
+    Last = (*p_Spec == '\0') ? (Size - 1) : strtoul(p_Spec, &p_End, 10);
+    if (Last < First) {
+        return -1;
     }
 
-    /* Send image data */
-    Error = httpd_resp_send(p_Request, (const char *)encoded.data, encoded.size);
-
-    ImageEncoder_Free(&encoded);
+    Last = (Last >= Size) ? (Size - 1) : Last;
+    *p_Offset = First;
+    *p_Length = Last - First + 1;
 
-    return Error;
+    return 1;
 }
 
-/** @brief              Handler for GET /api/v1/telemetry.
- *  @param p_Request    HTTP request handle
- *  @return             ESP_OK on success
+/** @brief          Release the slot of a download. The slots are claimed with the stream mutex taken, so they are
+ *                  released with it too.
+ *  @param Download Download to release
  */
-static esp_err_t HTTP_Handler_Telemetry(httpd_req_t *p_Request)
+static void HTTP_Server_ReleaseDownload(HTTP_Download_t *Download)
 {
-    esp_err_t Error;
-
-    _HTTPServer_State.RequestCount++;
+    xSemaphoreTake(_HTTPServer_State.StreamMutex, portMAX_DELAY);
+    Download->Reader = NULL;
+    Download->Request = NULL;
+    Download->Task = NULL;
+    Download->isActive = false;
+    xSemaphoreGive(_HTTPServer_State.StreamMutex);
+}
 
-    if (HTTP_Server_CheckAuth(p_Request) == false) {
-        return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
-    }
+/** @brief          Download task. Sends the blocks of the read-ahead reader as chunks of the response, so the SD card
+ *                  is read while the previous block is sent.
+ *  @param p_Param  Pointer to the HTTP_Download_t of the download
+ */
+static void HTTP_DownloadTask(void *p_Param)
+{
+    HTTP_Download_t *Download = reinterpret_cast<HTTP_Download_t *>(p_Param);
 
-    /* Build telemetry response */
-    cJSON *json = cJSON_CreateObject();
+    ESP_LOGD(TAG, "Download started");
 
-    /* Uptime */
-    uint32_t uptime = (esp_timer_get_time() / 1000000);
-    cJSON_AddNumberToObject(json, "uptime_s", uptime);
+    while (_HTTPServer_State.isRunning) {
+        const uint8_t *Data;
+        size_t Length;
 
-    /* Sensor temperature (from thermal frame if available) */
-    if (_HTTPServer_State.ThermalFrame != NULL) {
-        cJSON_AddNumberToObject(json, "sensor_temp_c", _HTTPServer_State.ThermalFrame->temp_avg);
-    }
+        /* An aborted download ends without the last chunk, so the client sees the truncated response */
+        if (FileReader_Read(Download->Reader, &Data, &Length) != ESP_OK) {
+            break;
+        }
 
-    /* Supply voltage (placeholder) */
-    cJSON_AddNumberToObject(json, "supply_voltage_v", 0);
+        if (Length == 0) {
+            httpd_resp_send_chunk(Download->Request, NULL, 0);
+            break;
+        }
 
-    /* WiFi RSSI */
-    wifi_ap_record_t ap_info;
-    if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-        cJSON_AddNumberToObject(json, "wifi_rssi_dbm", ap_info.rssi);
-    } else {
-        cJSON_AddNumberToObject(json, "wifi_rssi_dbm", 0);
+        if (httpd_resp_send_chunk(Download->Request, reinterpret_cast<const char *>(Data), Length) != ESP_OK) {
+            ESP_LOGD(TAG, "Download closed by client");
+            break;
+        }
     }
 
-    /* SD card info (placeholder) */
-    cJSON *sdcard = cJSON_CreateObject();
-    cJSON_AddBoolToObject(sdcard, "present", false);
-    cJSON_AddNumberToObject(sdcard, "free_mb", 0);
-    cJSON_AddItemToObject(json, "sdcard", sdcard);
+    FileReader_Close(Download->Reader);
+    httpd_req_async_handler_complete(Download->Request);
+    HTTP_Server_ReleaseDownload(Download);
 
-    Error = HTTP_Server_SendJSON(p_Request, json, 200);
-    cJSON_Delete(json);
+    ESP_LOGD(TAG, "Download stopped");
 
-    return Error;
+    vTaskDelete(NULL);
 }
 
-/** @brief              Handler for POST /api/v1/update (OTA).
+/** @brief              Handler for GET /api/v1/sd/file.
+ *                      Sends the file of the "path" query parameter. A single byte range of a Range header is
+ *                      answered with 206 Partial Content, so interrupted downloads can be resumed. The request is
+ *                      handed over to a download task, so the httpd task is free for other requests.
  *  @param p_Request    HTTP request handle
  *  @return             ESP_OK on success
  */
-static esp_err_t HTTP_Handler_Update(httpd_req_t *p_Request)
+static esp_err_t HTTP_Handler_SDFile(httpd_req_t *p_Request)
 {
-    int content_len;
-    int received = 0;
-    int total_received = 0;
+    char query[HTTP_SERVER_MAX_PATH + 16] = {0};
+    char Path[HTTP_SERVER_MAX_PATH + 16];
+    char Range[48] = {0};
+    HTTP_Download_t *Download = NULL;
+    struct stat Info;
+    uint32_t Offset;
+    uint32_t Length;
+    int isRange = 0;
     esp_err_t Error;
-    esp_ota_handle_t ota_handle;
 
     _HTTPServer_State.RequestCount++;
 
     if (HTTP_Server_CheckAuth(p_Request) == false) {
         return HTTP_Server_SendError(p_Request, 401, "Unauthorized");
+    } else if (SDManager_isMounted() == false) {
+        return HTTP_Server_SendError(p_Request, 503, "No SD card");
     }
 
-    const esp_partition_t *update_partition = esp_ota_get_next_update_partition(NULL);
-
-    if (update_partition == NULL) {
-        return HTTP_Server_SendError(p_Request, 500, "No OTA partition found");
-    }
-
-    ESP_LOGI(TAG, "OTA update starting, partition: %s", update_partition->label);
-
-    Error = esp_ota_begin(update_partition, OTA_SIZE_UNKNOWN, &ota_handle);
-    if (Error != ESP_OK) {
-        ESP_LOGE(TAG, "esp_ota_begin failed: %d!", Error);
-        return HTTP_Server_SendError(p_Request, 500, "OTA begin failed");
+    if ((httpd_req_get_url_query_str(p_Request, query, sizeof(query)) != ESP_OK) ||
+        (HTTP_Server_GetSDPath(query, Path, sizeof(Path), NULL) == false)) {
+        return HTTP_Server_SendError(p_Request, 400, "Invalid path");
     }
 
-    /* Receive firmware data */
-    char *buffer = (char *)heap_caps_malloc(1024, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    if (buffer == NULL) {
-        esp_ota_abort(ota_handle);
-
-        return HTTP_Server_SendError(p_Request, 500, "Memory allocation failed");
+    if ((stat(Path, &Info) != 0) || S_ISDIR(Info.st_mode)) {
+        return HTTP_Server_SendError(p_Request, 404, "File not found");
     }
 
-    content_len = p_Request->content_len;
+    Offset = 0;
+    Length = Info.st_size;
 
-    while (total_received < content_len) {
-        received = httpd_req_recv(p_Request, buffer, 1024);
-        if (received <= 0) {
-            if (received == HTTPD_SOCK_ERR_TIMEOUT) {
-                continue;
-            }
-            free(buffer);
-            esp_ota_abort(ota_handle);
+    if (httpd_req_get_hdr_value_str(p_Request, "Range", Range, sizeof(Range)) == ESP_OK) {
+        isRange = HTTP_Server_ParseRange(Range, Info.st_size, &Offset, &Length);
+        if (isRange < 0) {
+            snprintf(Range, sizeof(Range), "bytes */%u", static_cast<unsigned int>(Info.st_size));
+            httpd_resp_set_hdr(p_Request, "Content-Range", Range);
 
-            return HTTP_Server_SendError(p_Request, 500, "Receive failed");
+            return HTTP_Server_SendError(p_Request, 416, "Range not satisfiable");
         }
+    }
 
-        Error = esp_ota_write(ota_handle, buffer, received);
-        if (Error != ESP_OK) {
-            free(buffer);
-            esp_ota_abort(ota_handle);
-            ESP_LOGE(TAG, "esp_ota_write failed: %d!", Error);
-
-            return HTTP_Server_SendError(p_Request, 500, "OTA write failed");
+    xSemaphoreTake(_HTTPServer_State.StreamMutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < CONFIG_NETWORK_DOWNLOAD_MAX; i++) {
+        if (_HTTPServer_State.Downloads[i].isActive == false) {
+            Download = &_HTTPServer_State.Downloads[i];
+            Download->isActive = true;
+            break;
         }
-
-        total_received += received;
-        ESP_LOGD(TAG, "OTA progress: %d/%d bytes", total_received, content_len);
     }
+    xSemaphoreGive(_HTTPServer_State.StreamMutex);
 
-    free(buffer);
+    if (Download == NULL) {
+        return HTTP_Server_SendError(p_Request, 503, "Too many downloads");
+    }
 
-    Error = esp_ota_end(ota_handle);
+    Error = FileReader_Open(Path, Offset, Length, &Download->Reader);
     if (Error != ESP_OK) {
-        ESP_LOGE(TAG, "esp_ota_end failed: %d", Error);
-        return HTTP_Server_SendError(p_Request, 500, "OTA end failed");
+        HTTP_Server_ReleaseDownload(Download);
+        return HTTP_Server_SendError(p_Request, (Error == ESP_ERR_NOT_FOUND) ? 404 : 503, "Can not open file");
     }
 
-    Error = esp_ota_set_boot_partition(update_partition);
-    if (Error != ESP_OK) {
-        ESP_LOGE(TAG, "esp_ota_set_boot_partition failed: %d!", Error);
-        return HTTP_Server_SendError(p_Request, 500, "Set boot partition failed");
+    if (isRange > 0) {
+        snprintf(Download->ContentRange, sizeof(Download->ContentRange), "bytes %u-%u/%u",
+                 static_cast<unsigned int>(Offset), static_cast<unsigned int>(Offset + Length - 1),
+                 static_cast<unsigned int>(Info.st_size));
+        httpd_resp_set_status(p_Request, "206 Partial Content");
+        httpd_resp_set_hdr(p_Request, "Content-Range", Download->ContentRange);
     }
 
-    ESP_LOGI(TAG, "OTA update successful, rebooting...");
+    snprintf(Download->Disposition, sizeof(Download->Disposition), "attachment; filename=\"%s\"",
+             strrchr(Path, '/') + 1);
 
-    /* Send response */
-    cJSON *response = cJSON_CreateObject();
-    cJSON_AddStringToObject(response, "status", "updating");
-    cJSON_AddStringToObject(response, "message", "Firmware upload successful. Device will reboot after update.");
-    Error = HTTP_Server_SendJSON(p_Request, response, 200);
-    cJSON_Delete(response);
+    httpd_resp_set_type(p_Request, "application/octet-stream");
+    httpd_resp_set_hdr(p_Request, "Accept-Ranges", "bytes");
+    httpd_resp_set_hdr(p_Request, "Content-Disposition", Download->Disposition);
 
-    /* Reboot after response is sent */
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
-    esp_restart();
+    if (_HTTPServer_State.Config.EnableCORS) {
+        httpd_resp_set_hdr(p_Request, "Access-Control-Allow-Origin", "*");
+    }
 
-    return Error;
+    if (httpd_req_async_handler_begin(p_Request, &Download->Request) != ESP_OK) {
+        FileReader_Close(Download->Reader);
+        HTTP_Server_ReleaseDownload(Download);
+        return HTTP_Server_SendError(p_Request, 500, "Failed to start download");
+    }
+
+    if (Topology_CreateTask(TOPOLOGY_TASK_HTTP_DOWNLOAD, HTTP_DownloadTask, Download, &Download->Task) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create download task!");
+        httpd_req_async_handler_complete(Download->Request);
+        FileReader_Close(Download->Reader);
+        HTTP_Server_ReleaseDownload(Download);
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
 }
 
 /** @brief              Handler for CORS preflight requests.
@@ -471,6 +2006,16 @@ static const httpd_uri_t _URI_Image = {
     .supported_subprotocol = NULL,
 };
 
+static const httpd_uri_t _URI_Stream = {
+    .uri       = HTTP_SERVER_API_BASE_PATH "/stream",
+    .method    = HTTP_GET,
+    .handler   = HTTP_Handler_Stream,
+    .user_ctx  = NULL,
+    .is_websocket = false,
+    .handle_ws_control_frames = false,
+    .supported_subprotocol = NULL,
+};
+
 static const httpd_uri_t _URI_Telemetry = {
     .uri       = HTTP_SERVER_API_BASE_PATH "/telemetry",
     .method    = HTTP_GET,
@@ -481,6 +2026,126 @@ static const httpd_uri_t _URI_Telemetry = {
     .supported_subprotocol = NULL,
 };
 
+#ifdef CONFIG_NETWORK_RTP
+static const httpd_uri_t _URI_RTPStatus = {
+    .uri       = HTTP_SERVER_API_BASE_PATH "/rtp",
+    .method    = HTTP_GET,
+    .handler   = HTTP_Handler_RTPStatus,
+    .user_ctx  = NULL,
+    .is_websocket = false,
+    .handle_ws_control_frames = false,
+    .supported_subprotocol = NULL,
+};
+
+static const httpd_uri_t _URI_RTPControl = {
+    .uri       = HTTP_SERVER_API_BASE_PATH "/rtp",
+    .method    = HTTP_POST,
+    .handler   = HTTP_Handler_RTPControl,
+    .user_ctx  = NULL,
+    .is_websocket = false,
+    .handle_ws_control_frames = false,
+    .supported_subprotocol = NULL,
+};
+
+static const httpd_uri_t _URI_RTPSDP = {
+    .uri       = HTTP_SERVER_API_BASE_PATH "/rtp.sdp",
+    .method    = HTTP_GET,
+    .handler   = HTTP_Handler_RTPSDP,
+    .user_ctx  = NULL,
+    .is_websocket = false,
+    .handle_ws_control_frames = false,
+    .supported_subprotocol = NULL,
+};
+#endif
+
+#ifdef CONFIG_FLASH_LOG
+static const httpd_uri_t _URI_FlashLogList = {
+    .uri       = HTTP_SERVER_API_BASE_PATH "/flashlog",
+    .method    = HTTP_GET,
+    .handler   = HTTP_Handler_FlashLogList,
+    .user_ctx  = NULL,
+    .is_websocket = false,
+    .handle_ws_control_frames = false,
+    .supported_subprotocol = NULL,
+};
+
+static const httpd_uri_t _URI_FlashLogControl = {
+    .uri       = HTTP_SERVER_API_BASE_PATH "/flashlog",
+    .method    = HTTP_POST,
+    .handler   = HTTP_Handler_FlashLogControl,
+    .user_ctx  = NULL,
+    .is_websocket = false,
+    .handle_ws_control_frames = false,
+    .supported_subprotocol = NULL,
+};
+
+static const httpd_uri_t _URI_FlashLogRecord = {
+    .uri       = HTTP_SERVER_API_BASE_PATH "/flashlog/record",
+    .method    = HTTP_GET,
+    .handler   = HTTP_Handler_FlashLogRecord,
+    .user_ctx  = NULL,
+    .is_websocket = false,
+    .handle_ws_control_frames = false,
+    .supported_subprotocol = NULL,
+};
+#endif
+
+#ifdef CONFIG_NETWORK_METRICS
+static const httpd_uri_t _URI_Metrics = {
+    .uri       = HTTP_SERVER_API_BASE_PATH "/metrics",
+    .method    = HTTP_GET,
+    .handler   = HTTP_Handler_Metrics,
+    .user_ctx  = NULL,
+    .is_websocket = false,
+    .handle_ws_control_frames = false,
+    .supported_subprotocol = NULL,
+};
+#endif
+
+#ifdef CONFIG_TRACE
+static const httpd_uri_t _URI_TraceTrigger = {
+    .uri       = HTTP_SERVER_API_BASE_PATH "/trace",
+    .method    = HTTP_POST,
+    .handler   = HTTP_Handler_TraceTrigger,
+    .user_ctx  = NULL,
+    .is_websocket = false,
+    .handle_ws_control_frames = false,
+    .supported_subprotocol = NULL,
+};
+
+static const httpd_uri_t _URI_TraceDownload = {
+    .uri       = HTTP_SERVER_API_BASE_PATH "/trace",
+    .method    = HTTP_GET,
+    .handler   = HTTP_Handler_TraceDownload,
+    .user_ctx  = NULL,
+    .is_websocket = false,
+    .handle_ws_control_frames = false,
+    .supported_subprotocol = NULL,
+};
+#endif
+
+#ifdef BENCHMARK
+static const httpd_uri_t _URI_Benchmark = {
+    .uri       = HTTP_SERVER_API_BASE_PATH "/benchmark",
+    .method    = HTTP_GET,
+    .handler   = HTTP_Handler_Benchmark,
+    .user_ctx  = NULL,
+    .is_websocket = false,
+    .handle_ws_control_frames = false,
+    .supported_subprotocol = NULL,
+};
+
+static const httpd_uri_t _URI_BenchmarkWiFi = {
+    .uri       = HTTP_SERVER_API_BASE_PATH "/benchmark/wifi",
+    .method    = HTTP_GET,
+    .handler   = HTTP_Handler_BenchmarkWiFi,
+    .user_ctx  = NULL,
+    .is_websocket = false,
+    .handle_ws_control_frames = false,
+    .supported_subprotocol = NULL,
+};
+#endif
+
 static const httpd_uri_t _URI_Update = {
     .uri       = HTTP_SERVER_API_BASE_PATH "/update",
     .method    = HTTP_POST,
@@ -491,6 +2156,26 @@ static const httpd_uri_t _URI_Update = {
     .supported_subprotocol = NULL,
 };
 
+static const httpd_uri_t _URI_SDFiles = {
+    .uri       = HTTP_SERVER_API_BASE_PATH "/sd/files",
+    .method    = HTTP_GET,
+    .handler   = HTTP_Handler_SDFiles,
+    .user_ctx  = NULL,
+    .is_websocket = false,
+    .handle_ws_control_frames = false,
+    .supported_subprotocol = NULL,
+};
+
+static const httpd_uri_t _URI_SDFile = {
+    .uri       = HTTP_SERVER_API_BASE_PATH "/sd/file",
+    .method    = HTTP_GET,
+    .handler   = HTTP_Handler_SDFile,
+    .user_ctx  = NULL,
+    .is_websocket = false,
+    .handle_ws_control_frames = false,
+    .supported_subprotocol = NULL,
+};
+
 static const httpd_uri_t _URI_Options = {
     .uri       = HTTP_SERVER_API_BASE_PATH "/*",
     .method    = HTTP_OPTIONS,
@@ -565,6 +2250,21 @@ esp_err_t HTTP_Server_Init(const Network_HTTP_Server_Config_t *p_Config)
 
     ESP_LOGD(TAG, "Initializing HTTP server");
 
+    _HTTPServer_State.StreamMutex = xSemaphoreCreateMutex();
+    if (_HTTPServer_State.StreamMutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create stream mutex!");
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* Without the pool the heavy handlers run on the httpd task as before */
+    if (HTTP_Workers_Init() != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to start HTTP workers, serving all requests from the httpd task!");
+    }
+
+    memset(_HTTPServer_State.Streams, 0, sizeof(_HTTPServer_State.Streams));
+    memset(_HTTPServer_State.Waiters, 0, sizeof(_HTTPServer_State.Waiters));
+    memset(_HTTPServer_State.Downloads, 0, sizeof(_HTTPServer_State.Downloads));
+    _HTTPServer_State.WaitTask = NULL;
     memcpy(&_HTTPServer_State.Config, p_Config, sizeof(Network_HTTP_Server_Config_t));
     _HTTPServer_State.Handle = NULL;
     _HTTPServer_State.ThermalFrame = NULL;
@@ -581,6 +2281,30 @@ void HTTP_Server_Deinit(void)
     }
 
     HTTP_Server_Stop();
+
+    /* The stream, long poll and download tasks notice the stopped server within their wait timeout */
+    for (uint8_t Retry = 0; Retry < 20; Retry++) {
+        bool isBusy = (_HTTPServer_State.WaitTask != NULL);
+
+        for (uint8_t i = 0; i < HTTP_SERVER_MAX_STREAMS; i++) {
+            isBusy |= _HTTPServer_State.Streams[i].isActive;
+        }
+
+        for (uint8_t i = 0; i < CONFIG_NETWORK_DOWNLOAD_MAX; i++) {
+            isBusy |= _HTTPServer_State.Downloads[i].isActive;
+        }
+
+        if (isBusy == false) {
+            break;
+        }
+
+        vTaskDelay(100 / portTICK_PERIOD_MS);
+    }
+
+    HTTP_Workers_Deinit();
+
+    vSemaphoreDelete(_HTTPServer_State.StreamMutex);
+    _HTTPServer_State.StreamMutex = NULL;
     _HTTPServer_State.isInitialized = false;
 
     ESP_LOGD(TAG, "HTTP server deinitialized");
@@ -599,10 +2323,16 @@ esp_err_t HTTP_Server_Start(void)
 
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = _HTTPServer_State.Config.Port;
-    config.max_uri_handlers = 12;
-
-    /* Use only 2 sockets for provisioning */
-    config.max_open_sockets = 2;
+    config.max_uri_handlers = 28 + WebAssets_Count;
+
+    /* One socket per client plus one for API requests. Provisioning uses only 2 sockets. httpd needs 3 of the
+       CONFIG_LWIP_MAX_SOCKETS sockets internally */
+    config.max_open_sockets = _HTTPServer_State.Config.MaxClients + 1;
+    if (config.max_open_sockets < 2) {
+        config.max_open_sockets = 2;
+    } else if (config.max_open_sockets > (CONFIG_LWIP_MAX_SOCKETS - 3)) {
+        config.max_open_sockets = CONFIG_LWIP_MAX_SOCKETS - 3;
+    }
     config.lru_purge_enable = true;
     config.uri_match_fn = httpd_uri_match_wildcard;
 
@@ -637,13 +2367,39 @@ esp_err_t HTTP_Server_Start(void)
     httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_CaptivePortal_Generate204_NoUnderscore);
     httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_Time);
     httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_Image);
+    httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_Stream);
     httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_Telemetry);
+#ifdef CONFIG_NETWORK_RTP
+    httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_RTPStatus);
+    httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_RTPControl);
+    httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_RTPSDP);
+#endif
+#ifdef CONFIG_FLASH_LOG
+    httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_FlashLogList);
+    httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_FlashLogControl);
+    httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_FlashLogRecord);
+#endif
+#ifdef CONFIG_NETWORK_METRICS
+    httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_Metrics);
+#endif
+#ifdef CONFIG_TRACE
+    httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_TraceTrigger);
+    httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_TraceDownload);
+#endif
+#ifdef BENCHMARK
+    httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_Benchmark);
+    httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_BenchmarkWiFi);
+#endif
     httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_Update);
+    httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_SDFiles);
+    httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_SDFile);
 
     if (_HTTPServer_State.Config.EnableCORS) {
         httpd_register_uri_handler(_HTTPServer_State.Handle, &_URI_Options);
     }
 
+    WebAssets_Register(_HTTPServer_State.Handle);
+
     _HTTPServer_State.isRunning = true;
     _HTTPServer_State.StartTime = esp_timer_get_time() / 1000000;
 
@@ -671,11 +2427,55 @@ bool HTTP_Server_isRunning(void)
     return _HTTPServer_State.isRunning;
 }
 
+uint8_t HTTP_Server_GetStreamCount(void)
+{
+    uint8_t Count = 0;
+
+    if (_HTTPServer_State.isRunning == false) {
+        return 0;
+    }
+
+    xSemaphoreTake(_HTTPServer_State.StreamMutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < HTTP_SERVER_MAX_STREAMS; i++) {
+        if (_HTTPServer_State.Streams[i].isActive) {
+            Count++;
+        }
+    }
+
+    for (uint8_t i = 0; i < HTTP_SERVER_MAX_WAITERS; i++) {
+        if (_HTTPServer_State.Waiters[i].isActive) {
+            Count++;
+        }
+    }
+    xSemaphoreGive(_HTTPServer_State.StreamMutex);
+
+    return Count;
+}
+
 void HTTP_Server_SetThermalFrame(Network_Thermal_Frame_t *p_Frame)
 {
     _HTTPServer_State.ThermalFrame = p_Frame;
 }
 
+void HTTP_Server_NotifyFrameReady(void)
+{
+    /* Never block the caller, a stream that misses the notification picks the frame up with its timeout */
+    if ((_HTTPServer_State.StreamMutex == NULL) || (xSemaphoreTake(_HTTPServer_State.StreamMutex, 0) != pdTRUE)) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < HTTP_SERVER_MAX_STREAMS; i++) {
+        if (_HTTPServer_State.Streams[i].Task != NULL) {
+            xTaskNotifyGive(_HTTPServer_State.Streams[i].Task);
+        }
+    }
+
+    if (_HTTPServer_State.WaitTask != NULL) {
+        xTaskNotifyGive(_HTTPServer_State.WaitTask);
+    }
+    xSemaphoreGive(_HTTPServer_State.StreamMutex);
+}
+
 httpd_handle_t HTTP_Server_GetHandle(void)
 {
     return _HTTPServer_State.Handle;
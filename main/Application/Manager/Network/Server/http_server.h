@@ -29,6 +29,26 @@
 
 #include "../networkTypes.h"
 
+/** @brief Maximum number of simultaneous MJPEG streams (GET /api/v1/stream). The limit is also bound by MaxClients.
+ */
+#define HTTP_SERVER_MAX_STREAMS             4
+
+/** @brief Maximum number of simultaneous long polls (GET /api/v1/image?wait=).
+ */
+#define HTTP_SERVER_MAX_WAITERS             4
+
+/** @brief Upper limit of the wait time of a long poll in milliseconds.
+ */
+#define HTTP_SERVER_MAX_WAIT_MS             5000
+
+/** @brief Maximum number of directory entries of one page of GET /api/v1/sd/files.
+ */
+#define HTTP_SERVER_MAX_LIST_ENTRIES        64
+
+/** @brief Maximum length of an SD card path of the "path" query parameter.
+ */
+#define HTTP_SERVER_MAX_PATH                64
+
 /** @brief          Initialize the HTTP server.
  *  @param p_Config Pointer to server configuration.
  *  @return         ESP_OK on success.
@@ -54,11 +74,20 @@ esp_err_t HTTP_Server_Stop(void);
  */
 bool HTTP_Server_isRunning(void);
 
+/** @brief  Get the number of MJPEG streams and pending long polls.
+ *  @return Number of streaming clients
+ */
+uint8_t HTTP_Server_GetStreamCount(void);
+
 /** @brief              Set thermal frame data for image endpoint.
  *  @param p_Frame      Pointer to thermal frame data.
  */
 void HTTP_Server_SetThermalFrame(Network_Thermal_Frame_t *p_Frame);
 
+/** @brief Signal the MJPEG streams and long polls that a new frame is ready (non-blocking).
+ */
+void HTTP_Server_NotifyFrameReady(void);
+
 /** @brief  Get the HTTP server handle for WebSocket registration.
  *  @return HTTP server handle or NULL if not running
  */
@@ -28,8 +28,14 @@
 #include "websocket_handler.h"
 #include "VISA/visaServer.h"
 #include "ImageEncoder/imageEncoder.h"
+#include "Telemetry/telemetry.h"
+#include "Metrics/metrics.h"
+#include "RTP/rtpStreamer.h"
 
-/** @brief          Initialize the complete server (HTTP + WebSocket + Image Encoder + VISA).
+#include "Application/Tasks/Lepton/frameProducts.h"
+
+/** @brief          Initialize the complete server (HTTP + WebSocket + Image Encoder + Telemetry + Metrics + VISA +
+ *                  RTP).
  *  @param p_Config Pointer to server configuration
  *  @return         ESP_OK on success
  */
@@ -43,8 +49,25 @@ static inline esp_err_t Server_Init(const Network_Server_Config_t *p_Config)
         return Error;
     }
 
+    Error = Telemetry_Init();
+    if (Error != ESP_OK) {
+        ImageEncoder_Deinit();
+        return Error;
+    }
+
+#ifdef CONFIG_NETWORK_METRICS
+    /* The metrics are only diagnostics, the server also runs without them */
+    Metrics_Init();
+#endif
+
+#ifdef CONFIG_NETWORK_RTP
+    /* Optional as well, the other outputs do not depend on it */
+    RTPStreamer_Init();
+#endif
+
     Error = HTTP_Server_Init(&p_Config->HTTP_Server);
     if (Error != ESP_OK) {
+        Telemetry_Deinit();
         ImageEncoder_Deinit();
         return Error;
     }
@@ -52,6 +75,7 @@ static inline esp_err_t Server_Init(const Network_Server_Config_t *p_Config)
     Error = WebSocket_Handler_Init(&p_Config->HTTP_Server);
     if (Error != ESP_OK) {
         HTTP_Server_Deinit();
+        Telemetry_Deinit();
         ImageEncoder_Deinit();
         return Error;
     }
@@ -60,6 +84,7 @@ static inline esp_err_t Server_Init(const Network_Server_Config_t *p_Config)
     if (Error != ESP_OK) {
         WebSocket_Handler_Deinit();
         HTTP_Server_Deinit();
+        Telemetry_Deinit();
         ImageEncoder_Deinit();
         return Error;
     }
@@ -72,8 +97,15 @@ static inline esp_err_t Server_Init(const Network_Server_Config_t *p_Config)
 static inline void Server_Deinit(void)
 {
     VISAServer_Deinit();
+#ifdef CONFIG_NETWORK_RTP
+    RTPStreamer_Deinit();
+#endif
     WebSocket_Handler_Deinit();
     HTTP_Server_Deinit();
+#ifdef CONFIG_NETWORK_METRICS
+    Metrics_Deinit();
+#endif
+    Telemetry_Deinit();
     ImageEncoder_Deinit();
 }
 
@@ -102,6 +134,17 @@ static inline esp_err_t Server_Start(void)
         return Error;
     }
 
+    /* The frame temperatures of the streams come from the statistics and the spotmeter ROI. The encoders colorize
+       the RAW14 data themselves */
+    FrameProducts_Subscribe(FRAME_CONSUMER_NETWORK, FRAME_PRODUCT_RAW | FRAME_PRODUCT_STATISTICS | FRAME_PRODUCT_ROI);
+
+#ifdef CONFIG_NETWORK_RTP_AUTOSTART
+    RTPStreamer_Config_t RTPConfig;
+
+    RTPStreamer_GetDefaultConfig(&RTPConfig);
+    RTPStreamer_Start(&RTPConfig);
+#endif
+
     return ESP_OK;
 }
 
@@ -110,6 +153,12 @@ static inline esp_err_t Server_Start(void)
  */
 static inline esp_err_t Server_Stop(void)
 {
+    FrameProducts_Subscribe(FRAME_CONSUMER_NETWORK, 0);
+
+#ifdef CONFIG_NETWORK_RTP
+    RTPStreamer_Stop();
+#endif
+
     WebSocket_Handler_StopTask();
 
     return HTTP_Server_Stop();
@@ -123,13 +172,17 @@ static inline bool Server_isRunning(void)
     return HTTP_Server_isRunning();
 }
 
-/** @brief          Set thermal frame data for both HTTP and WebSocket endpoints.
+/** @brief          Set thermal frame data for the HTTP, WebSocket and RTP endpoints and the telemetry.
  *  @param p_Frame  Pointer to thermal frame data
  */
 static inline void Server_SetThermalFrame(Network_Thermal_Frame_t *p_Frame)
 {
     HTTP_Server_SetThermalFrame(p_Frame);
     WebSocket_Handler_SetThermalFrame(p_Frame);
+    Telemetry_SetThermalFrame(p_Frame);
+#ifdef CONFIG_NETWORK_RTP
+    RTPStreamer_SetThermalFrame(p_Frame);
+#endif
 }
 
 #endif /* SERVER_H_ */
@@ -23,12 +23,23 @@
 
 #include <esp_log.h>
 #include <esp_timer.h>
+#include <esp_random.h>
 #include <cJSON.h>
 
 #include <cstring>
 
 #include "websocket_handler.h"
 #include "ImageEncoder/imageEncoder.h"
+#include "Backfill/backfillRing.h"
+#include "Telemetry/telemetry.h"
+#include "Application/Boot/boot.h"
+#include "Application/Trace/trace.h"
+#include "Application/Memory/memoryPlan.h"
+#include "Application/Topology/topology.h"
+#include "Application/Tasks/Lepton/frameLatency.h"
+#include "Application/Tasks/Lepton/frameReplay.h"
+#include "Application/Tasks/Lepton/spotTracker.h"
+#include "Application/application.h"
 
 /** @brief WebSocket client state.
  */
@@ -37,13 +48,94 @@ typedef struct {
     bool active;
     bool stream_enabled;
     bool telemetry_enabled;
+    bool telemetry_binary;                                      /**< true to send the telemetry as binary message. */
     Network_ImageFormat_t stream_format;
+    Server_Palette_t stream_palette;
+    Network_ImageLevel_t stream_level;                          /**< Pyramid level of the stream. */
+    Network_ImageWindow_t stream_window;                        /**< Crop window, Width 0 for the full frame. */
     uint8_t stream_fps;
     uint32_t telemetry_interval_ms;
     uint32_t last_telemetry_time;
     uint32_t last_frame_time;
+    Network_Encoded_Image_t send_queue[WS_SEND_QUEUE_DEPTH];   /**< Frames waiting for the send, oldest at send_head. */
+    uint8_t send_head;
+    uint8_t send_count;
+    bool send_busy;                                             /**< true while sending is in the httpd queue. */
+    Network_Encoded_Image_t sending;                            /**< Frame of the pending asynchronous send. */
+    uint8_t send_failures;                                      /**< Consecutive send errors. */
+    uint32_t frames_sent;
+    uint32_t frames_dropped;
+    uint32_t send_errors;
+    bool adaptive;                                              /**< true when quality and frame rate follow the link. */
+    uint8_t stream_quality;                                     /**< JPEG quality, 0 for the default quality. */
+    uint8_t quality_min;
+    uint8_t quality_max;
+    uint8_t fps_min;
+    uint8_t fps_max;
+    uint32_t send_start_time;                                   /**< Start of the pending send in ms. */
+    uint32_t latency_ms;                                        /**< Smoothed send latency in ms. */
+    uint32_t adapt_time;                                        /**< Time of the last adaption step in ms. */
+    uint32_t adapt_dropped;                                     /**< frames_dropped at the last adaption step. */
+    Server_Palette_t sent_palette;                              /**< Palette the client has received for indexed frames,
+                                                                     PALETTE_COUNT if none. */
+    bool needs_keyframe;                                        /**< true until a radiometric keyframe is queued. */
+    uint32_t idle_reference;                                    /**< Keyframe the client shows without changes, 0 if
+                                                                     the last frame has changed tiles. */
+    uint32_t session;                                           /**< Session of a resumable stream, 0 if none. */
+    uint32_t backfill_next;                                     /**< Next frame from the backfill ring, 0 while the
+                                                                     client gets the live frames. */
+    uint32_t frames_backfilled;
+    uint8_t rx_buffer[WS_RX_BUFFER_SIZE];                       /**< Received message, used by the httpd task only. */
 } WS_Client_t;
 
+/** @brief Thermal frame encoded with one format, palette, quality, pyramid level and crop window.
+ */
+typedef struct {
+    Network_ImageFormat_t Format;
+    Server_Palette_t Palette;
+    uint8_t Quality;
+    Network_ImageLevel_t Level;
+    Network_ImageWindow_t Window;
+    Network_Encoded_Image_t Image;
+} WS_Encoded_Variant_t;
+
+/** @brief One thermal frame encoded for every format, palette, quality, pyramid level and crop window in use.
+ *         There is at most one variant per client.
+ */
+typedef struct {
+    uint8_t Count;
+    WS_Encoded_Variant_t Variants[WS_MAX_CLIENTS];
+} WS_Encoded_Frame_t;
+
+/** @brief Parameters of a start command, from the JSON or the binary command.
+ */
+typedef struct {
+    Network_ImageFormat_t Format;
+    Server_Palette_t Palette;                   /**< PALETTE_COUNT keeps the palette. */
+    Network_ImageLevel_t Level;
+    Network_ImageWindow_t Window;               /**< Crop window, Width 0 for the full frame. */
+    uint8_t Fps;                                /**< 0 keeps the frame rate. */
+    uint8_t Quality;                            /**< 0 for the default quality. */
+    bool isAdaptive;
+    uint8_t QualityMin;                         /**< Bounds of an adaptive stream, 0 for the defaults. */
+    uint8_t QualityMax;
+    uint8_t FpsMin;
+    uint8_t FpsMax;                             /**< 0 for the frame rate of the stream. */
+} WS_Start_t;
+
+/** @brief Radiometric stream of a client that lost its connection. The session waits
+ *         CONFIG_NETWORK_WS_RESUME_TIMEOUT seconds for a resume command, the backfill ring records the frames in the
+ *         meantime.
+ */
+typedef struct {
+    uint32_t Id;                                /**< Session, 0 for a free entry. */
+    uint32_t Parked;                            /**< Time of the disconnect in ms. */
+    uint8_t Fps;
+    bool isAdaptive;
+    uint8_t FpsMin;
+    uint8_t FpsMax;
+} WS_Session_t;
+
 typedef struct {
     bool isInitialized;
     httpd_handle_t ServerHandle;
@@ -53,8 +145,20 @@ typedef struct {
     Network_Thermal_Frame_t *ThermalFrame;
     SemaphoreHandle_t ClientsMutex;
     TaskHandle_t BroadcastTask;
+    TaskHandle_t EncodeTask;
     QueueHandle_t FrameReadyQueue;
+    QueueHandle_t EncodedQueue;                 /**< Encoded frames from the encode task to the broadcast task. */
     bool TaskRunning;
+    bool isRecording;                           /**< true while the backfill ring records the frames. */
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+    WS_Session_t Sessions[WS_MAX_CLIENTS];      /**< Parked sessions. */
+#endif
+#ifdef CONFIG_LEPTON_SPOTS
+    esp_event_handler_instance_t AlarmHandler;
+#endif
+#ifdef CONFIG_LEPTON_FFC
+    esp_event_handler_instance_t FFCHandler;
+#endif
 } WebSocket_Handler_State_t;
 
 static WebSocket_Handler_State_t _WSHandler_State;
@@ -71,6 +175,8 @@ static WS_Client_t *WS_FindClient(int FD)
 
     for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
         if (_WSHandler_State.Clients[i].active && _WSHandler_State.Clients[i].fd == FD) {
+            xSemaphoreGive(_WSHandler_State.ClientsMutex);
+
             return &_WSHandler_State.Clients[i];
         }
     }
@@ -94,11 +200,30 @@ static WS_Client_t *WS_AddClient(int FD)
             _WSHandler_State.Clients[i].active = true;
             _WSHandler_State.Clients[i].stream_enabled = false;
             _WSHandler_State.Clients[i].telemetry_enabled = false;
+            _WSHandler_State.Clients[i].telemetry_binary = false;
             _WSHandler_State.Clients[i].stream_format = NETWORK_IMAGE_FORMAT_JPEG;
+            _WSHandler_State.Clients[i].stream_palette = PALETTE_IRON;
+            _WSHandler_State.Clients[i].stream_level = NETWORK_IMAGE_LEVEL_NATIVE;
+            memset(&_WSHandler_State.Clients[i].stream_window, 0, sizeof(Network_ImageWindow_t));
             _WSHandler_State.Clients[i].stream_fps = 8;
             _WSHandler_State.Clients[i].telemetry_interval_ms = 1000;
             _WSHandler_State.Clients[i].last_telemetry_time = 0;
             _WSHandler_State.Clients[i].last_frame_time = 0;
+            _WSHandler_State.Clients[i].send_head = 0;
+            _WSHandler_State.Clients[i].send_count = 0;
+            _WSHandler_State.Clients[i].send_failures = 0;
+            _WSHandler_State.Clients[i].frames_sent = 0;
+            _WSHandler_State.Clients[i].frames_dropped = 0;
+            _WSHandler_State.Clients[i].send_errors = 0;
+            _WSHandler_State.Clients[i].adaptive = false;
+            _WSHandler_State.Clients[i].stream_quality = 0;
+            _WSHandler_State.Clients[i].latency_ms = 0;
+            _WSHandler_State.Clients[i].sent_palette = PALETTE_COUNT;
+            _WSHandler_State.Clients[i].needs_keyframe = true;
+            _WSHandler_State.Clients[i].idle_reference = 0;
+            _WSHandler_State.Clients[i].session = 0;
+            _WSHandler_State.Clients[i].backfill_next = 0;
+            _WSHandler_State.Clients[i].frames_backfilled = 0;
             _WSHandler_State.ClientCount++;
 
             xSemaphoreGive(_WSHandler_State.ClientsMutex);
@@ -115,6 +240,96 @@ static WS_Client_t *WS_AddClient(int FD)
     return NULL;
 }
 
+/** @brief          Free all frames in the send queue of a client. A pending send is freed by its completion
+ *                  callback. Call with the clients mutex taken.
+ *  @param p_Client Client pointer
+ */
+static void WS_FlushClient(WS_Client_t *p_Client)
+{
+    while (p_Client->send_count > 0) {
+        ImageEncoder_Free(&p_Client->send_queue[p_Client->send_head]);
+        p_Client->send_head = (p_Client->send_head + 1) % WS_SEND_QUEUE_DEPTH;
+        p_Client->send_count--;
+    }
+
+    p_Client->send_head = 0;
+}
+
+/** @brief          Park the session of a radiometric stream whose client is gone, so the client can resume the stream
+ *                  after a reconnect. The oldest parked session is replaced when all entries are taken.
+ *                  Call with the clients mutex taken.
+ *  @param p_Client Client pointer
+ */
+static void WS_ParkSession(WS_Client_t *p_Client)
+{
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+    WS_Session_t *Session;
+    uint32_t Now;
+
+    if ((p_Client->session == 0) || (p_Client->stream_enabled == false)) {
+        return;
+    }
+
+    Now = esp_timer_get_time() / 1000;
+
+    Session = NULL;
+    for (uint8_t i = 0; (i < WS_MAX_CLIENTS) && (Session == NULL); i++) {
+        if (_WSHandler_State.Sessions[i].Id == 0) {
+            Session = &_WSHandler_State.Sessions[i];
+        }
+    }
+
+    if (Session == NULL) {
+        Session = &_WSHandler_State.Sessions[0];
+        for (uint8_t i = 1; i < WS_MAX_CLIENTS; i++) {
+            if ((Now - _WSHandler_State.Sessions[i].Parked) > (Now - Session->Parked)) {
+                Session = &_WSHandler_State.Sessions[i];
+            }
+        }
+
+        ESP_LOGW(TAG, "Session %08lx replaced!", static_cast<unsigned long>(Session->Id));
+    }
+
+    Session->Id = p_Client->session;
+    Session->Parked = Now;
+    Session->Fps = p_Client->stream_fps;
+    Session->isAdaptive = p_Client->adaptive;
+    Session->FpsMin = p_Client->fps_min;
+    Session->FpsMax = p_Client->fps_max;
+
+    ESP_LOGI(TAG, "Session %08lx of fd=%d parked", static_cast<unsigned long>(Session->Id), p_Client->fd);
+#endif
+
+    p_Client->session = 0;
+    p_Client->backfill_next = 0;
+}
+
+/** @brief          Let the backfill send a frame of a session stream again that was dropped or failed to send. The
+ *                  queued frames are flushed, the backfill ring sends them again in order.
+ *                  Call with the clients mutex taken.
+ *  @param p_Client Client pointer
+ *  @param Sequence Sequence number of the lost frame
+ *  @return         true if the backfill takes over the frame
+ */
+static bool WS_Rewind(WS_Client_t *p_Client, uint32_t Sequence)
+{
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+    if ((p_Client->active == false) || (p_Client->session == 0) || (Sequence == 0)) {
+        return false;
+    }
+
+    if ((p_Client->backfill_next == 0) || (static_cast<int32_t>(Sequence - p_Client->backfill_next) < 0)) {
+        p_Client->backfill_next = Sequence;
+    }
+
+    WS_FlushClient(p_Client);
+
+    return true;
+#else
+    return false;
+#endif
+}
+
 /** @brief      Remove a client.
  *  @param FD   File descriptor
  */
@@ -126,6 +341,8 @@ static void WS_RemoveClient(int FD)
         if (_WSHandler_State.Clients[i].active && _WSHandler_State.Clients[i].fd == FD) {
             _WSHandler_State.Clients[i].active = false;
             _WSHandler_State.ClientCount--;
+            WS_ParkSession(&_WSHandler_State.Clients[i]);
+            WS_FlushClient(&_WSHandler_State.Clients[i]);
 
             ESP_LOGI(TAG, "Client removed: fd=%d, total=%d", FD, _WSHandler_State.ClientCount);
             break;
@@ -172,88 +389,501 @@ static esp_err_t WS_SendJSON(int FD, const char *p_Cmd, cJSON *p_Data)
     return err;
 }
 
-/** @brief          Send binary frame to a client.
- *  @param FD       File descriptor
- *  @param p_Data   Binary data
- *  @param Length   Data length
- *  @return         ESP_OK on success
+static void WS_KickClient(uint8_t Index);
+
+/** @brief          Register a send error of a client and remove the client after WS_SEND_MAX_ERRORS errors in a row.
+ *                  Call with the clients mutex taken.
+ *  @param p_Client Client pointer
  */
-static esp_err_t WS_SendBinary(int FD, const uint8_t *p_Data, size_t Length)
+static void WS_HandleSendError(WS_Client_t *p_Client)
 {
-    httpd_ws_frame_t Frame = {
-        .final = true,
-        .fragmented = false,
-        .type = HTTPD_WS_TYPE_BINARY,
-        .payload = (uint8_t *)p_Data,
-        .len = Length,
-    };
+    p_Client->send_errors++;
+    p_Client->send_failures++;
+
+    /* The lost message may have been the palette or the keyframe */
+    p_Client->sent_palette = PALETTE_COUNT;
+    p_Client->needs_keyframe = true;
+    p_Client->idle_reference = 0;
+
+    if (p_Client->active && (p_Client->send_failures >= WS_SEND_MAX_ERRORS)) {
+        ESP_LOGW(TAG, "Removing client fd=%d due to send failure", p_Client->fd);
+        p_Client->active = false;
+        _WSHandler_State.ClientCount--;
+        WS_ParkSession(p_Client);
+        WS_FlushClient(p_Client);
+    }
+}
 
-    /* Try to send with retry logic to handle queue congestion */
-    esp_err_t err = ESP_FAIL;
-    for (uint8_t retry = 0; retry < 3; retry++) {
-        err = httpd_ws_send_frame_async(_WSHandler_State.ServerHandle, FD, &Frame);
+/** @brief          Completion callback of an asynchronous binary send. Runs in the httpd task.
+ *  @param Error    Result of the send
+ *  @param Socket   Socket of the client
+ *  @param p_Arg    Client slot index
+ */
+static void WS_OnSendComplete(esp_err_t Error, int Socket, void *p_Arg)
+{
+    uint8_t Index = static_cast<uint8_t>(reinterpret_cast<uintptr_t>(p_Arg));
+    WS_Client_t *client = &_WSHandler_State.Clients[Index];
+    uint32_t Sequence;
+    uint32_t Timestamp;
 
-        if (err == ESP_OK) {
-            /* Send queued successfully - add small delay to prevent queue overflow */
-            vTaskDelay(5 / portTICK_PERIOD_MS);
-            break;
+    TRACE_ASYNC_END(TRACE_EVENT_WS_SEND, Index);
+
+    xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
+
+    Sequence = client->sending.sequence;
+    Timestamp = client->sending.timestamp;
+
+    ImageEncoder_Free(&client->sending);
+    client->send_busy = false;
+
+    /* The slot may have been reused by another client in the meantime */
+    if (client->active && (client->fd == Socket)) {
+        if (Error == ESP_OK) {
+            uint32_t Latency = (esp_timer_get_time() / 1000) - client->send_start_time;
+
+            if (Sequence != 0) {
+                FrameLatency_Mark(FRAME_LATENCY_SEND, Sequence, static_cast<int64_t>(Timestamp) * 1000);
+            }
+
+            client->frames_sent++;
+            client->send_failures = 0;
+            client->latency_ms = (client->latency_ms == 0) ? Latency : ((client->latency_ms * 3) + Latency) / 4;
+
+            Boot_Mark(BOOT_PHASE_FIRST_NETWORK);
+            Telemetry_FrameSent();
+        } else {
+            ESP_LOGW(TAG, "Failed to send frame to fd=%d: %s", Socket, esp_err_to_name(Error));
+            WS_Rewind(client, Sequence);
+            WS_HandleSendError(client);
+        }
+    }
+
+    WS_KickClient(Index);
+
+    xSemaphoreGive(_WSHandler_State.ClientsMutex);
+}
+
+/** @brief          Start the asynchronous send of the oldest queued frame of a client if no send is pending.
+ *                  Call with the clients mutex taken.
+ *  @param Index    Client slot index
+ */
+static void WS_KickClient(uint8_t Index)
+{
+    WS_Client_t *client = &_WSHandler_State.Clients[Index];
+
+    while (client->active && (client->send_busy == false) && (client->send_count > 0)) {
+        esp_err_t err;
+
+        client->sending = client->send_queue[client->send_head];
+        client->send_head = (client->send_head + 1) % WS_SEND_QUEUE_DEPTH;
+        client->send_count--;
+
+        httpd_ws_frame_t Frame = {
+            .final = true,
+            .fragmented = false,
+            .type = HTTPD_WS_TYPE_BINARY,
+            .payload = client->sending.data,
+            .len = client->sending.size,
+        };
+
+        /* The payload stays referenced until WS_OnSendComplete is called */
+        client->send_busy = true;
+        client->send_start_time = esp_timer_get_time() / 1000;
+        TRACE_ASYNC_BEGIN(TRACE_EVENT_WS_SEND, Index);
+        err = httpd_ws_send_data_async(_WSHandler_State.ServerHandle, client->fd, &Frame, WS_OnSendComplete,
+                                       reinterpret_cast<void *>(static_cast<uintptr_t>(Index)));
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to queue frame to fd=%d: %s", client->fd, esp_err_to_name(err));
+            TRACE_ASYNC_END(TRACE_EVENT_WS_SEND, Index);
+            ImageEncoder_Free(&client->sending);
+            client->send_busy = false;
+            WS_HandleSendError(client);
+        }
+    }
+}
+
+/** @brief          Queue a frame for a client. The oldest frame is dropped when the queue is full.
+ *                  Call with the clients mutex taken.
+ *  @param Index    Client slot index
+ *  @param p_Image  Encoded image, the queue takes its own reference
+ */
+static void WS_QueueFrame(uint8_t Index, const Network_Encoded_Image_t *p_Image)
+{
+    WS_Client_t *client = &_WSHandler_State.Clients[Index];
+    uint8_t Slot;
+
+    if (client->send_count >= WS_SEND_QUEUE_DEPTH) {
+        /* A session stream gets the queued frames and this one from the backfill ring, nothing is lost */
+        if (WS_Rewind(client, client->send_queue[client->send_head].sequence)) {
+            return;
+        }
+
+        /* The client lags behind, only the latest frames matter. A dropped palette or keyframe is sent again */
+        if (client->send_queue[client->send_head].format == NETWORK_IMAGE_FORMAT_PALETTE) {
+            client->sent_palette = PALETTE_COUNT;
+        } else if (client->send_queue[client->send_head].isKeyframe) {
+            client->needs_keyframe = true;
         }
 
-        /* Queue might be full, wait and retry */
-        ESP_LOGW(TAG, "Failed to queue frame to fd=%d (retry %d): %s",
-                 FD, retry + 1, esp_err_to_name(err));
-        vTaskDelay(50 / portTICK_PERIOD_MS);
+        ImageEncoder_Free(&client->send_queue[client->send_head]);
+        client->send_head = (client->send_head + 1) % WS_SEND_QUEUE_DEPTH;
+        client->send_count--;
+        client->frames_dropped++;
     }
 
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to send binary frame to fd=%d after retries: %s (len=%zu)",
-                 FD, esp_err_to_name(err), Length);
+    Slot = (client->send_head + client->send_count) % WS_SEND_QUEUE_DEPTH;
+    if (ImageEncoder_Retain(p_Image, &client->send_queue[Slot]) != ESP_OK) {
+        if (p_Image->format == NETWORK_IMAGE_FORMAT_PALETTE) {
+            client->sent_palette = PALETTE_COUNT;
+        } else if (p_Image->isKeyframe) {
+            client->needs_keyframe = true;
+        }
+
+        client->frames_dropped++;
+        return;
     }
 
-    return err;
+    client->send_count++;
+
+    WS_KickClient(Index);
 }
 
-/** @brief              Handle start command.
- *  @param p_Client     Client pointer
+/** @brief          Clamp a number.
+ *  @param Value    Number
+ *  @param Min      Minimum value
+ *  @param Max      Maximum value
+ *  @return         Number clamped to Min and Max
+ */
+static int WS_Clamp(int Value, int Min, int Max)
+{
+    if (Value < Min) {
+        return Min;
+    }
+
+    if (Value > Max) {
+        return Max;
+    }
+
+    return Value;
+}
+
+/** @brief              Read an optional number from a command.
  *  @param p_Data       Command data
+ *  @param p_Name       Name of the number
+ *  @param Min          Minimum value
+ *  @param Max          Maximum value
+ *  @param Default      Value if the number is missing
+ *  @return             Number clamped to Min and Max
  */
-static void WS_HandleStart(WS_Client_t *p_Client, cJSON *p_Data)
+static int WS_GetNumber(cJSON *p_Data, const char *p_Name, int Min, int Max, int Default)
 {
-    cJSON *fps = cJSON_GetObjectItem(p_Data, "fps");
+    cJSON *item = cJSON_GetObjectItem(p_Data, p_Name);
 
-    /* Set FPS (default 8) */
-    if (cJSON_IsNumber(fps)) {
-        p_Client->stream_fps = (uint8_t)fps->valueint;
-        if (p_Client->stream_fps < 1) {
-            p_Client->stream_fps = 1;
-        }
-        if (p_Client->stream_fps > 30) {
-            p_Client->stream_fps = 30;
+    return WS_Clamp(cJSON_IsNumber(item) ? item->valueint : Default, Min, Max);
+}
+
+/** @brief              Read the optional "crop" and "zoom" of a command.
+ *  @param p_Data       Command data
+ *  @param p_Window     Pointer to store the window, Width 0 without a "crop"
+ */
+static void WS_GetWindow(cJSON *p_Data, Network_ImageWindow_t *p_Window)
+{
+    cJSON *crop = cJSON_GetObjectItem(p_Data, "crop");
+    uint16_t Region[4];
+
+    memset(p_Window, 0, sizeof(Network_ImageWindow_t));
+    if ((cJSON_IsArray(crop) == false) || (cJSON_GetArraySize(crop) != 4)) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < 4; i++) {
+        cJSON *item = cJSON_GetArrayItem(crop, i);
+
+        Region[i] = (cJSON_IsNumber(item) && (item->valueint > 0)) ?
+                    static_cast<uint16_t>((item->valueint > UINT16_MAX) ? UINT16_MAX : item->valueint) : 0;
+    }
+
+    p_Window->X = Region[0];
+    p_Window->Y = Region[1];
+    p_Window->Width = Region[2];
+    p_Window->Height = Region[3];
+    p_Window->Zoom = WS_GetNumber(p_Data, "zoom", 1, IMAGE_ENCODER_MAX_ZOOM, 1);
+}
+
+/** @brief              Set the crop window of a stream. A window replaces the pyramid level. It is clipped here
+ *                      already, so clients with the same region share one encode.
+ *  @param p_Client     Client pointer
+ *  @param p_Window     Requested window, Width 0 for the full frame
+ */
+static void WS_SetWindow(WS_Client_t *p_Client, const Network_ImageWindow_t *p_Window)
+{
+    if (p_Window->Width == 0) {
+        memset(&p_Client->stream_window, 0, sizeof(Network_ImageWindow_t));
+        return;
+    }
+
+    p_Client->stream_window = *p_Window;
+
+    p_Client->stream_window.Zoom = WS_Clamp(p_Client->stream_window.Zoom, 1, IMAGE_ENCODER_MAX_ZOOM);
+
+    if (_WSHandler_State.ThermalFrame != NULL) {
+        ImageEncoder_ClipWindow(_WSHandler_State.ThermalFrame->width, _WSHandler_State.ThermalFrame->height,
+                                &p_Client->stream_window);
+    }
+
+    if (p_Client->stream_window.Width != 0) {
+        p_Client->stream_level = NETWORK_IMAGE_LEVEL_NATIVE;
+    }
+}
+
+/** @brief          Get the name of a stream format.
+ *  @param Format   Image format
+ *  @return         Name used by the start command
+ */
+static const char *WS_GetFormatName(Network_ImageFormat_t Format)
+{
+    switch (Format) {
+        case NETWORK_IMAGE_FORMAT_INDEXED:
+            return "indexed";
+        case NETWORK_IMAGE_FORMAT_RADIOMETRIC:
+            return "radiometric";
+        case NETWORK_IMAGE_FORMAT_TEMPERATURE:
+            return "temperature";
+        default:
+            return "jpeg";
+    }
+}
+
+/** @brief              Start the stream of a client and send the ACK.
+ *  @param p_Client     Client pointer
+ *  @param p_Start      Parameters of the stream
+ */
+static void WS_StartStream(WS_Client_t *p_Client, const WS_Start_t *p_Start)
+{
+    uint8_t Quality;
+
+    p_Client->stream_format = p_Start->Format;
+
+    if (p_Start->Fps != 0) {
+        p_Client->stream_fps = WS_Clamp(p_Start->Fps, 1, 30);
+    }
+
+    if (p_Start->Palette < PALETTE_COUNT) {
+        p_Client->stream_palette = p_Start->Palette;
+    }
+
+    p_Client->stream_level = (p_Start->Level < NETWORK_IMAGE_LEVEL_COUNT) ? p_Start->Level :
+                             NETWORK_IMAGE_LEVEL_NATIVE;
+    WS_SetWindow(p_Client, &p_Start->Window);
+
+    /* Fixed quality, 0 uses the default quality of the encoder */
+    Quality = WS_Clamp(p_Start->Quality, 0, 100);
+
+    p_Client->adaptive = p_Start->isAdaptive;
+    if (p_Client->adaptive) {
+        /* Keep the bounds on the quality grid */
+        p_Client->quality_min = WS_Clamp((p_Start->QualityMin != 0) ? p_Start->QualityMin : 30, WS_ADAPT_QUALITY_STEP,
+                                         100);
+        p_Client->quality_min = ((p_Client->quality_min + WS_ADAPT_QUALITY_STEP - 1) / WS_ADAPT_QUALITY_STEP) *
+                                WS_ADAPT_QUALITY_STEP;
+        p_Client->quality_max = WS_Clamp((p_Start->QualityMax != 0) ? p_Start->QualityMax : 90, p_Client->quality_min,
+                                         100);
+        p_Client->quality_max = (p_Client->quality_max / WS_ADAPT_QUALITY_STEP) * WS_ADAPT_QUALITY_STEP;
+        p_Client->quality_max = (p_Client->quality_max < p_Client->quality_min) ? p_Client->quality_min :
+                                p_Client->quality_max;
+        p_Client->fps_min = WS_Clamp((p_Start->FpsMin != 0) ? p_Start->FpsMin : 1, 1, 30);
+        p_Client->fps_max = WS_Clamp((p_Start->FpsMax != 0) ? p_Start->FpsMax : p_Client->stream_fps,
+                                     p_Client->fps_min, 30);
+
+        /* Start at the default quality on the quality grid and ramp from there */
+        if (Quality == 0) {
+            Quality = ImageEncoder_GetQuality();
         }
+        Quality = (Quality / WS_ADAPT_QUALITY_STEP) * WS_ADAPT_QUALITY_STEP;
+        Quality = (Quality < p_Client->quality_min) ? p_Client->quality_min : Quality;
+        Quality = (Quality > p_Client->quality_max) ? p_Client->quality_max : Quality;
+
+        p_Client->stream_fps = (p_Client->stream_fps < p_Client->fps_min) ? p_Client->fps_min : p_Client->stream_fps;
+        p_Client->stream_fps = (p_Client->stream_fps > p_Client->fps_max) ? p_Client->fps_max : p_Client->stream_fps;
+        p_Client->adapt_time = esp_timer_get_time() / 1000;
+        p_Client->adapt_dropped = p_Client->frames_dropped;
+        p_Client->latency_ms = 0;
+    }
+
+    /* Pin the quality of the other formats to 0, so the adaption only steps the frame rate */
+    if (p_Client->stream_format != NETWORK_IMAGE_FORMAT_JPEG) {
+        Quality = 0;
+        p_Client->quality_min = 0;
+        p_Client->quality_max = 0;
+    }
+
+    /* The encoder sends the measurement formats at the native level only */
+    if ((p_Client->stream_format == NETWORK_IMAGE_FORMAT_RADIOMETRIC) ||
+        (p_Client->stream_format == NETWORK_IMAGE_FORMAT_TEMPERATURE)) {
+        p_Client->stream_level = NETWORK_IMAGE_LEVEL_NATIVE;
+        memset(&p_Client->stream_window, 0, sizeof(Network_ImageWindow_t));
+    }
+
+    p_Client->stream_quality = Quality;
+    p_Client->sent_palette = PALETTE_COUNT;
+    p_Client->needs_keyframe = true;
+    p_Client->idle_reference = 0;
+    p_Client->backfill_next = 0;
+    p_Client->session = 0;
+
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+    /* Radiometric streams can be resumed, the frames are recorded from now on */
+    if (p_Client->stream_format == NETWORK_IMAGE_FORMAT_RADIOMETRIC) {
+        do {
+            p_Client->session = esp_random();
+        } while (p_Client->session == 0);
+
+        _WSHandler_State.isRecording = true;
     }
+#endif
 
-    /* Always use JPEG format for simplicity and efficiency */
-    p_Client->stream_format = NETWORK_IMAGE_FORMAT_JPEG;
     p_Client->stream_enabled = true;
     p_Client->last_frame_time = 0;
 
-    ESP_LOGI(TAG, "Stream started for fd=%d, fps=%d", p_Client->fd, p_Client->stream_fps);
+    ESP_LOGI(TAG, "Stream started for fd=%d, format=%d, fps=%d, palette=%d, quality=%d, level=%d, adaptive=%d",
+             p_Client->fd, p_Client->stream_format, p_Client->stream_fps, p_Client->stream_palette,
+             p_Client->stream_quality, p_Client->stream_level, p_Client->adaptive);
 
     /* Send ACK */
     cJSON *response = cJSON_CreateObject();
     cJSON_AddStringToObject(response, "status", "ok");
+    cJSON_AddStringToObject(response, "format", WS_GetFormatName(p_Client->stream_format));
     cJSON_AddNumberToObject(response, "fps", p_Client->stream_fps);
+    cJSON_AddNumberToObject(response, "quality",
+                            (p_Client->stream_quality != 0) ? p_Client->stream_quality : ImageEncoder_GetQuality());
+    cJSON_AddStringToObject(response, "level", ImageEncoder_GetLevelName(p_Client->stream_level));
+    if (p_Client->stream_window.Width != 0) {
+        const int Region[4] = {p_Client->stream_window.X, p_Client->stream_window.Y, p_Client->stream_window.Width,
+                               p_Client->stream_window.Height};
+
+        cJSON_AddItemToObject(response, "crop", cJSON_CreateIntArray(Region, 4));
+        cJSON_AddNumberToObject(response, "zoom", p_Client->stream_window.Zoom);
+    }
+    cJSON_AddBoolToObject(response, "adaptive", p_Client->adaptive);
+    if (p_Client->session != 0) {
+        cJSON_AddNumberToObject(response, "session", p_Client->session);
+    }
     WS_SendJSON(p_Client->fd, "started", response);
     cJSON_Delete(response);
 }
 
+/** @brief              Handle start command.
+ *                      Optional parameters: "format", "fps", "palette", "quality", "level", "crop", "zoom" and
+ *                      "adaptive". Adaptive streams follow the link between "quality_min" / "quality_max" and
+ *                      "fps_min" / "fps_max".
+ *                      The "level" selects the image pyramid: "half" for thumbnails, "native" or "double". Clients
+ *                      of the same level share one encode.
+ *                      "crop" ([x, y, width, height] in pixels of the native frame) and "zoom" (1 to
+ *                      IMAGE_ENCODER_MAX_ZOOM) stream a region of the frame instead of a level. Only the region is
+ *                      scaled, colorized and encoded.
+ *                      The "indexed" format sends 8 bit palette indices and the palette whenever it changes, the
+ *                      client applies the colors. The "radiometric" format sends the lossless RAW frame as keyframe
+ *                      or as difference to the last keyframe. The "temperature" format sends the uncompressed map
+ *                      in centi-Kelvin with the radiometric parameters. They have no quality and adapt the frame rate
+ *                      only.
+ *  @param p_Client     Client pointer
+ *  @param p_Data       Command data
+ */
+static void WS_HandleStart(WS_Client_t *p_Client, cJSON *p_Data)
+{
+    cJSON *format = cJSON_GetObjectItem(p_Data, "format");
+    cJSON *palette = cJSON_GetObjectItem(p_Data, "palette");
+    cJSON *level = cJSON_GetObjectItem(p_Data, "level");
+    WS_Start_t Start;
+
+    memset(&Start, 0, sizeof(WS_Start_t));
+
+    Start.Format = NETWORK_IMAGE_FORMAT_JPEG;
+    if (cJSON_IsString(format)) {
+        if (strcmp(format->valuestring, "indexed") == 0) {
+            Start.Format = NETWORK_IMAGE_FORMAT_INDEXED;
+        } else if (strcmp(format->valuestring, "radiometric") == 0) {
+            Start.Format = NETWORK_IMAGE_FORMAT_RADIOMETRIC;
+        } else if (strcmp(format->valuestring, "temperature") == 0) {
+            Start.Format = NETWORK_IMAGE_FORMAT_TEMPERATURE;
+        }
+    }
+
+    /* Set FPS (default 8) */
+    Start.Fps = WS_GetNumber(p_Data, "fps", 1, 30, p_Client->stream_fps);
+
+    /* Unknown names keep the current palette */
+    Start.Palette = PALETTE_COUNT;
+    if (cJSON_IsString(palette)) {
+        ImageEncoder_GetPaletteByName(palette->valuestring, &Start.Palette);
+    }
+
+    /* Unknown names use the native level */
+    Start.Level = NETWORK_IMAGE_LEVEL_NATIVE;
+    if (cJSON_IsString(level)) {
+        ImageEncoder_GetLevelByName(level->valuestring, &Start.Level);
+    }
+
+    WS_GetWindow(p_Data, &Start.Window);
+
+    Start.Quality = WS_GetNumber(p_Data, "quality", 0, 100, 0);
+    Start.isAdaptive = cJSON_IsTrue(cJSON_GetObjectItem(p_Data, "adaptive"));
+    Start.QualityMin = WS_GetNumber(p_Data, "quality_min", WS_ADAPT_QUALITY_STEP, 100, 30);
+    Start.QualityMax = WS_GetNumber(p_Data, "quality_max", 1, 100, 90);
+    Start.FpsMin = WS_GetNumber(p_Data, "fps_min", 1, 30, 1);
+    Start.FpsMax = WS_GetNumber(p_Data, "fps_max", 0, 30, 0);
+
+    WS_StartStream(p_Client, &Start);
+}
+
+/** @brief              Move the crop window of a stream without a restart, e.g. for a zoom that follows the pointer
+ *                      of the client. There is no response, the next frame has the new window.
+ *  @param p_Client     Client pointer
+ *  @param p_Window     Requested window, Width 0 for the full frame at the native level
+ */
+static void WS_MoveWindow(WS_Client_t *p_Client, const Network_ImageWindow_t *p_Window)
+{
+    /* The encoder sends the measurement formats at the native level only */
+    if ((p_Client->stream_format == NETWORK_IMAGE_FORMAT_RADIOMETRIC) ||
+        (p_Client->stream_format == NETWORK_IMAGE_FORMAT_TEMPERATURE)) {
+        return;
+    }
+
+    /* The encode task reads the window together with the level */
+    xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
+    p_Client->stream_level = NETWORK_IMAGE_LEVEL_NATIVE;
+    WS_SetWindow(p_Client, p_Window);
+    xSemaphoreGive(_WSHandler_State.ClientsMutex);
+
+    ESP_LOGD(TAG, "Window of fd=%d: %u, %u, %u x %u, zoom %u", p_Client->fd, p_Client->stream_window.X,
+             p_Client->stream_window.Y, p_Client->stream_window.Width, p_Client->stream_window.Height,
+             p_Client->stream_window.Zoom);
+}
+
+/** @brief              Handle window command. Parameters: "crop" and "zoom" as for the start command.
+ *  @param p_Client     Client pointer
+ *  @param p_Data       Command data
+ */
+static void WS_HandleWindow(WS_Client_t *p_Client, cJSON *p_Data)
+{
+    Network_ImageWindow_t Window;
+
+    WS_GetWindow(p_Data, &Window);
+    WS_MoveWindow(p_Client, &Window);
+}
+
 /** @brief              Handle stop command.
  *  @param p_Client     Client pointer
  */
 static void WS_HandleStop(WS_Client_t *p_Client)
 {
+    /* A stopped stream ends its session, it is not parked */
+    xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
     p_Client->stream_enabled = false;
     p_Client->last_frame_time = 0;
+    p_Client->session = 0;
+    p_Client->backfill_next = 0;
+    xSemaphoreGive(_WSHandler_State.ClientsMutex);
 
     ESP_LOGI(TAG, "Stream stopped for fd=%d", p_Client->fd);
 
@@ -263,25 +893,22 @@ static void WS_HandleStop(WS_Client_t *p_Client)
     cJSON_Delete(response);
 }
 
-/** @brief              Handle subscribe command.
+/** @brief              Subscribe the telemetry of a client and send the ACK.
  *  @param p_Client     Client pointer
- *  @param p_Data       Command data
+ *  @param Interval     Update interval in ms, 0 keeps the interval
+ *  @param isBinary     true to send the telemetry as binary message
  */
-static void WS_HandleTelemetrySubscribe(WS_Client_t *p_Client, cJSON *p_Data)
+static void WS_Subscribe(WS_Client_t *p_Client, uint32_t Interval, bool isBinary)
 {
-    cJSON *interval = cJSON_GetObjectItem(p_Data, "interval");
-
-    if (cJSON_IsNumber(interval)) {
-        p_Client->telemetry_interval_ms = (uint32_t)interval->valueint;
-        if (p_Client->telemetry_interval_ms < 100) {
-            p_Client->telemetry_interval_ms = 100;
-        }
+    if (Interval != 0) {
+        p_Client->telemetry_interval_ms = (Interval < TELEMETRY_MAX_AGE_MS) ? TELEMETRY_MAX_AGE_MS : Interval;
     }
 
+    p_Client->telemetry_binary = isBinary;
     p_Client->telemetry_enabled = true;
 
-    ESP_LOGI(TAG, "Telemetry subscribed for fd=%d, interval=%lu ms",
-             p_Client->fd, p_Client->telemetry_interval_ms);
+    ESP_LOGI(TAG, "Telemetry subscribed for fd=%d, interval=%lu ms, binary=%d",
+             p_Client->fd, p_Client->telemetry_interval_ms, p_Client->telemetry_binary);
 
     cJSON *response = cJSON_CreateObject();
     cJSON_AddStringToObject(response, "status", "ok");
@@ -289,6 +916,24 @@ static void WS_HandleTelemetrySubscribe(WS_Client_t *p_Client, cJSON *p_Data)
     cJSON_Delete(response);
 }
 
+/** @brief              Handle subscribe command.
+ *  @param p_Client     Client pointer
+ *  @param p_Data       Command data
+ */
+static void WS_HandleTelemetrySubscribe(WS_Client_t *p_Client, cJSON *p_Data)
+{
+    cJSON *interval = cJSON_GetObjectItem(p_Data, "interval");
+    uint32_t Interval;
+
+    /* The minimum interval is taken for 0 and below */
+    Interval = 0;
+    if (cJSON_IsNumber(interval)) {
+        Interval = (interval->valueint > 0) ? static_cast<uint32_t>(interval->valueint) : 1;
+    }
+
+    WS_Subscribe(p_Client, Interval, cJSON_IsTrue(cJSON_GetObjectItem(p_Data, "binary")));
+}
+
 /** @brief              Handle unsubscribe command.
  *  @param p_Client     Client pointer
  */
@@ -304,43 +949,350 @@ static void WS_HandleTelemetryUnsubscribe(WS_Client_t *p_Client)
     cJSON_Delete(response);
 }
 
-/** @brief              Process incoming WebSocket message.
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+/** @brief              Resume the radiometric stream of a session and send the ACK. The frames after Sequence are
+ *                      sent from the backfill ring as keyframes, as fast as the link takes them, and the live frames
+ *                      follow without a gap. A parked session moves to the client. The session of the running
+ *                      stream of the client fills a gap in the frames the client has received.
  *  @param p_Client     Client pointer
- *  @param p_Data       Message data
- *  @param length       Message length
+ *  @param Session      Session of the "started" response
+ *  @param Sequence     Sequence number of the last frame the client has received
  */
-static void WS_ProcessMessage(WS_Client_t *p_Client, const char *p_Data, size_t length)
+static void WS_Resume(WS_Client_t *p_Client, uint32_t Session, uint32_t Sequence)
 {
-    cJSON *json = cJSON_ParseWithLength(p_Data, length);
-    if (json == NULL) {
-        ESP_LOGW(TAG, "Invalid JSON from fd=%d", p_Client->fd);
-        return;
+    uint32_t Now;
+    uint32_t Oldest;
+    uint32_t Newest;
+    uint32_t Next;
+    uint32_t Missed;
+    bool isKnown;
+
+    Now = esp_timer_get_time() / 1000;
+    Next = 0;
+    Missed = 0;
+    Newest = 0;
+
+    xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
+
+    isKnown = (Session != 0) && (p_Client->session == Session) && p_Client->stream_enabled;
+
+    for (uint8_t i = 0; (i < WS_MAX_CLIENTS) && (isKnown == false) && (Session != 0); i++) {
+        WS_Session_t *Parked = &_WSHandler_State.Sessions[i];
+
+        if ((Parked->Id != Session) || ((Now - Parked->Parked) >= (CONFIG_NETWORK_WS_RESUME_TIMEOUT * 1000UL))) {
+            continue;
+        }
+
+        p_Client->stream_format = NETWORK_IMAGE_FORMAT_RADIOMETRIC;
+        p_Client->stream_level = NETWORK_IMAGE_LEVEL_NATIVE;
+        memset(&p_Client->stream_window, 0, sizeof(Network_ImageWindow_t));
+        p_Client->stream_quality = 0;
+        p_Client->stream_fps = Parked->Fps;
+        p_Client->adaptive = Parked->isAdaptive;
+        p_Client->quality_min = 0;
+        p_Client->quality_max = 0;
+        p_Client->fps_min = Parked->FpsMin;
+        p_Client->fps_max = Parked->FpsMax;
+        p_Client->adapt_time = Now;
+        p_Client->adapt_dropped = p_Client->frames_dropped;
+        p_Client->latency_ms = 0;
+        p_Client->session = Session;
+
+        Parked->Id = 0;
+        isKnown = true;
     }
 
-    cJSON *cmd = cJSON_GetObjectItem(json, "cmd");
-    cJSON *data = cJSON_GetObjectItem(json, "data");
+    if (isKnown) {
+        Next = Sequence + 1;
 
-    if (cJSON_IsString(cmd) == false) {
-        ESP_LOGW(TAG, "Invalid message format from fd=%d", p_Client->fd);
-        cJSON_Delete(json);
-        return;
+        /* Frames that are no longer in the ring are lost, the client is told how many */
+        if (BackfillRing_GetRange(&Oldest, &Newest)) {
+            if (static_cast<int32_t>(Next - Oldest) < 0) {
+                Missed = Oldest - Next;
+                Next = Oldest;
+            } else if (static_cast<int32_t>(Next - (Newest + 1)) > 0) {
+                Next = Newest + 1;
+            }
+        }
+
+        /* 0 is no sequence number of the frame pool */
+        Next = (Next == 0) ? 1 : Next;
+
+        /* Queued live frames would arrive ahead of the older frames of the ring */
+        WS_FlushClient(p_Client);
+        p_Client->backfill_next = Next;
+        p_Client->frames_dropped += Missed;
+        p_Client->sent_palette = PALETTE_COUNT;
+        p_Client->needs_keyframe = true;
+        p_Client->idle_reference = 0;
+        p_Client->last_frame_time = 0;
+        p_Client->stream_enabled = true;
+        _WSHandler_State.isRecording = true;
     }
 
-    /* Handle commands */
-    const char *cmd_str = cmd->valuestring;
-    if (strcmp(cmd_str, "start") == 0) {
-        WS_HandleStart(p_Client, data);
-    } else if (strcmp(cmd_str, "stop") == 0) {
-        WS_HandleStop(p_Client);
-    } else if (strcmp(cmd_str, "subscribe") == 0) {
-        WS_HandleTelemetrySubscribe(p_Client, data);
-    } else if (strcmp(cmd_str, "unsubscribe") == 0) {
-        WS_HandleTelemetryUnsubscribe(p_Client);
+    xSemaphoreGive(_WSHandler_State.ClientsMutex);
+
+    if (isKnown) {
+        ESP_LOGI(TAG, "Session %08lx resumed by fd=%d at %lu, %lu frames missed", static_cast<unsigned long>(Session),
+                 p_Client->fd, static_cast<unsigned long>(Next), static_cast<unsigned long>(Missed));
     } else {
-        ESP_LOGW(TAG, "Unknown command from fd=%d: %s", p_Client->fd, cmd_str);
+        ESP_LOGW(TAG, "Session %08lx of fd=%d expired!", static_cast<unsigned long>(Session), p_Client->fd);
     }
 
-    cJSON_Delete(json);
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "status", isKnown ? "ok" : "expired");
+    cJSON_AddNumberToObject(response, "session", Session);
+    if (isKnown) {
+        cJSON_AddNumberToObject(response, "sequence", Next);
+        cJSON_AddNumberToObject(response, "missed", Missed);
+        cJSON_AddNumberToObject(response, "latest", Newest);
+    }
+    WS_SendJSON(p_Client->fd, "resumed", response);
+    cJSON_Delete(response);
+}
+
+/** @brief              Handle resume command. Parameters: "session" of the "started" response and "sequence" of the
+ *                      last frame the client has received.
+ *  @param p_Client     Client pointer
+ *  @param p_Data       Command data
+ */
+static void WS_HandleResume(WS_Client_t *p_Client, cJSON *p_Data)
+{
+    cJSON *session = cJSON_GetObjectItem(p_Data, "session");
+    cJSON *sequence = cJSON_GetObjectItem(p_Data, "sequence");
+
+    WS_Resume(p_Client, cJSON_IsNumber(session) ? static_cast<uint32_t>(session->valuedouble) : 0,
+              cJSON_IsNumber(sequence) ? static_cast<uint32_t>(sequence->valuedouble) : 0);
+}
+#endif
+
+#ifdef CONFIG_LEPTON_REPLAY
+/** @brief              Handle replay command. The host records are sent as binary messages after the start.
+ *  @param p_Client     Client pointer
+ *  @param p_Data       Command data
+ */
+static void WS_HandleReplay(WS_Client_t *p_Client, cJSON *p_Data)
+{
+    FrameReplay_Status_t Status;
+    esp_err_t Error;
+    cJSON *source = cJSON_GetObjectItem(p_Data, "source");
+    cJSON *path = cJSON_GetObjectItem(p_Data, "path");
+    cJSON *loop = cJSON_GetObjectItem(p_Data, "loop");
+    const char *source_str = cJSON_IsString(source) ? source->valuestring : "status";
+    static const char *SourceNames[] = {"off", "sd", "host"};
+
+    Error = ESP_OK;
+    if (strcmp(source_str, "off") == 0) {
+        Error = FrameReplay_Stop();
+    } else if (strcmp(source_str, "host") == 0) {
+        Error = FrameReplay_StartHost();
+    } else if (strcmp(source_str, "sd") == 0) {
+        if (cJSON_IsString(path) == false) {
+            Error = ESP_ERR_INVALID_ARG;
+        } else {
+            Error = FrameReplay_StartFile(path->valuestring, WS_GetNumber(p_Data, "rate", 0, 27, 0),
+                                          cJSON_IsTrue(loop));
+        }
+    } else if (strcmp(source_str, "status") != 0) {
+        Error = ESP_ERR_INVALID_ARG;
+    }
+
+    if (Error != ESP_OK) {
+        ESP_LOGW(TAG, "Replay %s for fd=%d failed: %d", source_str, p_Client->fd, Error);
+    } else {
+        ESP_LOGI(TAG, "Replay %s for fd=%d", source_str, p_Client->fd);
+    }
+
+    FrameReplay_GetStatus(&Status);
+
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "status", (Error == ESP_OK) ? "ok" : esp_err_to_name(Error));
+    cJSON_AddStringToObject(response, "source", SourceNames[Status.Source]);
+    cJSON_AddNumberToObject(response, "rate", Status.Rate);
+    cJSON_AddBoolToObject(response, "loop", Status.isLoop);
+    cJSON_AddNumberToObject(response, "frames", Status.Frames);
+    cJSON_AddNumberToObject(response, "dropped", Status.Dropped);
+    cJSON_AddNumberToObject(response, "errors", Status.Errors);
+    WS_SendJSON(p_Client->fd, "replay", response);
+    cJSON_Delete(response);
+}
+#endif
+
+/** @brief              Process incoming WebSocket message.
+ *  @param p_Client     Client pointer
+ *  @param p_Data       Message data
+ *  @param length       Message length
+ */
+static void WS_ProcessMessage(WS_Client_t *p_Client, const char *p_Data, size_t length)
+{
+    cJSON *json = cJSON_ParseWithLength(p_Data, length);
+    if (json == NULL) {
+        ESP_LOGW(TAG, "Invalid JSON from fd=%d", p_Client->fd);
+        return;
+    }
+
+    cJSON *cmd = cJSON_GetObjectItem(json, "cmd");
+    cJSON *data = cJSON_GetObjectItem(json, "data");
+
+    if (cJSON_IsString(cmd) == false) {
+        ESP_LOGW(TAG, "Invalid message format from fd=%d", p_Client->fd);
+        cJSON_Delete(json);
+        return;
+    }
+
+    /* Handle commands */
+    const char *cmd_str = cmd->valuestring;
+    if (strcmp(cmd_str, "start") == 0) {
+        WS_HandleStart(p_Client, data);
+    } else if (strcmp(cmd_str, "window") == 0) {
+        WS_HandleWindow(p_Client, data);
+    } else if (strcmp(cmd_str, "stop") == 0) {
+        WS_HandleStop(p_Client);
+    } else if (strcmp(cmd_str, "subscribe") == 0) {
+        WS_HandleTelemetrySubscribe(p_Client, data);
+    } else if (strcmp(cmd_str, "unsubscribe") == 0) {
+        WS_HandleTelemetryUnsubscribe(p_Client);
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+    } else if (strcmp(cmd_str, "resume") == 0) {
+        WS_HandleResume(p_Client, data);
+#endif
+#ifdef CONFIG_LEPTON_REPLAY
+    } else if (strcmp(cmd_str, "replay") == 0) {
+        WS_HandleReplay(p_Client, data);
+#endif
+    } else {
+        ESP_LOGW(TAG, "Unknown command from fd=%d: %s", p_Client->fd, cmd_str);
+    }
+
+    cJSON_Delete(json);
+}
+
+/** @brief              Copy the parameters of a binary command. Parameters the client did not send are 0, so older
+ *                      clients get the defaults of the new parameters.
+ *  @param p_Command    Pointer to store the parameters
+ *  @param Size         Size of the parameter structure
+ *  @param p_Data       Parameters of the message
+ *  @param Length       Length of the parameters in the message
+ */
+static void WS_GetParameters(void *p_Command, size_t Size, const uint8_t *p_Data, size_t Length)
+{
+    memset(p_Command, 0, Size);
+    memcpy(p_Command, p_Data, (Length < Size) ? Length : Size);
+}
+
+/** @brief              Process a binary command. The commands are handled like the JSON commands with the same name
+ *                      and get the same JSON responses, but a command is parsed without any allocation.
+ *  @param p_Client     Client pointer
+ *  @param p_Data       Message data, starts with a WebSocket_Command_Header_t
+ *  @param Length       Message length
+ */
+static void WS_ProcessCommand(WS_Client_t *p_Client, const uint8_t *p_Data, size_t Length)
+{
+    WebSocket_Command_Header_t Header;
+    const uint8_t *p_Parameters;
+
+    /* The message has no alignment */
+    memcpy(&Header, p_Data, sizeof(WebSocket_Command_Header_t));
+    if (Length < (sizeof(WebSocket_Command_Header_t) + Header.Length)) {
+        ESP_LOGW(TAG, "Truncated command %u from fd=%d", Header.Command, p_Client->fd);
+        return;
+    }
+
+    p_Parameters = p_Data + sizeof(WebSocket_Command_Header_t);
+
+    switch (Header.Command) {
+        case WS_COMMAND_START: {
+            WebSocket_Command_Start_t Command;
+            WS_Start_t Start;
+
+            WS_GetParameters(&Command, sizeof(Command), p_Parameters, Header.Length);
+
+            /* Only the formats of the JSON command, the others are no streams */
+            switch (Command.Format) {
+                case NETWORK_IMAGE_FORMAT_INDEXED:
+                case NETWORK_IMAGE_FORMAT_RADIOMETRIC:
+                case NETWORK_IMAGE_FORMAT_TEMPERATURE: {
+                    Start.Format = static_cast<Network_ImageFormat_t>(Command.Format);
+
+                    break;
+                }
+                default: {
+                    Start.Format = NETWORK_IMAGE_FORMAT_JPEG;
+
+                    break;
+                }
+            }
+
+            Start.Palette = (Command.Palette < PALETTE_COUNT) ? static_cast<Server_Palette_t>(Command.Palette) :
+                            PALETTE_COUNT;
+            Start.Level = (Command.Level < NETWORK_IMAGE_LEVEL_COUNT) ?
+                          static_cast<Network_ImageLevel_t>(Command.Level) : NETWORK_IMAGE_LEVEL_NATIVE;
+            Start.Window.X = Command.X;
+            Start.Window.Y = Command.Y;
+            Start.Window.Width = Command.Width;
+            Start.Window.Height = Command.Height;
+            Start.Window.Zoom = Command.Zoom;
+            Start.Fps = Command.Fps;
+            Start.Quality = Command.Quality;
+            Start.isAdaptive = (Command.Flags & WS_COMMAND_FLAG_ADAPTIVE) != 0;
+            Start.QualityMin = Command.QualityMin;
+            Start.QualityMax = Command.QualityMax;
+            Start.FpsMin = Command.FpsMin;
+            Start.FpsMax = Command.FpsMax;
+
+            WS_StartStream(p_Client, &Start);
+
+            break;
+        }
+        case WS_COMMAND_STOP: {
+            WS_HandleStop(p_Client);
+
+            break;
+        }
+        case WS_COMMAND_SUBSCRIBE: {
+            WebSocket_Command_Subscribe_t Command;
+
+            WS_GetParameters(&Command, sizeof(Command), p_Parameters, Header.Length);
+            WS_Subscribe(p_Client, Command.Interval, (Command.Flags & WS_COMMAND_FLAG_BINARY) != 0);
+
+            break;
+        }
+        case WS_COMMAND_UNSUBSCRIBE: {
+            WS_HandleTelemetryUnsubscribe(p_Client);
+
+            break;
+        }
+        case WS_COMMAND_WINDOW: {
+            WebSocket_Command_Window_t Command;
+            Network_ImageWindow_t Window;
+
+            WS_GetParameters(&Command, sizeof(Command), p_Parameters, Header.Length);
+            Window.X = Command.X;
+            Window.Y = Command.Y;
+            Window.Width = Command.Width;
+            Window.Height = Command.Height;
+            Window.Zoom = Command.Zoom;
+
+            WS_MoveWindow(p_Client, &Window);
+
+            break;
+        }
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+        case WS_COMMAND_RESUME: {
+            WebSocket_Command_Resume_t Command;
+
+            WS_GetParameters(&Command, sizeof(Command), p_Parameters, Header.Length);
+            WS_Resume(p_Client, Command.Session, Command.Sequence);
+
+            break;
+        }
+#endif
+        default: {
+            ESP_LOGW(TAG, "Unknown command %u from fd=%d", Header.Command, p_Client->fd);
+
+            break;
+        }
+    }
 }
 
 /** @brief WebSocket handler callback.
@@ -350,6 +1302,7 @@ static esp_err_t WS_Handler(httpd_req_t *p_Request)
     httpd_ws_frame_t Frame;
     esp_err_t Error;
     WS_Client_t *Client;
+    bool isPooled;
     int FD;
 
     /* Handle new connection */
@@ -374,26 +1327,35 @@ static esp_err_t WS_Handler(httpd_req_t *p_Request)
         return Error;
     }
 
+    FD = httpd_req_to_sockfd(p_Request);
+    Client = WS_FindClient(FD);
+
+    /* Commands and control frames fit into the buffer of the client, only large messages need an allocation */
+    isPooled = (Client != NULL) && (Frame.len < WS_RX_BUFFER_SIZE);
     if (Frame.len > 0) {
-        Frame.payload = (uint8_t *)heap_caps_malloc(Frame.len + 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-        if (Frame.payload == NULL) {
-            ESP_LOGE(TAG, "Failed to allocate frame buffer!");
-            return ESP_ERR_NO_MEM;
+        if (isPooled) {
+            Frame.payload = Client->rx_buffer;
+        } else {
+            Frame.payload = reinterpret_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, Frame.len + 1,
+                                                                         "ws_message"));
+            if (Frame.payload == NULL) {
+                ESP_LOGE(TAG, "Failed to allocate frame buffer!");
+                return ESP_ERR_NO_MEM;
+            }
         }
 
         Error = httpd_ws_recv_frame(p_Request, &Frame, Frame.len);
         if (Error != ESP_OK) {
             ESP_LOGE(TAG, "Failed to receive frame: %d!", Error);
-            free(Frame.payload);
+            if (isPooled == false) {
+                MemoryPlan_Free(Frame.payload);
+            }
             return Error;
         }
 
         Frame.payload[Frame.len] = '\0';
     }
 
-    FD = httpd_req_to_sockfd(p_Request);
-    Client = WS_FindClient(FD);
-
     switch (Frame.type) {
         case HTTPD_WS_TYPE_TEXT: {
             if (Client != NULL && Frame.payload != NULL) {
@@ -402,6 +1364,30 @@ static esp_err_t WS_Handler(httpd_req_t *p_Request)
 
             break;
         }
+        case HTTPD_WS_TYPE_BINARY: {
+            uint16_t Magic;
+
+            if ((Client == NULL) || (Frame.len < sizeof(WebSocket_Command_Header_t))) {
+                break;
+            }
+
+            memcpy(&Magic, Frame.payload, sizeof(Magic));
+            if (Magic == WS_COMMAND_MAGIC) {
+                WS_ProcessCommand(Client, Frame.payload, Frame.len);
+            } else {
+#ifdef CONFIG_LEPTON_REPLAY
+                /* Records of a host replay, the frame rate is set by the host */
+                Error = FrameReplay_Push(Frame.payload, Frame.len);
+                if (Error != ESP_OK) {
+                    ESP_LOGD(TAG, "Replay record from fd=%d rejected: %d", FD, Error);
+                }
+#else
+                ESP_LOGW(TAG, "Unknown binary message from fd=%d", FD);
+#endif
+            }
+
+            break;
+        }
         case HTTPD_WS_TYPE_CLOSE: {
             ESP_LOGI(TAG, "WebSocket close from fd=%d", FD);
             WS_RemoveClient(FD);
@@ -447,8 +1433,8 @@ static esp_err_t WS_Handler(httpd_req_t *p_Request)
         }
     }
 
-    if (Frame.payload != NULL) {
-        free(Frame.payload);
+    if ((Frame.payload != NULL) && (isPooled == false)) {
+        MemoryPlan_Free(Frame.payload);
     }
 
     return ESP_OK;
@@ -464,6 +1450,94 @@ static const httpd_uri_t _URI_WebSocket = {
     .supported_subprotocol = NULL,
 };
 
+#ifdef CONFIG_LEPTON_SPOTS
+/** @brief                  Spot alarm event handler. Sends the alarm to every connected client.
+ *  @param p_HandlerArgs    Unused
+ *  @param Base             Event base
+ *  @param ID               Event ID
+ *  @param p_Data           SpotTracker_Event_t
+ */
+static void on_WS_SpotAlarm(void *p_HandlerArgs, esp_event_base_t Base, int32_t ID, void *p_Data)
+{
+    const SpotTracker_Event_t *p_Event;
+    cJSON *data;
+
+    p_Event = reinterpret_cast<const SpotTracker_Event_t *>(p_Data);
+
+    if ((_WSHandler_State.isInitialized == false) || (_WSHandler_State.ServerHandle == NULL) ||
+        (_WSHandler_State.ClientCount == 0)) {
+        return;
+    }
+
+    data = cJSON_CreateObject();
+    if (data == NULL) {
+        return;
+    }
+
+    cJSON_AddNumberToObject(data, "number", p_Event->Number);
+    cJSON_AddNumberToObject(data, "sequence", p_Event->Sequence);
+    cJSON_AddStringToObject(data, "kind", (p_Event->Kind == SPOT_TRACKER_HOT) ? "hot" : "cold");
+    cJSON_AddStringToObject(data, "state", (p_Event->Type == SPOT_TRACKER_EVENT_RAISED) ? "raised" : "cleared");
+    cJSON_AddNumberToObject(data, "id", p_Event->ID);
+    cJSON_AddNumberToObject(data, "x", p_Event->X);
+    cJSON_AddNumberToObject(data, "y", p_Event->Y);
+    cJSON_AddNumberToObject(data, "temp", (p_Event->Peak != 0) ? ((p_Event->Peak / 100.0) - 273.15) : 0);
+
+    xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (_WSHandler_State.Clients[i].active) {
+            WS_SendJSON(_WSHandler_State.Clients[i].fd, "alarm", data);
+        }
+    }
+    xSemaphoreGive(_WSHandler_State.ClientsMutex);
+
+    cJSON_Delete(data);
+}
+#endif
+
+#ifdef CONFIG_LEPTON_FFC
+/** @brief                  Flat field correction event handler. Sends the state to every connected client, so a
+ *                          client knows why the stream pauses.
+ *  @param p_HandlerArgs    Unused
+ *  @param Base             Event base
+ *  @param ID               Event ID
+ *  @param p_Data           App_Lepton_FFC_t
+ */
+static void on_WS_FFC(void *p_HandlerArgs, esp_event_base_t Base, int32_t ID, void *p_Data)
+{
+    const App_Lepton_FFC_t *p_FFC;
+    cJSON *data;
+
+    p_FFC = reinterpret_cast<const App_Lepton_FFC_t *>(p_Data);
+
+    if ((_WSHandler_State.isInitialized == false) || (_WSHandler_State.ServerHandle == NULL) ||
+        (_WSHandler_State.ClientCount == 0)) {
+        return;
+    }
+
+    data = cJSON_CreateObject();
+    if (data == NULL) {
+        return;
+    }
+
+    cJSON_AddNumberToObject(data, "number", p_FFC->Number);
+    cJSON_AddNumberToObject(data, "sequence", p_FFC->Sequence);
+    cJSON_AddStringToObject(data, "state", p_FFC->isActive ? "started" : "finished");
+    cJSON_AddNumberToObject(data, "frames", p_FFC->Frames);
+    cJSON_AddNumberToObject(data, "duration", p_FFC->Duration);
+
+    xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (_WSHandler_State.Clients[i].active) {
+            WS_SendJSON(_WSHandler_State.Clients[i].fd, "ffc", data);
+        }
+    }
+    xSemaphoreGive(_WSHandler_State.ClientsMutex);
+
+    cJSON_Delete(data);
+}
+#endif
+
 esp_err_t WebSocket_Handler_Init(const Network_HTTP_Server_Config_t *p_Config)
 {
     if (p_Config == NULL) {
@@ -483,8 +1557,14 @@ esp_err_t WebSocket_Handler_Init(const Network_HTTP_Server_Config_t *p_Config)
     _WSHandler_State.ThermalFrame = NULL;
     _WSHandler_State.ServerHandle = NULL;
     _WSHandler_State.BroadcastTask = NULL;
+    _WSHandler_State.EncodeTask = NULL;
     _WSHandler_State.FrameReadyQueue = NULL;
+    _WSHandler_State.EncodedQueue = NULL;
     _WSHandler_State.TaskRunning = false;
+    _WSHandler_State.isRecording = false;
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+    memset(_WSHandler_State.Sessions, 0, sizeof(_WSHandler_State.Sessions));
+#endif
 
     _WSHandler_State.ClientsMutex = xSemaphoreCreateMutex();
     if (_WSHandler_State.ClientsMutex == NULL) {
@@ -500,6 +1580,41 @@ esp_err_t WebSocket_Handler_Init(const Network_HTTP_Server_Config_t *p_Config)
         return ESP_ERR_NO_MEM;
     }
 
+#ifdef CONFIG_NETWORK_ENCODER_PIPELINE
+    /* One frame in flight between encoder and sender, the sender holds the previous one */
+    _WSHandler_State.EncodedQueue = xQueueCreate(1, sizeof(WS_Encoded_Frame_t));
+    if (_WSHandler_State.EncodedQueue == NULL) {
+        ESP_LOGE(TAG, "Failed to create encoded frame queue!");
+        vQueueDelete(_WSHandler_State.FrameReadyQueue);
+        vSemaphoreDelete(_WSHandler_State.ClientsMutex);
+        return ESP_ERR_NO_MEM;
+    }
+#endif
+
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+    /* Without the ring the streams are not resumable, the resume command answers "expired" */
+    if (BackfillRing_Init(CONFIG_NETWORK_WS_BACKFILL_FRAMES) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to initialize backfill ring!");
+    }
+#endif
+
+#ifdef CONFIG_LEPTON_SPOTS
+    /* The server works without the alarms */
+    if (esp_event_handler_instance_register(LEPTON_EVENTS, LEPTON_EVENT_SPOT_ALARM, &on_WS_SpotAlarm, NULL,
+                                            &_WSHandler_State.AlarmHandler) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to register alarm handler!");
+        _WSHandler_State.AlarmHandler = NULL;
+    }
+#endif
+
+#ifdef CONFIG_LEPTON_FFC
+    if (esp_event_handler_instance_register(LEPTON_EVENTS, LEPTON_EVENT_FFC, &on_WS_FFC, NULL,
+                                            &_WSHandler_State.FFCHandler) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to register FFC handler!");
+        _WSHandler_State.FFCHandler = NULL;
+    }
+#endif
+
     _WSHandler_State.isInitialized = true;
 
     return ESP_OK;
@@ -513,11 +1628,35 @@ void WebSocket_Handler_Deinit(void)
 
     WebSocket_Handler_StopTask();
 
+#ifdef CONFIG_LEPTON_SPOTS
+    if (_WSHandler_State.AlarmHandler != NULL) {
+        esp_event_handler_instance_unregister(LEPTON_EVENTS, LEPTON_EVENT_SPOT_ALARM, _WSHandler_State.AlarmHandler);
+        _WSHandler_State.AlarmHandler = NULL;
+    }
+#endif
+
+#ifdef CONFIG_LEPTON_FFC
+    if (_WSHandler_State.FFCHandler != NULL) {
+        esp_event_handler_instance_unregister(LEPTON_EVENTS, LEPTON_EVENT_FFC, _WSHandler_State.FFCHandler);
+        _WSHandler_State.FFCHandler = NULL;
+    }
+#endif
+
     if (_WSHandler_State.FrameReadyQueue != NULL) {
         vQueueDelete(_WSHandler_State.FrameReadyQueue);
         _WSHandler_State.FrameReadyQueue = NULL;
     }
 
+    if (_WSHandler_State.EncodedQueue != NULL) {
+        vQueueDelete(_WSHandler_State.EncodedQueue);
+        _WSHandler_State.EncodedQueue = NULL;
+    }
+
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+    BackfillRing_Deinit();
+    _WSHandler_State.isRecording = false;
+#endif
+
     if (_WSHandler_State.ClientsMutex != NULL) {
         vSemaphoreDelete(_WSHandler_State.ClientsMutex);
         _WSHandler_State.ClientsMutex = NULL;
@@ -561,6 +1700,25 @@ bool WebSocket_Handler_HasClients(void)
     return _WSHandler_State.ClientCount > 0;
 }
 
+uint8_t WebSocket_Handler_GetStreamCount(void)
+{
+    uint8_t Count = 0;
+
+    if (_WSHandler_State.isInitialized == false) {
+        return 0;
+    }
+
+    xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (_WSHandler_State.Clients[i].active && _WSHandler_State.Clients[i].stream_enabled) {
+            Count++;
+        }
+    }
+    xSemaphoreGive(_WSHandler_State.ClientsMutex);
+
+    return Count;
+}
+
 void WebSocket_Handler_SetThermalFrame(Network_Thermal_Frame_t *p_Frame)
 {
     xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
@@ -568,81 +1726,494 @@ void WebSocket_Handler_SetThermalFrame(Network_Thermal_Frame_t *p_Frame)
     xSemaphoreGive(_WSHandler_State.ClientsMutex);
 }
 
-/** @brief          Broadcast task function - runs in separate task to avoid blocking GUI.
- *  @param p_Param  Task parameter (unused)
+/** @brief          Find the image of a frame for a format, palette, quality, pyramid level and crop window.
+ *  @param p_Frame  Encoded frame
+ *  @param Format   Image format
+ *  @param Palette  Color palette
+ *  @param Quality  JPEG quality, 0 for the default quality
+ *  @param Level    Pyramid level
+ *  @param p_Window Crop window
+ *  @return         Pointer to the image or NULL if the frame has no such image
  */
-static void WS_BroadcastTask(void *p_Param)
+static const Network_Encoded_Image_t *WS_FindImage(const WS_Encoded_Frame_t *p_Frame, Network_ImageFormat_t Format,
+                                                   Server_Palette_t Palette, uint8_t Quality,
+                                                   Network_ImageLevel_t Level, const Network_ImageWindow_t *p_Window)
 {
-    uint8_t Signal;
-    Network_Encoded_Image_t Encoded;
+    for (uint8_t i = 0; i < p_Frame->Count; i++) {
+        if ((p_Frame->Variants[i].Format == Format) && (p_Frame->Variants[i].Palette == Palette) &&
+            (p_Frame->Variants[i].Quality == Quality) && (p_Frame->Variants[i].Level == Level) &&
+            ImageEncoder_isSameWindow(&p_Frame->Variants[i].Window, p_Window)) {
+            return &p_Frame->Variants[i].Image;
+        }
+    }
 
-    ESP_LOGI(TAG, "WebSocket broadcast task started");
+    return NULL;
+}
 
-    while (_WSHandler_State.TaskRunning) {
-        /* Wait for frame ready notification (blocking, 100ms timeout) */
-        if (xQueueReceive(_WSHandler_State.FrameReadyQueue, &Signal, 100 / portTICK_PERIOD_MS) == pdTRUE) {
-            uint32_t Now = esp_timer_get_time() / 1000;
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+/** @brief      Expire the parked sessions and check if the backfill ring has to record the frames. The ring records
+ *              while a radiometric stream has a session or a parked session waits for its client.
+ *              Call with the clients mutex taken.
+ *  @param Now  Current time in ms
+ *  @return     true if the frames are recorded
+ */
+static bool WS_UpdateRecording(uint32_t Now)
+{
+    bool isRecording = false;
+
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        WS_Session_t *Session = &_WSHandler_State.Sessions[i];
+        WS_Client_t *client = &_WSHandler_State.Clients[i];
+
+        if ((Session->Id != 0) && ((Now - Session->Parked) >= (CONFIG_NETWORK_WS_RESUME_TIMEOUT * 1000UL))) {
+            ESP_LOGI(TAG, "Session %08lx expired", static_cast<unsigned long>(Session->Id));
+            Session->Id = 0;
+        }
+
+        isRecording = isRecording || (Session->Id != 0) ||
+                      (client->active && client->stream_enabled && (client->session != 0));
+    }
+
+    _WSHandler_State.isRecording = isRecording;
+
+    return isRecording;
+}
+#endif
+
+/** @brief          Encode the current thermal frame once per format, palette, quality, pyramid level and crop window
+ *                  used by the clients that are due for a frame. The frame is also recorded into the backfill ring
+ *                  while a session needs it.
+ *  @param p_Frame  Output encoded frame
+ *  @return         true if at least one image was encoded
+ */
+static bool WS_EncodeFrame(WS_Encoded_Frame_t *p_Frame)
+{
+    uint32_t Now;
+    uint32_t Sequence;
+    uint32_t Timestamp;
+    bool isRecording;
+    WS_Encoded_Frame_t Wanted;
+
+    memset(p_Frame, 0, sizeof(WS_Encoded_Frame_t));
+
+    if ((_WSHandler_State.isInitialized == false) || (_WSHandler_State.ThermalFrame == NULL) ||
+        ((_WSHandler_State.ClientCount == 0) && (_WSHandler_State.isRecording == false))) {
+        return false;
+    }
+
+    Now = esp_timer_get_time() / 1000;
+    isRecording = false;
+
+    /* Collect the formats, palettes, qualities, levels and windows of all clients that are due for a frame */
+    Wanted.Count = 0;
+
+    xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+    isRecording = WS_UpdateRecording(Now);
+#endif
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        WS_Client_t *client = &_WSHandler_State.Clients[i];
+        bool isKnown = false;
+
+        if ((client->active == false) || (client->stream_enabled == false) ||
+            ((Now - client->last_frame_time) < (1000 / client->stream_fps))) {
+            continue;
+        }
+
+        for (uint8_t v = 0; v < Wanted.Count; v++) {
+            if ((Wanted.Variants[v].Format == client->stream_format) &&
+                (Wanted.Variants[v].Palette == client->stream_palette) &&
+                (Wanted.Variants[v].Quality == client->stream_quality) &&
+                (Wanted.Variants[v].Level == client->stream_level) &&
+                ImageEncoder_isSameWindow(&Wanted.Variants[v].Window, &client->stream_window)) {
+                isKnown = true;
+                break;
+            }
+        }
+
+        if (isKnown == false) {
+            Wanted.Variants[Wanted.Count].Format = client->stream_format;
+            Wanted.Variants[Wanted.Count].Palette = client->stream_palette;
+            Wanted.Variants[Wanted.Count].Quality = client->stream_quality;
+            Wanted.Variants[Wanted.Count].Level = client->stream_level;
+            Wanted.Variants[Wanted.Count].Window = client->stream_window;
+            Wanted.Count++;
+        }
+    }
+    xSemaphoreGive(_WSHandler_State.ClientsMutex);
+
+    if ((Wanted.Count == 0) && (isRecording == false)) {
+        return false;
+    }
+
+    /* Encode the frame ONCE per variant for all clients */
+    if (xSemaphoreTake(_WSHandler_State.ThermalFrame->mutex, 50 / portTICK_PERIOD_MS) != pdTRUE) {
+        /* Frame mutex busy, skip this frame */
+        return false;
+    }
+
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+    /* Every frame goes into the ring, also while no client is due or connected */
+    if (isRecording) {
+        BackfillRing_Record(_WSHandler_State.ThermalFrame);
+    }
+#endif
+
+    for (uint8_t v = 0; v < Wanted.Count; v++) {
+        WS_Encoded_Variant_t *Variant = &p_Frame->Variants[p_Frame->Count];
+
+        esp_err_t err = ImageEncoder_EncodeView(_WSHandler_State.ThermalFrame, Wanted.Variants[v].Format,
+                                                Wanted.Variants[v].Palette, Wanted.Variants[v].Quality,
+                                                Wanted.Variants[v].Level, &Wanted.Variants[v].Window,
+                                                &Variant->Image);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to encode frame: %d!", err);
+            continue;
+        }
+
+        Variant->Format = Wanted.Variants[v].Format;
+        Variant->Palette = Wanted.Variants[v].Palette;
+        Variant->Quality = Wanted.Variants[v].Quality;
+        Variant->Level = Wanted.Variants[v].Level;
+        Variant->Window = Wanted.Variants[v].Window;
+        p_Frame->Count++;
+    }
+
+    Sequence = _WSHandler_State.ThermalFrame->sequence;
+    Timestamp = _WSHandler_State.ThermalFrame->timestamp;
+
+    xSemaphoreGive(_WSHandler_State.ThermalFrame->mutex);
+
+    if ((p_Frame->Count > 0) && (Sequence != 0)) {
+        FrameLatency_Mark(FRAME_LATENCY_ENCODE, Sequence, static_cast<int64_t>(Timestamp) * 1000);
+    }
+
+    return p_Frame->Count > 0;
+}
+
+/** @brief          Free all images of an encoded frame.
+ *  @param p_Frame  Encoded frame
+ */
+static void WS_FreeFrame(WS_Encoded_Frame_t *p_Frame)
+{
+    for (uint8_t i = 0; i < p_Frame->Count; i++) {
+        ImageEncoder_Free(&p_Frame->Variants[i].Image);
+    }
+
+    p_Frame->Count = 0;
+}
+
+/** @brief          Step the quality and the frame rate of an adaptive stream. A client that drops frames or needs
+ *                  longer than one frame period per send gets a lower quality first and a lower frame rate when
+ *                  the quality is at its minimum. A client with headroom gets the frame rate back first.
+ *                  Call with the clients mutex taken.
+ *  @param p_Client Client pointer
+ *  @param Now      Current time in ms
+ */
+static void WS_AdaptClient(WS_Client_t *p_Client, uint32_t Now)
+{
+    uint32_t Budget;
+    uint32_t Dropped;
+
+    if ((p_Client->adaptive == false) || ((Now - p_Client->adapt_time) < WS_ADAPT_INTERVAL_MS)) {
+        return;
+    }
+
+    Budget = 1000 / p_Client->stream_fps;
+    Dropped = p_Client->frames_dropped - p_Client->adapt_dropped;
+
+    if ((Dropped > 0) || (p_Client->latency_ms > Budget)) {
+        if (p_Client->stream_quality > p_Client->quality_min) {
+            p_Client->stream_quality -= WS_ADAPT_QUALITY_STEP;
+            p_Client->stream_quality = (p_Client->stream_quality < p_Client->quality_min) ? p_Client->quality_min :
+                                       p_Client->stream_quality;
+        } else if (p_Client->stream_fps > p_Client->fps_min) {
+            p_Client->stream_fps -= (p_Client->stream_fps / 4) + 1;
+            p_Client->stream_fps = (p_Client->stream_fps < p_Client->fps_min) ? p_Client->fps_min : p_Client->stream_fps;
+        }
+
+        ESP_LOGD(TAG, "fd=%d congested (dropped=%u, latency=%u ms), quality=%u, fps=%u", p_Client->fd,
+                 static_cast<unsigned int>(Dropped), static_cast<unsigned int>(p_Client->latency_ms),
+                 p_Client->stream_quality, p_Client->stream_fps);
+    } else if ((p_Client->send_count == 0) && (p_Client->latency_ms < (Budget / 2))) {
+        if (p_Client->stream_fps < p_Client->fps_max) {
+            p_Client->stream_fps++;
+        } else if (p_Client->stream_quality < p_Client->quality_max) {
+            p_Client->stream_quality += WS_ADAPT_QUALITY_STEP;
+            p_Client->stream_quality = (p_Client->stream_quality > p_Client->quality_max) ? p_Client->quality_max :
+                                       p_Client->stream_quality;
+        }
+    }
+
+    p_Client->adapt_time = Now;
+    p_Client->adapt_dropped = p_Client->frames_dropped;
+}
 
-            if ((_WSHandler_State.isInitialized == false) || (_WSHandler_State.ThermalFrame == NULL) ||
-                (_WSHandler_State.ClientCount == 0)) {
+/** @brief          Get the keyframe a radiometric frame shows without changes.
+ *  @param p_Image  Encoded image
+ *  @return         Sequence number of the keyframe or 0 if the image has changes or is no radiometric frame
+ */
+static uint32_t WS_GetIdleReference(const Network_Encoded_Image_t *p_Image)
+{
+    ImageEncoder_Radiometric_Header_t Header;
+
+    if ((p_Image->format != NETWORK_IMAGE_FORMAT_RADIOMETRIC) || (p_Image->size < sizeof(Header))) {
+        return 0;
+    }
+
+    memcpy(&Header, p_Image->data, sizeof(Header));
+
+    if (p_Image->isKeyframe) {
+        return Header.Sequence;
+    } else if (((Header.Flags & IMAGE_ENCODER_RADIOMETRIC_FLAG_TILES) != 0) && (Header.Tiles == 0)) {
+        return Header.Reference;
+    }
+
+    return 0;
+}
+
+/** @brief          Queue an encoded frame for all streaming clients that are due for a frame. The frame is sent
+ *                  asynchronously, so a slow client does not delay the others.
+ *  @param p_Frame  Encoded frame
+ */
+static void WS_SendFrame(const WS_Encoded_Frame_t *p_Frame)
+{
+    uint32_t Now = esp_timer_get_time() / 1000;
+
+    xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        WS_Client_t *client = &_WSHandler_State.Clients[i];
+
+        const Network_Encoded_Image_t *image;
+
+        if ((client->active == false) || (client->stream_enabled == false)) {
+            continue;
+        }
+
+        WS_AdaptClient(client, Now);
+
+        /* Check frame rate limit */
+        if ((Now - client->last_frame_time) < (1000 / client->stream_fps)) {
+            continue;
+        }
+
+        /* The quality may have changed since the frame was encoded, the client gets the next frame then */
+        image = WS_FindImage(p_Frame, client->stream_format, client->stream_palette, client->stream_quality,
+                             client->stream_level, &client->stream_window);
+        if (image == NULL) {
+            continue;
+        }
+
+        /* A resumed stream gets the frames of the backfill ring first. It changes to the live frames with a keyframe
+           that directly follows the backfilled frames, so the client sees no gap */
+        if (client->backfill_next != 0) {
+            if (image->sequence != client->backfill_next) {
+                continue;
+            } else if (image->isKeyframe == false) {
+                ImageEncoder_RequestKeyframe();
                 continue;
             }
 
-            /* Encode frame ONCE for all clients (assume JPEG format for simplicity) */
-            if (xSemaphoreTake(_WSHandler_State.ThermalFrame->mutex, 50 / portTICK_PERIOD_MS) == pdTRUE) {
-                esp_err_t err = ImageEncoder_Encode(_WSHandler_State.ThermalFrame,
-                                                    NETWORK_IMAGE_FORMAT_JPEG, PALETTE_IRON, &Encoded);
-                xSemaphoreGive(_WSHandler_State.ThermalFrame->mutex);
+            client->backfill_next = 0;
+            client->needs_keyframe = false;
+        }
 
-                if (err != ESP_OK) {
-                    ESP_LOGW(TAG, "Failed to encode frame: %d!", err);
-                    continue;
-                }
-            } else {
-                /* Frame mutex busy, skip this frame */
+        /* Delta frames are useless without their keyframe, wait for the next one */
+        if ((client->stream_format == NETWORK_IMAGE_FORMAT_RADIOMETRIC) && client->needs_keyframe) {
+            if (image->isKeyframe == false) {
+                ImageEncoder_RequestKeyframe();
+                continue;
+            }
+
+            client->needs_keyframe = false;
+        }
+
+        /* Frames without changes to what the client shows are skipped, a heartbeat keeps the client informed */
+        if ((image->isKeyframe == false) && (client->idle_reference != 0) &&
+            (WS_GetIdleReference(image) == client->idle_reference)) {
+            if ((Now - client->last_frame_time) >= WS_HEARTBEAT_INTERVAL_MS) {
+                ImageEncoder_Radiometric_Header_t Header;
+                cJSON *heartbeat = cJSON_CreateObject();
+
+                memcpy(&Header, image->data, sizeof(Header));
+                cJSON_AddNumberToObject(heartbeat, "sequence", Header.Sequence);
+                cJSON_AddNumberToObject(heartbeat, "reference", client->idle_reference);
+                WS_SendJSON(client->fd, "heartbeat", heartbeat);
+                cJSON_Delete(heartbeat);
+
+                client->last_frame_time = Now;
+            }
+
+            continue;
+        }
+
+        /* Indexed frames need the palette on the client, send it ahead of the first frame and on changes */
+        if ((client->stream_format == NETWORK_IMAGE_FORMAT_INDEXED) && (client->sent_palette != client->stream_palette)) {
+            Network_Encoded_Image_t Palette;
+
+            if (ImageEncoder_EncodePalette(client->stream_palette, &Palette) != ESP_OK) {
                 continue;
             }
 
-            /* Send to all active streaming clients */
+            client->sent_palette = client->stream_palette;
+            WS_QueueFrame(i, &Palette);
+            ImageEncoder_Free(&Palette);
+        }
+
+        WS_QueueFrame(i, image);
+        client->idle_reference = WS_GetIdleReference(image);
+        client->last_frame_time = Now;
+    }
+
+    xSemaphoreGive(_WSHandler_State.ClientsMutex);
+}
+
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+/** @brief  Queue the next frames of the backfill ring for the resumed streams. The send queue of a client is filled
+ *          up only, so the backfill runs as fast as the link takes the frames.
+ *  @return true if a client has more frames in the ring
+ */
+static bool WS_Backfill(void)
+{
+    bool isPending = false;
+
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        WS_Client_t *client = &_WSHandler_State.Clients[i];
+
+        for (uint8_t n = 0; n < WS_SEND_QUEUE_DEPTH; n++) {
+            Network_Encoded_Image_t Image;
+            uint32_t Next;
+            esp_err_t Error;
+            int FD;
+
             xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
-            for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
-                WS_Client_t *client = &_WSHandler_State.Clients[i];
+            Next = client->backfill_next;
+            FD = client->fd;
+            if ((client->active == false) || (client->stream_enabled == false) ||
+                (client->send_count >= WS_SEND_QUEUE_DEPTH)) {
+                Next = 0;
+            }
+            xSemaphoreGive(_WSHandler_State.ClientsMutex);
 
-                if ((client->active == false) || (client->stream_enabled == false)) {
-                    continue;
-                }
+            if (Next == 0) {
+                break;
+            }
 
-                /* Check frame rate limit */
-                if ((Now - client->last_frame_time) < (1000 / client->stream_fps)) {
-                    continue;
-                }
+            /* The encode runs without the clients mutex, the client is checked again afterwards */
+            Error = BackfillRing_Encode(Next, &Image);
+            if (Error == ESP_ERR_NOT_FOUND) {
+                /* All recorded frames are sent, the live frames take over with the next keyframe */
+                break;
+            } else if (Error == ESP_ERR_NO_MEM) {
+                isPending = true;
+                break;
+            }
 
-                /* Copy FD before releasing mutex */
-                int client_fd = client->fd;
-                uint8_t client_idx = i;
-
-                xSemaphoreGive(_WSHandler_State.ClientsMutex);
-                esp_err_t send_err = WS_SendBinary(client_fd, Encoded.data, Encoded.size);
-                xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
-
-                /* Re-validate client is still active and same FD */
-                if (_WSHandler_State.Clients[client_idx].active &&
-                    _WSHandler_State.Clients[client_idx].fd == client_fd) {
-                    if (send_err == ESP_OK) {
-                        _WSHandler_State.Clients[client_idx].last_frame_time = Now;
-                    } else {
-                        ESP_LOGW(TAG, "Removing client fd=%d due to send failure", client_fd);
-                        _WSHandler_State.Clients[client_idx].active = false;
-                        _WSHandler_State.ClientCount--;
-                    }
+            xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
+            if (client->active && (client->fd == FD) && (client->backfill_next == Next)) {
+                if (Error == ESP_OK) {
+                    /* The ring has overwritten the frames in between */
+                    client->frames_dropped += Image.sequence - Next;
+                    client->backfill_next = Image.sequence + 1;
+                    client->frames_backfilled++;
+                    WS_QueueFrame(i, &Image);
+                    isPending = true;
+                } else {
+                    ESP_LOGW(TAG, "Backfill of fd=%d failed: %d!", FD, Error);
+                    client->backfill_next = 0;
                 }
             }
-
             xSemaphoreGive(_WSHandler_State.ClientsMutex);
 
-            /* Free encoded frame after sending to all clients */
-            ImageEncoder_Free(&Encoded);
+            if (Error == ESP_OK) {
+                ImageEncoder_Free(&Image);
+            }
+        }
+    }
+
+    return isPending;
+}
+#endif
+
+#ifdef CONFIG_NETWORK_ENCODER_PIPELINE
+/** @brief          Encode task function. Encodes frame N while the broadcast task is still sending frame N - 1.
+ *  @param p_Param  Task parameter (unused)
+ */
+static void WS_EncodeTask(void *p_Param)
+{
+    uint8_t Signal;
+    WS_Encoded_Frame_t Frame;
+    WS_Encoded_Frame_t Stale;
+
+    ESP_LOGI(TAG, "WebSocket encode task started on core %d", xPortGetCoreID());
+
+    while (_WSHandler_State.TaskRunning) {
+        /* Wait for frame ready notification (blocking, 100ms timeout) */
+        if (xQueueReceive(_WSHandler_State.FrameReadyQueue, &Signal, 100 / portTICK_PERIOD_MS) != pdTRUE) {
+            continue;
+        }
+
+        if (WS_EncodeFrame(&Frame) == false) {
+            continue;
+        }
+
+        /* The broadcast task has not picked up the previous frame yet. Replace it, only the latest frame matters */
+        if (xQueueSend(_WSHandler_State.EncodedQueue, &Frame, 0) != pdTRUE) {
+            if (xQueueReceive(_WSHandler_State.EncodedQueue, &Stale, 0) == pdTRUE) {
+                WS_FreeFrame(&Stale);
+            }
+
+            if (xQueueSend(_WSHandler_State.EncodedQueue, &Frame, 0) != pdTRUE) {
+                WS_FreeFrame(&Frame);
+            }
         }
+    }
+
+    ESP_LOGI(TAG, "WebSocket encode task stopped");
+    _WSHandler_State.EncodeTask = NULL;
+    vTaskDelete(NULL);
+}
+#endif
+
+/** @brief          Broadcast task function - runs in separate task to avoid blocking GUI.
+ *  @param p_Param  Task parameter (unused)
+ */
+static void WS_BroadcastTask(void *p_Param)
+{
+    WS_Encoded_Frame_t Frame;
+    bool isBackfilling;
+
+    ESP_LOGI(TAG, "WebSocket broadcast task started");
+
+    isBackfilling = false;
+
+    while (_WSHandler_State.TaskRunning) {
+        /* A running backfill does not wait for the next frame */
+        TickType_t Wait = isBackfilling ? 0 : (100 / portTICK_PERIOD_MS);
+
+#ifdef CONFIG_NETWORK_ENCODER_PIPELINE
+        /* Wait for the next frame of the encode task (blocking, 100ms timeout) */
+        if (xQueueReceive(_WSHandler_State.EncodedQueue, &Frame, Wait) == pdTRUE) {
+            WS_SendFrame(&Frame);
+
+            /* The send queues of the clients hold their own references */
+            WS_FreeFrame(&Frame);
+        }
+#else
+        uint8_t Signal;
+
+        /* Wait for frame ready notification (blocking, 100ms timeout) */
+        if ((xQueueReceive(_WSHandler_State.FrameReadyQueue, &Signal, Wait) == pdTRUE) && WS_EncodeFrame(&Frame)) {
+            WS_SendFrame(&Frame);
+
+            /* The send queues of the clients hold their own references */
+            WS_FreeFrame(&Frame);
+        }
+#endif
+
+#ifdef CONFIG_NETWORK_WS_BACKFILL
+        isBackfilling = WS_Backfill();
+#endif
 
         /* Small yield to prevent task starvation */
         vTaskDelay(10 / portTICK_PERIOD_MS);
@@ -661,7 +2232,8 @@ esp_err_t WebSocket_Handler_NotifyFrameReady(void)
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (_WSHandler_State.ClientCount == 0) {
+    /* A parked session needs the frames also without clients */
+    if ((_WSHandler_State.ClientCount == 0) && (_WSHandler_State.isRecording == false)) {
         return ESP_OK;
     }
 
@@ -675,6 +2247,8 @@ esp_err_t WebSocket_Handler_NotifyFrameReady(void)
 esp_err_t WebSocket_Handler_BroadcastTelemetry(void)
 {
     uint32_t Now;
+    bool isDue;
+    Telemetry_Snapshot_t Snapshot;
 
     if (_WSHandler_State.isInitialized == false) {
         return ESP_ERR_INVALID_STATE;
@@ -686,17 +2260,33 @@ esp_err_t WebSocket_Handler_BroadcastTelemetry(void)
 
     Now = esp_timer_get_time() / 1000;
 
-    /* Build telemetry data */
-    cJSON *data = cJSON_CreateObject();
+    /* Only build a snapshot when at least one client is due */
+    isDue = false;
+    xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        WS_Client_t *client = &_WSHandler_State.Clients[i];
 
-    if (_WSHandler_State.ThermalFrame != NULL) {
-        cJSON_AddNumberToObject(data, "temp", _WSHandler_State.ThermalFrame->temp_avg);
+        if (client->active && client->telemetry_enabled &&
+            ((Now - client->last_telemetry_time) >= client->telemetry_interval_ms)) {
+            isDue = true;
+            break;
+        }
+    }
+    xSemaphoreGive(_WSHandler_State.ClientsMutex);
+
+    if (isDue == false) {
+        return ESP_OK;
+    }
+
+    if (Telemetry_Get(TELEMETRY_MAX_AGE_MS, &Snapshot) != ESP_OK) {
+        return ESP_ERR_INVALID_STATE;
     }
 
     xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
 
     for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
         WS_Client_t *client = &_WSHandler_State.Clients[i];
+        WebSocket_Telemetry_Stats_t Stats;
 
         if ((client->active == false) || (client->telemetry_enabled == false)) {
             continue;
@@ -707,17 +2297,100 @@ esp_err_t WebSocket_Handler_BroadcastTelemetry(void)
             continue;
         }
 
-        WS_SendJSON(client->fd, "telemetry", data);
+        /* Only the send statistics of this client are added to the shared snapshot */
+        Stats.queue_depth = client->send_count;
+        Stats.fps = client->stream_fps;
+        Stats.quality = (client->stream_quality != 0) ? client->stream_quality : ImageEncoder_GetQuality();
+        Stats.reserved = 0;
+        Stats.frames_dropped = client->frames_dropped;
+        Stats.latency_ms = client->latency_ms;
+
+        if (client->telemetry_binary) {
+            uint8_t Message[sizeof(Telemetry_Packet_t) + sizeof(WebSocket_Telemetry_Stats_t)];
+
+            memcpy(Message, &Snapshot.Packet, sizeof(Telemetry_Packet_t));
+            memcpy(&Message[sizeof(Telemetry_Packet_t)], &Stats, sizeof(WebSocket_Telemetry_Stats_t));
+
+            httpd_ws_frame_t Frame = {
+                .final = true,
+                .fragmented = false,
+                .type = HTTPD_WS_TYPE_BINARY,
+                .payload = Message,
+                .len = sizeof(Message),
+            };
+
+            httpd_ws_send_frame_async(_WSHandler_State.ServerHandle, client->fd, &Frame);
+        } else {
+            char Message[TELEMETRY_JSON_SIZE + 128];
+            int Length;
+
+            /* Insert the statistics before the closing brace of the snapshot object */
+            Length = snprintf(Message, sizeof(Message),
+                              "{\"cmd\":\"telemetry\",\"data\":%.*s,\"queue\":%u,\"dropped\":%lu,\"latency\":%lu,"
+                              "\"fps\":%u,\"quality\":%u}}",
+                              static_cast<int>(Snapshot.JSONLength - 1), Snapshot.JSON,
+                              Stats.queue_depth,
+                              static_cast<unsigned long>(Stats.frames_dropped),
+                              static_cast<unsigned long>(Stats.latency_ms),
+                              Stats.fps,
+                              Stats.quality);
+
+            if ((Length > 0) && (Length < static_cast<int>(sizeof(Message)))) {
+                httpd_ws_frame_t Frame = {
+                    .final = true,
+                    .fragmented = false,
+                    .type = HTTPD_WS_TYPE_TEXT,
+                    .payload = reinterpret_cast<uint8_t *>(Message),
+                    .len = static_cast<size_t>(Length),
+                };
+
+                httpd_ws_send_frame_async(_WSHandler_State.ServerHandle, client->fd, &Frame);
+            }
+        }
+
         client->last_telemetry_time = Now;
     }
 
     xSemaphoreGive(_WSHandler_State.ClientsMutex);
 
-    cJSON_Delete(data);
-
     return ESP_OK;
 }
 
+esp_err_t WebSocket_Handler_GetClientStatistics(uint8_t Index, WebSocket_Client_Statistics_t *p_Statistics)
+{
+    esp_err_t Error;
+
+    if ((Index >= WS_MAX_CLIENTS) || (p_Statistics == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_WSHandler_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
+
+    if (_WSHandler_State.Clients[Index].active) {
+        p_Statistics->fd = _WSHandler_State.Clients[Index].fd;
+        p_Statistics->queue_depth = _WSHandler_State.Clients[Index].send_count;
+        p_Statistics->send_busy = _WSHandler_State.Clients[Index].send_busy;
+        p_Statistics->frames_sent = _WSHandler_State.Clients[Index].frames_sent;
+        p_Statistics->frames_dropped = _WSHandler_State.Clients[Index].frames_dropped;
+        p_Statistics->send_errors = _WSHandler_State.Clients[Index].send_errors;
+        p_Statistics->frames_backfilled = _WSHandler_State.Clients[Index].frames_backfilled;
+        p_Statistics->latency_ms = _WSHandler_State.Clients[Index].latency_ms;
+        p_Statistics->quality = (_WSHandler_State.Clients[Index].stream_quality != 0) ?
+                                _WSHandler_State.Clients[Index].stream_quality : ImageEncoder_GetQuality();
+        p_Statistics->fps = _WSHandler_State.Clients[Index].stream_fps;
+        p_Statistics->adaptive = _WSHandler_State.Clients[Index].adaptive;
+        Error = ESP_OK;
+    } else {
+        Error = ESP_ERR_NOT_FOUND;
+    }
+
+    xSemaphoreGive(_WSHandler_State.ClientsMutex);
+
+    return Error;
+}
+
 esp_err_t WebSocket_Handler_PingAll(void)
 {
     if ((_WSHandler_State.isInitialized == false) || (_WSHandler_State.ServerHandle == NULL)) {
@@ -747,6 +2420,8 @@ esp_err_t WebSocket_Handler_PingAll(void)
 
 esp_err_t WebSocket_Handler_StartTask(void)
 {
+    esp_err_t Error;
+
     if (_WSHandler_State.isInitialized == false) {
         return ESP_ERR_INVALID_STATE;
     } else if (_WSHandler_State.BroadcastTask != NULL) {
@@ -756,22 +2431,23 @@ esp_err_t WebSocket_Handler_StartTask(void)
 
     _WSHandler_State.TaskRunning = true;
 
-    BaseType_t ret = xTaskCreatePinnedToCore(
-                         WS_BroadcastTask,
-                         "WS_Broadcast",
-                         4096,
-                         NULL,
-                         5,
-                         &_WSHandler_State.BroadcastTask,
-                         1
-                     );
-
-    if (ret != pdPASS) {
+    Error = Topology_CreateTask(TOPOLOGY_TASK_WS_BROADCAST, WS_BroadcastTask, NULL, &_WSHandler_State.BroadcastTask);
+    if (Error != ESP_OK) {
         ESP_LOGE(TAG, "Failed to create broadcast task");
         _WSHandler_State.TaskRunning = false;
-        return ESP_ERR_NO_MEM;
+        return Error;
     }
 
+#ifdef CONFIG_NETWORK_ENCODER_PIPELINE
+    /* Keep the encoder away from the GUI core, so encoding does not compete with LVGL */
+    Error = Topology_CreateTask(TOPOLOGY_TASK_WS_ENCODE, WS_EncodeTask, NULL, &_WSHandler_State.EncodeTask);
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create encode task");
+        WebSocket_Handler_StopTask();
+        return Error;
+    }
+#endif
+
     return ESP_OK;
 }
 
@@ -790,12 +2466,28 @@ void WebSocket_Handler_StopTask(uint32_t Timeout_ms)
     /* Wait for task to finish (max 2 seconds) */
     Start = esp_timer_get_time() / 1000;
 
-    while (_WSHandler_State.BroadcastTask != NULL &&
+    while (((_WSHandler_State.BroadcastTask != NULL) || (_WSHandler_State.EncodeTask != NULL)) &&
            ((esp_timer_get_time() / 1000) - Start) < Timeout_ms) {
         vTaskDelay(10 / portTICK_PERIOD_MS);
     }
 
     _WSHandler_State.BroadcastTask = NULL;
+    _WSHandler_State.EncodeTask = NULL;
+
+    /* Return the buffers of all frames that were queued but not sent anymore */
+    xSemaphoreTake(_WSHandler_State.ClientsMutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        WS_FlushClient(&_WSHandler_State.Clients[i]);
+    }
+    xSemaphoreGive(_WSHandler_State.ClientsMutex);
+
+#ifdef CONFIG_NETWORK_ENCODER_PIPELINE
+    WS_Encoded_Frame_t Frame;
+
+    while ((_WSHandler_State.EncodedQueue != NULL) && (xQueueReceive(_WSHandler_State.EncodedQueue, &Frame, 0) == pdTRUE)) {
+        WS_FreeFrame(&Frame);
+    }
+#endif
 
     ESP_LOGI(TAG, "WebSocket broadcast task stopped");
 }
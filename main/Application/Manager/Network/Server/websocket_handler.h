@@ -33,6 +33,139 @@
  */
 #define WS_MAX_CLIENTS                      4
 
+/** @brief Maximum number of frames queued per WebSocket client. The oldest frame is dropped when a client lags.
+ */
+#define WS_SEND_QUEUE_DEPTH                 2
+
+/** @brief Number of consecutive send errors after which a client is removed.
+ */
+#define WS_SEND_MAX_ERRORS                  3
+
+/** @brief Interval in milliseconds between two adaption steps of an adaptive stream.
+ */
+#define WS_ADAPT_INTERVAL_MS                1000
+
+/** @brief JPEG quality change of one adaption step. Qualities are multiples of this step, so clients with a similar
+ *         link share one encoded image.
+ */
+#define WS_ADAPT_QUALITY_STEP               10
+
+/** @brief Interval in milliseconds between two heartbeats of a stream that skips frames without changes.
+ */
+#define WS_HEARTBEAT_INTERVAL_MS            1000
+
+/** @brief Size of the receive buffer of a client in bytes. Messages up to this size minus one byte are received
+ *         without an allocation, larger messages (e.g. replay records) get a buffer of their own.
+ */
+#define WS_RX_BUFFER_SIZE                   512
+
+/** @brief Magic of a binary command ("PC") (little endian).
+ */
+#define WS_COMMAND_MAGIC                    0x4350
+
+/** @brief Flags of the binary start command.
+ */
+#define WS_COMMAND_FLAG_ADAPTIVE            (1 << 0)
+
+/** @brief Flags of the binary subscribe command.
+ */
+#define WS_COMMAND_FLAG_BINARY              (1 << 0)
+
+/** @brief Binary commands, the compact form of the JSON commands with the same name.
+ */
+typedef enum {
+    WS_COMMAND_START = 1,                   /**< Start the stream, WebSocket_Command_Start_t. */
+    WS_COMMAND_STOP,                        /**< Stop the stream, no parameters. */
+    WS_COMMAND_SUBSCRIBE,                   /**< Subscribe the telemetry, WebSocket_Command_Subscribe_t. */
+    WS_COMMAND_UNSUBSCRIBE,                 /**< Unsubscribe the telemetry, no parameters. */
+    WS_COMMAND_WINDOW,                      /**< Move the crop window of the stream, WebSocket_Command_Window_t. */
+    WS_COMMAND_RESUME,                      /**< Resume a radiometric stream, WebSocket_Command_Resume_t. */
+} WebSocket_Command_t;
+
+/** @brief Header of a binary command (little endian), followed by Length bytes of parameters. Parameters beyond the
+ *         known structure are ignored.
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t Magic;                         /**< WS_COMMAND_MAGIC */
+    uint8_t Command;                        /**< WebSocket_Command_t */
+    uint8_t Length;                         /**< Bytes of the parameters after the header */
+} WebSocket_Command_Header_t;
+
+/** @brief Parameters of the binary start command. 0 selects the default of the JSON command.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t Format;                         /**< Network_ImageFormat_t: JPEG, indexed, radiometric or temperature */
+    uint8_t Palette;                        /**< Server_Palette_t, PALETTE_COUNT or more keeps the palette */
+    uint8_t Level;                          /**< Network_ImageLevel_t */
+    uint8_t Fps;                            /**< Frame rate (1 - 30), 0 keeps the frame rate */
+    uint8_t Quality;                        /**< JPEG quality, 0 for the default quality */
+    uint8_t Flags;                          /**< WS_COMMAND_FLAG_ADAPTIVE */
+    uint8_t QualityMin;                     /**< Lower quality of an adaptive stream */
+    uint8_t QualityMax;                     /**< Upper quality of an adaptive stream */
+    uint8_t FpsMin;                         /**< Lower frame rate of an adaptive stream */
+    uint8_t FpsMax;                         /**< Upper frame rate of an adaptive stream, 0 for Fps */
+    uint8_t Zoom;                           /**< Zoom of the crop window */
+    uint8_t reserved;
+    uint16_t X;                             /**< Left column of the crop window */
+    uint16_t Y;                             /**< Top row of the crop window */
+    uint16_t Width;                         /**< Width of the crop window, 0 for the full frame */
+    uint16_t Height;                        /**< Height of the crop window */
+} WebSocket_Command_Start_t;
+
+/** @brief Parameters of the binary subscribe command.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t Interval;                      /**< Update interval in ms, 0 keeps the interval */
+    uint8_t Flags;                          /**< WS_COMMAND_FLAG_BINARY */
+    uint8_t reserved[3];
+} WebSocket_Command_Subscribe_t;
+
+/** @brief Parameters of the binary window command.
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t X;                             /**< Left column of the crop window */
+    uint16_t Y;                             /**< Top row of the crop window */
+    uint16_t Width;                         /**< Width of the crop window, 0 for the full frame */
+    uint16_t Height;                        /**< Height of the crop window */
+    uint8_t Zoom;                           /**< Zoom of the crop window, 0 for 1 */
+    uint8_t reserved;
+} WebSocket_Command_Window_t;
+
+/** @brief Parameters of the binary resume command.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t Session;                       /**< Session of the "started" response */
+    uint32_t Sequence;                      /**< Sequence number of the last frame the client has received */
+} WebSocket_Command_Resume_t;
+
+/** @brief Send statistics of a WebSocket client.
+ */
+typedef struct {
+    int fd;                                 /**< Socket of the client */
+    uint8_t queue_depth;                    /**< Frames waiting in the send queue */
+    bool send_busy;                         /**< true while a frame is being sent */
+    uint32_t frames_sent;                   /**< Frames sent to the client */
+    uint32_t frames_dropped;                /**< Frames dropped because the client lagged */
+    uint32_t send_errors;                   /**< Frames that failed to send */
+    uint32_t frames_backfilled;             /**< Frames of the backfill ring sent after a resume */
+    uint32_t latency_ms;                    /**< Smoothed time from the start of a send until its completion */
+    uint8_t quality;                        /**< Current JPEG quality of the stream */
+    uint8_t fps;                            /**< Current frame rate of the stream */
+    bool adaptive;                          /**< true when quality and frame rate follow the link */
+} WebSocket_Client_Statistics_t;
+
+/** @brief Send statistics of a client, appended to the Telemetry_Packet_t of a binary telemetry message
+ *         (little endian).
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t queue_depth;                    /**< Frames waiting in the send queue */
+    uint8_t fps;                            /**< Current frame rate of the stream */
+    uint8_t quality;                        /**< Current JPEG quality of the stream */
+    uint8_t reserved;
+    uint32_t frames_dropped;                /**< Frames dropped because the client lagged */
+    uint32_t latency_ms;                    /**< Smoothed send latency */
+} WebSocket_Telemetry_Stats_t;
+
 /** @brief          Initialize the WebSocket handler.
  *  @param p_Config Pointer to server configuration
  *  @return         ESP_OK on success
@@ -59,17 +192,24 @@ uint8_t WebSocket_Handler_GetClientCount(void);
  */
 bool WebSocket_Handler_HasClients(void);
 
+/** @brief  Get the number of clients with an enabled image stream.
+ *  @return Number of streaming clients
+ */
+uint8_t WebSocket_Handler_GetStreamCount(void);
+
 /** @brief              Set thermal frame data for streaming.
  *  @param p_Frame      Pointer to thermal frame data
  */
 void WebSocket_Handler_SetThermalFrame(Network_Thermal_Frame_t *p_Frame);
 
-/** @brief  Signal that a new frame is ready for broadcasting (non-blocking).
+/** @brief  Signal that a new frame is ready for broadcasting (non-blocking). Without clients the frame is only taken
+ *          while the backfill ring records for a parked stream session.
  *  @return ESP_OK on success
  */
 esp_err_t WebSocket_Handler_NotifyFrameReady(void);
 
-/** @brief  Broadcast telemetry data to all subscribed clients.
+/** @brief  Broadcast telemetry data to all subscribed clients. The snapshot is built and serialized once for all
+ *          clients that are due, only the send statistics of each client are added.
  *  @return ESP_OK on success
  */
 esp_err_t WebSocket_Handler_BroadcastTelemetry(void);
@@ -84,6 +224,15 @@ esp_err_t WebSocket_Handler_StartTask(void);
  */
 void WebSocket_Handler_StopTask(uint32_t Timeout_ms = 2000);
 
+/** @brief              Get the send statistics of a client slot.
+ *  @param Index        Client slot (0 to WS_MAX_CLIENTS - 1)
+ *  @param p_Statistics Pointer to store the statistics
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if a parameter is invalid
+ *                      ESP_ERR_NOT_FOUND if the slot has no client
+ */
+esp_err_t WebSocket_Handler_GetClientStatistics(uint8_t Index, WebSocket_Client_Statistics_t *p_Statistics);
+
 /** @brief  Send ping to all connected clients.
  *  @return ESP_OK on success.
  */
@@ -28,6 +28,7 @@
 #include <esp_mac.h>
 #include <nvs_flash.h>
 #include <nvs.h>
+#include <esp_timer.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
@@ -46,11 +47,49 @@ ESP_EVENT_DEFINE_BASE(NETWORK_EVENTS);
 #define NVS_NAMESPACE           "wifi_creds"
 #define NVS_KEY_SSID            "ssid"
 #define NVS_KEY_PASSWORD        "password"
+#define NVS_KEY_FAST_CONNECT    "fast"
 
 #define WIFI_CONNECTED_BIT      BIT0
 #define WIFI_FAIL_BIT           BIT1
 #define WIFI_STARTED_BIT        BIT2
 
+/** @brief Access point and DHCP lease of the last successful connection. Stored in the NVS as blob.
+ */
+typedef struct {
+    char SSID[33];                              /**< SSID the entry belongs to. */
+    uint8_t BSSID[6];
+    uint8_t Channel;                            /**< Primary channel, 0 if the entry is invalid. */
+    uint32_t IP;
+    uint32_t Netmask;
+    uint32_t Gateway;
+    uint32_t DNS;
+} Network_FastConnect_t;
+
+/** @brief Settings of a power profile.
+ */
+typedef struct {
+    const char *Name;
+    wifi_ps_type_t PowerSave;
+    int8_t TxPower;                             /**< Maximum TX power in 0.25 dBm. */
+} Network_PowerProfile_Config_t;
+
+/** @brief Settings of the power profiles, indexed by Network_PowerProfile_t.
+ */
+static const Network_PowerProfile_Config_t _Network_PowerProfiles[] = {
+    {"low power",   WIFI_PS_MAX_MODEM,  60},
+    {"interactive", WIFI_PS_MIN_MODEM,  78},
+    {"throughput",  WIFI_PS_NONE,       80},
+};
+
+/** @brief Listen interval of the station in beacon intervals. Only used by the maximum modem sleep of the low
+ *         power profile, the other profiles wake up for every DTIM beacon.
+ */
+#define NETWORK_LISTEN_INTERVAL             10
+
+/** @brief Minimum time between two evaluations of the clients for the automatic power profile in ms.
+ */
+#define NETWORK_POWER_UPDATE_MS             250
+
 typedef struct {
     bool isInitialized;
     Network_State_t State;
@@ -60,12 +99,197 @@ typedef struct {
     Network_WiFi_STA_Config_t *STA_Config;
     uint8_t RetryCount;
     esp_netif_ip_info_t IP_Info;
+    Network_FastConnect_t FastConnect;
+    bool isFastConnect;                         /**< The STA config uses the channel and the BSSID of FastConnect. */
+    bool isStaticIP;                            /**< The DHCP client is stopped and the lease of FastConnect used. */
+    int64_t ConnectStart;                       /**< Start of the connection attempt in microseconds. */
+    Network_PowerProfile_t PowerProfile;        /**< Requested profile, NETWORK_POWER_PROFILE_AUTO to follow the
+                                                     clients. */
+    Network_PowerProfile_t ActiveProfile;       /**< Profile of the WiFi driver. */
+    int64_t PowerUpdateTime;                    /**< Time of the last evaluation in microseconds. */
+    int64_t LowerSince;                         /**< Time since a lower profile is requested, 0 if none. */
 } Network_Manager_State_t;
 
 static Network_Manager_State_t _Network_Manager_State;
 
 static const char *TAG = "Network Manager";
 
+/** @brief Load the access point of the last connection from the NVS.
+ */
+static void NetworkManager_LoadFastConnect(void)
+{
+    nvs_handle_t Handle;
+    size_t Length;
+
+    memset(&_Network_Manager_State.FastConnect, 0, sizeof(Network_FastConnect_t));
+
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &Handle) != ESP_OK) {
+        return;
+    }
+
+    Length = sizeof(Network_FastConnect_t);
+    if ((nvs_get_blob(Handle, NVS_KEY_FAST_CONNECT, &_Network_Manager_State.FastConnect, &Length) != ESP_OK) ||
+        (Length != sizeof(Network_FastConnect_t))) {
+        memset(&_Network_Manager_State.FastConnect, 0, sizeof(Network_FastConnect_t));
+    }
+
+    /* An entry from an older layout or a corrupted entry is ignored */
+    _Network_Manager_State.FastConnect.SSID[sizeof(_Network_Manager_State.FastConnect.SSID) - 1] = '\0';
+
+    nvs_close(Handle);
+}
+
+/** @brief Store the access point and the lease of the current connection. The NVS is only written on a change.
+ *         Called from the event loop with the IP event.
+ *  @param p_IP Pointer to the IP information of the lease
+ */
+static void NetworkManager_SaveFastConnect(const esp_netif_ip_info_t *p_IP)
+{
+#ifdef CONFIG_NETWORK_WIFI_FAST_CONNECT
+    Network_FastConnect_t Entry;
+    wifi_ap_record_t APInfo;
+    esp_netif_dns_info_t DNS;
+    nvs_handle_t Handle;
+
+    if (esp_wifi_sta_get_ap_info(&APInfo) != ESP_OK) {
+        return;
+    }
+
+    memset(&Entry, 0, sizeof(Entry));
+    strncpy(Entry.SSID, _Network_Manager_State.STA_Config->Credentials.SSID, sizeof(Entry.SSID) - 1);
+    memcpy(Entry.BSSID, APInfo.bssid, sizeof(Entry.BSSID));
+    Entry.Channel = APInfo.primary;
+    Entry.IP = p_IP->ip.addr;
+    Entry.Netmask = p_IP->netmask.addr;
+    Entry.Gateway = p_IP->gw.addr;
+
+    if (esp_netif_get_dns_info(_Network_Manager_State.STA_NetIF, ESP_NETIF_DNS_MAIN, &DNS) == ESP_OK) {
+        Entry.DNS = DNS.ip.u_addr.ip4.addr;
+    }
+
+    /* The static address fast path keeps the lease, so it is not written again */
+    if (memcmp(&Entry, &_Network_Manager_State.FastConnect, sizeof(Entry)) == 0) {
+        return;
+    }
+
+    memcpy(&_Network_Manager_State.FastConnect, &Entry, sizeof(Entry));
+
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &Handle) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to open NVS for the fast connect entry!");
+        return;
+    }
+
+    if ((nvs_set_blob(Handle, NVS_KEY_FAST_CONNECT, &Entry, sizeof(Entry)) != ESP_OK) ||
+        (nvs_commit(Handle) != ESP_OK)) {
+        ESP_LOGW(TAG, "Failed to store the fast connect entry!");
+    } else {
+        ESP_LOGD(TAG, "Fast connect entry stored (channel %u, BSSID " MACSTR ")", Entry.Channel,
+                 MAC2STR(Entry.BSSID));
+    }
+
+    nvs_close(Handle);
+#endif
+}
+
+/** @brief              Use the access point of the last connection for a directed connect without a scan.
+ *  @param p_WifiConfig Pointer to the STA configuration
+ *  @return             true if the fast connect is used
+ */
+static bool NetworkManager_ApplyFastConnect(wifi_config_t *p_WifiConfig)
+{
+#ifdef CONFIG_NETWORK_WIFI_FAST_CONNECT
+    Network_FastConnect_t *Entry;
+
+    Entry = &_Network_Manager_State.FastConnect;
+    if ((Entry->Channel == 0) || (strcmp(Entry->SSID, _Network_Manager_State.STA_Config->Credentials.SSID) != 0)) {
+        return false;
+    }
+
+    p_WifiConfig->sta.channel = Entry->Channel;
+    p_WifiConfig->sta.bssid_set = true;
+    memcpy(p_WifiConfig->sta.bssid, Entry->BSSID, sizeof(p_WifiConfig->sta.bssid));
+
+#ifdef CONFIG_NETWORK_WIFI_FAST_IP
+    if ((_Network_Manager_State.isStaticIP == false) && (Entry->IP != 0)) {
+        esp_netif_ip_info_t IP_Info;
+        esp_netif_dns_info_t DNS;
+
+        IP_Info.ip.addr = Entry->IP;
+        IP_Info.netmask.addr = Entry->Netmask;
+        IP_Info.gw.addr = Entry->Gateway;
+
+        esp_netif_dhcpc_stop(_Network_Manager_State.STA_NetIF);
+        if (esp_netif_set_ip_info(_Network_Manager_State.STA_NetIF, &IP_Info) == ESP_OK) {
+            if (Entry->DNS != 0) {
+                memset(&DNS, 0, sizeof(DNS));
+                DNS.ip.type = ESP_IPADDR_TYPE_V4;
+                DNS.ip.u_addr.ip4.addr = Entry->DNS;
+                esp_netif_set_dns_info(_Network_Manager_State.STA_NetIF, ESP_NETIF_DNS_MAIN, &DNS);
+            }
+
+            _Network_Manager_State.isStaticIP = true;
+        } else {
+            esp_netif_dhcpc_start(_Network_Manager_State.STA_NetIF);
+        }
+    }
+#endif
+
+    ESP_LOGI(TAG, "Fast connect on channel %u to " MACSTR, Entry->Channel, MAC2STR(Entry->BSSID));
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+/** @brief Drop the directed connect after a failed attempt and scan all channels with DHCP again.
+ */
+static void NetworkManager_FallbackToScan(void)
+{
+    wifi_config_t WifiConfig;
+
+    ESP_LOGW(TAG, "Fast connect failed, scanning all channels");
+
+    if (esp_wifi_get_config(WIFI_IF_STA, &WifiConfig) == ESP_OK) {
+        WifiConfig.sta.channel = 0;
+        WifiConfig.sta.bssid_set = false;
+        memset(WifiConfig.sta.bssid, 0, sizeof(WifiConfig.sta.bssid));
+        esp_wifi_set_config(WIFI_IF_STA, &WifiConfig);
+    }
+
+    if (_Network_Manager_State.isStaticIP) {
+        esp_netif_dhcpc_start(_Network_Manager_State.STA_NetIF);
+        _Network_Manager_State.isStaticIP = false;
+    }
+
+    /* The entry is written again with the access point found by the scan */
+    _Network_Manager_State.FastConnect.Channel = 0;
+    _Network_Manager_State.isFastConnect = false;
+}
+
+/** @brief          Configure the WiFi driver for a power profile. The station has to be started.
+ *  @param Profile  Power profile
+ */
+static void NetworkManager_ApplyPowerProfile(Network_PowerProfile_t Profile)
+{
+    const Network_PowerProfile_Config_t *Config;
+
+    Config = &_Network_PowerProfiles[Profile];
+
+    if (esp_wifi_set_ps(Config->PowerSave) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to set the power save mode!");
+    }
+
+    if (esp_wifi_set_max_tx_power(Config->TxPower) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to set the TX power!");
+    }
+
+    _Network_Manager_State.ActiveProfile = Profile;
+    _Network_Manager_State.LowerSince = 0;
+
+    ESP_LOGI(TAG, "Power profile: %s", Config->Name);
+}
+
 /** @brief                  WiFi event handler.
  *  @param p_HandlerArgs    Handler argument
  *  @param Base             Event base
@@ -91,6 +315,7 @@ static void on_WiFi_Event(void *p_HandlerArgs, esp_event_base_t Base, int32_t ID
         }
         case WIFI_EVENT_STA_DISCONNECTED: {
             wifi_event_sta_disconnected_t *Event = (wifi_event_sta_disconnected_t *)p_Data;
+            bool wasConnected = (_Network_Manager_State.State == NETWORK_STATE_CONNECTED);
 
             /* Decode disconnect reason for better debugging */
             const char *ReasonStr = "Unknown";
@@ -198,6 +423,18 @@ static void on_WiFi_Event(void *p_HandlerArgs, esp_event_base_t Base, int32_t ID
             esp_event_post(NETWORK_EVENTS, NETWORK_EVENT_WIFI_DISCONNECTED, p_Data, sizeof(wifi_event_sta_disconnected_t),
                            portMAX_DELAY);
 
+            /* A lost connection is first retried with the same access point. A failed directed connect falls back
+               to a full scan right away, without using up a retry */
+            if (wasConnected) {
+                _Network_Manager_State.ConnectStart = esp_timer_get_time();
+            } else if (_Network_Manager_State.isFastConnect) {
+                NetworkManager_FallbackToScan();
+                esp_wifi_connect();
+                _Network_Manager_State.State = NETWORK_STATE_CONNECTING;
+
+                break;
+            }
+
             if (_Network_Manager_State.RetryCount < _Network_Manager_State.STA_Config->MaxRetries) {
                 ESP_LOGD(TAG, "Retry %d/%d", _Network_Manager_State.RetryCount++, _Network_Manager_State.STA_Config->MaxRetries);
 
@@ -262,12 +499,25 @@ static void on_IP_Event(void *p_HandlerArgs, esp_event_base_t Base, int32_t ID,
         case IP_EVENT_STA_GOT_IP: {
             ip_event_got_ip_t *Event = (ip_event_got_ip_t *)p_Data;
             Network_IP_Info_t IP_Data;
+            uint32_t ConnectTime;
 
             ESP_LOGD(TAG, "Got IP: " IPSTR, IP2STR(&Event->ip_info.ip));
 
             memcpy(&_Network_Manager_State.IP_Info, &Event->ip_info, sizeof(esp_netif_ip_info_t));
             _Network_Manager_State.State = NETWORK_STATE_CONNECTED;
 
+            ConnectTime = static_cast<uint32_t>((esp_timer_get_time() - _Network_Manager_State.ConnectStart) / 1000);
+            ESP_LOGI(TAG, "Connected in %lu ms%s", static_cast<unsigned long>(ConnectTime),
+                     _Network_Manager_State.isFastConnect ? " (fast connect)" : "");
+            Telemetry_SetConnection(ConnectTime, _Network_Manager_State.isFastConnect);
+
+            /* The driver starts with the default modem sleep, the profile is selected again with the clients */
+            NetworkManager_ApplyPowerProfile((_Network_Manager_State.PowerProfile == NETWORK_POWER_PROFILE_AUTO) ?
+                                             _Network_Manager_State.ActiveProfile :
+                                             _Network_Manager_State.PowerProfile);
+
+            NetworkManager_SaveFastConnect(&Event->ip_info);
+
             IP_Data.IP = Event->ip_info.ip.addr;
             IP_Data.Netmask = Event->ip_info.netmask.addr;
             IP_Data.Gateway = Event->ip_info.gw.addr;
@@ -370,6 +620,11 @@ esp_err_t NetworkManager_Init(Network_WiFi_STA_Config_t *p_Config)
 
     /* Set storage type */
     ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
+
+    NetworkManager_LoadFastConnect();
+
+    _Network_Manager_State.PowerProfile = NETWORK_POWER_PROFILE_AUTO;
+    _Network_Manager_State.ActiveProfile = NETWORK_POWER_PROFILE_LOW_POWER;
     _Network_Manager_State.isInitialized = true;
     _Network_Manager_State.State = NETWORK_STATE_IDLE;
 
@@ -428,11 +683,20 @@ esp_err_t NetworkManager_StartSTA(void)
     WifiConfig.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
     WifiConfig.sta.pmf_cfg.capable = true;
     WifiConfig.sta.pmf_cfg.required = false;
+    WifiConfig.sta.listen_interval = NETWORK_LISTEN_INTERVAL;
     strncpy((char *)WifiConfig.sta.ssid, _Network_Manager_State.STA_Config->Credentials.SSID,
             sizeof(WifiConfig.sta.ssid) - 1);
     strncpy((char *)WifiConfig.sta.password, _Network_Manager_State.STA_Config->Credentials.Password,
             sizeof(WifiConfig.sta.password) - 1);
 
+    _Network_Manager_State.isFastConnect = NetworkManager_ApplyFastConnect(&WifiConfig);
+    if ((_Network_Manager_State.isFastConnect == false) && _Network_Manager_State.isStaticIP) {
+        esp_netif_dhcpc_start(_Network_Manager_State.STA_NetIF);
+        _Network_Manager_State.isStaticIP = false;
+    }
+
+    _Network_Manager_State.ConnectStart = esp_timer_get_time();
+
     /* Set STA mode - WiFi might still be in APSTA mode from provisioning */
     err = esp_wifi_set_mode(WIFI_MODE_STA);
     if (err != ESP_OK) {
@@ -618,6 +882,74 @@ esp_err_t NetworkManager_SetCredentials(Network_WiFi_Credentials_t *p_Credential
     return ESP_OK;
 }
 
+esp_err_t NetworkManager_SetPowerProfile(Network_PowerProfile_t Profile)
+{
+    if (Profile > NETWORK_POWER_PROFILE_AUTO) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    _Network_Manager_State.PowerProfile = Profile;
+
+    if ((Profile != NETWORK_POWER_PROFILE_AUTO) && NetworkManager_isConnected()) {
+        NetworkManager_ApplyPowerProfile(Profile);
+    }
+
+    return ESP_OK;
+}
+
+Network_PowerProfile_t NetworkManager_GetPowerProfile(void)
+{
+    return _Network_Manager_State.ActiveProfile;
+}
+
+uint32_t NetworkManager_UpdatePowerProfile(void)
+{
+    Network_PowerProfile_t Target;
+    bool isStreaming;
+    int64_t Elapsed;
+    int64_t Now;
+
+    if ((_Network_Manager_State.PowerProfile != NETWORK_POWER_PROFILE_AUTO) ||
+        (NetworkManager_isConnected() == false)) {
+        return UINT32_MAX;
+    }
+
+    Now = esp_timer_get_time();
+    Elapsed = Now - _Network_Manager_State.PowerUpdateTime;
+    if (Elapsed < (NETWORK_POWER_UPDATE_MS * 1000LL)) {
+        return NETWORK_POWER_UPDATE_MS - (Elapsed / 1000);
+    }
+
+    _Network_Manager_State.PowerUpdateTime = Now;
+
+    isStreaming = (WebSocket_Handler_GetStreamCount() > 0) || (HTTP_Server_GetStreamCount() > 0);
+#ifdef CONFIG_NETWORK_RTP
+    isStreaming = isStreaming || RTPStreamer_isRunning();
+#endif
+
+    if (isStreaming) {
+        Target = NETWORK_POWER_PROFILE_THROUGHPUT;
+    } else if (WebSocket_Handler_HasClients()) {
+        Target = NETWORK_POWER_PROFILE_INTERACTIVE;
+    } else {
+        Target = NETWORK_POWER_PROFILE_LOW_POWER;
+    }
+
+    /* A new stream gets the full throughput right away. The power is only saved again when the clients are gone
+       for a while, so a reloading browser does not toggle the modem sleep */
+    if (Target > _Network_Manager_State.ActiveProfile) {
+        NetworkManager_ApplyPowerProfile(Target);
+    } else if (Target == _Network_Manager_State.ActiveProfile) {
+        _Network_Manager_State.LowerSince = 0;
+    } else if (_Network_Manager_State.LowerSince == 0) {
+        _Network_Manager_State.LowerSince = Now;
+    } else if ((Now - _Network_Manager_State.LowerSince) >= (CONFIG_NETWORK_WIFI_POWER_HOLD_MS * 1000LL)) {
+        NetworkManager_ApplyPowerProfile(Target);
+    }
+
+    return NETWORK_POWER_UPDATE_MS;
+}
+
 uint8_t NetworkManager_GetConnectedStations(void)
 {
     wifi_sta_list_t StaList;
@@ -103,6 +103,27 @@ esp_err_t NetworkManager_SetCredentials(Network_WiFi_Credentials_t *p_Credential
  */
 uint8_t NetworkManager_GetConnectedStations(void);
 
+/** @brief          Set the WiFi power profile. With NETWORK_POWER_PROFILE_AUTO (default) the profile follows the
+ *                  clients and the streams of the server, see NetworkManager_UpdatePowerProfile.
+ *  @param Profile  Power profile
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if the profile is invalid
+ */
+esp_err_t NetworkManager_SetPowerProfile(Network_PowerProfile_t Profile);
+
+/** @brief  Get the active WiFi power profile.
+ *  @return Active profile, never NETWORK_POWER_PROFILE_AUTO
+ */
+Network_PowerProfile_t NetworkManager_GetPowerProfile(void);
+
+/** @brief  Select the power profile from the WebSocket clients and the image streams. A higher profile is used
+ *          right away, a lower one only after it was requested for CONFIG_NETWORK_WIFI_POWER_HOLD_MS. Call it
+ *          from the network task.
+ *  @return Time in ms until the next call is due, UINT32_MAX if the profile is not selected automatically or the
+ *          station is not connected
+ */
+uint32_t NetworkManager_UpdatePowerProfile(void);
+
 /** @brief              Start the network server (HTTP + Websocket + VISA).
  *  @param p_Config     Pointer to server configuration
  *  @return             ESP_OK on success
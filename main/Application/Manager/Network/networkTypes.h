@@ -35,6 +35,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "Application/Tasks/Lepton/framePool.h"
+
 /* Declare network event base */
 ESP_EVENT_DECLARE_BASE(NETWORK_EVENTS);
 
@@ -50,6 +52,15 @@ typedef enum {
     NETWORK_STATE_ERROR,
 } Network_State_t;
 
+/** @brief WiFi power profile of the station.
+ */
+typedef enum {
+    NETWORK_POWER_PROFILE_LOW_POWER = 0,        /**< Maximum modem sleep, no clients. */
+    NETWORK_POWER_PROFILE_INTERACTIVE,          /**< Minimum modem sleep, clients without an image stream. */
+    NETWORK_POWER_PROFILE_THROUGHPUT,           /**< No modem sleep and full TX power, at least one image stream. */
+    NETWORK_POWER_PROFILE_AUTO,                 /**< Follow the clients and the streams of the server. */
+} Network_PowerProfile_t;
+
 /** @brief Provisioning method.
  */
 typedef enum {
@@ -65,8 +76,33 @@ typedef enum {
     NETWORK_IMAGE_FORMAT_JPEG = 0,
     NETWORK_IMAGE_FORMAT_PNG,
     NETWORK_IMAGE_FORMAT_RAW,
+    NETWORK_IMAGE_FORMAT_INDEXED,               /**< 8 bit palette indices with AGC window, see ImageEncoder_Indexed_Header_t */
+    NETWORK_IMAGE_FORMAT_PALETTE,               /**< Palette colors, see ImageEncoder_Palette_Header_t */
+    NETWORK_IMAGE_FORMAT_RADIOMETRIC,           /**< Compressed RAW frame, see ImageEncoder_Radiometric_Header_t */
+    NETWORK_IMAGE_FORMAT_TEMPERATURE,           /**< Map in centi-Kelvin, see ImageEncoder_Temperature_Header_t */
 } Network_ImageFormat_t;
 
+/** @brief Levels of the image pyramid of a frame. Every level is built once per frame and shared by all formats,
+ *         palettes and clients of the level.
+ */
+typedef enum {
+    NETWORK_IMAGE_LEVEL_NATIVE = 0,             /**< Sensor resolution. */
+    NETWORK_IMAGE_LEVEL_HALF,                   /**< Half width and height, 2x2 box filtered, e.g. for thumbnails. */
+    NETWORK_IMAGE_LEVEL_DOUBLE,                 /**< Double width and height, bilinear interpolated. */
+    NETWORK_IMAGE_LEVEL_COUNT,
+} Network_ImageLevel_t;
+
+/** @brief Crop and zoom window of a stream or an image in pixels of the native frame. The region is cut from the
+ *         RAW frame and scaled before the colors are applied, see ImageEncoder_EncodeView.
+ */
+typedef struct {
+    uint16_t X;                                 /**< Left column of the region. */
+    uint16_t Y;                                 /**< Top row of the region. */
+    uint16_t Width;                             /**< Width of the region, 0 for the full frame. */
+    uint16_t Height;                            /**< Height of the region, 0 for the full frame. */
+    uint8_t Zoom;                               /**< Scale of the region, 1 to IMAGE_ENCODER_MAX_ZOOM. */
+} Network_ImageWindow_t;
+
 /** @brief Network event types (used as event IDs in NETWORK_EVENTS base).
  */
 typedef enum {
@@ -86,10 +122,12 @@ typedef enum {
     NETWORK_EVENT_PROV_SUCCESS,
     NETWORK_EVENT_PROV_FAILED,
     NETWORK_EVENT_PROV_TIMEOUT,
-    NETWORK_EVENT_OTA_STARTED,
-    NETWORK_EVENT_OTA_PROGRESS,
-    NETWORK_EVENT_OTA_COMPLETED,
-    NETWORK_EVENT_OTA_FAILED,
+    NETWORK_EVENT_OTA_STARTED,                  /**< A firmware update has started */
+    NETWORK_EVENT_OTA_PROGRESS,                 /**< Firmware update progress, at most every
+                                                     CONFIG_NETWORK_OTA_PROGRESS_INTERVAL ms
+                                                     Data is of type Network_Event_OTA_Progress_t */
+    NETWORK_EVENT_OTA_COMPLETED,                /**< The firmware update is written and selected for the next boot */
+    NETWORK_EVENT_OTA_FAILED,                   /**< The firmware update has failed or was aborted */
     NETWORK_EVENT_SNTP_SYNCED,                  /**< SNTP time synchronization completed
                                                      Data is of type struct timeval */
     NETWORK_EVENT_SET_TZ,                       /**< Set the timezone
@@ -106,6 +144,8 @@ typedef enum {
     PALETTE_IRON = 0,
     PALETTE_GRAY,
     PALETTE_RAINBOW,
+    PALETTE_CUSTOM,                             /**< User defined palette, see ImageEncoder_SetCustomPalette */
+    PALETTE_COUNT,
 } Server_Palette_t;
 
 /** @brief Scale mode for temperature visualization.
@@ -132,15 +172,21 @@ typedef enum {
 } Server_WS_Message_Type_t;
 
 /** @brief Thermal frame data structure.
+ *         The buffers belong to a frame pool slot. The owner of the structure holds one reference on the slot
+ *         and replaces it only while holding the mutex, so the buffers are valid as long as the mutex is taken.
  */
 typedef struct {
     uint8_t *buffer;                    /**< Pointer to RGB888 image data */
+    uint16_t *raw;                      /**< Pointer to RAW14 image data. NULL if the frame has no RAW14 data */
     uint16_t width;                     /**< Frame width in pixels */
     uint16_t height;                    /**< Frame height in pixels */
+    uint32_t sequence;                  /**< Frame sequence number of the frame pool */
+    FramePool_Frame_t *frame;           /**< Frame pool slot of the buffers */
     float temp_min;                     /**< Minimum temperature in frame */
     float temp_max;                     /**< Maximum temperature in frame */
     float temp_avg;                     /**< Average temperature in frame */
     uint32_t timestamp;                 /**< Timestamp in milliseconds */
+    int64_t time;                       /**< Capture time in microseconds since 1970-01-01 UTC, 0 if not set */
     SemaphoreHandle_t mutex;            /**< Mutex for thread-safe access */
 } Network_Thermal_Frame_t;
 
@@ -149,9 +195,16 @@ typedef struct {
 typedef struct {
     uint8_t *data;                      /**< Encoded image data */
     size_t size;                        /**< Size of encoded data */
+    size_t capacity;                    /**< Size of the data buffer */
+    bool isPooled;                      /**< true when data belongs to the encoder buffer pool */
     Network_ImageFormat_t format;       /**< Image format */
+    bool isKeyframe;                    /**< true for radiometric frames that do not refer to a keyframe */
     uint16_t width;                     /**< Image width */
     uint16_t height;                    /**< Image height */
+    uint32_t sequence;                  /**< Sequence number of the source frame, 0 if unknown */
+    uint32_t timestamp;                 /**< Capture time of the source frame in milliseconds */
+    int64_t time;                       /**< Capture time of the source frame in microseconds since 1970-01-01 UTC,
+                                             0 if not set */
 } Network_Encoded_Image_t;
 
 /** @brief IP info event data (for NETWORK_EVENT_WIFI_GOT_IP).
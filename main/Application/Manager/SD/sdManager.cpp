@@ -29,6 +29,7 @@
 #include <esp_task_wdt.h>
 #include <driver/sdspi_host.h>
 #include <driver/spi_common.h>
+#include <driver/sdmmc_host.h>
 #include <driver/gpio.h>
 #include <sdmmc_cmd.h>
 
@@ -42,7 +43,13 @@
 #include "Application/application.h"
 #include "Application/Manager/Devices/SPI/spi.h"
 
-#if defined(CONFIG_SD_CARD_SPI2_HOST)
+#if defined(CONFIG_SD_CARD_INTERFACE_SDMMC)
+#if defined(CONFIG_SD_CARD_SDMMC_4BIT)
+#define SD_SDMMC_WIDTH                  4
+#else
+#define SD_SDMMC_WIDTH                  1
+#endif
+#elif defined(CONFIG_SD_CARD_SPI2_HOST)
 #define SD_SPI_HOST                     SPI2_HOST
 #elif defined(CONFIG_SD_CARD_SPI3_HOST)
 #define SD_SPI_HOST                     SPI3_HOST
@@ -64,7 +71,11 @@ static const char *TAG = "sd-manager";
 typedef struct {
     sdmmc_card_t *Card;
     sdmmc_host_t Host;
+#if defined(CONFIG_SD_CARD_INTERFACE_SDMMC)
+    sdmmc_slot_config_t SlotConfig;
+#else
     sdspi_device_config_t SlotConfig;
+#endif
     bool isInitialized;
     esp_timer_handle_t DebounceTimer;
     esp_vfs_fat_sdmmc_mount_config_t MountConfig;
@@ -111,6 +122,22 @@ static void IRAM_ATTR SDManager_CardDetectISR(void *p_Arg)
 }
 #endif
 
+/** @brief  Mount the FAT filesystem of the card with the configured interface.
+ *  @return ESP_OK on success
+ *          ESP_FAIL if the filesystem can not be mounted
+ *          Other errors from the card initialization
+ */
+static esp_err_t SDManager_MountFilesystem(void)
+{
+#if defined(CONFIG_SD_CARD_INTERFACE_SDMMC)
+    return esp_vfs_fat_sdmmc_mount(SD_MOUNT_POINT, &_SD_Manager_State.Host, &_SD_Manager_State.SlotConfig,
+                                   &_SD_Manager_State.MountConfig, &_SD_Manager_State.Card);
+#else
+    return esp_vfs_fat_sdspi_mount(SD_MOUNT_POINT, &_SD_Manager_State.Host, &_SD_Manager_State.SlotConfig,
+                                   &_SD_Manager_State.MountConfig, &_SD_Manager_State.Card);
+#endif
+}
+
 esp_err_t SDManager_Init(void)
 {
     if (_SD_Manager_State.isInitialized) {
@@ -120,10 +147,12 @@ esp_err_t SDManager_Init(void)
 
     ESP_LOGI(TAG, "Initializing SD Manager...");
 
+#if defined(CONFIG_SD_CARD_INTERFACE_SPI)
     if (CONFIG_SD_CARD_PIN_CS < 0) {
         ESP_LOGE(TAG, "Invalid CS pin!");
         return ESP_ERR_INVALID_ARG;
     }
+#endif
 
     _SD_Manager_State.MountConfig = {
 #ifdef CONFIG_SD_CARD_FORMAT_CARD
@@ -137,20 +166,46 @@ esp_err_t SDManager_Init(void)
         .use_one_fat = false
     };
 
+#if defined(CONFIG_SD_CARD_INTERFACE_SDMMC)
+    /* The card is the only device on the SDMMC bus, so it does not compete with the display on the SPI bus */
+    _SD_Manager_State.Host = SDMMC_HOST_DEFAULT();
+#ifdef CONFIG_SD_CARD_SDMMC_HIGHSPEED
+    _SD_Manager_State.Host.max_freq_khz = SDMMC_FREQ_HIGHSPEED;
+#endif
+    _SD_Manager_State.SlotConfig = SDMMC_SLOT_CONFIG_DEFAULT();
+    _SD_Manager_State.SlotConfig.width = SD_SDMMC_WIDTH;
+    _SD_Manager_State.SlotConfig.clk = static_cast<gpio_num_t>(CONFIG_SD_CARD_PIN_CLK);
+    _SD_Manager_State.SlotConfig.cmd = static_cast<gpio_num_t>(CONFIG_SD_CARD_PIN_CMD);
+    _SD_Manager_State.SlotConfig.d0 = static_cast<gpio_num_t>(CONFIG_SD_CARD_PIN_D0);
+#if defined(CONFIG_SD_CARD_SDMMC_4BIT)
+    _SD_Manager_State.SlotConfig.d1 = static_cast<gpio_num_t>(CONFIG_SD_CARD_PIN_D1);
+    _SD_Manager_State.SlotConfig.d2 = static_cast<gpio_num_t>(CONFIG_SD_CARD_PIN_D2);
+    _SD_Manager_State.SlotConfig.d3 = static_cast<gpio_num_t>(CONFIG_SD_CARD_PIN_D3);
+#endif
+    _SD_Manager_State.SlotConfig.cd = SDMMC_SLOT_NO_CD;
+    _SD_Manager_State.SlotConfig.wp = SDMMC_SLOT_NO_WP;
+
+    /* Most boards have no external pull-ups on the data lines */
+    _SD_Manager_State.SlotConfig.flags |= SDMMC_SLOT_FLAG_INTERNAL_PULLUP;
+#else
     _SD_Manager_State.Host = SDSPI_HOST_DEFAULT();
     _SD_Manager_State.Host.slot = SD_SPI_HOST;
     _SD_Manager_State.SlotConfig = SDSPI_DEVICE_CONFIG_DEFAULT();
     _SD_Manager_State.SlotConfig.gpio_cs = static_cast<gpio_num_t>(CONFIG_SD_CARD_PIN_CS);
     _SD_Manager_State.SlotConfig.host_id = static_cast<spi_host_device_t>(_SD_Manager_State.Host.slot);
+#endif
 
-    if (esp_vfs_fat_sdspi_mount("/sdcard", &_SD_Manager_State.Host, &_SD_Manager_State.SlotConfig,
-                                &_SD_Manager_State.MountConfig, &_SD_Manager_State.Card) != ESP_OK) {
+    if (SDManager_MountFilesystem() != ESP_OK) {
         ESP_LOGE(TAG, "Failed to mount SD card filesystem!");
         return ESP_FAIL;
     }
 
     ESP_LOGI(TAG, "SD card filesystem mounted successfully");
 
+#if defined(CONFIG_SD_CARD_INTERFACE_SDMMC)
+    ESP_LOGI(TAG, "SDMMC bus: %d-bit, %d kHz", SD_SDMMC_WIDTH, _SD_Manager_State.Card->real_freq_khz);
+#endif
+
 #if CONFIG_SD_CARD_PIN_CD > 0
     esp_err_t Error;
 
@@ -255,6 +310,22 @@ bool SDManager_isCardPresent(void)
     return _SD_Manager_State.CardPresent;
 }
 
+bool SDManager_isMounted(void)
+{
+    return _SD_Manager_State.Card != NULL;
+}
+
+esp_err_t SDManager_GetFreeSpace(uint64_t *p_Total, uint64_t *p_Free)
+{
+    if ((p_Total == NULL) || (p_Free == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_SD_Manager_State.Card == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return esp_vfs_fat_info(SD_MOUNT_POINT, p_Total, p_Free);
+}
+
 /** @brief      Background task for mounting SD card (prevents GUI blocking).
  *  @param arg  Unused
  */
@@ -271,9 +342,7 @@ static void SDManager_MountTask(void *arg)
     /* Reset WDT before mount attempt */
     esp_task_wdt_reset();
 
-    Error = esp_vfs_fat_sdspi_mount(SD_MOUNT_POINT, &_SD_Manager_State.Host, &_SD_Manager_State.SlotConfig,
-                                    &_SD_Manager_State.MountConfig,
-                                    &_SD_Manager_State.Card);
+    Error = SDManager_MountFilesystem();
 
     /* Reset WDT after mount attempt */
     esp_task_wdt_reset();
@@ -59,6 +59,21 @@ esp_err_t SDManager_Deinit(void);
  */
 bool SDManager_isCardPresent(void);
 
+/** @brief  Check if the file system of the SD card is mounted.
+ *  @return true if mounted, false otherwise
+ */
+bool SDManager_isMounted(void);
+
+/** @brief          Get the size and the free space of the mounted file system.
+ *                  This can take some time on the first call after the mount, because FATFS has to scan the FAT.
+ *  @param p_Total  Pointer to store the size in bytes
+ *  @param p_Free   Pointer to store the free space in bytes
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if a pointer is NULL
+ *                  ESP_ERR_INVALID_STATE if no card is mounted
+ */
+esp_err_t SDManager_GetFreeSpace(uint64_t *p_Total, uint64_t *p_Free);
+
 /** @brief  Mount the SD card.
  *  @return ESP_OK on success
  */
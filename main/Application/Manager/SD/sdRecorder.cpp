@@ -0,0 +1,739 @@
+/*
+ * sdRecorder.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Continuous RAW14 video recorder for the SD card.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_vfs_fat.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "sdRecorder.h"
+#include "sdManager.h"
+#include "Application/Manager/Time/timeManager.h"
+#include "Application/Tasks/Lepton/frameProducts.h"
+#include "Application/Trace/trace.h"
+#include "Application/Memory/memoryPlan.h"
+
+#include "sdkconfig.h"
+
+/** @brief Size of the file header in bytes. The records start in the second sector.
+ */
+#define SD_RECORDER_HEADER_SIZE         SD_RECORDER_SECTOR_SIZE
+
+/** @brief Size of a single write in bytes.
+ */
+#define SD_RECORDER_CHUNK_SIZE          (CONFIG_SD_RECORDER_CHUNK_KB * 1024)
+
+/** @brief Preallocated size of a segment file in bytes.
+ */
+#define SD_RECORDER_SEGMENT_SIZE        (static_cast<uint64_t>(CONFIG_SD_RECORDER_SEGMENT_MB) * 1024 * 1024)
+
+/** @brief Number of index entries in RAM. The index is written early when it is full.
+ */
+#define SD_RECORDER_INDEX_ENTRIES       128
+
+/** @brief Maximum time the writer waits for a new frame in milliseconds.
+ */
+#define SD_RECORDER_WAIT_MS             100
+
+/** @brief Highest recording number (RECnnnn).
+ */
+#define SD_RECORDER_MAX_RECORDINGS      9999
+
+static_assert(sizeof(SDRecorder_File_Header_t) <= SD_RECORDER_HEADER_SIZE, "File header larger than one sector");
+static_assert((SD_RECORDER_CHUNK_SIZE % SD_RECORDER_SECTOR_SIZE) == 0, "Write size must be a multiple of a sector");
+
+typedef struct {
+    bool isInitialized;
+    volatile bool isRecording;                  /**< Frames are accepted. Read without the lock by the Lepton task. */
+    volatile bool isActive;                     /**< A recording is running or its remaining frames are written. */
+    bool isPushing;                             /**< The Lepton task is copying a frame into the ring. */
+    bool isStopRequested;                       /**< The writer closes the files when the ring is empty. */
+    TaskHandle_t Task;
+    uint16_t Width;
+    uint16_t Height;
+    size_t RecordSize;                          /**< Size of one record in bytes, multiple of a sector. */
+    uint16_t Slots;                             /**< Number of records in the ring. */
+    uint8_t *Ring;                              /**< Slots records in PSRAM. */
+    uint32_t Head;                              /**< Number of pushed frames. Only changed by the Lepton task. */
+    uint32_t Tail;                              /**< Frames copied into the chunk. Only changed by the writer. */
+    uint8_t *Chunk;                             /**< DMA capable write buffer in internal RAM. */
+    size_t ChunkFill;                           /**< Bytes in the chunk. Always a multiple of a sector. */
+    uint32_t ChunkRecords;                      /**< Records which end in the chunk. */
+    size_t ReadOffset;                          /**< Bytes of the record at Tail which are already in the chunk. */
+    int File;                                   /**< Segment file, -1 if closed. */
+    int IndexFile;                              /**< Index file, -1 if closed. */
+    char Path[32];                              /**< Path of the segment file. */
+    SDRecorder_File_Header_t Header;            /**< Header of the segment. Frames counts the written records. */
+    uint32_t SegmentRecords;                    /**< Records of the segment including the ones in the chunk. */
+    SDRecorder_Index_Entry_t Index[SD_RECORDER_INDEX_ENTRIES];  /**< Index entries which are not written yet. */
+    uint16_t IndexCount;                        /**< Number of entries in Index. */
+    int64_t LastIndex;                          /**< Time of the last index write in microseconds since boot. */
+    SDRecorder_Status_t Status;                 /**< Counters. Only changed with the lock taken. */
+} SDRecorder_State_t;
+
+static SDRecorder_State_t _SDRecorder_State;
+
+/* The ring positions and the counters are shared between the Lepton task, the writer and the callers */
+static portMUX_TYPE _SDRecorder_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *TAG = "sd-recorder";
+
+/** @brief  Find the next free recording number and create its directory.
+ *  @return ESP_OK on success
+ *          ESP_ERR_NOT_FOUND if all recording numbers are used
+ *          ESP_FAIL if the directory can not be created
+ */
+static esp_err_t SDRecorder_CreateDirectory(void)
+{
+    struct stat Info;
+    char Path[24];
+
+    for (uint16_t i = 1; i <= SD_RECORDER_MAX_RECORDINGS; i++) {
+        snprintf(Path, sizeof(Path), "%s/REC%04u", SD_MOUNT_POINT, i);
+
+        if (stat(Path, &Info) == 0) {
+            continue;
+        }
+
+        if (mkdir(Path, 0775) != 0) {
+            ESP_LOGE(TAG, "Failed to create %s!", Path);
+            return ESP_FAIL;
+        }
+
+        _SDRecorder_State.Header.Recording = i;
+
+        return ESP_OK;
+    }
+
+    ESP_LOGE(TAG, "No free recording number!");
+
+    return ESP_ERR_NOT_FOUND;
+}
+
+/** @brief  Write the chunk to the segment file.
+ *  @return ESP_OK on success
+ *          ESP_FAIL if the write failed
+ */
+static esp_err_t SDRecorder_WriteChunk(void)
+{
+    ssize_t Written;
+
+    if (_SDRecorder_State.ChunkFill == 0) {
+        return ESP_OK;
+    }
+
+    TRACE_BEGIN(TRACE_EVENT_SD_WRITE);
+    Written = write(_SDRecorder_State.File, _SDRecorder_State.Chunk, _SDRecorder_State.ChunkFill);
+    TRACE_END(TRACE_EVENT_SD_WRITE);
+    if (Written != static_cast<ssize_t>(_SDRecorder_State.ChunkFill)) {
+        ESP_LOGE(TAG, "Failed to write %u bytes to %s!", static_cast<unsigned int>(_SDRecorder_State.ChunkFill),
+                 _SDRecorder_State.Path);
+        return ESP_FAIL;
+    }
+
+    _SDRecorder_State.Header.Frames += _SDRecorder_State.ChunkRecords;
+
+    portENTER_CRITICAL(&_SDRecorder_Lock);
+    _SDRecorder_State.Status.Frames += _SDRecorder_State.ChunkRecords;
+    _SDRecorder_State.Status.Bytes += _SDRecorder_State.ChunkFill;
+    portEXIT_CRITICAL(&_SDRecorder_Lock);
+
+    _SDRecorder_State.ChunkFill = 0;
+    _SDRecorder_State.ChunkRecords = 0;
+
+    return ESP_OK;
+}
+
+/** @brief  Write the chunk, the pending index entries and the file header. Everything written before is
+ *          readable after a power loss afterwards.
+ *  @return ESP_OK on success
+ *          ESP_FAIL if a write failed
+ */
+static esp_err_t SDRecorder_WriteIndex(void)
+{
+    size_t Length;
+    esp_err_t Error;
+
+    Error = SDRecorder_WriteChunk();
+    if (Error != ESP_OK) {
+        return Error;
+    }
+
+    if (_SDRecorder_State.IndexCount > 0) {
+        Length = _SDRecorder_State.IndexCount * sizeof(SDRecorder_Index_Entry_t);
+
+        if (write(_SDRecorder_State.IndexFile, _SDRecorder_State.Index, Length) != static_cast<ssize_t>(Length)) {
+            ESP_LOGE(TAG, "Failed to write the index of %s!", _SDRecorder_State.Path);
+            return ESP_FAIL;
+        }
+
+        _SDRecorder_State.IndexCount = 0;
+    }
+
+    portENTER_CRITICAL(&_SDRecorder_Lock);
+    _SDRecorder_State.Header.Dropped = _SDRecorder_State.Status.Dropped;
+    portEXIT_CRITICAL(&_SDRecorder_Lock);
+
+    /* The chunk is empty now and is used for the header sector */
+    memset(_SDRecorder_State.Chunk, 0, SD_RECORDER_HEADER_SIZE);
+    memcpy(_SDRecorder_State.Chunk, &_SDRecorder_State.Header, sizeof(SDRecorder_File_Header_t));
+
+    if (pwrite(_SDRecorder_State.File, _SDRecorder_State.Chunk, SD_RECORDER_HEADER_SIZE, 0) !=
+        SD_RECORDER_HEADER_SIZE) {
+        ESP_LOGE(TAG, "Failed to update the header of %s!", _SDRecorder_State.Path);
+        return ESP_FAIL;
+    }
+
+    fsync(_SDRecorder_State.File);
+    fsync(_SDRecorder_State.IndexFile);
+
+    _SDRecorder_State.LastIndex = esp_timer_get_time();
+
+    return ESP_OK;
+}
+
+/** @brief  Close the files of the segment. The preallocated part behind the last record is released.
+ *  @return ESP_OK on success
+ *          ESP_FAIL if a write failed
+ */
+static esp_err_t SDRecorder_CloseSegment(void)
+{
+    esp_err_t Error;
+
+    if (_SDRecorder_State.File < 0) {
+        return ESP_OK;
+    }
+
+    Error = SDRecorder_WriteIndex();
+    if (Error == ESP_OK) {
+        ftruncate(_SDRecorder_State.File, SD_RECORDER_HEADER_SIZE +
+                  (static_cast<off_t>(_SDRecorder_State.Header.Frames) * _SDRecorder_State.RecordSize));
+    }
+
+    close(_SDRecorder_State.File);
+    close(_SDRecorder_State.IndexFile);
+    _SDRecorder_State.File = -1;
+    _SDRecorder_State.IndexFile = -1;
+
+    ESP_LOGI(TAG, "%s closed with %u frames", _SDRecorder_State.Path,
+             static_cast<unsigned int>(_SDRecorder_State.Header.Frames));
+
+    return Error;
+}
+
+/** @brief  Open the next segment of the recording. The segment file is allocated as one contiguous block, so the
+ *          writes never wait for a cluster allocation. The file header is the first sector of the chunk.
+ *  @return ESP_OK on success
+ *          ESP_FAIL if a file can not be created
+ */
+static esp_err_t SDRecorder_OpenSegment(void)
+{
+    SDRecorder_File_Header_t *p_Header = &_SDRecorder_State.Header;
+    char IndexPath[32];
+    int Flags = 0;
+    esp_err_t Error;
+
+    p_Header->Segment++;
+
+    snprintf(_SDRecorder_State.Path, sizeof(_SDRecorder_State.Path), "%s/REC%04u/SEG%03u.PRV", SD_MOUNT_POINT,
+             p_Header->Recording, p_Header->Segment);
+    snprintf(IndexPath, sizeof(IndexPath), "%s/REC%04u/SEG%03u.IDX", SD_MOUNT_POINT, p_Header->Recording,
+             p_Header->Segment);
+
+    /* This scans the FAT once per segment. The ring holds the frames in the meantime. */
+    Error = esp_vfs_fat_create_contiguous_file(SD_MOUNT_POINT, _SDRecorder_State.Path, SD_RECORDER_SEGMENT_SIZE, true);
+    if (Error != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to preallocate %s (%d), writing without preallocation!", _SDRecorder_State.Path, Error);
+        Flags = O_CREAT | O_TRUNC;
+    }
+
+    _SDRecorder_State.File = open(_SDRecorder_State.Path, O_WRONLY | Flags, 0664);
+    if (_SDRecorder_State.File < 0) {
+        ESP_LOGE(TAG, "Failed to open %s!", _SDRecorder_State.Path);
+        return ESP_FAIL;
+    }
+
+    _SDRecorder_State.IndexFile = open(IndexPath, O_WRONLY | O_CREAT | O_TRUNC, 0664);
+    if (_SDRecorder_State.IndexFile < 0) {
+        ESP_LOGE(TAG, "Failed to open %s!", IndexPath);
+
+        close(_SDRecorder_State.File);
+        _SDRecorder_State.File = -1;
+
+        return ESP_FAIL;
+    }
+
+    p_Header->Magic = SD_RECORDER_FILE_MAGIC;
+    p_Header->Version = SD_RECORDER_FILE_VERSION;
+    p_Header->HeaderSize = SD_RECORDER_HEADER_SIZE;
+    p_Header->RecordSize = _SDRecorder_State.RecordSize;
+    p_Header->Width = _SDRecorder_State.Width;
+    p_Header->Height = _SDRecorder_State.Height;
+    p_Header->Frames = 0;
+    p_Header->StartTimestamp = esp_timer_get_time();
+    p_Header->StartTime = TimeManager_ToUTC(p_Header->StartTimestamp);
+
+    portENTER_CRITICAL(&_SDRecorder_Lock);
+    p_Header->Dropped = _SDRecorder_State.Status.Dropped;
+    _SDRecorder_State.Status.Recording = p_Header->Recording;
+    _SDRecorder_State.Status.Segment = p_Header->Segment;
+    portEXIT_CRITICAL(&_SDRecorder_Lock);
+
+    /* The chunk is always written before a segment is changed, so it is empty here */
+    memset(_SDRecorder_State.Chunk, 0, SD_RECORDER_HEADER_SIZE);
+    memcpy(_SDRecorder_State.Chunk, p_Header, sizeof(SDRecorder_File_Header_t));
+    _SDRecorder_State.ChunkFill = SD_RECORDER_HEADER_SIZE;
+    _SDRecorder_State.ChunkRecords = 0;
+
+    _SDRecorder_State.SegmentRecords = 0;
+    _SDRecorder_State.IndexCount = 0;
+    _SDRecorder_State.LastIndex = p_Header->StartTimestamp;
+
+    ESP_LOGI(TAG, "Recording to %s", _SDRecorder_State.Path);
+
+    return ESP_OK;
+}
+
+/** @brief  Copy the frames from the ring into the chunk and write every full chunk. A new segment is opened when
+ *          the next record does not fit into the current one anymore.
+ *  @return ESP_OK on success
+ *          ESP_FAIL if a write failed
+ */
+static esp_err_t SDRecorder_Drain(void)
+{
+    const SDRecorder_Frame_Header_t *p_Frame;
+    const uint8_t *p_Record;
+    SDRecorder_Index_Entry_t *p_Entry;
+    uint32_t Available;
+    size_t Length;
+    esp_err_t Error;
+
+    while (true) {
+        portENTER_CRITICAL(&_SDRecorder_Lock);
+        Available = _SDRecorder_State.Head - _SDRecorder_State.Tail;
+        portEXIT_CRITICAL(&_SDRecorder_Lock);
+
+        if (Available == 0) {
+            return ESP_OK;
+        }
+
+        if ((_SDRecorder_State.ReadOffset == 0) &&
+            ((SD_RECORDER_HEADER_SIZE + ((static_cast<uint64_t>(_SDRecorder_State.SegmentRecords) + 1) *
+                                         _SDRecorder_State.RecordSize)) > SD_RECORDER_SEGMENT_SIZE)) {
+            Error = SDRecorder_CloseSegment();
+            if (Error != ESP_OK) {
+                return Error;
+            }
+
+            Error = SDRecorder_OpenSegment();
+            if (Error != ESP_OK) {
+                return Error;
+            }
+        }
+
+        p_Record = _SDRecorder_State.Ring + ((_SDRecorder_State.Tail % _SDRecorder_State.Slots) *
+                                             _SDRecorder_State.RecordSize);
+
+        /* A record can span two chunks, both sizes are multiples of a sector */
+        Length = _SDRecorder_State.RecordSize - _SDRecorder_State.ReadOffset;
+        if (Length > (SD_RECORDER_CHUNK_SIZE - _SDRecorder_State.ChunkFill)) {
+            Length = SD_RECORDER_CHUNK_SIZE - _SDRecorder_State.ChunkFill;
+        }
+
+        memcpy(_SDRecorder_State.Chunk + _SDRecorder_State.ChunkFill, p_Record + _SDRecorder_State.ReadOffset,
+               Length);
+        _SDRecorder_State.ChunkFill += Length;
+        _SDRecorder_State.ReadOffset += Length;
+
+        if (_SDRecorder_State.ReadOffset == _SDRecorder_State.RecordSize) {
+            p_Frame = reinterpret_cast<const SDRecorder_Frame_Header_t *>(p_Record);
+
+            p_Entry = &_SDRecorder_State.Index[_SDRecorder_State.IndexCount++];
+            p_Entry->Sequence = p_Frame->Sequence;
+            p_Entry->Timestamp = p_Frame->Timestamp;
+
+            portENTER_CRITICAL(&_SDRecorder_Lock);
+            p_Entry->Dropped = _SDRecorder_State.Status.Dropped;
+
+            /* The slot is free for the Lepton task again */
+            _SDRecorder_State.Tail++;
+            portEXIT_CRITICAL(&_SDRecorder_Lock);
+
+            _SDRecorder_State.ReadOffset = 0;
+            _SDRecorder_State.ChunkRecords++;
+            _SDRecorder_State.SegmentRecords++;
+
+            if (_SDRecorder_State.IndexCount >= SD_RECORDER_INDEX_ENTRIES) {
+                Error = SDRecorder_WriteIndex();
+                if (Error != ESP_OK) {
+                    return Error;
+                }
+            }
+        }
+
+        if (_SDRecorder_State.ChunkFill == SD_RECORDER_CHUNK_SIZE) {
+            Error = SDRecorder_WriteChunk();
+            if (Error != ESP_OK) {
+                return Error;
+            }
+        }
+    }
+}
+
+/** @brief          Stop the recording after an error. The frames in the ring are discarded.
+ *  @param Error    Error which stopped the recording
+ */
+static void SDRecorder_Abort(esp_err_t Error)
+{
+    _SDRecorder_State.isRecording = false;
+    FrameProducts_Subscribe(FRAME_CONSUMER_RECORDER, 0);
+
+    if (_SDRecorder_State.File >= 0) {
+        _SDRecorder_State.ChunkFill = 0;
+        _SDRecorder_State.ChunkRecords = 0;
+        SDRecorder_CloseSegment();
+    }
+
+    portENTER_CRITICAL(&_SDRecorder_Lock);
+    _SDRecorder_State.Tail = _SDRecorder_State.Head;
+    _SDRecorder_State.Status.Error = Error;
+    _SDRecorder_State.isStopRequested = false;
+    _SDRecorder_State.isActive = false;
+    portEXIT_CRITICAL(&_SDRecorder_Lock);
+
+    _SDRecorder_State.ReadOffset = 0;
+
+    ESP_LOGE(TAG, "Recording stopped: %d!", Error);
+}
+
+/** @brief          Writer task. Only this task accesses the files, so the Lepton task never waits for the card.
+ *  @param p_Param  Unused
+ */
+static void SDRecorder_Task(void *p_Param)
+{
+    bool isDone;
+    esp_err_t Error;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SD_RECORDER_WAIT_MS));
+
+        if (_SDRecorder_State.isActive == false) {
+            continue;
+        }
+
+        Error = ESP_OK;
+
+        /* New recording */
+        if (_SDRecorder_State.File < 0) {
+            _SDRecorder_State.Header.Segment = 0;
+
+            Error = SDRecorder_CreateDirectory();
+            if (Error == ESP_OK) {
+                Error = SDRecorder_OpenSegment();
+            }
+        }
+
+        if (Error == ESP_OK) {
+            Error = SDRecorder_Drain();
+        }
+
+        if ((Error == ESP_OK) &&
+            ((esp_timer_get_time() - _SDRecorder_State.LastIndex) >=
+             (CONFIG_SD_RECORDER_INDEX_INTERVAL * 1000000LL))) {
+            Error = SDRecorder_WriteIndex();
+        }
+
+        if (Error != ESP_OK) {
+            SDRecorder_Abort(Error);
+            continue;
+        }
+
+        portENTER_CRITICAL(&_SDRecorder_Lock);
+        isDone = _SDRecorder_State.isStopRequested && (_SDRecorder_State.isPushing == false) &&
+                 (_SDRecorder_State.Head == _SDRecorder_State.Tail);
+        portEXIT_CRITICAL(&_SDRecorder_Lock);
+
+        if (isDone) {
+            Error = SDRecorder_CloseSegment();
+
+            portENTER_CRITICAL(&_SDRecorder_Lock);
+            _SDRecorder_State.Status.Error = Error;
+            _SDRecorder_State.isStopRequested = false;
+            _SDRecorder_State.isActive = false;
+            portEXIT_CRITICAL(&_SDRecorder_Lock);
+
+            ESP_LOGI(TAG, "Recording %u stopped: %u frames, %u dropped", _SDRecorder_State.Header.Recording,
+                     static_cast<unsigned int>(_SDRecorder_State.Status.Frames),
+                     static_cast<unsigned int>(_SDRecorder_State.Status.Dropped));
+        }
+    }
+}
+
+esp_err_t SDRecorder_Init(uint16_t Width, uint16_t Height)
+{
+    if (_SDRecorder_State.isInitialized) {
+        ESP_LOGW(TAG, "Already initialized");
+        return ESP_OK;
+    }
+
+    if ((Width == 0) || (Height == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(&_SDRecorder_State, 0, sizeof(_SDRecorder_State));
+
+    _SDRecorder_State.Width = Width;
+    _SDRecorder_State.Height = Height;
+    _SDRecorder_State.Slots = CONFIG_SD_RECORDER_RING_FRAMES;
+    _SDRecorder_State.File = -1;
+    _SDRecorder_State.IndexFile = -1;
+
+    /* Pad the records to whole sectors, so every write starts at a sector boundary */
+    _SDRecorder_State.RecordSize = sizeof(SDRecorder_Frame_Header_t) + (Width * Height * sizeof(uint16_t));
+    _SDRecorder_State.RecordSize = ((_SDRecorder_State.RecordSize + SD_RECORDER_SECTOR_SIZE - 1) /
+                                    SD_RECORDER_SECTOR_SIZE) * SD_RECORDER_SECTOR_SIZE;
+
+    if (_SDRecorder_State.Slots == 0) {
+        _SDRecorder_State.isInitialized = true;
+
+        ESP_LOGI(TAG, "SD recorder disabled");
+
+        return ESP_OK;
+    }
+
+    _SDRecorder_State.Ring = reinterpret_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME, _SDRecorder_State.Slots *
+                                                                          _SDRecorder_State.RecordSize,
+                                                                          "sd_recorder_ring"));
+    if (_SDRecorder_State.Ring == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate the ring for %u frames!", _SDRecorder_State.Slots);
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* The padding is zeroed once and never written again */
+    memset(_SDRecorder_State.Ring, 0, _SDRecorder_State.Slots * _SDRecorder_State.RecordSize);
+
+    /* The card driver copies buffers in PSRAM sector by sector, a DMA capable buffer is written in one transfer */
+    _SDRecorder_State.Chunk = reinterpret_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_DMA, SD_RECORDER_CHUNK_SIZE,
+                                                                           "sd_recorder_chunk"));
+    if (_SDRecorder_State.Chunk == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate the write buffer!");
+
+        MemoryPlan_Free(_SDRecorder_State.Ring);
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreatePinnedToCore(SDRecorder_Task, "SD_Recorder", CONFIG_SD_RECORDER_TASK_STACKSIZE, NULL,
+                                CONFIG_SD_RECORDER_TASK_PRIO, &_SDRecorder_State.Task,
+                                CONFIG_SD_RECORDER_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create the writer task!");
+
+        MemoryPlan_Free(_SDRecorder_State.Chunk);
+        MemoryPlan_Free(_SDRecorder_State.Ring);
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    _SDRecorder_State.isInitialized = true;
+
+    ESP_LOGI(TAG, "SD recorder initialized: %u frames with %u bytes", _SDRecorder_State.Slots,
+             static_cast<unsigned int>(_SDRecorder_State.RecordSize));
+
+    return ESP_OK;
+}
+
+void SDRecorder_Deinit(void)
+{
+    if (_SDRecorder_State.isInitialized == false) {
+        return;
+    }
+
+    SDRecorder_Stop();
+
+    /* Wait until the writer has written the remaining frames */
+    while (_SDRecorder_State.isActive) {
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+
+    if (_SDRecorder_State.Task != NULL) {
+        vTaskDelete(_SDRecorder_State.Task);
+        _SDRecorder_State.Task = NULL;
+    }
+
+    if (_SDRecorder_State.Chunk != NULL) {
+        MemoryPlan_Free(_SDRecorder_State.Chunk);
+        _SDRecorder_State.Chunk = NULL;
+    }
+
+    if (_SDRecorder_State.Ring != NULL) {
+        MemoryPlan_Free(_SDRecorder_State.Ring);
+        _SDRecorder_State.Ring = NULL;
+    }
+
+    _SDRecorder_State.isInitialized = false;
+}
+
+esp_err_t SDRecorder_Start(void)
+{
+    esp_err_t Error = ESP_OK;
+
+    if ((_SDRecorder_State.isInitialized == false) || (_SDRecorder_State.Ring == NULL)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (SDManager_isMounted() == false) {
+        ESP_LOGW(TAG, "No SD card mounted!");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    portENTER_CRITICAL(&_SDRecorder_Lock);
+    if (_SDRecorder_State.isActive) {
+        Error = ESP_ERR_INVALID_STATE;
+    } else {
+        memset(&_SDRecorder_State.Status, 0, sizeof(SDRecorder_Status_t));
+        _SDRecorder_State.isActive = true;
+        _SDRecorder_State.isRecording = true;
+    }
+    portEXIT_CRITICAL(&_SDRecorder_Lock);
+
+    if (Error == ESP_OK) {
+        FrameProducts_Subscribe(FRAME_CONSUMER_RECORDER, FRAME_PRODUCT_RAW);
+        xTaskNotifyGive(_SDRecorder_State.Task);
+    }
+
+    return Error;
+}
+
+esp_err_t SDRecorder_Stop(void)
+{
+    esp_err_t Error = ESP_OK;
+
+    portENTER_CRITICAL(&_SDRecorder_Lock);
+    if (_SDRecorder_State.isRecording == false) {
+        Error = ESP_ERR_INVALID_STATE;
+    } else {
+        _SDRecorder_State.isRecording = false;
+        _SDRecorder_State.isStopRequested = true;
+    }
+    portEXIT_CRITICAL(&_SDRecorder_Lock);
+
+    if (Error == ESP_OK) {
+        FrameProducts_Subscribe(FRAME_CONSUMER_RECORDER, 0);
+        xTaskNotifyGive(_SDRecorder_State.Task);
+    }
+
+    return Error;
+}
+
+void SDRecorder_Push(const FramePool_Frame_t *p_Frame)
+{
+    SDRecorder_Frame_Header_t *p_Header;
+    uint32_t Backlog;
+    bool isFull;
+
+    /* Fast path for the common case without a recording */
+    if ((_SDRecorder_State.isRecording == false) || (p_Frame == NULL)) {
+        return;
+    }
+
+    portENTER_CRITICAL(&_SDRecorder_Lock);
+    isFull = (_SDRecorder_State.Head - _SDRecorder_State.Tail) >= _SDRecorder_State.Slots;
+    if ((_SDRecorder_State.isRecording == false) || isFull || (p_Frame->hasRAW == false) ||
+        (p_Frame->Width != _SDRecorder_State.Width) || (p_Frame->Height != _SDRecorder_State.Height)) {
+        if (_SDRecorder_State.isRecording) {
+            _SDRecorder_State.Status.Dropped++;
+        }
+
+        portEXIT_CRITICAL(&_SDRecorder_Lock);
+
+        return;
+    }
+    _SDRecorder_State.isPushing = true;
+    portEXIT_CRITICAL(&_SDRecorder_Lock);
+
+    /* Only the Lepton task writes the slot at Head and the writer never reads it before Head is incremented */
+    p_Header = reinterpret_cast<SDRecorder_Frame_Header_t *>(_SDRecorder_State.Ring +
+                                                             ((_SDRecorder_State.Head % _SDRecorder_State.Slots) *
+                                                              _SDRecorder_State.RecordSize));
+
+    p_Header->Magic = SD_RECORDER_FRAME_MAGIC;
+    p_Header->Sequence = p_Frame->Sequence;
+    p_Header->Timestamp = p_Frame->Timestamp;
+    p_Header->Width = p_Frame->Width;
+    p_Header->Height = p_Frame->Height;
+    p_Header->Repeats = p_Frame->Repeats;
+
+    if (p_Frame->hasTelemetry) {
+        p_Header->FrameCounter = p_Frame->Telemetry.FrameCounter;
+        p_Header->FPA = p_Frame->Telemetry.FPA_Temp;
+        p_Header->Housing = p_Frame->Telemetry.Housing_Temp;
+        p_Header->Flags = SD_RECORDER_FLAG_TELEMETRY;
+    } else {
+        p_Header->FrameCounter = 0;
+        p_Header->FPA = 0;
+        p_Header->Housing = 0;
+        p_Header->Flags = 0;
+    }
+
+    if (p_Frame->Repeats != 0) {
+        p_Header->Flags |= SD_RECORDER_FLAG_FFC;
+    }
+
+    memcpy(p_Header + 1, p_Frame->RAW, p_Frame->Width * p_Frame->Height * sizeof(uint16_t));
+
+    portENTER_CRITICAL(&_SDRecorder_Lock);
+    _SDRecorder_State.Head++;
+    _SDRecorder_State.isPushing = false;
+
+    Backlog = _SDRecorder_State.Head - _SDRecorder_State.Tail;
+    if (Backlog > _SDRecorder_State.Status.MaxBacklog) {
+        _SDRecorder_State.Status.MaxBacklog = Backlog;
+    }
+    portEXIT_CRITICAL(&_SDRecorder_Lock);
+
+    xTaskNotifyGive(_SDRecorder_State.Task);
+}
+
+esp_err_t SDRecorder_GetStatus(SDRecorder_Status_t *p_Status)
+{
+    if (p_Status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&_SDRecorder_Lock);
+    memcpy(p_Status, &_SDRecorder_State.Status, sizeof(SDRecorder_Status_t));
+    p_Status->isActive = _SDRecorder_State.isActive;
+    p_Status->Backlog = _SDRecorder_State.Head - _SDRecorder_State.Tail;
+    p_Status->Capacity = _SDRecorder_State.Slots;
+    portEXIT_CRITICAL(&_SDRecorder_Lock);
+
+    return ESP_OK;
+}
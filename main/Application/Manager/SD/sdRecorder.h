@@ -0,0 +1,91 @@
+/*
+ * sdRecorder.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Continuous RAW14 video recorder for the SD card.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef SDRECORDER_H_
+#define SDRECORDER_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdRecorderFormat.h"
+
+#include "Application/Tasks/Lepton/framePool.h"
+
+/** @brief State of the recorder.
+ */
+typedef struct {
+    bool isActive;                              /**< Recording or writing the remaining frames after a stop. */
+    uint16_t Recording;                         /**< Number of the current or last recording. */
+    uint16_t Segment;                           /**< Current or last segment. */
+    uint32_t Frames;                            /**< Frames written to the card since the start. */
+    uint32_t Backlog;                           /**< Frames in the ring, waiting for the writer. */
+    uint32_t MaxBacklog;                        /**< Largest backlog since the start. */
+    uint32_t Capacity;                          /**< Number of frames in the ring. */
+    uint32_t Dropped;                           /**< Frames dropped since the start, because the ring was full. */
+    uint64_t Bytes;                             /**< Bytes written to the card since the start. */
+    esp_err_t Error;                            /**< Error which stopped the last recording, ESP_OK otherwise. */
+} SDRecorder_Status_t;
+
+/** @brief          Initialize the recorder. The ring is allocated in PSRAM and the writer task is started.
+ *  @param Width    Frame width in pixels
+ *  @param Height   Frame height in pixels
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if a parameter is invalid
+ *                  ESP_ERR_NO_MEM if the buffers or the task can not be allocated
+ */
+esp_err_t SDRecorder_Init(uint16_t Width, uint16_t Height);
+
+/** @brief Deinitialize the recorder. A running recording is stopped and written before.
+ */
+void SDRecorder_Deinit(void);
+
+/** @brief  Start a new recording in the next free /sdcard/RECnnnn directory.
+ *          The files are created by the writer task, errors are reported with SDRecorder_GetStatus.
+ *  @return ESP_OK on success
+ *          ESP_ERR_NOT_SUPPORTED if the recorder is disabled
+ *          ESP_ERR_INVALID_STATE if no card is mounted or a recording is active
+ */
+esp_err_t SDRecorder_Start(void);
+
+/** @brief  Stop the recording. The frames in the ring are written by the writer task before the files are closed.
+ *  @return ESP_OK on success
+ *          ESP_ERR_INVALID_STATE if no recording is running
+ */
+esp_err_t SDRecorder_Stop(void);
+
+/** @brief          Copy a published frame into the ring while a recording is running. Called by the Lepton task for
+ *                  every frame. Never blocks, a frame is dropped and counted when the ring is full.
+ *  @param p_Frame  Pointer to the published frame
+ */
+void SDRecorder_Push(const FramePool_Frame_t *p_Frame);
+
+/** @brief          Get the state of the recorder.
+ *  @param p_Status Pointer to store the state
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if p_Status is NULL
+ */
+esp_err_t SDRecorder_GetStatus(SDRecorder_Status_t *p_Status);
+
+#endif /* SDRECORDER_H_ */
@@ -0,0 +1,101 @@
+/*
+ * sdRecorderFormat.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: File format of the SD card recordings.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef SDRECORDERFORMAT_H_
+#define SDRECORDERFORMAT_H_
+
+#include <stdint.h>
+
+/** @brief Sector size of the SD card. The file header and every record are padded to a multiple of it, so all
+ *         writes are sector aligned.
+ */
+#define SD_RECORDER_SECTOR_SIZE             512
+
+/** @brief Magic of the file header ("PVRV") and the frame header ("PVFR") (little endian).
+ */
+#define SD_RECORDER_FILE_MAGIC              0x56525650
+#define SD_RECORDER_FRAME_MAGIC             0x52465650
+
+/** @brief Version of the file format.
+ */
+#define SD_RECORDER_FILE_VERSION            1
+
+/** @brief Frame header flag: Telemetry fields are valid.
+ */
+#define SD_RECORDER_FLAG_TELEMETRY          (1 << 0)
+
+/** @brief Frame header flag: The camera repeated its frames right before this one (flat field correction). The
+ *         repeats are not recorded, Repeats holds their number.
+ */
+#define SD_RECORDER_FLAG_FFC                (1 << 1)
+
+/** @brief Header in the first sector of a segment file (little endian). The rest of the sector is zero.
+ *         A segment is named /sdcard/RECnnnn/SEGsss.PRV and the records start at offset HeaderSize.
+ *         Frames is updated with every index write, so the valid part of a segment is known after a power loss.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t Magic;                             /**< SD_RECORDER_FILE_MAGIC. */
+    uint16_t Version;                           /**< SD_RECORDER_FILE_VERSION. */
+    uint16_t HeaderSize;                        /**< Size of the file header in bytes. */
+    uint32_t RecordSize;                        /**< Size of one record (frame header, pixels and padding) in bytes. */
+    uint16_t Width;                             /**< Width of the frames in pixels. */
+    uint16_t Height;                            /**< Height of the frames in pixels. */
+    uint16_t Recording;                         /**< Number of the recording. */
+    uint16_t Segment;                           /**< Number of the segment within the recording, starting at 1. */
+    uint32_t Frames;                            /**< Number of complete records in this segment. */
+    uint32_t Dropped;                           /**< Frames dropped since the start of the recording. */
+    int64_t StartTime;                          /**< Wall clock time at StartTimestamp in microseconds since
+                                                     1970-01-01 UTC. 0 if the time was not set. */
+    int64_t StartTimestamp;                     /**< Time since boot in microseconds when the segment was opened.
+                                                     The wall clock time of a frame is
+                                                     StartTime + (Timestamp - StartTimestamp). */
+} SDRecorder_File_Header_t;
+
+/** @brief Header of every record (little endian). The RAW14 pixels (Width * Height * 2 bytes) follow directly,
+ *         the record is zero padded to RecordSize. Every record holds the complete frame, there are no delta
+ *         records, so record n starts at HeaderSize + n * RecordSize and can be read without the records before it.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t Magic;                             /**< SD_RECORDER_FRAME_MAGIC. */
+    uint32_t Sequence;                          /**< Frame pool sequence number. */
+    int64_t Timestamp;                          /**< Capture time in microseconds since boot. */
+    uint32_t FrameCounter;                      /**< Frame counter of the telemetry line. */
+    uint16_t FPA;                               /**< FPA temperature of the telemetry line in centi-Kelvin. */
+    uint16_t Housing;                           /**< Housing temperature of the telemetry line in centi-Kelvin. */
+    uint16_t Width;                             /**< Width of the frame in pixels. */
+    uint16_t Height;                            /**< Height of the frame in pixels. */
+    uint16_t Flags;                             /**< SD_RECORDER_FLAG_*. */
+    uint16_t Repeats;                           /**< Dropped repeated frames before this one, 0 without
+                                                     SD_RECORDER_FLAG_FFC. */
+} SDRecorder_Frame_Header_t;
+
+/** @brief Entry of the index file /sdcard/RECnnnn/SEGsss.IDX (little endian). Entry n belongs to record n of the
+ *         segment, so a frame can be found by its sequence number or its time without reading the records.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t Sequence;                          /**< Frame pool sequence number. */
+    uint32_t Dropped;                           /**< Frames dropped since the start of the recording. */
+    int64_t Timestamp;                          /**< Capture time in microseconds since boot. */
+} SDRecorder_Index_Entry_t;
+
+#endif /* SDRECORDERFORMAT_H_ */
@@ -0,0 +1,410 @@
+/*
+ * sdSnapshot.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Radiometric snapshot container for the SD card.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <esp_rom_crc.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "sdSnapshot.h"
+#include "sdManager.h"
+
+#include "Application/Manager/Network/Server/ImageEncoder/rawCodec.h"
+#include "Application/Tasks/Lepton/frameProducts.h"
+#include "Application/Trace/trace.h"
+
+/** @brief Sector size of the SD card. The file is padded to a multiple of it, so the single write covers whole
+ *         sectors only.
+ */
+#define SD_SNAPSHOT_SECTOR_SIZE         512
+
+/** @brief Highest snapshot number (IMGnnnnn).
+ */
+#define SD_SNAPSHOT_MAX_NUMBER          99999
+
+/** @brief Round up to the chunk alignment.
+ */
+#define SD_SNAPSHOT_ALIGN(x)            (((x) + 3) & ~static_cast<size_t>(3))
+
+static_assert(sizeof(SDSnapshot_Header_t) <= SD_SNAPSHOT_HEADER_SIZE, "Snapshot header does not fit the sector!");
+
+/* Number of the next snapshot. Only a hint, the file is created exclusively, so two writers never share a number */
+static uint32_t _SDSnapshot_Next = 1;
+static portMUX_TYPE _SDSnapshot_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *TAG = "sd-snapshot";
+
+/** @brief              Add the entry of a chunk that is already in the file buffer to the chunk index.
+ *  @param p_Buffer     Pointer to the file buffer. The header is at offset 0
+ *  @param p_Offset     Pointer to the position of the chunk, advanced by the aligned chunk length
+ *  @param Type         SD_SNAPSHOT_CHUNK_*
+ *  @param Length       Length of the chunk data in bytes
+ */
+static void SDSnapshot_IndexChunk(uint8_t *p_Buffer, size_t *p_Offset, uint32_t Type, size_t Length)
+{
+    SDSnapshot_Header_t *p_Header = reinterpret_cast<SDSnapshot_Header_t *>(p_Buffer);
+    SDSnapshot_Chunk_t *p_Chunk = &p_Header->Chunks[p_Header->ChunkCount];
+
+    p_Chunk->Type = Type;
+    p_Chunk->Offset = *p_Offset;
+    p_Chunk->Length = Length;
+    p_Chunk->CRC = esp_rom_crc32_le(0, p_Buffer + *p_Offset, Length);
+
+    p_Header->ChunkCount++;
+    *p_Offset += SD_SNAPSHOT_ALIGN(Length);
+}
+
+/** @brief              Append a chunk to the file buffer and its entry to the chunk index.
+ *  @param p_Buffer     Pointer to the file buffer. The header is at offset 0
+ *  @param p_Offset     Pointer to the write position, advanced by the aligned chunk length
+ *  @param Type         SD_SNAPSHOT_CHUNK_*
+ *  @param p_Data       Pointer to the chunk data
+ *  @param Length       Length of the chunk data in bytes
+ */
+static void SDSnapshot_AddChunk(uint8_t *p_Buffer, size_t *p_Offset, uint32_t Type, const void *p_Data,
+                                size_t Length)
+{
+    memcpy(p_Buffer + *p_Offset, p_Data, Length);
+
+    SDSnapshot_IndexChunk(p_Buffer, p_Offset, Type, Length);
+}
+
+/** @brief              Create the next free snapshot file.
+ *  @param p_Path       Pointer to store the path
+ *  @param PathSize     Size of the path buffer
+ *  @return             File descriptor or -1 on error
+ */
+static int SDSnapshot_Create(char *p_Path, size_t PathSize)
+{
+    struct stat Info;
+    uint32_t Number;
+    int File;
+
+    snprintf(p_Path, PathSize, "%s/SNAP", SD_MOUNT_POINT);
+    if ((stat(p_Path, &Info) != 0) && (mkdir(p_Path, 0775) != 0)) {
+        ESP_LOGE(TAG, "Failed to create %s!", p_Path);
+        return -1;
+    }
+
+    portENTER_CRITICAL(&_SDSnapshot_Lock);
+    Number = _SDSnapshot_Next;
+    portEXIT_CRITICAL(&_SDSnapshot_Lock);
+
+    /* Numbers used by earlier sessions or another card are skipped with a single failed open each */
+    for (; Number <= SD_SNAPSHOT_MAX_NUMBER; Number++) {
+        snprintf(p_Path, PathSize, "%s/SNAP/IMG%05u.PVS", SD_MOUNT_POINT, static_cast<unsigned int>(Number));
+
+        File = open(p_Path, O_WRONLY | O_CREAT | O_EXCL, 0664);
+        if (File >= 0) {
+            portENTER_CRITICAL(&_SDSnapshot_Lock);
+            _SDSnapshot_Next = Number + 1;
+            portEXIT_CRITICAL(&_SDSnapshot_Lock);
+
+            return File;
+        } else if (errno != EEXIST) {
+            ESP_LOGE(TAG, "Failed to create %s!", p_Path);
+            return -1;
+        }
+    }
+
+    ESP_LOGE(TAG, "No free snapshot number!");
+
+    return -1;
+}
+
+size_t SDSnapshot_GetMaxSize(uint16_t Width, uint16_t Height, size_t PreviewSize)
+{
+    size_t Size;
+
+    Size = SD_SNAPSHOT_HEADER_SIZE + SD_SNAPSHOT_ALIGN(PreviewSize) + SD_SNAPSHOT_ALIGN(sizeof(SDSnapshot_Flux_t)) +
+           (ROI_ENGINE_MAX_ROIS * sizeof(SDSnapshot_ROI_t)) + (Width * Height * sizeof(uint16_t));
+
+    return (Size + SD_SNAPSHOT_SECTOR_SIZE - 1) & ~static_cast<size_t>(SD_SNAPSHOT_SECTOR_SIZE - 1);
+}
+
+size_t SDSnapshot_Build(const FramePool_Frame_t *p_Frame, const Lepton_FluxLinearParams_t *p_Flux,
+                        const uint8_t *p_Preview, size_t PreviewSize, bool isCompressed, uint8_t *p_Buffer,
+                        size_t Size)
+{
+    SDSnapshot_Header_t *p_Header;
+    SDSnapshot_ROI_t ROIs[ROI_ENGINE_MAX_ROIS];
+    size_t RAWSize;
+    size_t Offset;
+
+    if ((p_Frame == NULL) || (p_Frame->hasRAW == false) || (p_Buffer == NULL) ||
+        ((p_Preview == NULL) && (PreviewSize > 0)) ||
+        (Size < SDSnapshot_GetMaxSize(p_Frame->Width, p_Frame->Height, PreviewSize))) {
+        return 0;
+    }
+
+    /* Best effort, a snapshot without statistics or ROI results is still usable */
+    FrameProducts_Require(p_Frame, FRAME_PRODUCT_STATISTICS | FRAME_PRODUCT_ROI);
+
+    RAWSize = p_Frame->Width * p_Frame->Height * sizeof(uint16_t);
+
+    p_Header = reinterpret_cast<SDSnapshot_Header_t *>(p_Buffer);
+    p_Header->Magic = SD_SNAPSHOT_MAGIC;
+    p_Header->Version = SD_SNAPSHOT_VERSION;
+    p_Header->HeaderSize = SD_SNAPSHOT_HEADER_SIZE;
+    p_Header->Width = p_Frame->Width;
+    p_Header->Height = p_Frame->Height;
+    p_Header->Sequence = p_Frame->Sequence;
+    p_Header->Timestamp = p_Frame->Timestamp;
+    p_Header->Time = p_Frame->Time;
+    p_Header->Min = p_Frame->Min;
+    p_Header->Max = p_Frame->Max;
+
+    if (p_Frame->hasTelemetry) {
+        p_Header->FrameCounter = p_Frame->Telemetry.FrameCounter;
+        p_Header->FPA = p_Frame->Telemetry.FPA_Temp;
+        p_Header->Housing = p_Frame->Telemetry.Housing_Temp;
+        p_Header->Flags |= SD_SNAPSHOT_FLAG_TELEMETRY;
+    }
+
+    /* The preview comes first, so a thumbnail is read with the header and a few KB from the start of the file */
+    Offset = SD_SNAPSHOT_HEADER_SIZE;
+
+    if (PreviewSize > 0) {
+        SDSnapshot_AddChunk(p_Buffer, &Offset, SD_SNAPSHOT_CHUNK_PREVIEW, p_Preview, PreviewSize);
+    }
+
+    if (p_Flux != NULL) {
+        SDSnapshot_Flux_t Flux;
+
+        Flux.SceneEmissivity = p_Flux->SceneEmissivity;
+        Flux.TBkgK = p_Flux->TBkgK;
+        Flux.TauWindow = p_Flux->TauWindow;
+        Flux.TWindowK = p_Flux->TWindowK;
+        Flux.TauAtm = p_Flux->TauAtm;
+        Flux.TAtmK = p_Flux->TAtmK;
+        Flux.ReflWindow = p_Flux->ReflWindow;
+        Flux.TReflK = p_Flux->TReflK;
+
+        SDSnapshot_AddChunk(p_Buffer, &Offset, SD_SNAPSHOT_CHUNK_FLUX, &Flux, sizeof(Flux));
+    }
+
+    memset(ROIs, 0, sizeof(ROIs));
+    for (uint8_t i = 0; (i < ROI_ENGINE_MAX_ROIS) && p_Frame->hasROI; i++) {
+        ROIs[i].isValid = p_Frame->ROI[i].isValid ? 1 : 0;
+        ROIs[i].Pixels = p_Frame->ROI[i].Pixels;
+        ROIs[i].Min = p_Frame->ROI[i].Min;
+        ROIs[i].Max = p_Frame->ROI[i].Max;
+        ROIs[i].Mean = p_Frame->ROI[i].Mean;
+        ROIs[i].StdDev = p_Frame->ROI[i].StdDev;
+    }
+
+    SDSnapshot_AddChunk(p_Buffer, &Offset, SD_SNAPSHOT_CHUNK_ROI, ROIs, sizeof(ROIs));
+
+    /* The codec writes into the space of the RAW chunk and gives up when it does not save anything */
+    if (isCompressed) {
+        size_t Length = RawCodec_Encode(p_Frame->RAW, NULL, p_Frame->Width, p_Frame->Height, p_Buffer + Offset,
+                                        RAWSize - 1);
+
+        if (Length > 0) {
+            SDSnapshot_IndexChunk(p_Buffer, &Offset, SD_SNAPSHOT_CHUNK_RICE, Length);
+            p_Header->FileSize = Offset;
+
+            return Offset;
+        }
+    }
+
+    SDSnapshot_AddChunk(p_Buffer, &Offset, SD_SNAPSHOT_CHUNK_RAW, p_Frame->RAW, RAWSize);
+    p_Header->FileSize = Offset;
+
+    return Offset;
+}
+
+esp_err_t SDSnapshot_Save(const uint8_t *p_Snapshot, size_t Length, char *p_Path, size_t PathSize)
+{
+    char Path[SD_SNAPSHOT_PATH_MAX];
+    size_t FileSize;
+    ssize_t Written;
+    int File;
+
+    if ((p_Snapshot == NULL) || (Length == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (SDManager_isMounted() == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    File = SDSnapshot_Create(Path, sizeof(Path));
+    if (File < 0) {
+        return ESP_FAIL;
+    }
+
+    /* One write for the whole file, so the FAT is updated once and the card sees a single sequential transfer */
+    FileSize = (Length + SD_SNAPSHOT_SECTOR_SIZE - 1) & ~static_cast<size_t>(SD_SNAPSHOT_SECTOR_SIZE - 1);
+    TRACE_BEGIN(TRACE_EVENT_SD_WRITE);
+    Written = write(File, p_Snapshot, FileSize);
+    TRACE_END(TRACE_EVENT_SD_WRITE);
+
+    if ((Written != static_cast<ssize_t>(FileSize)) || (fsync(File) != 0)) {
+        ESP_LOGE(TAG, "Failed to write %s!", Path);
+
+        close(File);
+        unlink(Path);
+
+        return ESP_FAIL;
+    }
+
+    close(File);
+
+    ESP_LOGI(TAG, "Frame %u saved to %s (%u bytes)",
+             static_cast<unsigned int>(reinterpret_cast<const SDSnapshot_Header_t *>(p_Snapshot)->Sequence), Path,
+             static_cast<unsigned int>(FileSize));
+
+    if (p_Path != NULL) {
+        snprintf(p_Path, PathSize, "%s", Path);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t SDSnapshot_Write(const FramePool_Frame_t *p_Frame, const Lepton_FluxLinearParams_t *p_Flux,
+                           const uint8_t *p_Preview, size_t PreviewSize, char *p_Path, size_t PathSize)
+{
+    uint8_t *p_Buffer;
+    size_t Size;
+    size_t Length;
+    esp_err_t Error;
+
+    if ((p_Frame == NULL) || (p_Frame->hasRAW == false) || ((p_Preview == NULL) && (PreviewSize > 0))) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (SDManager_isMounted() == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    Size = SDSnapshot_GetMaxSize(p_Frame->Width, p_Frame->Height, PreviewSize);
+    p_Buffer = reinterpret_cast<uint8_t *>(heap_caps_calloc(1, Size, MALLOC_CAP_SPIRAM));
+    if (p_Buffer == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %u bytes!", static_cast<unsigned int>(Size));
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* The card has the space, the RAW14 data is stored uncompressed for the readers of the RAW chunk */
+    Length = SDSnapshot_Build(p_Frame, p_Flux, p_Preview, PreviewSize, false, p_Buffer, Size);
+    Error = SDSnapshot_Save(p_Buffer, Length, p_Path, PathSize);
+
+    heap_caps_free(p_Buffer);
+
+    return Error;
+}
+
+esp_err_t SDSnapshot_ReadHeader(const char *p_Path, SDSnapshot_Header_t *p_Header)
+{
+    ssize_t Read;
+    int File;
+
+    if ((p_Path == NULL) || (p_Header == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    File = open(p_Path, O_RDONLY);
+    if (File < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    Read = read(File, p_Header, sizeof(SDSnapshot_Header_t));
+    close(File);
+
+    if (Read != sizeof(SDSnapshot_Header_t)) {
+        ESP_LOGE(TAG, "Failed to read %s!", p_Path);
+        return ESP_FAIL;
+    }
+
+    if ((p_Header->Magic != SD_SNAPSHOT_MAGIC) || (p_Header->Version != SD_SNAPSHOT_VERSION) ||
+        (p_Header->HeaderSize != SD_SNAPSHOT_HEADER_SIZE) || (p_Header->ChunkCount > SD_SNAPSHOT_MAX_CHUNKS)) {
+        ESP_LOGW(TAG, "%s is no supported snapshot!", p_Path);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    return ESP_OK;
+}
+
+const SDSnapshot_Chunk_t *SDSnapshot_FindChunk(const SDSnapshot_Header_t *p_Header, uint32_t Type)
+{
+    if (p_Header == NULL) {
+        return NULL;
+    }
+
+    for (uint16_t i = 0; (i < p_Header->ChunkCount) && (i < SD_SNAPSHOT_MAX_CHUNKS); i++) {
+        if (p_Header->Chunks[i].Type == Type) {
+            return &p_Header->Chunks[i];
+        }
+    }
+
+    return NULL;
+}
+
+esp_err_t SDSnapshot_ReadChunk(const char *p_Path, const SDSnapshot_Header_t *p_Header, uint32_t Type,
+                               void *p_Buffer, size_t Size, size_t *p_Length)
+{
+    const SDSnapshot_Chunk_t *p_Chunk;
+    ssize_t Read;
+    int File;
+
+    if ((p_Path == NULL) || (p_Header == NULL) || (p_Buffer == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    p_Chunk = SDSnapshot_FindChunk(p_Header, Type);
+    if (p_Chunk == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (p_Length != NULL) {
+        *p_Length = p_Chunk->Length;
+    }
+
+    if (p_Chunk->Length > Size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    File = open(p_Path, O_RDONLY);
+    if (File < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    Read = pread(File, p_Buffer, p_Chunk->Length, p_Chunk->Offset);
+    close(File);
+
+    if (Read != static_cast<ssize_t>(p_Chunk->Length)) {
+        ESP_LOGE(TAG, "Failed to read %s!", p_Path);
+        return ESP_FAIL;
+    }
+
+    if (esp_rom_crc32_le(0, reinterpret_cast<const uint8_t *>(p_Buffer), p_Chunk->Length) != p_Chunk->CRC) {
+        ESP_LOGW(TAG, "CRC error in chunk 0x%08X of %s!", static_cast<unsigned int>(Type), p_Path);
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    return ESP_OK;
+}
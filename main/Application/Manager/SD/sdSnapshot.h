@@ -0,0 +1,223 @@
+/*
+ * sdSnapshot.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Radiometric snapshot container for the SD card.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef SDSNAPSHOT_H_
+#define SDSNAPSHOT_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "lepton.h"
+#include "Application/Tasks/Lepton/framePool.h"
+
+/** @brief Size of the fixed header of a snapshot. The header with the chunk index fills the first sector, so a
+ *         reader gets everything it needs to locate the chunks with a single 512 byte read.
+ */
+#define SD_SNAPSHOT_HEADER_SIZE             512
+
+/** @brief Magic of the file header ("PVSN") (little endian).
+ */
+#define SD_SNAPSHOT_MAGIC                   0x4E535650
+
+/** @brief Version of the file format.
+ */
+#define SD_SNAPSHOT_VERSION                 1
+
+/** @brief Maximum number of chunks in the chunk index.
+ */
+#define SD_SNAPSHOT_MAX_CHUNKS              8
+
+/** @brief Maximum length of a snapshot path (/sdcard/SNAP/IMGnnnnn.PVS).
+ */
+#define SD_SNAPSHOT_PATH_MAX                32
+
+/** @brief Chunk types (FourCC, little endian).
+ *         PREV: JPEG preview, written first so a thumbnail is read from the start of the file.
+ *         FLUX: SDSnapshot_Flux_t with the radiometric parameters of the camera.
+ *         ROIS: ROI_ENGINE_MAX_ROIS SDSnapshot_ROI_t, indexed like the ROI engine slots.
+ *         RAW : Width * Height RAW14 pixels, 16 bit little endian.
+ *         RICE: RAW14 pixels coded by RawCodec_Encode without a reference (see the RAW format of Websocket.md).
+ *               Replaces the RAW chunk in compressed snapshots.
+ */
+#define SD_SNAPSHOT_CHUNK_PREVIEW           0x56455250
+#define SD_SNAPSHOT_CHUNK_FLUX              0x58554C46
+#define SD_SNAPSHOT_CHUNK_ROI               0x53494F52
+#define SD_SNAPSHOT_CHUNK_RAW               0x20574152
+#define SD_SNAPSHOT_CHUNK_RICE              0x45434952
+
+/** @brief Header flags.
+ */
+#define SD_SNAPSHOT_FLAG_TELEMETRY          (1 << 0)    /**< FrameCounter, FPA and Housing are valid. */
+
+/** @brief Entry of the chunk index. Every chunk starts on a 4 byte boundary.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t Type;                              /**< SD_SNAPSHOT_CHUNK_*. */
+    uint32_t Offset;                            /**< Offset of the chunk from the start of the file in bytes. */
+    uint32_t Length;                            /**< Length of the chunk in bytes. */
+    uint32_t CRC;                               /**< CRC-32 (IEEE 802.3, as zlib) of the chunk data. */
+} SDSnapshot_Chunk_t;
+
+/** @brief Fixed header at offset 0 of a snapshot file (little endian). The rest of the first sector is zero.
+ *         A snapshot is named /sdcard/SNAP/IMGnnnnn.PVS.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t Magic;                             /**< SD_SNAPSHOT_MAGIC. */
+    uint16_t Version;                           /**< SD_SNAPSHOT_VERSION. */
+    uint16_t HeaderSize;                        /**< SD_SNAPSHOT_HEADER_SIZE. */
+    uint32_t FileSize;                          /**< Size of the file without the padding of the last sector. */
+    uint16_t Width;                             /**< Width of the frame in pixels. */
+    uint16_t Height;                            /**< Height of the frame in pixels. */
+    uint32_t Sequence;                          /**< Frame pool sequence number. */
+    int64_t Timestamp;                          /**< Capture time in microseconds since boot. */
+    int64_t Time;                               /**< Wall clock time of the capture in microseconds since
+                                                     1970-01-01 UTC. 0 if the time was not set. */
+    uint32_t FrameCounter;                      /**< Frame counter of the telemetry line. */
+    uint16_t FPA;                               /**< FPA temperature of the telemetry line in centi-Kelvin. */
+    uint16_t Housing;                           /**< Housing temperature of the telemetry line in centi-Kelvin. */
+    int16_t Min;                                /**< Minimum temperature of the frame in centi-Kelvin. */
+    int16_t Max;                                /**< Maximum temperature of the frame in centi-Kelvin. */
+    uint16_t Flags;                             /**< SD_SNAPSHOT_FLAG_*. */
+    uint16_t ChunkCount;                        /**< Number of valid entries in Chunks. */
+    SDSnapshot_Chunk_t Chunks[SD_SNAPSHOT_MAX_CHUNKS];
+} SDSnapshot_Header_t;
+
+/** @brief Content of the FLUX chunk. The values are copied unchanged from Lepton_FluxLinearParams_t
+ *         (emissivity and transmissions scaled by 8192, temperatures in Kelvin * 100).
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t SceneEmissivity;
+    uint16_t TBkgK;
+    uint16_t TauWindow;
+    uint16_t TWindowK;
+    uint16_t TauAtm;
+    uint16_t TAtmK;
+    uint16_t ReflWindow;
+    uint16_t TReflK;
+} SDSnapshot_Flux_t;
+
+/** @brief Entry of the ROIS chunk.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t isValid;                            /**< 1 when the ROI is active and contains at least one pixel. */
+    uint8_t Reserved[3];
+    uint32_t Pixels;                            /**< Number of pixels inside the ROI. */
+    float Min;                                  /**< Minimum temperature in Degree Celsius. */
+    float Max;                                  /**< Maximum temperature in Degree Celsius. */
+    float Mean;                                 /**< Mean temperature in Degree Celsius. */
+    float StdDev;                               /**< Standard deviation in Kelvin. */
+} SDSnapshot_ROI_t;
+
+/** @brief              Get the buffer size for SDSnapshot_Build.
+ *  @param Width        Width of the frame in pixels
+ *  @param Height       Height of the frame in pixels
+ *  @param PreviewSize  Size of the JPEG preview in bytes
+ *  @return             Size of the snapshot without compression, padded to whole sectors of the SD card
+ */
+size_t SDSnapshot_GetMaxSize(uint16_t Width, uint16_t Height, size_t PreviewSize);
+
+/** @brief              Assemble the snapshot of a frame in a buffer.
+ *  @param p_Frame      Pointer to the frame with RAW14 data
+ *  @param p_Flux       Pointer to the radiometric parameters of the camera. NULL to omit the FLUX chunk
+ *  @param p_Preview    Pointer to the JPEG preview. NULL to omit the PREV chunk
+ *  @param PreviewSize  Size of the JPEG preview in bytes
+ *  @param isCompressed true to store the RAW14 data as RICE chunk. A frame that does not get smaller is stored
+ *                      as RAW chunk
+ *  @param p_Buffer     Pointer to the buffer. The first sector must be zero
+ *  @param Size         Size of the buffer (SDSnapshot_GetMaxSize)
+ *  @return             Length of the snapshot or 0 if the frame has no RAW14 data or the buffer is too small
+ */
+size_t SDSnapshot_Build(const FramePool_Frame_t *p_Frame, const Lepton_FluxLinearParams_t *p_Flux,
+                        const uint8_t *p_Preview, size_t PreviewSize, bool isCompressed, uint8_t *p_Buffer,
+                        size_t Size);
+
+/** @brief              Write an assembled snapshot to the next free /sdcard/SNAP/IMGnnnnn.PVS.
+ *  @param p_Snapshot   Pointer to the snapshot of SDSnapshot_Build. The file is padded to whole sectors of the
+ *                      card, so the buffer must be readable up to the next multiple of 512 bytes
+ *  @param Length       Length of the snapshot in bytes
+ *  @param p_Path       Pointer to store the path of the file. Can be NULL
+ *  @param PathSize     Size of the path buffer (SD_SNAPSHOT_PATH_MAX)
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if the snapshot is NULL or empty
+ *                      ESP_ERR_INVALID_STATE if no card is mounted
+ *                      ESP_FAIL if the file can not be written
+ */
+esp_err_t SDSnapshot_Save(const uint8_t *p_Snapshot, size_t Length, char *p_Path, size_t PathSize);
+
+/** @brief              Write a snapshot of a frame to the next free /sdcard/SNAP/IMGnnnnn.PVS.
+ *                      The file is assembled in PSRAM and written with a single write call.
+ *  @param p_Frame      Pointer to the frame with RAW14 data
+ *  @param p_Flux       Pointer to the radiometric parameters of the camera. NULL to omit the FLUX chunk
+ *  @param p_Preview    Pointer to the JPEG preview. NULL to omit the PREV chunk
+ *  @param PreviewSize  Size of the JPEG preview in bytes
+ *  @param p_Path       Pointer to store the path of the file. Can be NULL
+ *  @param PathSize     Size of the path buffer (SD_SNAPSHOT_PATH_MAX)
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if the frame has no RAW14 data
+ *                      ESP_ERR_INVALID_STATE if no card is mounted
+ *                      ESP_ERR_NO_MEM if the file buffer can not be allocated
+ *                      ESP_FAIL if the file can not be written
+ */
+esp_err_t SDSnapshot_Write(const FramePool_Frame_t *p_Frame, const Lepton_FluxLinearParams_t *p_Flux,
+                           const uint8_t *p_Preview, size_t PreviewSize, char *p_Path, size_t PathSize);
+
+/** @brief              Read and check the header of a snapshot. Only the first sector of the file is read.
+ *  @param p_Path       Path of the snapshot
+ *  @param p_Header     Pointer to store the header
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if a parameter is NULL
+ *                      ESP_ERR_NOT_FOUND if the file can not be opened
+ *                      ESP_ERR_INVALID_VERSION if the file is no snapshot or has an unknown version
+ *                      ESP_FAIL if the file can not be read
+ */
+esp_err_t SDSnapshot_ReadHeader(const char *p_Path, SDSnapshot_Header_t *p_Header);
+
+/** @brief              Find a chunk in the chunk index of a header.
+ *  @param p_Header     Pointer to the header from SDSnapshot_ReadHeader
+ *  @param Type         SD_SNAPSHOT_CHUNK_*
+ *  @return             Pointer to the index entry or NULL if the snapshot has no such chunk
+ */
+const SDSnapshot_Chunk_t *SDSnapshot_FindChunk(const SDSnapshot_Header_t *p_Header, uint32_t Type);
+
+/** @brief              Read a single chunk of a snapshot and check its CRC. Only the chunk is read from the file,
+ *                      so a preview is loaded without touching the RAW14 data.
+ *  @param p_Path       Path of the snapshot
+ *  @param p_Header     Pointer to the header from SDSnapshot_ReadHeader
+ *  @param Type         SD_SNAPSHOT_CHUNK_*
+ *  @param p_Buffer     Pointer to the buffer for the chunk data
+ *  @param Size         Size of the buffer in bytes
+ *  @param p_Length     Pointer to store the length of the chunk. Can be NULL
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if a parameter is NULL
+ *                      ESP_ERR_NOT_FOUND if the file can not be opened or the snapshot has no such chunk
+ *                      ESP_ERR_INVALID_SIZE if the buffer is too small, p_Length contains the required size
+ *                      ESP_ERR_INVALID_CRC if the chunk is corrupted
+ *                      ESP_FAIL if the file can not be read
+ */
+esp_err_t SDSnapshot_ReadChunk(const char *p_Path, const SDSnapshot_Header_t *p_Header, uint32_t Type,
+                               void *p_Buffer, size_t Size, size_t *p_Length);
+
+#endif /* SDSNAPSHOT_H_ */
@@ -0,0 +1,461 @@
+/*
+ * sdTimeLapse.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Interval capture to the SD card with deep sleep between the shots.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <esp_attr.h>
+#include <driver/rtc_io.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "sdTimeLapse.h"
+#include "sdManager.h"
+#include "sdRecorder.h"
+#include "sdSnapshot.h"
+#include "Application/Tasks/Lepton/leptonTask.h"
+#include "Application/Tasks/Lepton/frameProducts.h"
+#include "Application/Manager/Devices/devicesManager.h"
+#include "Application/Manager/Devices/RTC/rtc.h"
+#include "Application/Manager/Time/timeManager.h"
+#include "Application/Topology/topology.h"
+
+/** @brief Magic of the schedule in the RTC memory. The RTC memory is cleared by a power on only.
+ */
+#define SD_TIMELAPSE_MAGIC                  0x534C5450
+
+/** @brief Delay between SDTimeLapse_Start and the deep sleep, so the response of the command is sent.
+ */
+#define SD_TIMELAPSE_START_DELAY_MS         1000
+
+/** @brief The shots are never closer than this to the wake up, a shot that is due earlier is skipped.
+ */
+#define SD_TIMELAPSE_MIN_SLEEP_S            5
+
+/** @brief The timer of the S3 wakes the device this long after a missed RTC alarm.
+ */
+#define SD_TIMELAPSE_BACKUP_WAKEUP_S        60
+
+typedef struct {
+    uint32_t Magic;                             /**< SD_TIMELAPSE_MAGIC while a schedule is active. */
+    uint16_t Interval;
+    uint32_t Count;
+    uint32_t Shots;
+    int64_t Next;                               /**< Time of the next shot in seconds of the RTC clock. */
+    uint32_t WakeToCapture;                     /**< Counted from the start of the application, the boot loader
+                                                     is not included. */
+    uint32_t Awake;
+    int32_t Error;
+} SDTimeLapse_State_t;
+
+/* Survives the deep sleep. Only written by the single task of a start or a wake up */
+static RTC_DATA_ATTR SDTimeLapse_State_t _SDTimeLapse_State;
+
+static const char *TAG = "sd-timelapse";
+
+/** @brief          Convert a calendar time of the RTC into seconds since 1970. The RTC clock is used as it is, so
+ *                  the time zone and the daylight saving time do not move the schedule.
+ *  @param p_Time   Pointer to the calendar time
+ *  @return         Seconds since 1970
+ */
+static int64_t SDTimeLapse_ToSeconds(const struct tm *p_Time)
+{
+    int64_t Year;
+    int64_t Era;
+    int64_t YearOfEra;
+    int64_t DayOfYear;
+    int64_t DayOfEra;
+    int64_t Month;
+
+    /* Days from the civil date, the year starts in March so the leap day is the last day of the year */
+    Month = p_Time->tm_mon + 1;
+    Year = p_Time->tm_year + 1900 - ((Month <= 2) ? 1 : 0);
+    Era = ((Year >= 0) ? Year : (Year - 399)) / 400;
+    YearOfEra = Year - (Era * 400);
+    DayOfYear = (((153 * (Month + ((Month > 2) ? -3 : 9))) + 2) / 5) + p_Time->tm_mday - 1;
+    DayOfEra = (YearOfEra * 365) + (YearOfEra / 4) - (YearOfEra / 100) + DayOfYear;
+
+    return ((((Era * 146097) + DayOfEra - 719468) * 86400) + (p_Time->tm_hour * 3600) + (p_Time->tm_min * 60) +
+            p_Time->tm_sec);
+}
+
+/** @brief              Get the time of the RTC clock.
+ *  @param p_Seconds    Pointer to store the seconds since 1970
+ *  @return             ESP_OK on success
+ */
+static esp_err_t SDTimeLapse_GetRTCSeconds(int64_t *p_Seconds)
+{
+    struct tm Now;
+    esp_err_t Error;
+
+    Error = RTC_GetTime(&Now);
+    if (Error != ESP_OK) {
+        return Error;
+    }
+
+    *p_Seconds = SDTimeLapse_ToSeconds(&Now);
+
+    return ESP_OK;
+}
+
+/** @brief      Program the wake up sources for the next shot and enter the deep sleep. The RTC alarm wakes the
+ *              device through CONFIG_SD_TIMELAPSE_RTC_INT_PIN. Without the pin or when the alarm can not be set,
+ *              the timer of the S3 is used.
+ *  @param Now  Current time of the RTC clock in seconds, -1 if the RTC can not be read
+ */
+static void SDTimeLapse_Sleep(int64_t Now)
+{
+    int64_t Sleep;
+
+    if (_SDTimeLapse_State.Magic != SD_TIMELAPSE_MAGIC) {
+        ESP_LOGI(TAG, "Schedule finished, sleeping until the next reset");
+
+        RTC_EnableAlarmInterrupt(false);
+
+        _SDTimeLapse_State.Awake = esp_timer_get_time() / 1000;
+        esp_deep_sleep_start();
+    }
+
+    if (Now < 0) {
+        /* Without the RTC the interval is only kept approximately */
+        Sleep = static_cast<int64_t>(_SDTimeLapse_State.Interval) * 60;
+    } else {
+        /* Skip the shots that are already due, they are not taken late */
+        while (_SDTimeLapse_State.Next < (Now + SD_TIMELAPSE_MIN_SLEEP_S)) {
+            _SDTimeLapse_State.Next += static_cast<int64_t>(_SDTimeLapse_State.Interval) * 60;
+        }
+
+        Sleep = _SDTimeLapse_State.Next - Now;
+    }
+
+    ESP_LOGI(TAG, "Next shot in %lld s", static_cast<long long>(Sleep));
+
+#if CONFIG_SD_TIMELAPSE_RTC_INT_PIN >= 0
+    if (Now >= 0) {
+        RTC_Alarm_t Alarm;
+        struct tm Next;
+        time_t Time;
+
+        Time = static_cast<time_t>(_SDTimeLapse_State.Next);
+        gmtime_r(&Time, &Next);
+
+        memset(&Alarm, 0, sizeof(Alarm));
+        Alarm.Seconds = Next.tm_sec;
+        Alarm.Minutes = Next.tm_min;
+        Alarm.Hours = Next.tm_hour;
+        Alarm.Day = Next.tm_mday;
+        Alarm.EnableSeconds = true;
+        Alarm.EnableMinutes = true;
+        Alarm.EnableHours = true;
+        Alarm.EnableDay = true;
+
+        /* The INT output of the RTC is open drain and active low */
+        if ((RTC_ClearAlarmFlag() == ESP_OK) && (RTC_SetAlarm(&Alarm) == ESP_OK) &&
+            (RTC_EnableAlarmInterrupt(true) == ESP_OK)) {
+            rtc_gpio_pullup_en(static_cast<gpio_num_t>(CONFIG_SD_TIMELAPSE_RTC_INT_PIN));
+            rtc_gpio_pulldown_dis(static_cast<gpio_num_t>(CONFIG_SD_TIMELAPSE_RTC_INT_PIN));
+            esp_sleep_enable_ext0_wakeup(static_cast<gpio_num_t>(CONFIG_SD_TIMELAPSE_RTC_INT_PIN), 0);
+
+            /* The timer only catches a missed alarm */
+            Sleep += SD_TIMELAPSE_BACKUP_WAKEUP_S;
+        } else {
+            ESP_LOGW(TAG, "Failed to set the RTC alarm, using the timer!");
+        }
+    }
+#endif
+
+    esp_sleep_enable_timer_wakeup(static_cast<uint64_t>(Sleep) * 1000000ULL);
+
+    _SDTimeLapse_State.Awake = esp_timer_get_time() / 1000;
+    esp_deep_sleep_start();
+}
+
+/** @brief          Append the results of a shot to the log of the schedule.
+ *  @param p_Path   Path of the snapshot, empty if the shot failed
+ */
+static void SDTimeLapse_Log(const char *p_Path)
+{
+    FILE *File;
+    time_t Now;
+    int Battery;
+    int Percentage;
+
+    File = fopen(SD_TIMELAPSE_LOG_PATH, "a");
+    if (File == NULL) {
+        ESP_LOGW(TAG, "Failed to open the log!");
+        return;
+    }
+
+    if (DevicesManager_GetBatteryVoltage(&Battery, &Percentage) != ESP_OK) {
+        Battery = 0;
+    }
+
+    time(&Now);
+
+    fprintf(File, "%lu,%lld,%s,%lu,%lu,%d\n", static_cast<unsigned long>(_SDTimeLapse_State.Shots),
+            static_cast<long long>(Now), p_Path, static_cast<unsigned long>(_SDTimeLapse_State.WakeToCapture),
+            static_cast<unsigned long>(_SDTimeLapse_State.Awake), Battery);
+    fclose(File);
+}
+
+/** @brief              Wait for a settled frame of the Lepton task. The first frames after the power up are
+ *                      dropped while the camera runs its flat field correction.
+ *  @param p_AppContext Pointer to the application context
+ *  @return             Frame with a reference or NULL on a timeout
+ */
+static FramePool_Frame_t *SDTimeLapse_WaitFrame(App_Context_t *p_AppContext)
+{
+    App_Lepton_FrameReady_t Event;
+    int64_t Deadline;
+    uint32_t Skip;
+
+    Deadline = esp_timer_get_time() + (CONFIG_SD_TIMELAPSE_TIMEOUT_MS * 1000LL);
+    Skip = CONFIG_SD_TIMELAPSE_SKIP_FRAMES;
+
+    while (esp_timer_get_time() < Deadline) {
+        if (xQueueReceive(p_AppContext->Lepton_FrameEventQueue, &Event, 100 / portTICK_PERIOD_MS) != pdTRUE) {
+            continue;
+        }
+
+        if ((Skip > 0) || (Event.Frame->hasRAW == false)) {
+            if (Skip > 0) {
+                Skip--;
+            }
+
+            FramePool_Release(Event.Frame);
+            continue;
+        }
+
+        return Event.Frame;
+    }
+
+    return NULL;
+}
+
+/** @brief          Start task. Waits until the response of the command is sent and enters the deep sleep.
+ *  @param p_Param  Unused
+ */
+static void SDTimeLapse_StartTask(void *p_Param)
+{
+    int64_t Now;
+
+    (void)p_Param;
+
+    vTaskDelay(SD_TIMELAPSE_START_DELAY_MS / portTICK_PERIOD_MS);
+
+    SDManager_Unmount();
+
+    ESP_LOGI(TAG, "Starting schedule: %u min, %lu shots", _SDTimeLapse_State.Interval,
+             static_cast<unsigned long>(_SDTimeLapse_State.Count));
+
+    if (SDTimeLapse_GetRTCSeconds(&Now) != ESP_OK) {
+        Now = -1;
+    }
+
+    SDTimeLapse_Sleep(Now);
+}
+
+esp_err_t SDTimeLapse_Start(uint16_t Interval, uint32_t Count)
+{
+    SDRecorder_Status_t Recorder;
+    int64_t Now;
+
+    if ((Interval == 0) || (Interval > SD_TIMELAPSE_INTERVAL_MAX)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    SDRecorder_GetStatus(&Recorder);
+    if ((SDManager_isMounted() == false) || Recorder.isActive) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (SDTimeLapse_GetRTCSeconds(&Now) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read the RTC!");
+        return ESP_FAIL;
+    }
+
+    _SDTimeLapse_State.Interval = Interval;
+    _SDTimeLapse_State.Count = Count;
+    _SDTimeLapse_State.Shots = 0;
+    _SDTimeLapse_State.Next = Now + (static_cast<int64_t>(Interval) * 60);
+    _SDTimeLapse_State.WakeToCapture = 0;
+    _SDTimeLapse_State.Awake = 0;
+    _SDTimeLapse_State.Error = ESP_OK;
+    _SDTimeLapse_State.Magic = SD_TIMELAPSE_MAGIC;
+
+    if (Topology_CreateTask(TOPOLOGY_TASK_TIMELAPSE, SDTimeLapse_StartTask, NULL, NULL) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create start task!");
+
+        _SDTimeLapse_State.Magic = 0;
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+bool SDTimeLapse_isWakeup(void)
+{
+    esp_sleep_wakeup_cause_t Cause;
+
+    if (_SDTimeLapse_State.Magic != SD_TIMELAPSE_MAGIC) {
+        return false;
+    }
+
+    Cause = esp_sleep_get_wakeup_cause();
+
+    return (Cause == ESP_SLEEP_WAKEUP_EXT0) || (Cause == ESP_SLEEP_WAKEUP_TIMER);
+}
+
+void SDTimeLapse_Run(App_Context_t *p_AppContext)
+{
+    i2c_master_dev_handle_t RtcHandle = NULL;
+    FramePool_Frame_t *Frame;
+    Lepton_FluxLinearParams_t FluxParams;
+    bool hasFluxParams;
+    char Path[SD_SNAPSHOT_PATH_MAX];
+    int64_t Now;
+    esp_err_t Error;
+
+    ESP_LOGI(TAG, "Shot %lu of the schedule", static_cast<unsigned long>(_SDTimeLapse_State.Shots + 1));
+
+    Path[0] = '\0';
+    Now = -1;
+
+#if CONFIG_SD_TIMELAPSE_RTC_INT_PIN >= 0
+    rtc_gpio_deinit(static_cast<gpio_num_t>(CONFIG_SD_TIMELAPSE_RTC_INT_PIN));
+#endif
+
+    Error = DevicesManager_Init();
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize the devices!");
+        goto SDTimeLapse_Run_Exit;
+    }
+
+    /* Release the INT line of the RTC, the time of the RTC is also the base of the snapshot time */
+    RTC_ClearAlarmFlag();
+    if (SDTimeLapse_GetRTCSeconds(&Now) != ESP_OK) {
+        Now = -1;
+    }
+
+    if (DevicesManager_GetRTCHandle(&RtcHandle) == ESP_OK) {
+        TimeManager_Init(RtcHandle);
+    }
+
+    Error = SDManager_Init();
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "SD card not available!");
+        goto SDTimeLapse_Run_Exit;
+    }
+
+    /* The shot is taken from the frame queue of the GUI, which is not started. Only the products of the snapshot
+       are computed */
+    FrameProducts_Subscribe(FRAME_CONSUMER_DISPLAY, FRAME_PRODUCT_RAW | FRAME_PRODUCT_STATISTICS | FRAME_PRODUCT_ROI);
+
+    Error = Lepton_Task_Init();
+    if (Error == ESP_OK) {
+        Error = Lepton_Task_Start(p_AppContext);
+    }
+
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start the Lepton!");
+        goto SDTimeLapse_Run_Exit;
+    }
+
+    Frame = SDTimeLapse_WaitFrame(p_AppContext);
+    if (Frame == NULL) {
+        ESP_LOGE(TAG, "No frame received!");
+        Error = ESP_ERR_TIMEOUT;
+        goto SDTimeLapse_Run_Exit;
+    }
+
+    _SDTimeLapse_State.WakeToCapture = Frame->Timestamp / 1000;
+
+    /* The preview is skipped, it costs more time than the RAW14 write and is rendered from the RAW14 data later */
+    hasFluxParams = (Lepton_Task_GetFluxParameters(&FluxParams) == ESP_OK);
+    Error = SDSnapshot_Write(Frame, hasFluxParams ? &FluxParams : NULL, NULL, 0, Path, sizeof(Path));
+
+    FramePool_Release(Frame);
+
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write the snapshot: %d!", Error);
+        Path[0] = '\0';
+    } else {
+        ESP_LOGI(TAG, "Saved %s, %lu ms after the wake up", Path,
+                 static_cast<unsigned long>(_SDTimeLapse_State.WakeToCapture));
+    }
+
+SDTimeLapse_Run_Exit:
+    _SDTimeLapse_State.Shots++;
+    _SDTimeLapse_State.Error = Error;
+
+    if (SDManager_isMounted()) {
+        SDTimeLapse_Log(Path);
+    }
+
+    Lepton_Task_Deinit();
+    SDManager_Deinit();
+
+    if ((_SDTimeLapse_State.Count > 0) && (_SDTimeLapse_State.Shots >= _SDTimeLapse_State.Count)) {
+        _SDTimeLapse_State.Magic = 0;
+    }
+
+    SDTimeLapse_Sleep(Now);
+}
+
+void SDTimeLapse_Init(void)
+{
+    if (_SDTimeLapse_State.Magic == SD_TIMELAPSE_MAGIC) {
+        ESP_LOGW(TAG, "Schedule ended by a reset after %lu shots",
+                 static_cast<unsigned long>(_SDTimeLapse_State.Shots));
+
+        _SDTimeLapse_State.Magic = 0;
+    }
+
+    /* A pending alarm would keep the INT line of the RTC low */
+    RTC_EnableAlarmInterrupt(false);
+    RTC_ClearAlarmFlag();
+}
+
+esp_err_t SDTimeLapse_GetStatus(SDTimeLapse_Status_t *p_Status)
+{
+    if (p_Status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    p_Status->isActive = (_SDTimeLapse_State.Magic == SD_TIMELAPSE_MAGIC);
+    p_Status->Interval = _SDTimeLapse_State.Interval;
+    p_Status->Count = _SDTimeLapse_State.Count;
+    p_Status->Shots = _SDTimeLapse_State.Shots;
+    p_Status->WakeToCapture = _SDTimeLapse_State.WakeToCapture;
+    p_Status->Awake = _SDTimeLapse_State.Awake;
+    p_Status->Error = _SDTimeLapse_State.Error;
+
+    return ESP_OK;
+}
@@ -0,0 +1,91 @@
+/*
+ * sdTimeLapse.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Interval capture to the SD card with deep sleep between the shots.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef SDTIMELAPSE_H_
+#define SDTIMELAPSE_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "Application/application.h"
+
+/** @brief Maximum interval between two shots in minutes.
+ */
+#define SD_TIMELAPSE_INTERVAL_MAX           1440
+
+/** @brief Log of a schedule. One line per shot with
+ *         <shot>,<time>,<path>,<wake to capture ms>,<awake ms of the previous shot>,<battery mV>.
+ */
+#define SD_TIMELAPSE_LOG_PATH               "/sdcard/SNAP/TLAPSE.CSV"
+
+/** @brief State of the schedule. Kept in the RTC memory, so it survives the deep sleep and a software reset.
+ */
+typedef struct {
+    bool isActive;                              /**< The device sleeps between the shots of a schedule. */
+    uint16_t Interval;                          /**< Interval between two shots in minutes. */
+    uint32_t Count;                             /**< Number of shots of the schedule, 0 for no limit. */
+    uint32_t Shots;                             /**< Shots taken so far. */
+    uint32_t WakeToCapture;                     /**< Time from the wake up to the capture of the last shot in ms. */
+    uint32_t Awake;                             /**< Time from the wake up to the deep sleep of the last shot in ms. */
+    esp_err_t Error;                            /**< Error of the last shot, ESP_OK otherwise. */
+} SDTimeLapse_Status_t;
+
+/** @brief              Start a schedule. The device enters the deep sleep shortly after the call, so a response
+ *                      can still be sent. Every shot is a snapshot (see SDSnapshot_Write) without a preview.
+ *                      Any boot that is not a wake up of the schedule (reset, power on) ends it.
+ *  @param Interval     Interval between two shots in minutes (1 - SD_TIMELAPSE_INTERVAL_MAX)
+ *  @param Count        Number of shots, 0 for no limit
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if the interval is out of range
+ *                      ESP_ERR_INVALID_STATE if no card is mounted or a recording is running
+ *                      ESP_FAIL if the RTC can not be read
+ *                      ESP_ERR_NO_MEM if the sleep task can not be created
+ */
+esp_err_t SDTimeLapse_Start(uint16_t Interval, uint32_t Count);
+
+/** @brief  Check if the device was woken up for the next shot of a schedule.
+ *  @return true if SDTimeLapse_Run has to be called instead of the normal start
+ */
+bool SDTimeLapse_isWakeup(void);
+
+/** @brief              Take the shot of a wake up and go back to the deep sleep. Only the devices, the time, the
+ *                      SD card and the Lepton are started, the GUI and the network stay off. Never returns.
+ *  @param p_AppContext Pointer to the application context with the frame queue of the Lepton task
+ */
+void SDTimeLapse_Run(App_Context_t *p_AppContext);
+
+/** @brief  End a schedule that was interrupted by a normal boot and disable the alarm of the RTC. The results of
+ *          the last schedule are kept for SDTimeLapse_GetStatus. Requires the RTC of the Devices Manager.
+ */
+void SDTimeLapse_Init(void);
+
+/** @brief          Get the state of the schedule.
+ *  @param p_Status Pointer to store the state
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if p_Status is NULL
+ */
+esp_err_t SDTimeLapse_GetStatus(SDTimeLapse_Status_t *p_Status);
+
+#endif /* SDTIMELAPSE_H_ */
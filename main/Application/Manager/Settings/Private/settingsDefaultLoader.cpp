@@ -25,9 +25,6 @@
 #include <esp_mac.h>
 #include <esp_efuse.h>
 
-#include <nvs_flash.h>
-#include <nvs.h>
-
 #include <string.h>
 
 #include "settingsLoader.h"
@@ -35,91 +32,18 @@
 
 static const char *TAG = "settings_default_loader";
 
-void SettingsManager_InitDefaultLeptonROIs(App_Settings_t *p_Settings)
-{
-    /* Spotmeter defaults */
-    p_Settings->Lepton.ROI[ROI_TYPE_SPOTMETER].Type = ROI_TYPE_SPOTMETER;
-    p_Settings->Lepton.ROI[ROI_TYPE_SPOTMETER].x = 60;
-    p_Settings->Lepton.ROI[ROI_TYPE_SPOTMETER].y = 40;
-    p_Settings->Lepton.ROI[ROI_TYPE_SPOTMETER].w = 40;
-    p_Settings->Lepton.ROI[ROI_TYPE_SPOTMETER].h = 40;
-
-    /* Scene statistics defaults */
-    p_Settings->Lepton.ROI[ROI_TYPE_SCENE].Type = ROI_TYPE_SCENE;
-    p_Settings->Lepton.ROI[ROI_TYPE_SCENE].x = 0;
-    p_Settings->Lepton.ROI[ROI_TYPE_SCENE].y = 0;
-    p_Settings->Lepton.ROI[ROI_TYPE_SCENE].w = 160;
-    p_Settings->Lepton.ROI[ROI_TYPE_SCENE].h = 120;
-
-    /* AGC defaults */
-    p_Settings->Lepton.ROI[ROI_TYPE_AGC].Type = ROI_TYPE_AGC;
-    p_Settings->Lepton.ROI[ROI_TYPE_AGC].x = 0;
-    p_Settings->Lepton.ROI[ROI_TYPE_AGC].y = 0;
-    p_Settings->Lepton.ROI[ROI_TYPE_AGC].w = 160;
-    p_Settings->Lepton.ROI[ROI_TYPE_AGC].h = 120;
-
-    /* Video focus defaults */
-    p_Settings->Lepton.ROI[ROI_TYPE_VIDEO_FOCUS].Type = ROI_TYPE_VIDEO_FOCUS;
-    p_Settings->Lepton.ROI[ROI_TYPE_VIDEO_FOCUS].x = 1;
-    p_Settings->Lepton.ROI[ROI_TYPE_VIDEO_FOCUS].y = 1;
-    p_Settings->Lepton.ROI[ROI_TYPE_VIDEO_FOCUS].w = 157;
-    p_Settings->Lepton.ROI[ROI_TYPE_VIDEO_FOCUS].h = 157;
-}
-
-void SettingsManager_InitDefaultLeptonEmissivityPresets(App_Settings_t *p_Settings)
-{
-    /* No emissiviy values available */
-    p_Settings->Lepton.EmissivityCount = 1;
-    p_Settings->Lepton.EmissivityPresets[0].Value = 100.0f;
-    strncpy(p_Settings->Lepton.EmissivityPresets[0].Description, "Unknown",
-            sizeof(p_Settings->Lepton.EmissivityPresets[0].Description));
-}
-
 void SettingsManager_InitDefaults(SettingsManager_State_t *p_State)
 {
-    memset(&p_State->Settings, 0, sizeof(App_Settings_t));
-
-    SettingsManager_InitDefaultDisplay(&p_State->Settings);
-    SettingsManager_InitDefaultProvisioning(&p_State->Settings);
-    SettingsManager_InitDefaultWiFi(&p_State->Settings);
-    SettingsManager_InitDefaultSystem(p_State);
-    SettingsManager_InitDefaultLepton(&p_State->Settings);
-    SettingsManager_InitDefaultHTTPServer(&p_State->Settings);
-    SettingsManager_InitDefaultVISAServer(&p_State->Settings);
-}
-
-void SettingsManager_InitDefaultDisplay(App_Settings_t *p_Settings)
-{
-    ESP_LOGW(TAG, "Loading default Display settings");
-
-    p_Settings->Display.Brightness = SETTINGS_DISPLAY_DEFAULT_BRIGHTNESS;
-    p_Settings->Display.Timeout = SETTINGS_DISPLAY_DEFAULT_TIMEOUT;
-}
-
-void SettingsManager_InitDefaultProvisioning(App_Settings_t *p_Settings)
-{
-    ESP_LOGW(TAG, "Loading default Provisioning settings");
-
-    p_Settings->Provisioning.Timeout = SETTINGS_PROVISIONING_DEFAULT_TIMEOUT;
-    strncpy(p_Settings->Provisioning.Name, SETTINGS_PROVISIONING_DEFAULT_NAME, sizeof(p_Settings->Provisioning.Name));
-}
+    uint8_t Mac[6];
 
-void SettingsManager_InitDefaultWiFi(App_Settings_t *p_Settings)
-{
-    ESP_LOGW(TAG, "Loading default WiFi settings");
+    ESP_LOGD(TAG, "Loading default settings");
 
-    p_Settings->WiFi.AutoConnect = SETTINGS_WIFI_DEFAULT_AUTOCONNECT;
-    p_Settings->WiFi.MaxRetries = SETTINGS_WIFI_DEFAULT_MAX_RETRIES;
-    p_Settings->WiFi.RetryInterval = SETTINGS_WIFI_DEFAULT_RETRY_INTERVAL;
-    strncpy(p_Settings->WiFi.SSID, "", sizeof(p_Settings->WiFi.SSID));
-    strncpy(p_Settings->WiFi.Password, "", sizeof(p_Settings->WiFi.Password));
-}
-
-void SettingsManager_InitDefaultSystem(SettingsManager_State_t *p_State)
-{
-    uint8_t Mac[6];
+    memcpy(&p_State->Settings, &SettingsManager_Defaults, sizeof(App_Settings_t));
 
-    ESP_LOGW(TAG, "Loading default System settings");
+    /* The default settings don't contain a device name, so each device gets an unique name with the MAC address */
+    if (p_State->Settings.System.DeviceName[0] != '\0') {
+        return;
+    }
 
     if (esp_efuse_mac_get_default(Mac) == ESP_OK) {
         snprintf(p_State->Settings.System.DeviceName, sizeof(p_State->Settings.System.DeviceName),
@@ -130,31 +54,4 @@ void SettingsManager_InitDefaultSystem(SettingsManager_State_t *p_State)
                  SETTINGS_SYSTEM_DEFAULT_DEVICENAME);
         ESP_LOGW(TAG, "Failed to get MAC address, using default name");
     }
-
-    p_State->Settings.System.SDCard_AutoMount = true;
-    strncpy(p_State->Settings.System.Timezone, SETTINGS_SYSTEM_DEFAULT_TIMEZONE, sizeof(p_State->Settings.System.Timezone));
 }
-
-void SettingsManager_InitDefaultLepton(App_Settings_t *p_Settings)
-{
-    ESP_LOGW(TAG, "Loading default Lepton settings");
-
-    SettingsManager_InitDefaultLeptonROIs(p_Settings);
-    SettingsManager_InitDefaultLeptonEmissivityPresets(p_Settings);
-}
-
-void SettingsManager_InitDefaultHTTPServer(App_Settings_t *p_Settings)
-{
-    ESP_LOGW(TAG, "Loading default HTTP Server settings");
-
-    p_Settings->HTTPServer.Port = SETTINGS_DEFAULT_HTTP_PORT;
-    p_Settings->HTTPServer.WSPingIntervalSec = SETTINGS_DEFAULT_WS_PING_INTERVAL;
-    p_Settings->HTTPServer.MaxClients = SETTINGS_DEFAULT_HTTP_MAX_CLIENTS;
-}
-
-void SettingsManager_InitDefaultVISAServer(App_Settings_t *p_Settings)
-{
-    ESP_LOGW(TAG, "Loading default VISA Server settings");
-
-    p_Settings->VISAServer.Port = SETTINGS_DEFAULT_VISA_PORT;
-}
\ No newline at end of file
@@ -25,6 +25,7 @@
 #define SETTINGS_LOADER_H_
 
 #include <esp_err.h>
+#include <esp_timer.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
@@ -55,6 +56,80 @@
 #define SETTINGS_DISPLAY_DEFAULT_BRIGHTNESS    80
 #define SETTINGS_DISPLAY_DEFAULT_TIMEOUT       0
 
+/** @brief Layout version of the stored settings. 0 is the single settings blob of older firmware versions.
+ *         Members can be appended to the end of a section without a new version, the stored part is kept and the
+ *         new members get their defaults. Increment the version and add a migration to _Migrations in
+ *         settingsManager.cpp when a member is changed, moved or removed.
+ */
+#define SETTINGS_VERSION                        1
+
+/** @brief Layout of the single settings blob of version 0. Frozen copy of App_Settings_t of the older firmware
+ *         versions with fixed width types, so it has the size of the stored blob on every target. Don't change it.
+ */
+typedef struct {
+    struct {
+        char FirmwareVersion[16];
+        char Manufacturer[16];
+        uint16_t Serial;
+    } __attribute__((packed)) Info;
+    struct {
+        struct {
+            uint32_t Type;
+            uint16_t x;
+            uint16_t y;
+            uint16_t w;
+            uint16_t h;
+        } __attribute__((packed)) ROI[4];
+        struct {
+            float Value;
+            char Description[32];
+        } __attribute__((packed)) EmissivityPresets[128];
+        uint32_t EmissivityCount;               /**< size_t of the ESP32-S3. */
+    } __attribute__((packed)) Lepton;
+    struct {
+        char SSID[33];
+        char Password[65];
+        uint8_t AutoConnect;
+        uint8_t MaxRetries;
+        uint16_t RetryInterval;
+    } __attribute__((packed)) WiFi;
+    struct {
+        char Name[32];
+        uint32_t Timeout;
+    } __attribute__((packed)) Provisioning;
+    struct {
+        uint8_t Brightness;
+        uint16_t Timeout;
+    } __attribute__((packed)) Display;
+    struct {
+        uint16_t Port;
+        uint16_t WSPingIntervalSec;
+        uint8_t MaxClients;
+    } __attribute__((packed)) HTTPServer;
+    struct {
+        uint16_t Port;
+    } __attribute__((packed)) VISAServer;
+    struct {
+        uint8_t SDCard_AutoMount;
+        char Timezone[32];
+        char DeviceName[32];
+        uint8_t Reserved[100];
+    } __attribute__((packed)) System;
+} __attribute__((packed)) SettingsManager_Settings_V0_t;
+
+/** @brief Number of settings snapshots. One snapshot is the current one, the others can still be held by readers
+ *         while the next one is written.
+ */
+#define SETTINGS_SNAPSHOTS                      3
+
+/** @brief Immutable copy of the settings for the readers.
+ */
+typedef struct {
+    uint32_t Version;                           /**< Settings version of this snapshot. */
+    uint8_t RefCount;                           /**< Number of readers holding this snapshot. */
+    App_Settings_t Settings;                    /**< Copy of the settings. */
+} SettingsManager_Snapshot_t;
+
 /** @brief Settings Manager state.
  */
 typedef struct {
@@ -63,62 +138,21 @@ typedef struct {
     App_Settings_t Settings;
     App_Settings_Info_t Info;
     SemaphoreHandle_t Mutex;
+    uint32_t Dirty;                             /**< Bit mask of the sections that differ from the NVS. */
+    esp_timer_handle_t CommitTimer;             /**< Writes the dirty sections after CONFIG_SETTINGS_COMMIT_DELAY_MS. */
+    SettingsManager_Snapshot_t *Snapshots;      /**< SETTINGS_SNAPSHOTS snapshots in PSRAM. */
+    SettingsManager_Snapshot_t *Current;        /**< Latest snapshot. Only changed with the snapshot lock taken. */
+    volatile uint32_t Version;                  /**< Version of the latest snapshot. */
 } SettingsManager_State_t;
 
-/** @brief          Initialize the settings presets from the NVS by using a config JSON file.
- *  @param p_State  Pointer to the Settings Manager state structure
- *  @return         ESP_OK on success, ESP_ERR_* on failure
- */
-esp_err_t SettingsManager_LoadDefaultsFromJSON(SettingsManager_State_t *p_State);
-
-/** @brief              Initialize Lepton ROIs with factory defaults.
- *  @param p_Settings   Pointer to settings structure
+/** @brief Factory default settings. Generated at build time from data/default_settings.json by
+ *         scripts/settings_defaults.py and stored in flash.
  */
-void SettingsManager_InitDefaultLeptonROIs(App_Settings_t *p_Settings);
+extern const App_Settings_t SettingsManager_Defaults;
 
-/** @brief              Initialize Lepton emissivity presets with factory defaults.
- *  @param p_Settings   Pointer to settings structure
- */
-void SettingsManager_InitDefaultLeptonEmissivityPresets(App_Settings_t *p_Settings);
-
-/** @brief          Initialize settings with factory defaults.
+/** @brief          Initialize the settings in the Settings Manager RAM with the factory defaults.
  *  @param p_State  Pointer to Settings Manager state structure
  */
 void SettingsManager_InitDefaults(SettingsManager_State_t *p_State);
 
-/** @brief              Initialize Display settings with factory defaults.
- *  @param p_Settings   Pointer to settings structure
- */
-void SettingsManager_InitDefaultDisplay(App_Settings_t *p_Settings);
-
-/** @brief              Initialize Provisioning settings with factory defaults.
- *  @param p_Settings   Pointer to settings structure
- */
-void SettingsManager_InitDefaultProvisioning(App_Settings_t *p_Settings);
-
-/** @brief              Initialize WiFi settings with factory defaults.
- *  @param p_Settings   Pointer to settings structure
- */
-void SettingsManager_InitDefaultWiFi(App_Settings_t *p_Settings);
-
-/** @brief          Initialize System settings with factory defaults.
- *  @param p_State  Pointer to Settings Manager state structure
- */
-void SettingsManager_InitDefaultSystem(SettingsManager_State_t *p_State);
-
-/** @brief              Initialize Lepton settings with factory defaults.
- *  @param p_Settings   Pointer to settings structure
- */
-void SettingsManager_InitDefaultLepton(App_Settings_t *p_Settings);
-
-/** @brief              Initialize HTTP server settings with factory defaults.
- *  @param p_Settings   Pointer to settings structure
- */
-void SettingsManager_InitDefaultHTTPServer(App_Settings_t *p_Settings);
-
-/** @brief              Initialize VISA server settings with factory defaults.
- *  @param p_Settings   Pointer to settings structure
- */
-void SettingsManager_InitDefaultVISAServer(App_Settings_t *p_Settings);
-
 #endif /* SETTINGS_LOADER_H_ */
\ No newline at end of file
@@ -25,14 +25,13 @@
 #include <esp_event.h>
 #include <esp_mac.h>
 #include <esp_efuse.h>
-#include <esp_littlefs.h>
+#include <esp_heap_caps.h>
 
 #include <nvs_flash.h>
 #include <nvs.h>
 
 #include <string.h>
-#include <sys/stat.h>
-#include <cJSON.h>
+#include <stddef.h>
 
 #include "settingsManager.h"
 #include "Private/settingsLoader.h"
@@ -41,35 +40,451 @@
  */
 #define SETTINGS_NVS_NAMESPACE      "pyrovision"
 
+/** @brief NVS key of the single settings blob of older firmware versions. It is migrated into the sections.
+ */
+#define SETTINGS_NVS_LEGACY_KEY     "settings"
+
+/** @brief NVS key of the layout version of the stored settings.
+ */
+#define SETTINGS_NVS_VERSION_KEY    "version"
+
+/** @brief          Define a settings section from the first to the last member (inclusive) of App_Settings_t.
+ *  @param Key      NVS key of the section (max. 15 characters)
+ *  @param First    First member of the section
+ *  @param Last     Last member of the section
+ */
+#define SETTINGS_SECTION(Key, First, Last)  {Key, offsetof(App_Settings_t, First),                               \
+                                             offsetof(App_Settings_t, Last) +                                   \
+                                             sizeof(static_cast<App_Settings_t *>(NULL)->Last) -                \
+                                             offsetof(App_Settings_t, First)}
+
+/** @brief Settings section that is stored with its own NVS key.
+ */
+typedef struct {
+    const char *Key;                            /**< NVS key of the section. */
+    size_t Offset;                              /**< Offset of the section in App_Settings_t. */
+    size_t Size;                                /**< Size of the section in bytes. */
+} SettingsManager_Section_t;
+
+/** @brief Settings sections. Only the changed sections are written, so the ROIs are separated from the large
+ *         emissivity preset table. The device information is created at runtime and not stored.
+ */
+static const SettingsManager_Section_t _Sections[] = {
+    SETTINGS_SECTION("lepton_roi", Lepton.ROI, Lepton.ROI),
+    SETTINGS_SECTION("lepton_emis", Lepton.EmissivityPresets, Lepton.EmissivityCount),
+    SETTINGS_SECTION("wifi", WiFi, WiFi),
+    SETTINGS_SECTION("provisioning", Provisioning, Provisioning),
+    SETTINGS_SECTION("display", Display, Display),
+    SETTINGS_SECTION("http_server", HTTPServer, HTTPServer),
+    SETTINGS_SECTION("visa_server", VISAServer, VISAServer),
+    SETTINGS_SECTION("system", System, System),
+    SETTINGS_SECTION("tasks", Tasks, Tasks),
+};
+
+#define SETTINGS_SECTION_COUNT      (sizeof(_Sections) / sizeof(_Sections[0]))
+#define SETTINGS_SECTION_ALL        ((1UL << SETTINGS_SECTION_COUNT) - 1)
+
 static const char *TAG = "settings_manager";
 
 ESP_EVENT_DEFINE_BASE(SETTINGS_EVENTS);
 
 static SettingsManager_State_t _State;
 
+/* Only protects the snapshot pointer and the reference counts. Readers never take the mutex. */
+static portMUX_TYPE _Snapshot_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+/** @brief  Publish the settings from the Settings Manager RAM as a new snapshot. Must be called with the mutex
+ *          taken, so there is only one writer.
+ */
+static void SettingsManager_Publish(void)
+{
+    SettingsManager_Snapshot_t *p_Snapshot = NULL;
+
+    /* Readers only take the current snapshot, so a free snapshot can not be taken while it is written */
+    while (p_Snapshot == NULL) {
+        portENTER_CRITICAL(&_Snapshot_Lock);
+        for (uint8_t i = 0; i < SETTINGS_SNAPSHOTS; i++) {
+            if ((&_State.Snapshots[i] != _State.Current) && (_State.Snapshots[i].RefCount == 0)) {
+                p_Snapshot = &_State.Snapshots[i];
+                break;
+            }
+        }
+        portEXIT_CRITICAL(&_Snapshot_Lock);
+
+        if (p_Snapshot == NULL) {
+            ESP_LOGW(TAG, "All settings snapshots in use, waiting for a reader!");
+            vTaskDelay(1);
+        }
+    }
+
+    memcpy(&p_Snapshot->Settings, &_State.Settings, sizeof(App_Settings_t));
+    p_Snapshot->Version = _State.Version + 1;
+
+    portENTER_CRITICAL(&_Snapshot_Lock);
+    _State.Current = p_Snapshot;
+    _State.Version = p_Snapshot->Version;
+    portEXIT_CRITICAL(&_Snapshot_Lock);
+}
+
+/** @brief          Copy a part of the current snapshot.
+ *  @param p_Dst    Pointer to destination structure
+ *  @param Offset   Offset of the part in App_Settings_t
+ *  @param Size     Size of the part in bytes
+ *  @return         ESP_OK on success
+ */
+static esp_err_t SettingsManager_Get(void *p_Dst, size_t Offset, size_t Size)
+{
+    const App_Settings_t *p_Settings;
+
+    if (p_Dst == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    p_Settings = SettingsManager_Acquire(NULL);
+    if (p_Settings == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memcpy(p_Dst, reinterpret_cast<const uint8_t *>(p_Settings) + Offset, Size);
+
+    SettingsManager_Release(p_Settings);
+
+    return ESP_OK;
+}
+
+/** @brief  Write all dirty sections to the NVS. Must be called with the mutex taken.
+ *  @return ESP_OK on success
+ */
+static esp_err_t SettingsManager_Commit(void)
+{
+    const uint8_t *p_Settings = reinterpret_cast<const uint8_t *>(&_State.Settings);
+    esp_err_t Error;
+
+    for (size_t i = 0; i < SETTINGS_SECTION_COUNT; i++) {
+        if ((_State.Dirty & (1UL << i)) == 0) {
+            continue;
+        }
+
+        Error = nvs_set_blob(_State.NVS_Handle, _Sections[i].Key, p_Settings + _Sections[i].Offset,
+                             _Sections[i].Size);
+        if (Error != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to write settings section %s: %d!", _Sections[i].Key, Error);
+            return Error;
+        }
+
+        _State.Dirty &= ~(1UL << i);
+
+        ESP_LOGD(TAG, "Settings section %s written (%u bytes)", _Sections[i].Key,
+                 static_cast<unsigned int>(_Sections[i].Size));
+    }
+
+    Error = nvs_set_u16(_State.NVS_Handle, SETTINGS_NVS_VERSION_KEY, SETTINGS_VERSION);
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write settings version: %d!", Error);
+        return Error;
+    }
+
+    Error = nvs_commit(_State.NVS_Handle);
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to commit settings: %d!", Error);
+        return Error;
+    }
+
+    return ESP_OK;
+}
+
+/** @brief  Read all sections from the NVS into the Settings Manager RAM. Missing sections and sections with a
+ *          different size keep the defaults for the missing members and are marked as dirty, so they are written
+ *          with the current layout. Must be called with the mutex taken.
+ *  @return ESP_OK on success
+ *          ESP_ERR_NVS_NOT_FOUND if no section exists
+ */
+static esp_err_t SettingsManager_ReadSections(void)
+{
+    uint8_t *p_Settings = reinterpret_cast<uint8_t *>(&_State.Settings);
+    size_t RequiredSize;
+    size_t Found = 0;
+    esp_err_t Error;
+
+    for (size_t i = 0; i < SETTINGS_SECTION_COUNT; i++) {
+        Error = nvs_get_blob(_State.NVS_Handle, _Sections[i].Key, NULL, &RequiredSize);
+        if (Error == ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGW(TAG, "Settings section %s not found, using defaults", _Sections[i].Key);
+            _State.Dirty |= (1UL << i);
+            continue;
+        } else if (Error != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to get size of settings section %s: %d!", _Sections[i].Key, Error);
+            return Error;
+        }
+
+        Found++;
+
+        /* A larger section can not be interpreted without a migration */
+        if (RequiredSize > _Sections[i].Size) {
+            ESP_LOGW(TAG, "Settings section %s too large (expected %u, got %u), using defaults",
+                     _Sections[i].Key, static_cast<unsigned int>(_Sections[i].Size),
+                     static_cast<unsigned int>(RequiredSize));
+            _State.Dirty |= (1UL << i);
+            continue;
+        }
+
+        /* A smaller section was written before members were appended. The new members keep their defaults. */
+        if (RequiredSize < _Sections[i].Size) {
+            ESP_LOGI(TAG, "Settings section %s extended from %u to %u bytes", _Sections[i].Key,
+                     static_cast<unsigned int>(RequiredSize), static_cast<unsigned int>(_Sections[i].Size));
+            _State.Dirty |= (1UL << i);
+        }
+
+        Error = nvs_get_blob(_State.NVS_Handle, _Sections[i].Key, p_Settings + _Sections[i].Offset, &RequiredSize);
+        if (Error != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to read settings section %s: %d!", _Sections[i].Key, Error);
+            return Error;
+        }
+    }
+
+    if (Found == 0) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+
+    return ESP_OK;
+}
+
+/* The old settings blob of the firmware without a layout version has 5007 bytes on the ESP32-S3 */
+static_assert(sizeof(SettingsManager_Settings_V0_t) == 5007, "Version 0 layout changed, can not migrate!");
+
+/** @brief              Migrate the single settings blob of older firmware versions (version 0) into the Settings
+ *                      Manager RAM. The sections are written by the caller.
+ *  @param p_Settings   Pointer to the settings in the Settings Manager RAM
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_NVS_NOT_FOUND if there is no old settings blob
+ *                      ESP_ERR_NO_MEM when the old settings can not be read
+ */
+static esp_err_t SettingsManager_Migrate_0_1(App_Settings_t *p_Settings)
+{
+    SettingsManager_Settings_V0_t *p_Old;
+    size_t RequiredSize;
+    esp_err_t Error;
+
+    Error = nvs_get_blob(_State.NVS_Handle, SETTINGS_NVS_LEGACY_KEY, NULL, &RequiredSize);
+    if (Error != ESP_OK) {
+        return Error;
+    }
+
+    if (RequiredSize != sizeof(SettingsManager_Settings_V0_t)) {
+        ESP_LOGW(TAG, "Old settings size mismatch (expected %u, got %u), using defaults",
+                 static_cast<unsigned int>(sizeof(SettingsManager_Settings_V0_t)),
+                 static_cast<unsigned int>(RequiredSize));
+        return ESP_OK;
+    }
+
+    p_Old = reinterpret_cast<SettingsManager_Settings_V0_t *>(heap_caps_malloc(sizeof(SettingsManager_Settings_V0_t),
+                                                                               MALLOC_CAP_SPIRAM));
+    if (p_Old == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate old settings!");
+        return ESP_ERR_NO_MEM;
+    }
+
+    Error = nvs_get_blob(_State.NVS_Handle, SETTINGS_NVS_LEGACY_KEY, p_Old, &RequiredSize);
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read old settings: %d!", Error);
+        heap_caps_free(p_Old);
+        return Error;
+    }
+
+    /* Members which are not part of version 0 keep their defaults */
+    memcpy(p_Settings->Info.FirmwareVersion, p_Old->Info.FirmwareVersion, sizeof(p_Old->Info.FirmwareVersion));
+    memcpy(p_Settings->Info.Manufacturer, p_Old->Info.Manufacturer, sizeof(p_Old->Info.Manufacturer));
+    p_Settings->Info.Serial = p_Old->Info.Serial;
+
+    for (size_t i = 0; i < (sizeof(p_Old->Lepton.ROI) / sizeof(p_Old->Lepton.ROI[0])); i++) {
+        p_Settings->Lepton.ROI[i].Type = static_cast<App_Settings_ROI_Type_t>(p_Old->Lepton.ROI[i].Type);
+        p_Settings->Lepton.ROI[i].x = p_Old->Lepton.ROI[i].x;
+        p_Settings->Lepton.ROI[i].y = p_Old->Lepton.ROI[i].y;
+        p_Settings->Lepton.ROI[i].w = p_Old->Lepton.ROI[i].w;
+        p_Settings->Lepton.ROI[i].h = p_Old->Lepton.ROI[i].h;
+    }
+
+    for (size_t i = 0; i < (sizeof(p_Old->Lepton.EmissivityPresets) / sizeof(p_Old->Lepton.EmissivityPresets[0]));
+         i++) {
+        p_Settings->Lepton.EmissivityPresets[i].Value = p_Old->Lepton.EmissivityPresets[i].Value;
+        memcpy(p_Settings->Lepton.EmissivityPresets[i].Description, p_Old->Lepton.EmissivityPresets[i].Description,
+               sizeof(p_Old->Lepton.EmissivityPresets[i].Description));
+    }
+    p_Settings->Lepton.EmissivityCount = p_Old->Lepton.EmissivityCount;
+
+    memcpy(p_Settings->WiFi.SSID, p_Old->WiFi.SSID, sizeof(p_Old->WiFi.SSID));
+    memcpy(p_Settings->WiFi.Password, p_Old->WiFi.Password, sizeof(p_Old->WiFi.Password));
+    p_Settings->WiFi.AutoConnect = (p_Old->WiFi.AutoConnect != 0);
+    p_Settings->WiFi.MaxRetries = p_Old->WiFi.MaxRetries;
+    p_Settings->WiFi.RetryInterval = p_Old->WiFi.RetryInterval;
+
+    memcpy(p_Settings->Provisioning.Name, p_Old->Provisioning.Name, sizeof(p_Old->Provisioning.Name));
+    p_Settings->Provisioning.Timeout = p_Old->Provisioning.Timeout;
+
+    p_Settings->Display.Brightness = p_Old->Display.Brightness;
+    p_Settings->Display.Timeout = p_Old->Display.Timeout;
+
+    p_Settings->HTTPServer.Port = p_Old->HTTPServer.Port;
+    p_Settings->HTTPServer.WSPingIntervalSec = p_Old->HTTPServer.WSPingIntervalSec;
+    p_Settings->HTTPServer.MaxClients = p_Old->HTTPServer.MaxClients;
+
+    p_Settings->VISAServer.Port = p_Old->VISAServer.Port;
+
+    p_Settings->System.SDCard_AutoMount = (p_Old->System.SDCard_AutoMount != 0);
+    memcpy(p_Settings->System.Timezone, p_Old->System.Timezone, sizeof(p_Old->System.Timezone));
+    memcpy(p_Settings->System.DeviceName, p_Old->System.DeviceName, sizeof(p_Old->System.DeviceName));
+    memcpy(p_Settings->System.Reserved, p_Old->System.Reserved, sizeof(p_Old->System.Reserved));
+
+    heap_caps_free(p_Old);
+
+    return ESP_OK;
+}
+
+/** @brief Migration of the stored settings from one layout version to the next one.
+ */
+typedef struct {
+    uint16_t Version;                           /**< Stored layout version that is migrated to Version + 1. */
+    esp_err_t (*Migrate)(App_Settings_t *p_Settings);   /**< Migration. Called with the mutex taken. */
+} SettingsManager_Migration_t;
+
+/** @brief Migrations ordered by version. The last one migrates to SETTINGS_VERSION.
+ */
+static const SettingsManager_Migration_t _Migrations[] = {
+    {0, SettingsManager_Migrate_0_1},
+};
+
+/** @brief  Load the stored settings into the Settings Manager RAM and migrate them to the current layout. The
+ *          members which are not stored keep the factory defaults. Must be called with the mutex taken.
+ *  @return ESP_OK on success
+ *          ESP_ERR_NVS_NOT_FOUND if no settings are stored
+ */
+static esp_err_t SettingsManager_ReadStored(void)
+{
+    uint16_t Version;
+    esp_err_t Error;
+
+    SettingsManager_InitDefaults(&_State);
+    _State.Dirty = 0;
+
+    /* Older firmware versions did not store a layout version */
+    Error = nvs_get_u16(_State.NVS_Handle, SETTINGS_NVS_VERSION_KEY, &Version);
+    if (Error == ESP_ERR_NVS_NOT_FOUND) {
+        Version = 0;
+    } else if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read settings version: %d!", Error);
+        return Error;
+    }
+
+    if (Version > SETTINGS_VERSION) {
+        ESP_LOGW(TAG, "Settings version %u is newer than %u!", Version, SETTINGS_VERSION);
+    }
+
+    if (Version > 0) {
+        Error = SettingsManager_ReadSections();
+        if (Error != ESP_OK) {
+            return Error;
+        }
+    }
+
+    for (size_t i = 0; i < (sizeof(_Migrations) / sizeof(_Migrations[0])); i++) {
+        if (_Migrations[i].Version < Version) {
+            continue;
+        }
+
+        Error = _Migrations[i].Migrate(&_State.Settings);
+        if (Error != ESP_OK) {
+            return Error;
+        }
+
+        ESP_LOGI(TAG, "Settings migrated from version %u to %u", _Migrations[i].Version, _Migrations[i].Version + 1);
+    }
+
+    /* Store the migrated settings with the current layout and remove the data of older firmware versions */
+    if (Version < SETTINGS_VERSION) {
+        _State.Dirty = SETTINGS_SECTION_ALL;
+    }
+
+    if (_State.Dirty != 0) {
+        Error = SettingsManager_Commit();
+        if (Error != ESP_OK) {
+            return Error;
+        }
+    }
+
+    if (Version == 0) {
+        nvs_erase_key(_State.NVS_Handle, SETTINGS_NVS_LEGACY_KEY);
+        nvs_erase_key(_State.NVS_Handle, "config_loaded");
+        nvs_commit(_State.NVS_Handle);
+    }
+
+    return ESP_OK;
+}
+
+/** @brief          Commit timer callback. Writes all changes since the timer was started.
+ *  @param p_Arg    Unused
+ */
+static void SettingsManager_CommitTimerCallback(void *p_Arg)
+{
+    SettingsManager_Save();
+}
+
 /** @brief          Update a specific settings section in the Settings Manager RAM and emit the corresponding event.
+ *                  The changed sections are marked as dirty and written to the NVS by the commit timer.
  *  @param p_Src    Pointer to source settings structure
  *  @param p_Dst    Pointer to destination settings structure in RAM
  *  @param Size     Size of the settings structure to copy
  *  @param EventID  Event identifier to emit after update
  *  @return         ESP_OK on success
  */
-static esp_err_t SettingsManager_Update(void* p_Src, void* p_Dst, size_t Size, int EventID)
+static esp_err_t SettingsManager_Update(const void* p_Src, void* p_Dst, size_t Size, int EventID)
 {
+    size_t Offset;
+    bool isDirty;
+
     if (_State.isInitialized == false) {
         return ESP_ERR_INVALID_STATE;
     } else if ((p_Src == NULL) || (p_Dst == NULL) || (Size == 0)) {
         return ESP_ERR_INVALID_ARG;
     }
 
+    Offset = reinterpret_cast<uint8_t *>(p_Dst) - reinterpret_cast<uint8_t *>(&_State.Settings);
+
     xSemaphoreTake(_State.Mutex, portMAX_DELAY);
 
-    memcpy(p_Dst, p_Src, Size);
+    /* Only mark the sections with a changed content, so a repeated update does not cause a write */
+    for (size_t i = 0; i < SETTINGS_SECTION_COUNT; i++) {
+        size_t Start = (_Sections[i].Offset > Offset) ? _Sections[i].Offset : Offset;
+        size_t End = ((_Sections[i].Offset + _Sections[i].Size) < (Offset + Size)) ?
+                     (_Sections[i].Offset + _Sections[i].Size) : (Offset + Size);
+
+        if ((Start < End) && (memcmp(reinterpret_cast<uint8_t *>(&_State.Settings) + Start,
+                                     reinterpret_cast<const uint8_t *>(p_Src) + (Start - Offset), End - Start) != 0)) {
+            _State.Dirty |= (1UL << i);
+        }
+    }
+
+    /* Readers only see a new version when something has changed */
+    if (memcmp(p_Dst, p_Src, Size) != 0) {
+        memcpy(p_Dst, p_Src, Size);
+
+        SettingsManager_Publish();
+    }
+
+    isDirty = (_State.Dirty != 0);
+
+    /* The timer is not restarted by further changes, so continuous changes are still written */
+    if (isDirty && (CONFIG_SETTINGS_COMMIT_DELAY_MS > 0) && (esp_timer_is_active(_State.CommitTimer) == false)) {
+        esp_timer_start_once(_State.CommitTimer, CONFIG_SETTINGS_COMMIT_DELAY_MS * 1000ULL);
+    }
 
     xSemaphoreGive(_State.Mutex);
 
     esp_event_post(SETTINGS_EVENTS, EventID, p_Dst, Size, portMAX_DELAY);
 
+    if (isDirty && (CONFIG_SETTINGS_COMMIT_DELAY_MS == 0)) {
+        return SettingsManager_Save();
+    }
+
     return ESP_OK;
 }
 
@@ -104,15 +519,52 @@ esp_err_t SettingsManager_Init(void)
         return ESP_ERR_NO_MEM;
     }
 
+    /* Allocated once, a settings change never allocates */
+    _State.Snapshots = reinterpret_cast<SettingsManager_Snapshot_t *>(heap_caps_calloc(SETTINGS_SNAPSHOTS,
+                                                                      sizeof(SettingsManager_Snapshot_t),
+                                                                      MALLOC_CAP_SPIRAM));
+    if (_State.Snapshots == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate settings snapshots!");
+
+        vSemaphoreDelete(_State.Mutex);
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    _State.Current = NULL;
+    _State.Version = 0;
+
     Error = nvs_open_from_partition("settings", SETTINGS_NVS_NAMESPACE, NVS_READWRITE, &_State.NVS_Handle);
     if (Error != ESP_OK) {
         ESP_LOGE(TAG, "Failed to open NVS handle: %d!", Error);
 
+        heap_caps_free(_State.Snapshots);
         vSemaphoreDelete(_State.Mutex);
 
         return Error;
     }
 
+    const esp_timer_create_args_t commit_timer_args = {
+        .callback = &SettingsManager_CommitTimerCallback,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "settings_commit",
+        .skip_unhandled_events = false,
+    };
+
+    Error = esp_timer_create(&commit_timer_args, &_State.CommitTimer);
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create commit timer: %d!", Error);
+
+        nvs_close(_State.NVS_Handle);
+        heap_caps_free(_State.Snapshots);
+        vSemaphoreDelete(_State.Mutex);
+
+        return Error;
+    }
+
+    _State.Dirty = 0;
+
     _State.isInitialized = true;
 
     /* Copy the read-only data */
@@ -135,22 +587,23 @@ esp_err_t SettingsManager_Init(void)
     /* Load the settings from the NVS */
     Error = SettingsManager_Load(&_State.Settings);
     if (Error != ESP_OK) {
-        ESP_LOGI(TAG, "No settings found, using factory defaults");
-
-        /* Try to load default settings from JSON first (on first boot) */
-        if (SettingsManager_LoadDefaultsFromJSON(&_State) != ESP_OK) {
-            ESP_LOGW(TAG, "Failed to load default settings from JSON, using built-in defaults");
-
-            /* Use built-in defaults */
-            SettingsManager_InitDefaults(&_State);
-        }
+        ESP_LOGW(TAG, "No settings found, using factory defaults");
 
         /* Save the default settings to NVS */
-        SettingsManager_Save();
+        xSemaphoreTake(_State.Mutex, portMAX_DELAY);
+        SettingsManager_InitDefaults(&_State);
+        _State.Dirty = SETTINGS_SECTION_ALL;
+        SettingsManager_Commit();
+        SettingsManager_Publish();
+        xSemaphoreGive(_State.Mutex);
+    }
 
-        /* Load the JSON presets into the settings structure */
-        SettingsManager_Load(&_State.Settings);
+    /* The readers need a snapshot, even when the settings could not be loaded again */
+    xSemaphoreTake(_State.Mutex, portMAX_DELAY);
+    if (_State.Current == NULL) {
+        SettingsManager_Publish();
     }
+    xSemaphoreGive(_State.Mutex);
 
     ESP_LOGI(TAG, "Settings Manager initialized");
 
@@ -165,9 +618,24 @@ esp_err_t SettingsManager_Deinit(void)
         return ESP_OK;
     }
 
+    /* Write the pending changes before the handle is closed */
+    esp_timer_stop(_State.CommitTimer);
+    SettingsManager_Save();
+    esp_timer_delete(_State.CommitTimer);
+
     nvs_close(_State.NVS_Handle);
     vSemaphoreDelete(_State.Mutex);
 
+    for (uint8_t i = 0; i < SETTINGS_SNAPSHOTS; i++) {
+        if (_State.Snapshots[i].RefCount > 0) {
+            ESP_LOGW(TAG, "Settings snapshot %u still held (%u) during deinit!", i, _State.Snapshots[i].RefCount);
+        }
+    }
+
+    heap_caps_free(_State.Snapshots);
+    _State.Snapshots = NULL;
+    _State.Current = NULL;
+
     _State.isInitialized = false;
 
     ESP_LOGI(TAG, "Settings Manager deinitialized");
@@ -178,7 +646,6 @@ esp_err_t SettingsManager_Deinit(void)
 esp_err_t SettingsManager_Load(App_Settings_t *p_Settings)
 {
     esp_err_t Error;
-    size_t RequiredSize;
 
     if (_State.isInitialized == false) {
         return ESP_ERR_INVALID_STATE;
@@ -188,33 +655,18 @@ esp_err_t SettingsManager_Load(App_Settings_t *p_Settings)
 
     xSemaphoreTake(_State.Mutex, portMAX_DELAY);
 
-    Error = nvs_get_blob(_State.NVS_Handle, "settings", NULL, &RequiredSize);
-    if (Error == ESP_ERR_NVS_NOT_FOUND) {
-        xSemaphoreGive(_State.Mutex);
-
-        return ESP_ERR_NVS_NOT_FOUND;
-    } else if (Error != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to get settings size: %d!", Error);
-        xSemaphoreGive(_State.Mutex);
-        return Error;
-    }
-
-    if (RequiredSize != sizeof(App_Settings_t)) {
-        ESP_LOGW(TAG, "Settings size mismatch (expected %u, got %u), using defaults",
-                 sizeof(App_Settings_t), RequiredSize);
-        xSemaphoreGive(_State.Mutex);
-
-        return ESP_ERR_INVALID_SIZE;
-    }
+    /* Pending changes are discarded, the RAM matches the NVS again */
+    esp_timer_stop(_State.CommitTimer);
 
-    Error = nvs_get_blob(_State.NVS_Handle, "settings", &_State.Settings, &RequiredSize);
+    Error = SettingsManager_ReadStored();
     if (Error != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to read settings: %d!", Error);
         xSemaphoreGive(_State.Mutex);
 
         return Error;
     }
 
+    SettingsManager_Publish();
+
     memcpy(p_Settings, &_State.Settings, sizeof(App_Settings_t));
 
     xSemaphoreGive(_State.Mutex);
@@ -234,16 +686,16 @@ esp_err_t SettingsManager_Save(void)
 
     xSemaphoreTake(_State.Mutex, portMAX_DELAY);
 
-    Error = nvs_set_blob(_State.NVS_Handle, "settings", &_State.Settings, sizeof(App_Settings_t));
-    if (Error != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to write settings: %d!", Error);
+    esp_timer_stop(_State.CommitTimer);
+
+    if (_State.Dirty == 0) {
         xSemaphoreGive(_State.Mutex);
-        return Error;
+
+        return ESP_OK;
     }
 
-    Error = nvs_commit(_State.NVS_Handle);
+    Error = SettingsManager_Commit();
     if (Error != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit settings: %d!", Error);
         xSemaphoreGive(_State.Mutex);
         return Error;
     }
@@ -257,22 +709,54 @@ esp_err_t SettingsManager_Save(void)
     return ESP_OK;
 }
 
-esp_err_t SettingsManager_GetInfo(App_Settings_Info_t* p_Settings)
+const App_Settings_t *SettingsManager_Acquire(uint32_t *p_Version)
 {
-    if ( p_Settings == NULL ) {
-        return ESP_ERR_INVALID_ARG;
-    } else if (_State.isInitialized == false) {
-        return ESP_ERR_INVALID_STATE;
+    SettingsManager_Snapshot_t *p_Snapshot;
+
+    if (_State.isInitialized == false) {
+        return NULL;
     }
 
-    xSemaphoreTake(_State.Mutex, portMAX_DELAY);
-    memcpy(p_Settings, &_State.Info, sizeof(App_Settings_Info_t));
-    xSemaphoreGive(_State.Mutex);
+    portENTER_CRITICAL(&_Snapshot_Lock);
+    p_Snapshot = _State.Current;
+    if (p_Snapshot != NULL) {
+        p_Snapshot->RefCount++;
+    }
+    portEXIT_CRITICAL(&_Snapshot_Lock);
 
-    return ESP_OK;
+    if (p_Snapshot == NULL) {
+        return NULL;
+    }
+
+    if (p_Version != NULL) {
+        *p_Version = p_Snapshot->Version;
+    }
+
+    return &p_Snapshot->Settings;
 }
 
-esp_err_t SettingsManager_GetLepton(App_Settings_Lepton_t* p_Settings)
+void SettingsManager_Release(const App_Settings_t *p_Settings)
+{
+    if ((p_Settings == NULL) || (_State.Snapshots == NULL)) {
+        return;
+    }
+
+    portENTER_CRITICAL(&_Snapshot_Lock);
+    for (uint8_t i = 0; i < SETTINGS_SNAPSHOTS; i++) {
+        if ((&_State.Snapshots[i].Settings == p_Settings) && (_State.Snapshots[i].RefCount > 0)) {
+            _State.Snapshots[i].RefCount--;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&_Snapshot_Lock);
+}
+
+uint32_t SettingsManager_GetVersion(void)
+{
+    return _State.Version;
+}
+
+esp_err_t SettingsManager_GetInfo(App_Settings_Info_t* p_Settings)
 {
     if ( p_Settings == NULL ) {
         return ESP_ERR_INVALID_ARG;
@@ -281,31 +765,46 @@ esp_err_t SettingsManager_GetLepton(App_Settings_Lepton_t* p_Settings)
     }
 
     xSemaphoreTake(_State.Mutex, portMAX_DELAY);
-    memcpy(p_Settings, &_State.Settings.Lepton, sizeof(App_Settings_Lepton_t));
+    memcpy(p_Settings, &_State.Info, sizeof(App_Settings_Info_t));
     xSemaphoreGive(_State.Mutex);
 
     return ESP_OK;
 }
 
+esp_err_t SettingsManager_GetLepton(App_Settings_Lepton_t* p_Settings)
+{
+    return SettingsManager_Get(p_Settings, offsetof(App_Settings_t, Lepton), sizeof(App_Settings_Lepton_t));
+}
+
 esp_err_t SettingsManager_UpdateLepton(App_Settings_Lepton_t* p_Settings)
 {
     return SettingsManager_Update(p_Settings, &_State.Settings.Lepton, sizeof(App_Settings_Lepton_t),
                                   SETTINGS_EVENT_LEPTON_CHANGED);
 }
 
-esp_err_t SettingsManager_GetWiFi(App_Settings_WiFi_t* p_Settings)
+esp_err_t SettingsManager_GetROI(App_Settings_ROI_Type_t Type, App_Settings_ROI_t* p_ROI)
 {
-    if ( p_Settings == NULL ) {
+    if (Type > ROI_TYPE_VIDEO_FOCUS) {
         return ESP_ERR_INVALID_ARG;
-    } else if (_State.isInitialized == false) {
-        return ESP_ERR_INVALID_STATE;
     }
 
-    xSemaphoreTake(_State.Mutex, portMAX_DELAY);
-    memcpy(p_Settings, &_State.Settings.WiFi, sizeof(App_Settings_WiFi_t));
-    xSemaphoreGive(_State.Mutex);
+    return SettingsManager_Get(p_ROI, offsetof(App_Settings_t, Lepton.ROI[0]) + (Type * sizeof(App_Settings_ROI_t)),
+                               sizeof(App_Settings_ROI_t));
+}
 
-    return ESP_OK;
+esp_err_t SettingsManager_UpdateROI(const App_Settings_ROI_t* p_ROI)
+{
+    if ((p_ROI == NULL) || (p_ROI->Type > ROI_TYPE_VIDEO_FOCUS)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return SettingsManager_Update(p_ROI, &_State.Settings.Lepton.ROI[p_ROI->Type], sizeof(App_Settings_ROI_t),
+                                  SETTINGS_EVENT_ROI_CHANGED);
+}
+
+esp_err_t SettingsManager_GetWiFi(App_Settings_WiFi_t* p_Settings)
+{
+    return SettingsManager_Get(p_Settings, offsetof(App_Settings_t, WiFi), sizeof(App_Settings_WiFi_t));
 }
 
 esp_err_t SettingsManager_UpdateWiFi(App_Settings_WiFi_t* p_Settings)
@@ -316,17 +815,7 @@ esp_err_t SettingsManager_UpdateWiFi(App_Settings_WiFi_t* p_Settings)
 
 esp_err_t SettingsManager_GetProvisioning(App_Settings_Provisioning_t* p_Settings)
 {
-    if ( p_Settings == NULL ) {
-        return ESP_ERR_INVALID_ARG;
-    } else if (_State.isInitialized == false) {
-        return ESP_ERR_INVALID_STATE;
-    }
-
-    xSemaphoreTake(_State.Mutex, portMAX_DELAY);
-    memcpy(p_Settings, &_State.Settings.Provisioning, sizeof(App_Settings_Provisioning_t));
-    xSemaphoreGive(_State.Mutex);
-
-    return ESP_OK;
+    return SettingsManager_Get(p_Settings, offsetof(App_Settings_t, Provisioning), sizeof(App_Settings_Provisioning_t));
 }
 
 esp_err_t SettingsManager_UpdateProvisioning(App_Settings_Provisioning_t* p_Settings)
@@ -337,17 +826,7 @@ esp_err_t SettingsManager_UpdateProvisioning(App_Settings_Provisioning_t* p_Sett
 
 esp_err_t SettingsManager_GetDisplay(App_Settings_Display_t* p_Settings)
 {
-    if ( p_Settings == NULL ) {
-        return ESP_ERR_INVALID_ARG;
-    } else if (_State.isInitialized == false) {
-        return ESP_ERR_INVALID_STATE;
-    }
-
-    xSemaphoreTake(_State.Mutex, portMAX_DELAY);
-    memcpy(p_Settings, &_State.Settings.Display, sizeof(App_Settings_Display_t));
-    xSemaphoreGive(_State.Mutex);
-
-    return ESP_OK;
+    return SettingsManager_Get(p_Settings, offsetof(App_Settings_t, Display), sizeof(App_Settings_Display_t));
 }
 
 esp_err_t SettingsManager_UpdateDisplay(App_Settings_Display_t* p_Settings)
@@ -358,17 +837,7 @@ esp_err_t SettingsManager_UpdateDisplay(App_Settings_Display_t* p_Settings)
 
 esp_err_t SettingsManager_GetHTTPServer(App_Settings_HTTP_Server_t* p_Settings)
 {
-    if ( p_Settings == NULL ) {
-        return ESP_ERR_INVALID_ARG;
-    } else if (_State.isInitialized == false) {
-        return ESP_ERR_INVALID_STATE;
-    }
-
-    xSemaphoreTake(_State.Mutex, portMAX_DELAY);
-    memcpy(p_Settings, &_State.Settings.HTTPServer, sizeof(App_Settings_HTTP_Server_t));
-    xSemaphoreGive(_State.Mutex);
-
-    return ESP_OK;
+    return SettingsManager_Get(p_Settings, offsetof(App_Settings_t, HTTPServer), sizeof(App_Settings_HTTP_Server_t));
 }
 
 esp_err_t SettingsManager_UpdateHTTPServer(App_Settings_HTTP_Server_t* p_Settings)
@@ -379,17 +848,7 @@ esp_err_t SettingsManager_UpdateHTTPServer(App_Settings_HTTP_Server_t* p_Setting
 
 esp_err_t SettingsManager_GetVISAServer(App_Settings_VISA_Server_t* p_Settings)
 {
-    if ( p_Settings == NULL ) {
-        return ESP_ERR_INVALID_ARG;
-    } else if (_State.isInitialized == false) {
-        return ESP_ERR_INVALID_STATE;
-    }
-
-    xSemaphoreTake(_State.Mutex, portMAX_DELAY);
-    memcpy(p_Settings, &_State.Settings.VISAServer, sizeof(App_Settings_VISA_Server_t));
-    xSemaphoreGive(_State.Mutex);
-
-    return ESP_OK;
+    return SettingsManager_Get(p_Settings, offsetof(App_Settings_t, VISAServer), sizeof(App_Settings_VISA_Server_t));
 }
 
 esp_err_t SettingsManager_UpdateVISAServer(App_Settings_VISA_Server_t* p_Settings)
@@ -400,17 +859,7 @@ esp_err_t SettingsManager_UpdateVISAServer(App_Settings_VISA_Server_t* p_Setting
 
 esp_err_t SettingsManager_GetSystem(App_Settings_System_t* p_Settings)
 {
-    if ( p_Settings == NULL ) {
-        return ESP_ERR_INVALID_ARG;
-    } else if (_State.isInitialized == false) {
-        return ESP_ERR_INVALID_STATE;
-    }
-
-    xSemaphoreTake(_State.Mutex, portMAX_DELAY);
-    memcpy(p_Settings, &_State.Settings.System, sizeof(App_Settings_System_t));
-    xSemaphoreGive(_State.Mutex);
-
-    return ESP_OK;
+    return SettingsManager_Get(p_Settings, offsetof(App_Settings_t, System), sizeof(App_Settings_System_t));
 }
 
 esp_err_t SettingsManager_UpdateSystem(App_Settings_System_t* p_Settings)
@@ -419,6 +868,17 @@ esp_err_t SettingsManager_UpdateSystem(App_Settings_System_t* p_Settings)
                                   SETTINGS_EVENT_SYSTEM_CHANGED);
 }
 
+esp_err_t SettingsManager_GetTasks(App_Settings_Tasks_t* p_Settings)
+{
+    return SettingsManager_Get(p_Settings, offsetof(App_Settings_t, Tasks), sizeof(App_Settings_Tasks_t));
+}
+
+esp_err_t SettingsManager_UpdateTasks(App_Settings_Tasks_t* p_Settings)
+{
+    return SettingsManager_Update(p_Settings, &_State.Settings.Tasks, sizeof(App_Settings_Tasks_t),
+                                  SETTINGS_EVENT_TASKS_CHANGED);
+}
+
 esp_err_t SettingsManager_ResetToDefaults(void)
 {
     esp_err_t Error;
@@ -431,24 +891,36 @@ esp_err_t SettingsManager_ResetToDefaults(void)
 
     xSemaphoreTake(_State.Mutex, portMAX_DELAY);
 
-    Error = nvs_erase_key(_State.NVS_Handle, "settings");
+    /* Discard the pending changes, so the commit timer does not write them again */
+    esp_timer_stop(_State.CommitTimer);
+    _State.Dirty = 0;
+
+    for (size_t i = 0; i < SETTINGS_SECTION_COUNT; i++) {
+        Error = nvs_erase_key(_State.NVS_Handle, _Sections[i].Key);
+        if (Error != ESP_OK && Error != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGE(TAG, "Failed to erase settings section %s: %d!", _Sections[i].Key, Error);
+            xSemaphoreGive(_State.Mutex);
+            return Error;
+        }
+    }
+
+    Error = nvs_erase_key(_State.NVS_Handle, SETTINGS_NVS_LEGACY_KEY);
     if (Error != ESP_OK && Error != ESP_ERR_NVS_NOT_FOUND) {
         ESP_LOGE(TAG, "Failed to erase settings: %d!", Error);
         xSemaphoreGive(_State.Mutex);
         return Error;
     }
 
-    Error = nvs_commit(_State.NVS_Handle);
-    if (Error != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit erase: %d!", Error);
+    Error = nvs_erase_key(_State.NVS_Handle, SETTINGS_NVS_VERSION_KEY);
+    if (Error != ESP_OK && Error != ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGE(TAG, "Failed to erase settings version: %d!", Error);
         xSemaphoreGive(_State.Mutex);
         return Error;
     }
 
-    /* Reset config_loaded flag to allow reloading default config */
-    Error = nvs_set_u8(_State.NVS_Handle, "config_loaded", false);
+    Error = nvs_commit(_State.NVS_Handle);
     if (Error != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set config_loaded flag: %d!", Error);
+        ESP_LOGE(TAG, "Failed to commit erase: %d!", Error);
         xSemaphoreGive(_State.Mutex);
         return Error;
     }
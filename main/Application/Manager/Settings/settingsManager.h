@@ -40,16 +40,37 @@ esp_err_t SettingsManager_Init(void);
 esp_err_t SettingsManager_Deinit(void);
 
 /** @brief              Load all settings from NVS into the Settings Manager RAM and into the provided structure. This function overwrites all unsaved settings in RAM.
+ *                      Settings of older firmware versions are migrated, missing settings get the factory defaults.
  *  @param p_Settings   Pointer to settings structure to populate
  *  @return             ESP_OK on success, ESP_ERR_NVS_NOT_FOUND if no settings exist
  */
 esp_err_t SettingsManager_Load(App_Settings_t *p_Settings);
 
-/** @brief  Save all RAM settings to NVS.
+/** @brief  Write all changed settings sections from the RAM to NVS immediately.
+ *          Changes are also written automatically CONFIG_SETTINGS_COMMIT_DELAY_MS after the first change.
  *  @return ESP_OK on success, ESP_ERR_* on failure
  */
 esp_err_t SettingsManager_Save(void);
 
+/** @brief              Get an immutable snapshot of all settings without taking the Settings Manager mutex.
+ *                      The snapshot does not change while it is held. Updates create a new snapshot, so the
+ *                      snapshot must be released with SettingsManager_Release as soon as possible.
+ *  @param p_Version    Pointer to store the settings version of the snapshot. Can be NULL.
+ *  @return             Pointer to the settings snapshot, NULL if the Settings Manager is not initialized
+ */
+const App_Settings_t *SettingsManager_Acquire(uint32_t *p_Version);
+
+/** @brief              Release a snapshot from SettingsManager_Acquire.
+ *  @param p_Settings   Pointer to the settings snapshot
+ */
+void SettingsManager_Release(const App_Settings_t *p_Settings);
+
+/** @brief  Get the settings version. The version is incremented with every settings update, so a task can check
+ *          for changes since it has read the settings without copying them.
+ *  @return Settings version of the latest snapshot
+ */
+uint32_t SettingsManager_GetVersion(void);
+
 /** @brief              Get the device information from the Settings Manager RAM.
  *  @param p_Settings   Pointer to Info structure to populate
  *  @return             ESP_OK on success, ESP_ERR_* on failure
@@ -68,6 +89,19 @@ esp_err_t SettingsManager_GetLepton(App_Settings_Lepton_t* p_Settings);
  */
 esp_err_t SettingsManager_UpdateLepton(App_Settings_Lepton_t* p_Settings);
 
+/** @brief              Get a single Lepton ROI from the Settings Manager RAM.
+ *  @param Type         ROI type
+ *  @param p_ROI        Pointer to ROI structure to populate
+ *  @return             ESP_OK on success, ESP_ERR_* on failure
+*/
+esp_err_t SettingsManager_GetROI(App_Settings_ROI_Type_t Type, App_Settings_ROI_t* p_ROI);
+
+/** @brief              Update a single Lepton ROI in the Settings Manager RAM. The ROI is selected by its type.
+ *  @param p_ROI        Pointer to ROI structure
+ *  @return             ESP_OK on success, ESP_ERR_* on failure
+ */
+esp_err_t SettingsManager_UpdateROI(const App_Settings_ROI_t* p_ROI);
+
 /** @brief              Get the WiFi settings from the Settings Manager RAM.
  *  @param p_Settings   Pointer to WiFi settings structure to populate
  *  @return             ESP_OK on success, ESP_ERR_* on failure
@@ -140,8 +174,21 @@ esp_err_t SettingsManager_GetSystem(App_Settings_System_t* p_Settings);
  */
 esp_err_t SettingsManager_UpdateSystem(App_Settings_System_t* p_Settings);
 
+/** @brief              Get the task topology settings from the Settings Manager RAM.
+ *  @param p_Settings   Pointer to Tasks structure to populate
+ *  @return             ESP_OK on success, ESP_ERR_* on failure
+*/
+esp_err_t SettingsManager_GetTasks(App_Settings_Tasks_t* p_Settings);
+
+/** @brief              Update the task topology settings in the Settings Manager RAM. The tasks use the new layout
+ *                      when they are created next, i.e. after a restart for the application tasks.
+ *  @param p_Settings   Pointer to Tasks structure
+ *  @return             ESP_OK on success, ESP_ERR_* on failure
+ */
+esp_err_t SettingsManager_UpdateTasks(App_Settings_Tasks_t* p_Settings);
+
 /** @brief  Reset all settings to factory defaults.
- *          Erases NVS partition and reloads defaults.
+ *          Erases the stored settings and restarts the device, which writes the factory defaults again.
  *  @return ESP_OK on success
  */
 esp_err_t SettingsManager_ResetToDefaults(void);
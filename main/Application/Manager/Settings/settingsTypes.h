@@ -53,6 +53,10 @@ enum {
                                                      Data contains App_Settings_VISA_Server_t. */
     SETTINGS_EVENT_SYSTEM_CHANGED,              /**< System settings changed.
                                                      Data contains App_Settings_System_t. */
+    SETTINGS_EVENT_TASKS_CHANGED,               /**< Task topology settings changed. The tasks use them when they
+                                                     are created next. Data contains App_Settings_Tasks_t. */
+    SETTINGS_EVENT_ROI_CHANGED,                 /**< A single Lepton ROI changed.
+                                                     Data contains App_Settings_ROI_t. */
     SETTINGS_EVENT_REQUEST_GET,                 /**< Request to get current settings. */
     SETTINGS_EVENT_REQUEST_SAVE,                /**< Request to save settings to NVS. */
     SETTINGS_EVENT_REQUEST_RESET,               /**< Request to reset settings to factory defaults. */
@@ -147,6 +151,32 @@ typedef struct {
     uint8_t Reserved[100];                      /**< Reserved for future use. */
 } __attribute__((packed)) App_Settings_System_t;
 
+/** @brief Number of tasks in the task topology settings. The index is the Topology_Task_t of the task.
+ */
+#define SETTINGS_TASKS_MAX                      16
+
+/** @brief Value of a task topology setting that keeps the Kconfig default.
+ */
+#define SETTINGS_TASK_DEFAULT                   0
+
+/** @brief Core of a task that is not pinned to a core.
+ */
+#define SETTINGS_TASK_CORE_ANY                  0xFF
+
+/** @brief Layout of a single task. Every member that is SETTINGS_TASK_DEFAULT keeps the Kconfig default.
+ */
+typedef struct {
+    uint8_t Core;                               /**< Core + 1 or SETTINGS_TASK_CORE_ANY. */
+    uint8_t Priority;                           /**< Task priority. */
+    uint16_t StackSize;                         /**< Stack size in bytes. */
+} __attribute__((packed)) App_Settings_Task_t;
+
+/** @brief Task topology settings.
+ */
+typedef struct {
+    App_Settings_Task_t Task[SETTINGS_TASKS_MAX];       /**< Layouts in the order of Topology_Task_t. */
+} __attribute__((packed)) App_Settings_Tasks_t;
+
 /** @brief Complete application settings structure.
  */
 typedef struct {
@@ -158,6 +188,7 @@ typedef struct {
     App_Settings_HTTP_Server_t HTTPServer;      /**< HTTP server settings. */
     App_Settings_VISA_Server_t VISAServer;      /**< VISA server settings. */
     App_Settings_System_t System;               /**< System settings. */
+    App_Settings_Tasks_t Tasks;                 /**< Task topology settings. */
 } __attribute__((packed)) App_Settings_t;
 
 #endif /* SETTINGS_TYPES_H_ */
@@ -27,6 +27,8 @@
 #include <esp_event.h>
 #include <sys/time.h>
 
+#include <freertos/FreeRTOS.h>
+
 #include <string.h>
 
 #include "timeManager.h"
@@ -55,8 +57,51 @@ typedef struct {
 
 static TimeManager_State_t _TimeManager_State;
 
+/** @brief Mapping of the time since boot to UTC. Read by the frame loop with every frame, so it is a copy of the
+ *         system time that can be read without the locks and the RTC of gettimeofday.
+ */
+typedef struct {
+    bool isValid;
+    int64_t Offset;                             /**< UTC minus the time since boot in microseconds. */
+} TimeManager_Clock_t;
+
+static TimeManager_Clock_t _TimeManager_Clock;
+
+static portMUX_TYPE _TimeManager_ClockLock = portMUX_INITIALIZER_UNLOCKED;
+
 static const char *TAG = "time-manager";
 
+/** @brief Take the mapping of the time since boot to UTC from the system time. Called after every change of the
+ *         system time and periodically, so a slow adjustment of the SNTP client is followed as well.
+ */
+static void TimeManager_UpdateClock(void)
+{
+    struct timeval Now;
+    struct tm Timeinfo;
+    int64_t Offset;
+    int64_t Step;
+    bool wasValid;
+    bool isValid;
+
+    gettimeofday(&Now, NULL);
+    Offset = (static_cast<int64_t>(Now.tv_sec) * 1000000) + Now.tv_usec - esp_timer_get_time();
+
+    /* A time that was set by hand is used as well, only the default time after the boot is not */
+    gmtime_r(&Now.tv_sec, &Timeinfo);
+    isValid = (Timeinfo.tm_year + 1900) >= TIME_MANAGER_VALID_YEAR_MIN;
+
+    portENTER_CRITICAL(&_TimeManager_ClockLock);
+    wasValid = _TimeManager_Clock.isValid;
+    Step = Offset - _TimeManager_Clock.Offset;
+    _TimeManager_Clock.Offset = Offset;
+    _TimeManager_Clock.isValid = isValid;
+    portEXIT_CRITICAL(&_TimeManager_ClockLock);
+
+    if (wasValid && ((Step > 1000) || (Step < -1000))) {
+        ESP_LOGD(TAG, "Clock stepped by %lld us", Step);
+    }
+}
+
 /** @brief  SNTP time synchronization notification callback.
  *  @param tv Pointer to the synchronized time value
  */
@@ -76,6 +121,8 @@ static void TimeManager_SNTP_Sync_Callback(struct timeval *tv)
     _TimeManager_State.timeSynchronized = true;
     _TimeManager_State.sntpSyncCount++;
 
+    TimeManager_UpdateClock();
+
     /* Post time synchronized event */
     esp_event_post(TIME_EVENTS, TIME_EVENT_SYNCHRONIZED, &Timeinfo, sizeof(struct tm), portMAX_DELAY);
 
@@ -102,6 +149,8 @@ static void TimeManager_Sync_Timer_Callback(void *p_Arg)
 
     time(&Now);
 
+    TimeManager_UpdateClock();
+
     /* If network is available and SNTP sync is due */
     if (_TimeManager_State.hasNetwork) {
         time_t TimeSinceSync;
@@ -214,6 +263,8 @@ esp_err_t TimeManager_Init(void *p_RTC_Handle)
 
     _TimeManager_State.isInitialized = true;
 
+    TimeManager_UpdateClock();
+
     ESP_LOGD(TAG, "Time Manager initialized (Source: %s)",
              _TimeManager_State.activeSource == TIME_SOURCE_RTC ? "RTC" :
              _TimeManager_State.activeSource == TIME_SOURCE_SNTP ? "SNTP" : "None");
@@ -327,6 +378,37 @@ esp_err_t TimeManager_GetTimestamp(time_t *p_Time, TimeManager_Source_t *p_Sourc
     return ESP_OK;
 }
 
+esp_err_t TimeManager_SetTimestamp(time_t Time)
+{
+    struct timeval Tv = {.tv_sec = Time, .tv_usec = 0};
+
+    if (settimeofday(&Tv, NULL) != 0) {
+        return ESP_FAIL;
+    }
+
+    TimeManager_UpdateClock();
+
+    return ESP_OK;
+}
+
+int64_t TimeManager_ToUTC(int64_t Monotonic)
+{
+    int64_t Offset;
+    bool isValid;
+
+    portENTER_CRITICAL(&_TimeManager_ClockLock);
+    Offset = _TimeManager_Clock.Offset;
+    isValid = _TimeManager_Clock.isValid;
+    portEXIT_CRITICAL(&_TimeManager_ClockLock);
+
+    return isValid ? (Monotonic + Offset) : 0;
+}
+
+int64_t TimeManager_GetUTC(void)
+{
+    return TimeManager_ToUTC(esp_timer_get_time());
+}
+
 esp_err_t TimeManager_GetStatus(TimeManager_Status_t *p_Status)
 {
     if (p_Status == NULL) {
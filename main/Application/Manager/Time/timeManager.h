@@ -25,6 +25,7 @@
 #define TIME_MANAGER_H_
 
 #include <time.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include <esp_err.h>
 
@@ -88,6 +89,24 @@ esp_err_t TimeManager_GetTime(struct tm *p_Time, TimeManager_Source_t *p_Source)
  */
 esp_err_t TimeManager_GetTimestamp(time_t *p_Time, TimeManager_Source_t *p_Source);
 
+/** @brief      Set the system time, e.g. from a client without SNTP.
+ *  @param Time UNIX timestamp
+ *  @return     ESP_OK on success
+ */
+esp_err_t TimeManager_SetTimestamp(time_t Time);
+
+/** @brief              Convert a time since boot into UTC. The mapping is updated with every SNTP and RTC
+ *                      synchronization, the conversion never does any I/O and can be called from every task.
+ *  @param Monotonic    Time since boot in microseconds (esp_timer_get_time)
+ *  @return             Microseconds since 1970-01-01 UTC or 0 if the time is not synchronized
+ */
+int64_t TimeManager_ToUTC(int64_t Monotonic);
+
+/** @brief  Get the current UTC time with microsecond resolution, see TimeManager_ToUTC.
+ *  @return Microseconds since 1970-01-01 UTC or 0 if the time is not synchronized
+ */
+int64_t TimeManager_GetUTC(void);
+
 /** @brief          Get the time manager status.
  *  @param p_Status Pointer to store the status
  *  @return         ESP_OK on success
@@ -0,0 +1,376 @@
+/*
+ * memoryPlan.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Placement policy and static arena of the large buffers.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_attr.h>
+#include <esp_heap_caps.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <string.h>
+
+#include <sdkconfig.h>
+
+#include "memoryPlan.h"
+
+/** @brief Maximum number of buffers of the fast, DMA and frame regions. Short lived buffers are only counted.
+ */
+#define MEMORY_PLAN_MAX_BUFFERS             64
+
+/** @brief Alignment of the buffers in the frame arena, enough for the PSRAM cache lines and the DMA.
+ */
+#define MEMORY_PLAN_ARENA_ALIGN             16
+
+#define MEMORY_PLAN_ARENA_SIZE              (CONFIG_MEMORY_ARENA_SIZE_KB * 1024)
+
+/** @brief Buffer of the plan.
+ */
+typedef struct {
+    const char *Owner;                          /**< NULL for a free entry. */
+    void *Buffer;
+    uint32_t Size;
+    uint8_t Region;                             /**< MemoryPlan_Region_t */
+    bool isFallback;                            /**< The buffer is in the PSRAM heap instead of its region. */
+} MemoryPlan_Buffer_t;
+
+typedef struct {
+    uint32_t ArenaTop;                          /**< End of the last buffer in the frame arena. */
+    MemoryPlan_Usage_t Regions[MEMORY_REGION_COUNT];
+    MemoryPlan_Buffer_t Buffers[MEMORY_PLAN_MAX_BUFFERS];
+} MemoryPlan_State_t;
+
+static MemoryPlan_State_t _MemoryPlan_State;
+
+/* Buffers are allocated by the boot steps on both cores and by the network tasks */
+static portMUX_TYPE _MemoryPlan_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+#if MEMORY_PLAN_ARENA_SIZE > 0
+/* Reserved by the linker, so the frame buffers never compete with the heap for a large free block */
+EXT_RAM_BSS_ATTR static uint8_t _MemoryPlan_Arena[MEMORY_PLAN_ARENA_SIZE]
+    __attribute__((aligned(MEMORY_PLAN_ARENA_ALIGN)));
+#endif
+
+static const char *_MemoryPlan_RegionNames[MEMORY_REGION_COUNT] = {
+    "fast",
+    "dma",
+    "frame",
+    "bulk",
+};
+
+static const char *TAG = "memory_plan";
+
+/** @brief          Check if a buffer is in the frame arena.
+ *  @param p_Buffer Buffer
+ *  @return         true if the buffer is in the arena
+ */
+static bool MemoryPlan_isArena(const void *p_Buffer)
+{
+#if MEMORY_PLAN_ARENA_SIZE > 0
+    const uint8_t *Buffer = reinterpret_cast<const uint8_t *>(p_Buffer);
+
+    return (Buffer >= _MemoryPlan_Arena) && (Buffer < (_MemoryPlan_Arena + MEMORY_PLAN_ARENA_SIZE));
+#else
+    return false;
+#endif
+}
+
+/** @brief          Count a buffer. Call with the lock taken.
+ *  @param Region   Region of the buffer
+ *  @param Size     Size in bytes
+ */
+static void MemoryPlan_Count(MemoryPlan_Region_t Region, uint32_t Size)
+{
+    MemoryPlan_Usage_t *Usage = &_MemoryPlan_State.Regions[Region];
+
+    Usage->Bytes += Size;
+    Usage->Count++;
+    if (Usage->Bytes > Usage->Peak) {
+        Usage->Peak = Usage->Bytes;
+    }
+}
+
+/** @brief          Take space of the frame arena. Call with the lock taken.
+ *  @param Size     Size in bytes
+ *  @return         Pointer to the space or NULL if the arena is full
+ */
+static void *MemoryPlan_TakeArena(size_t Size)
+{
+#if MEMORY_PLAN_ARENA_SIZE > 0
+    uint32_t Offset;
+
+    Offset = (_MemoryPlan_State.ArenaTop + MEMORY_PLAN_ARENA_ALIGN - 1) &
+             ~static_cast<uint32_t>(MEMORY_PLAN_ARENA_ALIGN - 1);
+    if ((Offset > MEMORY_PLAN_ARENA_SIZE) || (Size > (MEMORY_PLAN_ARENA_SIZE - Offset))) {
+        return NULL;
+    }
+
+    _MemoryPlan_State.ArenaTop = Offset + Size;
+
+    return &_MemoryPlan_Arena[Offset];
+#else
+    return NULL;
+#endif
+}
+
+/** @brief Give the space of freed buffers at the end of the frame arena back. Call with the lock taken.
+ */
+static void MemoryPlan_TrimArena(void)
+{
+#if MEMORY_PLAN_ARENA_SIZE > 0
+    uint32_t Top = 0;
+
+    for (uint8_t i = 0; i < MEMORY_PLAN_MAX_BUFFERS; i++) {
+        const MemoryPlan_Buffer_t *Entry = &_MemoryPlan_State.Buffers[i];
+
+        if ((Entry->Owner != NULL) && MemoryPlan_isArena(Entry->Buffer)) {
+            uint32_t End = (reinterpret_cast<uint8_t *>(Entry->Buffer) - _MemoryPlan_Arena) + Entry->Size;
+
+            if (End > Top) {
+                Top = End;
+            }
+        }
+    }
+
+    _MemoryPlan_State.ArenaTop = Top;
+#endif
+}
+
+/** @brief          Get the capabilities of the heap of a region.
+ *  @param Region   Region
+ *  @return         Capabilities for heap_caps_malloc
+ */
+static uint32_t MemoryPlan_GetCaps(MemoryPlan_Region_t Region)
+{
+    switch (Region) {
+        case MEMORY_REGION_FAST: {
+            return MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+        }
+        case MEMORY_REGION_DMA: {
+            return MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA;
+        }
+        default: {
+            return MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+        }
+    }
+}
+
+void *MemoryPlan_Alloc(MemoryPlan_Region_t Region, size_t Size, const char *p_Owner)
+{
+    void *Buffer;
+    bool isFallback;
+    int Index;
+
+    if ((Region >= MEMORY_REGION_COUNT) || (Size == 0)) {
+        return NULL;
+    }
+
+    if (p_Owner == NULL) {
+        p_Owner = "unnamed";
+    }
+
+    /* Short lived buffers are only counted, they are allocated for every frame or message */
+    if (Region == MEMORY_REGION_BULK) {
+        size_t Allocated;
+
+        Buffer = heap_caps_malloc(Size, MemoryPlan_GetCaps(Region));
+        if (Buffer != NULL) {
+            Allocated = heap_caps_get_allocated_size(Buffer);
+
+            portENTER_CRITICAL(&_MemoryPlan_Lock);
+            MemoryPlan_Count(Region, Allocated);
+            portEXIT_CRITICAL(&_MemoryPlan_Lock);
+        }
+
+        return Buffer;
+    }
+
+    Buffer = NULL;
+    isFallback = false;
+
+    /* Reserve the entry first, so a concurrent allocation does not take it */
+    portENTER_CRITICAL(&_MemoryPlan_Lock);
+    Index = -1;
+    for (uint8_t i = 0; i < MEMORY_PLAN_MAX_BUFFERS; i++) {
+        if (_MemoryPlan_State.Buffers[i].Owner == NULL) {
+            Index = i;
+            break;
+        }
+    }
+
+    if (Index >= 0) {
+        if (Region == MEMORY_REGION_FRAME) {
+            Buffer = MemoryPlan_TakeArena(Size);
+        }
+
+        _MemoryPlan_State.Buffers[Index].Owner = p_Owner;
+        _MemoryPlan_State.Buffers[Index].Buffer = Buffer;
+        _MemoryPlan_State.Buffers[Index].Size = Size;
+        _MemoryPlan_State.Buffers[Index].Region = Region;
+        _MemoryPlan_State.Buffers[Index].isFallback = false;
+    }
+    portEXIT_CRITICAL(&_MemoryPlan_Lock);
+
+    if (Index < 0) {
+        /* Not listed in the report, it is counted and freed like a short lived buffer */
+        ESP_LOGW(TAG, "Too many buffers, %s is placed in the PSRAM heap!", p_Owner);
+
+        return MemoryPlan_Alloc(MEMORY_REGION_BULK, Size, p_Owner);
+    }
+
+    if ((Buffer == NULL) && (Region != MEMORY_REGION_FRAME)) {
+        Buffer = heap_caps_malloc(Size, MemoryPlan_GetCaps(Region));
+    }
+
+    if (Buffer == NULL) {
+        /* The buffer only gets slower in the PSRAM heap */
+        ESP_LOGW(TAG, "%s (%u bytes) does not fit into the %s region, using the PSRAM heap!", p_Owner,
+                 static_cast<unsigned int>(Size), _MemoryPlan_RegionNames[Region]);
+
+        Buffer = heap_caps_malloc(Size, MemoryPlan_GetCaps(MEMORY_REGION_BULK));
+        isFallback = true;
+    }
+
+    portENTER_CRITICAL(&_MemoryPlan_Lock);
+    if (Buffer == NULL) {
+        _MemoryPlan_State.Buffers[Index].Owner = NULL;
+    } else {
+        _MemoryPlan_State.Buffers[Index].Buffer = Buffer;
+        _MemoryPlan_State.Buffers[Index].isFallback = isFallback;
+        MemoryPlan_Count(Region, Size);
+
+        if (isFallback) {
+            _MemoryPlan_State.Regions[Region].Fallbacks++;
+        }
+    }
+    portEXIT_CRITICAL(&_MemoryPlan_Lock);
+
+    if (Buffer == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %s (%u bytes)!", p_Owner, static_cast<unsigned int>(Size));
+    }
+
+    return Buffer;
+}
+
+void MemoryPlan_Free(void *p_Buffer)
+{
+    MemoryPlan_Usage_t *Usage;
+    size_t Size;
+    bool isArena;
+    bool isListed;
+
+    if (p_Buffer == NULL) {
+        return;
+    }
+
+    isArena = MemoryPlan_isArena(p_Buffer);
+
+    /* Only needed for a short lived buffer, but the heap can not be asked with the lock taken */
+    Size = isArena ? 0 : heap_caps_get_allocated_size(p_Buffer);
+
+    isListed = false;
+
+    portENTER_CRITICAL(&_MemoryPlan_Lock);
+    for (uint8_t i = 0; i < MEMORY_PLAN_MAX_BUFFERS; i++) {
+        MemoryPlan_Buffer_t *Entry = &_MemoryPlan_State.Buffers[i];
+
+        if ((Entry->Owner != NULL) && (Entry->Buffer == p_Buffer)) {
+            Usage = &_MemoryPlan_State.Regions[Entry->Region];
+            Usage->Bytes -= Entry->Size;
+            Usage->Count--;
+
+            Entry->Owner = NULL;
+            Entry->Buffer = NULL;
+            isListed = true;
+
+            break;
+        }
+    }
+
+    if (isArena) {
+        MemoryPlan_TrimArena();
+    } else if (isListed == false) {
+        Usage = &_MemoryPlan_State.Regions[MEMORY_REGION_BULK];
+        Usage->Bytes = (Usage->Bytes > Size) ? (Usage->Bytes - Size) : 0;
+        if (Usage->Count > 0) {
+            Usage->Count--;
+        }
+    }
+    portEXIT_CRITICAL(&_MemoryPlan_Lock);
+
+    if (isArena == false) {
+        heap_caps_free(p_Buffer);
+    }
+}
+
+void MemoryPlan_GetStatus(MemoryPlan_Status_t *p_Status)
+{
+    if (p_Status == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&_MemoryPlan_Lock);
+    p_Status->ArenaSize = MEMORY_PLAN_ARENA_SIZE;
+    p_Status->ArenaUsed = _MemoryPlan_State.ArenaTop;
+    memcpy(p_Status->Regions, _MemoryPlan_State.Regions, sizeof(p_Status->Regions));
+    portEXIT_CRITICAL(&_MemoryPlan_Lock);
+}
+
+void MemoryPlan_Report(void)
+{
+    MemoryPlan_Status_t Status;
+    /* Static to keep it off the stack of the calling task */
+    static MemoryPlan_Buffer_t Buffers[MEMORY_PLAN_MAX_BUFFERS];
+
+    MemoryPlan_GetStatus(&Status);
+
+    portENTER_CRITICAL(&_MemoryPlan_Lock);
+    memcpy(Buffers, _MemoryPlan_State.Buffers, sizeof(Buffers));
+    portEXIT_CRITICAL(&_MemoryPlan_Lock);
+
+    ESP_LOGI(TAG, "Frame arena: %lu of %lu kB used", static_cast<unsigned long>(Status.ArenaUsed / 1024),
+             static_cast<unsigned long>(Status.ArenaSize / 1024));
+
+    for (uint8_t i = 0; i < MEMORY_REGION_COUNT; i++) {
+        ESP_LOGI(TAG, "  %-5s %7lu bytes in %lu buffers, peak %lu bytes, %lu fallbacks", _MemoryPlan_RegionNames[i],
+                 static_cast<unsigned long>(Status.Regions[i].Bytes),
+                 static_cast<unsigned long>(Status.Regions[i].Count),
+                 static_cast<unsigned long>(Status.Regions[i].Peak),
+                 static_cast<unsigned long>(Status.Regions[i].Fallbacks));
+    }
+
+    for (uint8_t i = 0; i < MEMORY_PLAN_MAX_BUFFERS; i++) {
+        if (Buffers[i].Owner == NULL) {
+            continue;
+        }
+
+        ESP_LOGI(TAG, "    %-20s %-5s %7lu bytes%s", Buffers[i].Owner, _MemoryPlan_RegionNames[Buffers[i].Region],
+                 static_cast<unsigned long>(Buffers[i].Size), Buffers[i].isFallback ? " (PSRAM heap)" : "");
+    }
+
+    ESP_LOGI(TAG, "Internal heap: %u bytes free, largest block %u bytes",
+             static_cast<unsigned int>(heap_caps_get_free_size(MALLOC_CAP_INTERNAL)),
+             static_cast<unsigned int>(heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL)));
+    ESP_LOGI(TAG, "PSRAM heap: %u bytes free, largest block %u bytes",
+             static_cast<unsigned int>(heap_caps_get_free_size(MALLOC_CAP_SPIRAM)),
+             static_cast<unsigned int>(heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM)));
+}
@@ -0,0 +1,91 @@
+/*
+ * memoryPlan.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Placement policy and static arena of the large buffers.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef MEMORY_PLAN_H_
+#define MEMORY_PLAN_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/** @brief Memory regions of the plan. Every large buffer of the application is placed by its purpose, not by the
+ *         caller.
+ */
+typedef enum {
+    MEMORY_REGION_FAST = 0,                     /**< Internal SRAM for lookup tables and line buffers that are read
+                                                     for every pixel. Falls back to the PSRAM heap. */
+    MEMORY_REGION_DMA,                          /**< Internal DMA capable SRAM, e.g. the LVGL draw buffers. Falls
+                                                     back to the PSRAM heap. */
+    MEMORY_REGION_FRAME,                        /**< Static arena in the PSRAM for buffers that live as long as the
+                                                     pipeline (frame pool, canvas, recorders). Falls back to the
+                                                     PSRAM heap when the arena is full. */
+    MEMORY_REGION_BULK,                         /**< PSRAM heap for short lived buffers, e.g. encoded images and
+                                                     messages. */
+    MEMORY_REGION_COUNT,
+} MemoryPlan_Region_t;
+
+/** @brief Usage of a region.
+ */
+typedef struct {
+    uint32_t Bytes;                             /**< Allocated bytes. */
+    uint32_t Peak;                              /**< Maximum of Bytes. */
+    uint32_t Count;                             /**< Live allocations. */
+    uint32_t Fallbacks;                         /**< Allocations that did not fit into the region. */
+} MemoryPlan_Usage_t;
+
+/** @brief State of the memory plan.
+ */
+typedef struct {
+    uint32_t ArenaSize;                         /**< Size of the frame arena in bytes. */
+    uint32_t ArenaUsed;                         /**< Used part of the frame arena, including the freed gaps. */
+    MemoryPlan_Usage_t Regions[MEMORY_REGION_COUNT];
+} MemoryPlan_Status_t;
+
+/** @brief          Allocate a buffer in the region of its purpose. A buffer that does not fit is placed in the PSRAM
+ *                  heap with a warning, so a full region only costs speed.
+ *  @param Region   Region of the buffer
+ *  @param Size     Size in bytes
+ *  @param p_Owner  Name of the buffer for the boot report, must be a static string
+ *  @return         Pointer to the buffer, 16 byte aligned in the frame arena. NULL if there is no memory at all.
+ */
+void *MemoryPlan_Alloc(MemoryPlan_Region_t Region, size_t Size, const char *p_Owner);
+
+/** @brief          Free a buffer of MemoryPlan_Alloc. Space in the frame arena is reused when all buffers allocated
+ *                  after it are freed too, which matches the init / deinit order of the tasks.
+ *  @param p_Buffer Buffer or NULL
+ */
+void MemoryPlan_Free(void *p_Buffer);
+
+/** @brief          Get the usage of the regions.
+ *  @param p_Status Pointer to store the state
+ */
+void MemoryPlan_GetStatus(MemoryPlan_Status_t *p_Status);
+
+/** @brief Log the budget of the regions, every buffer of the plan, and the free internal and PSRAM heap. Called
+ *         once after the boot.
+ */
+void MemoryPlan_Report(void);
+
+#endif /* MEMORY_PLAN_H_ */
@@ -0,0 +1,191 @@
+/*
+ * stripe.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Fork-join executor that splits per frame kernels into horizontal bands on both cores.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <sdkconfig.h>
+
+#ifdef CONFIG_STRIPE
+
+#include <esp_log.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#include "stripe.h"
+
+typedef struct {
+    bool isInitialized;
+    volatile bool RunTask;
+    TaskHandle_t Workers[STRIPE_WORKERS];
+    SemaphoreHandle_t Lock;                     /**< Held by the caller of the running job. */
+    Stripe_Kernel_t Kernel;                     /**< Kernel of the running job. */
+    void *p_Context;                            /**< Context of the running job. */
+    uint32_t Rows;                              /**< Rows of the running job. */
+    TaskHandle_t Caller;                        /**< Task that waits for the running job. */
+    Stripe_Status_t Status;
+} Stripe_State_t;
+
+static Stripe_State_t _Stripe_State;
+
+static const char *TAG = "stripe";
+
+/** @brief              Worker task of one band. Sleeps on its notification until the next job.
+ *  @param p_Parameters Band index of the worker
+ */
+static void Stripe_Task(void *p_Parameters)
+{
+    uint8_t Band = static_cast<uint8_t>(reinterpret_cast<uintptr_t>(p_Parameters));
+
+    ESP_LOGD(TAG, "Worker %u started on core %d", Band, xPortGetCoreID());
+
+    while (true) {
+        uint32_t First;
+        uint32_t Last;
+
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (_Stripe_State.RunTask == false) {
+            break;
+        }
+
+        /* The job is published before the notification, the notification orders the memory accesses */
+        First = (_Stripe_State.Rows * Band) / STRIPE_WORKERS;
+        Last = (_Stripe_State.Rows * (Band + 1)) / STRIPE_WORKERS;
+        _Stripe_State.Kernel(_Stripe_State.p_Context, Band, First, Last - First);
+
+        xTaskNotifyGive(_Stripe_State.Caller);
+    }
+
+    _Stripe_State.Workers[Band] = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t Stripe_Init(void)
+{
+    if (_Stripe_State.isInitialized) {
+        return ESP_OK;
+    }
+
+    _Stripe_State.Lock = xSemaphoreCreateMutex();
+    if (_Stripe_State.Lock == NULL) {
+        ESP_LOGE(TAG, "Failed to create lock!");
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    _Stripe_State.RunTask = true;
+    _Stripe_State.isInitialized = true;
+
+    /* One worker per core, so every band of a job runs on its own core */
+    for (uint8_t i = 0; i < STRIPE_WORKERS; i++) {
+        if (xTaskCreatePinnedToCore(Stripe_Task, "Stripe", CONFIG_STRIPE_TASK_STACKSIZE,
+                                    reinterpret_cast<void *>(static_cast<uintptr_t>(i)), CONFIG_STRIPE_TASK_PRIO,
+                                    &_Stripe_State.Workers[i], i) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create worker %u!", i);
+            Stripe_Deinit();
+
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ESP_LOGI(TAG, "Stripe executor started with %u workers", STRIPE_WORKERS);
+
+    return ESP_OK;
+}
+
+void Stripe_Deinit(void)
+{
+    if (_Stripe_State.isInitialized == false) {
+        return;
+    }
+
+    /* A running job ends before the workers stop */
+    xSemaphoreTake(_Stripe_State.Lock, portMAX_DELAY);
+    _Stripe_State.RunTask = false;
+
+    for (uint8_t i = 0; i < STRIPE_WORKERS; i++) {
+        if (_Stripe_State.Workers[i] != NULL) {
+            xTaskNotifyGive(_Stripe_State.Workers[i]);
+        }
+    }
+
+    for (uint8_t i = 0; i < STRIPE_WORKERS; i++) {
+        while (_Stripe_State.Workers[i] != NULL) {
+            vTaskDelay(1);
+        }
+    }
+
+    _Stripe_State.isInitialized = false;
+    xSemaphoreGive(_Stripe_State.Lock);
+    vSemaphoreDelete(_Stripe_State.Lock);
+    _Stripe_State.Lock = NULL;
+}
+
+void Stripe_Run(Stripe_Kernel_t Kernel, void *p_Context, uint32_t Rows)
+{
+    uint32_t Done;
+
+    if (Kernel == NULL) {
+        return;
+    }
+
+    /* A second caller does not wait for the running job, it is faster to do the work alone */
+    if ((_Stripe_State.isInitialized == false) || (Rows < STRIPE_WORKERS) ||
+        (xSemaphoreTake(_Stripe_State.Lock, 0) != pdTRUE)) {
+        __atomic_fetch_add(&_Stripe_State.Status.Inline, 1, __ATOMIC_RELAXED);
+        Kernel(p_Context, 0, 0, Rows);
+
+        return;
+    }
+
+    _Stripe_State.Kernel = Kernel;
+    _Stripe_State.p_Context = p_Context;
+    _Stripe_State.Rows = Rows;
+    _Stripe_State.Caller = xTaskGetCurrentTaskHandle();
+
+    for (uint8_t i = 0; i < STRIPE_WORKERS; i++) {
+        xTaskNotifyGive(_Stripe_State.Workers[i]);
+    }
+
+    /* Every worker gives one notification, a take returns all that arrived so far */
+    Done = 0;
+    while (Done < STRIPE_WORKERS) {
+        Done += ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+
+    _Stripe_State.Status.Jobs++;
+    xSemaphoreGive(_Stripe_State.Lock);
+}
+
+esp_err_t Stripe_GetStatus(Stripe_Status_t *p_Status)
+{
+    if (p_Status == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    p_Status->Jobs = __atomic_load_n(&_Stripe_State.Status.Jobs, __ATOMIC_RELAXED);
+    p_Status->Inline = __atomic_load_n(&_Stripe_State.Status.Inline, __ATOMIC_RELAXED);
+
+    return ESP_OK;
+}
+
+#endif /* CONFIG_STRIPE */
@@ -0,0 +1,82 @@
+/*
+ * stripe.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Fork-join executor that splits per frame kernels into horizontal bands on both cores.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef STRIPE_H_
+#define STRIPE_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Number of bands of a job, one worker task pinned to each core.
+ */
+#define STRIPE_WORKERS                      2
+
+/** @brief              Kernel of a job. Processes the rows of one band and must not touch LVGL or other state that
+ *                      belongs to the thread of the caller.
+ *  @param p_Context    Context of the job
+ *  @param Band         Band index, 0 to STRIPE_WORKERS - 1. Every band of a job has its own index, e.g. for the
+ *                      line buffers of the band
+ *  @param First        First row of the band
+ *  @param Count        Number of rows of the band
+ */
+typedef void (*Stripe_Kernel_t)(void *p_Context, uint8_t Band, uint32_t First, uint32_t Count);
+
+/** @brief Counters since the start of the executor.
+ */
+typedef struct {
+    uint32_t Jobs;                              /**< Jobs split into bands. */
+    uint32_t Inline;                            /**< Jobs run by the caller alone, because the workers were busy or
+                                                     not running. */
+} Stripe_Status_t;
+
+/** @brief  Start the worker tasks.
+ *  @return ESP_OK on success
+ *          ESP_ERR_NO_MEM if a worker task can not be created
+ */
+esp_err_t Stripe_Init(void);
+
+/** @brief Stop the worker tasks. Waits for a running job.
+ */
+void Stripe_Deinit(void);
+
+/** @brief              Split a job into STRIPE_WORKERS bands of rows, run every band on its own core and wait until
+ *                      all bands are done. Needs no memory. The caller waits on its task notification, so it must not
+ *                      receive other notifications during the job. While another job runs or the workers are
+ *                      stopped, the caller runs all rows itself as band 0. The caller sleeps during the job, so the
+ *                      output can be handed to LVGL afterwards from the LVGL task.
+ *  @param Kernel       Kernel of the job
+ *  @param p_Context    Context of the job, passed to every band
+ *  @param Rows         Number of rows of the job
+ */
+void Stripe_Run(Stripe_Kernel_t Kernel, void *p_Context, uint32_t Rows);
+
+/** @brief              Get the counters of the executor.
+ *  @param p_Status     Pointer to store the counters
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if p_Status is NULL
+ */
+esp_err_t Stripe_GetStatus(Stripe_Status_t *p_Status);
+
+#endif /* STRIPE_H_ */
@@ -30,11 +30,14 @@
 #include <freertos/task.h>
 #include <freertos/event_groups.h>
 
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 
 #include "devicesTask.h"
 #include "Application/application.h"
+#include "Application/Bus/messageBus.h"
+#include "Application/Topology/topology.h"
 #include "Application/Manager/Time/time_types.h"
 
 #define DEVICES_TASK_STOP_REQUEST           BIT0
@@ -49,6 +52,7 @@ typedef struct {
     TaskHandle_t TaskHandle;
     EventGroupHandle_t EventGroup;
     uint32_t LastBatteryUpdate;
+    int LastBatteryVoltage;                     /**< Last published battery voltage in mV, -1 if none. */
     uint32_t LastTimeUpdate;
     struct timeval TimeOfDay;
 } Devices_Task_State_t;
@@ -74,35 +78,36 @@ static void on_GUI_Event_Handler(void *p_HandlerArgs, esp_event_base_t Base, int
 static void Task_Devices(void *p_Parameters)
 {
     uint32_t Now;
+    uint32_t Elapsed;
 
     esp_task_wdt_add(NULL);
 
     ESP_LOGD(TAG, "Devices task started on core %d", xPortGetCoreID());
 
+    _DevicesTask_State.LastBatteryVoltage = -1;
+
     _DevicesTask_State.RunTask = true;
     while (_DevicesTask_State.RunTask) {
         EventBits_t EventBits;
 
         esp_task_wdt_reset();
 
-        EventBits = xEventGroupGetBits(_DevicesTask_State.EventGroup);
-        if (EventBits & DEVICES_TASK_STOP_REQUEST) {
-            ESP_LOGD(TAG, "Stop request received");
-
-            xEventGroupClearBits(_DevicesTask_State.EventGroup, DEVICES_TASK_STOP_REQUEST);
-
-            break;
-        }
-
         Now = esp_timer_get_time() / 1000;
 
-        if ((Now - _DevicesTask_State.LastBatteryUpdate) >= 1000) {
+        if ((Now - _DevicesTask_State.LastBatteryUpdate) >= CONFIG_DEVICES_BATTERY_INTERVAL_MS) {
             App_Devices_Battery_t BatteryInfo;
 
             ESP_LOGD(TAG, "Updating battery voltage...");
 
             if (DevicesManager_GetBatteryVoltage(&BatteryInfo.Voltage, &BatteryInfo.Percentage) == ESP_OK) {
-                esp_event_post(DEVICE_EVENTS, DEVICE_EVENT_RESPONSE_BATTERY_VOLTAGE, &BatteryInfo, sizeof(BatteryInfo), portMAX_DELAY);
+                /* Only changes are published */
+                if ((_DevicesTask_State.LastBatteryVoltage < 0) ||
+                    (abs(BatteryInfo.Voltage - _DevicesTask_State.LastBatteryVoltage) >=
+                     CONFIG_DEVICES_BATTERY_THRESHOLD_MV)) {
+                    if (Bus_Publish(BUS_TOPIC_BATTERY, &BatteryInfo, sizeof(BatteryInfo)) == ESP_OK) {
+                        _DevicesTask_State.LastBatteryVoltage = BatteryInfo.Voltage;
+                    }
+                }
             } else {
                 ESP_LOGE(TAG, "Failed to read battery voltage!");
             }
@@ -110,7 +115,21 @@ static void Task_Devices(void *p_Parameters)
             _DevicesTask_State.LastBatteryUpdate = esp_timer_get_time() / 1000;
         }
 
-        vTaskDelay(10 / portTICK_PERIOD_MS);
+        /* Sleep until the next battery update is due or a stop is requested. The interval is shorter than the
+           task watchdog timeout */
+        Elapsed = (esp_timer_get_time() / 1000) - _DevicesTask_State.LastBatteryUpdate;
+        if (Elapsed > CONFIG_DEVICES_BATTERY_INTERVAL_MS) {
+            Elapsed = CONFIG_DEVICES_BATTERY_INTERVAL_MS;
+        }
+
+        EventBits = xEventGroupWaitBits(_DevicesTask_State.EventGroup, DEVICES_TASK_STOP_REQUEST, pdTRUE, pdFALSE,
+                                        (CONFIG_DEVICES_BATTERY_INTERVAL_MS - Elapsed + portTICK_PERIOD_MS - 1) /
+                                        portTICK_PERIOD_MS);
+        if (EventBits & DEVICES_TASK_STOP_REQUEST) {
+            ESP_LOGD(TAG, "Stop request received");
+
+            break;
+        }
     }
 
     ESP_LOGD(TAG, "Devices task shutting down");
@@ -178,7 +197,7 @@ void DevicesTask_Deinit(void)
 
 esp_err_t DevicesTask_Start(App_Context_t *p_AppContext)
 {
-    BaseType_t ret;
+    esp_err_t Error;
 
     if (p_AppContext == NULL) {
         return ESP_ERR_INVALID_ARG;
@@ -191,19 +210,10 @@ esp_err_t DevicesTask_Start(App_Context_t *p_AppContext)
 
     ESP_LOGD(TAG, "Starting Devices Task");
 
-    ret = xTaskCreatePinnedToCore(
-              Task_Devices,
-              "Task_Devices",
-              CONFIG_DEVICES_TASK_STACKSIZE,
-              p_AppContext,
-              CONFIG_DEVICES_TASK_PRIO,
-              &_DevicesTask_State.TaskHandle,
-              CONFIG_DEVICES_TASK_CORE
-          );
-
-    if (ret != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create Devices Task: %d!", ret);
-        return ESP_ERR_NO_MEM;
+    Error = Topology_CreateTask(TOPOLOGY_TASK_DEVICES, Task_Devices, p_AppContext, &_DevicesTask_State.TaskHandle);
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create Devices Task: %d!", Error);
+        return Error;
     }
 
     _DevicesTask_State.Running = true;
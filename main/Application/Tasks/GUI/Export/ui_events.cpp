@@ -8,6 +8,7 @@
 #include "ui.h"
 
 #include "../../../application.h"
+#include "../../../Bus/messageBus.h"
 
 void ScreenMainLoaded(lv_event_t *e)
 {
@@ -35,8 +36,8 @@ void ScreenMainLoaded(lv_event_t *e)
 
 void ScreenInfoLoaded(lv_event_t *e)
 {
-    esp_event_post(GUI_EVENTS, GUI_EVENT_REQUEST_UPTIME, NULL, 0, 0);
-    esp_event_post(GUI_EVENTS, GUI_EVENT_REQUEST_FPA_AUX_TEMP, NULL, 0, 0);
+    Bus_Request(GUI_EVENT_REQUEST_UPTIME);
+    Bus_Request(GUI_EVENT_REQUEST_FPA_AUX_TEMP);
 }
 
 void ButtonMainWiFiClicked(lv_event_t *e)
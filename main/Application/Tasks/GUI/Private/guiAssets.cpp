@@ -0,0 +1,277 @@
+/*
+ * guiAssets.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Compressed fonts and images of the GUI, inflated into the PSRAM when they are drawn first.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <sdkconfig.h>
+
+#ifdef CONFIG_GUI_COMPRESSED_ASSETS
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <rom/miniz.h>
+
+#include <string.h>
+
+#include "guiAssets.h"
+#include "Application/Memory/memoryPlan.h"
+
+/* All functions run in the context of the GUI task, which owns LVGL, so the module needs no lock */
+typedef struct {
+    lv_image_decoder_t *Decoder;
+    GUI_Assets_Asset_t *p_Loaded;               /**< List of the inflated assets. */
+} GUI_Assets_State_t;
+
+static GUI_Assets_State_t _GUI_Assets_State;
+
+static const char *TAG = "gui_assets";
+
+/** @brief          Get the compressed image of an image descriptor.
+ *  @param p_Image  Pointer to the image descriptor
+ *  @return         Pointer to the compressed image or NULL if the image is not compressed
+ */
+static GUI_Assets_Image_t *GUI_Assets_GetImage(const lv_image_dsc_t *p_Image)
+{
+    if ((p_Image == NULL) || ((p_Image->header.flags & GUI_ASSETS_IMAGE_FLAG) == 0)) {
+        return NULL;
+    }
+
+    /* The generated descriptor points to a writable GUI_Assets_Image_t */
+    return const_cast<GUI_Assets_Image_t *>(reinterpret_cast<const GUI_Assets_Image_t *>(p_Image->data));
+}
+
+/** @brief          Free the inflated bitmap of an asset and remove it from the list.
+ *  @param p_Asset  Pointer to the asset
+ */
+static void GUI_Assets_Release(GUI_Assets_Asset_t *p_Asset)
+{
+    GUI_Assets_Asset_t **pp_Link;
+
+    if (p_Asset->p_Cache == NULL) {
+        return;
+    }
+
+    for (pp_Link = &_GUI_Assets_State.p_Loaded; *pp_Link != NULL; pp_Link = &(*pp_Link)->p_Next) {
+        if (*pp_Link == p_Asset) {
+            *pp_Link = p_Asset->p_Next;
+            break;
+        }
+    }
+
+    MemoryPlan_Free(p_Asset->p_Cache);
+    p_Asset->p_Cache = NULL;
+    p_Asset->p_Next = NULL;
+
+    ESP_LOGD(TAG, "Released %s", p_Asset->Name);
+}
+
+/** @brief              Image decoder info callback. Accepts the compressed images only.
+ *  @param p_Decoder    Pointer to the decoder
+ *  @param p_Dsc        Pointer to the decoder descriptor with the image source
+ *  @param p_Header     Pointer to store the image header
+ *  @return             LV_RESULT_OK if the image is compressed
+ */
+static lv_result_t GUI_Assets_DecoderInfo(lv_image_decoder_t *p_Decoder, lv_image_decoder_dsc_t *p_Dsc,
+                                          lv_image_header_t *p_Header)
+{
+    const lv_image_dsc_t *p_Image;
+
+    LV_UNUSED(p_Decoder);
+
+    if (p_Dsc->src_type != LV_IMAGE_SRC_VARIABLE) {
+        return LV_RESULT_INVALID;
+    }
+
+    p_Image = reinterpret_cast<const lv_image_dsc_t *>(p_Dsc->src);
+    if (GUI_Assets_GetImage(p_Image) == NULL) {
+        return LV_RESULT_INVALID;
+    }
+
+    *p_Header = p_Image->header;
+    p_Header->flags &= ~GUI_ASSETS_IMAGE_FLAG;
+
+    return LV_RESULT_OK;
+}
+
+/** @brief              Image decoder open callback. Inflates the image with the first draw and hands out the
+ *                      draw buffer of the cached bitmap on every other draw.
+ *  @param p_Decoder    Pointer to the decoder
+ *  @param p_Dsc        Pointer to the decoder descriptor with the image source
+ *  @return             LV_RESULT_OK on success
+ */
+static lv_result_t GUI_Assets_DecoderOpen(lv_image_decoder_t *p_Decoder, lv_image_decoder_dsc_t *p_Dsc)
+{
+    const lv_image_dsc_t *p_Image;
+    GUI_Assets_Image_t *p_Asset;
+
+    LV_UNUSED(p_Decoder);
+
+    p_Image = reinterpret_cast<const lv_image_dsc_t *>(p_Dsc->src);
+    p_Asset = GUI_Assets_GetImage(p_Image);
+    if ((p_Asset == NULL) || (GUI_Assets_Load(&p_Asset->Asset) != ESP_OK)) {
+        return LV_RESULT_INVALID;
+    }
+
+    if (p_Asset->Buffer.data != p_Asset->Asset.p_Cache) {
+        if (lv_draw_buf_init(&p_Asset->Buffer, p_Image->header.w, p_Image->header.h,
+                             static_cast<lv_color_format_t>(p_Image->header.cf), 0, p_Asset->Asset.p_Cache,
+                             p_Asset->Asset.Size) != LV_RESULT_OK) {
+            ESP_LOGE(TAG, "Invalid image size of %s!", p_Asset->Asset.Name);
+
+            return LV_RESULT_INVALID;
+        }
+    }
+
+    p_Dsc->decoded = &p_Asset->Buffer;
+
+    return LV_RESULT_OK;
+}
+
+/** @brief              Image decoder close callback. The bitmap stays cached until GUI_Assets_ReleaseImage.
+ *  @param p_Decoder    Pointer to the decoder
+ *  @param p_Dsc        Pointer to the decoder descriptor
+ */
+static void GUI_Assets_DecoderClose(lv_image_decoder_t *p_Decoder, lv_image_decoder_dsc_t *p_Dsc)
+{
+    LV_UNUSED(p_Decoder);
+    LV_UNUSED(p_Dsc);
+}
+
+esp_err_t GUI_Assets_Init(void)
+{
+    if (_GUI_Assets_State.Decoder != NULL) {
+        return ESP_OK;
+    }
+
+    /* A new decoder is asked before the built-in ones */
+    _GUI_Assets_State.Decoder = lv_image_decoder_create();
+    if (_GUI_Assets_State.Decoder == NULL) {
+        ESP_LOGE(TAG, "Can not create image decoder!");
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    lv_image_decoder_set_info_cb(_GUI_Assets_State.Decoder, GUI_Assets_DecoderInfo);
+    lv_image_decoder_set_open_cb(_GUI_Assets_State.Decoder, GUI_Assets_DecoderOpen);
+    lv_image_decoder_set_close_cb(_GUI_Assets_State.Decoder, GUI_Assets_DecoderClose);
+
+    return ESP_OK;
+}
+
+void GUI_Assets_Deinit(void)
+{
+    if (_GUI_Assets_State.Decoder != NULL) {
+        lv_image_decoder_delete(_GUI_Assets_State.Decoder);
+        _GUI_Assets_State.Decoder = NULL;
+    }
+
+    while (_GUI_Assets_State.p_Loaded != NULL) {
+        GUI_Assets_Release(_GUI_Assets_State.p_Loaded);
+    }
+}
+
+esp_err_t GUI_Assets_Load(GUI_Assets_Asset_t *p_Asset)
+{
+    tinfl_decompressor *p_Inflator;
+    tinfl_status Status;
+    size_t InLength;
+    size_t OutLength;
+    int64_t Start;
+
+    if (p_Asset->p_Cache != NULL) {
+        return ESP_OK;
+    }
+
+    Start = esp_timer_get_time();
+
+    p_Asset->p_Cache = static_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, p_Asset->Size, p_Asset->Name));
+    p_Inflator = static_cast<tinfl_decompressor *>(MemoryPlan_Alloc(MEMORY_REGION_BULK, sizeof(tinfl_decompressor),
+                                                                    "gui_assets"));
+    if ((p_Asset->p_Cache == NULL) || (p_Inflator == NULL)) {
+        ESP_LOGE(TAG, "Can not allocate %u bytes for %s!", static_cast<unsigned int>(p_Asset->Size), p_Asset->Name);
+
+        MemoryPlan_Free(p_Asset->p_Cache);
+        MemoryPlan_Free(p_Inflator);
+        p_Asset->p_Cache = NULL;
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* The whole bitmap fits into the output buffer, so the stream is inflated in one call without a dictionary */
+    tinfl_init(p_Inflator);
+    InLength = p_Asset->Length;
+    OutLength = p_Asset->Size;
+    Status = tinfl_decompress(p_Inflator, p_Asset->Data, &InLength, p_Asset->p_Cache, p_Asset->p_Cache, &OutLength,
+                              TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+    MemoryPlan_Free(p_Inflator);
+
+    if ((Status != TINFL_STATUS_DONE) || (OutLength != p_Asset->Size)) {
+        ESP_LOGE(TAG, "Can not inflate %s: %d!", p_Asset->Name, static_cast<int>(Status));
+
+        MemoryPlan_Free(p_Asset->p_Cache);
+        p_Asset->p_Cache = NULL;
+
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    p_Asset->p_Next = _GUI_Assets_State.p_Loaded;
+    _GUI_Assets_State.p_Loaded = p_Asset;
+
+    ESP_LOGD(TAG, "Inflated %s: %u -> %u bytes in %lld us", p_Asset->Name, static_cast<unsigned int>(p_Asset->Length),
+             static_cast<unsigned int>(p_Asset->Size), esp_timer_get_time() - Start);
+
+    return ESP_OK;
+}
+
+void GUI_Assets_ReleaseImage(const lv_image_dsc_t *p_Image)
+{
+    GUI_Assets_Image_t *p_Asset;
+
+    p_Asset = GUI_Assets_GetImage(p_Image);
+    if (p_Asset == NULL) {
+        return;
+    }
+
+    GUI_Assets_Release(&p_Asset->Asset);
+    memset(&p_Asset->Buffer, 0, sizeof(p_Asset->Buffer));
+}
+
+const void *GUI_Assets_GetGlyphBitmap(lv_font_glyph_dsc_t *p_Glyph, lv_draw_buf_t *p_Buffer)
+{
+    const lv_font_t *p_Font;
+    lv_font_fmt_txt_dsc_t *p_FontDsc;
+    GUI_Assets_Asset_t *p_Asset;
+
+    p_Font = p_Glyph->resolved_font;
+    p_Asset = static_cast<GUI_Assets_Asset_t *>(p_Font->user_data);
+    if (GUI_Assets_Load(p_Asset) != ESP_OK) {
+        return NULL;
+    }
+
+    /* The generated font descriptor is writable and gets the bitmap after it was inflated */
+    p_FontDsc = const_cast<lv_font_fmt_txt_dsc_t *>(static_cast<const lv_font_fmt_txt_dsc_t *>(p_Font->dsc));
+    p_FontDsc->glyph_bitmap = p_Asset->p_Cache;
+
+    return lv_font_get_bitmap_fmt_txt(p_Glyph, p_Buffer);
+}
+
+#endif /* CONFIG_GUI_COMPRESSED_ASSETS */
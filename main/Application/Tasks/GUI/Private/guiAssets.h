@@ -0,0 +1,99 @@
+/*
+ * guiAssets.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Compressed fonts and images of the GUI, inflated into the PSRAM when they are drawn first.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef GUI_ASSETS_H_
+#define GUI_ASSETS_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <lvgl.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Image header flag of a compressed image. The data of the image descriptor points to a
+ *         GUI_Assets_Image_t and the image is drawn through the decoder of this module.
+ */
+#define GUI_ASSETS_IMAGE_FLAG               LV_IMAGE_FLAGS_USER1
+
+/** @brief Compressed bitmap of a font or an image. The assets are generated by scripts/ui_assets.py from the
+ *         SquareLine Studio export at build time.
+ */
+typedef struct GUI_Assets_Asset {
+    const char *Name;                           /**< Name of the font or image. */
+    const uint8_t *Data;                        /**< zlib stream of the bitmap in the flash. */
+    uint32_t Length;                            /**< Length of the zlib stream in bytes. */
+    uint32_t Size;                              /**< Size of the bitmap in bytes. */
+    uint8_t *p_Cache;                           /**< Inflated bitmap in the PSRAM. NULL until it is drawn first. */
+    struct GUI_Assets_Asset *p_Next;            /**< Next inflated asset. */
+} GUI_Assets_Asset_t;
+
+/** @brief Compressed image with the draw buffer that LVGL gets from the decoder.
+ */
+typedef struct {
+    GUI_Assets_Asset_t Asset;
+    lv_draw_buf_t Buffer;                       /**< Draw buffer of the inflated image. */
+} GUI_Assets_Image_t;
+
+/** @brief  Register the image decoder of the compressed images. Call after lv_init and before the screens are
+ *          created.
+ *  @return ESP_OK on success
+ *          ESP_ERR_NO_MEM if the decoder can not be created
+ */
+esp_err_t GUI_Assets_Init(void);
+
+/** @brief Remove the image decoder and free the inflated assets.
+ */
+void GUI_Assets_Deinit(void);
+
+/** @brief          Inflate an asset into the PSRAM, unless it is already inflated.
+ *  @param p_Asset  Pointer to the asset
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_NO_MEM if the memory for the bitmap is missing
+ *                  ESP_ERR_INVALID_CRC if the zlib stream is corrupted
+ */
+esp_err_t GUI_Assets_Load(GUI_Assets_Asset_t *p_Asset);
+
+/** @brief          Free the inflated bitmap of an image, e.g. of the splash screen after it was left. The image
+ *                  is inflated again when it is drawn.
+ *  @param p_Image  Pointer to the image descriptor. Images that are not compressed are ignored
+ */
+void GUI_Assets_ReleaseImage(const lv_image_dsc_t *p_Image);
+
+/** @brief          Glyph bitmap callback of the compressed fonts. Inflates the glyphs of the font with the first
+ *                  drawn glyph and returns the bitmap of lv_font_get_bitmap_fmt_txt.
+ *  @param p_Glyph  Pointer to the glyph descriptor
+ *  @param p_Buffer Draw buffer of the glyph
+ *  @return         Pointer to the bitmap or NULL if the font can not be inflated
+ */
+const void *GUI_Assets_GetGlyphBitmap(lv_font_glyph_dsc_t *p_Glyph, lv_draw_buf_t *p_Buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GUI_ASSETS_H_ */
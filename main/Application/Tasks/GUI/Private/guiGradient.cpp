@@ -0,0 +1,127 @@
+/*
+ * guiGradient.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Pre-rendered temperature gradient bars of the color palettes.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+
+#include <string.h>
+
+#include "guiGradient.h"
+
+#include "lepton.h"
+#include "Application/Memory/memoryPlan.h"
+
+#define GUI_GRADIENT_PIXELS                 (GUI_GRADIENT_WIDTH * GUI_GRADIENT_HEIGHT)
+
+/** @brief              Render the bar of a palette from its colors. The top row is the hottest color.
+ *  @param p_Gradient   Pointer to the gradient cache
+ *  @param Palette      Palette to render
+ */
+static void GUI_Gradient_Render(GUI_Gradient_t *p_Gradient, Server_Palette_t Palette)
+{
+    uint16_t *p_Bar;
+
+    p_Bar = &p_Gradient->Buffer[Palette * GUI_GRADIENT_PIXELS];
+
+    for (uint32_t y = 0; y < GUI_GRADIENT_HEIGHT; y++) {
+        const uint8_t *p_Color;
+        uint16_t RGB565;
+
+        p_Color = p_Gradient->Colors[Palette][255 - (y * 255 / (GUI_GRADIENT_HEIGHT - 1))];
+        RGB565 = ((p_Color[0] >> 3) << 11) | ((p_Color[1] >> 2) << 5) | (p_Color[2] >> 3);
+
+        for (uint32_t x = 0; x < GUI_GRADIENT_WIDTH; x++) {
+            p_Bar[(y * GUI_GRADIENT_WIDTH) + x] = RGB565;
+        }
+    }
+}
+
+esp_err_t GUI_Gradient_Init(GUI_Gradient_t *p_Gradient)
+{
+    uint8_t Gray[256][3];
+
+    if (p_Gradient == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    p_Gradient->Buffer = reinterpret_cast<uint16_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME, PALETTE_COUNT *
+                                                                       GUI_GRADIENT_PIXELS * sizeof(uint16_t),
+                                                                       "gradient_bars"));
+    if (p_Gradient->Buffer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (uint32_t i = 0; i < PALETTE_COUNT; i++) {
+        lv_img_dsc_t *p_Image = &p_Gradient->Images[i];
+
+        memset(p_Image, 0, sizeof(lv_img_dsc_t));
+        p_Image->header.cf = LV_COLOR_FORMAT_RGB565;
+        p_Image->header.w = GUI_GRADIENT_WIDTH;
+        p_Image->header.h = GUI_GRADIENT_HEIGHT;
+        p_Image->data = reinterpret_cast<const uint8_t *>(&p_Gradient->Buffer[i * GUI_GRADIENT_PIXELS]);
+        p_Image->data_size = GUI_GRADIENT_PIXELS * sizeof(uint16_t);
+    }
+
+    for (uint32_t i = 0; i < 256; i++) {
+        Gray[i][0] = i;
+        Gray[i][1] = i;
+        Gray[i][2] = i;
+    }
+
+    GUI_Gradient_Load(p_Gradient, PALETTE_IRON, Lepton_Palette_Iron);
+    GUI_Gradient_Load(p_Gradient, PALETTE_GRAY, Gray);
+    GUI_Gradient_Load(p_Gradient, PALETTE_RAINBOW, Lepton_Palette_Rainbow);
+    GUI_Gradient_Load(p_Gradient, PALETTE_CUSTOM, Gray);
+
+    return ESP_OK;
+}
+
+void GUI_Gradient_Deinit(GUI_Gradient_t *p_Gradient)
+{
+    if ((p_Gradient == NULL) || (p_Gradient->Buffer == NULL)) {
+        return;
+    }
+
+    MemoryPlan_Free(p_Gradient->Buffer);
+    p_Gradient->Buffer = NULL;
+}
+
+esp_err_t GUI_Gradient_Load(GUI_Gradient_t *p_Gradient, Server_Palette_t Palette, const uint8_t p_Colors[256][3])
+{
+    if ((p_Gradient == NULL) || (p_Gradient->Buffer == NULL) || (Palette >= PALETTE_COUNT) || (p_Colors == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memcpy(p_Gradient->Colors[Palette], p_Colors, sizeof(p_Gradient->Colors[Palette]));
+    GUI_Gradient_Render(p_Gradient, Palette);
+
+    return ESP_OK;
+}
+
+const lv_img_dsc_t *GUI_Gradient_GetImage(const GUI_Gradient_t *p_Gradient, Server_Palette_t Palette)
+{
+    return &p_Gradient->Images[(Palette < PALETTE_COUNT) ? Palette : PALETTE_IRON];
+}
+
+PaletteLUT_Palette_t GUI_Gradient_GetColors(const GUI_Gradient_t *p_Gradient, Server_Palette_t Palette)
+{
+    return p_Gradient->Colors[(Palette < PALETTE_COUNT) ? Palette : PALETTE_IRON];
+}
@@ -0,0 +1,86 @@
+/*
+ * guiGradient.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Pre-rendered temperature gradient bars of the color palettes.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef GUI_GRADIENT_H_
+#define GUI_GRADIENT_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+
+#include <lvgl.h>
+
+#include "Application/Tasks/Lepton/paletteLUT.h"
+#include "Application/Manager/Network/networkTypes.h"
+
+/* Size of the gradient bar next to the thermal image */
+#define GUI_GRADIENT_WIDTH                  20
+#define GUI_GRADIENT_HEIGHT                 180
+
+/** @brief Gradient bars of all palettes. Every bar is rendered once, a palette switch only swaps the image source.
+ */
+typedef struct {
+    uint16_t *Buffer;                           /**< RGB565 bars of all palettes, PALETTE_COUNT bars. */
+    lv_img_dsc_t Images[PALETTE_COUNT];         /**< Image descriptors of the bars. */
+    uint8_t Colors[PALETTE_COUNT][256][3];      /**< RGB888 colors of the palettes, used by the thermal LUT. */
+} GUI_Gradient_t;
+
+/** @brief              Allocate the bars and render all built-in palettes. The custom palette is gray until it is
+ *                      loaded.
+ *  @param p_Gradient   Pointer to the gradient cache
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if p_Gradient is NULL
+ *                      ESP_ERR_NO_MEM if the bars can not be allocated
+ */
+esp_err_t GUI_Gradient_Init(GUI_Gradient_t *p_Gradient);
+
+/** @brief              Free the bars.
+ *  @param p_Gradient   Pointer to the gradient cache
+ */
+void GUI_Gradient_Deinit(GUI_Gradient_t *p_Gradient);
+
+/** @brief              Load the colors of a palette and render its bar. An image showing the bar and a lookup
+ *                      table built from the palette have to be invalidated by the caller.
+ *  @param p_Gradient   Pointer to the gradient cache
+ *  @param Palette      Palette to load
+ *  @param p_Colors     256 RGB888 colors, index 0 is the coldest color
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if an argument is invalid
+ */
+esp_err_t GUI_Gradient_Load(GUI_Gradient_t *p_Gradient, Server_Palette_t Palette, const uint8_t p_Colors[256][3]);
+
+/** @brief              Get the bar of a palette.
+ *  @param p_Gradient   Pointer to the gradient cache
+ *  @param Palette      Palette
+ *  @return             Image descriptor of the bar, the bar of the iron palette for an invalid palette
+ */
+const lv_img_dsc_t *GUI_Gradient_GetImage(const GUI_Gradient_t *p_Gradient, Server_Palette_t Palette);
+
+/** @brief              Get the colors of a palette for PaletteLUT_Update.
+ *  @param p_Gradient   Pointer to the gradient cache
+ *  @param Palette      Palette
+ *  @return             Colors of the palette, the iron palette for an invalid palette
+ */
+PaletteLUT_Palette_t GUI_Gradient_GetColors(const GUI_Gradient_t *p_Gradient, Server_Palette_t Palette);
+
+#endif /* GUI_GRADIENT_H_ */
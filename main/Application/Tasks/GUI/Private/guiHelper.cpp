@@ -23,8 +23,13 @@
 
 #include <esp_log.h>
 
+#include <freertos/semphr.h>
+
 #include "guiHelper.h"
 #include "Application/application.h"
+#include "Application/Trace/trace.h"
+#include "Application/Memory/memoryPlan.h"
+#include "Application/Bus/messageBus.h"
 #include "../Export/ui.h"
 
 #if defined(CONFIG_LCD_SPI2_HOST)
@@ -37,6 +42,9 @@
 
 #define GUI_DRAW_BUFFER_SIZE                (CONFIG_GUI_WIDTH * CONFIG_GUI_HEIGHT * sizeof(uint16_t) / 10)
 
+/* Only guards against a lost transfer interrupt, a full draw buffer is sent in a few ms */
+#define GUI_FLUSH_TIMEOUT_MS                100
+
 static const esp_lcd_panel_dev_config_t _GUI_Panel_Config = {
     .reset_gpio_num = CONFIG_LCD_RST,
     .color_space = ESP_LCD_COLOR_SPACE_BGR,
@@ -80,6 +88,34 @@ static esp_lcd_touch_config_t _GUI_Touch_Config = {
 
 static esp_lcd_panel_io_spi_config_t _GUI_Touch_IO_Config = ESP_LCD_TOUCH_IO_SPI_XPT2046_CONFIG(CONFIG_TOUCH_CS);
 
+#ifdef GUI_TOUCH_USE_IRQ
+/** @brief      Pen down interrupt of the touch controller. Only marks a pending touch, the SPI bus is read by the
+ *              LVGL touch read callback.
+ *  @param tp   Touch handle
+ */
+static void IRAM_ATTR GUI_Touch_ISR(esp_lcd_touch_handle_t tp)
+{
+    reinterpret_cast<GUI_Task_State_t *>(tp->config.user_data)->isTouchPending = true;
+}
+#endif
+
+#ifdef CONFIG_LCD_FLUSH_ASYNC
+/* Given by the transfer done interrupt of the panel IO */
+static SemaphoreHandle_t _GUI_FlushDone;
+
+/* Running LVGL flush, cleared by the transfer done interrupt */
+static volatile bool _GUI_isFlushing;
+
+#ifdef CONFIG_GUI_THERMAL_DIRECT
+/* Given by the transfer done interrupt when the direct thermal image transfer is completed */
+static SemaphoreHandle_t _GUI_BlitDone;
+
+/* Running direct thermal image transfer. The next completed transfer belongs to it, because a blit is only
+   started when no flush is running and the transfers of the panel IO complete in order */
+static volatile bool _GUI_isBlitting;
+#endif
+#endif
+
 static const char *TAG = "gui_helper";
 
 static void GUI_LVGL_TickTimer_CB(void *p_Arg)
@@ -96,9 +132,78 @@ static void GUI_LCD_Flush_CB(lv_display_t *p_Disp, const lv_area_t *p_Area, uint
     int offsety1 = p_Area->y1;
     int offsety2 = p_Area->y2;
 
+#ifdef CONFIG_LCD_FLUSH_ASYNC
+    /* Drop a completion of the previous flush that was not waited for */
+    xSemaphoreTake(_GUI_FlushDone, 0);
+    _GUI_isFlushing = true;
+
+    /* The flush is completed by GUI_LCD_FlushDone_CB, LVGL renders into the other buffer in the meantime. The
+       completion runs in the interrupt context, so only the handover is traced */
+    TRACE_BEGIN(TRACE_EVENT_LVGL_FLUSH);
+    if (esp_lcd_panel_draw_bitmap(panel_handle, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1, p_PxMap) != ESP_OK) {
+        _GUI_isFlushing = false;
+        lv_display_flush_ready(p_Disp);
+    }
+    TRACE_END(TRACE_EVENT_LVGL_FLUSH);
+#else
+    TRACE_BEGIN(TRACE_EVENT_LVGL_FLUSH);
     esp_lcd_panel_draw_bitmap(panel_handle, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1, p_PxMap);
+    TRACE_END(TRACE_EVENT_LVGL_FLUSH);
 
     lv_display_flush_ready(p_Disp);
+#endif
+}
+
+#ifdef CONFIG_LCD_FLUSH_ASYNC
+/** @brief              Color transfer done callback of the panel IO. Runs in the interrupt context.
+ *  @param Panel_IO     Panel IO handle
+ *  @param p_Event      Event data
+ *  @param p_User_Ctx   LVGL display
+ *  @return             true if a higher priority task was woken
+ */
+static bool GUI_LCD_FlushDone_CB(esp_lcd_panel_io_handle_t Panel_IO, esp_lcd_panel_io_event_data_t *p_Event,
+                                 void *p_User_Ctx)
+{
+    BaseType_t Woken = pdFALSE;
+
+#ifdef CONFIG_GUI_THERMAL_DIRECT
+    if (_GUI_isBlitting) {
+        _GUI_isBlitting = false;
+        xSemaphoreGiveFromISR(_GUI_BlitDone, &Woken);
+
+        return Woken == pdTRUE;
+    }
+#endif
+
+    _GUI_isFlushing = false;
+    lv_display_flush_ready(reinterpret_cast<lv_display_t *>(p_User_Ctx));
+    xSemaphoreGiveFromISR(_GUI_FlushDone, &Woken);
+
+    return Woken == pdTRUE;
+}
+
+/** @brief          Called by LVGL when it needs the buffer of a running flush. Sleeps instead of polling the flag.
+ *  @param p_Disp   LVGL display
+ */
+static void GUI_LCD_FlushWait_CB(lv_display_t *p_Disp)
+{
+    if (xSemaphoreTake(_GUI_FlushDone, GUI_FLUSH_TIMEOUT_MS / portTICK_PERIOD_MS) != pdTRUE) {
+        ESP_LOGW(TAG, "Flush timeout!");
+    }
+}
+#endif
+
+/** @brief  Allocate a LVGL draw buffer. Internal DMA capable RAM is used when enabled, because the SPI driver copies
+ *          a PSRAM buffer into a temporary DMA buffer for every transfer. The memory plan falls back to the PSRAM.
+ *  @return Pointer to the buffer or NULL
+ */
+static void *GUI_Helper_AllocDrawBuffer(void)
+{
+#ifdef CONFIG_LCD_DRAW_BUFFER_INTERNAL
+    return MemoryPlan_Alloc(MEMORY_REGION_DMA, GUI_DRAW_BUFFER_SIZE, "lvgl_draw_buffer");
+#else
+    return MemoryPlan_Alloc(MEMORY_REGION_FRAME, GUI_DRAW_BUFFER_SIZE, "lvgl_draw_buffer");
+#endif
 }
 
 esp_err_t GUI_Helper_Init(GUI_Task_State_t *p_GUITask_State, lv_indev_read_cb_t Touch_Read_Callback)
@@ -128,9 +233,29 @@ esp_err_t GUI_Helper_Init(GUI_Task_State_t *p_GUITask_State, lv_indev_read_cb_t
     ESP_LOGD(TAG, "LVGL display object created");
 
     /* Register event callbacks BEFORE installing panel driver */
+#ifdef CONFIG_LCD_FLUSH_ASYNC
+    _GUI_FlushDone = xSemaphoreCreateBinary();
+    if (_GUI_FlushDone == NULL) {
+        ESP_LOGE(TAG, "Failed to create flush semaphore!");
+        return ESP_ERR_NO_MEM;
+    }
+
+#ifdef CONFIG_GUI_THERMAL_DIRECT
+    _GUI_BlitDone = xSemaphoreCreateBinary();
+    if (_GUI_BlitDone == NULL) {
+        ESP_LOGE(TAG, "Failed to create blit semaphore!");
+        return ESP_ERR_NO_MEM;
+    }
+#endif
+
+    esp_lcd_panel_io_callbacks_t cbs = {
+        .on_color_trans_done = GUI_LCD_FlushDone_CB,
+    };
+#else
     esp_lcd_panel_io_callbacks_t cbs = {
         .on_color_trans_done = NULL,
     };
+#endif
     ESP_ERROR_CHECK(esp_lcd_panel_io_register_event_callbacks(p_GUITask_State->Panel_IO_Handle, &cbs,
                                                               p_GUITask_State->Display));
     ESP_LOGD(TAG, "LCD panel IO callbacks registered");
@@ -152,19 +277,21 @@ esp_err_t GUI_Helper_Init(GUI_Task_State_t *p_GUITask_State, lv_indev_read_cb_t
     ESP_ERROR_CHECK(esp_lcd_panel_mirror(p_GUITask_State->PanelHandle, true, true));
     ESP_LOGD(TAG, "Panel mirroring configured (180 degree rotation)");
     ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(p_GUITask_State->PanelHandle, true));
+    p_GUITask_State->isDisplayOn = true;
     ESP_LOGD(TAG, "Panel display turned ON");
     vTaskDelay(100 / portTICK_PERIOD_MS);
 
     /* Set LVGL display properties */
     lv_display_set_flush_cb(p_GUITask_State->Display, GUI_LCD_Flush_CB);
+#ifdef CONFIG_LCD_FLUSH_ASYNC
+    lv_display_set_flush_wait_cb(p_GUITask_State->Display, GUI_LCD_FlushWait_CB);
+#endif
     lv_display_set_user_data(p_GUITask_State->Display,
                              p_GUITask_State->PanelHandle);
 
     /* Note: Color format set to RGB565 by default, matching thermal image BGR565 conversion */
-    /* Allocate draw buffers in PSRAM */
-    p_GUITask_State->DisplayBuffer1 = heap_caps_malloc(GUI_DRAW_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
-    p_GUITask_State->DisplayBuffer2 = heap_caps_malloc(GUI_DRAW_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
-    ESP_LOGD(TAG, "Allocated LVGL buffers: %d bytes each in PSRAM", GUI_DRAW_BUFFER_SIZE);
+    p_GUITask_State->DisplayBuffer1 = GUI_Helper_AllocDrawBuffer();
+    p_GUITask_State->DisplayBuffer2 = GUI_Helper_AllocDrawBuffer();
     if ((p_GUITask_State->DisplayBuffer1 == NULL) || (p_GUITask_State->DisplayBuffer2 == NULL)) {
         ESP_LOGE(TAG, "Failed to allocate LVGL draw buffers!");
         return ESP_ERR_NO_MEM;
@@ -183,6 +310,19 @@ esp_err_t GUI_Helper_Init(GUI_Task_State_t *p_GUITask_State, lv_indev_read_cb_t
     }
 
     ESP_LOGD(TAG, "Initialize touch controller XPT2046");
+#ifdef GUI_TOUCH_USE_IRQ
+    /* The ISR service may already be installed by the SD card detection */
+    esp_err_t Error = gpio_install_isr_service(0);
+    if ((Error != ESP_OK) && (Error != ESP_ERR_INVALID_STATE)) {
+        ESP_LOGE(TAG, "Failed to install GPIO ISR service: %d!", Error);
+        return Error;
+    }
+
+    p_GUITask_State->isTouchPending = false;
+    p_GUITask_State->isTouched = false;
+    _GUI_Touch_Config.interrupt_callback = GUI_Touch_ISR;
+    _GUI_Touch_Config.user_data = p_GUITask_State;
+#endif
     ESP_ERROR_CHECK(esp_lcd_new_panel_io_spi(static_cast<esp_lcd_spi_bus_handle_t>(LCD_SPI_HOST), &_GUI_Touch_IO_Config,
                                              &p_GUITask_State->Touch_IO_Handle));
     ESP_ERROR_CHECK(esp_lcd_touch_new_spi_xpt2046(p_GUITask_State->Touch_IO_Handle, &_GUI_Touch_Config,
@@ -211,9 +351,8 @@ esp_err_t GUI_Helper_Init(GUI_Task_State_t *p_GUITask_State, lv_indev_read_cb_t
     /* Create LVGL clock update timer. Use a 100 ms interval for smoother updates */
     p_GUITask_State->UpdateTimer[0] = lv_timer_create(GUI_Helper_Timer_ClockUpdate, 100, NULL);
 
-    p_GUITask_State->UpdateTimer[1] = lv_timer_create(GUI_Helper_Timer_SpotUpdate, 2000, NULL);
-    p_GUITask_State->UpdateTimer[2] = lv_timer_create(GUI_Helper_Timer_SpotmeterUpdate, 5000, NULL);
-    p_GUITask_State->UpdateTimer[3] = lv_timer_create(GUI_Helper_Timer_SceneStatisticsUpdate, 5000, NULL);
+    p_GUITask_State->UpdateTimer[1] = lv_timer_create(GUI_Helper_Timer_SpotmeterUpdate, 5000, NULL);
+    p_GUITask_State->UpdateTimer[2] = lv_timer_create(GUI_Helper_Timer_SceneStatisticsUpdate, 5000, NULL);
 
     _lock_init(&p_GUITask_State->LVGL_API_Lock);
 
@@ -257,12 +396,12 @@ void GUI_Helper_Deinit(GUI_Task_State_t *p_GUITask_State)
     }
 
     if (p_GUITask_State->DisplayBuffer1 != NULL) {
-        heap_caps_free(p_GUITask_State->DisplayBuffer1);
+        MemoryPlan_Free(p_GUITask_State->DisplayBuffer1);
         p_GUITask_State->DisplayBuffer1 = NULL;
     }
 
     if (p_GUITask_State->DisplayBuffer2 != NULL) {
-        heap_caps_free(p_GUITask_State->DisplayBuffer2);
+        MemoryPlan_Free(p_GUITask_State->DisplayBuffer2);
         p_GUITask_State->DisplayBuffer2 = NULL;
     }
 
@@ -276,9 +415,192 @@ void GUI_Helper_Deinit(GUI_Task_State_t *p_GUITask_State)
         p_GUITask_State->PanelHandle = NULL;
     }
 
+#ifdef CONFIG_LCD_FLUSH_ASYNC
+    if (_GUI_FlushDone != NULL) {
+        vSemaphoreDelete(_GUI_FlushDone);
+        _GUI_FlushDone = NULL;
+    }
+
+#ifdef CONFIG_GUI_THERMAL_DIRECT
+    if (_GUI_BlitDone != NULL) {
+        vSemaphoreDelete(_GUI_BlitDone);
+        _GUI_BlitDone = NULL;
+    }
+#endif
+#endif
+
     _lock_close(&p_GUITask_State->LVGL_API_Lock);
 }
 
+void GUI_Helper_SetDisplayPower(GUI_Task_State_t *p_GUITask_State, bool Enable)
+{
+    if (p_GUITask_State->isDisplayOn == Enable) {
+        return;
+    }
+
+    if (Enable) {
+        esp_lcd_panel_disp_on_off(p_GUITask_State->PanelHandle, true);
+        lv_display_enable_invalidation(p_GUITask_State->Display, true);
+        lv_obj_invalidate(lv_screen_active());
+        lv_obj_invalidate(lv_layer_top());
+
+#if CONFIG_LCD_BL >= 0
+        gpio_set_level(static_cast<gpio_num_t>(CONFIG_LCD_BL), LCD_BK_LIGHT_ON_LEVEL);
+#endif
+    } else {
+#if CONFIG_LCD_BL >= 0
+        gpio_set_level(static_cast<gpio_num_t>(CONFIG_LCD_BL), !LCD_BK_LIGHT_ON_LEVEL);
+#endif
+
+        lv_display_enable_invalidation(p_GUITask_State->Display, false);
+        esp_lcd_panel_disp_on_off(p_GUITask_State->PanelHandle, false);
+    }
+
+    p_GUITask_State->isDisplayOn = Enable;
+
+    ESP_LOGD(TAG, "Display %s", Enable ? "on" : "off");
+}
+
+#ifdef CONFIG_GUI_THERMAL_DIRECT
+/** @brief          Invalidate the children of the thermal image, so LVGL only draws the overlays on top of the
+ *                  transferred image. Frames with a transparent background only invalidate their border.
+ *  @param p_Parent Parent object
+ */
+static void GUI_Helper_InvalidateOverlays(lv_obj_t *p_Parent)
+{
+    for (uint32_t i = 0; i < lv_obj_get_child_count(p_Parent); i++) {
+        lv_obj_t *p_Child = lv_obj_get_child(p_Parent, i);
+        lv_area_t Area;
+        lv_area_t Strip;
+        int32_t Border;
+        bool isTransparent;
+
+        if (lv_obj_has_flag(p_Child, LV_OBJ_FLAG_HIDDEN)) {
+            continue;
+        }
+
+        lv_obj_get_coords(p_Child, &Area);
+        Border = lv_obj_get_style_border_width(p_Child, LV_PART_MAIN);
+        isTransparent = (lv_obj_get_style_bg_opa(p_Child, LV_PART_MAIN) == LV_OPA_TRANSP);
+
+        if (isTransparent && (Border == 0) && (lv_obj_get_child_count(p_Child) > 0)) {
+            /* Layout container, only its content is drawn */
+            GUI_Helper_InvalidateOverlays(p_Child);
+        } else if (isTransparent && (Border > 0) && (lv_obj_get_child_count(p_Child) == 0) &&
+                   (lv_area_get_width(&Area) > (2 * Border)) && (lv_area_get_height(&Area) > (2 * Border))) {
+            /* ROI frame */
+            Strip = Area;
+            Strip.y2 = Area.y1 + Border - 1;
+            lv_obj_invalidate_area(p_Child, &Strip);
+
+            Strip = Area;
+            Strip.y1 = Area.y2 - Border + 1;
+            lv_obj_invalidate_area(p_Child, &Strip);
+
+            Strip = Area;
+            Strip.x2 = Area.x1 + Border - 1;
+            lv_obj_invalidate_area(p_Child, &Strip);
+
+            Strip = Area;
+            Strip.x1 = Area.x2 - Border + 1;
+            lv_obj_invalidate_area(p_Child, &Strip);
+        } else {
+            lv_obj_invalidate(p_Child);
+        }
+    }
+}
+
+esp_err_t GUI_Helper_BlitThermal(GUI_Task_State_t *p_GUITask_State)
+{
+    lv_area_t Area;
+    esp_err_t Error;
+
+    /* Menus, message boxes and screen changes cover the image and are only drawn by LVGL */
+    if ((lv_screen_active() != ui_Main) || (lv_obj_get_child_count(lv_layer_top()) > 0) ||
+        lv_obj_has_flag(ui_Image_Thermal, LV_OBJ_FLAG_HIDDEN)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    lv_obj_get_coords(ui_Image_Thermal, &Area);
+    if ((lv_area_get_width(&Area) != static_cast<int32_t>(p_GUITask_State->ThermalImageDescriptor.header.w)) ||
+        (lv_area_get_height(&Area) != static_cast<int32_t>(p_GUITask_State->ThermalImageDescriptor.header.h)) ||
+        (Area.x1 < 0) || (Area.y1 < 0) || (Area.x2 >= CONFIG_GUI_WIDTH) || (Area.y2 >= CONFIG_GUI_HEIGHT)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+#ifdef CONFIG_LCD_FLUSH_ASYNC
+    /* Keep the completions in order, the interrupt can only tell the blit apart when no flush is in between */
+    while (_GUI_isFlushing) {
+        if (xSemaphoreTake(_GUI_FlushDone, GUI_FLUSH_TIMEOUT_MS / portTICK_PERIOD_MS) != pdTRUE) {
+            ESP_LOGW(TAG, "Flush timeout!");
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+
+    if (_GUI_isBlitting && (xSemaphoreTake(_GUI_BlitDone, GUI_FLUSH_TIMEOUT_MS / portTICK_PERIOD_MS) != pdTRUE)) {
+        ESP_LOGW(TAG, "Blit timeout!");
+        return ESP_ERR_TIMEOUT;
+    }
+
+    xSemaphoreTake(_GUI_BlitDone, 0);
+    _GUI_isBlitting = true;
+#endif
+
+    /* The SPI driver copies the PSRAM canvas into DMA buffers when the transfer is queued, so the next frame can be
+       scaled into the canvas while the transfer is running */
+    Error = esp_lcd_panel_draw_bitmap(p_GUITask_State->PanelHandle, Area.x1, Area.y1, Area.x2 + 1, Area.y2 + 1,
+                                      p_GUITask_State->ThermalCanvasBuffer);
+    if (Error != ESP_OK) {
+#ifdef CONFIG_LCD_FLUSH_ASYNC
+        _GUI_isBlitting = false;
+#endif
+        ESP_LOGW(TAG, "Thermal image transfer failed: %d", Error);
+        return Error;
+    }
+
+    GUI_Helper_InvalidateOverlays(ui_Image_Thermal);
+
+    return ESP_OK;
+}
+#endif
+
+#ifdef BENCHMARK
+esp_err_t GUI_Helper_FlushCanvas(GUI_Task_State_t *p_GUITask_State)
+{
+    esp_err_t Error;
+
+    if ((p_GUITask_State == NULL) || (p_GUITask_State->ThermalCanvasBuffer == NULL)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+#ifdef CONFIG_LCD_FLUSH_ASYNC
+    /* Completed by GUI_LCD_FlushDone_CB like a LVGL flush, LVGL is not rendering while the benchmark runs */
+    xSemaphoreTake(_GUI_FlushDone, 0);
+    _GUI_isFlushing = true;
+#endif
+
+    Error = esp_lcd_panel_draw_bitmap(p_GUITask_State->PanelHandle, 0, 0,
+                                      p_GUITask_State->ThermalImageDescriptor.header.w,
+                                      p_GUITask_State->ThermalImageDescriptor.header.h,
+                                      p_GUITask_State->ThermalCanvasBuffer);
+    if (Error != ESP_OK) {
+#ifdef CONFIG_LCD_FLUSH_ASYNC
+        _GUI_isFlushing = false;
+#endif
+        return Error;
+    }
+
+#ifdef CONFIG_LCD_FLUSH_ASYNC
+    if (xSemaphoreTake(_GUI_FlushDone, GUI_FLUSH_TIMEOUT_MS / portTICK_PERIOD_MS) != pdTRUE) {
+        _GUI_isFlushing = false;
+        return ESP_ERR_TIMEOUT;
+    }
+#endif
+
+    return ESP_OK;
+}
+#endif
+
 void GUI_Helper_Timer_ClockUpdate(lv_timer_t *p_Timer)
 {
     char buf[9];
@@ -288,7 +610,7 @@ void GUI_Helper_Timer_ClockUpdate(lv_timer_t *p_Timer)
     TimeManager_GetTime(&time_now, NULL);
 
     snprintf(buf, sizeof(buf), "%02d:%02d:%02d", time_now.tm_hour, time_now.tm_min, time_now.tm_sec);
-    lv_label_set_text(ui_Label_Main_Time, buf);
+    GUI_Widgets_SetText(ui_Label_Main_Time, buf);
 
     /* Broadcast telemetry to WebSocket clients if server is running */
     if (Server_isRunning()) {
@@ -296,35 +618,56 @@ void GUI_Helper_Timer_ClockUpdate(lv_timer_t *p_Timer)
     }
 }
 
-void GUI_Helper_Timer_SpotUpdate(lv_timer_t *p_Timer)
+void GUI_Helper_UpdatePixelTemperature(GUI_Task_State_t *p_GUITask_State, const FramePool_Frame_t *p_Frame)
 {
-    App_GUI_Screenposition_t ScreenPosition;
+    FramePool_Frame_t *Latest = NULL;
+    int32_t Width;
+    int32_t Height;
+    int32_t x;
+    int32_t y;
+
+    Width = lv_obj_get_width(ui_Image_Thermal);
+    Height = lv_obj_get_height(ui_Image_Thermal);
+    if ((Width <= 0) || (Height <= 0)) {
+        return;
+    }
 
-    /* Check if thermal image is initialized */
-    if ((lv_obj_get_width(ui_Image_Thermal) == 0) || (lv_obj_get_height(ui_Image_Thermal) == 0)) {
+    if (p_Frame == NULL) {
+        Latest = FramePool_GetLatest();
+        p_Frame = Latest;
+    }
+
+    if ((p_Frame == NULL) || (p_Frame->hasRAW == false)) {
+        FramePool_Release(Latest);
         return;
     }
 
-    /* Get crosshair position relative to its parent (ui_Image_Thermal) */
-    ScreenPosition.x = lv_obj_get_x(ui_Label_Main_Thermal_Crosshair) + lv_obj_get_width(
-                           ui_Label_Main_Thermal_Crosshair) / 2;
-    ScreenPosition.y = lv_obj_get_y(ui_Label_Main_Thermal_Crosshair) + lv_obj_get_height(
-                           ui_Label_Main_Thermal_Crosshair) / 2;
-    ScreenPosition.Width = lv_obj_get_width(ui_Image_Thermal);
-    ScreenPosition.Height = lv_obj_get_height(ui_Image_Thermal);
+    /* Center of the crosshair relative to its parent (ui_Image_Thermal) */
+    x = lv_obj_get_x(ui_Label_Main_Thermal_Crosshair) + (lv_obj_get_width(ui_Label_Main_Thermal_Crosshair) / 2);
+    y = lv_obj_get_y(ui_Label_Main_Thermal_Crosshair) + (lv_obj_get_height(ui_Label_Main_Thermal_Crosshair) / 2);
+
+    /* The thermal image is shown rotated by 180 degree */
+    x = (x * p_Frame->Width) / Width;
+    y = (y * p_Frame->Height) / Height;
+    x = (x < 0) ? 0 : ((x >= p_Frame->Width) ? (p_Frame->Width - 1) : x);
+    y = (y < 0) ? 0 : ((y >= p_Frame->Height) ? (p_Frame->Height - 1) : y);
+    x = p_Frame->Width - 1 - x;
+    y = p_Frame->Height - 1 - y;
+
+    p_GUITask_State->SpotTemperature = FrameStatistics_RawToCelsius(p_Frame->RAW[(y * p_Frame->Width) + x]);
 
-    ESP_LOGD(TAG, "Crosshair center in thermal canvas: (%d,%d), size (%d,%d)", ScreenPosition.x, ScreenPosition.y,
-             ScreenPosition.Width, ScreenPosition.Height);
+    FramePool_Release(Latest);
 
-    esp_event_post(GUI_EVENTS, GUI_EVENT_REQUEST_PIXEL_TEMPERATURE, &ScreenPosition, sizeof(ScreenPosition), portMAX_DELAY);
+    GUI_Widgets_SetValue(&p_GUITask_State->PixelTemperature, ui_Label_Main_Thermal_PixelTemperature,
+                         p_GUITask_State->SpotTemperature, GUI_WIDGETS_TEMP_HYSTERESIS, "%.2f °C");
 }
 
 void GUI_Helper_Timer_SpotmeterUpdate(lv_timer_t *p_Timer)
 {
-    esp_event_post(GUI_EVENTS, GUI_EVENT_REQUEST_SPOTMETER, NULL, 0, portMAX_DELAY);
+    Bus_Request(GUI_EVENT_REQUEST_SPOTMETER);
 }
 
 void GUI_Helper_Timer_SceneStatisticsUpdate(lv_timer_t *p_Timer)
 {
-    esp_event_post(GUI_EVENTS, GUI_EVENT_REQUEST_SCENE_STATISTICS, NULL, 0, portMAX_DELAY);
+    Bus_Request(GUI_EVENT_REQUEST_SCENE_STATISTICS);
 }
\ No newline at end of file
@@ -37,6 +37,12 @@
 #include <lvgl.h>
 
 #include "Application/application.h"
+#include "Application/Tasks/Lepton/paletteLUT.h"
+#include "Application/Tasks/Lepton/frameAGC.h"
+#include "Application/Tasks/Lepton/framePool.h"
+#include "imageScaler.h"
+#include "guiWidgets.h"
+#include "guiGradient.h"
 #include "Application/Manager/Network/networkTypes.h"
 
 #define STOP_REQUEST                        BIT0
@@ -49,11 +55,25 @@
 #define SD_CARD_MOUNT_ERROR                 BIT10
 #define LEPTON_UPTIME_READY                 BIT11
 #define LEPTON_TEMP_READY                   BIT12
-#define LEPTON_PIXEL_TEMPERATURE_READY      BIT13
 #define LEPTON_CAMERA_READY                 BIT4
 #define LEPTON_SPOTMETER_READY              BIT5
 #define LEPTON_SCENE_STATISTICS_READY       BIT6
 
+/* Events of the main loop. LEPTON_CAMERA_READY is only used by the splash screen */
+#define GUI_MAIN_EVENTS                     (STOP_REQUEST | BATTERY_VOLTAGE_READY | BATTERY_CHARGING_STATUS_READY | \
+                                             WIFI_CONNECTION_STATE_CHANGED | PROVISIONING_STATE_CHANGED | \
+                                             SD_CARD_STATE_CHANGED | SD_CARD_MOUNTED | SD_CARD_MOUNT_ERROR | \
+                                             LEPTON_UPTIME_READY | LEPTON_TEMP_READY | LEPTON_SPOTMETER_READY | \
+                                             LEPTON_SCENE_STATISTICS_READY)
+
+/* Touch reads are started by the pen down interrupt, so the IRQ pin of the touch controller is needed */
+#if defined(CONFIG_GUI_TOUCH_IRQ) && (CONFIG_TOUCH_IRQ >= 0)
+#define GUI_TOUCH_USE_IRQ
+#endif
+
+/* Longest sleep of the main loop when LVGL has no timer, so the task watchdog is fed */
+#define GUI_TASK_IDLE_MS                    500
+
 typedef struct {
     bool isInitialized;
     bool Running;
@@ -62,6 +82,9 @@ typedef struct {
     bool ProvisioningActive;
     bool RunTask;
     bool CardPresent;
+    bool isDisplayOn;                   /* false while the display is switched off by the timeout */
+    bool isThermalVisible;              /* The thermal image is shown, the GUI receives the camera frames */
+    uint16_t DisplayTimeout;            /* Display timeout in seconds, 0 to keep the display on */
     TaskHandle_t GUI_Handle;
     void *DisplayBuffer1;
     void *DisplayBuffer2;
@@ -73,8 +96,7 @@ typedef struct {
     lv_display_t *Display;
     lv_indev_t *Touch;
     lv_img_dsc_t ThermalImageDescriptor;
-    lv_img_dsc_t GradientImageDescriptor;
-    lv_timer_t *UpdateTimer[4];
+    lv_timer_t *UpdateTimer[3];
     _lock_t LVGL_API_Lock;
     App_Devices_Battery_t BatteryInfo;
     App_Lepton_ROI_Result_t ROIResult;
@@ -83,13 +105,33 @@ typedef struct {
     Network_IP_Info_t IP_Info;
     EventGroupHandle_t EventGroup;
     uint8_t *ThermalCanvasBuffer;
-    uint8_t *GradientCanvasBuffer;
-    uint8_t *NetworkRGBBuffer;          /* RGB888 buffer for network streaming (240x180x3) */
+    GUI_Gradient_t Gradient;            /* Pre-rendered gradient bars of all palettes */
+    Server_Palette_t Palette;           /* Palette of the thermal image and the gradient bar */
+    PaletteLUT_t ThermalLUT;            /* RAW14 to RGB565 lookup table for the thermal canvas */
+#ifdef CONFIG_GUI_THERMAL_RAW_LUT
+    FrameAGC_t ThermalAGC;              /* Software AGC of the lookup table */
+    uint8_t AGCMode;                    /* Requested AGC mode, only changed atomically */
+#ifdef CONFIG_LEPTON_ISOTHERMS
+    uint32_t IsothermRevision;          /* Revision of the bands in ThermalLUT */
+    bool isIsothermHidden;              /* true while the local contrast hides the bands */
+#endif
+#endif
+    ImageScaler_t ThermalScaler;        /* Scaler from the Lepton frame to the thermal canvas */
     uint32_t LeptonUptime;
     float SpotTemperature;
-
-    /* Network frame for server streaming */
-    Network_Thermal_Frame_t NetworkFrame;
+    GUI_Widgets_Value_t TempScaleMin;   /* Shown values of the temperature labels */
+    GUI_Widgets_Value_t TempScaleMax;
+    GUI_Widgets_Value_t PixelTemperature;
+    GUI_Widgets_Value_t SceneMin;
+    GUI_Widgets_Value_t SceneMax;
+    GUI_Widgets_Value_t SceneMean;
+    GUI_Widgets_Value_t FPA;
+    GUI_Widgets_Value_t AUX;
+
+#ifdef GUI_TOUCH_USE_IRQ
+    volatile bool isTouchPending;       /* Set by the pen down interrupt, cleared by the touch read callback */
+    bool isTouched;                     /* The last touch read found a point, keep reading until the release */
+#endif
 
 #ifdef CONFIG_GUI_TOUCH_DEBUG
     /* Touch debug visualization */
@@ -110,15 +152,48 @@ esp_err_t GUI_Helper_Init(GUI_Task_State_t *p_GUITask_State, lv_indev_read_cb_t
  */
 void GUI_Helper_Deinit(GUI_Task_State_t *p_GUITask_State);
 
+/** @brief                  Switch the display on or off. LVGL does not render while the display is off, the whole
+ *                          screen is redrawn when it is switched on again.
+ *  @param p_GUITask_State  Pointer to the GUI task state structure.
+ *  @param Enable           true to switch the display on
+ */
+void GUI_Helper_SetDisplayPower(GUI_Task_State_t *p_GUITask_State, bool Enable);
+
+#ifdef CONFIG_GUI_THERMAL_DIRECT
+/** @brief                  Send the thermal canvas directly to the display window of the thermal image and let LVGL
+ *                          only redraw the overlays on top of it. Must be called by the GUI task outside of
+ *                          lv_timer_handler().
+ *  @param p_GUITask_State  Pointer to the GUI task state structure.
+ *  @return                 ESP_OK on success
+ *                          ESP_ERR_INVALID_STATE if the image is covered and has to be drawn by LVGL
+ *                          ESP_ERR_INVALID_SIZE if the image widget does not match the canvas
+ *                          ESP_ERR_TIMEOUT if the previous transfer did not complete
+ */
+esp_err_t GUI_Helper_BlitThermal(GUI_Task_State_t *p_GUITask_State);
+#endif
+
+#ifdef BENCHMARK
+/** @brief                  Send the thermal canvas to the top left corner of the display and wait until the transfer
+ *                          is done. Only for the benchmark firmware, LVGL must not flush at the same time.
+ *  @param p_GUITask_State  Pointer to the GUI task state structure.
+ *  @return                 ESP_OK on success
+ *                          ESP_ERR_TIMEOUT if the transfer did not complete
+ */
+esp_err_t GUI_Helper_FlushCanvas(GUI_Task_State_t *p_GUITask_State);
+#endif
+
 /** @brief          LVGL timer callback to update the clock display.
  *  @param p_Timer  Pointer to the LVGL timer structure.
  */
 void GUI_Helper_Timer_ClockUpdate(lv_timer_t *p_Timer);
 
-/** @brief          LVGL timer callback to update the spotmeter display.
- *  @param p_Timer  Pointer to the LVGL timer structure.
+/** @brief                  Show the temperature of the pixel below the crosshair. The value is read from the RAW14
+ *                          data of the frame, so it follows a dragged crosshair and every new frame without a request
+ *                          to the Lepton task.
+ *  @param p_GUITask_State  Pointer to the GUI task state
+ *  @param p_Frame          Frame to read, NULL for the latest frame of the pool
  */
-void GUI_Helper_Timer_SpotUpdate(lv_timer_t *p_Timer);
+void GUI_Helper_UpdatePixelTemperature(GUI_Task_State_t *p_GUITask_State, const FramePool_Frame_t *p_Frame);
 
 /** @brief          LVGL timer callback to request spotmeter data update.
  *  @param p_Timer  Pointer to the LVGL timer structure.
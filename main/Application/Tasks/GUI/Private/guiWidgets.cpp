@@ -0,0 +1,98 @@
+/*
+ * guiWidgets.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Change aware label and style updates of the GUI task.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "guiWidgets.h"
+
+bool GUI_Widgets_SetText(lv_obj_t *p_Label, const char *p_Text)
+{
+    const char *p_Current;
+
+    if ((p_Label == NULL) || (p_Text == NULL)) {
+        return false;
+    }
+
+    /* lv_label_set_text always reallocates the text and invalidates the label, even for the same text */
+    p_Current = lv_label_get_text(p_Label);
+    if ((p_Current != NULL) && (strcmp(p_Current, p_Text) == 0)) {
+        return false;
+    }
+
+    lv_label_set_text(p_Label, p_Text);
+
+    return true;
+}
+
+bool GUI_Widgets_SetValue(GUI_Widgets_Value_t *p_Cache, lv_obj_t *p_Label, float Value, float Hysteresis,
+                          const char *p_Format)
+{
+    char Buffer[24];
+
+    if ((p_Cache == NULL) || (p_Format == NULL)) {
+        return false;
+    }
+
+    if (p_Cache->isValid && (fabsf(Value - p_Cache->Value) < Hysteresis)) {
+        return false;
+    }
+
+    p_Cache->Value = Value;
+    p_Cache->isValid = true;
+
+    snprintf(Buffer, sizeof(Buffer), p_Format, Value);
+
+    /* A change above the hysteresis can still be below the resolution of the format */
+    return GUI_Widgets_SetText(p_Label, Buffer);
+}
+
+void GUI_Widgets_Reset(GUI_Widgets_Value_t *p_Cache)
+{
+    if (p_Cache != NULL) {
+        p_Cache->isValid = false;
+    }
+}
+
+bool GUI_Widgets_SetBgColor(lv_obj_t *p_Object, lv_color_t Color)
+{
+    if ((p_Object == NULL) || lv_color_eq(lv_obj_get_style_bg_color(p_Object, LV_PART_MAIN), Color)) {
+        return false;
+    }
+
+    lv_obj_set_style_bg_color(p_Object, Color, 0);
+
+    return true;
+}
+
+bool GUI_Widgets_SetTextColor(lv_obj_t *p_Object, lv_color_t Color)
+{
+    if ((p_Object == NULL) || lv_color_eq(lv_obj_get_style_text_color(p_Object, LV_PART_MAIN), Color)) {
+        return false;
+    }
+
+    lv_obj_set_style_text_color(p_Object, Color, LV_PART_MAIN);
+
+    return true;
+}
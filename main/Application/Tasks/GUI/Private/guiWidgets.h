@@ -0,0 +1,83 @@
+/*
+ * guiWidgets.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Change aware label and style updates of the GUI task.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef GUI_WIDGETS_H_
+#define GUI_WIDGETS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <lvgl.h>
+
+#include <sdkconfig.h>
+
+/* Change of a temperature in °C before a label shows the new value */
+#define GUI_WIDGETS_TEMP_HYSTERESIS         (CONFIG_GUI_LABEL_HYSTERESIS / 100.0f)
+
+/** @brief Last value shown by a label with hysteresis.
+ */
+typedef struct {
+    bool isValid;                               /**< false until the first value is shown. */
+    float Value;                                /**< Shown value. */
+} GUI_Widgets_Value_t;
+
+/** @brief          Set the text of a label. The label is not touched, and nothing is redrawn, when the text is
+ *                  unchanged.
+ *  @param p_Label  Label object
+ *  @param p_Text   New text
+ *  @return         true if the label was changed
+ */
+bool GUI_Widgets_SetText(lv_obj_t *p_Label, const char *p_Text);
+
+/** @brief              Show a value in a label, formatted with printf. The value is only formatted when it moved by
+ *                      at least the hysteresis from the shown value, so noise does not redraw the label.
+ *  @param p_Cache      Last shown value of the label
+ *  @param p_Label      Label object
+ *  @param Value        New value
+ *  @param Hysteresis   Minimum change of the value
+ *  @param p_Format     printf format with a single floating point conversion
+ *  @return             true if the label was changed
+ */
+bool GUI_Widgets_SetValue(GUI_Widgets_Value_t *p_Cache, lv_obj_t *p_Label, float Value, float Hysteresis,
+                          const char *p_Format);
+
+/** @brief          Force the next GUI_Widgets_SetValue to show the value, e.g. after the label was recreated.
+ *  @param p_Cache  Last shown value of the label
+ */
+void GUI_Widgets_Reset(GUI_Widgets_Value_t *p_Cache);
+
+/** @brief          Set the background color of an object if it differs from the current one.
+ *  @param p_Object Object
+ *  @param Color    New color
+ *  @return         true if the style was changed
+ */
+bool GUI_Widgets_SetBgColor(lv_obj_t *p_Object, lv_color_t Color);
+
+/** @brief          Set the text color of an object if it differs from the current one.
+ *  @param p_Object Object
+ *  @param Color    New color
+ *  @return         true if the style was changed
+ */
+bool GUI_Widgets_SetTextColor(lv_obj_t *p_Object, lv_color_t Color);
+
+#endif /* GUI_WIDGETS_H_ */
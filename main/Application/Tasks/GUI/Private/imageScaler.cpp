@@ -0,0 +1,526 @@
+/*
+ * imageScaler.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Table driven bilinear scaler for the thermal canvas.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_attr.h>
+
+#ifdef CONFIG_GUI_SCALER_BENCHMARK
+#include <esp_timer.h>
+#endif
+
+#include <string.h>
+
+#include "imageScaler.h"
+
+#include "Application/Tasks/Lepton/pixelFormat.h"
+#include "Application/Memory/memoryPlan.h"
+
+static const char *TAG = "image_scaler";
+
+static void ImageScaler_SelectKernels(ImageScaler_t *p_Scaler);
+
+/** @brief          Free all tables of a scaler.
+ *  @param p_Scaler Pointer to the scaler
+ */
+static void ImageScaler_FreeTables(ImageScaler_t *p_Scaler)
+{
+    /* All tables are one block, starting with X0 */
+    MemoryPlan_Free(p_Scaler->X0);
+
+    memset(p_Scaler, 0, sizeof(ImageScaler_t));
+}
+
+/** @brief          Build the index and weight table for one axis. Uses the same 16.16 mapping as the
+ *                  former per pixel scaler, so the sample positions are unchanged.
+ *  @param Src      Source size of the axis
+ *  @param Dst      Destination size of the axis
+ *  @param isRotated true to build the table for a mirrored axis
+ *  @param p_Index  Index table output
+ *  @param p_Step   Step table output
+ *  @param p_Frac   Weight table output
+ */
+static void ImageScaler_BuildAxis(uint16_t Src, uint16_t Dst, bool isRotated, uint16_t *p_Index, uint8_t *p_Step,
+                                  uint8_t *p_Frac)
+{
+    uint32_t Ratio = ((Src - 1) << 16) / Dst;
+
+    for (uint32_t i = 0; i < Dst; i++) {
+        uint32_t Position;
+        uint32_t Fixed;
+        uint32_t Index;
+
+        Position = isRotated ? (Dst - 1 - i) : i;
+        Fixed = Position * Ratio;
+        Index = Fixed >> 16;
+
+        p_Index[i] = Index;
+        p_Step[i] = ((Index + 1) < Src) ? 1 : 0;
+        p_Frac[i] = (Fixed >> 8) & 0xFF;
+    }
+}
+
+esp_err_t ImageScaler_Configure(ImageScaler_t *p_Scaler, uint16_t SrcWidth, uint16_t SrcHeight, uint16_t DstWidth,
+                                uint16_t DstHeight, bool isRotated)
+{
+    uint16_t *p_Rows;
+
+    if ((p_Scaler == NULL) || (SrcWidth < 2) || (SrcHeight < 2) || (DstWidth == 0) || (DstHeight == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (p_Scaler->isInitialized && (p_Scaler->SrcWidth == SrcWidth) && (p_Scaler->SrcHeight == SrcHeight) &&
+        (p_Scaler->DstWidth == DstWidth) && (p_Scaler->DstHeight == DstHeight) && (p_Scaler->isRotated == isRotated)) {
+        return ESP_OK;
+    }
+
+    ImageScaler_FreeTables(p_Scaler);
+
+    /* The tables and the line buffers are read for every pixel, so they are placed in internal RAM. One block with
+       the 16 bit tables first keeps every table aligned */
+    p_Scaler->X0 = reinterpret_cast<uint16_t *>(MemoryPlan_Alloc(MEMORY_REGION_FAST,
+                                                                 ((1 + IMAGE_SCALER_BANDS * 6) * DstWidth + DstHeight) *
+                                                                 sizeof(uint16_t) + 2 * DstWidth + 2 * DstHeight,
+                                                                 "scaler_tables"));
+    if (p_Scaler->X0 == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate scaler tables!");
+        ImageScaler_FreeTables(p_Scaler);
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    p_Scaler->Y0 = p_Scaler->X0 + DstWidth;
+    p_Rows = p_Scaler->Y0 + DstHeight;
+    for (uint8_t i = 0; i < IMAGE_SCALER_BANDS; i++) {
+        ImageScaler_Band_t *p_Band = &p_Scaler->Bands[i];
+
+        p_Band->Rows[0] = p_Rows;
+        p_Band->Rows[1] = p_Rows + 3 * DstWidth;
+        p_Band->RowIndex[0] = -1;
+        p_Band->RowIndex[1] = -1;
+        p_Rows += 6 * DstWidth;
+    }
+    p_Scaler->XStep = reinterpret_cast<uint8_t *>(p_Rows);
+    p_Scaler->XFrac = p_Scaler->XStep + DstWidth;
+    p_Scaler->YStep = p_Scaler->XFrac + DstWidth;
+    p_Scaler->YFrac = p_Scaler->YStep + DstHeight;
+
+    ImageScaler_BuildAxis(SrcWidth, DstWidth, isRotated, p_Scaler->X0, p_Scaler->XStep, p_Scaler->XFrac);
+    ImageScaler_BuildAxis(SrcHeight, DstHeight, isRotated, p_Scaler->Y0, p_Scaler->YStep, p_Scaler->YFrac);
+
+    p_Scaler->SrcWidth = SrcWidth;
+    p_Scaler->SrcHeight = SrcHeight;
+    p_Scaler->DstWidth = DstWidth;
+    p_Scaler->DstHeight = DstHeight;
+    p_Scaler->isRotated = isRotated;
+    ImageScaler_SelectKernels(p_Scaler);
+    p_Scaler->isInitialized = true;
+
+    ESP_LOGD(TAG, "Scaler configured: %ux%u -> %ux%u%s, %s kernels", SrcWidth, SrcHeight, DstWidth, DstHeight,
+             isRotated ? " (rotated)" : "", p_Scaler->isSpecialized ? "fixed size" : "generic");
+
+    return ESP_OK;
+}
+
+void ImageScaler_Deinit(ImageScaler_t *p_Scaler)
+{
+    if ((p_Scaler == NULL) || (p_Scaler->isInitialized == false)) {
+        return;
+    }
+
+    ImageScaler_FreeTables(p_Scaler);
+}
+
+/** @brief          Get the slot for a horizontally scaled source row. A source row is scaled only once
+ *                  for all destination rows of a band that use it.
+ *  @param p_Band   Pointer to the rows of the band
+ *  @param Row      Source row
+ *  @param Keep     Source row that must not be evicted
+ *  @param p_Valid  Set to true when the slot already holds the row
+ *  @return         Slot index
+ */
+static inline uint8_t ImageScaler_GetRowSlot(ImageScaler_Band_t *p_Band, int32_t Row, int32_t Keep, bool *p_Valid)
+{
+    uint8_t Slot;
+
+    if (p_Band->RowIndex[0] == Row) {
+        *p_Valid = true;
+        return 0;
+    } else if (p_Band->RowIndex[1] == Row) {
+        *p_Valid = true;
+        return 1;
+    }
+
+    Slot = (p_Band->RowIndex[0] == Keep) ? 1 : 0;
+    p_Band->RowIndex[Slot] = Row;
+    *p_Valid = false;
+
+    return Slot;
+}
+
+/** @brief          Horizontally scale one RAW14 source row.
+ *  @tparam Width   Destination width, 0 for the width of the scaler
+ *  @param p_Scaler Pointer to the scaler
+ *  @param p_Src    Pointer to the source row
+ *  @param p_Out    Pointer to the output row (DstWidth entries)
+ */
+template <uint32_t Width>
+static inline __attribute__((always_inline)) void ImageScaler_RowRAW14(const ImageScaler_t *p_Scaler,
+                                                                       const uint16_t *p_Src, uint16_t *p_Out)
+{
+    const uint32_t DstWidth = (Width != 0) ? Width : p_Scaler->DstWidth;
+    const uint16_t *p_X0 = p_Scaler->X0;
+    const uint8_t *p_XStep = p_Scaler->XStep;
+    const uint8_t *p_XFrac = p_Scaler->XFrac;
+
+    for (uint32_t x = 0; x < DstWidth; x++) {
+        const uint16_t *p_Pixel = &p_Src[p_X0[x]];
+        uint32_t Frac = p_XFrac[x];
+
+        p_Out[x] = ((p_Pixel[0] * (256 - Frac)) + (p_Pixel[p_XStep[x]] * Frac)) >> 8;
+    }
+}
+
+/** @brief          Horizontally scale one RGB888 source row.
+ *  @tparam Width   Destination width, 0 for the width of the scaler
+ *  @param p_Scaler Pointer to the scaler
+ *  @param p_Src    Pointer to the source row
+ *  @param p_Out    Pointer to the output row (3 * DstWidth entries)
+ */
+template <uint32_t Width>
+static inline __attribute__((always_inline)) void ImageScaler_RowRGB888(const ImageScaler_t *p_Scaler,
+                                                                        const uint8_t *p_Src, uint16_t *p_Out)
+{
+    const uint32_t DstWidth = (Width != 0) ? Width : p_Scaler->DstWidth;
+    const uint16_t *p_X0 = p_Scaler->X0;
+    const uint8_t *p_XStep = p_Scaler->XStep;
+    const uint8_t *p_XFrac = p_Scaler->XFrac;
+
+    for (uint32_t x = 0; x < DstWidth; x++) {
+        const uint8_t *p_Left = &p_Src[p_X0[x] * 3];
+        const uint8_t *p_Right = p_Left + (p_XStep[x] * 3);
+        uint32_t Frac = p_XFrac[x];
+        uint32_t Inv = 256 - Frac;
+
+        /* Keep the 8 fractional bits for the vertical pass */
+        p_Out[0] = (p_Left[0] * Inv) + (p_Right[0] * Frac);
+        p_Out[1] = (p_Left[1] * Inv) + (p_Right[1] * Frac);
+        p_Out[2] = (p_Left[2] * Inv) + (p_Right[2] * Frac);
+        p_Out += 3;
+    }
+}
+
+/** @brief          Scale a band of a RAW14 frame and colorize it. A size of 0 is taken from the scaler at runtime,
+ *                  a fixed size gives the compiler constant strides and trip counts.
+ *  @tparam Stride  Source width
+ *  @tparam Width   Destination width
+ *  @param p_Scaler Pointer to the scaler
+ *  @param Band     Band index
+ *  @param First    First destination row
+ *  @param Count    Number of destination rows
+ *  @param p_Src    Source RAW14 frame
+ *  @param p_LUT    Pointer to the palette lookup table
+ *  @param p_Dst    RGB565 destination of the whole frame
+ */
+template <uint32_t Stride, uint32_t Width>
+static inline __attribute__((always_inline)) void ImageScaler_KernelRAW14(ImageScaler_t *p_Scaler, uint8_t Band,
+                                                                          uint32_t First, uint32_t Count,
+                                                                          const uint16_t *p_Src,
+                                                                          const PaletteLUT_t *p_LUT, uint16_t *p_Dst)
+{
+    const uint32_t SrcWidth = (Stride != 0) ? Stride : p_Scaler->SrcWidth;
+    const uint32_t DstWidth = (Width != 0) ? Width : p_Scaler->DstWidth;
+    ImageScaler_Band_t *p_Band = &p_Scaler->Bands[Band];
+
+    p_Dst += First * DstWidth;
+
+    for (uint32_t y = First; y < (First + Count); y++) {
+        int32_t Upper = p_Scaler->Y0[y];
+        int32_t Lower = Upper + p_Scaler->YStep[y];
+        uint32_t Frac = p_Scaler->YFrac[y];
+        uint32_t Inv = 256 - Frac;
+        const uint16_t *p_Upper;
+        const uint16_t *p_Lower;
+        uint8_t Slot;
+        bool isValid;
+
+        Slot = ImageScaler_GetRowSlot(p_Band, Upper, Lower, &isValid);
+        if (isValid == false) {
+            ImageScaler_RowRAW14<Width>(p_Scaler, &p_Src[Upper * SrcWidth], p_Band->Rows[Slot]);
+        }
+        p_Upper = p_Band->Rows[Slot];
+
+        if (Frac == 0) {
+            /* The destination row hits a source row, no vertical blend needed */
+            for (uint32_t x = 0; x < DstWidth; x++) {
+                p_Dst[x] = PaletteLUT_Map(p_LUT, p_Upper[x]);
+            }
+        } else {
+            Slot = ImageScaler_GetRowSlot(p_Band, Lower, Upper, &isValid);
+            if (isValid == false) {
+                ImageScaler_RowRAW14<Width>(p_Scaler, &p_Src[Lower * SrcWidth], p_Band->Rows[Slot]);
+            }
+            p_Lower = p_Band->Rows[Slot];
+
+            for (uint32_t x = 0; x < DstWidth; x++) {
+                p_Dst[x] = PaletteLUT_Map(p_LUT, ((p_Upper[x] * Inv) + (p_Lower[x] * Frac)) >> 8);
+            }
+        }
+
+        p_Dst += DstWidth;
+    }
+
+    /* The next frame has new content */
+    p_Band->RowIndex[0] = -1;
+    p_Band->RowIndex[1] = -1;
+}
+
+/** @brief          Scale a band of an RGB888 frame into RGB565. A size of 0 is taken from the scaler at runtime.
+ *  @tparam Stride  Source width
+ *  @tparam Width   Destination width
+ *  @param p_Scaler Pointer to the scaler
+ *  @param Band     Band index
+ *  @param First    First destination row
+ *  @param Count    Number of destination rows
+ *  @param p_Src    Source RGB888 frame
+ *  @param p_Dst    RGB565 destination of the whole frame
+ */
+template <uint32_t Stride, uint32_t Width>
+static inline __attribute__((always_inline)) void ImageScaler_KernelRGB888(ImageScaler_t *p_Scaler, uint8_t Band,
+                                                                           uint32_t First, uint32_t Count,
+                                                                           const uint8_t *p_Src, uint16_t *p_Dst)
+{
+    const uint32_t SrcWidth = (Stride != 0) ? Stride : p_Scaler->SrcWidth;
+    const uint32_t DstWidth = (Width != 0) ? Width : p_Scaler->DstWidth;
+    ImageScaler_Band_t *p_Band = &p_Scaler->Bands[Band];
+
+    p_Dst += First * DstWidth;
+
+    for (uint32_t y = First; y < (First + Count); y++) {
+        int32_t Upper = p_Scaler->Y0[y];
+        int32_t Lower = Upper + p_Scaler->YStep[y];
+        uint32_t Frac = p_Scaler->YFrac[y];
+        uint32_t Inv = 256 - Frac;
+        const uint16_t *p_Upper;
+        const uint16_t *p_Lower;
+        uint8_t Slot;
+        bool isValid;
+
+        Slot = ImageScaler_GetRowSlot(p_Band, Upper, Lower, &isValid);
+        if (isValid == false) {
+            ImageScaler_RowRGB888<Width>(p_Scaler, &p_Src[Upper * SrcWidth * 3], p_Band->Rows[Slot]);
+        }
+        p_Upper = p_Band->Rows[Slot];
+
+        Slot = ImageScaler_GetRowSlot(p_Band, Lower, Upper, &isValid);
+        if (isValid == false) {
+            ImageScaler_RowRGB888<Width>(p_Scaler, &p_Src[Lower * SrcWidth * 3], p_Band->Rows[Slot]);
+        }
+        p_Lower = p_Band->Rows[Slot];
+
+        for (uint32_t x = 0; x < DstWidth; x++) {
+            uint32_t r = ((p_Upper[0] * Inv) + (p_Lower[0] * Frac)) >> 16;
+            uint32_t g = ((p_Upper[1] * Inv) + (p_Lower[1] * Frac)) >> 16;
+            uint32_t b = ((p_Upper[2] * Inv) + (p_Lower[2] * Frac)) >> 16;
+
+            p_Dst[x] = PixelFormat_ToRGB565(r, g, b);
+            p_Upper += 3;
+            p_Lower += 3;
+        }
+
+        p_Dst += DstWidth;
+    }
+
+    p_Band->RowIndex[0] = -1;
+    p_Band->RowIndex[1] = -1;
+}
+
+/* Every kernel is a plain function in IRAM, the templates are inlined into them */
+static void IRAM_ATTR ImageScaler_RAW14_Generic(ImageScaler_t *p_Scaler, uint8_t Band, uint16_t First, uint16_t Count,
+                                                const uint16_t *p_Src, const PaletteLUT_t *p_LUT, uint16_t *p_Dst)
+{
+    ImageScaler_KernelRAW14<0, 0>(p_Scaler, Band, First, Count, p_Src, p_LUT, p_Dst);
+}
+
+static void IRAM_ATTR ImageScaler_RAW14_160x120(ImageScaler_t *p_Scaler, uint8_t Band, uint16_t First, uint16_t Count,
+                                                const uint16_t *p_Src, const PaletteLUT_t *p_LUT, uint16_t *p_Dst)
+{
+    ImageScaler_KernelRAW14<160, 240>(p_Scaler, Band, First, Count, p_Src, p_LUT, p_Dst);
+}
+
+static void IRAM_ATTR ImageScaler_RAW14_80x60(ImageScaler_t *p_Scaler, uint8_t Band, uint16_t First, uint16_t Count,
+                                              const uint16_t *p_Src, const PaletteLUT_t *p_LUT, uint16_t *p_Dst)
+{
+    ImageScaler_KernelRAW14<80, 240>(p_Scaler, Band, First, Count, p_Src, p_LUT, p_Dst);
+}
+
+static void IRAM_ATTR ImageScaler_RGB888_Generic(ImageScaler_t *p_Scaler, uint8_t Band, uint16_t First, uint16_t Count,
+                                                 const uint8_t *p_Src, uint16_t *p_Dst)
+{
+    ImageScaler_KernelRGB888<0, 0>(p_Scaler, Band, First, Count, p_Src, p_Dst);
+}
+
+static void IRAM_ATTR ImageScaler_RGB888_160x120(ImageScaler_t *p_Scaler, uint8_t Band, uint16_t First,
+                                                 uint16_t Count, const uint8_t *p_Src, uint16_t *p_Dst)
+{
+    ImageScaler_KernelRGB888<160, 240>(p_Scaler, Band, First, Count, p_Src, p_Dst);
+}
+
+static void IRAM_ATTR ImageScaler_RGB888_80x60(ImageScaler_t *p_Scaler, uint8_t Band, uint16_t First, uint16_t Count,
+                                               const uint8_t *p_Src, uint16_t *p_Dst)
+{
+    ImageScaler_KernelRGB888<80, 240>(p_Scaler, Band, First, Count, p_Src, p_Dst);
+}
+
+/** @brief Kernels with fixed sizes for the shipped geometries.
+ */
+typedef struct {
+    uint16_t SrcWidth;
+    uint16_t SrcHeight;
+    uint16_t DstWidth;
+    uint16_t DstHeight;
+    ImageScaler_RAW14_t RAW14;
+    ImageScaler_RGB888_t RGB888;
+} ImageScaler_Kernel_t;
+
+static const ImageScaler_Kernel_t _ImageScaler_Kernels[] = {
+    /* Lepton 3.x and 2.x on the thermal widget */
+    {160, 120, 240, 180, ImageScaler_RAW14_160x120, ImageScaler_RGB888_160x120},
+    {80, 60, 240, 180, ImageScaler_RAW14_80x60, ImageScaler_RGB888_80x60},
+};
+
+/** @brief          Select the kernels of the geometry of a scaler.
+ *  @param p_Scaler Pointer to the scaler
+ */
+static void ImageScaler_SelectKernels(ImageScaler_t *p_Scaler)
+{
+    p_Scaler->RAW14 = ImageScaler_RAW14_Generic;
+    p_Scaler->RGB888 = ImageScaler_RGB888_Generic;
+    p_Scaler->isSpecialized = false;
+
+    for (size_t i = 0; i < sizeof(_ImageScaler_Kernels) / sizeof(_ImageScaler_Kernels[0]); i++) {
+        const ImageScaler_Kernel_t *p_Kernel = &_ImageScaler_Kernels[i];
+
+        if ((p_Kernel->SrcWidth == p_Scaler->SrcWidth) && (p_Kernel->SrcHeight == p_Scaler->SrcHeight) &&
+            (p_Kernel->DstWidth == p_Scaler->DstWidth) && (p_Kernel->DstHeight == p_Scaler->DstHeight)) {
+            p_Scaler->RAW14 = p_Kernel->RAW14;
+            p_Scaler->RGB888 = p_Kernel->RGB888;
+            p_Scaler->isSpecialized = true;
+
+            break;
+        }
+    }
+}
+
+void IRAM_ATTR ImageScaler_ScaleRAW14(ImageScaler_t *p_Scaler, const uint16_t *p_Src, const PaletteLUT_t *p_LUT,
+                                      uint16_t *p_Dst)
+{
+    p_Scaler->RAW14(p_Scaler, 0, 0, p_Scaler->DstHeight, p_Src, p_LUT, p_Dst);
+}
+
+void IRAM_ATTR ImageScaler_ScaleRAW14Band(ImageScaler_t *p_Scaler, uint8_t Band, uint16_t First, uint16_t Count,
+                                          const uint16_t *p_Src, const PaletteLUT_t *p_LUT, uint16_t *p_Dst)
+{
+    p_Scaler->RAW14(p_Scaler, Band, First, Count, p_Src, p_LUT, p_Dst);
+}
+
+void IRAM_ATTR ImageScaler_ScaleRGB888(ImageScaler_t *p_Scaler, const uint8_t *p_Src, uint16_t *p_Dst)
+{
+    p_Scaler->RGB888(p_Scaler, 0, 0, p_Scaler->DstHeight, p_Src, p_Dst);
+}
+
+void IRAM_ATTR ImageScaler_ScaleRGB888Band(ImageScaler_t *p_Scaler, uint8_t Band, uint16_t First, uint16_t Count,
+                                           const uint8_t *p_Src, uint16_t *p_Dst)
+{
+    p_Scaler->RGB888(p_Scaler, Band, First, Count, p_Src, p_Dst);
+}
+
+#ifdef CONFIG_GUI_SCALER_BENCHMARK
+/** @brief          Reference: the former per pixel bilinear scaler of the GUI task (rotated by 180 degree).
+ *  @param p_Src    Source RGB888 frame
+ *  @param SrcW     Source width
+ *  @param SrcH     Source height
+ *  @param p_Dst    RGB565 destination
+ *  @param DstW     Destination width
+ *  @param DstH     Destination height
+ */
+static void ImageScaler_Reference(const uint8_t *p_Src, uint32_t SrcW, uint32_t SrcH, uint16_t *p_Dst, uint32_t DstW,
+                                  uint32_t DstH)
+{
+    uint32_t x_ratio = ((SrcW - 1) << 16) / DstW;
+    uint32_t y_ratio = ((SrcH - 1) << 16) / DstH;
+
+    for (uint32_t dst_y = 0; dst_y < DstH; dst_y++) {
+        uint32_t src_y_fixed = dst_y * y_ratio;
+        uint32_t y0 = src_y_fixed >> 16;
+        uint32_t y1 = (y0 + 1 < SrcH) ? y0 + 1 : y0;
+        uint32_t y_frac = (src_y_fixed >> 8) & 0xFF;
+        uint32_t y_inv = 256 - y_frac;
+
+        for (uint32_t dst_x = 0; dst_x < DstW; dst_x++) {
+            uint32_t src_x_fixed = dst_x * x_ratio;
+            uint32_t x0 = src_x_fixed >> 16;
+            uint32_t x1 = (x0 + 1 < SrcW) ? x0 + 1 : x0;
+            uint32_t x_frac = (src_x_fixed >> 8) & 0xFF;
+            uint32_t x_inv = 256 - x_frac;
+
+            uint32_t idx00 = (y0 * SrcW + x0) * 3;
+            uint32_t idx10 = (y0 * SrcW + x1) * 3;
+            uint32_t idx01 = (y1 * SrcW + x0) * 3;
+            uint32_t idx11 = (y1 * SrcW + x1) * 3;
+
+            uint32_t w00 = (x_inv * y_inv) >> 8;
+            uint32_t w10 = (x_frac * y_inv) >> 8;
+            uint32_t w01 = (x_inv * y_frac) >> 8;
+            uint32_t w11 = (x_frac * y_frac) >> 8;
+
+            uint32_t r = (p_Src[idx00 + 0] * w00 + p_Src[idx10 + 0] * w10 + p_Src[idx01 + 0] * w01 + p_Src[idx11 + 0] * w11) >> 8;
+            uint32_t g = (p_Src[idx00 + 1] * w00 + p_Src[idx10 + 1] * w10 + p_Src[idx01 + 1] * w01 + p_Src[idx11 + 1] * w11) >> 8;
+            uint32_t b = (p_Src[idx00 + 2] * w00 + p_Src[idx10 + 2] * w10 + p_Src[idx01 + 2] * w01 + p_Src[idx11 + 2] * w11) >> 8;
+
+            p_Dst[(DstH - 1 - dst_y) * DstW + (DstW - 1 - dst_x)] = PixelFormat_ToRGB565(r, g, b);
+        }
+    }
+}
+
+void ImageScaler_Benchmark(ImageScaler_t *p_Scaler, const uint8_t *p_Src, uint16_t *p_Dst)
+{
+    int64_t Start;
+    int64_t Reference;
+    int64_t Table;
+
+    if ((p_Scaler == NULL) || (p_Scaler->isInitialized == false) || (p_Src == NULL) || (p_Dst == NULL)) {
+        return;
+    }
+
+    Start = esp_timer_get_time();
+    ImageScaler_Reference(p_Src, p_Scaler->SrcWidth, p_Scaler->SrcHeight, p_Dst, p_Scaler->DstWidth, p_Scaler->DstHeight);
+    Reference = esp_timer_get_time() - Start;
+
+    Start = esp_timer_get_time();
+    ImageScaler_ScaleRGB888(p_Scaler, p_Src, p_Dst);
+    Table = esp_timer_get_time() - Start;
+
+    ESP_LOGI(TAG, "Scaler %ux%u -> %ux%u: per pixel %lld us, table driven %lld us per frame", p_Scaler->SrcWidth,
+             p_Scaler->SrcHeight, p_Scaler->DstWidth, p_Scaler->DstHeight, Reference, Table);
+}
+#endif
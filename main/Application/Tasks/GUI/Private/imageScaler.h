@@ -0,0 +1,151 @@
+/*
+ * imageScaler.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Table driven bilinear scaler for the thermal canvas.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef IMAGE_SCALER_H_
+#define IMAGE_SCALER_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "Application/Tasks/Lepton/paletteLUT.h"
+
+/** @brief Number of bands of a frame that can be scaled at the same time, e.g. one on each core.
+ */
+#define IMAGE_SCALER_BANDS                  2
+
+struct ImageScaler;
+
+/** @brief Scale kernel of a band of a RAW14 frame, see ImageScaler_ScaleRAW14Band.
+ */
+typedef void (*ImageScaler_RAW14_t)(struct ImageScaler *p_Scaler, uint8_t Band, uint16_t First, uint16_t Count,
+                                    const uint16_t *p_Src, const PaletteLUT_t *p_LUT, uint16_t *p_Dst);
+
+/** @brief Scale kernel of a band of an RGB888 frame, see ImageScaler_ScaleRGB888Band.
+ */
+typedef void (*ImageScaler_RGB888_t)(struct ImageScaler *p_Scaler, uint8_t Band, uint16_t First, uint16_t Count,
+                                     const uint8_t *p_Src, uint16_t *p_Dst);
+
+/** @brief Horizontally scaled source rows of a band. Every band has its own rows, so the bands of a frame can be
+ *         scaled in parallel.
+ */
+typedef struct {
+    uint16_t *Rows[2];                          /**< Horizontally scaled source rows (3 * DstWidth entries each). */
+    int32_t RowIndex[2];                        /**< Source row held by Rows, -1 when empty. */
+} ImageScaler_Band_t;
+
+/** @brief Bilinear scaler with precomputed index and weight tables for one source and destination geometry.
+ *         The optional 180 degree rotation is part of the tables, so the output is always written in order.
+ */
+typedef struct ImageScaler {
+    bool isInitialized;
+    bool isSpecialized;                         /**< true when the kernels are compiled for the geometry. */
+    bool isRotated;                             /**< true when the output is rotated by 180 degree. */
+    uint16_t SrcWidth;                          /**< Source width in pixels. */
+    uint16_t SrcHeight;                         /**< Source height in pixels. */
+    uint16_t DstWidth;                          /**< Destination width in pixels. */
+    uint16_t DstHeight;                         /**< Destination height in pixels. */
+    uint16_t *X0;                               /**< Left source column per destination column. */
+    uint8_t *XStep;                             /**< Offset of the right source column (0 or 1) per destination column. */
+    uint8_t *XFrac;                             /**< Weight of the right source column (0 to 255) per destination column. */
+    uint16_t *Y0;                               /**< Upper source row per destination row. */
+    uint8_t *YStep;                             /**< Offset of the lower source row (0 or 1) per destination row. */
+    uint8_t *YFrac;                             /**< Weight of the lower source row (0 to 255) per destination row. */
+    ImageScaler_Band_t Bands[IMAGE_SCALER_BANDS];
+    ImageScaler_RAW14_t RAW14;                  /**< RAW14 kernel of the geometry. */
+    ImageScaler_RGB888_t RGB888;                /**< RGB888 kernel of the geometry. */
+} ImageScaler_t;
+
+/** @brief              Build the tables for a geometry and select its kernels. The geometries of the Lepton 3.x
+ *                      (160x120) and 2.x (80x60) on the thermal widget (240x180) have kernels with fixed sizes,
+ *                      all others use the generic kernels. Does nothing when the geometry is unchanged.
+ *  @param p_Scaler     Pointer to the scaler
+ *  @param SrcWidth     Source width in pixels
+ *  @param SrcHeight    Source height in pixels
+ *  @param DstWidth     Destination width in pixels
+ *  @param DstHeight    Destination height in pixels
+ *  @param isRotated    true to rotate the output by 180 degree
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if a parameter is invalid
+ *                      ESP_ERR_NO_MEM if the tables can not be allocated
+ */
+esp_err_t ImageScaler_Configure(ImageScaler_t *p_Scaler, uint16_t SrcWidth, uint16_t SrcHeight, uint16_t DstWidth,
+                                uint16_t DstHeight, bool isRotated);
+
+/** @brief          Free the tables of a scaler.
+ *  @param p_Scaler Pointer to the scaler
+ */
+void ImageScaler_Deinit(ImageScaler_t *p_Scaler);
+
+/** @brief          Scale a RAW14 frame and colorize it through a palette lookup table.
+ *  @param p_Scaler Pointer to a configured scaler
+ *  @param p_Src    Source RAW14 frame (SrcWidth * SrcHeight)
+ *  @param p_LUT    Pointer to a valid palette lookup table
+ *  @param p_Dst    RGB565 destination (DstWidth * DstHeight)
+ */
+void ImageScaler_ScaleRAW14(ImageScaler_t *p_Scaler, const uint16_t *p_Src, const PaletteLUT_t *p_LUT, uint16_t *p_Dst);
+
+/** @brief          Scale and colorize a band of destination rows of a RAW14 frame. Different bands of the same
+ *                  frame can be scaled at the same time.
+ *  @param p_Scaler Pointer to a configured scaler
+ *  @param Band     Band index, 0 to IMAGE_SCALER_BANDS - 1
+ *  @param First    First destination row of the band
+ *  @param Count    Number of destination rows of the band
+ *  @param p_Src    Source RAW14 frame (SrcWidth * SrcHeight)
+ *  @param p_LUT    Pointer to a valid palette lookup table
+ *  @param p_Dst    RGB565 destination of the whole frame (DstWidth * DstHeight)
+ */
+void ImageScaler_ScaleRAW14Band(ImageScaler_t *p_Scaler, uint8_t Band, uint16_t First, uint16_t Count,
+                                const uint16_t *p_Src, const PaletteLUT_t *p_LUT, uint16_t *p_Dst);
+
+/** @brief          Scale an RGB888 frame into RGB565.
+ *  @param p_Scaler Pointer to a configured scaler
+ *  @param p_Src    Source RGB888 frame (SrcWidth * SrcHeight * 3)
+ *  @param p_Dst    RGB565 destination (DstWidth * DstHeight)
+ */
+void ImageScaler_ScaleRGB888(ImageScaler_t *p_Scaler, const uint8_t *p_Src, uint16_t *p_Dst);
+
+/** @brief          Scale a band of destination rows of an RGB888 frame into RGB565. Different bands of the same
+ *                  frame can be scaled at the same time.
+ *  @param p_Scaler Pointer to a configured scaler
+ *  @param Band     Band index, 0 to IMAGE_SCALER_BANDS - 1
+ *  @param First    First destination row of the band
+ *  @param Count    Number of destination rows of the band
+ *  @param p_Src    Source RGB888 frame (SrcWidth * SrcHeight * 3)
+ *  @param p_Dst    RGB565 destination of the whole frame (DstWidth * DstHeight)
+ */
+void ImageScaler_ScaleRGB888Band(ImageScaler_t *p_Scaler, uint8_t Band, uint16_t First, uint16_t Count,
+                                 const uint8_t *p_Src, uint16_t *p_Dst);
+
+#ifdef CONFIG_GUI_SCALER_BENCHMARK
+/** @brief          Compare the per pixel reference scaler with the table driven scaler on a frame and log
+ *                  the time per frame of both.
+ *  @param p_Scaler Pointer to a configured scaler
+ *  @param p_Src    Source RGB888 frame (SrcWidth * SrcHeight * 3)
+ *  @param p_Dst    RGB565 destination (DstWidth * DstHeight), overwritten by the benchmark
+ */
+void ImageScaler_Benchmark(ImageScaler_t *p_Scaler, const uint8_t *p_Src, uint16_t *p_Dst);
+#endif
+
+#endif /* IMAGE_SCALER_H_ */
@@ -26,6 +26,8 @@
 #include <esp_mac.h>
 #include <esp_efuse.h>
 
+#include <driver/gpio.h>
+
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
@@ -37,14 +39,35 @@
 #include "guiTask.h"
 #include "Export/ui.h"
 #include "Application/application.h"
+#include "Application/Boot/boot.h"
+#include "Application/Trace/trace.h"
+#include "Application/Memory/memoryPlan.h"
+#include "Application/Bus/messageBus.h"
 #include "Application/Manager/managers.h"
 #include "Application/Manager/Network/Server/server.h"
+#include "Application/Stripe/stripe.h"
+#include "Application/Topology/topology.h"
+#include "Application/Tasks/Lepton/frameProducts.h"
+#include "Application/Tasks/Lepton/frameLatency.h"
+#include "Application/Tasks/Lepton/isotherm.h"
 #include "Private/guiHelper.h"
+#include "Private/imageScaler.h"
+#include "Private/guiWidgets.h"
+#include "Private/guiAssets.h"
 
 #include "lepton.h"
 
 ESP_EVENT_DEFINE_BASE(GUI_EVENTS);
 
+/* Frame products the thermal image needs with every frame. The scaler benchmark also reads the RGB888 frame */
+#if defined(CONFIG_GUI_THERMAL_RAW_LUT) && !defined(CONFIG_GUI_SCALER_BENCHMARK)
+#define GUI_FRAME_PRODUCTS                  (FRAME_PRODUCT_RAW | FRAME_PRODUCT_STATISTICS)
+#elif defined(CONFIG_GUI_THERMAL_RAW_LUT)
+#define GUI_FRAME_PRODUCTS                  (FRAME_PRODUCT_RAW | FRAME_PRODUCT_STATISTICS | FRAME_PRODUCT_RGB)
+#else
+#define GUI_FRAME_PRODUCTS                  (FRAME_PRODUCT_RGB)
+#endif
+
 /* Touch calibration ranges (based on measurements)
  * Adjusted: RAW_X increased to shift touch point up
  */
@@ -53,10 +76,72 @@ const int16_t TOUCH_RAW_X_MAX = 281;
 const int16_t TOUCH_RAW_Y_MIN = 30;
 const int16_t TOUCH_RAW_Y_MAX = 234;
 
+/** @brief Topic of the bus and the event bit that wakes up the GUI task when it is published.
+ */
+typedef struct {
+    Bus_Topic_t Topic;
+    EventBits_t Bits;
+} GUI_Task_Topic_t;
+
+static const GUI_Task_Topic_t _GUITask_Topics[] = {
+    {BUS_TOPIC_LEPTON_DEVICE,               LEPTON_CAMERA_READY},
+    {BUS_TOPIC_LEPTON_TEMPERATURES,         LEPTON_TEMP_READY},
+    {BUS_TOPIC_LEPTON_UPTIME,               LEPTON_UPTIME_READY},
+    {BUS_TOPIC_LEPTON_SPOTMETER,            LEPTON_SPOTMETER_READY},
+    {BUS_TOPIC_LEPTON_SCENE_STATISTICS,     LEPTON_SCENE_STATISTICS_READY},
+    {BUS_TOPIC_BATTERY,                     BATTERY_VOLTAGE_READY},
+};
+
 static GUI_Task_State_t _GUITask_State;
 
 static const char *TAG = "gui_task";
 
+/** @brief Thermal frame that is scaled into the canvas, either the RAW14 frame with the table of the AGC or the
+ *         RGB888 frame.
+ */
+typedef struct {
+    ImageScaler_t *p_Scaler;
+    const uint16_t *p_RAW;
+    const PaletteLUT_t *p_LUT;
+    const uint8_t *p_RGB;
+    uint16_t *p_Dst;
+} GUI_Scale_Job_t;
+
+#ifdef CONFIG_STRIPE
+static_assert(IMAGE_SCALER_BANDS >= STRIPE_WORKERS, "Every stripe worker needs its own band of the scaler!");
+#endif
+
+/** @brief              Stripe kernel that scales a band of rows of the canvas.
+ *  @param p_Context    Pointer to the GUI_Scale_Job_t
+ *  @param Band         Band index
+ *  @param First        First row of the canvas
+ *  @param Count        Number of rows
+ */
+static void GUI_Scale_Band(void *p_Context, uint8_t Band, uint32_t First, uint32_t Count)
+{
+    GUI_Scale_Job_t *p_Job = static_cast<GUI_Scale_Job_t *>(p_Context);
+
+    if (p_Job->p_RAW != NULL) {
+        ImageScaler_ScaleRAW14Band(p_Job->p_Scaler, Band, First, Count, p_Job->p_RAW, p_Job->p_LUT, p_Job->p_Dst);
+    } else {
+        ImageScaler_ScaleRGB888Band(p_Job->p_Scaler, Band, First, Count, p_Job->p_RGB, p_Job->p_Dst);
+    }
+}
+
+/** @brief          Scale a thermal frame into the canvas. With the stripe executor the upper and the lower half of
+ *                  the canvas are scaled on both cores. The GUI task waits for both halves, so LVGL only gets the
+ *                  canvas back after the whole frame was written.
+ *  @param p_Job    Pointer to the frame
+ */
+static void GUI_Scale(GUI_Scale_Job_t *p_Job)
+{
+#ifdef CONFIG_STRIPE
+    Stripe_Run(GUI_Scale_Band, p_Job, p_Job->p_Scaler->DstHeight);
+#else
+    GUI_Scale_Band(p_Job, 0, 0, p_Job->p_Scaler->DstHeight);
+#endif
+}
+
 /** @brief
  *  @param p_HandlerArgs    Handler argument
  *  @param Base             Event base
@@ -68,13 +153,6 @@ static void on_Devices_Event_Handler(void *p_HandlerArgs, esp_event_base_t Base,
     ESP_LOGD(TAG, "Devices event received: ID=%d", ID);
 
     switch (ID) {
-        case DEVICE_EVENT_RESPONSE_BATTERY_VOLTAGE: {
-            memcpy(&_GUITask_State.BatteryInfo, p_Data, sizeof(App_Devices_Battery_t));
-
-            xEventGroupSetBits(_GUITask_State.EventGroup, BATTERY_VOLTAGE_READY);
-
-            break;
-        }
         case DEVICE_EVENT_RESPONSE_CHARGING: {
             memcpy(&_GUITask_State.ChargeStatus, p_Data, sizeof(bool));
 
@@ -172,10 +250,6 @@ static void on_Network_Event_Handler(void *p_HandlerArgs, esp_event_base_t Base,
             break;
         }
         case NETWORK_EVENT_SERVER_STARTED: {
-            /* Register thermal frame with server (called after server is started) */
-            Server_SetThermalFrame(&_GUITask_State.NetworkFrame);
-            ESP_LOGD(TAG, "Network frame registered with server");
-
             break;
         }
         case NETWORK_EVENT_AP_STA_CONNECTED: {
@@ -227,66 +301,61 @@ static void on_SD_Event_Handler(void *p_HandlerArgs, esp_event_base_t Base, int3
     }
 }
 
-/** @brief
+/** @brief                  Settings event handler. Takes over a changed display timeout.
  *  @param p_HandlerArgs    Handler argument
  *  @param Base             Event base
  *  @param ID               Event ID
  *  @param p_Data           Event-specific data
  */
-static void on_Lepton_Event_Handler(void *p_HandlerArgs, esp_event_base_t Base, int32_t ID, void *p_Data)
+static void on_Settings_Event_Handler(void *p_HandlerArgs, esp_event_base_t Base, int32_t ID, void *p_Data)
 {
-    ESP_LOGD(TAG, "Lepton event received: ID=%d", ID);
-
     switch (ID) {
-        case LEPTON_EVENT_CAMERA_READY: {
-            memcpy(&_GUITask_State.LeptonDeviceInfo, ((App_Lepton_Device_t *)p_Data), sizeof(App_Lepton_Device_t));
-
-            xEventGroupSetBits(_GUITask_State.EventGroup, LEPTON_CAMERA_READY);
+        case SETTINGS_EVENT_LOADED: {
+            _GUITask_State.DisplayTimeout = reinterpret_cast<App_Settings_t *>(p_Data)->Display.Timeout;
 
             break;
         }
-        case LEPTON_EVENT_CAMERA_ERROR: {
-            break;
-        }
-        case LEPTON_EVENT_RESPONSE_FPA_AUX_TEMP: {
-            memcpy(&_GUITask_State.LeptonTemperatures, p_Data, sizeof(App_Lepton_Temperatures_t));
-
-            xEventGroupSetBits(_GUITask_State.EventGroup, LEPTON_TEMP_READY);
+        case SETTINGS_EVENT_DISPLAY_CHANGED: {
+            _GUITask_State.DisplayTimeout = reinterpret_cast<App_Settings_Display_t *>(p_Data)->Timeout;
 
             break;
         }
-        case LEPTON_EVENT_RESPONSE_SPOTMETER: {
-            memcpy(&_GUITask_State.ROIResult, p_Data, sizeof(App_Lepton_ROI_Result_t));
-
-            xEventGroupSetBits(_GUITask_State.EventGroup, LEPTON_SPOTMETER_READY);
-
+        default: {
             break;
         }
-        case LEPTON_EVENT_RESPONSE_SCENE_STATISTICS: {
-            memcpy(&_GUITask_State.ROIResult, p_Data, sizeof(App_Lepton_ROI_Result_t));
-
-            xEventGroupSetBits(_GUITask_State.EventGroup, LEPTON_SCENE_STATISTICS_READY);
+    }
+}
 
-            break;
-        }
-        case LEPTON_EVENT_RESPONSE_UPTIME: {
-            memcpy(&_GUITask_State.LeptonUptime, p_Data, sizeof(uint32_t));
+/** @brief Switch the display off after the display timeout without touch input and on again with the next touch.
+ *         The camera frames are only received while the thermal image can be seen, the scaling is skipped
+ *         otherwise.
+ */
+static void GUI_Update_Visibility(void)
+{
+    uint32_t Inactive;
+    uint32_t Timeout;
+    bool isVisible;
 
-            xEventGroupSetBits(_GUITask_State.EventGroup, LEPTON_UPTIME_READY);
+    Inactive = lv_display_get_inactive_time(_GUITask_State.Display);
+    Timeout = _GUITask_State.DisplayTimeout * 1000UL;
 
-            break;
+    if (_GUITask_State.isDisplayOn) {
+        if ((Timeout > 0) && (Inactive >= Timeout)) {
+            GUI_Helper_SetDisplayPower(&_GUITask_State, false);
         }
-        case LEPTON_EVENT_RESPONSE_PIXEL_TEMPERATURE: {
-            memcpy(&_GUITask_State.SpotTemperature, p_Data, sizeof(float));
+    } else if ((Timeout == 0) || (Inactive < Timeout)) {
+        GUI_Helper_SetDisplayPower(&_GUITask_State, true);
 
-            xEventGroupSetBits(_GUITask_State.EventGroup, LEPTON_PIXEL_TEMPERATURE_READY);
+        /* The touch that wakes up the display must not click the widget below it */
+        lv_indev_wait_release(_GUITask_State.Touch);
+    }
 
-            break;
-        }
-        default: {
-            ESP_LOGW(TAG, "Unhandled Lepton event ID: %d", ID);
-            break;
-        }
+    isVisible = _GUITask_State.isDisplayOn && (lv_screen_active() == ui_Main);
+    if (isVisible != _GUITask_State.isThermalVisible) {
+        _GUITask_State.isThermalVisible = isVisible;
+        FrameProducts_Subscribe(FRAME_CONSUMER_DISPLAY, isVisible ? GUI_FRAME_PRODUCTS : 0);
+
+        ESP_LOGD(TAG, "Thermal image %s", isVisible ? "visible" : "hidden");
     }
 }
 
@@ -316,7 +385,8 @@ static void GUI_Update_ROI(App_Settings_ROI_t ROI)
 {
     int32_t DisplayWidth;
     int32_t DisplayHeight;
-    App_Settings_Lepton_t SettingsLepton;
+    App_Settings_ROI_t StoredROI;
+    Bus_Request_t Request;
 
     if ((ROI.x + ROI.w) > 160) {
         ROI.w = 160 - ROI.x;
@@ -388,26 +458,24 @@ static void GUI_Update_ROI(App_Settings_ROI_t ROI)
         }
     }
 
-    SettingsManager_GetLepton(&SettingsLepton);
+    SettingsManager_GetROI(ROI.Type, &StoredROI);
 
     /* Check if an update is required */
-    if (SettingsLepton.ROI[ROI.Type].x == ROI.x &&
-        SettingsLepton.ROI[ROI.Type].y == ROI.y &&
-        SettingsLepton.ROI[ROI.Type].w == ROI.w &&
-        SettingsLepton.ROI[ROI.Type].h == ROI.h) {
+    if (StoredROI.x == ROI.x &&
+        StoredROI.y == ROI.y &&
+        StoredROI.w == ROI.w &&
+        StoredROI.h == ROI.h) {
         ESP_LOGW(TAG, "ROI unchanged, not updating NVS");
         return;
     }
 
-    /* Copy the new ROI in the existing settings structure */
-    memcpy(&SettingsLepton.ROI[ROI.Type], &ROI, sizeof(App_Settings_ROI_t));
-
-    /* Save the new ROI to NVS */
-    SettingsManager_UpdateLepton(&SettingsLepton);
-    SettingsManager_Save();
+    /* Store the new ROI. The Settings Manager writes it to the NVS once the ROI drag has finished. */
+    SettingsManager_UpdateROI(&ROI);
 
     /* The Lepton task needs the ROI with the Lepton coordinates */
-    SettingsLepton.ROI[ROI.Type] = {
+    memset(&Request, 0, sizeof(Request));
+    Request.ID = GUI_EVENT_REQUEST_ROI;
+    Request.Data.ROI = {
         .Type = ROI.Type,
         .x = (uint16_t)ROI.x,
         .y = (uint16_t)ROI.y,
@@ -415,62 +483,149 @@ static void GUI_Update_ROI(App_Settings_ROI_t ROI)
         .h = (uint16_t)ROI.h
     };
 
-    esp_event_post(GUI_EVENTS, GUI_EVENT_REQUEST_ROI, &SettingsLepton.ROI[ROI.Type], sizeof(App_Settings_ROI_t),
-                   portMAX_DELAY);
+    Bus_Send(BUS_CHANNEL_LEPTON_REQUEST, &Request);
 }
 
-/** @brief Create temperature gradient canvas for palette visualization.
- *         Generates a vertical gradient from hot (top) to cold (bottom).
+/** @brief          Switch the palette of the thermal image. The gradient bar is pre-rendered, so only the image
+ *                  source is swapped. The thermal lookup table follows with the next frame.
+ *  @param Palette  New palette
  */
-static void UI_Canvas_AddTempGradient(void)
+static void GUI_Set_Palette(Server_Palette_t Palette)
 {
-    /* Generate gradient pixel by pixel */
-    uint16_t *buffer = (uint16_t *)_GUITask_State.GradientCanvasBuffer;
-
-    for (uint32_t y = 0; y < _GUITask_State.GradientImageDescriptor.header.h; y++) {
-        uint32_t index;
-
-        /* Map y position to palette index (0 = top/hot = white, 179 = bottom/cold = black)
-         * Iron palette: index 0 = black (cold), index 255 = white (hot)
-         * So we need to invert: top (y=0) should be index 255, bottom (y=179) should be index 0
-         */
-        index = 255 - (y * 255 / (_GUITask_State.GradientImageDescriptor.header.h - 1));
-
-        /* Get RGB888 values from palette */
-        uint8_t r8 = Lepton_Palette_Iron[index][0];
-        uint8_t g8 = Lepton_Palette_Iron[index][1];
-        uint8_t b8 = Lepton_Palette_Iron[index][2];
-
-        /* Convert RGB888 to RGB565 */
-        uint16_t r5 = (r8 >> 3) & 0x1F;
-        uint16_t g6 = (g8 >> 2) & 0x3F;
-        uint16_t b5 = (b8 >> 3) & 0x1F;
-
-        /* Fill entire row with same color */
-        for (uint32_t x = 0; x < _GUITask_State.GradientImageDescriptor.header.w; x++) {
-            buffer[y * _GUITask_State.GradientImageDescriptor.header.w + x] = (r5 << 11) | (g6 << 5) | b5;
+    if (Palette >= PALETTE_COUNT) {
+        return;
+    }
+
+    _GUITask_State.Palette = Palette;
+    lv_img_set_src(ui_Image_Gradient, GUI_Gradient_GetImage(&_GUITask_State.Gradient, Palette));
+
+    ESP_LOGD(TAG, "Palette %u", Palette);
+}
+
+/** @brief      Click handler of the gradient bar. Cycles through the palettes.
+ *  @param e    LVGL event
+ */
+static void on_Gradient_Clicked(lv_event_t *e)
+{
+    GUI_Set_Palette(static_cast<Server_Palette_t>((_GUITask_State.Palette + 1) % PALETTE_COUNT));
+}
+
+/** @brief      Press handler of the thermal image. Moves the crosshair to the touch point and shows the temperature
+ *              of the pixel below it immediately.
+ *  @param e    LVGL event
+ */
+static void on_Thermal_Pressing(lv_event_t *e)
+{
+    lv_point_t Point;
+    lv_area_t Area;
+    int32_t x;
+    int32_t y;
+
+    lv_indev_get_point(lv_indev_active(), &Point);
+    lv_obj_get_coords(ui_Image_Thermal, &Area);
+
+    x = Point.x - Area.x1;
+    y = Point.y - Area.y1;
+    x = (x < 0) ? 0 : ((x >= lv_area_get_width(&Area)) ? (lv_area_get_width(&Area) - 1) : x);
+    y = (y < 0) ? 0 : ((y >= lv_area_get_height(&Area)) ? (lv_area_get_height(&Area) - 1) : y);
+
+    lv_obj_align(ui_Label_Main_Thermal_Crosshair, LV_ALIGN_TOP_LEFT,
+                 x - (lv_obj_get_width(ui_Label_Main_Thermal_Crosshair) / 2),
+                 y - (lv_obj_get_height(ui_Label_Main_Thermal_Crosshair) / 2));
+
+    /* The new position is only applied with the next refresh otherwise */
+    lv_obj_update_layout(ui_Label_Main_Thermal_Crosshair);
+
+    GUI_Helper_UpdatePixelTemperature(&_GUITask_State, NULL);
+}
+
+/** @brief          Sort a few touch samples in place.
+ *  @param p_Values Samples
+ *  @param Count    Number of samples
+ */
+static void XPT2046_Sort(uint16_t *p_Values, uint8_t Count)
+{
+    for (uint8_t i = 1; i < Count; i++) {
+        uint16_t Value = p_Values[i];
+        uint8_t j = i;
+
+        while ((j > 0) && (p_Values[j - 1] > Value)) {
+            p_Values[j] = p_Values[j - 1];
+            j--;
+        }
+
+        p_Values[j] = Value;
+    }
+}
+
+/** @brief          Read CONFIG_GUI_TOUCH_SAMPLES samples from the touch controller and filter them with a median per
+ *                  axis. A single outlier of the resistive panel does not move a dragged object.
+ *  @param Touch    Touch handle
+ *  @param p_X      Filtered raw X coordinate
+ *  @param p_Y      Filtered raw Y coordinate
+ *  @return         true if the panel is touched
+ */
+static bool XPT2046_Sample(esp_lcd_touch_handle_t Touch, uint16_t *p_X, uint16_t *p_Y)
+{
+    uint16_t X[CONFIG_GUI_TOUCH_SAMPLES];
+    uint16_t Y[CONFIG_GUI_TOUCH_SAMPLES];
+    uint8_t Valid = 0;
+
+    for (uint8_t i = 0; i < CONFIG_GUI_TOUCH_SAMPLES; i++) {
+        esp_lcd_touch_point_data_t Data[1];
+        uint8_t Count = 0;
+
+        esp_lcd_touch_read_data(Touch);
+        if ((esp_lcd_touch_get_data(Touch, Data, &Count, sizeof(Data) / sizeof(Data[0])) == ESP_OK) && (Count > 0)) {
+            X[Valid] = Data[0].x;
+            Y[Valid] = Data[0].y;
+            Valid++;
+        } else if (Valid == 0) {
+            /* Released, the remaining samples would only occupy the SPI bus */
+            return false;
         }
     }
+
+    XPT2046_Sort(X, Valid);
+    XPT2046_Sort(Y, Valid);
+
+    *p_X = X[Valid / 2];
+    *p_Y = Y[Valid / 2];
+
+    return true;
 }
 
 /** @brief LVGL touch read callback for XPT2046 touch controller.
  */
 static void XPT2046_LVGL_ReadCallback(lv_indev_t *p_Indev, lv_indev_data_t *p_Data)
 {
-    uint8_t Count = 0;
-    esp_lcd_touch_point_data_t Data[1];
     esp_lcd_touch_handle_t Touch;
-    esp_err_t Error;
+    uint16_t raw_x;
+    uint16_t raw_y;
+    bool isTouched;
 
     Touch = (esp_lcd_touch_handle_t)lv_indev_get_user_data(p_Indev);
-    esp_lcd_touch_read_data(Touch);
 
-    Error = esp_lcd_touch_get_data(Touch, Data, &Count, sizeof(Data) / sizeof(Data[0]));
+#ifdef GUI_TOUCH_USE_IRQ
+    /* Without a pen down interrupt or a held pen the panel is not touched, the shared SPI bus stays free for the
+       display. The line is low while the pen is down, this also catches an interrupt lost during the last read */
+    if ((_GUITask_State.isTouched == false) && (_GUITask_State.isTouchPending == false) &&
+        (gpio_get_level(static_cast<gpio_num_t>(CONFIG_TOUCH_IRQ)) != 0)) {
+        p_Data->state = LV_INDEV_STATE_RELEASED;
+
+        return;
+    }
+#endif
 
-    if ((Error == ESP_OK) && (Count > 0)) {
-        uint16_t raw_x = Data[0].x;
-        uint16_t raw_y = Data[0].y;
+    isTouched = XPT2046_Sample(Touch, &raw_x, &raw_y);
 
+#ifdef GUI_TOUCH_USE_IRQ
+    /* The conversions toggle the IRQ line, so the flag is cleared after the read */
+    _GUITask_State.isTouchPending = false;
+    _GUITask_State.isTouched = isTouched;
+#endif
+
+    if (isTouched) {
         /* Clamp raw values to calibrated range */
         int16_t clamped_x = (raw_x < TOUCH_RAW_X_MIN) ? TOUCH_RAW_X_MIN : (raw_x > TOUCH_RAW_X_MAX) ? TOUCH_RAW_X_MAX : raw_x;
         int16_t clamped_y = (raw_y < TOUCH_RAW_Y_MIN) ? TOUCH_RAW_Y_MIN : (raw_y > TOUCH_RAW_Y_MAX) ? TOUCH_RAW_Y_MAX : raw_y;
@@ -516,7 +671,9 @@ static void XPT2046_LVGL_ReadCallback(lv_indev_t *p_Indev, lv_indev_data_t *p_Da
 void Task_GUI(void *p_Parameters)
 {
     App_Context_t *App_Context;
-    App_Settings_Lepton_t LeptonSettings;
+    App_Settings_ROI_t ROI;
+    App_Settings_Display_t DisplaySettings;
+    TickType_t Wait;
 
     esp_task_wdt_add(NULL);
 
@@ -529,20 +686,24 @@ void Task_GUI(void *p_Parameters)
     /*  - Waiting for the Lepton */
     do {
         EventBits_t EventBits;
+        uint32_t Wait;
 
         esp_task_wdt_reset();
 
-        EventBits = xEventGroupGetBits(_GUITask_State.EventGroup);
-        if (EventBits & LEPTON_CAMERA_READY) {
-
-            lv_bar_set_value(ui_SplashScreen_LoadingBar, 100, LV_ANIM_OFF);
-            xEventGroupClearBits(_GUITask_State.EventGroup, LEPTON_CAMERA_READY);
+        Wait = lv_timer_handler();
+        if ((Wait == 0) || (Wait > 100)) {
+            Wait = 100;
         }
 
         // TODO: Add timeout
 
-        lv_timer_handler();
-        vTaskDelay(100 / portTICK_PERIOD_MS);
+        /* Wake up as soon as the camera is ready instead of polling, the main screen is loaded right away */
+        EventBits = xEventGroupWaitBits(_GUITask_State.EventGroup, LEPTON_CAMERA_READY, pdTRUE, pdFALSE,
+                                        Wait / portTICK_PERIOD_MS);
+        if (EventBits & LEPTON_CAMERA_READY) {
+            Bus_Read(BUS_TOPIC_LEPTON_DEVICE, &_GUITask_State.LeptonDeviceInfo, sizeof(App_Lepton_Device_t), NULL);
+            lv_bar_set_value(ui_SplashScreen_LoadingBar, 100, LV_ANIM_OFF);
+        }
     } while (lv_bar_get_value(ui_SplashScreen_LoadingBar) < lv_bar_get_max_value(ui_SplashScreen_LoadingBar));
 
     lv_disp_load_scr(ui_Main);
@@ -550,30 +711,52 @@ void Task_GUI(void *p_Parameters)
     /* Process layout changes after loading new screen */
     lv_timer_handler();
 
+#ifdef CONFIG_GUI_COMPRESSED_ASSETS
+    /* The splash screen is not shown again, its images are inflated again if it is */
+    GUI_Assets_ReleaseImage(&ui_img_logo_80x44_png);
+    GUI_Assets_ReleaseImage(&ui_img_text_218x40_png);
+#endif
+
     /* Set the initial ROI FIRST to give it a size */
-    SettingsManager_GetLepton(&LeptonSettings);
-    GUI_Update_ROI(LeptonSettings.ROI[ROI_TYPE_SPOTMETER]);
-    GUI_Update_ROI(LeptonSettings.ROI[ROI_TYPE_SCENE]);
-    GUI_Update_ROI(LeptonSettings.ROI[ROI_TYPE_AGC]);
-    GUI_Update_ROI(LeptonSettings.ROI[ROI_TYPE_VIDEO_FOCUS]);
+    for (uint8_t i = ROI_TYPE_SPOTMETER; i <= ROI_TYPE_VIDEO_FOCUS; i++) {
+        if (SettingsManager_GetROI(static_cast<App_Settings_ROI_Type_t>(i), &ROI) == ESP_OK) {
+            GUI_Update_ROI(ROI);
+        }
+    }
 
     GUI_Update_Info();
 
+    if (SettingsManager_GetDisplay(&DisplaySettings) == ESP_OK) {
+        _GUITask_State.DisplayTimeout = DisplaySettings.Timeout;
+    }
+
+    _GUITask_State.isThermalVisible = true;
+    FrameProducts_Subscribe(FRAME_CONSUMER_DISPLAY, GUI_FRAME_PRODUCTS);
+
     esp_event_post(GUI_EVENTS, GUI_EVENT_APP_STARTED, NULL, 0, portMAX_DELAY);
 
+    Wait = 0;
+
     _GUITask_State.RunTask = true;
     while (_GUITask_State.RunTask) {
         EventBits_t EventBits;
         App_Lepton_FrameReady_t LeptonFrame;
+        bool isFrameDrawn = false;
+        uint32_t FrameSequence = 0;
+        int64_t FrameTimestamp = 0;
 
         esp_task_wdt_reset();
 
-        /* Check for new thermal frame */
-        if (xQueueReceive(App_Context->Lepton_FrameEventQueue, &LeptonFrame, 0) == pdTRUE) {
+        /* Sleep until a new thermal frame arrives or the next LVGL timer is due. Events are handled with the next
+           wake up, LVGL refreshes the display more often than the events arrive */
+        if (xQueueReceive(App_Context->Lepton_FrameEventQueue, &LeptonFrame, Wait) == pdTRUE) {
             uint8_t *dst;
             uint32_t Image_Width;
             uint32_t Image_Height;
-            char temp_buf[16];
+            int32_t ScaleMin;
+            int32_t ScaleMax;
+            bool isRAW;
+            GUI_Scale_Job_t ScaleJob;
 
             /* Reset watchdog before image processing */
             esp_task_wdt_reset();
@@ -586,122 +769,127 @@ void Task_GUI(void *p_Parameters)
             /* Skip if image widget not properly initialized yet */
             if ((Image_Width == 0) || (Image_Height == 0)) {
                 ESP_LOGW(TAG, "Image widget not ready yet (size: %ux%u), skipping frame", Image_Width, Image_Height);
+                FramePool_Release(LeptonFrame.Frame);
                 continue;
             }
 
-            /* Pre-calculate scaling factors (fixed-point 16.16) */
-            uint32_t x_ratio = ((LeptonFrame.Width - 1) << 16) / Image_Width;
-            uint32_t y_ratio = ((LeptonFrame.Height - 1) << 16) / Image_Height;
-
-            for (uint32_t dst_y = 0; dst_y < Image_Height; dst_y++) {
-                uint32_t src_y_fixed = dst_y * y_ratio;
-                uint32_t y0 = src_y_fixed >> 16;
-                uint32_t y1 = (y0 + 1 < LeptonFrame.Height) ? y0 + 1 : y0;
-                uint32_t y_frac = (src_y_fixed >> 8) & 0xFF; /* 8-bit fractional part */
-                uint32_t y_inv = 256 - y_frac;
-
-                for (uint32_t dst_x = 0; dst_x < Image_Width; dst_x++) {
-                    uint32_t src_x_fixed = dst_x * x_ratio;
-                    uint32_t x0 = src_x_fixed >> 16;
-                    uint32_t x1 = (x0 + 1 < LeptonFrame.Width) ? x0 + 1 : x0;
-                    uint32_t x_frac = (src_x_fixed >> 8) & 0xFF; /* 8-bit fractional part */
-                    uint32_t x_inv = 256 - x_frac;
-
-                    /* Get the four surrounding pixels */
-                    uint32_t idx00 = (y0 * LeptonFrame.Width + x0) * 3;
-                    uint32_t idx10 = (y0 * LeptonFrame.Width + x1) * 3;
-                    uint32_t idx01 = (y1 * LeptonFrame.Width + x0) * 3;
-                    uint32_t idx11 = (y1 * LeptonFrame.Width + x1) * 3;
-
-                    /* Bilinear interpolation using fixed-point arithmetic (8.8 format) */
-                    /* Weight: (256-x_frac)*(256-y_frac), x_frac*(256-y_frac), etc. */
-                    uint32_t w00 = (x_inv * y_inv) >> 8;
-                    uint32_t w10 = (x_frac * y_inv) >> 8;
-                    uint32_t w01 = (x_inv * y_frac) >> 8;
-                    uint32_t w11 = (x_frac * y_frac) >> 8;
-
-                    uint32_t r = (LeptonFrame.Buffer[idx00 + 0] * w00 +
-                                  LeptonFrame.Buffer[idx10 + 0] * w10 +
-                                  LeptonFrame.Buffer[idx01 + 0] * w01 +
-                                  LeptonFrame.Buffer[idx11 + 0] * w11) >> 8;
-
-                    uint32_t g = (LeptonFrame.Buffer[idx00 + 1] * w00 +
-                                  LeptonFrame.Buffer[idx10 + 1] * w10 +
-                                  LeptonFrame.Buffer[idx01 + 1] * w01 +
-                                  LeptonFrame.Buffer[idx11 + 1] * w11) >> 8;
-
-                    uint32_t b_val = (LeptonFrame.Buffer[idx00 + 2] * w00 +
-                                      LeptonFrame.Buffer[idx10 + 2] * w10 +
-                                      LeptonFrame.Buffer[idx01 + 2] * w01 +
-                                      LeptonFrame.Buffer[idx11 + 2] * w11) >> 8;
-
-                    /* Destination pixel index (rotated 180 degrees) */
-                    uint32_t rot_y = Image_Height - 1 - dst_y;
-                    uint32_t rot_x = Image_Width - 1 - dst_x;
-                    uint32_t dst_idx = rot_y * Image_Width + rot_x;
-
-                    /* Convert to RGB565 - LVGL handles swapping with RGB565_SWAPPED */
-                    uint16_t rgb565 = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b_val >> 3);
-
-                    /* Low byte first */
-                    dst[dst_idx * 2 + 0] = rgb565 & 0xFF;
-
-                    /* High byte second */
-                    dst[dst_idx * 2 + 1] = (rgb565 >> 8) & 0xFF;
+            ScaleMin = LeptonFrame.Min;
+            ScaleMax = LeptonFrame.Max;
+
+#ifdef CONFIG_GUI_THERMAL_RAW_LUT
+            isRAW = (_GUITask_State.ThermalLUT.RGB565 != NULL) &&
+                    (FrameProducts_Require(LeptonFrame.Frame, FRAME_PRODUCT_RAW | FRAME_PRODUCT_STATISTICS) == ESP_OK);
+#else
+            isRAW = false;
+#endif
+
+            /* The index and weight tables are only rebuilt when the widget size changes. The 180 degree
+               rotation of the thermal image is part of the tables */
+            if (ImageScaler_Configure(&_GUITask_State.ThermalScaler, LeptonFrame.Width, LeptonFrame.Height, Image_Width,
+                                      Image_Height, true) != ESP_OK) {
+                ESP_LOGE(TAG, "Can not configure thermal scaler!");
+                FramePool_Release(LeptonFrame.Frame);
+                continue;
+            }
+
+            memset(&ScaleJob, 0, sizeof(ScaleJob));
+            ScaleJob.p_Scaler = &_GUITask_State.ThermalScaler;
+            ScaleJob.p_Dst = reinterpret_cast<uint16_t *>(dst);
+
+            TRACE_BEGIN(TRACE_EVENT_SCALE);
+
+            if (isRAW) {
+#ifdef CONFIG_GUI_THERMAL_RAW_LUT
+                const uint16_t *p_Image;
+                uint8_t Mode;
+
+                /* A mode without its buffers keeps the previous mode */
+                Mode = __atomic_load_n(&_GUITask_State.AGCMode, __ATOMIC_RELAXED);
+                if ((Mode != _GUITask_State.ThermalAGC.Config.Mode) &&
+                    (FrameAGC_SetMode(&_GUITask_State.ThermalAGC, static_cast<FrameAGC_Mode_t>(Mode)) != ESP_OK)) {
+                    ESP_LOGW(TAG, "Can not switch to AGC mode %u!", Mode);
+                    __atomic_store_n(&_GUITask_State.AGCMode, _GUITask_State.ThermalAGC.Config.Mode, __ATOMIC_RELAXED);
+                }
+
+#ifdef CONFIG_LEPTON_ISOTHERMS
+                /* The bands are patched into the table. The local contrast maps levels instead of temperatures,
+                   so it shows no bands */
+                bool isHidden = (_GUITask_State.ThermalAGC.Config.Mode == FRAME_AGC_LOCAL);
+                if ((Isotherm_GetRevision() != _GUITask_State.IsothermRevision) ||
+                    (isHidden != _GUITask_State.isIsothermHidden)) {
+                    Isotherm_Set_t Isotherms;
+
+                    Isotherm_Get(&Isotherms);
+                    PaletteLUT_SetIsotherms(&_GUITask_State.ThermalLUT, Isotherms.Bands,
+                                            isHidden ? 0 : Isotherms.Count);
+                    _GUITask_State.IsothermRevision = Isotherms.Revision;
+                    _GUITask_State.isIsothermHidden = isHidden;
                 }
+#endif
+
+                /* Map the RAW14 data straight to the display format. The AGC only rebuilds the table when the
+                   window or the equalization curve has changed */
+                p_Image = FrameAGC_Process(&_GUITask_State.ThermalAGC, LeptonFrame.Frame->RAW,
+                                           &LeptonFrame.Frame->Statistics, &_GUITask_State.ThermalLUT,
+                                           GUI_Gradient_GetColors(&_GUITask_State.Gradient, _GUITask_State.Palette));
+                ScaleMin = _GUITask_State.ThermalAGC.Low;
+                ScaleMax = _GUITask_State.ThermalAGC.High;
+                ScaleJob.p_RAW = p_Image;
+                ScaleJob.p_LUT = &_GUITask_State.ThermalLUT;
+                GUI_Scale(&ScaleJob);
+#endif
+            } else {
+                /* Colorize the frame if the Lepton task did not */
+                FrameProducts_Require(LeptonFrame.Frame, FRAME_PRODUCT_RGB);
+                ScaleJob.p_RGB = LeptonFrame.Buffer;
+                GUI_Scale(&ScaleJob);
             }
 
-            /* Reset watchdog after image processing */
-            esp_task_wdt_reset();
+            TRACE_END(TRACE_EVENT_SCALE);
+
+#ifdef CONFIG_GUI_SCALER_BENCHMARK
+            /* Compare with the former per pixel scaler every 100 frames. Both overwrite the canvas, so the
+               frame is scaled again afterwards */
+            static uint32_t BenchmarkFrames = 0;
+            if ((++BenchmarkFrames % 100) == 0) {
+                ImageScaler_Benchmark(&_GUITask_State.ThermalScaler, LeptonFrame.Buffer, reinterpret_cast<uint16_t *>(dst));
+                ImageScaler_ScaleRGB888(&_GUITask_State.ThermalScaler, LeptonFrame.Buffer, reinterpret_cast<uint16_t *>(dst));
+            }
+#endif
 
-            /* Max temperature (top of gradient) */
-            float temp_max_celsius = (LeptonFrame.Max / 100.0f) - 273.15f;
-            snprintf(temp_buf, sizeof(temp_buf), "%.1f °C", temp_max_celsius);
-            lv_label_set_text(ui_Label_TempScaleMax, temp_buf);
+            FrameSequence = LeptonFrame.Frame->Sequence;
+            FrameTimestamp = LeptonFrame.Frame->Timestamp;
+            FrameLatency_Mark(FRAME_LATENCY_SCALE, FrameSequence, FrameTimestamp);
 
-            /* Min temperature (bottom of gradient) */
-            float temp_min_celsius = (LeptonFrame.Min / 100.0f) - 273.15f;
-            snprintf(temp_buf, sizeof(temp_buf), "%.1f °C", temp_min_celsius);
-            lv_label_set_text(ui_Label_TempScaleMin, temp_buf);
+            GUI_Helper_UpdatePixelTemperature(&_GUITask_State, LeptonFrame.Frame);
 
+            /* The display copy is done, return the frame to the pool */
+            FramePool_Release(LeptonFrame.Frame);
+
+            /* Reset watchdog after image processing */
+            esp_task_wdt_reset();
+
+            /* Max and min temperature (top and bottom of gradient). The AGC window moves with every frame, the
+               labels only follow changes above the hysteresis */
+            GUI_Widgets_SetValue(&_GUITask_State.TempScaleMax, ui_Label_TempScaleMax, (ScaleMax / 100.0f) - 273.15f,
+                                 GUI_WIDGETS_TEMP_HYSTERESIS, "%.1f °C");
+            GUI_Widgets_SetValue(&_GUITask_State.TempScaleMin, ui_Label_TempScaleMin, (ScaleMin / 100.0f) - 273.15f,
+                                 GUI_WIDGETS_TEMP_HYSTERESIS, "%.1f °C");
+
+#ifdef CONFIG_GUI_THERMAL_DIRECT
+            /* Send the image to the display, LVGL only redraws the overlays. LVGL draws the whole image when it is
+               covered */
+            if (GUI_Helper_BlitThermal(&_GUITask_State) != ESP_OK) {
+                lv_obj_invalidate(ui_Image_Thermal);
+            }
+#else
             /* Trigger LVGL to redraw the image */
             lv_obj_invalidate(ui_Image_Thermal);
+#endif
+            isFrameDrawn = true;
             ESP_LOGD(TAG, "Updated thermal image display (src: %ux%u -> dst: %ux%u)", LeptonFrame.Width, LeptonFrame.Height,
                      Image_Width, Image_Height);
 
-            /* Update network frame for server streaming if server is running */
-            if (Server_isRunning()) {
-                if (xSemaphoreTake(_GUITask_State.NetworkFrame.mutex, 0) == pdTRUE) {
-                    /* Convert scaled RGB565 buffer to RGB888 for network transmission */
-                    uint8_t *rgb888_dst = _GUITask_State.NetworkRGBBuffer;
-                    for (uint32_t i = 0; i < Image_Width * Image_Height; i++) {
-                        /* Read RGB565 value (little endian) */
-                        uint16_t rgb565 = dst[i * 2 + 0] | (dst[i * 2 + 1] << 8);
-
-                        /* Convert RGB565 to RGB888 */
-                        uint8_t r = ((rgb565 >> 11) & 0x1F) * 255 / 31;
-                        uint8_t g = ((rgb565 >> 5) & 0x3F) * 255 / 63;
-                        uint8_t b = (rgb565 & 0x1F) * 255 / 31;
-
-                        /* Store as RGB888 */
-                        rgb888_dst[i * 3 + 0] = r;
-                        rgb888_dst[i * 3 + 1] = g;
-                        rgb888_dst[i * 3 + 2] = b;
-                    }
-
-                    _GUITask_State.NetworkFrame.buffer = _GUITask_State.NetworkRGBBuffer;
-                    _GUITask_State.NetworkFrame.width = Image_Width;
-                    _GUITask_State.NetworkFrame.height = Image_Height;
-                    _GUITask_State.NetworkFrame.timestamp = esp_timer_get_time() / 1000;
-
-                    xSemaphoreGive(_GUITask_State.NetworkFrame.mutex);
-                }
-
-                /* Notify Websocket handler that a new frame is ready (non-blocking) */
-                if (WebSocket_Handler_HasClients()) {
-                    WebSocket_Handler_NotifyFrameReady();
-                }
-            }
         }
 
         /* Process the recieved system events */
@@ -713,25 +901,27 @@ void Task_GUI(void *p_Parameters)
         } else if (EventBits & BATTERY_VOLTAGE_READY) {
             char buf[8];
 
+            Bus_Read(BUS_TOPIC_BATTERY, &_GUITask_State.BatteryInfo, sizeof(App_Devices_Battery_t), NULL);
+
             if (_GUITask_State.BatteryInfo.Percentage == 100) {
-                lv_obj_set_style_bg_color(ui_Image_Main_Battery, lv_color_hex(0x00FF00), 0);
-                lv_label_set_text(ui_Image_Main_Battery, LV_SYMBOL_BATTERY_FULL);
+                GUI_Widgets_SetBgColor(ui_Image_Main_Battery, lv_color_hex(0x00FF00));
+                GUI_Widgets_SetText(ui_Image_Main_Battery, LV_SYMBOL_BATTERY_FULL);
             } else if (_GUITask_State.BatteryInfo.Percentage >= 75) {
-                lv_obj_set_style_bg_color(ui_Image_Main_Battery, lv_color_hex(0x00FF00), 0);
-                lv_label_set_text(ui_Image_Main_Battery, LV_SYMBOL_BATTERY_3);
+                GUI_Widgets_SetBgColor(ui_Image_Main_Battery, lv_color_hex(0x00FF00));
+                GUI_Widgets_SetText(ui_Image_Main_Battery, LV_SYMBOL_BATTERY_3);
             } else if (_GUITask_State.BatteryInfo.Percentage >= 50) {
-                lv_obj_set_style_bg_color(ui_Image_Main_Battery, lv_color_hex(0xFFFF00), 0);
-                lv_label_set_text(ui_Image_Main_Battery, LV_SYMBOL_BATTERY_2);
+                GUI_Widgets_SetBgColor(ui_Image_Main_Battery, lv_color_hex(0xFFFF00));
+                GUI_Widgets_SetText(ui_Image_Main_Battery, LV_SYMBOL_BATTERY_2);
             } else if (_GUITask_State.BatteryInfo.Percentage >= 25) {
-                lv_obj_set_style_bg_color(ui_Image_Main_Battery, lv_color_hex(0xFFFF00), 0);
-                lv_label_set_text(ui_Image_Main_Battery, LV_SYMBOL_BATTERY_1);
+                GUI_Widgets_SetBgColor(ui_Image_Main_Battery, lv_color_hex(0xFFFF00));
+                GUI_Widgets_SetText(ui_Image_Main_Battery, LV_SYMBOL_BATTERY_1);
             } else {
-                lv_obj_set_style_bg_color(ui_Image_Main_Battery, lv_color_hex(0xFF0000), 0);
-                lv_label_set_text(ui_Image_Main_Battery, LV_SYMBOL_BATTERY_EMPTY);
+                GUI_Widgets_SetBgColor(ui_Image_Main_Battery, lv_color_hex(0xFF0000));
+                GUI_Widgets_SetText(ui_Image_Main_Battery, LV_SYMBOL_BATTERY_EMPTY);
             }
 
             snprintf(buf, sizeof(buf), "%d%%", _GUITask_State.BatteryInfo.Percentage);
-            lv_label_set_text(ui_Label_Main_Battery_Remaining, buf);
+            GUI_Widgets_SetText(ui_Label_Main_Battery_Remaining, buf);
 
             xEventGroupClearBits(_GUITask_State.EventGroup, BATTERY_VOLTAGE_READY);
         } else if ( EventBits & BATTERY_CHARGING_STATUS_READY) {
@@ -746,21 +936,21 @@ void Task_GUI(void *p_Parameters)
                          (_GUITask_State.IP_Info.IP >> 16) & 0xFF,
                          (_GUITask_State.IP_Info.IP >> 24) & 0xFF);
 
-                lv_label_set_text(ui_Label_Info_IP, Buffer);
-                lv_obj_set_style_text_color(ui_Image_Main_WiFi, lv_color_hex(0x00FF00), LV_PART_MAIN);
+                GUI_Widgets_SetText(ui_Label_Info_IP, Buffer);
+                GUI_Widgets_SetTextColor(ui_Image_Main_WiFi, lv_color_hex(0x00FF00));
                 lv_obj_remove_flag(ui_Button_Main_WiFi, LV_OBJ_FLAG_CLICKABLE);
             } else {
-                lv_label_set_text(ui_Label_Info_IP, "Not connected");
-                lv_obj_set_style_text_color(ui_Image_Main_WiFi, lv_color_hex(0xFF0000), LV_PART_MAIN);
+                GUI_Widgets_SetText(ui_Label_Info_IP, "Not connected");
+                GUI_Widgets_SetTextColor(ui_Image_Main_WiFi, lv_color_hex(0xFF0000));
                 lv_obj_add_flag(ui_Button_Main_WiFi, LV_OBJ_FLAG_CLICKABLE);
             }
 
             xEventGroupClearBits(_GUITask_State.EventGroup, WIFI_CONNECTION_STATE_CHANGED);
         } else if (EventBits & PROVISIONING_STATE_CHANGED) {
             if ((_GUITask_State.WiFiConnected == false) && _GUITask_State.ProvisioningActive) {
-                lv_obj_set_style_text_color(ui_Image_Main_WiFi, lv_color_hex(0xFF8800), LV_PART_MAIN);
+                GUI_Widgets_SetTextColor(ui_Image_Main_WiFi, lv_color_hex(0xFF8800));
             } else {
-                lv_obj_set_style_text_color(ui_Image_Main_WiFi, lv_color_hex(0xFF0000), LV_PART_MAIN);
+                GUI_Widgets_SetTextColor(ui_Image_Main_WiFi, lv_color_hex(0xFF0000));
             }
 
             xEventGroupClearBits(_GUITask_State.EventGroup, PROVISIONING_STATE_CHANGED);
@@ -777,71 +967,71 @@ void Task_GUI(void *p_Parameters)
 
             xEventGroupClearBits(_GUITask_State.EventGroup, SD_CARD_MOUNT_ERROR);
         } else if (EventBits & LEPTON_SPOTMETER_READY) {
-            // TODO: Can we move this to the network task?
-            if (Server_isRunning()) {
-                if (xSemaphoreTake(_GUITask_State.NetworkFrame.mutex, 0) == pdTRUE) {
-                    _GUITask_State.NetworkFrame.temp_min = _GUITask_State.ROIResult.Min;
-                    _GUITask_State.NetworkFrame.temp_max = _GUITask_State.ROIResult.Max;
-                    _GUITask_State.NetworkFrame.temp_avg = _GUITask_State.ROIResult.Average;
-
-                    xSemaphoreGive(_GUITask_State.NetworkFrame.mutex);
-                }
-            }
+            Bus_Read(BUS_TOPIC_LEPTON_SPOTMETER, &_GUITask_State.ROIResult, sizeof(App_Lepton_ROI_Result_t), NULL);
 
             xEventGroupClearBits(_GUITask_State.EventGroup, LEPTON_SPOTMETER_READY);
         } else if (EventBits & LEPTON_UPTIME_READY) {
             char buf[32];
             uint32_t uptime_sec;
 
+            Bus_Read(BUS_TOPIC_LEPTON_UPTIME, &_GUITask_State.LeptonUptime, sizeof(uint32_t), NULL);
             uptime_sec = _GUITask_State.LeptonUptime / 1000;
 
             snprintf(buf, sizeof(buf), "%02lu:%02lu:%02lu", uptime_sec / 3600, (uptime_sec % 3600) / 60, uptime_sec % 60);
-            lv_label_set_text(ui_Label_Info_Lepton_Uptime, buf);
+            GUI_Widgets_SetText(ui_Label_Info_Lepton_Uptime, buf);
 
             xEventGroupClearBits(_GUITask_State.EventGroup, LEPTON_UPTIME_READY);
         } else if (EventBits & LEPTON_TEMP_READY) {
-            char buf[32];
+            Bus_Read(BUS_TOPIC_LEPTON_TEMPERATURES, &_GUITask_State.LeptonTemperatures,
+                     sizeof(App_Lepton_Temperatures_t), NULL);
 
-            snprintf(buf, sizeof(buf), "%.2f °C", _GUITask_State.LeptonTemperatures.FPA);
-            lv_label_set_text(ui_Label_Info_Lepton_FPA, buf);
-            snprintf(buf, sizeof(buf), "%.2f °C", _GUITask_State.LeptonTemperatures.AUX);
-            lv_label_set_text(ui_Label_Info_Lepton_AUX, buf);
+            GUI_Widgets_SetValue(&_GUITask_State.FPA, ui_Label_Info_Lepton_FPA, _GUITask_State.LeptonTemperatures.FPA,
+                                 GUI_WIDGETS_TEMP_HYSTERESIS, "%.2f °C");
+            GUI_Widgets_SetValue(&_GUITask_State.AUX, ui_Label_Info_Lepton_AUX, _GUITask_State.LeptonTemperatures.AUX,
+                                 GUI_WIDGETS_TEMP_HYSTERESIS, "%.2f °C");
 
             xEventGroupClearBits(_GUITask_State.EventGroup, LEPTON_TEMP_READY);
-        } else if (EventBits & LEPTON_PIXEL_TEMPERATURE_READY) {
-            char buf[16];
-
-            snprintf(buf, sizeof(buf), "%.2f °C", _GUITask_State.SpotTemperature);
-            lv_label_set_text(ui_Label_Main_Thermal_PixelTemperature, buf);
-
-            xEventGroupClearBits(_GUITask_State.EventGroup, LEPTON_PIXEL_TEMPERATURE_READY);
         } else if (EventBits & LEPTON_SCENE_STATISTICS_READY) {
-            char temp_buf[16];
+            Bus_Read(BUS_TOPIC_LEPTON_SCENE_STATISTICS, &_GUITask_State.ROIResult, sizeof(App_Lepton_ROI_Result_t),
+                     NULL);
 
-            float temp_max_celsius = _GUITask_State.ROIResult.Max;
-            snprintf(temp_buf, sizeof(temp_buf), "%.1f °C", temp_max_celsius);
-            lv_label_set_text(ui_Label_Main_Thermal_Scene_Max, temp_buf);
-
-            float temp_min_celsius = _GUITask_State.ROIResult.Min;
-            snprintf(temp_buf, sizeof(temp_buf), "%.1f °C", temp_min_celsius);
-            lv_label_set_text(ui_Label_Main_Thermal_Scene_Min, temp_buf);
-
-            float temp_mean_celsius = _GUITask_State.ROIResult.Mean ;
-            snprintf(temp_buf, sizeof(temp_buf), "%.1f °C", temp_mean_celsius);
-            lv_label_set_text(ui_Label_Main_Thermal_Scene_Mean, temp_buf);
+            GUI_Widgets_SetValue(&_GUITask_State.SceneMax, ui_Label_Main_Thermal_Scene_Max,
+                                 _GUITask_State.ROIResult.Max, GUI_WIDGETS_TEMP_HYSTERESIS, "%.1f °C");
+            GUI_Widgets_SetValue(&_GUITask_State.SceneMin, ui_Label_Main_Thermal_Scene_Min,
+                                 _GUITask_State.ROIResult.Min, GUI_WIDGETS_TEMP_HYSTERESIS, "%.1f °C");
+            GUI_Widgets_SetValue(&_GUITask_State.SceneMean, ui_Label_Main_Thermal_Scene_Mean,
+                                 _GUITask_State.ROIResult.Mean, GUI_WIDGETS_TEMP_HYSTERESIS, "%.1f °C");
 
             xEventGroupClearBits(_GUITask_State.EventGroup, LEPTON_SCENE_STATISTICS_READY);
         }
 
         _lock_acquire(&_GUITask_State.LVGL_API_Lock);
+        TRACE_BEGIN(TRACE_EVENT_LVGL_RENDER);
         uint32_t time_till_next = lv_timer_handler();
+        TRACE_END(TRACE_EVENT_LVGL_RENDER);
         _lock_release(&_GUITask_State.LVGL_API_Lock);
-        uint32_t delay_ms = (time_till_next > 0) ? time_till_next : 10;
+
+        GUI_Update_Visibility();
+
+        /* The frame has been rendered and handed to the display driver */
+        if (isFrameDrawn) {
+            FrameLatency_Mark(FRAME_LATENCY_DISPLAY, FrameSequence, FrameTimestamp);
+            Boot_Mark(BOOT_PHASE_FIRST_DISPLAY);
+        }
+
+        if (time_till_next > GUI_TASK_IDLE_MS) {
+            time_till_next = GUI_TASK_IDLE_MS;
+        }
+
+        /* Further events are pending, the loop handles one per pass */
+        if (xEventGroupGetBits(_GUITask_State.EventGroup) & GUI_MAIN_EVENTS) {
+            Wait = 0;
+        } else {
+            Wait = (time_till_next + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+        }
 
         /* Reset watchdog at end of loop to prevent timeout during long operations */
         esp_task_wdt_reset();
-
-        vTaskDelay(delay_ms / portTICK_PERIOD_MS);
     }
 
     esp_task_wdt_delete(NULL);
@@ -857,41 +1047,71 @@ esp_err_t GUI_Task_Init(void)
 
     ESP_ERROR_CHECK(GUI_Helper_Init(&_GUITask_State, XPT2046_LVGL_ReadCallback));
 
+#ifdef CONFIG_GUI_COMPRESSED_ASSETS
+    ESP_ERROR_CHECK(GUI_Assets_Init());
+#endif
+
     /* Initialize the UI elements and trigger a redraw to make all elements accessibile */
     ui_init();
 
     /* Use the event loop to receive control signals from other tasks */
     esp_event_handler_register(DEVICE_EVENTS, ESP_EVENT_ANY_ID, on_Devices_Event_Handler, NULL);
     esp_event_handler_register(NETWORK_EVENTS, ESP_EVENT_ANY_ID, on_Network_Event_Handler, NULL);
-    esp_event_handler_register(LEPTON_EVENTS, ESP_EVENT_ANY_ID, on_Lepton_Event_Handler, NULL);
     esp_event_handler_register(TIME_EVENTS, ESP_EVENT_ANY_ID, on_Time_Event_Handler, NULL);
     esp_event_handler_register(SD_EVENTS, ESP_EVENT_ANY_ID, on_SD_Event_Handler, NULL);
+    esp_event_handler_register(SETTINGS_EVENTS, ESP_EVENT_ANY_ID, on_Settings_Event_Handler, NULL);
 
-    _GUITask_State.ThermalCanvasBuffer = (uint8_t *)heap_caps_malloc(240 * 180 * 2, MALLOC_CAP_SPIRAM);
-    _GUITask_State.GradientCanvasBuffer = (uint8_t *)heap_caps_malloc(20 * 180 * 2, MALLOC_CAP_SPIRAM);
-    _GUITask_State.NetworkRGBBuffer = (uint8_t *)heap_caps_malloc(240 * 180 * 3, MALLOC_CAP_SPIRAM);
+    /* The camera results and the battery are read from the bus, a publish only sets the event bit */
+    for (size_t i = 0; i < sizeof(_GUITask_Topics) / sizeof(_GUITask_Topics[0]); i++) {
+        Bus_Subscribe(_GUITask_Topics[i].Topic, _GUITask_State.EventGroup, _GUITask_Topics[i].Bits);
+    }
+
+    _GUITask_State.ThermalCanvasBuffer = reinterpret_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME,
+                                                                                      240 * 180 * 2, "thermal_canvas"));
 
     if (_GUITask_State.ThermalCanvasBuffer == NULL) {
         ESP_LOGE(TAG, "Failed to allocate thermal canvas buffer!");
         return ESP_ERR_NO_MEM;
     }
 
-    if (_GUITask_State.GradientCanvasBuffer == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate gradient canvas buffer!");
-        heap_caps_free(_GUITask_State.ThermalCanvasBuffer);
+    if (GUI_Gradient_Init(&_GUITask_State.Gradient) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to allocate gradient bars!");
+        MemoryPlan_Free(_GUITask_State.ThermalCanvasBuffer);
         return ESP_ERR_NO_MEM;
     }
 
-    if (_GUITask_State.NetworkRGBBuffer == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate network RGB buffer!");
-        heap_caps_free(_GUITask_State.ThermalCanvasBuffer);
-        heap_caps_free(_GUITask_State.GradientCanvasBuffer);
-        return ESP_ERR_NO_MEM;
+#ifdef CONFIG_GUI_THERMAL_RAW_LUT
+    /* Without the lookup table the GUI falls back to the colorized RGB888 frame */
+    if (PaletteLUT_Init(&_GUITask_State.ThermalLUT, false) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to allocate thermal lookup table, using RGB888 frames!");
     }
 
+    const FrameAGC_Config_t AGCConfig = {
+        .Mode = static_cast<FrameAGC_Mode_t>(CONFIG_GUI_AGC_MODE),
+        .Clip = CONFIG_GUI_AGC_CLIP,
+        .Plateau = CONFIG_GUI_AGC_PLATEAU,
+        .Damping = CONFIG_GUI_AGC_DAMPING,
+    };
+
+    /* The local contrast mode needs two buffers, the global modes work without them */
+    if (FrameAGC_Init(&_GUITask_State.ThermalAGC, 160, 120, &AGCConfig) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to initialize AGC mode %u, using the histogram equalization!", CONFIG_GUI_AGC_MODE);
+
+        const FrameAGC_Config_t Fallback = {
+            .Mode = FRAME_AGC_HEQ,
+            .Clip = CONFIG_GUI_AGC_CLIP,
+            .Plateau = CONFIG_GUI_AGC_PLATEAU,
+            .Damping = CONFIG_GUI_AGC_DAMPING,
+        };
+
+        FrameAGC_Init(&_GUITask_State.ThermalAGC, 160, 120, &Fallback);
+    }
+
+    _GUITask_State.AGCMode = _GUITask_State.ThermalAGC.Config.Mode;
+#endif
+
     /* Initialize buffers with black pixels (RGB565 = 0x0000) */
     memset(_GUITask_State.ThermalCanvasBuffer, 0x00, 240 * 180 * 2);
-    memset(_GUITask_State.GradientCanvasBuffer, 0x00, 20 * 180 * 2);
 
     /* Now configure the image descriptors with allocated buffers */
     _GUITask_State.ThermalImageDescriptor.header.cf = LV_COLOR_FORMAT_RGB565;
@@ -900,17 +1120,16 @@ esp_err_t GUI_Task_Init(void)
     _GUITask_State.ThermalImageDescriptor.data = _GUITask_State.ThermalCanvasBuffer;
     _GUITask_State.ThermalImageDescriptor.data_size = 240 * 180 * 2;
 
-    _GUITask_State.GradientImageDescriptor.header.cf = LV_COLOR_FORMAT_RGB565;
-    _GUITask_State.GradientImageDescriptor.header.w = 20;
-    _GUITask_State.GradientImageDescriptor.header.h = 180;
-    _GUITask_State.GradientImageDescriptor.data = _GUITask_State.GradientCanvasBuffer;
-    _GUITask_State.GradientImageDescriptor.data_size = 20 * 180 * 2;
-
-    UI_Canvas_AddTempGradient();
-
     /* Set the images */
     lv_img_set_src(ui_Image_Thermal, &_GUITask_State.ThermalImageDescriptor);
-    lv_img_set_src(ui_Image_Gradient, &_GUITask_State.GradientImageDescriptor);
+    GUI_Set_Palette(PALETTE_IRON);
+
+    /* A click on the gradient bar switches to the next palette */
+    lv_obj_add_event_cb(ui_Image_Gradient, on_Gradient_Clicked, LV_EVENT_CLICKED, NULL);
+
+    /* Touching or dragging on the thermal image moves the crosshair */
+    lv_obj_add_flag(ui_Image_Thermal, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(ui_Image_Thermal, on_Thermal_Pressing, LV_EVENT_PRESSING, NULL);
 
 #ifdef CONFIG_GUI_TOUCH_DEBUG
     /* Create touch debug visualization overlay on main screen */
@@ -950,16 +1169,6 @@ esp_err_t GUI_Task_Init(void)
     ESP_LOGD(TAG, "Touch debug visualization enabled on ui_Main screen");
 #endif
 
-    /* Initialize network frame for server streaming */
-    _GUITask_State.NetworkFrame.mutex = xSemaphoreCreateMutex();
-    if (_GUITask_State.NetworkFrame.mutex == NULL) {
-        ESP_LOGE(TAG, "Failed to create NetworkFrame mutex!");
-        heap_caps_free(_GUITask_State.ThermalCanvasBuffer);
-        heap_caps_free(_GUITask_State.GradientCanvasBuffer);
-        heap_caps_free(_GUITask_State.NetworkRGBBuffer);
-        return ESP_ERR_NO_MEM;
-    }
-
     _GUITask_State.isInitialized = true;
 
     return ESP_OK;
@@ -973,18 +1182,28 @@ void GUI_Task_Deinit(void)
 
     esp_event_handler_unregister(DEVICE_EVENTS, ESP_EVENT_ANY_ID, on_Devices_Event_Handler);
     esp_event_handler_unregister(NETWORK_EVENTS, ESP_EVENT_ANY_ID, on_Network_Event_Handler);
-    esp_event_handler_unregister(LEPTON_EVENTS, ESP_EVENT_ANY_ID, on_Lepton_Event_Handler);
     esp_event_handler_unregister(TIME_EVENTS, ESP_EVENT_ANY_ID, on_Time_Event_Handler);
     esp_event_handler_unregister(SD_EVENTS, ESP_EVENT_ANY_ID, on_SD_Event_Handler);
+    esp_event_handler_unregister(SETTINGS_EVENTS, ESP_EVENT_ANY_ID, on_Settings_Event_Handler);
+
+    for (size_t i = 0; i < sizeof(_GUITask_Topics) / sizeof(_GUITask_Topics[0]); i++) {
+        Bus_Unsubscribe(_GUITask_Topics[i].Topic, _GUITask_State.EventGroup);
+    }
 
     ui_destroy();
 
+#ifdef CONFIG_GUI_COMPRESSED_ASSETS
+    GUI_Assets_Deinit();
+#endif
+
     GUI_Helper_Deinit(&_GUITask_State);
 
-    if (_GUITask_State.NetworkFrame.mutex != NULL) {
-        vSemaphoreDelete(_GUITask_State.NetworkFrame.mutex);
-        _GUITask_State.NetworkFrame.mutex = NULL;
-    }
+#ifdef CONFIG_GUI_THERMAL_RAW_LUT
+    FrameAGC_Deinit(&_GUITask_State.ThermalAGC);
+#endif
+    PaletteLUT_Deinit(&_GUITask_State.ThermalLUT);
+    GUI_Gradient_Deinit(&_GUITask_State.Gradient);
+    ImageScaler_Deinit(&_GUITask_State.ThermalScaler);
 
     _GUITask_State.Display = NULL;
     _GUITask_State.isInitialized = false;
@@ -992,7 +1211,7 @@ void GUI_Task_Deinit(void)
 
 esp_err_t GUI_Task_Start(App_Context_t *p_AppContext)
 {
-    BaseType_t ret;
+    esp_err_t Error;
 
     if (p_AppContext == NULL) {
         return ESP_ERR_INVALID_ARG;
@@ -1005,19 +1224,10 @@ esp_err_t GUI_Task_Start(App_Context_t *p_AppContext)
 
     ESP_LOGD(TAG, "Starting GUI Task");
 
-    ret = xTaskCreatePinnedToCore(
-              Task_GUI,
-              "Task_GUI",
-              CONFIG_GUI_TASK_STACKSIZE,
-              p_AppContext,
-              CONFIG_GUI_TASK_PRIO,
-              &_GUITask_State.GUI_Handle,
-              CONFIG_GUI_TASK_CORE
-          );
-
-    if (ret != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create GUI task: %d!", ret);
-        return ESP_ERR_NO_MEM;
+    Error = Topology_CreateTask(TOPOLOGY_TASK_GUI, Task_GUI, p_AppContext, &_GUITask_State.GUI_Handle);
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create GUI task: %d!", Error);
+        return Error;
     }
 
     _GUITask_State.Running = true;
@@ -1043,4 +1253,33 @@ esp_err_t GUI_Task_Stop(void)
 bool GUI_Task_isRunning(void)
 {
     return _GUITask_State.Running;
-}
\ No newline at end of file
+}
+
+#ifdef CONFIG_GUI_THERMAL_RAW_LUT
+esp_err_t GUI_Task_SetAGC(uint8_t Mode)
+{
+    if (Mode >= FRAME_AGC_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    __atomic_store_n(&_GUITask_State.AGCMode, Mode, __ATOMIC_RELAXED);
+
+    return ESP_OK;
+}
+
+uint8_t GUI_Task_GetAGC(void)
+{
+    return __atomic_load_n(&_GUITask_State.AGCMode, __ATOMIC_RELAXED);
+}
+#endif
+
+#ifdef BENCHMARK
+esp_err_t GUI_Task_FlushCanvas(void)
+{
+    if (_GUITask_State.Running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return GUI_Helper_FlushCanvas(&_GUITask_State);
+}
+#endif
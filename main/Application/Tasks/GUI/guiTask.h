@@ -58,6 +58,30 @@ esp_err_t GUI_Task_Stop(void);
  */
 bool GUI_Task_isRunning(void);
 
+#ifdef CONFIG_GUI_THERMAL_RAW_LUT
+/** @brief      Select the software AGC of the thermal view. The GUI task switches with the next frame, a mode
+ *              whose buffers can not be allocated keeps the previous mode.
+ *  @param Mode 0 = linear, 1 = linear with outlier clipping, 2 = histogram equalization, 3 = local contrast
+ *  @return     ESP_OK on success
+ *              ESP_ERR_INVALID_ARG if the mode is invalid
+ */
+esp_err_t GUI_Task_SetAGC(uint8_t Mode);
+
+/** @brief  Get the software AGC of the thermal view.
+ *  @return 0 = linear, 1 = linear with outlier clipping, 2 = histogram equalization, 3 = local contrast
+ */
+uint8_t GUI_Task_GetAGC(void);
+#endif
+
+#ifdef BENCHMARK
+/** @brief  Send the thermal canvas (240x180 RGB565) to the display and wait until the transfer is done.
+ *          Only for the benchmark firmware, before the GUI task is started.
+ *  @return ESP_OK on success
+ *          ESP_ERR_INVALID_STATE if the GUI is not initialized or already running
+ */
+esp_err_t GUI_Task_FlushCanvas(void);
+#endif
+
 /** @brief Toggle ROI (Region of Interest) edit mode.
  *         When enabled, shows a draggable rectangle overlay on the thermal image
  *         that can be moved by touch to adjust the spotmeter region.
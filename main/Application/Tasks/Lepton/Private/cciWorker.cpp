@@ -0,0 +1,602 @@
+/*
+ * cciWorker.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Asynchronous Lepton CCI command worker.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_task_wdt.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#include <string.h>
+
+#include "cciWorker.h"
+#include "../framePool.h"
+#include "Application/Trace/trace.h"
+#include "Application/Bus/messageBus.h"
+
+/* Coalescing slots. Every ROI type has its own slot, all other commands share the slot with the command */
+enum {
+    CCI_WORKER_SLOT_ROI_SPOTMETER = 0,
+    CCI_WORKER_SLOT_ROI_SCENE,
+    CCI_WORKER_SLOT_ROI_AGC,
+    CCI_WORKER_SLOT_ROI_VIDEO_FOCUS,
+    CCI_WORKER_SLOT_EMISSIVITY,
+    CCI_WORKER_SLOT_TEMPERATURE,
+    CCI_WORKER_SLOT_UPTIME,
+    CCI_WORKER_SLOT_SPOTMETER,
+    CCI_WORKER_SLOT_SCENE_STATISTICS,
+    CCI_WORKER_SLOT_COUNT,
+};
+
+/** @brief Pending request of a coalescing slot.
+ */
+typedef struct {
+    CCIWorker_Request_t Request;
+    uint8_t CallbackCount;
+    CCIWorker_Callback_t Callbacks[CCI_WORKER_MAX_CALLBACKS];
+    void *Args[CCI_WORKER_MAX_CALLBACKS];
+} CCIWorker_Pending_t;
+
+typedef struct {
+    bool isInitialized;
+    bool Running;
+    bool RunTask;
+    TaskHandle_t TaskHandle;
+    SemaphoreHandle_t Mutex;
+    Lepton_t *p_Lepton;
+    uint32_t PendingHigh;                       /**< Bitmask of pending high priority slots. */
+    uint32_t PendingLow;                        /**< Bitmask of pending low priority slots. */
+    CCIWorker_Pending_t Pending[CCI_WORKER_SLOT_COUNT];
+    CCIWorker_Statistics_t Statistics;
+    bool hasFluxParams;                         /**< FluxParams was read from the camera. */
+    Lepton_FluxLinearParams_t FluxParams;       /**< Last radiometric parameters of the camera. */
+} CCIWorker_State_t;
+
+static CCIWorker_State_t _CCIWorker_State;
+
+static const char *TAG = "cci_worker";
+
+/** @brief              Map a request to its coalescing slot.
+ *  @param p_Request    Pointer to the request
+ *  @return             Slot index or CCI_WORKER_SLOT_COUNT if the request is invalid
+ */
+static uint8_t CCIWorker_GetSlot(const CCIWorker_Request_t *p_Request)
+{
+    switch (p_Request->Command) {
+        case CCI_WORKER_CMD_SET_ROI: {
+            if (p_Request->Data.ROI.Type > ROI_TYPE_VIDEO_FOCUS) {
+                return CCI_WORKER_SLOT_COUNT;
+            }
+
+            return CCI_WORKER_SLOT_ROI_SPOTMETER + p_Request->Data.ROI.Type;
+        }
+        case CCI_WORKER_CMD_SET_EMISSIVITY: {
+            return CCI_WORKER_SLOT_EMISSIVITY;
+        }
+        case CCI_WORKER_CMD_GET_TEMPERATURE: {
+            return CCI_WORKER_SLOT_TEMPERATURE;
+        }
+        case CCI_WORKER_CMD_GET_UPTIME: {
+            return CCI_WORKER_SLOT_UPTIME;
+        }
+        case CCI_WORKER_CMD_GET_SPOTMETER: {
+            return CCI_WORKER_SLOT_SPOTMETER;
+        }
+        case CCI_WORKER_CMD_GET_SCENE_STATISTICS: {
+            return CCI_WORKER_SLOT_SCENE_STATISTICS;
+        }
+        default: {
+            return CCI_WORKER_SLOT_COUNT;
+        }
+    }
+}
+
+/** @brief              Take the next pending request. High priority slots are served first, lower slot
+ *                      numbers first within a priority.
+ *  @param p_Pending    Pointer to the output
+ *  @return             true when a request was taken
+ */
+static bool CCIWorker_TakeNext(CCIWorker_Pending_t *p_Pending)
+{
+    uint32_t *p_Mask;
+    uint8_t Slot;
+
+    xSemaphoreTake(_CCIWorker_State.Mutex, portMAX_DELAY);
+
+    if (_CCIWorker_State.PendingHigh != 0) {
+        p_Mask = &_CCIWorker_State.PendingHigh;
+    } else if (_CCIWorker_State.PendingLow != 0) {
+        p_Mask = &_CCIWorker_State.PendingLow;
+    } else {
+        xSemaphoreGive(_CCIWorker_State.Mutex);
+        return false;
+    }
+
+    Slot = __builtin_ctz(*p_Mask);
+    *p_Mask &= ~(1UL << Slot);
+
+    memcpy(p_Pending, &_CCIWorker_State.Pending[Slot], sizeof(CCIWorker_Pending_t));
+    _CCIWorker_State.Pending[Slot].CallbackCount = 0;
+
+    xSemaphoreGive(_CCIWorker_State.Mutex);
+
+    return true;
+}
+
+/** @brief          Set a camera ROI.
+ *  @param p_ROI    Pointer to the ROI
+ *  @return         ESP_OK on success
+ */
+static esp_err_t CCIWorker_SetROI(const App_Settings_ROI_t *p_ROI)
+{
+    Lepton_ROI_t ROI;
+    Lepton_Error_t Error;
+
+    ROI.Start_Col = p_ROI->x;
+    ROI.Start_Row = p_ROI->y;
+    ROI.End_Col = p_ROI->x + p_ROI->w - 1;
+    ROI.End_Row = p_ROI->y + p_ROI->h - 1;
+
+    switch (p_ROI->Type) {
+        case ROI_TYPE_SPOTMETER: {
+            Error = Lepton_SetSpotmeterROI(_CCIWorker_State.p_Lepton, &ROI);
+            break;
+        }
+        case ROI_TYPE_SCENE: {
+            Error = Lepton_SetSceneROI(_CCIWorker_State.p_Lepton, &ROI);
+            break;
+        }
+        case ROI_TYPE_AGC: {
+            Error = Lepton_SetAGCROI(_CCIWorker_State.p_Lepton, &ROI);
+            break;
+        }
+        case ROI_TYPE_VIDEO_FOCUS: {
+            Error = Lepton_SetVideoFocusROI(_CCIWorker_State.p_Lepton, &ROI);
+            break;
+        }
+        default: {
+            ESP_LOGW(TAG, "Invalid ROI type: %d", p_ROI->Type);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    if (Error != LEPTON_ERR_OK) {
+        ESP_LOGE(TAG, "Failed to update Lepton ROI with type %d!", p_ROI->Type);
+        return ESP_FAIL;
+    }
+
+    ESP_LOGD(TAG, "New Lepton ROI (Type %d) - Start_Col: %u, Start_Row: %u, End_Col: %u, End_Row: %u", p_ROI->Type,
+             ROI.Start_Col, ROI.Start_Row, ROI.End_Col, ROI.End_Row);
+
+    return ESP_OK;
+}
+
+/** @brief  Get the spotmeter from the ROI engine result of the latest frame, or from the camera.
+ *  @return ESP_OK on success
+ */
+static esp_err_t CCIWorker_GetSpotmeter(void)
+{
+    FramePool_Frame_t *Latest;
+    App_Lepton_ROI_Result_t App_Lepton_Spotmeter;
+    esp_err_t Error = ESP_FAIL;
+
+    Latest = FramePool_GetLatest();
+    if ((Latest != NULL) && Latest->hasROI && Latest->ROI[ROI_TYPE_SPOTMETER].isValid) {
+        App_Lepton_Spotmeter.Min = Latest->ROI[ROI_TYPE_SPOTMETER].Min;
+        App_Lepton_Spotmeter.Max = Latest->ROI[ROI_TYPE_SPOTMETER].Max;
+        App_Lepton_Spotmeter.Average = Latest->ROI[ROI_TYPE_SPOTMETER].Mean;
+        Error = ESP_OK;
+    } else {
+        Lepton_Spotmeter_t Spotmeter;
+
+        if (Lepton_GetSpotmeter(_CCIWorker_State.p_Lepton, &Spotmeter) == LEPTON_ERR_OK) {
+            ESP_LOGD(TAG, "Spotmeter: Spot=%uK, Min=%uK, Max=%uK", Spotmeter.Value, Spotmeter.Min, Spotmeter.Max);
+
+            App_Lepton_Spotmeter.Min = Spotmeter.Min - 273.0f;
+            App_Lepton_Spotmeter.Max = Spotmeter.Max - 273.0f;
+            App_Lepton_Spotmeter.Average = Spotmeter.Value - 273.0f;
+            Error = ESP_OK;
+        }
+    }
+    FramePool_Release(Latest);
+
+    if (Error == ESP_OK) {
+        Bus_Publish(BUS_TOPIC_LEPTON_SPOTMETER, &App_Lepton_Spotmeter, sizeof(App_Lepton_ROI_Result_t));
+    } else {
+        ESP_LOGW(TAG, "Failed to read spotmeter!");
+    }
+
+    return Error;
+}
+
+/** @brief  Get the scene statistics from the latest frame, or from the camera.
+ *  @return ESP_OK on success
+ */
+static esp_err_t CCIWorker_GetSceneStatistics(void)
+{
+    FramePool_Frame_t *Latest;
+    App_Lepton_ROI_Result_t App_Lepton_Scene;
+    esp_err_t Error = ESP_FAIL;
+
+    Latest = FramePool_GetLatest();
+    if ((Latest != NULL) && Latest->hasStatistics) {
+        App_Lepton_Scene.Min = FrameStatistics_RawToCelsius(Latest->Statistics.Min);
+        App_Lepton_Scene.Max = FrameStatistics_RawToCelsius(Latest->Statistics.Max);
+        App_Lepton_Scene.Mean = FrameStatistics_RawToCelsius(Latest->Statistics.Mean);
+        Error = ESP_OK;
+    } else {
+        Lepton_SceneStatistics_t SceneStats;
+
+        if (Lepton_GetSceneStatistics(_CCIWorker_State.p_Lepton, &SceneStats) == LEPTON_ERR_OK) {
+            App_Lepton_Scene.Min = SceneStats.MinIntensity;
+            App_Lepton_Scene.Max = SceneStats.MaxIntensity;
+            App_Lepton_Scene.Average = SceneStats.MeanIntensity;
+            Error = ESP_OK;
+        }
+    }
+    FramePool_Release(Latest);
+
+    if (Error == ESP_OK) {
+        ESP_LOGD(TAG, "Scene Statistics: Min=%.2f°C, Max=%.2f°C, Average=%.2f°C", App_Lepton_Scene.Min, App_Lepton_Scene.Max,
+                 App_Lepton_Scene.Average);
+
+        Bus_Publish(BUS_TOPIC_LEPTON_SCENE_STATISTICS, &App_Lepton_Scene, sizeof(App_Lepton_ROI_Result_t));
+    } else {
+        ESP_LOGW(TAG, "Failed to read scene statistics!");
+    }
+
+    return Error;
+}
+
+/** @brief  Read the radiometric parameters from the camera and update the cached copy.
+ *          Called from the worker task only, so the readout never collides with another CCI transfer.
+ *  @return ESP_OK on success
+ */
+static esp_err_t CCIWorker_ReadFluxParameters(void)
+{
+    Lepton_FluxLinearParams_t FluxParams;
+
+    if (Lepton_GetFluxLinearParameters(_CCIWorker_State.p_Lepton, &FluxParams) != LEPTON_ERR_OK) {
+        ESP_LOGW(TAG, "Failed to read flux linear parameters!");
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG,
+             "Flux Linear Parameters - Scene Emissivity: %u, TBkgK: %u, TauWindow: %u, TWindowK: %u, TauAtm: %u, TAtmK: %u, ReflWindow: %u, TReflK: %u",
+             FluxParams.SceneEmissivity,
+             FluxParams.TBkgK,
+             FluxParams.TauWindow,
+             FluxParams.TWindowK,
+             FluxParams.TauAtm,
+             FluxParams.TAtmK,
+             FluxParams.ReflWindow,
+             FluxParams.TReflK);
+
+    xSemaphoreTake(_CCIWorker_State.Mutex, portMAX_DELAY);
+    memcpy(&_CCIWorker_State.FluxParams, &FluxParams, sizeof(Lepton_FluxLinearParams_t));
+    _CCIWorker_State.hasFluxParams = true;
+    xSemaphoreGive(_CCIWorker_State.Mutex);
+
+    return ESP_OK;
+}
+
+/** @brief              Execute a request.
+ *  @param p_Request    Pointer to the request
+ *  @return             ESP_OK on success
+ */
+static esp_err_t CCIWorker_Execute(const CCIWorker_Request_t *p_Request)
+{
+    switch (p_Request->Command) {
+        case CCI_WORKER_CMD_SET_ROI: {
+            return CCIWorker_SetROI(&p_Request->Data.ROI);
+        }
+        case CCI_WORKER_CMD_SET_EMISSIVITY: {
+            if (Lepton_SetEmissivity(_CCIWorker_State.p_Lepton,
+                                     static_cast<Lepton_Emissivity_t>(p_Request->Data.Emissivity)) != LEPTON_ERR_OK) {
+                ESP_LOGE(TAG, "Failed to update emissivity to %u!", p_Request->Data.Emissivity);
+                return ESP_FAIL;
+            }
+
+            ESP_LOGD(TAG, "Updated emissivity to %u", p_Request->Data.Emissivity);
+
+            /* The emissivity is part of the flux parameters, so the cached copy is stale now */
+            CCIWorker_ReadFluxParameters();
+
+            return ESP_OK;
+        }
+        case CCI_WORKER_CMD_GET_TEMPERATURE: {
+            uint16_t FPA_Temp;
+            uint16_t AUX_Temp;
+            App_Lepton_Temperatures_t Temperatures;
+
+            if (Lepton_GetTemperature(_CCIWorker_State.p_Lepton, &FPA_Temp, &AUX_Temp) != LEPTON_ERR_OK) {
+                ESP_LOGW(TAG, "Failed to read FPA/AUX temperature!");
+                return ESP_FAIL;
+            }
+
+            Temperatures.FPA = (static_cast<float>(FPA_Temp) * 0.01f) - 273.0f;
+            Temperatures.AUX = (static_cast<float>(AUX_Temp) * 0.01f) - 273.0f;
+
+            Bus_Publish(BUS_TOPIC_LEPTON_TEMPERATURES, &Temperatures, sizeof(App_Lepton_Temperatures_t));
+
+            return ESP_OK;
+        }
+        case CCI_WORKER_CMD_GET_UPTIME: {
+            uint32_t Uptime;
+
+            Uptime = Lepton_GetUptime(_CCIWorker_State.p_Lepton);
+
+            Bus_Publish(BUS_TOPIC_LEPTON_UPTIME, &Uptime, sizeof(uint32_t));
+
+            return ESP_OK;
+        }
+        case CCI_WORKER_CMD_GET_SPOTMETER: {
+            return CCIWorker_GetSpotmeter();
+        }
+        case CCI_WORKER_CMD_GET_SCENE_STATISTICS: {
+            return CCIWorker_GetSceneStatistics();
+        }
+        default: {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+}
+
+/** @brief              CCI worker task main loop.
+ *  @param p_Parameters Unused
+ */
+static void Task_CCIWorker(void *p_Parameters)
+{
+    esp_task_wdt_add(NULL);
+
+    ESP_LOGD(TAG, "CCI worker started on core %d", xPortGetCoreID());
+
+    CCIWorker_ReadFluxParameters();
+
+    while (_CCIWorker_State.RunTask) {
+        CCIWorker_Pending_t Pending;
+
+        esp_task_wdt_reset();
+
+        /* Sleep until a request is submitted */
+        ulTaskNotifyTake(pdTRUE, 500 / portTICK_PERIOD_MS);
+
+        /* Drain everything that is pending, not only one request per wakeup */
+        while (_CCIWorker_State.RunTask && CCIWorker_TakeNext(&Pending)) {
+            esp_err_t Error;
+
+            TRACE_BEGIN_ARG(TRACE_EVENT_CCI, Pending.Request.Command);
+            Error = CCIWorker_Execute(&Pending.Request);
+            TRACE_END(TRACE_EVENT_CCI);
+
+            xSemaphoreTake(_CCIWorker_State.Mutex, portMAX_DELAY);
+            _CCIWorker_State.Statistics.Executed++;
+            if (Error != ESP_OK) {
+                _CCIWorker_State.Statistics.Failed++;
+            }
+            xSemaphoreGive(_CCIWorker_State.Mutex);
+
+            for (uint8_t i = 0; i < Pending.CallbackCount; i++) {
+                Pending.Callbacks[i](Pending.Request.Command, Error, Pending.Args[i]);
+            }
+
+            esp_task_wdt_reset();
+        }
+    }
+
+    ESP_LOGD(TAG, "CCI worker shutting down");
+
+    _CCIWorker_State.Running = false;
+    _CCIWorker_State.TaskHandle = NULL;
+
+    esp_task_wdt_delete(NULL);
+    vTaskDelete(NULL);
+}
+
+esp_err_t CCIWorker_Init(Lepton_t *p_Lepton)
+{
+    if (p_Lepton == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_CCIWorker_State.isInitialized) {
+        ESP_LOGW(TAG, "Already initialized");
+        return ESP_OK;
+    }
+
+    memset(&_CCIWorker_State, 0, sizeof(_CCIWorker_State));
+
+    _CCIWorker_State.Mutex = xSemaphoreCreateMutex();
+    if (_CCIWorker_State.Mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex!");
+        return ESP_ERR_NO_MEM;
+    }
+
+    _CCIWorker_State.p_Lepton = p_Lepton;
+    _CCIWorker_State.isInitialized = true;
+
+    return ESP_OK;
+}
+
+void CCIWorker_Deinit(void)
+{
+    if (_CCIWorker_State.isInitialized == false) {
+        return;
+    }
+
+    CCIWorker_Stop();
+
+    vSemaphoreDelete(_CCIWorker_State.Mutex);
+    _CCIWorker_State.Mutex = NULL;
+    _CCIWorker_State.p_Lepton = NULL;
+    _CCIWorker_State.isInitialized = false;
+}
+
+esp_err_t CCIWorker_Start(void)
+{
+    BaseType_t Ret;
+
+    if (_CCIWorker_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    } else if (_CCIWorker_State.Running) {
+        ESP_LOGW(TAG, "Task already Running");
+        return ESP_OK;
+    }
+
+    _CCIWorker_State.RunTask = true;
+
+    Ret = xTaskCreatePinnedToCore(
+              Task_CCIWorker,
+              "Task_CCI",
+              CONFIG_LEPTON_CCI_TASK_STACKSIZE,
+              NULL,
+              CONFIG_LEPTON_CCI_TASK_PRIO,
+              &_CCIWorker_State.TaskHandle,
+              CONFIG_LEPTON_CCI_TASK_CORE
+          );
+
+    if (Ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create CCI worker task: %d!", Ret);
+        _CCIWorker_State.RunTask = false;
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    _CCIWorker_State.Running = true;
+
+    /* Requests submitted before the start are pending already */
+    xTaskNotifyGive(_CCIWorker_State.TaskHandle);
+
+    return ESP_OK;
+}
+
+esp_err_t CCIWorker_Stop(void)
+{
+    if (_CCIWorker_State.Running == false) {
+        return ESP_OK;
+    }
+
+    _CCIWorker_State.RunTask = false;
+    xTaskNotifyGive(_CCIWorker_State.TaskHandle);
+
+    /* Wait for the task to finish the current CCI transfer */
+    for (int i = 0; i < 20 && _CCIWorker_State.Running; i++) {
+        vTaskDelay(50 / portTICK_PERIOD_MS);
+    }
+
+    xSemaphoreTake(_CCIWorker_State.Mutex, portMAX_DELAY);
+    _CCIWorker_State.PendingHigh = 0;
+    _CCIWorker_State.PendingLow = 0;
+    xSemaphoreGive(_CCIWorker_State.Mutex);
+
+    _CCIWorker_State.TaskHandle = NULL;
+    _CCIWorker_State.Running = false;
+
+    return ESP_OK;
+}
+
+esp_err_t CCIWorker_Submit(const CCIWorker_Request_t *p_Request, CCIWorker_Priority_t Priority)
+{
+    uint8_t Slot;
+    uint32_t Bit;
+    CCIWorker_Pending_t *p_Pending;
+
+    if (p_Request == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_CCIWorker_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    Slot = CCIWorker_GetSlot(p_Request);
+    if (Slot >= CCI_WORKER_SLOT_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    Bit = 1UL << Slot;
+    p_Pending = &_CCIWorker_State.Pending[Slot];
+
+    xSemaphoreTake(_CCIWorker_State.Mutex, portMAX_DELAY);
+
+    _CCIWorker_State.Statistics.Submitted++;
+    if ((_CCIWorker_State.PendingHigh | _CCIWorker_State.PendingLow) & Bit) {
+        _CCIWorker_State.Statistics.Coalesced++;
+    }
+
+    /* The newest data wins */
+    memcpy(&p_Pending->Request, p_Request, sizeof(CCIWorker_Request_t));
+
+    if ((p_Request->Callback != NULL) && (p_Pending->CallbackCount < CCI_WORKER_MAX_CALLBACKS)) {
+        p_Pending->Callbacks[p_Pending->CallbackCount] = p_Request->Callback;
+        p_Pending->Args[p_Pending->CallbackCount] = p_Request->p_Arg;
+        p_Pending->CallbackCount++;
+    } else if (p_Request->Callback != NULL) {
+        ESP_LOGW(TAG, "Too many callbacks for pending slot %u, dropping callback!", Slot);
+    }
+
+    /* A pending request can only be promoted */
+    if ((Priority == CCI_WORKER_PRIO_HIGH) || (_CCIWorker_State.PendingHigh & Bit)) {
+        _CCIWorker_State.PendingLow &= ~Bit;
+        _CCIWorker_State.PendingHigh |= Bit;
+    } else {
+        _CCIWorker_State.PendingLow |= Bit;
+    }
+
+    xSemaphoreGive(_CCIWorker_State.Mutex);
+
+    if (_CCIWorker_State.TaskHandle != NULL) {
+        xTaskNotifyGive(_CCIWorker_State.TaskHandle);
+    }
+
+    return ESP_OK;
+}
+
+void CCIWorker_GetStatistics(CCIWorker_Statistics_t *p_Statistics)
+{
+    if ((p_Statistics == NULL) || (_CCIWorker_State.isInitialized == false)) {
+        return;
+    }
+
+    xSemaphoreTake(_CCIWorker_State.Mutex, portMAX_DELAY);
+    memcpy(p_Statistics, &_CCIWorker_State.Statistics, sizeof(CCIWorker_Statistics_t));
+    xSemaphoreGive(_CCIWorker_State.Mutex);
+}
+
+esp_err_t CCIWorker_GetFluxParameters(Lepton_FluxLinearParams_t *p_Params)
+{
+    esp_err_t Error = ESP_OK;
+
+    if (p_Params == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_CCIWorker_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(_CCIWorker_State.Mutex, portMAX_DELAY);
+    if (_CCIWorker_State.hasFluxParams) {
+        memcpy(p_Params, &_CCIWorker_State.FluxParams, sizeof(Lepton_FluxLinearParams_t));
+    } else {
+        Error = ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreGive(_CCIWorker_State.Mutex);
+
+    return Error;
+}
@@ -0,0 +1,131 @@
+/*
+ * cciWorker.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Asynchronous Lepton CCI command worker.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef CCI_WORKER_H_
+#define CCI_WORKER_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lepton.h"
+#include "Application/application.h"
+
+/** @brief Maximum number of completion callbacks that can be attached to one pending command.
+ */
+#define CCI_WORKER_MAX_CALLBACKS                4
+
+/** @brief CCI worker commands.
+ *         The results of the GET commands are published to the matching BUS_TOPIC_LEPTON_* topic.
+ */
+typedef enum {
+    CCI_WORKER_CMD_SET_ROI,                     /**< Set a camera ROI. Data in ROI. */
+    CCI_WORKER_CMD_SET_EMISSIVITY,              /**< Set the scene emissivity. Data in Emissivity. */
+    CCI_WORKER_CMD_GET_TEMPERATURE,             /**< Read the FPA and AUX temperature. */
+    CCI_WORKER_CMD_GET_UPTIME,                  /**< Read the camera uptime. */
+    CCI_WORKER_CMD_GET_SPOTMETER,               /**< Get the spotmeter result. */
+    CCI_WORKER_CMD_GET_SCENE_STATISTICS,        /**< Get the scene statistics. */
+} CCIWorker_Command_t;
+
+/** @brief CCI worker request priorities. Pending high priority requests are always drained first.
+ */
+typedef enum {
+    CCI_WORKER_PRIO_LOW = 0,                    /**< Periodic readouts. */
+    CCI_WORKER_PRIO_HIGH,                       /**< User triggered configuration changes. */
+} CCIWorker_Priority_t;
+
+/** @brief              Completion callback. Called from the CCI worker task.
+ *  @param Command      Executed command
+ *  @param Error        ESP_OK when the command was successful
+ *  @param p_Arg        User argument passed on submit
+ */
+typedef void (*CCIWorker_Callback_t)(CCIWorker_Command_t Command, esp_err_t Error, void *p_Arg);
+
+/** @brief CCI worker request.
+ */
+typedef struct {
+    CCIWorker_Command_t Command;                /**< Command to execute. */
+    union {
+        App_Settings_ROI_t ROI;                 /**< ROI for CCI_WORKER_CMD_SET_ROI. */
+        uint16_t Emissivity;                    /**< Emissivity (multiplied by 100) for CCI_WORKER_CMD_SET_EMISSIVITY. */
+    } Data;
+    CCIWorker_Callback_t Callback;              /**< Optional completion callback. */
+    void *p_Arg;                                /**< User argument for the callback. */
+} CCIWorker_Request_t;
+
+/** @brief CCI worker statistics.
+ */
+typedef struct {
+    uint32_t Submitted;                         /**< Number of submitted requests. */
+    uint32_t Coalesced;                         /**< Number of requests merged into an already pending request. */
+    uint32_t Executed;                          /**< Number of executed commands. */
+    uint32_t Failed;                            /**< Number of failed commands. */
+} CCIWorker_Statistics_t;
+
+/** @brief          Initialize the CCI worker.
+ *  @param p_Lepton Pointer to the initialized Lepton device
+ *  @return         ESP_OK on success, error code otherwise
+ */
+esp_err_t CCIWorker_Init(Lepton_t *p_Lepton);
+
+/** @brief Deinitialize the CCI worker. Stops the worker task if it is running.
+ */
+void CCIWorker_Deinit(void);
+
+/** @brief  Start the CCI worker task.
+ *  @return ESP_OK on success, error code otherwise
+ */
+esp_err_t CCIWorker_Start(void);
+
+/** @brief  Stop the CCI worker task. Pending requests are dropped.
+ *  @return ESP_OK on success, error code otherwise
+ */
+esp_err_t CCIWorker_Stop(void);
+
+/** @brief              Submit a request. The request is merged with an identical pending request
+ *                      (same command, and same ROI type for CCI_WORKER_CMD_SET_ROI). The data of the newest
+ *                      request wins and all callbacks are called.
+ *  @param p_Request    Pointer to the request
+ *  @param Priority     Request priority
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if the request is invalid
+ *                      ESP_ERR_INVALID_STATE if the worker is not initialized
+ */
+esp_err_t CCIWorker_Submit(const CCIWorker_Request_t *p_Request, CCIWorker_Priority_t Priority);
+
+/** @brief              Get the worker statistics.
+ *  @param p_Statistics Pointer to the statistics output
+ */
+void CCIWorker_GetStatistics(CCIWorker_Statistics_t *p_Statistics);
+
+/** @brief          Get the radiometric parameters of the camera. The parameters are read when the worker is started
+ *                  and after every emissivity change, so no CCI transfer is needed here.
+ *  @param p_Params Pointer to store the parameters
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if p_Params is NULL
+ *                  ESP_ERR_INVALID_STATE if the parameters were not read yet
+ */
+esp_err_t CCIWorker_GetFluxParameters(Lepton_FluxLinearParams_t *p_Params);
+
+#endif /* CCI_WORKER_H_ */
@@ -0,0 +1,461 @@
+/*
+ * frameAGC.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Software AGC of RAW14 frames for the display.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_attr.h>
+
+#include <string.h>
+
+#include "frameAGC.h"
+#include "Application/Memory/memoryPlan.h"
+
+/** @brief Largest palette index of a curve in 8.8 fixed point.
+ */
+#define FRAME_AGC_CURVE_MAX                     (255 << 8)
+
+/** @brief Movement of a curve point in 8.8 fixed point that rebuilds the lookup table (half a palette step).
+ */
+#define FRAME_AGC_CURVE_HYSTERESIS              128
+
+static const char *TAG = "frame_agc";
+
+/** @brief          Move a smoothed value towards its target.
+ *  @param Current  Smoothed value
+ *  @param Target   New value
+ *  @param Damping  Weight of the new value in 1/256
+ *  @return         New smoothed value. Reaches the target, the last step is never rounded to zero
+ */
+static inline int32_t FrameAGC_Damp(int32_t Current, int32_t Target, uint16_t Damping)
+{
+    int32_t Difference;
+    int32_t Step;
+
+    Difference = Target - Current;
+    Step = (Difference * static_cast<int32_t>(Damping)) / 256;
+    if ((Step == 0) && (Difference != 0)) {
+        Step = (Difference > 0) ? 1 : -1;
+    }
+
+    return Current + Step;
+}
+
+/** @brief              Build a plateau equalization curve from a histogram.
+ *  @param p_Histogram  Histogram
+ *  @param Bins         Number of bins
+ *  @param Plateau      Bin limit in multiples of the mean bin count
+ *  @param Scale        Value of the last curve point
+ *  @param p_Curve      Bins + 1 curve points, smoothed towards the new curve
+ *  @param Damping      Weight of the new curve in 1/256
+ *  @param isFirst      true to take the new curve unsmoothed
+ */
+static void FrameAGC_Equalize(const uint16_t *p_Histogram, uint32_t Bins, uint32_t Plateau, uint32_t Scale,
+                              uint16_t *p_Curve, uint16_t Damping, bool isFirst)
+{
+    uint32_t Pixels;
+    uint32_t Limit;
+    uint32_t Total;
+    uint32_t Sum;
+
+    Pixels = 0;
+    for (uint32_t i = 0; i < Bins; i++) {
+        Pixels += p_Histogram[i];
+    }
+
+    /* Bins above the plateau are clipped, so large uniform areas (sky, wall) do not take most of the palette */
+    Limit = (Plateau * Pixels) / Bins;
+    Limit = (Limit > 0) ? Limit : 1;
+
+    Total = 0;
+    for (uint32_t i = 0; i < Bins; i++) {
+        Total += (p_Histogram[i] < Limit) ? p_Histogram[i] : Limit;
+    }
+
+    Sum = 0;
+    for (uint32_t i = 0; i <= Bins; i++) {
+        int32_t Target;
+
+        /* An empty histogram gives the linear curve */
+        Target = (Total > 0) ? static_cast<int32_t>((static_cast<uint64_t>(Sum) * Scale) / Total) :
+                 static_cast<int32_t>((i * Scale) / Bins);
+        p_Curve[i] = isFirst ? Target : FrameAGC_Damp(p_Curve[i], Target, Damping);
+
+        if (i < Bins) {
+            Sum += (p_Histogram[i] < Limit) ? p_Histogram[i] : Limit;
+        }
+    }
+}
+
+/** @brief              Update the window of the AGC.
+ *  @param p_AGC        Pointer to the AGC
+ *  @param p_Statistics Statistics of the frame
+ */
+static void FrameAGC_UpdateWindow(FrameAGC_t *p_AGC, const FrameStatistics_t *p_Statistics)
+{
+    uint32_t Range;
+    uint32_t Pixels;
+    uint32_t Clip;
+    uint32_t Sum;
+    uint32_t Lower;
+    uint32_t Upper;
+    int32_t Low;
+    int32_t High;
+
+    Range = p_Statistics->Max - p_Statistics->Min + 1;
+    Low = p_Statistics->Min;
+    High = p_Statistics->Max;
+
+    if (p_AGC->Config.Mode == FRAME_AGC_CLIP) {
+        Pixels = 0;
+        for (uint32_t i = 0; i < FRAME_STATISTICS_HISTOGRAM_BINS; i++) {
+            Pixels += p_Statistics->Histogram[i];
+        }
+
+        Clip = (Pixels * p_AGC->Config.Clip) / 1000;
+
+        /* First and last bin that are reached after Clip pixels from the cold and the hot end */
+        Sum = 0;
+        for (Lower = 0; Lower < (FRAME_STATISTICS_HISTOGRAM_BINS - 1); Lower++) {
+            Sum += p_Statistics->Histogram[Lower];
+            if (Sum > Clip) {
+                break;
+            }
+        }
+
+        Sum = 0;
+        for (Upper = FRAME_STATISTICS_HISTOGRAM_BINS - 1; Upper > Lower; Upper--) {
+            Sum += p_Statistics->Histogram[Upper];
+            if (Sum > Clip) {
+                break;
+            }
+        }
+
+        Low = p_Statistics->Min + ((Lower * Range) / FRAME_STATISTICS_HISTOGRAM_BINS);
+        High = p_Statistics->Min + ((((Upper + 1) * Range) / FRAME_STATISTICS_HISTOGRAM_BINS) - 1);
+        High = (High > Low) ? High : (Low + 1);
+    }
+
+    /* The linear mode follows every frame like the camera AGC. The curves of the equalization are relative to the
+       histogram of the frame, so their window can not be smoothed */
+    if ((p_AGC->Config.Mode == FRAME_AGC_LINEAR) || (p_AGC->Config.Mode == FRAME_AGC_HEQ) ||
+        (p_AGC->hasHistory == false)) {
+        p_AGC->WindowLow = Low << 4;
+        p_AGC->WindowHigh = High << 4;
+    } else {
+        p_AGC->WindowLow = FrameAGC_Damp(p_AGC->WindowLow, Low << 4, p_AGC->Config.Damping);
+        p_AGC->WindowHigh = FrameAGC_Damp(p_AGC->WindowHigh, High << 4, p_AGC->Config.Damping);
+    }
+
+    p_AGC->Low = static_cast<uint16_t>((p_AGC->WindowLow + 8) >> 4);
+    p_AGC->High = static_cast<uint16_t>((p_AGC->WindowHigh + 8) >> 4);
+    if (p_AGC->High <= p_AGC->Low) {
+        p_AGC->High = p_AGC->Low + 1;
+    }
+}
+
+/** @brief          Check if the smoothed curve has moved away from the curve of the lookup table.
+ *  @param p_AGC    Pointer to the AGC
+ *  @return         true when the lookup table has to be rebuilt
+ */
+static bool FrameAGC_isCurveMoved(const FrameAGC_t *p_AGC)
+{
+    for (uint32_t i = 0; i < PALETTE_LUT_CURVE_POINTS; i++) {
+        int32_t Difference = p_AGC->Curve[i] - p_AGC->Applied[i];
+
+        if ((Difference >= FRAME_AGC_CURVE_HYSTERESIS) || (Difference <= -FRAME_AGC_CURVE_HYSTERESIS)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/** @brief          Allocate the buffers of the local contrast mode and compute the column and row taps.
+ *  @param p_AGC    Pointer to the AGC
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_NO_MEM if a buffer can not be allocated
+ */
+static esp_err_t FrameAGC_InitLocal(FrameAGC_t *p_AGC)
+{
+    if (p_AGC->Local != NULL) {
+        return ESP_OK;
+    }
+
+    /* Written and read once per frame like the RAW frame. The taps are read for every pixel */
+    p_AGC->Local = reinterpret_cast<uint16_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME,
+                                                                 p_AGC->Width * p_AGC->Height * sizeof(uint16_t),
+                                                                 "agc_local"));
+    p_AGC->Taps = reinterpret_cast<FrameAGC_Tap_t *>(MemoryPlan_Alloc(MEMORY_REGION_FAST,
+                                                                      (p_AGC->Width + p_AGC->Height) *
+                                                                      sizeof(FrameAGC_Tap_t), "agc_taps"));
+    if ((p_AGC->Local == NULL) || (p_AGC->Taps == NULL)) {
+        ESP_LOGE(TAG, "Failed to allocate local contrast buffers!");
+
+        MemoryPlan_Free(p_AGC->Local);
+        MemoryPlan_Free(p_AGC->Taps);
+        p_AGC->Local = NULL;
+        p_AGC->Taps = NULL;
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* Every pixel blends the curves of the two nearest tile centers in each direction. The tile center of
+       column x is at (Tile + 0.5) * Size, the position is in 1/256 tiles */
+    for (uint32_t Axis = 0; Axis < 2; Axis++) {
+        uint32_t Length = (Axis == 0) ? p_AGC->Width : p_AGC->Height;
+        FrameAGC_Tap_t *p_Taps = (Axis == 0) ? p_AGC->Taps : &p_AGC->Taps[p_AGC->Width];
+
+        for (uint32_t i = 0; i < Length; i++) {
+            int32_t Position = static_cast<int32_t>((((2 * i) + 1) * FRAME_AGC_TILES * 128) / Length) - 128;
+
+            if (Position <= 0) {
+                p_Taps[i].First = 0;
+                p_Taps[i].Second = 0;
+                p_Taps[i].Weight = 0;
+            } else if (Position >= ((FRAME_AGC_TILES - 1) * 256)) {
+                p_Taps[i].First = FRAME_AGC_TILES - 1;
+                p_Taps[i].Second = FRAME_AGC_TILES - 1;
+                p_Taps[i].Weight = 0;
+            } else {
+                p_Taps[i].First = Position >> 8;
+                p_Taps[i].Second = (Position >> 8) + 1;
+                p_Taps[i].Weight = Position & 0xFF;
+            }
+        }
+    }
+
+    p_AGC->hasHistory = false;
+
+    return ESP_OK;
+}
+
+/** @brief              Local contrast kernel. Equalizes every tile and blends the curves of the four nearest tiles
+ *                      bilinearly, so there are no edges between the tiles.
+ *  @param p_AGC        Pointer to the AGC with the buffers of the local mode
+ *  @param p_RAW        RAW14 frame
+ */
+static IRAM_ATTR void FrameAGC_Local(FrameAGC_t *p_AGC, const uint16_t *p_RAW)
+{
+    uint16_t (*Histogram)[FRAME_AGC_TILE_BINS];
+    const FrameAGC_Tap_t *p_Columns;
+    const FrameAGC_Tap_t *p_Rows;
+    uint32_t Low;
+    uint32_t Span;
+    uint32_t Scale;
+    uint32_t Width;
+    uint32_t Height;
+
+    Width = p_AGC->Width;
+    Height = p_AGC->Height;
+    Low = p_AGC->Low;
+    Span = p_AGC->High - p_AGC->Low;
+
+    /* Position in the tile histogram in 16.16 fixed point. Span * Scale < 64 << 16 */
+    Scale = (FRAME_AGC_TILE_BINS << 16) / (Span + 1);
+
+    /* Pass 1: Histogram of every tile */
+    Histogram = p_AGC->TileHistogram;
+    memset(Histogram, 0, sizeof(p_AGC->TileHistogram));
+    for (uint32_t y = 0; y < Height; y++) {
+        uint16_t *p_Histograms = Histogram[((y * FRAME_AGC_TILES) / Height) * FRAME_AGC_TILES];
+        const uint16_t *p_Line = &p_RAW[y * Width];
+
+        for (uint32_t Tile = 0; Tile < FRAME_AGC_TILES; Tile++) {
+            uint32_t Start = (Tile * Width) / FRAME_AGC_TILES;
+            uint32_t End = ((Tile + 1) * Width) / FRAME_AGC_TILES;
+            uint16_t *p_Bins = &p_Histograms[Tile * FRAME_AGC_TILE_BINS];
+
+            for (uint32_t x = Start; x < End; x++) {
+                uint32_t Value = p_Line[x];
+
+                Value = (Value > Low) ? (Value - Low) : 0;
+                Value = (Value < Span) ? Value : Span;
+                p_Bins[(Value * Scale) >> 16]++;
+            }
+        }
+    }
+
+    for (uint32_t Tile = 0; Tile < FRAME_AGC_TILE_COUNT; Tile++) {
+        FrameAGC_Equalize(Histogram[Tile], FRAME_AGC_TILE_BINS, p_AGC->Config.Plateau, FRAME_AGC_LOCAL_LEVELS - 1,
+                          p_AGC->TileCurve[Tile], p_AGC->Config.Damping, p_AGC->hasHistory == false);
+    }
+
+    /* Pass 2: Level of every pixel from the curves of the four nearest tiles */
+    p_Columns = p_AGC->Taps;
+    p_Rows = &p_AGC->Taps[Width];
+
+    for (uint32_t y = 0; y < Height; y++) {
+        const uint16_t *p_Upper = p_AGC->TileCurve[p_Rows[y].First * FRAME_AGC_TILES];
+        const uint16_t *p_Lower = p_AGC->TileCurve[p_Rows[y].Second * FRAME_AGC_TILES];
+        int32_t RowWeight = p_Rows[y].Weight;
+        const uint16_t *p_Line = &p_RAW[y * Width];
+        uint16_t *p_Out = &p_AGC->Local[y * Width];
+
+        for (uint32_t x = 0; x < Width; x++) {
+            const FrameAGC_Tap_t *p_Tap = &p_Columns[x];
+            uint32_t Value = p_Line[x];
+            uint32_t Position;
+            uint32_t Bin;
+            int32_t Fraction;
+            int32_t Level[4];
+            const uint16_t *p_Curves[4];
+            int32_t Top;
+            int32_t Bottom;
+
+            Value = (Value > Low) ? (Value - Low) : 0;
+            Value = (Value < Span) ? Value : Span;
+            Position = Value * Scale;
+            Bin = Position >> 16;
+            Fraction = (Position >> 8) & 0xFF;
+
+            p_Curves[0] = &p_Upper[p_Tap->First * (FRAME_AGC_TILE_BINS + 1)];
+            p_Curves[1] = &p_Upper[p_Tap->Second * (FRAME_AGC_TILE_BINS + 1)];
+            p_Curves[2] = &p_Lower[p_Tap->First * (FRAME_AGC_TILE_BINS + 1)];
+            p_Curves[3] = &p_Lower[p_Tap->Second * (FRAME_AGC_TILE_BINS + 1)];
+
+            for (uint32_t i = 0; i < 4; i++) {
+                Level[i] = p_Curves[i][Bin] + (((p_Curves[i][Bin + 1] - p_Curves[i][Bin]) * Fraction) >> 8);
+            }
+
+            Top = Level[0] + (((Level[1] - Level[0]) * p_Tap->Weight) >> 8);
+            Bottom = Level[2] + (((Level[3] - Level[2]) * p_Tap->Weight) >> 8);
+            p_Out[x] = static_cast<uint16_t>(Top + (((Bottom - Top) * RowWeight) >> 8));
+        }
+    }
+}
+
+esp_err_t FrameAGC_Init(FrameAGC_t *p_AGC, uint16_t Width, uint16_t Height, const FrameAGC_Config_t *p_Config)
+{
+    if ((p_AGC == NULL) || (p_Config == NULL) || (Width < FRAME_AGC_TILES) || (Height < FRAME_AGC_TILES) ||
+        (p_Config->Mode >= FRAME_AGC_COUNT) || (p_Config->Plateau == 0) || (p_Config->Damping == 0) ||
+        (p_Config->Damping > 256) || (p_Config->Clip >= 500)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(p_AGC, 0, sizeof(FrameAGC_t));
+
+    p_AGC->Config = *p_Config;
+    p_AGC->Width = Width;
+    p_AGC->Height = Height;
+
+    if (p_AGC->Config.Mode == FRAME_AGC_LOCAL) {
+        return FrameAGC_InitLocal(p_AGC);
+    }
+
+    return ESP_OK;
+}
+
+void FrameAGC_Deinit(FrameAGC_t *p_AGC)
+{
+    if (p_AGC == NULL) {
+        return;
+    }
+
+    MemoryPlan_Free(p_AGC->Local);
+    MemoryPlan_Free(p_AGC->Taps);
+    p_AGC->Local = NULL;
+    p_AGC->Taps = NULL;
+    p_AGC->hasHistory = false;
+}
+
+esp_err_t FrameAGC_SetMode(FrameAGC_t *p_AGC, FrameAGC_Mode_t Mode)
+{
+    if ((p_AGC == NULL) || (Mode >= FRAME_AGC_COUNT)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (Mode == p_AGC->Config.Mode) {
+        return ESP_OK;
+    }
+
+    if (Mode == FRAME_AGC_LOCAL) {
+        esp_err_t Error = FrameAGC_InitLocal(p_AGC);
+
+        if (Error != ESP_OK) {
+            return Error;
+        }
+    }
+
+    p_AGC->Config.Mode = Mode;
+    p_AGC->hasHistory = false;
+
+    return ESP_OK;
+}
+
+void FrameAGC_Reset(FrameAGC_t *p_AGC)
+{
+    if (p_AGC != NULL) {
+        p_AGC->hasHistory = false;
+    }
+}
+
+const uint16_t *FrameAGC_Process(FrameAGC_t *p_AGC, const uint16_t *p_RAW, const FrameStatistics_t *p_Statistics,
+                                 PaletteLUT_t *p_LUT, PaletteLUT_Palette_t Palette)
+{
+    if ((p_AGC == NULL) || (p_RAW == NULL) || (p_Statistics == NULL) || (p_LUT == NULL)) {
+        return p_RAW;
+    }
+
+    FrameAGC_UpdateWindow(p_AGC, p_Statistics);
+
+    switch (p_AGC->Config.Mode) {
+        case FRAME_AGC_HEQ: {
+            FrameAGC_Equalize(p_Statistics->Histogram, FRAME_STATISTICS_HISTOGRAM_BINS, p_AGC->Config.Plateau,
+                              FRAME_AGC_CURVE_MAX, p_AGC->Curve, p_AGC->Config.Damping, p_AGC->hasHistory == false);
+
+            /* The window follows every frame and only costs the entries inside it. A curve that only moved a
+               little keeps the table of the previous frame */
+            if ((p_LUT->isValid == false) || (p_LUT->isCurve == false) || (p_LUT->Palette != Palette) ||
+                (p_LUT->Min != p_AGC->Low) || (p_LUT->Max != p_AGC->High) || FrameAGC_isCurveMoved(p_AGC)) {
+                memcpy(p_AGC->Applied, p_AGC->Curve, sizeof(p_AGC->Applied));
+                PaletteLUT_UpdateCurve(p_LUT, Palette, p_AGC->Low, p_AGC->High, p_AGC->Applied);
+            }
+
+            break;
+        }
+        case FRAME_AGC_LOCAL: {
+            if (p_AGC->Local == NULL) {
+                PaletteLUT_Update(p_LUT, Palette, p_AGC->Low, p_AGC->High);
+
+                break;
+            }
+
+            FrameAGC_Local(p_AGC, p_RAW);
+
+            /* The table maps the levels, it is only built once */
+            PaletteLUT_Update(p_LUT, Palette, 0, FRAME_AGC_LOCAL_LEVELS - 1);
+            p_AGC->hasHistory = true;
+
+            return p_AGC->Local;
+        }
+        default: {
+            /* The table is only rebuilt when the window has changed */
+            PaletteLUT_Update(p_LUT, Palette, p_AGC->Low, p_AGC->High);
+
+            break;
+        }
+    }
+
+    p_AGC->hasHistory = true;
+
+    return p_RAW;
+}
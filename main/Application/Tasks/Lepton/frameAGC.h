@@ -0,0 +1,144 @@
+/*
+ * frameAGC.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Software AGC of RAW14 frames for the display.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef FRAME_AGC_H_
+#define FRAME_AGC_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "paletteLUT.h"
+#include "frameStatistics.h"
+
+/** @brief Number of tiles in each direction of the local contrast mode.
+ */
+#define FRAME_AGC_TILES                         4
+#define FRAME_AGC_TILE_COUNT                    (FRAME_AGC_TILES * FRAME_AGC_TILES)
+
+/** @brief Number of histogram bins of a tile.
+ */
+#define FRAME_AGC_TILE_BINS                     64
+
+/** @brief Number of output levels of the local contrast mode.
+ */
+#define FRAME_AGC_LOCAL_LEVELS                  (1 << 14)
+
+/** @brief AGC mode.
+ */
+typedef enum {
+    FRAME_AGC_LINEAR = 0,                       /**< Linear between the minimum and the maximum of the frame. */
+    FRAME_AGC_CLIP,                             /**< Linear between two percentiles, hot and cold outliers saturate. */
+    FRAME_AGC_HEQ,                              /**< Plateau histogram equalization over the whole frame. */
+    FRAME_AGC_LOCAL,                            /**< Plateau histogram equalization per tile, blended between the
+                                                     tiles (local contrast). */
+    FRAME_AGC_COUNT,
+} FrameAGC_Mode_t;
+
+/** @brief AGC parameters.
+ */
+typedef struct {
+    FrameAGC_Mode_t Mode;
+    uint16_t Clip;                              /**< Pixels that saturate at each end in 1/1000 (CLIP). */
+    uint8_t Plateau;                            /**< Bin limit in multiples of the mean bin count (HEQ, LOCAL). 1
+                                                     is linear, higher values equalize more. */
+    uint16_t Damping;                           /**< Weight of the new frame in 1/256 (CLIP, HEQ, LOCAL). 256
+                                                     follows every frame, lower values smooth the window. */
+} FrameAGC_Config_t;
+
+/** @brief Blend of two neighbouring tiles for a column or a row of the local contrast mode.
+ */
+typedef struct {
+    uint8_t First;                              /**< Tile whose center is at or before the pixel. */
+    uint8_t Second;                             /**< Next tile, equal to First at the image border. */
+    uint16_t Weight;                            /**< Weight of Second in 1/256. */
+} FrameAGC_Tap_t;
+
+/** @brief AGC state. The window and the transfer curves are smoothed over the frames and the lookup table is only
+ *         rebuilt when the curve moves by more than half a palette step.
+ */
+typedef struct {
+    FrameAGC_Config_t Config;
+    bool hasHistory;                            /**< false until the first frame after a reset. */
+    bool isCurveValid;                          /**< The lookup table holds Applied. */
+    uint16_t Width;
+    uint16_t Height;
+    uint16_t Low;                               /**< Lower end of the window in raw counts. */
+    uint16_t High;                              /**< Upper end of the window in raw counts. */
+    int32_t WindowLow;                          /**< Smoothed window in 1/16 raw counts. */
+    int32_t WindowHigh;
+    uint16_t Curve[PALETTE_LUT_CURVE_POINTS];   /**< Smoothed HEQ curve, palette index in 8.8 per bin edge. */
+    uint16_t Applied[PALETTE_LUT_CURVE_POINTS]; /**< Curve of the lookup table. */
+    uint16_t TileCurve[FRAME_AGC_TILE_COUNT][FRAME_AGC_TILE_BINS + 1];  /**< Smoothed tile curves, output level
+                                                                            per bin edge. */
+    uint16_t TileHistogram[FRAME_AGC_TILE_COUNT][FRAME_AGC_TILE_BINS];  /**< Histograms of the tiles, kept off
+                                                                            the stack of the caller. */
+    uint16_t *Local;                            /**< Output of the local contrast mode, Width * Height levels. */
+    FrameAGC_Tap_t *Taps;                       /**< Width column taps followed by Height row taps. */
+} FrameAGC_t;
+
+/** @brief              Initialize the AGC. The buffers of the local contrast mode are only allocated for the
+ *                      LOCAL mode.
+ *  @param p_AGC        Pointer to the AGC
+ *  @param Width        Frame width in pixels
+ *  @param Height       Frame height in pixels
+ *  @param p_Config     AGC parameters
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if a parameter is invalid
+ *                      ESP_ERR_NO_MEM if the buffers of the local mode can not be allocated
+ */
+esp_err_t FrameAGC_Init(FrameAGC_t *p_AGC, uint16_t Width, uint16_t Height, const FrameAGC_Config_t *p_Config);
+
+/** @brief          Free the AGC.
+ *  @param p_AGC    Pointer to the AGC
+ */
+void FrameAGC_Deinit(FrameAGC_t *p_AGC);
+
+/** @brief          Change the mode. The buffers of the local mode are allocated when it is selected the first time.
+ *  @param p_AGC    Pointer to the AGC
+ *  @param Mode     New mode
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if the mode is invalid
+ *                  ESP_ERR_NO_MEM if the buffers of the local mode can not be allocated, the mode is not changed
+ */
+esp_err_t FrameAGC_SetMode(FrameAGC_t *p_AGC, FrameAGC_Mode_t Mode);
+
+/** @brief          Drop the smoothed window and curves, e.g. after the frame source has changed.
+ *  @param p_AGC    Pointer to the AGC
+ */
+void FrameAGC_Reset(FrameAGC_t *p_AGC);
+
+/** @brief              Update the AGC with a frame and bring the lookup table up to date. The histogram of the
+ *                      frame statistics is used for all global modes, only the local mode reads the pixels.
+ *  @param p_AGC        Pointer to the AGC
+ *  @param p_RAW        RAW14 frame
+ *  @param p_Statistics Statistics of the frame
+ *  @param p_LUT        Lookup table of the display
+ *  @param Palette      Palette of the display
+ *  @return             Image to map through the lookup table: p_RAW, or the output of the local mode
+ */
+const uint16_t *FrameAGC_Process(FrameAGC_t *p_AGC, const uint16_t *p_RAW, const FrameStatistics_t *p_Statistics,
+                                 PaletteLUT_t *p_LUT, PaletteLUT_Palette_t Palette);
+
+#endif /* FRAME_AGC_H_ */
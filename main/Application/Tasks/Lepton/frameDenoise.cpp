@@ -0,0 +1,188 @@
+/*
+ * frameDenoise.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Motion adaptive temporal noise reduction of RAW14 frames.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_attr.h>
+
+#include <string.h>
+
+#include "frameDenoise.h"
+#include "Application/Memory/memoryPlan.h"
+
+/** @brief Parameters of a strength.
+ */
+typedef struct {
+    uint16_t Alpha;                             /**< Weight of the new pixel of a static area in 1/256. */
+    uint16_t Motion;                            /**< Difference in raw counts from which the new pixel is taken
+                                                     unchanged. */
+} FrameDenoise_Parameters_t;
+
+/* A static Lepton scene shows a noise of about 5 counts (50 mK NETD), a moving edge a difference of hundreds */
+static const FrameDenoise_Parameters_t _FrameDenoise_Parameters[FRAME_DENOISE_COUNT] = {
+    [FRAME_DENOISE_OFF] = {256, 1},
+    [FRAME_DENOISE_LOW] = {128, 24},
+    [FRAME_DENOISE_MEDIUM] = {80, 40},
+    [FRAME_DENOISE_HIGH] = {48, 64},
+};
+
+static const char *TAG = "frame_denoise";
+
+/** @brief          Blend one pixel with its history.
+ *  @param Alpha    Blend table
+ *  @param Previous Filtered pixel of the previous frame
+ *  @param Current  Pixel of the new frame
+ *  @return         Filtered pixel, between Previous and Current
+ */
+static inline uint32_t FrameDenoise_Blend(const uint16_t *Alpha, uint32_t Previous, uint32_t Current)
+{
+    int32_t Difference;
+    uint32_t Index;
+
+    Difference = static_cast<int32_t>(Current) - static_cast<int32_t>(Previous);
+    Index = static_cast<uint32_t>((Difference < 0) ? -Difference : Difference) >> 1;
+    Index = (Index < FRAME_DENOISE_LUT_SIZE) ? Index : (FRAME_DENOISE_LUT_SIZE - 1);
+
+    /* Previous * 256 + Difference * Alpha stays between both pixels * 256, so the sum is never negative */
+    return static_cast<uint32_t>((static_cast<int32_t>(Previous << 8) + (Difference * Alpha[Index]) + 128)) >> 8;
+}
+
+esp_err_t FrameDenoise_Init(FrameDenoise_t *p_Denoise, uint16_t Width, uint16_t Height,
+                            FrameDenoise_Strength_t Strength)
+{
+    if ((p_Denoise == NULL) || (Width == 0) || (Height == 0) || (Strength >= FRAME_DENOISE_COUNT)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(p_Denoise, 0, sizeof(FrameDenoise_t));
+
+    /* Read and written once per pixel and frame, like the frame pool */
+    p_Denoise->History = reinterpret_cast<uint16_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME,
+                                                                       Width * Height * sizeof(uint16_t),
+                                                                       "denoise_history"));
+    if (p_Denoise->History == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate history!");
+        return ESP_ERR_NO_MEM;
+    }
+
+    p_Denoise->Width = Width;
+    p_Denoise->Height = Height;
+
+    return FrameDenoise_SetStrength(p_Denoise, Strength);
+}
+
+void FrameDenoise_Deinit(FrameDenoise_t *p_Denoise)
+{
+    if ((p_Denoise == NULL) || (p_Denoise->History == NULL)) {
+        return;
+    }
+
+    MemoryPlan_Free(p_Denoise->History);
+    p_Denoise->History = NULL;
+    p_Denoise->hasHistory = false;
+}
+
+esp_err_t FrameDenoise_SetStrength(FrameDenoise_t *p_Denoise, FrameDenoise_Strength_t Strength)
+{
+    const FrameDenoise_Parameters_t *p_Parameters;
+
+    if ((p_Denoise == NULL) || (Strength >= FRAME_DENOISE_COUNT)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    p_Parameters = &_FrameDenoise_Parameters[Strength];
+
+    /* The weight rises linearly from Alpha for a static pixel to 256 at the motion threshold */
+    for (uint32_t i = 0; i < FRAME_DENOISE_LUT_SIZE; i++) {
+        uint32_t Difference = i << 1;
+
+        if (Difference >= p_Parameters->Motion) {
+            p_Denoise->Alpha[i] = 256;
+        } else {
+            p_Denoise->Alpha[i] = p_Parameters->Alpha + (((256 - p_Parameters->Alpha) * Difference) /
+                                                         p_Parameters->Motion);
+        }
+    }
+
+    /* The history is only tracked while the filter is on */
+    if (p_Denoise->Strength == FRAME_DENOISE_OFF) {
+        p_Denoise->hasHistory = false;
+    }
+
+    p_Denoise->Strength = Strength;
+
+    return ESP_OK;
+}
+
+void FrameDenoise_Reset(FrameDenoise_t *p_Denoise)
+{
+    if (p_Denoise != NULL) {
+        p_Denoise->hasHistory = false;
+    }
+}
+
+/** @brief Filter kernel. Processes two pixels per iteration, the new frame and the history are each read and written
+ *         once.
+ */
+IRAM_ATTR void FrameDenoise_Apply(FrameDenoise_t *p_Denoise, uint16_t *p_RAW)
+{
+    uint32_t Count;
+    uint32_t Pairs;
+    uint16_t *p_History;
+    const uint16_t *Alpha;
+
+    if ((p_Denoise == NULL) || (p_Denoise->History == NULL) || (p_RAW == NULL) ||
+        (p_Denoise->Strength == FRAME_DENOISE_OFF)) {
+        return;
+    }
+
+    Count = p_Denoise->Width * p_Denoise->Height;
+
+    if (p_Denoise->hasHistory == false) {
+        memcpy(p_Denoise->History, p_RAW, Count * sizeof(uint16_t));
+        p_Denoise->hasHistory = true;
+
+        return;
+    }
+
+    Pairs = Count / 2;
+    p_History = p_Denoise->History;
+    Alpha = p_Denoise->Alpha;
+
+    for (uint32_t i = 0; i < Pairs; i++) {
+        uint32_t a = FrameDenoise_Blend(Alpha, p_History[0], p_RAW[0]);
+        uint32_t b = FrameDenoise_Blend(Alpha, p_History[1], p_RAW[1]);
+
+        p_RAW[0] = static_cast<uint16_t>(a);
+        p_RAW[1] = static_cast<uint16_t>(b);
+        p_History[0] = static_cast<uint16_t>(a);
+        p_History[1] = static_cast<uint16_t>(b);
+
+        p_RAW += 2;
+        p_History += 2;
+    }
+
+    if (Count & 1) {
+        *p_RAW = static_cast<uint16_t>(FrameDenoise_Blend(Alpha, *p_History, *p_RAW));
+        *p_History = *p_RAW;
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ * frameDenoise.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Motion adaptive temporal noise reduction of RAW14 frames.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef FRAME_DENOISE_H_
+#define FRAME_DENOISE_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Number of entries of the blend table. Entry n is used for a frame to frame difference of 2n and 2n + 1
+ *         raw counts, larger differences use the last entry.
+ */
+#define FRAME_DENOISE_LUT_SIZE                  64
+
+/** @brief Strength of the noise reduction.
+ */
+typedef enum {
+    FRAME_DENOISE_OFF = 0,                      /**< Frames are not changed. */
+    FRAME_DENOISE_LOW,                          /**< Half of every new frame, short trails. */
+    FRAME_DENOISE_MEDIUM,                       /**< About a third of every new frame. */
+    FRAME_DENOISE_HIGH,                         /**< About a fifth of every new frame, for static scenes. */
+    FRAME_DENOISE_COUNT,
+} FrameDenoise_Strength_t;
+
+/** @brief Recursive filter state. Every pixel is blended with the filtered pixel of the previous frame. The weight
+ *         of the new pixel grows with the difference to the previous frame, so moving edges and real temperature
+ *         changes pass through while the noise of static areas is averaged.
+ */
+typedef struct {
+    FrameDenoise_Strength_t Strength;
+    bool hasHistory;                            /**< false until the first frame after a reset was stored. */
+    uint16_t Width;
+    uint16_t Height;
+    uint16_t Alpha[FRAME_DENOISE_LUT_SIZE];     /**< Weight of the new pixel in 1/256 per difference. */
+    uint16_t *History;                          /**< Filtered previous frame, Width * Height pixels. */
+} FrameDenoise_t;
+
+/** @brief              Allocate the filter for a frame size.
+ *  @param p_Denoise    Pointer to the filter
+ *  @param Width        Frame width in pixels
+ *  @param Height       Frame height in pixels
+ *  @param Strength     Initial strength
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if a parameter is invalid
+ *                      ESP_ERR_NO_MEM if the history can not be allocated
+ */
+esp_err_t FrameDenoise_Init(FrameDenoise_t *p_Denoise, uint16_t Width, uint16_t Height,
+                            FrameDenoise_Strength_t Strength);
+
+/** @brief              Free the filter.
+ *  @param p_Denoise    Pointer to the filter
+ */
+void FrameDenoise_Deinit(FrameDenoise_t *p_Denoise);
+
+/** @brief              Change the strength. The history is kept, so the change does not restart the filter.
+ *  @param p_Denoise    Pointer to the filter
+ *  @param Strength     New strength
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if the strength is invalid
+ */
+esp_err_t FrameDenoise_SetStrength(FrameDenoise_t *p_Denoise, FrameDenoise_Strength_t Strength);
+
+/** @brief              Drop the history, e.g. when the frame source changes. The next frame passes unchanged.
+ *  @param p_Denoise    Pointer to the filter
+ */
+void FrameDenoise_Reset(FrameDenoise_t *p_Denoise);
+
+/** @brief              Filter a RAW14 frame in place.
+ *  @param p_Denoise    Pointer to an initialized filter
+ *  @param p_RAW        RAW14 frame with the size of the filter, overwritten with the filtered frame
+ */
+void FrameDenoise_Apply(FrameDenoise_t *p_Denoise, uint16_t *p_RAW);
+
+#endif /* FRAME_DENOISE_H_ */
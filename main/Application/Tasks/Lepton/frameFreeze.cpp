@@ -0,0 +1,132 @@
+/*
+ * frameFreeze.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Detection of repeated frames during the flat field correction.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_attr.h>
+
+#include <string.h>
+
+#include "frameFreeze.h"
+
+#define FRAME_FREEZE_FNV_OFFSET                 2166136261UL
+#define FRAME_FREEZE_FNV_PRIME                  16777619UL
+
+esp_err_t FrameFreeze_Init(FrameFreeze_t *p_Freeze, uint8_t Confirm)
+{
+    if ((p_Freeze == NULL) || (Confirm == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(p_Freeze, 0, sizeof(FrameFreeze_t));
+    p_Freeze->Confirm = Confirm;
+
+    return ESP_OK;
+}
+
+void FrameFreeze_Reset(FrameFreeze_t *p_Freeze)
+{
+    if (p_Freeze == NULL) {
+        return;
+    }
+
+    p_Freeze->hasHistory = false;
+    p_Freeze->hasCounter = false;
+    p_Freeze->isFrozen = false;
+    p_Freeze->Repeats = 0;
+}
+
+IRAM_ATTR uint32_t FrameFreeze_Hash(const void *p_Data, size_t Size)
+{
+    const uint32_t *p_Words;
+    const uint8_t *p_Tail;
+    uint32_t Hash;
+    size_t Words;
+
+    p_Words = reinterpret_cast<const uint32_t *>(p_Data);
+    Words = Size / sizeof(uint32_t);
+    Hash = FRAME_FREEZE_FNV_OFFSET;
+
+    /* Two pixels per step, a byte wise FNV would need four times the multiplications */
+    for (size_t i = 0; i < Words; i++) {
+        Hash = (Hash ^ p_Words[i]) * FRAME_FREEZE_FNV_PRIME;
+    }
+
+    p_Tail = reinterpret_cast<const uint8_t *>(p_Words + Words);
+    for (size_t i = 0; i < (Size % sizeof(uint32_t)); i++) {
+        Hash = (Hash ^ p_Tail[i]) * FRAME_FREEZE_FNV_PRIME;
+    }
+
+    return Hash;
+}
+
+bool FrameFreeze_Check(FrameFreeze_t *p_Freeze, const void *p_Data, size_t Size, const uint32_t *p_Counter,
+                       int64_t Timestamp, FrameFreeze_Event_t *p_Event, FrameFreeze_Info_t *p_Info)
+{
+    FrameFreeze_Info_t Info;
+    uint32_t Hash;
+    bool isRepeat;
+
+    *p_Event = FRAME_FREEZE_EVENT_NONE;
+
+    /* An unchanged frame counter is a repeat without hashing the frame */
+    if (p_Freeze->hasHistory && p_Freeze->hasCounter && (p_Counter != NULL) && (*p_Counter == p_Freeze->Counter)) {
+        isRepeat = true;
+        Hash = p_Freeze->Hash;
+    } else {
+        Hash = FrameFreeze_Hash(p_Data, Size);
+        isRepeat = p_Freeze->hasHistory && (Hash == p_Freeze->Hash);
+    }
+
+    Info.Number = p_Freeze->Count;
+    Info.Frames = p_Freeze->Repeats;
+    Info.Duration = static_cast<uint32_t>((Timestamp - p_Freeze->Timestamp) / 1000);
+
+    if (isRepeat) {
+        p_Freeze->Repeats++;
+        Info.Frames = p_Freeze->Repeats;
+
+        if ((p_Freeze->isFrozen == false) && (p_Freeze->Repeats >= p_Freeze->Confirm)) {
+            p_Freeze->isFrozen = true;
+            p_Freeze->Count++;
+            Info.Number = p_Freeze->Count;
+            *p_Event = FRAME_FREEZE_EVENT_STARTED;
+        }
+    } else {
+        if (p_Freeze->isFrozen) {
+            p_Freeze->isFrozen = false;
+            *p_Event = FRAME_FREEZE_EVENT_FINISHED;
+        }
+
+        p_Freeze->hasHistory = true;
+        p_Freeze->hasCounter = (p_Counter != NULL);
+        p_Freeze->Counter = (p_Counter != NULL) ? *p_Counter : 0;
+        p_Freeze->Hash = Hash;
+        p_Freeze->Timestamp = Timestamp;
+        p_Freeze->Repeats = 0;
+    }
+
+    if ((p_Info != NULL) && (*p_Event != FRAME_FREEZE_EVENT_NONE)) {
+        memcpy(p_Info, &Info, sizeof(FrameFreeze_Info_t));
+    }
+
+    return isRepeat;
+}
@@ -0,0 +1,99 @@
+/*
+ * frameFreeze.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Detection of repeated frames during the flat field correction.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef FRAME_FREEZE_H_
+#define FRAME_FREEZE_H_
+
+#include <esp_err.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief State change of a check.
+ */
+typedef enum {
+    FRAME_FREEZE_EVENT_NONE = 0,
+    FRAME_FREEZE_EVENT_STARTED,                 /**< The camera repeats its frames, e.g. for a flat field correction. */
+    FRAME_FREEZE_EVENT_FINISHED,                /**< The first new frame after a freeze. */
+} FrameFreeze_Event_t;
+
+/** @brief Summary of a freeze. Filled with FRAME_FREEZE_EVENT_STARTED and completed with
+ *         FRAME_FREEZE_EVENT_FINISHED.
+ */
+typedef struct {
+    uint32_t Number;                            /**< Number of the freeze since the reset, starting at 1. */
+    uint32_t Frames;                            /**< Repeated frames so far. */
+    uint32_t Duration;                          /**< Time since the last new frame in ms. */
+} FrameFreeze_Info_t;
+
+/** @brief Detector state. The shutter of the Lepton closes for a flat field correction and the camera repeats the
+ *         last frame in the meantime. A repeated frame is bit identical, a frame of a real scene never is because of
+ *         the sensor noise, so a hash of the frame finds the repeats without a copy of the previous frame.
+ */
+typedef struct {
+    uint8_t Confirm;                            /**< Repeated frames until a freeze is reported. */
+    bool hasHistory;                            /**< false until the first frame after a reset was checked. */
+    bool hasCounter;                            /**< Counter is valid. */
+    bool isFrozen;
+    uint32_t Hash;                              /**< Hash of the last new frame. */
+    uint32_t Counter;                           /**< Telemetry frame counter of the last new frame. */
+    int64_t Timestamp;                          /**< Time of the last new frame in microseconds. */
+    uint32_t Repeats;                           /**< Repeated frames since the last new frame. */
+    uint32_t Count;                             /**< Number of freezes since the reset. */
+} FrameFreeze_t;
+
+/** @brief              Initialize the detector.
+ *  @param p_Freeze     Pointer to the detector
+ *  @param Confirm      Repeated frames until a freeze is reported, at least 1
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if a parameter is invalid
+ */
+esp_err_t FrameFreeze_Init(FrameFreeze_t *p_Freeze, uint8_t Confirm);
+
+/** @brief              Forget the last frame, e.g. when the frame source changes. The next frame is always new.
+ *  @param p_Freeze     Pointer to the detector
+ */
+void FrameFreeze_Reset(FrameFreeze_t *p_Freeze);
+
+/** @brief          Hash of a frame buffer (FNV-1a over 32 bit words).
+ *  @param p_Data   Frame data, 32 bit aligned
+ *  @param Size     Size of the data in bytes
+ *  @return         Hash
+ */
+uint32_t FrameFreeze_Hash(const void *p_Data, size_t Size);
+
+/** @brief              Check if a frame of the camera repeats the last new frame.
+ *  @param p_Freeze     Pointer to an initialized detector
+ *  @param p_Data       Frame as received from the camera, 32 bit aligned
+ *  @param Size         Size of the frame in bytes
+ *  @param p_Counter    Telemetry frame counter of the frame or NULL without telemetry
+ *  @param Timestamp    Time of the frame in microseconds
+ *  @param p_Event      Set to the state change of this frame
+ *  @param p_Info       Filled when p_Event is not FRAME_FREEZE_EVENT_NONE. May be NULL
+ *  @return             true if the frame is a repeat and should be dropped
+ */
+bool FrameFreeze_Check(FrameFreeze_t *p_Freeze, const void *p_Data, size_t Size, const uint32_t *p_Counter,
+                       int64_t Timestamp, FrameFreeze_Event_t *p_Event, FrameFreeze_Info_t *p_Info);
+
+#endif /* FRAME_FREEZE_H_ */
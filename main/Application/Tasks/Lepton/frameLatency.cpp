@@ -0,0 +1,232 @@
+/*
+ * frameLatency.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Latency of the frames through the pipeline stages.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_timer.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <string.h>
+
+#include "frameLatency.h"
+
+/** @brief Time in microseconds after the last frame of a stage in which skipped frames count as drops. A stage that
+ *         was idle, e.g. without a connected client, does not drop the frames in between.
+ */
+#define FRAME_LATENCY_ACTIVE_US                 1000000
+
+typedef struct {
+    bool isPending;                             /**< Latency holds a frame that is not in the histogram yet. */
+    uint32_t Sequence;                          /**< Sequence number of the last frame. */
+    uint32_t Latency;                           /**< Latency of the last frame in microseconds. */
+    int64_t Time;                               /**< Time of the last mark in microseconds. */
+    uint32_t Frames;
+    uint32_t Drops;
+    uint32_t Count;                             /**< Frames in the histogram. */
+    uint32_t Max;                               /**< Maximum of the current window. */
+    uint32_t PreviousMax;                       /**< Maximum of the previous window. */
+    uint16_t Histogram[FRAME_LATENCY_BUCKETS];
+} FrameLatency_Stage_State_t;
+
+static FrameLatency_Stage_State_t _FrameLatency_Stages[FRAME_LATENCY_STAGE_COUNT];
+
+/* Marked from the Lepton, GUI, network and httpd tasks */
+static portMUX_TYPE _FrameLatency_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *_FrameLatency_StageNames[FRAME_LATENCY_STAGE_COUNT] = {
+    "publish",
+    "colorize",
+    "scale",
+    "display",
+    "encode",
+    "send",
+};
+
+/* The colorization is only done on demand, so skipped frames are no drops there. The Lepton task counts its drops */
+static const bool _FrameLatency_CountGaps[FRAME_LATENCY_STAGE_COUNT] = {
+    false,
+    false,
+    true,
+    true,
+    true,
+    true,
+};
+
+/** @brief          Move the pending frame of a stage into its histogram. Call with the lock taken.
+ *  @param p_Stage  Stage
+ */
+static void FrameLatency_Commit(FrameLatency_Stage_State_t *p_Stage)
+{
+    uint32_t Bucket;
+
+    Bucket = p_Stage->Latency / FRAME_LATENCY_BUCKET_US;
+    if (Bucket >= FRAME_LATENCY_BUCKETS) {
+        Bucket = FRAME_LATENCY_BUCKETS - 1;
+    }
+
+    /* Halving keeps the shape of the histogram and lets the older frames fade out */
+    if (p_Stage->Count >= FRAME_LATENCY_WINDOW) {
+        p_Stage->Count = 0;
+        for (uint32_t i = 0; i < FRAME_LATENCY_BUCKETS; i++) {
+            p_Stage->Histogram[i] /= 2;
+            p_Stage->Count += p_Stage->Histogram[i];
+        }
+
+        p_Stage->PreviousMax = p_Stage->Max;
+        p_Stage->Max = 0;
+    }
+
+    p_Stage->Histogram[Bucket]++;
+    p_Stage->Count++;
+    p_Stage->Frames++;
+
+    if (p_Stage->Latency > p_Stage->Max) {
+        p_Stage->Max = p_Stage->Latency;
+    }
+
+    p_Stage->isPending = false;
+}
+
+/** @brief          Get a percentile of the histogram of a stage. Call with the lock taken.
+ *  @param p_Stage  Stage
+ *  @param Percent  Percentile
+ *  @param Max      Maximum latency in microseconds
+ *  @return         Upper end of the bucket of the percentile in microseconds, limited to Max
+ */
+static uint32_t FrameLatency_Percentile(const FrameLatency_Stage_State_t *p_Stage, uint32_t Percent, uint32_t Max)
+{
+    uint32_t Target;
+    uint32_t Sum;
+
+    if (p_Stage->Count == 0) {
+        return 0;
+    }
+
+    Target = ((p_Stage->Count * Percent) + 99) / 100;
+    Sum = 0;
+
+    for (uint32_t i = 0; i < FRAME_LATENCY_BUCKETS; i++) {
+        Sum += p_Stage->Histogram[i];
+        if (Sum >= Target) {
+            uint32_t Value = (i + 1) * FRAME_LATENCY_BUCKET_US;
+
+            return (Value < Max) ? Value : Max;
+        }
+    }
+
+    return Max;
+}
+
+void FrameLatency_Mark(FrameLatency_Stage_t Stage, uint32_t Sequence, int64_t Timestamp)
+{
+    FrameLatency_Stage_State_t *p_Stage;
+    int64_t Now;
+    uint32_t Latency;
+
+    if (Stage >= FRAME_LATENCY_STAGE_COUNT) {
+        return;
+    }
+
+    Now = esp_timer_get_time();
+    Latency = (Now > Timestamp) ? static_cast<uint32_t>(Now - Timestamp) : 0;
+    p_Stage = &_FrameLatency_Stages[Stage];
+
+    portENTER_CRITICAL(&_FrameLatency_Lock);
+    if ((p_Stage->Sequence != 0) && (Sequence == p_Stage->Sequence)) {
+        /* The same frame again, e.g. for the next client */
+        if (p_Stage->isPending && (Latency > p_Stage->Latency)) {
+            p_Stage->Latency = Latency;
+        }
+    } else if ((p_Stage->Sequence == 0) || (Sequence > p_Stage->Sequence)) {
+        if (p_Stage->isPending) {
+            FrameLatency_Commit(p_Stage);
+        }
+
+        if (_FrameLatency_CountGaps[Stage] && (p_Stage->Sequence != 0) && (Sequence > (p_Stage->Sequence + 1)) &&
+            ((Now - p_Stage->Time) < FRAME_LATENCY_ACTIVE_US)) {
+            p_Stage->Drops += Sequence - p_Stage->Sequence - 1;
+        }
+
+        p_Stage->Sequence = Sequence;
+        p_Stage->Latency = Latency;
+        p_Stage->isPending = true;
+    }
+    p_Stage->Time = Now;
+    portEXIT_CRITICAL(&_FrameLatency_Lock);
+}
+
+void FrameLatency_Drop(FrameLatency_Stage_t Stage)
+{
+    if (Stage >= FRAME_LATENCY_STAGE_COUNT) {
+        return;
+    }
+
+    portENTER_CRITICAL(&_FrameLatency_Lock);
+    _FrameLatency_Stages[Stage].Drops++;
+    portEXIT_CRITICAL(&_FrameLatency_Lock);
+}
+
+void FrameLatency_Get(FrameLatency_Stage_t Stage, FrameLatency_Stats_t *p_Stats)
+{
+    const FrameLatency_Stage_State_t *p_Stage;
+    uint32_t Max;
+
+    if (p_Stats == NULL) {
+        return;
+    }
+
+    memset(p_Stats, 0, sizeof(FrameLatency_Stats_t));
+
+    if (Stage >= FRAME_LATENCY_STAGE_COUNT) {
+        return;
+    }
+
+    p_Stage = &_FrameLatency_Stages[Stage];
+
+    portENTER_CRITICAL(&_FrameLatency_Lock);
+    Max = (p_Stage->Max > p_Stage->PreviousMax) ? p_Stage->Max : p_Stage->PreviousMax;
+
+    p_Stats->Frames = p_Stage->Frames;
+    p_Stats->Drops = p_Stage->Drops;
+    p_Stats->Sequence = p_Stage->Sequence;
+    p_Stats->Last = p_Stage->Latency;
+    p_Stats->P50 = FrameLatency_Percentile(p_Stage, 50, Max);
+    p_Stats->P99 = FrameLatency_Percentile(p_Stage, 99, Max);
+    p_Stats->Max = Max;
+    portEXIT_CRITICAL(&_FrameLatency_Lock);
+}
+
+void FrameLatency_Reset(void)
+{
+    portENTER_CRITICAL(&_FrameLatency_Lock);
+    memset(_FrameLatency_Stages, 0, sizeof(_FrameLatency_Stages));
+    portEXIT_CRITICAL(&_FrameLatency_Lock);
+}
+
+const char *FrameLatency_GetStageName(FrameLatency_Stage_t Stage)
+{
+    if (Stage >= FRAME_LATENCY_STAGE_COUNT) {
+        return "unknown";
+    }
+
+    return _FrameLatency_StageNames[Stage];
+}
@@ -0,0 +1,97 @@
+/*
+ * frameLatency.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Latency of the frames through the pipeline stages.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef FRAME_LATENCY_H_
+#define FRAME_LATENCY_H_
+
+#include <stdint.h>
+
+/** @brief Width of a histogram bucket in microseconds.
+ */
+#define FRAME_LATENCY_BUCKET_US                 1000
+
+/** @brief Number of histogram buckets. The last bucket holds all latencies above the range.
+ */
+#define FRAME_LATENCY_BUCKETS                   256
+
+/** @brief Number of frames after which the histogram of a stage is halved, so old frames fade out.
+ */
+#define FRAME_LATENCY_WINDOW                    1024
+
+/** @brief Stages of the frame pipeline. The latency of a stage is the time from the VoSPI frame to the end of the
+ *         stage, so the stages of one consumer add up.
+ */
+typedef enum {
+    FRAME_LATENCY_PUBLISH = 0,                  /**< Frame published by the Lepton task. */
+    FRAME_LATENCY_COLORIZE,                     /**< RGB888 image computed on request after the publish. */
+    FRAME_LATENCY_SCALE,                        /**< Frame scaled into the thermal canvas of the GUI. */
+    FRAME_LATENCY_DISPLAY,                      /**< Thermal canvas handed to the display. */
+    FRAME_LATENCY_ENCODE,                       /**< Frame encoded for the WebSocket clients. */
+    FRAME_LATENCY_SEND,                         /**< Frame sent to the last WebSocket client. */
+    FRAME_LATENCY_STAGE_COUNT,
+} FrameLatency_Stage_t;
+
+/** @brief Statistics of a stage. Percentiles have the resolution of a histogram bucket and never exceed Max.
+ */
+typedef struct {
+    uint32_t Frames;                            /**< Frames that reached the stage since boot. */
+    uint32_t Drops;                             /**< Frames that were skipped by the stage since boot. */
+    uint32_t Sequence;                          /**< Sequence number of the last frame, 0 if none. */
+    uint32_t Last;                              /**< Latency of the last frame in microseconds. */
+    uint32_t P50;                               /**< Median latency in microseconds. */
+    uint32_t P99;                               /**< 99th percentile in microseconds. */
+    uint32_t Max;                               /**< Maximum latency of the last one or two windows in microseconds. */
+} FrameLatency_Stats_t;
+
+/** @brief              Record that a frame reached the end of a stage. A stage that handles a frame more than once
+ *                      (several encoded variants or clients) keeps the latest time of the frame. A frame older
+ *                      than the last one of the stage is ignored. Skipped sequence numbers of the display and the
+ *                      network stages are counted as drops while the stage is busy. Can be called from any task.
+ *  @param Stage        Pipeline stage
+ *  @param Sequence     Frame pool sequence number of the frame
+ *  @param Timestamp    Capture time of the frame in microseconds since boot (esp_timer)
+ */
+void FrameLatency_Mark(FrameLatency_Stage_t Stage, uint32_t Sequence, int64_t Timestamp);
+
+/** @brief          Count a frame that was dropped by a stage, e.g. because no buffer was available.
+ *  @param Stage    Pipeline stage
+ */
+void FrameLatency_Drop(FrameLatency_Stage_t Stage);
+
+/** @brief          Get the statistics of a stage.
+ *  @param Stage    Pipeline stage
+ *  @param p_Stats  Pointer to store the statistics
+ */
+void FrameLatency_Get(FrameLatency_Stage_t Stage, FrameLatency_Stats_t *p_Stats);
+
+/** @brief Clear the histograms and counters of all stages.
+ */
+void FrameLatency_Reset(void);
+
+/** @brief          Get the name of a stage.
+ *  @param Stage    Pipeline stage
+ *  @return         Name of the stage
+ */
+const char *FrameLatency_GetStageName(FrameLatency_Stage_t Stage);
+
+#endif /* FRAME_LATENCY_H_ */
@@ -0,0 +1,271 @@
+/*
+ * framePool.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Reference counted PSRAM frame pool shared by all frame consumers.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <string.h>
+
+#include "framePool.h"
+#include "Application/Memory/memoryPlan.h"
+
+typedef struct {
+    bool isInitialized;
+    uint8_t Count;
+    uint32_t Sequence;
+    FramePool_Frame_t *Latest;                  /**< Latest published frame. The pool holds one reference on it. */
+    FramePool_Frame_t *Frames;
+} FramePool_State_t;
+
+static FramePool_State_t _FramePool_State;
+
+/* The reference counts are touched from several tasks on both cores, so a spinlock is used instead of a mutex */
+static portMUX_TYPE _FramePool_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *TAG = "frame_pool";
+
+/** @brief Free the pixel buffers of all slots. The buffers of all slots are one block, starting at the first slot.
+ */
+static void FramePool_FreeSlots(void)
+{
+    MemoryPlan_Free(_FramePool_State.Frames[0].RGB);
+    MemoryPlan_Free(_FramePool_State.Frames[0].RAW);
+
+    heap_caps_free(_FramePool_State.Frames);
+    _FramePool_State.Frames = NULL;
+    _FramePool_State.Count = 0;
+}
+
+esp_err_t FramePool_Init(uint8_t Count, uint16_t Width, uint16_t Height)
+{
+    uint16_t *RAW;
+    uint8_t *RGB;
+
+    if (_FramePool_State.isInitialized) {
+        ESP_LOGW(TAG, "Already initialized");
+        return ESP_OK;
+    }
+
+    if ((Count < 2) || (Width == 0) || (Height == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    _FramePool_State.Frames = reinterpret_cast<FramePool_Frame_t *>(heap_caps_calloc(Count, sizeof(FramePool_Frame_t),
+                                                                                    MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    if (_FramePool_State.Frames == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate slot descriptors!");
+        return ESP_ERR_NO_MEM;
+    }
+
+    _FramePool_State.Count = Count;
+
+    /* The slots live as long as the pipeline, so they are placed in the frame arena */
+    RAW = reinterpret_cast<uint16_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME, Count * Width * Height * sizeof(uint16_t),
+                                                        "frame_pool_raw"));
+    RGB = reinterpret_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME, Count * Width * Height * 3,
+                                                       "frame_pool_rgb"));
+    if ((RAW == NULL) || (RGB == NULL)) {
+        ESP_LOGE(TAG, "Failed to allocate %u frame slots!", Count);
+        MemoryPlan_Free(RGB);
+        MemoryPlan_Free(RAW);
+        heap_caps_free(_FramePool_State.Frames);
+        _FramePool_State.Frames = NULL;
+        _FramePool_State.Count = 0;
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (uint8_t i = 0; i < Count; i++) {
+        FramePool_Frame_t *Frame = &_FramePool_State.Frames[i];
+
+        Frame->Width = Width;
+        Frame->Height = Height;
+        Frame->RAW = &RAW[i * Width * Height];
+        Frame->RGB = &RGB[i * Width * Height * 3];
+    }
+
+    _FramePool_State.Sequence = 0;
+    _FramePool_State.Latest = NULL;
+    _FramePool_State.isInitialized = true;
+
+    ESP_LOGD(TAG, "Frame pool initialized: %u slots with %ux%u pixels (%u bytes per slot)", Count, Width, Height,
+             static_cast<unsigned int>(Width * Height * (sizeof(uint16_t) + 3)));
+
+    return ESP_OK;
+}
+
+void FramePool_Deinit(void)
+{
+    if (_FramePool_State.isInitialized == false) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < _FramePool_State.Count; i++) {
+        if ((_FramePool_State.Frames[i].RefCount > 0) && (&_FramePool_State.Frames[i] != _FramePool_State.Latest)) {
+            ESP_LOGW(TAG, "Slot %u still referenced (%u) during deinit!", i, _FramePool_State.Frames[i].RefCount);
+        }
+    }
+
+    _FramePool_State.Latest = NULL;
+    FramePool_FreeSlots();
+
+    _FramePool_State.isInitialized = false;
+}
+
+FramePool_Frame_t *FramePool_Acquire(void)
+{
+    FramePool_Frame_t *Frame = NULL;
+
+    if (_FramePool_State.isInitialized == false) {
+        return NULL;
+    }
+
+    portENTER_CRITICAL(&_FramePool_Lock);
+    for (uint8_t i = 0; i < _FramePool_State.Count; i++) {
+        if (_FramePool_State.Frames[i].RefCount == 0) {
+            Frame = &_FramePool_State.Frames[i];
+            Frame->RefCount = 1;
+
+            /* Invalidate the sequence, so FramePool_Find never returns a slot that is being written */
+            Frame->Sequence = 0;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&_FramePool_Lock);
+
+    if (Frame != NULL) {
+        Frame->hasRAW = false;
+        Frame->hasTelemetry = false;
+        Frame->hasStatistics = false;
+        Frame->hasROI = false;
+        Frame->hasRGB = false;
+        Frame->Repeats = 0;
+        Frame->Time = 0;
+        Frame->Min = 0;
+        Frame->Max = 0;
+    }
+
+    return Frame;
+}
+
+void FramePool_Publish(FramePool_Frame_t *p_Frame)
+{
+    FramePool_Frame_t *Previous;
+
+    if (p_Frame == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&_FramePool_Lock);
+    p_Frame->Sequence = ++_FramePool_State.Sequence;
+    Previous = _FramePool_State.Latest;
+    _FramePool_State.Latest = p_Frame;
+
+    /* Drop the reference the pool held on the previous frame */
+    if ((Previous != NULL) && (Previous->RefCount > 0)) {
+        Previous->RefCount--;
+    }
+    portEXIT_CRITICAL(&_FramePool_Lock);
+}
+
+FramePool_Frame_t *FramePool_GetLatest(void)
+{
+    FramePool_Frame_t *Frame;
+
+    portENTER_CRITICAL(&_FramePool_Lock);
+    Frame = _FramePool_State.Latest;
+    if (Frame != NULL) {
+        Frame->RefCount++;
+    }
+    portEXIT_CRITICAL(&_FramePool_Lock);
+
+    return Frame;
+}
+
+FramePool_Frame_t *FramePool_Find(uint32_t Sequence)
+{
+    FramePool_Frame_t *Frame = NULL;
+
+    if ((_FramePool_State.isInitialized == false) || (Sequence == 0)) {
+        return NULL;
+    }
+
+    portENTER_CRITICAL(&_FramePool_Lock);
+    for (uint8_t i = 0; i < _FramePool_State.Count; i++) {
+        if (_FramePool_State.Frames[i].Sequence == Sequence) {
+            Frame = &_FramePool_State.Frames[i];
+            Frame->RefCount++;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&_FramePool_Lock);
+
+    return Frame;
+}
+
+FramePool_Frame_t *FramePool_Retain(FramePool_Frame_t *p_Frame)
+{
+    if (p_Frame == NULL) {
+        return NULL;
+    }
+
+    portENTER_CRITICAL(&_FramePool_Lock);
+    p_Frame->RefCount++;
+    portEXIT_CRITICAL(&_FramePool_Lock);
+
+    return p_Frame;
+}
+
+void FramePool_Release(FramePool_Frame_t *p_Frame)
+{
+    bool Underflow = false;
+
+    if (p_Frame == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&_FramePool_Lock);
+    if (p_Frame->RefCount > 0) {
+        p_Frame->RefCount--;
+    } else {
+        Underflow = true;
+    }
+    portEXIT_CRITICAL(&_FramePool_Lock);
+
+    if (Underflow) {
+        ESP_LOGW(TAG, "Release of unreferenced frame %u!", static_cast<unsigned int>(p_Frame->Sequence));
+    }
+}
+
+uint32_t FramePool_GetSequence(void)
+{
+    uint32_t Sequence;
+
+    portENTER_CRITICAL(&_FramePool_Lock);
+    Sequence = _FramePool_State.Sequence;
+    portEXIT_CRITICAL(&_FramePool_Lock);
+
+    return Sequence;
+}
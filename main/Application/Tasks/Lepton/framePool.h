@@ -0,0 +1,125 @@
+/*
+ * framePool.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Reference counted PSRAM frame pool shared by all frame consumers.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef FRAME_POOL_H_
+#define FRAME_POOL_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lepton.h"
+#include "frameStatistics.h"
+#include "roiEngine.h"
+
+/** @brief Frame slot of the frame pool.
+ *         A slot is written by the Lepton task only while it owns the slot exclusively (after FramePool_Acquire).
+ *         After FramePool_Publish the content is read-only until the last reference is released. Products that
+ *         were not demanded at the publish (statistics, ROI, RGB) are produced on request with
+ *         FrameProducts_Require.
+ */
+typedef struct {
+    uint32_t Sequence;                          /**< Monotonic frame sequence number, assigned on publish. */
+    int64_t Timestamp;                          /**< Capture time in microseconds since boot (esp_timer). */
+    int64_t Time;                               /**< Capture time in microseconds since 1970-01-01 UTC, 0 if the
+                                                     time is not set. See TimeManager_ToUTC. */
+    uint16_t Width;                             /**< Width of the frame in pixels. */
+    uint16_t Height;                            /**< Height of the frame in pixels. */
+    bool hasRAW;                                /**< true when RAW contains valid RAW14 data for this frame. */
+    bool hasTelemetry;                          /**< true when Telemetry is valid for this frame. */
+    bool hasStatistics;                         /**< true when Statistics is valid for this frame. */
+    bool hasROI;                                /**< true when ROI contains the ROI engine results for this frame. */
+    bool hasRGB;                                /**< true when RGB contains the colorized frame. */
+    uint16_t Repeats;                           /**< Repeated camera frames that were dropped right before this
+                                                     frame, e.g. during a flat field correction. */
+    uint16_t *RAW;                              /**< RAW14 pixel data (Width * Height). */
+    uint8_t *RGB;                               /**< Colorized RGB888 pixel data (Width * Height * 3). */
+    int16_t Min;                                /**< Minimum temperature of the frame in centi-Kelvin. Only valid
+                                                     with hasStatistics or hasRGB. */
+    int16_t Max;                                /**< Maximum temperature of the frame in centi-Kelvin. Only valid
+                                                     with hasStatistics or hasRGB. */
+    Lepton_Telemetry_t Telemetry;               /**< Telemetry line of the frame. */
+    FrameStatistics_t Statistics;               /**< Statistics of the RAW14 data. Only valid with hasRAW. */
+    ROIEngine_Result_t ROI[ROI_ENGINE_MAX_ROIS];    /**< ROI engine results, indexed like the ROI engine slots. */
+    uint8_t RefCount;                           /**< Number of outstanding references. Managed by the pool only. */
+} FramePool_Frame_t;
+
+/** @brief          Initialize the frame pool and allocate all slots in PSRAM.
+ *  @param Count    Number of frame slots
+ *  @param Width    Frame width in pixels
+ *  @param Height   Frame height in pixels
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if a parameter is invalid
+ *                  ESP_ERR_NO_MEM if the slots can not be allocated
+ */
+esp_err_t FramePool_Init(uint8_t Count, uint16_t Width, uint16_t Height);
+
+/** @brief Deinitialize the frame pool and free all slots.
+ *         All references must be released before calling this function.
+ */
+void FramePool_Deinit(void);
+
+/** @brief  Get a free slot for writing a new frame. The caller owns the only reference of the slot.
+ *  @return Pointer to the frame slot or NULL if all slots are in use
+ */
+FramePool_Frame_t *FramePool_Acquire(void);
+
+/** @brief          Publish a frame obtained with FramePool_Acquire as the latest frame.
+ *                  The reference of the writer is handed over to the pool. The previous latest frame is
+ *                  released by the pool and returns to the free list once all consumers released it.
+ *  @param p_Frame  Pointer to the frame slot
+ */
+void FramePool_Publish(FramePool_Frame_t *p_Frame);
+
+/** @brief  Get a reference to the latest published frame.
+ *          The reference must be returned with FramePool_Release.
+ *  @return Pointer to the latest frame or NULL if no frame is available
+ */
+FramePool_Frame_t *FramePool_GetLatest(void);
+
+/** @brief          Get a reference to a recent frame by its sequence number. A frame stays available until its slot
+ *                  is written again, so the last few frames can be found.
+ *                  The reference must be returned with FramePool_Release.
+ *  @param Sequence Sequence number of the frame
+ *  @return         Pointer to the frame or NULL if the frame is not available (anymore)
+ */
+FramePool_Frame_t *FramePool_Find(uint32_t Sequence);
+
+/** @brief          Take an additional reference on a frame the caller already holds a reference for.
+ *  @param p_Frame  Pointer to the frame slot
+ *  @return         p_Frame
+ */
+FramePool_Frame_t *FramePool_Retain(FramePool_Frame_t *p_Frame);
+
+/** @brief          Release a reference on a frame.
+ *  @param p_Frame  Pointer to the frame slot. NULL is ignored.
+ */
+void FramePool_Release(FramePool_Frame_t *p_Frame);
+
+/** @brief  Get the sequence number of the latest published frame.
+ *  @return Sequence number or 0 if no frame was published yet
+ */
+uint32_t FramePool_GetSequence(void);
+
+#endif /* FRAME_POOL_H_ */
@@ -0,0 +1,228 @@
+/*
+ * frameProducts.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Demand driven products of the frame pool slots.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "frameProducts.h"
+#include "frameLatency.h"
+
+typedef struct {
+    SemaphoreHandle_t Lock;                     /**< Serializes the production on published frames. */
+    FrameProducts_Colorizer_t Colorizer;
+    uint32_t Subscriptions[FRAME_CONSUMER_COUNT];   /**< Products per consumer. */
+} FrameProducts_State_t;
+
+static FrameProducts_State_t _FrameProducts_State;
+
+/* The subscriptions are changed from several tasks and read by the Lepton task with every frame */
+static portMUX_TYPE _FrameProducts_Spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *TAG = "frame_products";
+
+/** @brief          Get the products of a frame that are not available yet.
+ *  @param p_Frame  Frame
+ *  @param Products Mask of the needed products
+ *  @return         Mask of the missing products
+ */
+static uint32_t FrameProducts_Missing(const FramePool_Frame_t *p_Frame, uint32_t Products)
+{
+    uint32_t Missing = 0;
+
+    if ((Products & FRAME_PRODUCT_RAW) && (p_Frame->hasRAW == false)) {
+        Missing |= FRAME_PRODUCT_RAW;
+    }
+
+    if ((Products & FRAME_PRODUCT_STATISTICS) && (p_Frame->hasStatistics == false)) {
+        Missing |= FRAME_PRODUCT_STATISTICS;
+    }
+
+    if ((Products & FRAME_PRODUCT_ROI) && (p_Frame->hasROI == false)) {
+        Missing |= FRAME_PRODUCT_ROI;
+    }
+
+    if ((Products & FRAME_PRODUCT_RGB) && (p_Frame->hasRGB == false)) {
+        Missing |= FRAME_PRODUCT_RGB;
+    }
+
+    return Missing;
+}
+
+/** @brief          Compute products from the RAW14 data. Min and Max are written once, by the first product that
+ *                  gives them. A flag is only set after its product is written.
+ *  @param p_Frame  Frame with RAW14 data
+ *  @param Products Mask of the products to compute
+ */
+static void FrameProducts_Produce(FramePool_Frame_t *p_Frame, uint32_t Products)
+{
+    if ((Products & FRAME_PRODUCT_STATISTICS) && (p_Frame->hasStatistics == false)) {
+        if (FrameStatistics_Compute(p_Frame->RAW, p_Frame->Width, p_Frame->Height, &p_Frame->Statistics) == ESP_OK) {
+            if (p_Frame->hasRGB == false) {
+                p_Frame->Min = static_cast<int16_t>(p_Frame->Statistics.Min);
+                p_Frame->Max = static_cast<int16_t>(p_Frame->Statistics.Max);
+            }
+
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            p_Frame->hasStatistics = true;
+        }
+    }
+
+    if ((Products & FRAME_PRODUCT_ROI) && (p_Frame->hasROI == false)) {
+        if (ROIEngine_Process(p_Frame->RAW, p_Frame->ROI) == ESP_OK) {
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            p_Frame->hasROI = true;
+        }
+    }
+
+    if ((Products & FRAME_PRODUCT_RGB) && (p_Frame->hasRGB == false) && (_FrameProducts_State.Colorizer != NULL)) {
+        int16_t Min;
+        int16_t Max;
+
+        _FrameProducts_State.Colorizer(p_Frame, p_Frame->RGB, &Min, &Max);
+
+        if (p_Frame->hasStatistics == false) {
+            p_Frame->Min = Min;
+            p_Frame->Max = Max;
+        }
+
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        p_Frame->hasRGB = true;
+    }
+}
+
+esp_err_t FrameProducts_Init(FrameProducts_Colorizer_t Colorizer)
+{
+    if (Colorizer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (_FrameProducts_State.Lock == NULL) {
+        _FrameProducts_State.Lock = xSemaphoreCreateMutex();
+        if (_FrameProducts_State.Lock == NULL) {
+            ESP_LOGE(TAG, "Failed to create lock!");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    _FrameProducts_State.Colorizer = Colorizer;
+
+    return ESP_OK;
+}
+
+void FrameProducts_Deinit(void)
+{
+    if (_FrameProducts_State.Lock != NULL) {
+        vSemaphoreDelete(_FrameProducts_State.Lock);
+        _FrameProducts_State.Lock = NULL;
+    }
+
+    _FrameProducts_State.Colorizer = NULL;
+}
+
+void FrameProducts_Subscribe(FrameProducts_Consumer_t Consumer, uint32_t Products)
+{
+    if (Consumer >= FRAME_CONSUMER_COUNT) {
+        return;
+    }
+
+    portENTER_CRITICAL(&_FrameProducts_Spinlock);
+    _FrameProducts_State.Subscriptions[Consumer] = Products;
+    portEXIT_CRITICAL(&_FrameProducts_Spinlock);
+
+    ESP_LOGD(TAG, "Consumer %d needs 0x%02lx", Consumer, static_cast<unsigned long>(Products));
+}
+
+bool FrameProducts_isSubscribed(FrameProducts_Consumer_t Consumer)
+{
+    bool isSubscribed;
+
+    if (Consumer >= FRAME_CONSUMER_COUNT) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&_FrameProducts_Spinlock);
+    isSubscribed = (_FrameProducts_State.Subscriptions[Consumer] != 0);
+    portEXIT_CRITICAL(&_FrameProducts_Spinlock);
+
+    return isSubscribed;
+}
+
+uint32_t FrameProducts_GetDemand(void)
+{
+    uint32_t Demand = 0;
+
+    portENTER_CRITICAL(&_FrameProducts_Spinlock);
+    for (uint8_t i = 0; i < FRAME_CONSUMER_COUNT; i++) {
+        Demand |= _FrameProducts_State.Subscriptions[i];
+    }
+    portEXIT_CRITICAL(&_FrameProducts_Spinlock);
+
+    return Demand;
+}
+
+void FrameProducts_Prepare(FramePool_Frame_t *p_Frame, uint32_t Demand)
+{
+    if ((p_Frame == NULL) || (p_Frame->hasRAW == false)) {
+        return;
+    }
+
+    /* The slot is not published yet, so nobody else can produce on it */
+    FrameProducts_Produce(p_Frame, Demand);
+}
+
+esp_err_t FrameProducts_Require(const FramePool_Frame_t *p_Frame, uint32_t Products)
+{
+    uint32_t Missing;
+    bool isColorized;
+
+    if (p_Frame == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    Missing = FrameProducts_Missing(p_Frame, Products);
+    if (Missing == 0) {
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        return ESP_OK;
+    } else if (p_Frame->hasRAW == false) {
+        return ESP_ERR_NOT_SUPPORTED;
+    } else if (_FrameProducts_State.Lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(_FrameProducts_State.Lock, portMAX_DELAY);
+
+    /* Only the cached products are written, the RAW14 data and the metadata of the frame stay untouched */
+    isColorized = p_Frame->hasRGB;
+    FrameProducts_Produce(const_cast<FramePool_Frame_t *>(p_Frame), Missing);
+    Missing = FrameProducts_Missing(p_Frame, Products);
+
+    xSemaphoreGive(_FrameProducts_State.Lock);
+
+    if ((isColorized == false) && p_Frame->hasRGB) {
+        FrameLatency_Mark(FRAME_LATENCY_COLORIZE, p_Frame->Sequence, p_Frame->Timestamp);
+    }
+
+    return (Missing == 0) ? ESP_OK : ESP_FAIL;
+}
@@ -0,0 +1,114 @@
+/*
+ * frameProducts.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Demand driven products of the frame pool slots.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef FRAME_PRODUCTS_H_
+#define FRAME_PRODUCTS_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "framePool.h"
+
+/** @brief Products of a frame. The RAW14 data is the source of all other products and always kept.
+ */
+typedef enum {
+    FRAME_PRODUCT_RAW = (1 << 0),               /**< RAW14 data. */
+    FRAME_PRODUCT_STATISTICS = (1 << 1),        /**< Scene statistics and histogram, also gives Min and Max. */
+    FRAME_PRODUCT_ROI = (1 << 2),               /**< Results of the ROI engine. */
+    FRAME_PRODUCT_RGB = (1 << 3),               /**< Colorized RGB888 image, also gives Min and Max. */
+} FrameProducts_Product_t;
+
+/** @brief Consumers that need products of every frame. Consumers that only read a frame on request (VISA
+ *         queries, snapshots) do not subscribe and call FrameProducts_Require instead.
+ */
+typedef enum {
+    FRAME_CONSUMER_DISPLAY = 0,                 /**< Reader of App_Context_t.Lepton_FrameEventQueue. Frame events
+                                                     are only sent while it is subscribed. */
+    FRAME_CONSUMER_NETWORK,                     /**< HTTP, WebSocket and MJPEG streams. */
+    FRAME_CONSUMER_RECORDER,                    /**< SD card recorder. */
+    FRAME_CONSUMER_SPOTS,                       /**< Hot and cold spot alarms of the Lepton task. */
+    FRAME_CONSUMER_COUNT,
+} FrameProducts_Consumer_t;
+
+/** @brief          Colorize the RAW14 data of a frame.
+ *  @param p_Frame  Frame with RAW14 data
+ *  @param p_RGB    RGB888 output with Width * Height * 3 bytes
+ *  @param p_Min    Minimum temperature of the frame in centi-Kelvin
+ *  @param p_Max    Maximum temperature of the frame in centi-Kelvin
+ */
+typedef void (*FrameProducts_Colorizer_t)(const FramePool_Frame_t *p_Frame, uint8_t *p_RGB, int16_t *p_Min,
+                                          int16_t *p_Max);
+
+/** @brief              Initialize the lazy production.
+ *  @param Colorizer    Function that produces FRAME_PRODUCT_RGB
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if Colorizer is NULL
+ *                      ESP_ERR_NO_MEM if the lock can not be created
+ */
+esp_err_t FrameProducts_Init(FrameProducts_Colorizer_t Colorizer);
+
+/** @brief Deinitialize the lazy production. The subscriptions are kept.
+ */
+void FrameProducts_Deinit(void);
+
+/** @brief              Set the products a consumer needs from every frame. Can be called before the
+ *                      initialization.
+ *  @param Consumer     Consumer
+ *  @param Products     Mask of FrameProducts_Product_t, 0 to unsubscribe
+ */
+void FrameProducts_Subscribe(FrameProducts_Consumer_t Consumer, uint32_t Products);
+
+/** @brief              Check if a consumer is subscribed.
+ *  @param Consumer     Consumer
+ *  @return             true if the consumer needs at least one product
+ */
+bool FrameProducts_isSubscribed(FrameProducts_Consumer_t Consumer);
+
+/** @brief  Get the products that are needed by at least one consumer.
+ *  @return Mask of FrameProducts_Product_t
+ */
+uint32_t FrameProducts_GetDemand(void);
+
+/** @brief          Produce the demanded products of a new frame. Called by the writer of the slot before
+ *                  FramePool_Publish, the other products are produced on request.
+ *  @param p_Frame  Frame slot owned by the caller, with RAW14 data
+ *  @param Demand   Products to produce, usually FrameProducts_GetDemand()
+ */
+void FrameProducts_Prepare(FramePool_Frame_t *p_Frame, uint32_t Demand);
+
+/** @brief          Make products of a published frame available. Every product is produced at most once per
+ *                  frame, the first consumer that needs it pays for it. The products are a cache of the
+ *                  RAW14 data, so a frame is still read-only for its consumers.
+ *  @param p_Frame  Frame the caller holds a reference for
+ *  @param Products Mask of FrameProducts_Product_t
+ *  @return         ESP_OK when all products are available
+ *                  ESP_ERR_INVALID_ARG if p_Frame is NULL
+ *                  ESP_ERR_NOT_SUPPORTED if the frame has no RAW14 data to produce them from
+ *                  ESP_ERR_INVALID_STATE if the production is not initialized
+ *                  ESP_FAIL if a product can not be computed
+ */
+esp_err_t FrameProducts_Require(const FramePool_Frame_t *p_Frame, uint32_t Products);
+
+#endif /* FRAME_PRODUCTS_H_ */
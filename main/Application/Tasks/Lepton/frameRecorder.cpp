@@ -0,0 +1,247 @@
+/*
+ * frameRecorder.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Gapless burst recorder for consecutive RAW14 frames in PSRAM.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <string.h>
+
+#include "frameRecorder.h"
+#include "Application/Memory/memoryPlan.h"
+
+typedef struct {
+    bool isInitialized;
+    volatile bool isRecording;                  /**< Burst is running. Read without the lock by the Lepton task. */
+    uint16_t Capacity;                          /**< Maximum number of frames of a burst. */
+    uint16_t Width;
+    uint16_t Height;
+    size_t RecordSize;                          /**< Size of one frame with header in bytes. */
+    uint16_t Requested;                         /**< Number of frames of the current burst. */
+    uint16_t Recorded;                          /**< Number of recorded frames of the current burst. */
+    uint8_t Readers;                            /**< Number of outstanding locks of the recorded frames. */
+    uint8_t *Buffer;                            /**< Capacity records in PSRAM. */
+} FrameRecorder_State_t;
+
+static FrameRecorder_State_t _FrameRecorder_State;
+
+/* The state is shared between the Lepton task and the network tasks on both cores */
+static portMUX_TYPE _FrameRecorder_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *TAG = "frame_recorder";
+
+esp_err_t FrameRecorder_Init(uint16_t Capacity, uint16_t Width, uint16_t Height)
+{
+    if (_FrameRecorder_State.isInitialized) {
+        ESP_LOGW(TAG, "Already initialized");
+        return ESP_OK;
+    }
+
+    if ((Width == 0) || (Height == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(&_FrameRecorder_State, 0, sizeof(_FrameRecorder_State));
+
+    _FrameRecorder_State.Capacity = Capacity;
+    _FrameRecorder_State.Width = Width;
+    _FrameRecorder_State.Height = Height;
+    _FrameRecorder_State.RecordSize = sizeof(FrameRecorder_Header_t) + (Width * Height * sizeof(uint16_t));
+
+    if (Capacity > 0) {
+        /* Allocated once, so a burst never fails on a fragmented heap */
+        _FrameRecorder_State.Buffer = reinterpret_cast<uint8_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME, Capacity *
+                                                                                   _FrameRecorder_State.RecordSize,
+                                                                                   "burst_recorder"));
+        if (_FrameRecorder_State.Buffer == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate %u frames!", Capacity);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    _FrameRecorder_State.isInitialized = true;
+
+    ESP_LOGD(TAG, "Frame recorder initialized: %u frames with %u bytes", Capacity,
+             static_cast<unsigned int>(_FrameRecorder_State.RecordSize));
+
+    return ESP_OK;
+}
+
+void FrameRecorder_Deinit(void)
+{
+    if (_FrameRecorder_State.isInitialized == false) {
+        return;
+    }
+
+    if (_FrameRecorder_State.Readers > 0) {
+        ESP_LOGW(TAG, "Recorded frames still locked (%u) during deinit!", _FrameRecorder_State.Readers);
+    }
+
+    _FrameRecorder_State.isRecording = false;
+
+    if (_FrameRecorder_State.Buffer != NULL) {
+        MemoryPlan_Free(_FrameRecorder_State.Buffer);
+        _FrameRecorder_State.Buffer = NULL;
+    }
+
+    _FrameRecorder_State.isInitialized = false;
+}
+
+esp_err_t FrameRecorder_Start(uint16_t Count)
+{
+    esp_err_t Error = ESP_OK;
+
+    if ((_FrameRecorder_State.isInitialized == false) || (_FrameRecorder_State.Buffer == NULL)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if ((Count == 0) || (Count > _FrameRecorder_State.Capacity)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    portENTER_CRITICAL(&_FrameRecorder_Lock);
+    if (_FrameRecorder_State.isRecording || (_FrameRecorder_State.Readers > 0)) {
+        Error = ESP_ERR_INVALID_STATE;
+    } else {
+        _FrameRecorder_State.Requested = Count;
+        _FrameRecorder_State.Recorded = 0;
+        _FrameRecorder_State.isRecording = true;
+    }
+    portEXIT_CRITICAL(&_FrameRecorder_Lock);
+
+    if (Error == ESP_OK) {
+        ESP_LOGI(TAG, "Burst of %u frames started", Count);
+    }
+
+    return Error;
+}
+
+void FrameRecorder_Push(const FramePool_Frame_t *p_Frame)
+{
+    FrameRecorder_Header_t *p_Header;
+    uint16_t Index;
+
+    /* Fast path for the common case without a burst */
+    if ((_FrameRecorder_State.isRecording == false) || (p_Frame == NULL)) {
+        return;
+    }
+
+    if ((p_Frame->hasRAW == false) || (p_Frame->Width != _FrameRecorder_State.Width) ||
+        (p_Frame->Height != _FrameRecorder_State.Height)) {
+        ESP_LOGW(TAG, "Frame %u without RAW14 data, burst stopped after %u frames!",
+                 static_cast<unsigned int>(p_Frame->Sequence), _FrameRecorder_State.Recorded);
+
+        _FrameRecorder_State.isRecording = false;
+
+        return;
+    }
+
+    /* Only the Lepton task writes records and Start is rejected while recording, so no lock is needed for the copy */
+    Index = _FrameRecorder_State.Recorded;
+    p_Header = reinterpret_cast<FrameRecorder_Header_t *>(_FrameRecorder_State.Buffer +
+                                                          (Index * _FrameRecorder_State.RecordSize));
+
+    p_Header->Sequence = p_Frame->Sequence;
+    p_Header->Timestamp = static_cast<uint64_t>(p_Frame->Timestamp);
+    p_Header->Width = p_Frame->Width;
+    p_Header->Height = p_Frame->Height;
+
+    if (p_Frame->hasTelemetry) {
+        p_Header->FrameCounter = p_Frame->Telemetry.FrameCounter;
+        p_Header->FPA = p_Frame->Telemetry.FPA_Temp;
+        p_Header->Housing = p_Frame->Telemetry.Housing_Temp;
+    } else {
+        p_Header->FrameCounter = 0;
+        p_Header->FPA = 0;
+        p_Header->Housing = 0;
+    }
+
+    memcpy(p_Header + 1, p_Frame->RAW, p_Frame->Width * p_Frame->Height * sizeof(uint16_t));
+
+    portENTER_CRITICAL(&_FrameRecorder_Lock);
+    _FrameRecorder_State.Recorded++;
+    if (_FrameRecorder_State.Recorded >= _FrameRecorder_State.Requested) {
+        _FrameRecorder_State.isRecording = false;
+    }
+    portEXIT_CRITICAL(&_FrameRecorder_Lock);
+
+    if (_FrameRecorder_State.isRecording == false) {
+        ESP_LOGI(TAG, "Burst of %u frames complete", _FrameRecorder_State.Recorded);
+    }
+}
+
+bool FrameRecorder_GetStatus(uint16_t *p_Recorded, uint16_t *p_Requested)
+{
+    bool isRecording;
+
+    portENTER_CRITICAL(&_FrameRecorder_Lock);
+    isRecording = _FrameRecorder_State.isRecording;
+
+    if (p_Recorded != NULL) {
+        *p_Recorded = _FrameRecorder_State.Recorded;
+    }
+
+    if (p_Requested != NULL) {
+        *p_Requested = _FrameRecorder_State.Requested;
+    }
+    portEXIT_CRITICAL(&_FrameRecorder_Lock);
+
+    return isRecording;
+}
+
+size_t FrameRecorder_GetRecordSize(void)
+{
+    return _FrameRecorder_State.RecordSize;
+}
+
+esp_err_t FrameRecorder_Lock(const uint8_t **pp_Data, size_t *p_Length)
+{
+    esp_err_t Error = ESP_OK;
+
+    if ((pp_Data == NULL) || (p_Length == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&_FrameRecorder_Lock);
+    if (_FrameRecorder_State.isRecording) {
+        Error = ESP_ERR_INVALID_STATE;
+    } else if ((_FrameRecorder_State.Buffer == NULL) || (_FrameRecorder_State.Recorded == 0)) {
+        Error = ESP_ERR_NOT_FOUND;
+    } else {
+        _FrameRecorder_State.Readers++;
+        *pp_Data = _FrameRecorder_State.Buffer;
+        *p_Length = _FrameRecorder_State.Recorded * _FrameRecorder_State.RecordSize;
+    }
+    portEXIT_CRITICAL(&_FrameRecorder_Lock);
+
+    return Error;
+}
+
+void FrameRecorder_Unlock(void)
+{
+    portENTER_CRITICAL(&_FrameRecorder_Lock);
+    if (_FrameRecorder_State.Readers > 0) {
+        _FrameRecorder_State.Readers--;
+    }
+    portEXIT_CRITICAL(&_FrameRecorder_Lock);
+}
@@ -0,0 +1,102 @@
+/*
+ * frameRecorder.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Gapless burst recorder for consecutive RAW14 frames in PSRAM.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef FRAME_RECORDER_H_
+#define FRAME_RECORDER_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "framePool.h"
+
+/** @brief Header of a recorded frame (little endian). The RAW14 pixels (Width * Height * 2 bytes) follow directly.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t Sequence;                          /**< Frame pool sequence number. */
+    uint32_t FrameCounter;                      /**< Frame counter of the telemetry line, 0 without telemetry. */
+    uint64_t Timestamp;                         /**< Capture time in microseconds since boot. */
+    uint16_t FPA;                               /**< FPA temperature of the telemetry line, 0 without telemetry. */
+    uint16_t Housing;                           /**< Housing temperature of the telemetry line, 0 without telemetry. */
+    uint16_t Width;                             /**< Width of the frame in pixels. */
+    uint16_t Height;                            /**< Height of the frame in pixels. */
+} FrameRecorder_Header_t;
+
+/** @brief          Initialize the recorder and preallocate the buffer for all frames of a burst in PSRAM.
+ *  @param Capacity Maximum number of frames of a burst. 0 disables the recorder.
+ *  @param Width    Frame width in pixels
+ *  @param Height   Frame height in pixels
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if a parameter is invalid
+ *                  ESP_ERR_NO_MEM if the buffer can not be allocated
+ */
+esp_err_t FrameRecorder_Init(uint16_t Capacity, uint16_t Width, uint16_t Height);
+
+/** @brief Deinitialize the recorder and free the buffer.
+ */
+void FrameRecorder_Deinit(void);
+
+/** @brief          Start a burst. The previous burst is discarded.
+ *  @param Count    Number of consecutive frames to record
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_NOT_SUPPORTED if the recorder is disabled
+ *                  ESP_ERR_INVALID_SIZE if Count is 0 or larger than the capacity
+ *                  ESP_ERR_INVALID_STATE if a burst is running or the previous burst is still being read
+ */
+esp_err_t FrameRecorder_Start(uint16_t Count);
+
+/** @brief          Record a published frame while a burst is running. Called by the Lepton task for every frame,
+ *                  so a burst has no gaps. A frame without RAW14 data ends the burst early.
+ *  @param p_Frame  Pointer to the published frame
+ */
+void FrameRecorder_Push(const FramePool_Frame_t *p_Frame);
+
+/** @brief              Get the state of the current burst.
+ *  @param p_Recorded   Pointer to store the number of recorded frames. Can be NULL.
+ *  @param p_Requested  Pointer to store the number of requested frames. Can be NULL.
+ *  @return             true while the burst is running
+ */
+bool FrameRecorder_GetStatus(uint16_t *p_Recorded, uint16_t *p_Requested);
+
+/** @brief          Get the size of one recorded frame (header and pixels).
+ *  @return         Size in bytes
+ */
+size_t FrameRecorder_GetRecordSize(void);
+
+/** @brief          Lock the recorded frames for reading. The frames are stored back to back, so the whole burst can
+ *                  be sent as one block. A new burst can not be started until FrameRecorder_Unlock is called.
+ *  @param pp_Data  Pointer to store the start of the first frame
+ *  @param p_Length Pointer to store the length of all recorded frames in bytes
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_STATE if a burst is running
+ *                  ESP_ERR_NOT_FOUND if no frame was recorded
+ */
+esp_err_t FrameRecorder_Lock(const uint8_t **pp_Data, size_t *p_Length);
+
+/** @brief Release a lock taken with FrameRecorder_Lock.
+ */
+void FrameRecorder_Unlock(void);
+
+#endif /* FRAME_RECORDER_H_ */
@@ -0,0 +1,488 @@
+/*
+ * frameReplay.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Replay of recorded RAW14 frames as source of the capture pipeline.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+
+#include <sys/stat.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <sdkconfig.h>
+
+#include "frameReplay.h"
+#include "Application/Memory/memoryPlan.h"
+
+#ifdef CONFIG_LEPTON_REPLAY
+
+/** @brief Number of frame buffers. The Lepton task copies a frame right after it is received, so a buffer is only
+ *         written again two frames later.
+ */
+#define FRAME_REPLAY_BUFFERS                3
+
+/** @brief Frame buffer of the replay.
+ */
+typedef struct {
+    uint16_t *RAW;
+    Lepton_Telemetry_t Telemetry;
+} FrameReplay_Buffer_t;
+
+typedef struct {
+    bool isInitialized;
+    volatile FrameReplay_Source_t Source;       /**< Read without the lock by the Lepton task. */
+    volatile bool isStopping;                   /**< Stop request for the reader task. */
+    uint16_t Width;
+    uint16_t Height;
+    uint16_t Rate;
+    bool isLoop;
+    bool isDirectory;                           /**< Path is a recording directory with several segments. */
+    char Path[64];
+    TaskHandle_t Task;
+    QueueHandle_t Queue;                        /**< Latest frame for the Lepton task. */
+    uint8_t Next;                               /**< Buffer of the next frame. */
+    FrameReplay_Buffer_t Buffers[FRAME_REPLAY_BUFFERS];
+    uint32_t Frames;
+    uint32_t Dropped;
+    uint32_t Errors;
+} FrameReplay_State_t;
+
+static FrameReplay_State_t _FrameReplay_State;
+
+/* The frames are pushed by the reader task or the HTTP server task and taken by the Lepton task */
+static portMUX_TYPE _FrameReplay_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *TAG = "frame_replay";
+
+/** @brief          Hand the frame in the next buffer to the Lepton task. A frame the task has not taken yet is
+ *                  replaced, like the VoSPI capture does.
+ *  @param p_Header Header of the record
+ */
+static void FrameReplay_Publish(const SDRecorder_Frame_Header_t *p_Header)
+{
+    FrameReplay_Buffer_t *Buffer;
+    Lepton_FrameBuffer_t Frame;
+    bool isDropped;
+
+    Buffer = &_FrameReplay_State.Buffers[_FrameReplay_State.Next];
+
+    memset(&Frame, 0, sizeof(Frame));
+    Frame.Image_Buffer = reinterpret_cast<decltype(Frame.Image_Buffer)>(Buffer->RAW);
+    Frame.Width = _FrameReplay_State.Width;
+    Frame.Height = _FrameReplay_State.Height;
+    Frame.BytesPerPixel = sizeof(uint16_t);
+
+    if (p_Header->Flags & SD_RECORDER_FLAG_TELEMETRY) {
+        memset(&Buffer->Telemetry, 0, sizeof(Buffer->Telemetry));
+        Buffer->Telemetry.FrameCounter = p_Header->FrameCounter;
+        Buffer->Telemetry.FPA_Temp = p_Header->FPA;
+        Buffer->Telemetry.Housing_Temp = p_Header->Housing;
+
+        Frame.Telemetry_Buffer = reinterpret_cast<decltype(Frame.Telemetry_Buffer)>(&Buffer->Telemetry);
+    }
+
+    isDropped = (uxQueueMessagesWaiting(_FrameReplay_State.Queue) > 0);
+    xQueueOverwrite(_FrameReplay_State.Queue, &Frame);
+
+    _FrameReplay_State.Next = (_FrameReplay_State.Next + 1) % FRAME_REPLAY_BUFFERS;
+
+    portENTER_CRITICAL(&_FrameReplay_Lock);
+    _FrameReplay_State.Frames++;
+    if (isDropped) {
+        _FrameReplay_State.Dropped++;
+    }
+    portEXIT_CRITICAL(&_FrameReplay_Lock);
+}
+
+/** @brief          Count an invalid record.
+ */
+static void FrameReplay_CountError(void)
+{
+    portENTER_CRITICAL(&_FrameReplay_Lock);
+    _FrameReplay_State.Errors++;
+    portEXIT_CRITICAL(&_FrameReplay_Lock);
+}
+
+/** @brief          Check the header of a record.
+ *  @param p_Header Header of the record
+ *  @return         true if the record is a frame of the size of the replay
+ */
+static bool FrameReplay_isValid(const SDRecorder_Frame_Header_t *p_Header)
+{
+    return (p_Header->Magic == SD_RECORDER_FRAME_MAGIC) && (p_Header->Width == _FrameReplay_State.Width) &&
+           (p_Header->Height == _FrameReplay_State.Height);
+}
+
+/** @brief          Open a segment file and check its header.
+ *  @param p_Path   Path of the segment file
+ *  @param p_Header Pointer to store the file header
+ *  @return         File or NULL if it is not a recording of the frame size of the replay
+ */
+static FILE *FrameReplay_OpenSegment(const char *p_Path, SDRecorder_File_Header_t *p_Header)
+{
+    FILE *File;
+
+    File = fopen(p_Path, "rb");
+    if (File == NULL) {
+        return NULL;
+    }
+
+    if ((fread(p_Header, sizeof(SDRecorder_File_Header_t), 1, File) != 1) ||
+        (p_Header->Magic != SD_RECORDER_FILE_MAGIC) || (p_Header->Version != SD_RECORDER_FILE_VERSION) ||
+        (p_Header->Width != _FrameReplay_State.Width) || (p_Header->Height != _FrameReplay_State.Height) ||
+        (p_Header->RecordSize < (sizeof(SDRecorder_Frame_Header_t) + (p_Header->Width * p_Header->Height *
+                                                                       sizeof(uint16_t))))) {
+        fclose(File);
+
+        return NULL;
+    }
+
+    return File;
+}
+
+/** @brief          Get the path of a segment of the replay.
+ *  @param Segment  Number of the segment, starting at 1
+ *  @param p_Path   Output buffer
+ *  @param Size     Size of the output buffer
+ *  @return         false if the replay is a single file and Segment is not the first one
+ */
+static bool FrameReplay_GetSegmentPath(uint16_t Segment, char *p_Path, size_t Size)
+{
+    if (_FrameReplay_State.isDirectory) {
+        snprintf(p_Path, Size, "%s/SEG%03u.PRV", _FrameReplay_State.Path, Segment);
+    } else if (Segment == 1) {
+        snprintf(p_Path, Size, "%s", _FrameReplay_State.Path);
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+/** @brief          Wait until a frame is due or the replay is stopped.
+ *  @param Deadline Time the frame is due in microseconds since boot
+ */
+static void FrameReplay_WaitUntil(int64_t Deadline)
+{
+    int64_t Wait = Deadline - esp_timer_get_time();
+
+    /* A frame is at most one tick early, the following deadlines keep the mean rate exact */
+    if (Wait >= (1000000 / configTICK_RATE_HZ)) {
+        ulTaskNotifyTake(pdTRUE, static_cast<TickType_t>(Wait / (1000000 / configTICK_RATE_HZ)));
+    }
+}
+
+/** @brief              Reader task of a SD card replay.
+ *  @param p_Parameters Unused
+ */
+static void Task_FrameReplay(void *p_Parameters)
+{
+    char Path[sizeof(_FrameReplay_State.Path) + 16];
+    SDRecorder_File_Header_t FileHeader;
+    SDRecorder_Frame_Header_t Header;
+    size_t Pixels;
+    uint32_t Count;
+    int64_t Start;
+    int64_t First;
+    int64_t Deadline;
+
+    Pixels = _FrameReplay_State.Width * _FrameReplay_State.Height;
+
+    ESP_LOGI(TAG, "Replaying %s at %u Hz", _FrameReplay_State.Path, _FrameReplay_State.Rate);
+
+    do {
+        Count = 0;
+        Start = esp_timer_get_time();
+        First = 0;
+        Deadline = Start;
+
+        for (uint16_t Segment = 1; _FrameReplay_State.isStopping == false; Segment++) {
+            FILE *File;
+
+            if ((FrameReplay_GetSegmentPath(Segment, Path, sizeof(Path)) == false) ||
+                ((File = FrameReplay_OpenSegment(Path, &FileHeader)) == NULL)) {
+                break;
+            }
+
+            ESP_LOGD(TAG, "Segment %s with %lu frames", Path, FileHeader.Frames);
+
+            for (uint32_t i = 0; (i < FileHeader.Frames) && (_FrameReplay_State.isStopping == false); i++) {
+                uint16_t *RAW = _FrameReplay_State.Buffers[_FrameReplay_State.Next].RAW;
+
+                if ((fseek(File, FileHeader.HeaderSize + (i * FileHeader.RecordSize), SEEK_SET) != 0) ||
+                    (fread(&Header, sizeof(Header), 1, File) != 1) || (FrameReplay_isValid(&Header) == false) ||
+                    (fread(RAW, sizeof(uint16_t), Pixels, File) != Pixels)) {
+                    FrameReplay_CountError();
+                    continue;
+                }
+
+                /* Without a rate the frames keep the distances of the recording */
+                if (_FrameReplay_State.Rate > 0) {
+                    Deadline += 1000000 / _FrameReplay_State.Rate;
+                } else {
+                    if (Count == 0) {
+                        First = Header.Timestamp;
+                    }
+
+                    Deadline = Start + (Header.Timestamp - First);
+                }
+
+                FrameReplay_WaitUntil(Deadline);
+                FrameReplay_Publish(&Header);
+                Count++;
+            }
+
+            fclose(File);
+        }
+    } while (_FrameReplay_State.isLoop && (Count > 0) && (_FrameReplay_State.isStopping == false));
+
+    ESP_LOGI(TAG, "Replay of %s done", _FrameReplay_State.Path);
+
+    portENTER_CRITICAL(&_FrameReplay_Lock);
+    _FrameReplay_State.Source = FRAME_REPLAY_SOURCE_NONE;
+    _FrameReplay_State.Task = NULL;
+    portEXIT_CRITICAL(&_FrameReplay_Lock);
+
+    vTaskDelete(NULL);
+}
+
+esp_err_t FrameReplay_Init(uint16_t Width, uint16_t Height)
+{
+    if (_FrameReplay_State.isInitialized) {
+        ESP_LOGW(TAG, "Already initialized");
+        return ESP_OK;
+    }
+
+    if ((Width == 0) || (Height == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(&_FrameReplay_State, 0, sizeof(_FrameReplay_State));
+
+    _FrameReplay_State.Width = Width;
+    _FrameReplay_State.Height = Height;
+
+    _FrameReplay_State.Queue = xQueueCreate(1, sizeof(Lepton_FrameBuffer_t));
+    if (_FrameReplay_State.Queue == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (uint8_t i = 0; i < FRAME_REPLAY_BUFFERS; i++) {
+        _FrameReplay_State.Buffers[i].RAW = reinterpret_cast<uint16_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME,
+                                                                                          Width * Height *
+                                                                                          sizeof(uint16_t),
+                                                                                          "replay_frame"));
+        if (_FrameReplay_State.Buffers[i].RAW == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate frame buffers!");
+
+            for (uint8_t j = 0; j < i; j++) {
+                MemoryPlan_Free(_FrameReplay_State.Buffers[j].RAW);
+            }
+            vQueueDelete(_FrameReplay_State.Queue);
+
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    _FrameReplay_State.isInitialized = true;
+
+    return ESP_OK;
+}
+
+void FrameReplay_Deinit(void)
+{
+    if (_FrameReplay_State.isInitialized == false) {
+        return;
+    }
+
+    FrameReplay_Stop();
+
+    for (uint8_t i = 0; i < FRAME_REPLAY_BUFFERS; i++) {
+        MemoryPlan_Free(_FrameReplay_State.Buffers[i].RAW);
+        _FrameReplay_State.Buffers[i].RAW = NULL;
+    }
+
+    vQueueDelete(_FrameReplay_State.Queue);
+    _FrameReplay_State.Queue = NULL;
+
+    _FrameReplay_State.isInitialized = false;
+}
+
+esp_err_t FrameReplay_StartFile(const char *p_Path, uint16_t Rate, bool isLoop)
+{
+    SDRecorder_File_Header_t Header;
+    char Path[sizeof(_FrameReplay_State.Path) + 16];
+    struct stat Info;
+    FILE *File;
+
+    if (p_Path == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    } else if ((_FrameReplay_State.isInitialized == false) ||
+               (_FrameReplay_State.Source != FRAME_REPLAY_SOURCE_NONE)) {
+        return ESP_ERR_INVALID_STATE;
+    } else if ((strlen(p_Path) >= sizeof(_FrameReplay_State.Path)) || (stat(p_Path, &Info) != 0)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    strcpy(_FrameReplay_State.Path, p_Path);
+    _FrameReplay_State.isDirectory = S_ISDIR(Info.st_mode);
+
+    /* Check the first segment here, so the caller gets the error */
+    FrameReplay_GetSegmentPath(1, Path, sizeof(Path));
+    File = FrameReplay_OpenSegment(Path, &Header);
+    if (File == NULL) {
+        ESP_LOGW(TAG, "%s is no recording of %ux%u frames!", Path, _FrameReplay_State.Width,
+                 _FrameReplay_State.Height);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    fclose(File);
+
+    _FrameReplay_State.Rate = Rate;
+    _FrameReplay_State.isLoop = isLoop;
+    _FrameReplay_State.isStopping = false;
+    _FrameReplay_State.Frames = 0;
+    _FrameReplay_State.Dropped = 0;
+    _FrameReplay_State.Errors = 0;
+    _FrameReplay_State.Source = FRAME_REPLAY_SOURCE_SD;
+
+    if (xTaskCreatePinnedToCore(Task_FrameReplay, "Task_Replay", CONFIG_LEPTON_REPLAY_TASK_STACKSIZE, NULL,
+                                CONFIG_LEPTON_REPLAY_TASK_PRIO, &_FrameReplay_State.Task,
+                                CONFIG_LEPTON_REPLAY_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create reader task!");
+
+        _FrameReplay_State.Source = FRAME_REPLAY_SOURCE_NONE;
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t FrameReplay_StartHost(void)
+{
+    if ((_FrameReplay_State.isInitialized == false) || (_FrameReplay_State.Source != FRAME_REPLAY_SOURCE_NONE)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    _FrameReplay_State.Rate = 0;
+    _FrameReplay_State.isLoop = false;
+    _FrameReplay_State.Frames = 0;
+    _FrameReplay_State.Dropped = 0;
+    _FrameReplay_State.Errors = 0;
+    _FrameReplay_State.Source = FRAME_REPLAY_SOURCE_HOST;
+
+    ESP_LOGI(TAG, "Replaying frames of the host");
+
+    return ESP_OK;
+}
+
+esp_err_t FrameReplay_Stop(void)
+{
+    if (_FrameReplay_State.Source == FRAME_REPLAY_SOURCE_SD) {
+        _FrameReplay_State.isStopping = true;
+
+        portENTER_CRITICAL(&_FrameReplay_Lock);
+        if (_FrameReplay_State.Task != NULL) {
+            xTaskNotifyGive(_FrameReplay_State.Task);
+        }
+        portEXIT_CRITICAL(&_FrameReplay_Lock);
+
+        /* The reader task leaves the source when it ends */
+        for (uint8_t i = 0; (i < 20) && (_FrameReplay_State.Task != NULL); i++) {
+            vTaskDelay(50 / portTICK_PERIOD_MS);
+        }
+    }
+
+    _FrameReplay_State.Source = FRAME_REPLAY_SOURCE_NONE;
+
+    if (_FrameReplay_State.Queue != NULL) {
+        xQueueReset(_FrameReplay_State.Queue);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t FrameReplay_Push(const uint8_t *p_Record, size_t Length)
+{
+    SDRecorder_Frame_Header_t Header;
+    size_t Size;
+
+    if (_FrameReplay_State.Source != FRAME_REPLAY_SOURCE_HOST) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    Size = _FrameReplay_State.Width * _FrameReplay_State.Height * sizeof(uint16_t);
+
+    if ((p_Record == NULL) || (Length < (sizeof(Header) + Size))) {
+        FrameReplay_CountError();
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    /* The record of a WebSocket message has no alignment */
+    memcpy(&Header, p_Record, sizeof(Header));
+    if (FrameReplay_isValid(&Header) == false) {
+        FrameReplay_CountError();
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    memcpy(_FrameReplay_State.Buffers[_FrameReplay_State.Next].RAW, p_Record + sizeof(Header), Size);
+    FrameReplay_Publish(&Header);
+
+    return ESP_OK;
+}
+
+bool FrameReplay_isActive(void)
+{
+    return _FrameReplay_State.Source != FRAME_REPLAY_SOURCE_NONE;
+}
+
+bool FrameReplay_Receive(Lepton_FrameBuffer_t *p_Frame, TickType_t Timeout)
+{
+    if ((_FrameReplay_State.isInitialized == false) || (p_Frame == NULL)) {
+        return false;
+    }
+
+    return xQueueReceive(_FrameReplay_State.Queue, p_Frame, Timeout) == pdTRUE;
+}
+
+void FrameReplay_GetStatus(FrameReplay_Status_t *p_Status)
+{
+    if (p_Status == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&_FrameReplay_Lock);
+    p_Status->Source = _FrameReplay_State.Source;
+    p_Status->Rate = _FrameReplay_State.Rate;
+    p_Status->isLoop = _FrameReplay_State.isLoop;
+    p_Status->Frames = _FrameReplay_State.Frames;
+    p_Status->Dropped = _FrameReplay_State.Dropped;
+    p_Status->Errors = _FrameReplay_State.Errors;
+    portEXIT_CRITICAL(&_FrameReplay_Lock);
+}
+
+#endif
@@ -0,0 +1,120 @@
+/*
+ * frameReplay.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Replay of recorded RAW14 frames as source of the capture pipeline.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef FRAME_REPLAY_H_
+#define FRAME_REPLAY_H_
+
+#include <esp_err.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "lepton.h"
+#include "Application/Manager/SD/sdRecorderFormat.h"
+
+/** @brief Source of the replayed frames.
+ */
+typedef enum {
+    FRAME_REPLAY_SOURCE_NONE = 0,               /**< No replay, the frames come from the VoSPI capture. */
+    FRAME_REPLAY_SOURCE_SD,                     /**< Recording of the SD recorder. */
+    FRAME_REPLAY_SOURCE_HOST,                   /**< Records pushed by a host, e.g. over the WebSocket. */
+} FrameReplay_Source_t;
+
+/** @brief State of the replay.
+ */
+typedef struct {
+    FrameReplay_Source_t Source;
+    uint16_t Rate;                              /**< Frame rate in Hz, 0 for the timing of the recording. */
+    bool isLoop;                                /**< The recording starts again at its end. */
+    uint32_t Frames;                            /**< Frames handed to the Lepton task. */
+    uint32_t Dropped;                           /**< Frames replaced by a newer frame before the Lepton task took them. */
+    uint32_t Errors;                            /**< Invalid records. */
+} FrameReplay_Status_t;
+
+/** @brief          Initialize the replay and allocate the frame buffers in PSRAM.
+ *  @param Width    Frame width in pixels
+ *  @param Height   Frame height in pixels
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if a parameter is invalid
+ *                  ESP_ERR_NO_MEM if the buffers can not be allocated
+ */
+esp_err_t FrameReplay_Init(uint16_t Width, uint16_t Height);
+
+/** @brief Stop the replay and free the buffers.
+ */
+void FrameReplay_Deinit(void);
+
+/** @brief          Replay a recording of the SD recorder instead of the VoSPI frames.
+ *  @param p_Path   Recording directory (/sdcard/RECnnnn) with all segments or a single segment file (SEGsss.PRV)
+ *  @param Rate     Frame rate in Hz, 0 for the timing of the recording. Rates above 9 Hz stress the pipeline.
+ *  @param isLoop   true to start the recording again at its end, false to return to the VoSPI frames
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_STATE if the replay is not initialized or already running
+ *                  ESP_ERR_NOT_FOUND if the recording can not be opened
+ *                  ESP_ERR_INVALID_VERSION if the file is not a recording of this size and version
+ *                  ESP_ERR_NO_MEM if the reader task can not be created
+ */
+esp_err_t FrameReplay_StartFile(const char *p_Path, uint16_t Rate, bool isLoop);
+
+/** @brief  Replay the records pushed with FrameReplay_Push instead of the VoSPI frames. The host sets the rate.
+ *  @return ESP_OK on success
+ *          ESP_ERR_INVALID_STATE if the replay is not initialized or already running
+ */
+esp_err_t FrameReplay_StartHost(void);
+
+/** @brief  Stop the replay. The Lepton task returns to the VoSPI frames.
+ *  @return ESP_OK on success
+ */
+esp_err_t FrameReplay_Stop(void);
+
+/** @brief          Push a record of a host. The record has the format of the SD recorder: a
+ *                  SDRecorder_Frame_Header_t followed by the RAW14 pixels, the padding is optional.
+ *  @param p_Record Record
+ *  @param Length   Length of the record in bytes
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_STATE if the host replay is not running
+ *                  ESP_ERR_INVALID_SIZE if the record is invalid or has another frame size
+ */
+esp_err_t FrameReplay_Push(const uint8_t *p_Record, size_t Length);
+
+/** @brief  Check if a replay is running. Read by the Lepton task with every frame.
+ *  @return true when the frames come from the replay
+ */
+bool FrameReplay_isActive(void);
+
+/** @brief          Wait for the next replayed frame. The buffers stay valid for two more frames.
+ *  @param p_Frame  Pointer to store the frame in the buffer format of the VoSPI capture
+ *  @param Timeout  Maximum time to wait
+ *  @return         true if a frame was received
+ */
+bool FrameReplay_Receive(Lepton_FrameBuffer_t *p_Frame, TickType_t Timeout);
+
+/** @brief          Get the state of the replay.
+ *  @param p_Status Pointer to store the state
+ */
+void FrameReplay_GetStatus(FrameReplay_Status_t *p_Status);
+
+#endif /* FRAME_REPLAY_H_ */
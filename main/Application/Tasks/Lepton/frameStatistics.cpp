@@ -0,0 +1,134 @@
+/*
+ * frameStatistics.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Per frame statistics over the RAW14 Lepton image.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_attr.h>
+
+#include <string.h>
+
+#include "frameStatistics.h"
+
+#define FRAME_STATISTICS_INVALID_INDEX          0xFFFFFFFF
+
+/** @brief Reduction kernel. Processes four pixels per iteration with branchless min/max (MINU/MAXU on Xtensa).
+ *         Radiometric values use the full 16 bit range, so only the sum fits into 32 bit (19200 * 65535).
+ */
+IRAM_ATTR esp_err_t FrameStatistics_Compute(const uint16_t *p_RAW, uint16_t Width, uint16_t Height,
+                                            FrameStatistics_t *p_Statistics)
+{
+    uint32_t Count;
+    uint32_t Blocks;
+    uint32_t Min0 = 0xFFFF;
+    uint32_t Min1 = 0xFFFF;
+    uint32_t Max0 = 0;
+    uint32_t Max1 = 0;
+    uint32_t Sum = 0;
+    uint64_t SumSquares = 0;
+    uint32_t Range;
+    uint32_t Scale;
+    uint32_t MinIndex = FRAME_STATISTICS_INVALID_INDEX;
+    uint32_t MaxIndex = FRAME_STATISTICS_INVALID_INDEX;
+    const uint16_t *p_Pixel;
+    float Mean;
+
+    if ((p_RAW == NULL) || (p_Statistics == NULL) || (Width == 0) || (Height == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    Count = Width * Height;
+    Blocks = Count / 4;
+    p_Pixel = p_RAW;
+
+    /* Pass 1: Min, max, sum and sum of squares */
+    for (uint32_t i = 0; i < Blocks; i++) {
+        uint32_t a = p_Pixel[0];
+        uint32_t b = p_Pixel[1];
+        uint32_t c = p_Pixel[2];
+        uint32_t d = p_Pixel[3];
+
+        Min0 = (a < Min0) ? a : Min0;
+        Min1 = (b < Min1) ? b : Min1;
+        Min0 = (c < Min0) ? c : Min0;
+        Min1 = (d < Min1) ? d : Min1;
+        Max0 = (a > Max0) ? a : Max0;
+        Max1 = (b > Max1) ? b : Max1;
+        Max0 = (c > Max0) ? c : Max0;
+        Max1 = (d > Max1) ? d : Max1;
+
+        Sum += a + b + c + d;
+        SumSquares += static_cast<uint64_t>(a * a) + (b * b);
+        SumSquares += static_cast<uint64_t>(c * c) + (d * d);
+
+        p_Pixel += 4;
+    }
+
+    for (uint32_t i = Blocks * 4; i < Count; i++) {
+        uint32_t a = p_RAW[i];
+
+        Min0 = (a < Min0) ? a : Min0;
+        Max0 = (a > Max0) ? a : Max0;
+        Sum += a;
+        SumSquares += a * a;
+    }
+
+    Min0 = (Min1 < Min0) ? Min1 : Min0;
+    Max0 = (Max1 > Max0) ? Max1 : Max0;
+
+    Mean = static_cast<float>(Sum) / static_cast<float>(Count);
+
+    p_Statistics->Min = static_cast<uint16_t>(Min0);
+    p_Statistics->Max = static_cast<uint16_t>(Max0);
+    p_Statistics->Mean = Mean;
+
+    /* N * SumSquares - Sum^2 is evaluated exactly in 64 bit to avoid the cancellation of the float formula */
+    p_Statistics->Variance = static_cast<float>((static_cast<uint64_t>(Count) * SumSquares) -
+                                                (static_cast<uint64_t>(Sum) * Sum)) /
+                             (static_cast<float>(Count) * static_cast<float>(Count));
+
+    /* Pass 2: Histogram between min and max and the location of the extrema.
+     * (Value - Min) < Range, so (Value - Min) * Scale < 256 << 16 and the product can not overflow */
+    Range = Max0 - Min0 + 1;
+    Scale = (FRAME_STATISTICS_HISTOGRAM_BINS << 16) / Range;
+    p_Statistics->BinWidth = static_cast<float>(Range) / FRAME_STATISTICS_HISTOGRAM_BINS;
+    memset(p_Statistics->Histogram, 0, sizeof(p_Statistics->Histogram));
+
+    for (uint32_t i = 0; i < Count; i++) {
+        uint32_t Value = p_RAW[i];
+
+        p_Statistics->Histogram[((Value - Min0) * Scale) >> 16]++;
+
+        if ((Value == Min0) && (MinIndex == FRAME_STATISTICS_INVALID_INDEX)) {
+            MinIndex = i;
+        }
+
+        if ((Value == Max0) && (MaxIndex == FRAME_STATISTICS_INVALID_INDEX)) {
+            MaxIndex = i;
+        }
+    }
+
+    p_Statistics->MinX = MinIndex % Width;
+    p_Statistics->MinY = MinIndex / Width;
+    p_Statistics->MaxX = MaxIndex % Width;
+    p_Statistics->MaxY = MaxIndex / Width;
+
+    return ESP_OK;
+}
@@ -0,0 +1,69 @@
+/*
+ * frameStatistics.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Per frame statistics over the RAW14 Lepton image.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef FRAME_STATISTICS_H_
+#define FRAME_STATISTICS_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+
+/** @brief Number of histogram bins. The bins are spread linearly between Min and Max of the frame.
+ */
+#define FRAME_STATISTICS_HISTOGRAM_BINS         256
+
+/** @brief Statistics of a single RAW14 frame. All values are raw counts (centi-Kelvin in radiometric mode).
+ */
+typedef struct {
+    uint16_t Min;                                               /**< Minimum pixel value. */
+    uint16_t Max;                                               /**< Maximum pixel value. */
+    uint16_t MinX;                                              /**< Column of the first minimum pixel. */
+    uint16_t MinY;                                              /**< Row of the first minimum pixel. */
+    uint16_t MaxX;                                              /**< Column of the first maximum pixel. */
+    uint16_t MaxY;                                              /**< Row of the first maximum pixel. */
+    float Mean;                                                 /**< Mean pixel value. */
+    float Variance;                                             /**< Variance of the pixel values. */
+    float BinWidth;                                             /**< Width of a histogram bin in raw counts. */
+    uint16_t Histogram[FRAME_STATISTICS_HISTOGRAM_BINS];        /**< Pixel count per bin, bin 0 starts at Min. */
+} FrameStatistics_t;
+
+/** @brief              Compute the statistics of a RAW14 frame.
+ *  @param p_RAW        Pointer to the RAW14 pixel data
+ *  @param Width        Frame width in pixels
+ *  @param Height       Frame height in pixels
+ *  @param p_Statistics Pointer to the statistics output
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if a parameter is invalid
+ */
+esp_err_t FrameStatistics_Compute(const uint16_t *p_RAW, uint16_t Width, uint16_t Height, FrameStatistics_t *p_Statistics);
+
+/** @brief      Convert a raw radiometric value (centi-Kelvin) into Degree Celsius.
+ *  @param Raw  Raw value
+ *  @return     Temperature in Degree Celsius
+ */
+static inline float FrameStatistics_RawToCelsius(float Raw)
+{
+    return (Raw * 0.01f) - 273.15f;
+}
+
+#endif /* FRAME_STATISTICS_H_ */
@@ -0,0 +1,78 @@
+/*
+ * isotherm.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Isotherm bands that paint temperature ranges in alarm colors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <string.h>
+
+#include "isotherm.h"
+
+static Isotherm_Set_t _Isotherm_Set;
+
+/* The bands are written by the command interfaces and read by the GUI and the encoder tasks */
+static portMUX_TYPE _Isotherm_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *TAG = "isotherm";
+
+esp_err_t Isotherm_Set(const Isotherm_Band_t *p_Bands, uint8_t Count)
+{
+    if ((Count > ISOTHERM_MAX_BANDS) || ((Count > 0) && (p_Bands == NULL))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (uint8_t i = 0; i < Count; i++) {
+        if (p_Bands[i].Low > p_Bands[i].High) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    portENTER_CRITICAL(&_Isotherm_Lock);
+    if (Count > 0) {
+        memcpy(_Isotherm_Set.Bands, p_Bands, Count * sizeof(Isotherm_Band_t));
+    }
+    _Isotherm_Set.Count = Count;
+    __atomic_store_n(&_Isotherm_Set.Revision, _Isotherm_Set.Revision + 1, __ATOMIC_RELAXED);
+    portEXIT_CRITICAL(&_Isotherm_Lock);
+
+    ESP_LOGD(TAG, "%u bands", Count);
+
+    return ESP_OK;
+}
+
+void Isotherm_Get(Isotherm_Set_t *p_Set)
+{
+    if (p_Set == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&_Isotherm_Lock);
+    memcpy(p_Set, &_Isotherm_Set, sizeof(Isotherm_Set_t));
+    portEXIT_CRITICAL(&_Isotherm_Lock);
+}
+
+uint32_t Isotherm_GetRevision(void)
+{
+    return __atomic_load_n(&_Isotherm_Set.Revision, __ATOMIC_RELAXED);
+}
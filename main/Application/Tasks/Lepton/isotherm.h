@@ -0,0 +1,99 @@
+/*
+ * isotherm.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Isotherm bands that paint temperature ranges in alarm colors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef ISOTHERM_H_
+#define ISOTHERM_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Maximum number of isotherm bands.
+ */
+#define ISOTHERM_MAX_BANDS                      4
+
+/** @brief Temperature band painted in one color. A band from 0 paints everything below High, a band up to
+ *         UINT16_MAX everything above Low.
+ */
+typedef struct {
+    uint16_t Low;                               /**< Lower end in raw counts (centi-Kelvin), inclusive. */
+    uint16_t High;                              /**< Upper end in raw counts (centi-Kelvin), inclusive. */
+    uint8_t Color[3];                           /**< RGB888 color. */
+} Isotherm_Band_t;
+
+/** @brief Copy of the active bands.
+ */
+typedef struct {
+    uint32_t Revision;                          /**< Changes with every update of the bands. */
+    uint8_t Count;                              /**< Number of bands, the first band is painted on top. */
+    Isotherm_Band_t Bands[ISOTHERM_MAX_BANDS];
+} Isotherm_Set_t;
+
+/** @brief          Replace the bands of the display and the encoders. The lookup tables are patched with their next
+ *                  rebuild, so the bands cost nothing per frame.
+ *  @param p_Bands  Bands, can be NULL if Count is 0
+ *  @param Count    Number of bands
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if a band is invalid or Count is too large
+ */
+esp_err_t Isotherm_Set(const Isotherm_Band_t *p_Bands, uint8_t Count);
+
+/** @brief          Get a copy of the bands.
+ *  @param p_Set    Pointer to store the bands
+ */
+void Isotherm_Get(Isotherm_Set_t *p_Set);
+
+/** @brief  Get the revision of the bands, to check for a change without a copy.
+ *  @return Revision
+ */
+uint32_t Isotherm_GetRevision(void);
+
+/** @brief          Get the entries of a lookup table inside a band. Entry n of the table holds the raw value
+ *                  Min + (n << Shift), the first entry also holds everything below Min and the last one everything
+ *                  above.
+ *  @param Low      Lower end of the band in raw counts
+ *  @param High     Upper end of the band in raw counts
+ *  @param Min      Raw value of the first entry
+ *  @param Shift    Index shift of the table
+ *  @param Entries  Number of table entries
+ *  @param p_First  Pointer to store the first entry of the band
+ *  @param p_Last   Pointer to store the last entry of the band
+ *  @return         true if the band covers at least one entry
+ */
+static inline bool Isotherm_GetEntries(uint16_t Low, uint16_t High, uint16_t Min, uint8_t Shift, uint32_t Entries,
+                                       uint32_t *p_First, uint32_t *p_Last)
+{
+    if ((Entries == 0) || (High < Min) || (Low > High)) {
+        return false;
+    }
+
+    /* An entry is painted when its raw value is inside the band */
+    *p_First = (Low <= Min) ? 0 : ((static_cast<uint32_t>(Low - Min) + (1UL << Shift) - 1) >> Shift);
+    *p_Last = static_cast<uint32_t>(High - Min) >> Shift;
+    *p_Last = (*p_Last < Entries) ? *p_Last : (Entries - 1);
+
+    return *p_First <= *p_Last;
+}
+
+#endif /* ISOTHERM_H_ */
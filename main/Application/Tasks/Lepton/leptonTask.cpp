@@ -24,6 +24,7 @@
 #include <esp_log.h>
 #include <esp_event.h>
 #include <esp_task_wdt.h>
+#include <esp_timer.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -34,16 +35,27 @@
 
 #include "lepton.h"
 #include "leptonTask.h"
+#include "framePool.h"
+#include "frameProducts.h"
+#include "frameLatency.h"
+#include "frameRecorder.h"
+#include "frameReplay.h"
+#include "frameDenoise.h"
+#include "frameFreeze.h"
+#include "spotTracker.h"
+#include "roiEngine.h"
+#include "Private/cciWorker.h"
 #include "Application/application.h"
+#include "Application/Boot/boot.h"
+#include "Application/Trace/trace.h"
+#include "Application/Bus/messageBus.h"
+#include "Application/Topology/topology.h"
+#include "Application/Manager/Devices/I2C/i2c.h"
+#include "Application/Manager/Network/Server/server.h"
+#include "Application/Manager/SD/sdRecorder.h"
+#include "Application/Manager/Time/timeManager.h"
 
 #define LEPTON_TASK_STOP_REQUEST                BIT0
-#define LEPTON_TASK_UPDATE_ROI_REQUEST          BIT1
-#define LEPTON_TASK_UPDATE_TEMP_REQUEST         BIT2
-#define LEPTON_TASK_UPDATE_UPTIME_REQUEST       BIT3
-#define LEPTON_TASK_UPDATE_PIXEL_TEMPERATURE    BIT4
-#define LEPTON_TASK_UPDATE_SPOTMETER            BIT5
-#define LEPTON_TASK_UPDATE_SCENE_STATISTICS     BIT6
-#define LEPTON_TASK_UPDATE_EMISSIVITY           BIT7
 
 ESP_EVENT_DEFINE_BASE(LEPTON_EVENTS);
 
@@ -51,84 +63,506 @@ typedef struct {
     bool isInitialized;
     bool Running;
     bool RunTask;
-    bool ApplicationStarted;
+    bool hasCamera;                             /**< false when the replay is the only frame source. */
     TaskHandle_t TaskHandle;
     EventGroupHandle_t EventGroup;
-    uint8_t *RGB_Buffer[2];
-    uint8_t CurrentReadBuffer;
-    uint16_t Emissivity;
-    SemaphoreHandle_t BufferMutex;
     QueueHandle_t RawFrameQueue;
     Lepton_FrameBuffer_t RawFrame;
     Lepton_Conf_t LeptonConf;
     Lepton_t Lepton;
-    App_Settings_ROI_t ROI;
-    App_GUI_Screenposition_t ScreenPosition;
+    Network_Thermal_Frame_t NetworkFrame;       /**< Native frame for the network encoders. Holds one pool reference. */
+    App_Lepton_Capture_t Capture;               /**< VoSPI stream health, protected by _LeptonTask_CaptureLock. */
+    int64_t LastFrameTime;                      /**< Time of the last VoSPI frame or the capture start in us. */
+    uint32_t Misses;                            /**< Consecutive frame timeouts. Only used by the Lepton task. */
+#ifdef CONFIG_LEPTON_DENOISE
+    FrameDenoise_t Denoise;                     /**< Only used by the Lepton task. */
+    uint8_t DenoiseStrength;                    /**< Requested strength, only changed atomically. */
+#endif
+#ifdef CONFIG_LEPTON_SPOTS
+    SpotTracker_t Spots;                        /**< Only used by the Lepton task. */
+    uint16_t SpotThreshold[SPOT_TRACKER_KIND_COUNT];    /**< Requested thresholds, only changed atomically. */
+    SpotTracker_Result_t SpotResult;            /**< Result of the latest frame, protected by _LeptonTask_SpotLock. */
+#endif
+#ifdef CONFIG_LEPTON_FFC
+    FrameFreeze_t Freeze;                       /**< Only used by the Lepton task. */
+    uint32_t Repeats;                           /**< Frames dropped since the last published camera frame. */
+    App_Lepton_FFC_t FFC;                       /**< Latest correction, protected by _LeptonTask_FFCLock. */
+#endif
 } Lepton_Task_State_t;
 
 static Lepton_Task_State_t _LeptonTask_State;
 
+/* The capture health is written by the Lepton task and read by the telemetry */
+static portMUX_TYPE _LeptonTask_CaptureLock = portMUX_INITIALIZER_UNLOCKED;
+
+#ifdef CONFIG_LEPTON_SPOTS
+/* The spots are written by the Lepton task and read by the VISA and the WebSocket tasks */
+static portMUX_TYPE _LeptonTask_SpotLock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+#ifdef CONFIG_LEPTON_FFC
+/* The correction is written by the Lepton task and read by the VISA task */
+static portMUX_TYPE _LeptonTask_FFCLock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
 static const char *TAG = "lepton_task";
 
-static void on_GUI_Event_Handler(void *p_HandlerArgs, esp_event_base_t Base, int32_t ID, void *p_Data)
+/** @brief Deinitialize the camera driver, if a camera was found.
+ */
+static void Lepton_DeinitCamera(void)
 {
-    ESP_LOGD(TAG, "GUI event received: ID=%d", ID);
+    if (_LeptonTask_State.hasCamera) {
+        Lepton_Deinit(&_LeptonTask_State.Lepton);
+        _LeptonTask_State.hasCamera = false;
+    }
+}
 
-    switch (ID) {
-        case GUI_EVENT_APP_STARTED: {
-            ESP_LOGD(TAG, "Application started event received");
+/** @brief              CCI write of the Lepton driver. The device handle is created by the driver, so the bus
+ *                      priority is passed with every transfer.
+ *  @param p_Dev_Handle Pointer to I2C device handle
+ *  @param p_Data       Pointer to data
+ *  @param Length       Length of data in bytes
+ *  @return             ESP_OK when successful
+ */
+static int32_t Lepton_CCI_Write(i2c_master_dev_handle_t *p_Dev_Handle, const uint8_t *p_Data, uint32_t Length)
+{
+    return I2CM_Transfer(p_Dev_Handle, I2CM_PRIORITY_HIGH, p_Data, Length, NULL, 0);
+}
 
-            _LeptonTask_State.ApplicationStarted = true;
+/** @brief              CCI read of the Lepton driver.
+ *  @param p_Dev_Handle Pointer to I2C device handle
+ *  @param p_Data       Pointer to data
+ *  @param Length       Length of data in bytes
+ *  @return             ESP_OK when successful
+ */
+static int32_t Lepton_CCI_Read(i2c_master_dev_handle_t *p_Dev_Handle, uint8_t *p_Data, uint32_t Length)
+{
+    return I2CM_Transfer(p_Dev_Handle, I2CM_PRIORITY_HIGH, NULL, 0, p_Data, Length);
+}
 
-            break;
-        }
+/** @brief              Execute a request of the GUI from the request channel.
+ *  @param p_Message    Pointer to the request
+ */
+static void Lepton_HandleRequest(const Bus_Request_t *p_Message)
+{
+    CCIWorker_Request_t Request;
+
+    ESP_LOGD(TAG, "Request received: ID=%d", p_Message->ID);
+
+    /* All CCI transfers are handed over to the CCI worker, so the capture loop never waits for the I2C bus */
+    memset(&Request, 0, sizeof(Request));
+
+    switch (p_Message->ID) {
         case GUI_EVENT_REQUEST_ROI: {
-            memcpy(&_LeptonTask_State.ROI, p_Data, sizeof(App_Settings_ROI_t));
+            ROIEngine_ROI_t EngineROI;
+
+            Request.Command = CCI_WORKER_CMD_SET_ROI;
+            Request.Data.ROI = p_Message->Data.ROI;
 
-            xEventGroupSetBits(_LeptonTask_State.EventGroup, LEPTON_TASK_UPDATE_ROI_REQUEST);
+            /* The software ROI engine is updated immediately, the settings ROI types are used as slot index */
+            memset(&EngineROI, 0, sizeof(EngineROI));
+            EngineROI.Shape = ROI_SHAPE_RECT;
+            EngineROI.x = Request.Data.ROI.x;
+            EngineROI.y = Request.Data.ROI.y;
+            EngineROI.w = Request.Data.ROI.w;
+            EngineROI.h = Request.Data.ROI.h;
+            ROIEngine_SetROI(static_cast<uint8_t>(Request.Data.ROI.Type), &EngineROI);
+
+            CCIWorker_Submit(&Request, CCI_WORKER_PRIO_HIGH);
 
             break;
         }
         case GUI_EVENT_REQUEST_FPA_AUX_TEMP: {
-            xEventGroupSetBits(_LeptonTask_State.EventGroup, LEPTON_TASK_UPDATE_TEMP_REQUEST);
-            break;
-        }
-        case GUI_EVENT_REQUEST_UPTIME: {
-            xEventGroupSetBits(_LeptonTask_State.EventGroup, LEPTON_TASK_UPDATE_UPTIME_REQUEST);
+            Request.Command = CCI_WORKER_CMD_GET_TEMPERATURE;
+            CCIWorker_Submit(&Request, CCI_WORKER_PRIO_LOW);
 
             break;
         }
-        case GUI_EVENT_REQUEST_PIXEL_TEMPERATURE: {
-            _LeptonTask_State.ScreenPosition = *(App_GUI_Screenposition_t *)p_Data;
-
-            xEventGroupSetBits(_LeptonTask_State.EventGroup, LEPTON_TASK_UPDATE_PIXEL_TEMPERATURE);
+        case GUI_EVENT_REQUEST_UPTIME: {
+            Request.Command = CCI_WORKER_CMD_GET_UPTIME;
+            CCIWorker_Submit(&Request, CCI_WORKER_PRIO_LOW);
 
             break;
         }
         case GUI_EVENT_REQUEST_SPOTMETER: {
-            xEventGroupSetBits(_LeptonTask_State.EventGroup, LEPTON_TASK_UPDATE_SPOTMETER);
+            Request.Command = CCI_WORKER_CMD_GET_SPOTMETER;
+            CCIWorker_Submit(&Request, CCI_WORKER_PRIO_LOW);
 
             break;
         }
         case GUI_EVENT_REQUEST_SCENE_STATISTICS: {
-            xEventGroupSetBits(_LeptonTask_State.EventGroup, LEPTON_TASK_UPDATE_SCENE_STATISTICS);
+            Request.Command = CCI_WORKER_CMD_GET_SCENE_STATISTICS;
+            CCIWorker_Submit(&Request, CCI_WORKER_PRIO_LOW);
 
             break;
         }
         case GUI_EVENT_REQUEST_EMISSIVITY: {
-            _LeptonTask_State.Emissivity = *(uint16_t *)p_Data;
+            Request.Command = CCI_WORKER_CMD_SET_EMISSIVITY;
+            Request.Data.Emissivity = p_Message->Data.Emissivity;
+            CCIWorker_Submit(&Request, CCI_WORKER_PRIO_HIGH);
+
+            break;
+        }
+        default: {
+            ESP_LOGW(TAG, "Unhandled request ID: %d", p_Message->ID);
+            break;
+        }
+    }
+}
 
-            xEventGroupSetBits(_LeptonTask_State.EventGroup, LEPTON_TASK_UPDATE_EMISSIVITY);
+/** @brief                  Network event handler.
+ *  @param p_HandlerArgs    Handler argument
+ *  @param Base             Event base
+ *  @param ID               Event ID
+ *  @param p_Data           Event-specific data
+ */
+static void on_Network_Event_Handler(void *p_HandlerArgs, esp_event_base_t Base, int32_t ID, void *p_Data)
+{
+    switch (ID) {
+        case NETWORK_EVENT_SERVER_STARTED: {
+            /* Register the network frame with the server (called after the server is started) */
+            Server_SetThermalFrame(&_LeptonTask_State.NetworkFrame);
+            ESP_LOGD(TAG, "Network frame registered with server");
 
             break;
         }
         default: {
-            ESP_LOGW(TAG, "Unhandled GUI event ID: %d", ID);
             break;
         }
     }
 }
 
+/** @brief          Colorize the RAW14 data of a frame slot. Used by the frame products for FRAME_PRODUCT_RGB.
+ *  @param p_Frame  Frame with RAW14 data
+ *  @param p_RGB    RGB888 output
+ *  @param p_Min    Minimum temperature of the frame in centi-Kelvin
+ *  @param p_Max    Maximum temperature of the frame in centi-Kelvin
+ */
+static void Lepton_Colorize(const FramePool_Frame_t *p_Frame, uint8_t *p_RGB, int16_t *p_Min, int16_t *p_Max)
+{
+    /* The slot holds a copy of the VoSPI buffer, so it is passed in the buffer type of the driver */
+    Lepton_Raw14ToRGB(&_LeptonTask_State.Lepton,
+                      reinterpret_cast<decltype(_LeptonTask_State.RawFrame.Image_Buffer)>(p_Frame->RAW), p_RGB, p_Min,
+                      p_Max, p_Frame->Width, p_Frame->Height);
+}
+
+#ifdef CONFIG_LEPTON_SPOTS
+/** @brief The statistics are computed with every frame while an alarm threshold is set, the tracker needs them
+ *         for its quick check.
+ */
+static void Lepton_SubscribeSpots(void)
+{
+    bool isEnabled = false;
+
+    for (uint8_t i = 0; i < SPOT_TRACKER_KIND_COUNT; i++) {
+        isEnabled |= (__atomic_load_n(&_LeptonTask_State.SpotThreshold[i], __ATOMIC_RELAXED) != 0);
+    }
+
+    isEnabled &= (_LeptonTask_State.Spots.Runs != NULL);
+
+    FrameProducts_Subscribe(FRAME_CONSUMER_SPOTS, isEnabled ? FRAME_PRODUCT_STATISTICS : 0);
+}
+
+/** @brief Initialize the spot tracker with the thresholds of the configuration.
+ */
+static void Lepton_InitSpots(void)
+{
+    SpotTracker_Config_t Config;
+
+    memset(&Config, 0, sizeof(Config));
+#ifdef CONFIG_LEPTON_SPOTS_HOT_ALARM
+    Config.Threshold[SPOT_TRACKER_HOT] = (CONFIG_LEPTON_SPOTS_HOT * 100) + 27315;
+#endif
+#ifdef CONFIG_LEPTON_SPOTS_COLD_ALARM
+    Config.Threshold[SPOT_TRACKER_COLD] = (CONFIG_LEPTON_SPOTS_COLD * 100) + 27315;
+#endif
+    Config.Hysteresis = CONFIG_LEPTON_SPOTS_HYSTERESIS * 10;
+    Config.MinArea = CONFIG_LEPTON_SPOTS_MIN_AREA;
+    Config.Confirm = CONFIG_LEPTON_SPOTS_CONFIRM;
+    Config.Clear = CONFIG_LEPTON_SPOTS_CLEAR;
+
+    memset(&_LeptonTask_State.SpotResult, 0, sizeof(SpotTracker_Result_t));
+    memcpy(_LeptonTask_State.SpotThreshold, Config.Threshold, sizeof(_LeptonTask_State.SpotThreshold));
+
+    if (SpotTracker_Init(&_LeptonTask_State.Spots, 160, 120, &Config) != ESP_OK) {
+        ESP_LOGW(TAG, "Can not allocate spot tracker, the spot alarms are disabled!");
+        return;
+    }
+
+    Lepton_SubscribeSpots();
+}
+
+/** @brief          Track the hot and cold spots of a published frame and post the alarm changes.
+ *  @param p_Frame  Pointer to the published frame
+ */
+static void Lepton_TrackSpots(const FramePool_Frame_t *p_Frame)
+{
+    /* Only used by the Lepton task, static to keep it off the stack */
+    static SpotTracker_Result_t Result;
+    SpotTracker_Event_t Events[SPOT_TRACKER_KIND_COUNT];
+    SpotTracker_t *p_Tracker;
+    bool isIdle;
+    uint8_t Count;
+
+    p_Tracker = &_LeptonTask_State.Spots;
+    if ((p_Tracker->Runs == NULL) || (p_Frame->hasRAW == false)) {
+        return;
+    }
+
+    isIdle = (p_Tracker->Count == 0);
+    for (uint8_t i = 0; i < SPOT_TRACKER_KIND_COUNT; i++) {
+        uint16_t Threshold = __atomic_load_n(&_LeptonTask_State.SpotThreshold[i], __ATOMIC_RELAXED);
+
+        if (Threshold != p_Tracker->Config.Threshold[i]) {
+            SpotTracker_SetThreshold(p_Tracker, static_cast<SpotTracker_Kind_t>(i), Threshold);
+        }
+
+        isIdle &= (Threshold == 0) && (p_Tracker->isAlarm[i] == false);
+    }
+
+    /* Nothing to track and no alarm to clear */
+    if (isIdle) {
+        return;
+    }
+
+    /* Only missing right after a threshold was set, the subscription computes them from the next frame on */
+    if (FrameProducts_Require(p_Frame, FRAME_PRODUCT_STATISTICS) != ESP_OK) {
+        return;
+    }
+
+    Count = SpotTracker_Process(p_Tracker, p_Frame->RAW, &p_Frame->Statistics, p_Frame->Sequence, &Result, Events);
+
+    portENTER_CRITICAL(&_LeptonTask_SpotLock);
+    memcpy(&_LeptonTask_State.SpotResult, &Result, sizeof(SpotTracker_Result_t));
+    portEXIT_CRITICAL(&_LeptonTask_SpotLock);
+
+    for (uint8_t i = 0; i < Count; i++) {
+        ESP_LOGI(TAG, "%s spot alarm %s, spot %u at %u/%u (%u)", (Events[i].Kind == SPOT_TRACKER_HOT) ? "Hot" : "Cold",
+                 (Events[i].Type == SPOT_TRACKER_EVENT_RAISED) ? "raised" : "cleared", Events[i].ID, Events[i].X,
+                 Events[i].Y, Events[i].Peak);
+
+        /* The frame loop never waits for the event loop, a full queue drops the event */
+        esp_event_post(LEPTON_EVENTS, LEPTON_EVENT_SPOT_ALARM, &Events[i], sizeof(SpotTracker_Event_t), 0);
+    }
+}
+#endif
+
+#ifdef CONFIG_LEPTON_FFC
+/** @brief Forget the last camera frame when the replay takes over. A running correction ends without an event.
+ */
+static void Lepton_ResetFreeze(void)
+{
+    if (_LeptonTask_State.Freeze.hasHistory == false) {
+        return;
+    }
+
+    FrameFreeze_Reset(&_LeptonTask_State.Freeze);
+    _LeptonTask_State.Repeats = 0;
+
+    portENTER_CRITICAL(&_LeptonTask_FFCLock);
+    _LeptonTask_State.FFC.isActive = false;
+    portEXIT_CRITICAL(&_LeptonTask_FFCLock);
+}
+
+/** @brief              Check if the received VoSPI frame repeats the last one. The camera repeats its last frame
+ *                      while the shutter is closed for a flat field correction, these frames are dropped before
+ *                      the frame pool, so the display, the streams and the recordings never process them again.
+ *  @param p_isFinished Set to true when the frame ends a correction, the event is posted after the publish
+ *  @return             true if the frame is a repeat and must be dropped
+ */
+static bool Lepton_CheckFreeze(bool *p_isFinished)
+{
+    Lepton_Telemetry_t Telemetry;
+    FrameFreeze_Event_t Event;
+    FrameFreeze_Info_t Info;
+    App_Lepton_FFC_t FFC;
+    uint32_t Counter;
+    bool isRepeat;
+    size_t Size;
+
+    Counter = 0;
+    if (_LeptonTask_State.RawFrame.Telemetry_Buffer != NULL) {
+        memcpy(&Telemetry, _LeptonTask_State.RawFrame.Telemetry_Buffer, sizeof(Lepton_Telemetry_t));
+        Counter = Telemetry.FrameCounter;
+    }
+
+    Size = _LeptonTask_State.RawFrame.Width * _LeptonTask_State.RawFrame.Height *
+           _LeptonTask_State.RawFrame.BytesPerPixel;
+
+    isRepeat = FrameFreeze_Check(&_LeptonTask_State.Freeze, _LeptonTask_State.RawFrame.Image_Buffer, Size,
+                                 (_LeptonTask_State.RawFrame.Telemetry_Buffer != NULL) ? &Counter : NULL,
+                                 esp_timer_get_time(), &Event, &Info);
+
+    *p_isFinished = (Event == FRAME_FREEZE_EVENT_FINISHED);
+
+    if (isRepeat) {
+        _LeptonTask_State.Repeats++;
+    }
+
+    portENTER_CRITICAL(&_LeptonTask_FFCLock);
+    if (isRepeat) {
+        _LeptonTask_State.FFC.Dropped++;
+    }
+
+    if (Event != FRAME_FREEZE_EVENT_NONE) {
+        _LeptonTask_State.FFC.isActive = (Event == FRAME_FREEZE_EVENT_STARTED);
+        _LeptonTask_State.FFC.Number = Info.Number;
+        _LeptonTask_State.FFC.Frames = Info.Frames;
+        _LeptonTask_State.FFC.Duration = Info.Duration;
+
+        if (Event == FRAME_FREEZE_EVENT_STARTED) {
+            _LeptonTask_State.FFC.Sequence = FramePool_GetSequence();
+        }
+    }
+    memcpy(&FFC, &_LeptonTask_State.FFC, sizeof(App_Lepton_FFC_t));
+    portEXIT_CRITICAL(&_LeptonTask_FFCLock);
+
+    if (Event == FRAME_FREEZE_EVENT_STARTED) {
+        ESP_LOGI(TAG, "Flat field correction %lu started after frame %lu", static_cast<unsigned long>(FFC.Number),
+                 static_cast<unsigned long>(FFC.Sequence));
+
+        /* The frame loop never waits for the event loop, a full queue drops the event */
+        esp_event_post(LEPTON_EVENTS, LEPTON_EVENT_FFC, &FFC, sizeof(App_Lepton_FFC_t), 0);
+    }
+
+    return isRepeat;
+}
+
+/** @brief          Report the end of a correction with the first new frame.
+ *  @param p_Frame  Pointer to the published frame
+ */
+static void Lepton_FinishFreeze(const FramePool_Frame_t *p_Frame)
+{
+    App_Lepton_FFC_t FFC;
+
+    portENTER_CRITICAL(&_LeptonTask_FFCLock);
+    _LeptonTask_State.FFC.Sequence = p_Frame->Sequence;
+    memcpy(&FFC, &_LeptonTask_State.FFC, sizeof(App_Lepton_FFC_t));
+    portEXIT_CRITICAL(&_LeptonTask_FFCLock);
+
+    ESP_LOGI(TAG, "Flat field correction %lu finished, %lu frames dropped in %lu ms",
+             static_cast<unsigned long>(FFC.Number), static_cast<unsigned long>(FFC.Frames),
+             static_cast<unsigned long>(FFC.Duration));
+
+    esp_event_post(LEPTON_EVENTS, LEPTON_EVENT_FFC, &FFC, sizeof(App_Lepton_FFC_t), 0);
+}
+#endif
+
+/** @brief Count a VoSPI frame and end an interruption of the stream.
+ */
+static void Lepton_CaptureReceived(void)
+{
+    int64_t Now;
+    uint32_t Duration;
+    bool isFirst;
+
+    Now = esp_timer_get_time();
+    Duration = static_cast<uint32_t>((Now - _LeptonTask_State.LastFrameTime) / 1000);
+
+    portENTER_CRITICAL(&_LeptonTask_CaptureLock);
+    isFirst = (_LeptonTask_State.Capture.Frames == 0);
+    if (isFirst) {
+        /* The synchronization after the start is no interruption */
+        _LeptonTask_State.Capture.SyncTime = Duration;
+    } else if (_LeptonTask_State.Misses > 0) {
+        _LeptonTask_State.Capture.Resyncs++;
+        _LeptonTask_State.Capture.LastResync = Duration;
+        if (Duration > _LeptonTask_State.Capture.MaxResync) {
+            _LeptonTask_State.Capture.MaxResync = Duration;
+        }
+    }
+    _LeptonTask_State.Capture.Frames++;
+    _LeptonTask_State.Capture.isLost = false;
+    portEXIT_CRITICAL(&_LeptonTask_CaptureLock);
+
+    if (isFirst) {
+        ESP_LOGI(TAG, "VoSPI stream synchronized after %lu ms", static_cast<unsigned long>(Duration));
+    } else if (_LeptonTask_State.Misses > 0) {
+        ESP_LOGI(TAG, "VoSPI stream back after %lu ms", static_cast<unsigned long>(Duration));
+    }
+
+    _LeptonTask_State.Misses = 0;
+    _LeptonTask_State.LastFrameTime = Now;
+}
+
+/** @brief Count a frame timeout of the VoSPI stream. The stream is reported as lost once per interruption after
+ *         CONFIG_LEPTON_CAPTURE_RETRIES timeouts, the capture keeps waiting for the camera.
+ */
+static void Lepton_CaptureTimeout(void)
+{
+    bool isStarted;
+
+    _LeptonTask_State.Misses++;
+
+    portENTER_CRITICAL(&_LeptonTask_CaptureLock);
+    _LeptonTask_State.Capture.Timeouts++;
+    isStarted = (_LeptonTask_State.Capture.Frames > 0);
+    _LeptonTask_State.Capture.isLost = isStarted;
+    portEXIT_CRITICAL(&_LeptonTask_CaptureLock);
+
+    /* One warning per interruption instead of one per timeout */
+    if ((_LeptonTask_State.Misses == 1) && isStarted) {
+        ESP_LOGW(TAG, "VoSPI stream interrupted, no frame for %u ms", CONFIG_LEPTON_CAPTURE_TIMEOUT);
+    }
+
+    if (_LeptonTask_State.Misses == CONFIG_LEPTON_CAPTURE_RETRIES) {
+        ESP_LOGE(TAG, "No VoSPI frame for %lu ms, camera lost!",
+                 static_cast<unsigned long>((esp_timer_get_time() - _LeptonTask_State.LastFrameTime) / 1000));
+        esp_event_post(LEPTON_EVENTS, LEPTON_EVENT_CAMERA_ERROR, NULL, 0, 0);
+    }
+}
+
+/** @brief          Hand a published frame to the network encoders. Only the reference is passed, the encoders
+ *                  read the native frame directly from the pool slot.
+ *  @param p_Frame  Pointer to the published frame
+ */
+static void Lepton_UpdateNetworkFrame(FramePool_Frame_t *p_Frame)
+{
+    FramePool_Frame_t *Previous;
+
+    /* Skip the frame if an encoder is still reading the previous one */
+    if (xSemaphoreTake(_LeptonTask_State.NetworkFrame.mutex, 0) != pdTRUE) {
+        return;
+    }
+
+    Previous = _LeptonTask_State.NetworkFrame.frame;
+
+    _LeptonTask_State.NetworkFrame.frame = FramePool_Retain(p_Frame);
+    _LeptonTask_State.NetworkFrame.buffer = p_Frame->RGB;
+    _LeptonTask_State.NetworkFrame.raw = p_Frame->hasRAW ? p_Frame->RAW : NULL;
+    _LeptonTask_State.NetworkFrame.width = p_Frame->Width;
+    _LeptonTask_State.NetworkFrame.height = p_Frame->Height;
+    _LeptonTask_State.NetworkFrame.sequence = p_Frame->Sequence;
+    _LeptonTask_State.NetworkFrame.timestamp = p_Frame->Timestamp / 1000;
+    _LeptonTask_State.NetworkFrame.time = p_Frame->Time;
+
+    /* Use the spotmeter of the ROI engine and fall back to the scene statistics */
+    if (p_Frame->hasROI && p_Frame->ROI[ROI_TYPE_SPOTMETER].isValid) {
+        _LeptonTask_State.NetworkFrame.temp_min = p_Frame->ROI[ROI_TYPE_SPOTMETER].Min;
+        _LeptonTask_State.NetworkFrame.temp_max = p_Frame->ROI[ROI_TYPE_SPOTMETER].Max;
+        _LeptonTask_State.NetworkFrame.temp_avg = p_Frame->ROI[ROI_TYPE_SPOTMETER].Mean;
+    } else if (p_Frame->hasStatistics) {
+        _LeptonTask_State.NetworkFrame.temp_min = FrameStatistics_RawToCelsius(p_Frame->Statistics.Min);
+        _LeptonTask_State.NetworkFrame.temp_max = FrameStatistics_RawToCelsius(p_Frame->Statistics.Max);
+        _LeptonTask_State.NetworkFrame.temp_avg = FrameStatistics_RawToCelsius(p_Frame->Statistics.Mean);
+    }
+
+    xSemaphoreGive(_LeptonTask_State.NetworkFrame.mutex);
+
+    FramePool_Release(Previous);
+
+    /* Notify Websocket handler that a new frame is ready (non-blocking). Without clients the handler only takes
+       the frame for the backfill ring of a parked stream session */
+    WebSocket_Handler_NotifyFrameReady();
+
+    /* Wake up the MJPEG streams */
+    HTTP_Server_NotifyFrameReady();
+
+#ifdef CONFIG_NETWORK_RTP
+    RTPStreamer_NotifyFrameReady();
+#endif
+}
+
 /** @brief          Lepton camera task main loop.
  *  @param p_Parameters Pointer to App_Context_t structure
  */
@@ -154,288 +588,241 @@ static void Task_Lepton(void *p_Parameters)
     ESP_LOGD(TAG, "	Part number: %s", DeviceInfo.PartNumber);
     ESP_LOGD(TAG, "	Serial number: %s", DeviceInfo.SerialNumber);
 
-    esp_event_post(LEPTON_EVENTS, LEPTON_EVENT_CAMERA_READY, &DeviceInfo, sizeof(App_Lepton_Device_t), portMAX_DELAY);
+    Bus_Publish(BUS_TOPIC_LEPTON_DEVICE, &DeviceInfo, sizeof(App_Lepton_Device_t));
 
-    while (_LeptonTask_State.ApplicationStarted == false) {
-        esp_task_wdt_reset();
-        vTaskDelay(100 / portTICK_PERIOD_MS);
-    }
-
-    Lepton_FluxLinearParams_t FluxParams;
-    Lepton_GetFluxLinearParameters(&_LeptonTask_State.Lepton, &FluxParams);
-    ESP_LOGI(TAG,
-             "Flux Linear Parameters - Scene Emissivity: %u, TBkgK: %u, TauWindow: %u, TWindowK: %u, TauAtm: %u, TAtmK: %u, ReflWindow: %u, TReflK: %u",
-             FluxParams.SceneEmissivity,
-             FluxParams.TBkgK,
-             FluxParams.TauWindow,
-             FluxParams.TWindowK,
-             FluxParams.TauAtm,
-             FluxParams.TAtmK,
-             FluxParams.ReflWindow,
-             FluxParams.TReflK);
-
-    ESP_LOGD(TAG, "Start image capturing...");
-
-    if (Lepton_StartCapture(&_LeptonTask_State.Lepton, _LeptonTask_State.RawFrameQueue) != LEPTON_ERR_OK) {
-        ESP_LOGE(TAG, "Can not start image capturing!");
-        esp_event_post(LEPTON_EVENTS, LEPTON_EVENT_CAMERA_ERROR, NULL, 0, portMAX_DELAY);
-
-        /* Critical error - cannot continue without capture task */
-        _LeptonTask_State.Running = false;
-        _LeptonTask_State.TaskHandle = NULL;
-        esp_task_wdt_delete(NULL);
-        vTaskDelete(NULL);
-        return;
+    /* The capture starts right away and does not wait for the GUI. The VoSPI stream needs a few frames to
+       synchronize, which now overlaps with the rest of the boot. Serve the CCI requests that were queued while
+       the application was starting. The worker reads the flux parameters first */
+    if (_LeptonTask_State.hasCamera) {
+        if (CCIWorker_Start() != ESP_OK) {
+            ESP_LOGE(TAG, "Can not start CCI worker!");
+        }
+
+        ESP_LOGD(TAG, "Start image capturing...");
+
+        if (Lepton_StartCapture(&_LeptonTask_State.Lepton, _LeptonTask_State.RawFrameQueue) != LEPTON_ERR_OK) {
+            ESP_LOGE(TAG, "Can not start image capturing!");
+            esp_event_post(LEPTON_EVENTS, LEPTON_EVENT_CAMERA_ERROR, NULL, 0, 0);
+
+            /* Critical error - cannot continue without capture task */
+            CCIWorker_Stop();
+            _LeptonTask_State.Running = false;
+            _LeptonTask_State.TaskHandle = NULL;
+            esp_task_wdt_delete(NULL);
+            vTaskDelete(NULL);
+            return;
+        }
+
+        Boot_Mark(BOOT_PHASE_CAPTURE);
     }
 
+    portENTER_CRITICAL(&_LeptonTask_CaptureLock);
+    memset(&_LeptonTask_State.Capture, 0, sizeof(App_Lepton_Capture_t));
+    portEXIT_CRITICAL(&_LeptonTask_CaptureLock);
+    _LeptonTask_State.LastFrameTime = esp_timer_get_time();
+    _LeptonTask_State.Misses = 0;
+
+#ifdef CONFIG_LEPTON_DENOISE
+    bool wasReplay = false;
+#endif
+
     _LeptonTask_State.RunTask = true;
     while (_LeptonTask_State.RunTask) {
         EventBits_t EventBits;
+        Bus_Request_t Request;
+        bool isReplay;
+        bool isReceived;
 
         esp_task_wdt_reset();
 
+        /* Forwarding a request only takes the CCI worker lock, the pending requests are handled with every frame */
+        while (Bus_Receive(BUS_CHANNEL_LEPTON_REQUEST, &Request, 0)) {
+            Lepton_HandleRequest(&Request);
+        }
+
+        /* The replay replaces the VoSPI frames, everything behind the queue stays the same */
+        isReplay = false;
+        isReceived = false;
+#ifdef CONFIG_LEPTON_REPLAY
+        isReplay = (_LeptonTask_State.hasCamera == false) || FrameReplay_isActive();
+#endif
+
+#ifdef CONFIG_LEPTON_DENOISE
+        /* The strength is only changed here, so the filter is never changed during a frame */
+        uint8_t Strength = __atomic_load_n(&_LeptonTask_State.DenoiseStrength, __ATOMIC_RELAXED);
+        if (Strength != _LeptonTask_State.Denoise.Strength) {
+            FrameDenoise_SetStrength(&_LeptonTask_State.Denoise, static_cast<FrameDenoise_Strength_t>(Strength));
+        }
+
+        /* The history of one source would blend into the first frames of the other one */
+        if (isReplay != wasReplay) {
+            FrameDenoise_Reset(&_LeptonTask_State.Denoise);
+            wasReplay = isReplay;
+        }
+#endif
+
         /* Wait for a new raw frame with longer timeout to avoid busy waiting */
-        if (xQueueReceive(_LeptonTask_State.RawFrameQueue, &_LeptonTask_State.RawFrame, 500 / portTICK_PERIOD_MS) == pdTRUE) {
-            uint8_t WriteBufferIdx;
-            uint8_t *WriteBuffer;
-            Lepton_Telemetry_t Telemetry;
+        if (isReplay) {
+#ifdef CONFIG_LEPTON_REPLAY
+            isReceived = FrameReplay_Receive(&_LeptonTask_State.RawFrame, 500 / portTICK_PERIOD_MS);
+#endif
+
+            /* The VoSPI capture keeps running, its frames are discarded */
+            xQueueReset(_LeptonTask_State.RawFrameQueue);
+        } else {
+            /* A short timeout, so an interruption of the stream is noticed after a few missing frames */
+            isReceived = (xQueueReceive(_LeptonTask_State.RawFrameQueue, &_LeptonTask_State.RawFrame,
+                                        CONFIG_LEPTON_CAPTURE_TIMEOUT / portTICK_PERIOD_MS) == pdTRUE);
+            if (isReceived) {
+                Lepton_CaptureReceived();
+            }
+        }
+
+        if (isReceived) {
+            FramePool_Frame_t *Frame;
             Lepton_VideoFormat_t VideoFormat;
-            int16_t Min = 0;
-            int16_t Max = 0;
+            bool isRGB888;
+            uint32_t Demand;
+            App_Lepton_FrameReady_t FrameEvent;
+            App_Lepton_FrameReady_t StaleEvent;
+#ifdef CONFIG_LEPTON_FFC
+            bool isFFCFinished = false;
+
+            /* Replayed frames were recorded without the repeats */
+            if (isReplay) {
+                Lepton_ResetFreeze();
+            } else if (Lepton_CheckFreeze(&isFFCFinished)) {
+                continue;
+            }
+#endif
+
+            /* Get a slot that is not referenced by any consumer */
+            Frame = FramePool_Acquire();
+            if (Frame == NULL) {
+                ESP_LOGW(TAG, "No free frame slot, dropping frame!");
+                FrameLatency_Drop(FRAME_LATENCY_PUBLISH);
+                TRACE_INSTANT(TRACE_EVENT_CAPTURE, 0);
+                continue;
+            }
+
+            TRACE_BEGIN(TRACE_EVENT_CAPTURE);
+
+            Frame->Timestamp = esp_timer_get_time();
+            Frame->Time = TimeManager_ToUTC(Frame->Timestamp);
+            Demand = FrameProducts_GetDemand();
+
+#ifdef CONFIG_LEPTON_FFC
+            Frame->Repeats = (_LeptonTask_State.Repeats > UINT16_MAX) ? UINT16_MAX : _LeptonTask_State.Repeats;
+            _LeptonTask_State.Repeats = 0;
+#endif
 
             if (_LeptonTask_State.RawFrame.Telemetry_Buffer != NULL) {
-                memcpy(&Telemetry, _LeptonTask_State.RawFrame.Telemetry_Buffer, sizeof(Lepton_Telemetry_t));
+                memcpy(&Frame->Telemetry, _LeptonTask_State.RawFrame.Telemetry_Buffer, sizeof(Lepton_Telemetry_t));
+                Frame->hasTelemetry = true;
                 ESP_LOGD(TAG, "Telemetry - FrameCounter: %u, FPA_Temp: %uK, Housing_Temp: %uK",
-                         Telemetry.FrameCounter,
-                         Telemetry.FPA_Temp,
-                         Telemetry.Housing_Temp);
+                         Frame->Telemetry.FrameCounter,
+                         Frame->Telemetry.FPA_Temp,
+                         Frame->Telemetry.Housing_Temp);
             }
 
             ESP_LOGD(TAG, "Processing frame...");
 
-            /* Determine which buffer to write to (ping-pong) */
-            if (xSemaphoreTake(_LeptonTask_State.BufferMutex, 100 / portTICK_PERIOD_MS) == pdTRUE) {
-                /* Find a buffer that's not currently being read */
-                WriteBufferIdx = (_LeptonTask_State.CurrentReadBuffer + 1) % 2;
-                WriteBuffer = _LeptonTask_State.RGB_Buffer[WriteBufferIdx];
-                xSemaphoreGive(_LeptonTask_State.BufferMutex);
-            } else {
-                ESP_LOGW(TAG, "Failed to acquire mutex for buffer selection!");
-                continue;
+            /* Process frame based on video format. Replayed frames are always RAW14 */
+            isRGB888 = false;
+            if (isReplay == false) {
+                Lepton_GetVideoFormat(&_LeptonTask_State.Lepton, &VideoFormat);
+                isRGB888 = (VideoFormat == LEPTON_FORMAT_RGB888);
             }
 
-            /* Process frame based on video format */
-            Lepton_GetVideoFormat(&_LeptonTask_State.Lepton, &VideoFormat);
-
-            if (VideoFormat == LEPTON_FORMAT_RGB888) {
+            if (isRGB888) {
                 /* RGB888: Data is already in RGB format, just copy it */
                 size_t ImageSize = _LeptonTask_State.RawFrame.Width * _LeptonTask_State.RawFrame.Height *
                                    _LeptonTask_State.RawFrame.BytesPerPixel;
-                memcpy(WriteBuffer, _LeptonTask_State.RawFrame.Image_Buffer, ImageSize);
+                memcpy(Frame->RGB, _LeptonTask_State.RawFrame.Image_Buffer, ImageSize);
+                Frame->hasRGB = true;
                 ESP_LOGD(TAG, "Copied RGB888 frame: %ux%u (%u bytes)", _LeptonTask_State.RawFrame.Width,
                          _LeptonTask_State.RawFrame.Height, static_cast<unsigned int>(ImageSize));
             } else {
-                /* RAW14: Convert to RGB */
-                Lepton_Raw14ToRGB(&_LeptonTask_State.Lepton, _LeptonTask_State.RawFrame.Image_Buffer, WriteBuffer, &Min, &Max,
-                                  _LeptonTask_State.RawFrame.Width,
-                                  _LeptonTask_State.RawFrame.Height);
+                /* RAW14: Keep the raw data for the consumers */
+                memcpy(Frame->RAW, _LeptonTask_State.RawFrame.Image_Buffer,
+                       _LeptonTask_State.RawFrame.Width * _LeptonTask_State.RawFrame.Height * sizeof(uint16_t));
+                Frame->hasRAW = true;
+
+#ifdef CONFIG_LEPTON_DENOISE
+                /* Every consumer, the statistics and the colorized image get the filtered frame */
+                FrameDenoise_Apply(&_LeptonTask_State.Denoise, Frame->RAW);
+#endif
+
+                /* Only the products a subscriber needs with every frame are computed here. Everything else is
+                   computed on request by the first consumer that needs it */
+                FrameProducts_Prepare(Frame, Demand);
             }
 
-            /* Mark buffer as ready and update read buffer index */
-            if (xSemaphoreTake(_LeptonTask_State.BufferMutex, 100 / portTICK_PERIOD_MS) == pdTRUE) {
-                _LeptonTask_State.CurrentReadBuffer = WriteBufferIdx;
-                xSemaphoreGive(_LeptonTask_State.BufferMutex);
-            } else {
-                ESP_LOGW(TAG, "Failed to acquire mutex for buffer ready!");
-                continue;
-            }
-
-            /* Send frame notification to network task */
-            App_Lepton_FrameReady_t FrameEvent = {
-                .Buffer = WriteBuffer,
-                .Width = _LeptonTask_State.RawFrame.Width,
-                .Height = _LeptonTask_State.RawFrame.Height,
-                .Channels = 3,
-                .Min = Min,
-                .Max = Max
-            };
-
-            /* Use xQueueOverwrite to always have the latest frame */
-            xQueueOverwrite(App_Context->Lepton_FrameEventQueue, &FrameEvent);
-            ESP_LOGD(TAG, "Frame sent to queue successfully");
-        } else {
-            /* Timeout waiting for frame */
-            ESP_LOGW(TAG, "No raw frame received from VoSPI");
-        }
-
-        EventBits = xEventGroupGetBits(_LeptonTask_State.EventGroup);
-        if (EventBits & LEPTON_TASK_UPDATE_ROI_REQUEST) {
-            Lepton_ROI_t ROI;
-            Lepton_Error_t Error;
-
-            ROI.Start_Col = _LeptonTask_State.ROI.x;
-            ROI.Start_Row = _LeptonTask_State.ROI.y;
-            ROI.End_Col = _LeptonTask_State.ROI.x + _LeptonTask_State.ROI.w - 1;
-            ROI.End_Row = _LeptonTask_State.ROI.y + _LeptonTask_State.ROI.h - 1;
-
-            switch (_LeptonTask_State.ROI.Type) {
-                case ROI_TYPE_SPOTMETER: {
-                    Error = Lepton_SetSpotmeterROI(&_LeptonTask_State.Lepton, &ROI);
-                    break;
-                }
-                case ROI_TYPE_SCENE: {
-                    Error = Lepton_SetSceneROI(&_LeptonTask_State.Lepton, &ROI);
-                    break;
-                }
-                case ROI_TYPE_AGC: {
-                    Error = Lepton_SetAGCROI(&_LeptonTask_State.Lepton, &ROI);
-                    break;
-                }
-                case ROI_TYPE_VIDEO_FOCUS: {
-                    Error = Lepton_SetVideoFocusROI(&_LeptonTask_State.Lepton, &ROI);
-                    break;
-                }
-                default: {
-                    ESP_LOGW(TAG, "Invalid ROI type in GUI event: %d", _LeptonTask_State.ROI.Type);
-                    return;
-                }
-            }
+            /* Make the frame the latest one. The slot is read-only from now on */
+            FramePool_Publish(Frame);
+            FrameLatency_Mark(FRAME_LATENCY_PUBLISH, Frame->Sequence, Frame->Timestamp);
+            TRACE_END(TRACE_EVENT_CAPTURE);
 
-            if (Error == LEPTON_ERR_OK) {
-                ESP_LOGD(TAG, "New Lepton ROI (Type %d) - Start_Col: %u, Start_Row: %u, End_Col: %u, End_Row: %u",
-                         _LeptonTask_State.ROI.Type,
-                         ROI.Start_Col,
-                         ROI.Start_Row,
-                         ROI.End_Col,
-                         ROI.End_Row);
-            } else {
-                ESP_LOGE(TAG, "Failed to update Lepton ROI with type %d!", _LeptonTask_State.ROI.Type);
+#ifdef CONFIG_LEPTON_FFC
+            if (isFFCFinished) {
+                Lepton_FinishFreeze(Frame);
             }
+#endif
 
-            xEventGroupClearBits(_LeptonTask_State.EventGroup, LEPTON_TASK_UPDATE_ROI_REQUEST);
-        } else if (EventBits & LEPTON_TASK_UPDATE_TEMP_REQUEST) {
-            uint16_t FPA_Temp;
-            uint16_t AUX_Temp;
-            App_Lepton_Temperatures_t Temperatures;
-
-            Lepton_GetTemperature(&_LeptonTask_State.Lepton, &FPA_Temp, &AUX_Temp);
-
-            Temperatures.FPA = (static_cast<float>(FPA_Temp) * 0.01f) - 273.0f;
-            Temperatures.AUX = (static_cast<float>(AUX_Temp) * 0.01f) - 273.0f;
-
-            esp_event_post(LEPTON_EVENTS, LEPTON_EVENT_RESPONSE_FPA_AUX_TEMP, &Temperatures, sizeof(App_Lepton_Temperatures_t), 0);
+            /* The tracker reads the published frame, its statistics are shared with the other consumers */
+#ifdef CONFIG_LEPTON_SPOTS
+            Lepton_TrackSpots(Frame);
+#endif
 
-            xEventGroupClearBits(_LeptonTask_State.EventGroup, LEPTON_TASK_UPDATE_TEMP_REQUEST);
-        } else if (EventBits & LEPTON_TASK_UPDATE_UPTIME_REQUEST) {
-            uint32_t Uptime;
+            /* A running VISA burst copies every frame, independent of the consumers below */
+            FrameRecorder_Push(Frame);
 
-            Uptime = Lepton_GetUptime(&_LeptonTask_State.Lepton);
+            /* The SD recording is fed from the same point, the card is written by its own task */
+            SDRecorder_Push(Frame);
 
-            esp_event_post(LEPTON_EVENTS, LEPTON_EVENT_RESPONSE_UPTIME, &Uptime, sizeof(uint32_t), 0);
-
-            xEventGroupClearBits(_LeptonTask_State.EventGroup, LEPTON_TASK_UPDATE_UPTIME_REQUEST);
-        } else if (EventBits & LEPTON_TASK_STOP_REQUEST) {
-            ESP_LOGI(TAG, "Stop request received");
-
-            xEventGroupClearBits(_LeptonTask_State.EventGroup, LEPTON_TASK_STOP_REQUEST);
-
-            break;
-        } else if (EventBits & LEPTON_TASK_UPDATE_PIXEL_TEMPERATURE) {
-            int16_t x;
-            int16_t y;
-            float Temperature;
-            Lepton_VideoFormat_t VideoFormat;
-
-            Lepton_GetVideoFormat(&_LeptonTask_State.Lepton, &VideoFormat);
-            if (((_LeptonTask_State.RawFrame.Width == 0) || (_LeptonTask_State.RawFrame.Height == 0)) &&
-                (VideoFormat != LEPTON_FORMAT_RAW14)) {
-                ESP_LOGW(TAG, "Invalid Lepton frame! Cannot get pixel temperature!");
-                xEventGroupClearBits(_LeptonTask_State.EventGroup, LEPTON_TASK_UPDATE_PIXEL_TEMPERATURE);
-                continue;
+            if (Server_isRunning()) {
+                Lepton_UpdateNetworkFrame(Frame);
             }
 
-            /* Convert the screen position to the Lepton frame coordinates */
-            x = (_LeptonTask_State.ScreenPosition.x * _LeptonTask_State.RawFrame.Width) / _LeptonTask_State.ScreenPosition.Width;
-            y = (_LeptonTask_State.ScreenPosition.y * _LeptonTask_State.RawFrame.Height) / _LeptonTask_State.ScreenPosition.Height;
-
-            ESP_LOGD(TAG, "Crosshair center in Lepton Frame: (%d,%d), size (%d,%d)", x, y, _LeptonTask_State.RawFrame.Width,
-                     _LeptonTask_State.RawFrame.Height);
-
-            if (_LeptonTask_State.RawFrame.Image_Buffer != NULL) {
-                if (Lepton_GetPixelTemperature(&_LeptonTask_State.Lepton,
-                                               _LeptonTask_State.RawFrame.Image_Buffer[(y * _LeptonTask_State.RawFrame.Width) + x],
-                                               &Temperature) == LEPTON_ERR_OK) {
-                    esp_event_post(LEPTON_EVENTS, LEPTON_EVENT_RESPONSE_PIXEL_TEMPERATURE, &Temperature, sizeof(float), 0);
-                } else {
-                    ESP_LOGW(TAG, "Failed to get pixel temperature!");
+            /* Send frame notification to the GUI task when it shows the image. The event carries its own
+               reference */
+            if (FrameProducts_isSubscribed(FRAME_CONSUMER_DISPLAY)) {
+                FrameEvent.Frame = FramePool_Retain(Frame);
+                FrameEvent.Buffer = Frame->RGB;
+                FrameEvent.Width = Frame->Width;
+                FrameEvent.Height = Frame->Height;
+                FrameEvent.Channels = 3;
+                FrameEvent.Min = Frame->Min;
+                FrameEvent.Max = Frame->Max;
+
+                /* Drop a frame that was not consumed yet and release its reference before queuing the new one */
+                if (xQueueReceive(App_Context->Lepton_FrameEventQueue, &StaleEvent, 0) == pdTRUE) {
+                    FramePool_Release(StaleEvent.Frame);
                 }
-            } else {
-                ESP_LOGW(TAG, "Image buffer is NULL, cannot get pixel temperature");
-            }
-
-            xEventGroupClearBits(_LeptonTask_State.EventGroup, LEPTON_TASK_UPDATE_PIXEL_TEMPERATURE);
-        } else if (EventBits & LEPTON_TASK_UPDATE_SPOTMETER) {
-            Lepton_Spotmeter_t Spotmeter;
-
-            ESP_LOGD(TAG, "Getting spotmeter - I2C Bus: %p, I2C Dev: %p",
-                     _LeptonTask_State.Lepton.Internal.CCI.I2C_Bus_Handle,
-                     _LeptonTask_State.Lepton.Internal.CCI.I2C_Dev_Handle);
-
-            if (Lepton_GetSpotmeter(&_LeptonTask_State.Lepton, &Spotmeter) == LEPTON_ERR_OK) {
-                App_Lepton_ROI_Result_t App_Lepton_Spotmeter;
-
-                ESP_LOGD(TAG, "Spotmeter: Spot=%uK, Min=%uK, Max=%uK",
-                         Spotmeter.Value,
-                         Spotmeter.Min,
-                         Spotmeter.Max);
 
-                App_Lepton_Spotmeter.Min = Spotmeter.Min - 273.0f;
-                App_Lepton_Spotmeter.Max = Spotmeter.Max - 273.0f;
-                App_Lepton_Spotmeter.Average = Spotmeter.Value - 273.0f;
-
-                esp_event_post(LEPTON_EVENTS, LEPTON_EVENT_RESPONSE_SPOTMETER, &App_Lepton_Spotmeter, sizeof(App_Lepton_ROI_Result_t),
-                               0);
-            } else {
-                ESP_LOGW(TAG, "Failed to read spotmeter!");
+                /* Use xQueueOverwrite to always have the latest frame */
+                xQueueOverwrite(App_Context->Lepton_FrameEventQueue, &FrameEvent);
+                ESP_LOGD(TAG, "Frame sent to queue successfully");
             }
 
-            xEventGroupClearBits(_LeptonTask_State.EventGroup, LEPTON_TASK_UPDATE_SPOTMETER);
-        } else if (EventBits & LEPTON_TASK_UPDATE_SCENE_STATISTICS) {
-            Lepton_SceneStatistics_t SceneStats;
-
-            if (Lepton_GetSceneStatistics(&_LeptonTask_State.Lepton, &SceneStats) == LEPTON_ERR_OK) {
-                App_Lepton_ROI_Result_t App_Lepton_Scene;
-
-                App_Lepton_Scene.Min = SceneStats.MinIntensity;
-                App_Lepton_Scene.Max = SceneStats.MaxIntensity;
-                App_Lepton_Scene.Average = SceneStats.MeanIntensity;
-
-                ESP_LOGD(TAG, "Scene Statistics: Min=%.2f°C, Max=%.2f°C, Average=%.2f°C",
-                         App_Lepton_Scene.Min, App_Lepton_Scene.Max, App_Lepton_Scene.Average);
-
-                esp_event_post(LEPTON_EVENTS, LEPTON_EVENT_RESPONSE_SCENE_STATISTICS, &App_Lepton_Scene,
-                               sizeof(App_Lepton_ROI_Result_t), 0);
-            } else {
-                ESP_LOGW(TAG, "Failed to read scene statistics!");
-            }
+            Boot_Mark(BOOT_PHASE_FIRST_FRAME);
+        } else if (isReplay == false) {
+            Lepton_CaptureTimeout();
+        }
 
-            xEventGroupClearBits(_LeptonTask_State.EventGroup, LEPTON_TASK_UPDATE_SCENE_STATISTICS);
-        } else if (EventBits & LEPTON_TASK_UPDATE_EMISSIVITY) {
-            Lepton_Error_t Error;
+        EventBits = xEventGroupGetBits(_LeptonTask_State.EventGroup);
+        if (EventBits & LEPTON_TASK_STOP_REQUEST) {
+            ESP_LOGI(TAG, "Stop request received");
 
-            Error = Lepton_SetEmissivity(&_LeptonTask_State.Lepton, static_cast<Lepton_Emissivity_t>(_LeptonTask_State.Emissivity));
-            if (Error == LEPTON_ERR_OK) {
-                ESP_LOGD(TAG, "Updated emissivity to %u", _LeptonTask_State.Emissivity);
-            } else {
-                ESP_LOGE(TAG, "Failed to update emissivity to %u!", _LeptonTask_State.Emissivity);
-            }
+            xEventGroupClearBits(_LeptonTask_State.EventGroup, LEPTON_TASK_STOP_REQUEST);
 
-            xEventGroupClearBits(_LeptonTask_State.EventGroup, LEPTON_TASK_UPDATE_EMISSIVITY);
+            break;
         }
     }
 
     ESP_LOGD(TAG, "Lepton task shutting down");
-    Lepton_Deinit(&_LeptonTask_State.Lepton);
+    CCIWorker_Stop();
+    Lepton_DeinitCamera();
 
     _LeptonTask_State.Running = false;
     _LeptonTask_State.TaskHandle = NULL;
@@ -454,7 +841,6 @@ esp_err_t Lepton_Task_Init(void)
     }
 
     ESP_LOGD(TAG, "Initializing Lepton Task");
-    _LeptonTask_State.CurrentReadBuffer = 0;
 
     Lepton_Error = LEPTON_ERR_OK;
 
@@ -465,75 +851,151 @@ esp_err_t Lepton_Task_Init(void)
         return ESP_ERR_NO_MEM;
     }
 
-    /* Create mutex for buffer synchronization */
-    _LeptonTask_State.BufferMutex = xSemaphoreCreateMutex();
-    if (_LeptonTask_State.BufferMutex == NULL) {
-        ESP_LOGE(TAG, "Failed to create buffer mutex!");
-        vEventGroupDelete(_LeptonTask_State.EventGroup);
-        return ESP_ERR_NO_MEM;
-    }
-
     /* Initialize Lepton configuration and I2C BEFORE allocating large buffers */
     _LeptonTask_State.LeptonConf = LEPTON_DEFAULT_CONF;
-    LEPTON_ASSIGN_FUNC(_LeptonTask_State.LeptonConf, NULL, NULL, I2CM_Write, I2CM_Read);
+    LEPTON_ASSIGN_FUNC(_LeptonTask_State.LeptonConf, NULL, NULL, Lepton_CCI_Write, Lepton_CCI_Read);
     LEPTON_ASSIGN_I2C_HANDLE(_LeptonTask_State.LeptonConf, DevicesManager_GetI2CBusHandle());
 
+    /* The camera was powered by the Devices Manager. Only the remaining part of its boot time is waited for,
+       the other boot steps run in the meantime */
+    DevicesManager_WaitForCamera();
+
     /* Initialize Lepton (this creates I2C device handle) before framebuffer allocation */
     Lepton_Error = Lepton_Init(&_LeptonTask_State.Lepton, &_LeptonTask_State.LeptonConf);
     if (Lepton_Error != LEPTON_ERR_OK) {
         ESP_LOGE(TAG, "Lepton initialization failed with error: %d!", Lepton_Error);
 
-        vSemaphoreDelete(_LeptonTask_State.BufferMutex);
+#ifdef CONFIG_LEPTON_REPLAY
+        ESP_LOGW(TAG, "No camera, the replay is the only frame source");
+#else
         vEventGroupDelete(_LeptonTask_State.EventGroup);
 
         return ESP_FAIL;
+#endif
+    } else {
+        _LeptonTask_State.hasCamera = true;
     }
 
-    /* Allocate RGB buffers - both RAW14 and RGB888 use 160x120 resolution
-     * RAW14: 160x120x3 = 57,600 bytes (after conversion to RGB)
-     * RGB888: 160x120x3 = 57,600 bytes (native RGB data)
+    /* Allocate the frame pool - both RAW14 and RGB888 use 160x120 resolution
+     * RAW14: 160x120x2 = 38,400 bytes (raw data for the consumers)
+     * RGB888: 160x120x3 = 57,600 bytes (converted or native RGB data)
      */
-    size_t RGB_Buffer_Size = 160 * 120 * 3;
+    if (FramePool_Init(CONFIG_LEPTON_FRAME_POOL_SLOTS, 160, 120) != ESP_OK) {
+        ESP_LOGE(TAG, "Can not allocate frame pool!");
 
-    _LeptonTask_State.RGB_Buffer[0] = reinterpret_cast<uint8_t *>(heap_caps_malloc(RGB_Buffer_Size, MALLOC_CAP_SPIRAM));
-    _LeptonTask_State.RGB_Buffer[1] = reinterpret_cast<uint8_t *>(heap_caps_malloc(RGB_Buffer_Size, MALLOC_CAP_SPIRAM));
+        Lepton_DeinitCamera();
+        vEventGroupDelete(_LeptonTask_State.EventGroup);
 
-    if ((_LeptonTask_State.RGB_Buffer[0] == NULL) || (_LeptonTask_State.RGB_Buffer[1] == NULL)) {
-        ESP_LOGE(TAG, "Can not allocate RGB buffers!");
+        return ESP_ERR_NO_MEM;
+    }
 
-        if (_LeptonTask_State.RGB_Buffer[0]) {
-            heap_caps_free(_LeptonTask_State.RGB_Buffer[0]);
-        }
+    /* The sequence numbers of the new pool start again */
+    FrameLatency_Reset();
 
-        if (_LeptonTask_State.RGB_Buffer[1]) {
-            heap_caps_free(_LeptonTask_State.RGB_Buffer[1]);
-        }
+    if (FrameProducts_Init(Lepton_Colorize) != ESP_OK) {
+        ESP_LOGE(TAG, "Can not initialize frame products!");
 
-        Lepton_Deinit(&_LeptonTask_State.Lepton);
-        vSemaphoreDelete(_LeptonTask_State.BufferMutex);
+        FramePool_Deinit();
+        Lepton_DeinitCamera();
         vEventGroupDelete(_LeptonTask_State.EventGroup);
 
         return ESP_ERR_NO_MEM;
     }
 
-    ESP_LOGD(TAG, "RGB buffers allocated: 2 x %u bytes", static_cast<unsigned int>(RGB_Buffer_Size));
+    if (ROIEngine_Init(160, 120) != ESP_OK) {
+        ESP_LOGE(TAG, "Can not initialize ROI engine!");
+
+        FrameProducts_Deinit();
+        FramePool_Deinit();
+        Lepton_DeinitCamera();
+        vEventGroupDelete(_LeptonTask_State.EventGroup);
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* The burst recorder is optional, the camera keeps working without it */
+    if (FrameRecorder_Init(CONFIG_LEPTON_BURST_FRAMES, 160, 120) != ESP_OK) {
+        ESP_LOGW(TAG, "Can not allocate burst recorder, bursts are disabled!");
+    }
+
+    /* Without the history the frames pass unfiltered */
+#ifdef CONFIG_LEPTON_DENOISE
+    _LeptonTask_State.DenoiseStrength = CONFIG_LEPTON_DENOISE_STRENGTH;
+    if (FrameDenoise_Init(&_LeptonTask_State.Denoise, 160, 120,
+                          static_cast<FrameDenoise_Strength_t>(CONFIG_LEPTON_DENOISE_STRENGTH)) != ESP_OK) {
+        ESP_LOGW(TAG, "Can not allocate denoise history, the noise reduction is disabled!");
+    }
+#endif
+
+    /* Without the tracker the camera works without spot alarms */
+#ifdef CONFIG_LEPTON_SPOTS
+    Lepton_InitSpots();
+#endif
+
+#ifdef CONFIG_LEPTON_FFC
+    memset(&_LeptonTask_State.FFC, 0, sizeof(App_Lepton_FFC_t));
+    _LeptonTask_State.Repeats = 0;
+    FrameFreeze_Init(&_LeptonTask_State.Freeze, CONFIG_LEPTON_FFC_CONFIRM);
+#endif
 
     /* Create internal queue to receive raw frames from VoSPI capture task */
     _LeptonTask_State.RawFrameQueue = xQueueCreate(1, sizeof(Lepton_FrameBuffer_t));
     if (_LeptonTask_State.RawFrameQueue == NULL) {
         ESP_LOGE(TAG, "Failed to create raw frame queue!");
 
-        heap_caps_free(_LeptonTask_State.RGB_Buffer[0]);
-        heap_caps_free(_LeptonTask_State.RGB_Buffer[1]);
-        Lepton_Deinit(&_LeptonTask_State.Lepton);
-        vSemaphoreDelete(_LeptonTask_State.BufferMutex);
+        FrameRecorder_Deinit();
+        ROIEngine_Deinit();
+        FrameProducts_Deinit();
+        FramePool_Deinit();
+        Lepton_DeinitCamera();
         vEventGroupDelete(_LeptonTask_State.EventGroup);
 
         return ESP_ERR_NO_MEM;
     }
 
-    /* Use the event loop to receive control signals from other tasks */
-    esp_event_handler_register(GUI_EVENTS, ESP_EVENT_ANY_ID, on_GUI_Event_Handler, NULL);
+    _LeptonTask_State.NetworkFrame.mutex = xSemaphoreCreateMutex();
+    if (_LeptonTask_State.NetworkFrame.mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create network frame mutex!");
+
+        vQueueDelete(_LeptonTask_State.RawFrameQueue);
+        _LeptonTask_State.RawFrameQueue = NULL;
+        FrameRecorder_Deinit();
+        ROIEngine_Deinit();
+        FrameProducts_Deinit();
+        FramePool_Deinit();
+        Lepton_DeinitCamera();
+        vEventGroupDelete(_LeptonTask_State.EventGroup);
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* CCI commands are executed by a worker task, so the frame loop never blocks on the I2C bus */
+    if (CCIWorker_Init(&_LeptonTask_State.Lepton) != ESP_OK) {
+        ESP_LOGE(TAG, "Can not initialize CCI worker!");
+
+        vSemaphoreDelete(_LeptonTask_State.NetworkFrame.mutex);
+        _LeptonTask_State.NetworkFrame.mutex = NULL;
+        vQueueDelete(_LeptonTask_State.RawFrameQueue);
+        _LeptonTask_State.RawFrameQueue = NULL;
+        FrameRecorder_Deinit();
+        ROIEngine_Deinit();
+        FrameProducts_Deinit();
+        FramePool_Deinit();
+        Lepton_DeinitCamera();
+        vEventGroupDelete(_LeptonTask_State.EventGroup);
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* The replay is optional as well */
+#ifdef CONFIG_LEPTON_REPLAY
+    if (FrameReplay_Init(160, 120) != ESP_OK) {
+        ESP_LOGW(TAG, "Can not allocate replay buffers, the replay is disabled!");
+    }
+#endif
+
+    /* The requests of the GUI are read from the bus, the network state still comes from the event loop */
+    esp_event_handler_register(NETWORK_EVENTS, ESP_EVENT_ANY_ID, on_Network_Event_Handler, NULL);
 
     ESP_LOGD(TAG, "Lepton Task initialized");
 
@@ -559,24 +1021,38 @@ void Lepton_Task_Deinit(void)
         _LeptonTask_State.EventGroup = NULL;
     }
 
-    esp_event_handler_unregister(GUI_EVENTS, ESP_EVENT_ANY_ID, on_GUI_Event_Handler);
+    esp_event_handler_unregister(NETWORK_EVENTS, ESP_EVENT_ANY_ID, on_Network_Event_Handler);
 
-    Lepton_Deinit(&_LeptonTask_State.Lepton);
+    CCIWorker_Deinit();
+    Lepton_DeinitCamera();
 
-    if (_LeptonTask_State.BufferMutex != NULL) {
-        vSemaphoreDelete(_LeptonTask_State.BufferMutex);
-        _LeptonTask_State.BufferMutex = NULL;
-    }
+    /* Drop the reference of the network frame before the pool is freed */
+    if (_LeptonTask_State.NetworkFrame.mutex != NULL) {
+        xSemaphoreTake(_LeptonTask_State.NetworkFrame.mutex, portMAX_DELAY);
+        FramePool_Release(_LeptonTask_State.NetworkFrame.frame);
+        _LeptonTask_State.NetworkFrame.frame = NULL;
+        _LeptonTask_State.NetworkFrame.buffer = NULL;
+        _LeptonTask_State.NetworkFrame.raw = NULL;
+        xSemaphoreGive(_LeptonTask_State.NetworkFrame.mutex);
 
-    if (_LeptonTask_State.RGB_Buffer[0] != NULL) {
-        heap_caps_free(_LeptonTask_State.RGB_Buffer[0]);
-        _LeptonTask_State.RGB_Buffer[0] = NULL;
+        vSemaphoreDelete(_LeptonTask_State.NetworkFrame.mutex);
+        _LeptonTask_State.NetworkFrame.mutex = NULL;
     }
 
-    if (_LeptonTask_State.RGB_Buffer[1] != NULL) {
-        heap_caps_free(_LeptonTask_State.RGB_Buffer[1]);
-        _LeptonTask_State.RGB_Buffer[1] = NULL;
-    }
+#ifdef CONFIG_LEPTON_REPLAY
+    FrameReplay_Deinit();
+#endif
+#ifdef CONFIG_LEPTON_DENOISE
+    FrameDenoise_Deinit(&_LeptonTask_State.Denoise);
+#endif
+#ifdef CONFIG_LEPTON_SPOTS
+    FrameProducts_Subscribe(FRAME_CONSUMER_SPOTS, 0);
+    SpotTracker_Deinit(&_LeptonTask_State.Spots);
+#endif
+    FrameRecorder_Deinit();
+    ROIEngine_Deinit();
+    FrameProducts_Deinit();
+    FramePool_Deinit();
 
     if (_LeptonTask_State.RawFrameQueue != NULL) {
         vQueueDelete(_LeptonTask_State.RawFrameQueue);
@@ -588,7 +1064,7 @@ void Lepton_Task_Deinit(void)
 
 esp_err_t Lepton_Task_Start(App_Context_t *p_AppContext)
 {
-    BaseType_t Ret;
+    esp_err_t Error;
 
     if (p_AppContext == NULL) {
         return ESP_ERR_INVALID_ARG;
@@ -600,19 +1076,10 @@ esp_err_t Lepton_Task_Start(App_Context_t *p_AppContext)
     }
 
     ESP_LOGD(TAG, "Starting Lepton Task");
-    Ret = xTaskCreatePinnedToCore(
-              Task_Lepton,
-              "Task_Lepton",
-              CONFIG_LEPTON_TASK_STACKSIZE,
-              p_AppContext,
-              CONFIG_LEPTON_TASK_PRIO,
-              &_LeptonTask_State.TaskHandle,
-              CONFIG_LEPTON_TASK_CORE
-          );
-
-    if (Ret != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create Lepton Task: %d!", Ret);
-        return ESP_ERR_NO_MEM;
+    Error = Topology_CreateTask(TOPOLOGY_TASK_LEPTON, Task_Lepton, p_AppContext, &_LeptonTask_State.TaskHandle);
+    if (Error != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create Lepton Task: %d!", Error);
+        return Error;
     }
 
     _LeptonTask_State.Running = true;
@@ -645,4 +1112,129 @@ esp_err_t Lepton_Task_Stop(void)
 bool Lepton_Task_isRunning(void)
 {
     return _LeptonTask_State.Running;
-}
\ No newline at end of file
+}
+
+esp_err_t Lepton_Task_GetFluxParameters(Lepton_FluxLinearParams_t *p_Params)
+{
+    return CCIWorker_GetFluxParameters(p_Params);
+}
+
+#ifdef CONFIG_LEPTON_DENOISE
+esp_err_t Lepton_Task_SetDenoise(uint8_t Strength)
+{
+    if (Strength >= FRAME_DENOISE_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    __atomic_store_n(&_LeptonTask_State.DenoiseStrength, Strength, __ATOMIC_RELAXED);
+
+    return ESP_OK;
+}
+
+uint8_t Lepton_Task_GetDenoise(void)
+{
+    return __atomic_load_n(&_LeptonTask_State.DenoiseStrength, __ATOMIC_RELAXED);
+}
+#endif
+
+#ifdef CONFIG_LEPTON_SPOTS
+esp_err_t Lepton_Task_SetSpotThreshold(SpotTracker_Kind_t Kind, uint16_t Threshold)
+{
+    if (Kind >= SPOT_TRACKER_KIND_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    __atomic_store_n(&_LeptonTask_State.SpotThreshold[Kind], Threshold, __ATOMIC_RELAXED);
+    Lepton_SubscribeSpots();
+
+    return ESP_OK;
+}
+
+uint16_t Lepton_Task_GetSpotThreshold(SpotTracker_Kind_t Kind)
+{
+    if (Kind >= SPOT_TRACKER_KIND_COUNT) {
+        return 0;
+    }
+
+    return __atomic_load_n(&_LeptonTask_State.SpotThreshold[Kind], __ATOMIC_RELAXED);
+}
+
+esp_err_t Lepton_Task_GetSpots(SpotTracker_Result_t *p_Result)
+{
+    if (p_Result == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (_LeptonTask_State.Spots.Runs == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    portENTER_CRITICAL(&_LeptonTask_SpotLock);
+    memcpy(p_Result, &_LeptonTask_State.SpotResult, sizeof(SpotTracker_Result_t));
+    portEXIT_CRITICAL(&_LeptonTask_SpotLock);
+
+    return ESP_OK;
+}
+#endif
+
+esp_err_t Lepton_Task_GetCapture(App_Lepton_Capture_t *p_Capture)
+{
+    if (p_Capture == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&_LeptonTask_CaptureLock);
+    memcpy(p_Capture, &_LeptonTask_State.Capture, sizeof(App_Lepton_Capture_t));
+    portEXIT_CRITICAL(&_LeptonTask_CaptureLock);
+
+    return ESP_OK;
+}
+
+#ifdef CONFIG_LEPTON_FFC
+esp_err_t Lepton_Task_GetFFC(App_Lepton_FFC_t *p_FFC)
+{
+    if (p_FFC == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&_LeptonTask_FFCLock);
+    memcpy(p_FFC, &_LeptonTask_State.FFC, sizeof(App_Lepton_FFC_t));
+    portEXIT_CRITICAL(&_LeptonTask_FFCLock);
+
+    return ESP_OK;
+}
+#endif
+
+#ifdef BENCHMARK
+esp_err_t Lepton_Task_Colorize(const uint16_t *p_RAW, uint8_t *p_RGB, uint16_t Width, uint16_t Height)
+{
+    int16_t Min;
+    int16_t Max;
+
+    if ((p_RAW == NULL) || (p_RGB == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* The driver does not write the input, it only takes it in the buffer type of the VoSPI frames */
+    Lepton_Raw14ToRGB(&_LeptonTask_State.Lepton,
+                      reinterpret_cast<decltype(_LeptonTask_State.RawFrame.Image_Buffer)>(
+                          const_cast<uint16_t *>(p_RAW)),
+                      p_RGB, &Min, &Max, Width, Height);
+
+    return ESP_OK;
+}
+
+esp_err_t Lepton_Task_ReadTemperature(uint16_t *p_FPA, uint16_t *p_AUX)
+{
+    /* The CCI worker owns the bus while the task is running */
+    if (_LeptonTask_State.Running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (Lepton_GetTemperature(&_LeptonTask_State.Lepton, p_FPA, p_AUX) != LEPTON_ERR_OK) {
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+#endif
@@ -31,6 +31,7 @@
 
 #include "Application/application.h"
 #include "Application/Manager/Devices/devices.h"
+#include "Application/Tasks/Lepton/spotTracker.h"
 
 /** @brief  Initialize the Lepton task.
  *  @return ESP_OK on success, error code otherwise
@@ -57,4 +58,91 @@ esp_err_t Lepton_Task_Stop(void);
  */
 bool Lepton_Task_isRunning(void);
 
+/** @brief          Get the radiometric (flux linear) parameters the camera is using. The cached copy of the CCI
+ *                  worker is returned, so the call never waits for the I2C bus.
+ *  @param p_Params Pointer to store the parameters
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if p_Params is NULL
+ *                  ESP_ERR_INVALID_STATE if the camera is not running or the parameters were not read yet
+ */
+esp_err_t Lepton_Task_GetFluxParameters(Lepton_FluxLinearParams_t *p_Params);
+
+#ifdef CONFIG_LEPTON_DENOISE
+/** @brief          Set the strength of the temporal noise reduction. The Lepton task uses it from the next frame on.
+ *  @param Strength 0 = off, 1 = low, 2 = medium, 3 = high
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if the strength is invalid
+ */
+esp_err_t Lepton_Task_SetDenoise(uint8_t Strength);
+
+/** @brief  Get the strength of the temporal noise reduction.
+ *  @return 0 = off, 1 = low, 2 = medium, 3 = high
+ */
+uint8_t Lepton_Task_GetDenoise(void);
+#endif
+
+#ifdef CONFIG_LEPTON_SPOTS
+/** @brief              Set the threshold of the hot or the cold spot alarm. The Lepton task uses it from the next
+ *                      frame on.
+ *  @param Kind         SPOT_TRACKER_HOT or SPOT_TRACKER_COLD
+ *  @param Threshold    Threshold in centi-Kelvin, 0 disables the alarm
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if the kind is invalid
+ */
+esp_err_t Lepton_Task_SetSpotThreshold(SpotTracker_Kind_t Kind, uint16_t Threshold);
+
+/** @brief      Get the threshold of the hot or the cold spot alarm.
+ *  @param Kind SPOT_TRACKER_HOT or SPOT_TRACKER_COLD
+ *  @return     Threshold in centi-Kelvin, 0 if the alarm is disabled
+ */
+uint16_t Lepton_Task_GetSpotThreshold(SpotTracker_Kind_t Kind);
+
+/** @brief          Get a copy of the spots and the alarm state of the latest frame.
+ *  @param p_Result Pointer to store the result
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if p_Result is NULL
+ *                  ESP_ERR_INVALID_STATE if the tracker is not running
+ */
+esp_err_t Lepton_Task_GetSpots(SpotTracker_Result_t *p_Result);
+#endif
+
+/** @brief              Get the health of the VoSPI stream since the start of the task.
+ *  @param p_Capture    Pointer to store the counters
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if p_Capture is NULL
+ */
+esp_err_t Lepton_Task_GetCapture(App_Lepton_Capture_t *p_Capture);
+
+#ifdef CONFIG_LEPTON_FFC
+/** @brief          Get the state of the latest flat field correction.
+ *  @param p_FFC    Pointer to store the state, all zero before the first correction
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if p_FFC is NULL
+ */
+esp_err_t Lepton_Task_GetFFC(App_Lepton_FFC_t *p_FFC);
+#endif
+
+#ifdef BENCHMARK
+/** @brief          Colorize a RAW14 frame with the Lepton driver (Lepton_Raw14ToRGB). Only for the benchmark
+ *                  firmware.
+ *  @param p_RAW    RAW14 frame
+ *  @param p_RGB    RGB888 output (Width * Height * 3 bytes)
+ *  @param Width    Frame width in pixels
+ *  @param Height   Frame height in pixels
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if a buffer is NULL
+ */
+esp_err_t Lepton_Task_Colorize(const uint16_t *p_RAW, uint8_t *p_RGB, uint16_t Width, uint16_t Height);
+
+/** @brief          Read the FPA and AUX temperature over the CCI without the CCI worker. Only for the benchmark
+ *                  firmware, before the Lepton task is started.
+ *  @param p_FPA    Pointer to store the FPA temperature in centi-Kelvin
+ *  @param p_AUX    Pointer to store the AUX temperature in centi-Kelvin
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_STATE if the Lepton task is running
+ *                  ESP_FAIL if the CCI transfer failed
+ */
+esp_err_t Lepton_Task_ReadTemperature(uint16_t *p_FPA, uint16_t *p_AUX);
+#endif
+
 #endif /* LEPTON_TASK_H_ */
\ No newline at end of file
@@ -0,0 +1,257 @@
+/*
+ * paletteLUT.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: RAW14 to RGB565 palette lookup table.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+
+#include <string.h>
+
+#include "paletteLUT.h"
+#include "pixelFormat.h"
+#include "Application/Memory/memoryPlan.h"
+
+static const char *TAG = "palette_lut";
+
+/** @brief          Convert a palette into the byte order of the table.
+ *  @param p_LUT    Pointer to the lookup table
+ *  @param Palette  Palette with 256 entries
+ *  @param p_Colors 256 RGB565 colors
+ */
+static void PaletteLUT_Convert(const PaletteLUT_t *p_LUT, PaletteLUT_Palette_t Palette, uint16_t *p_Colors)
+{
+    /* Convert the palette once instead of once per table entry */
+    for (uint32_t i = 0; i < 256; i++) {
+        uint16_t Color;
+
+        Color = PixelFormat_ToRGB565(Palette[i][0], Palette[i][1], Palette[i][2]);
+        p_Colors[i] = p_LUT->isSwapped ? PixelFormat_Swap(Color) : Color;
+    }
+}
+
+/** @brief      Get the index shift for an AGC window.
+ *  @param Span Width of the window in raw counts
+ *  @return     Right shift so that the window fits into the table
+ */
+static uint8_t PaletteLUT_GetShift(uint32_t Span)
+{
+    uint8_t Shift;
+
+    /* Radiometric frames use the full 16 bit range. Wide windows are covered with a coarser step */
+    Shift = 0;
+    while ((Span >> Shift) >= PALETTE_LUT_SIZE) {
+        Shift++;
+    }
+
+    return Shift;
+}
+
+/** @brief          Saturate the entries above the window and store the new window.
+ *  @param p_LUT    Pointer to the lookup table
+ *  @param Palette  Palette of the table
+ *  @param p_Colors Converted palette
+ *  @param Min      Lower end of the AGC window in raw counts
+ *  @param Max      Upper end of the AGC window in raw counts
+ *  @param Shift    Index shift of the window
+ *  @param End      Last table entry inside the window
+ */
+static void PaletteLUT_Finish(PaletteLUT_t *p_LUT, PaletteLUT_Palette_t Palette, const uint16_t *p_Colors,
+                              uint16_t Min, uint16_t Max, uint8_t Shift, uint16_t End)
+{
+    uint32_t TailEnd;
+
+    /* Everything above the window is saturated. Entries above the old window end are saturated already,
+       unless the palette has changed or a band was patched into them */
+    if (p_LUT->isValid && (p_LUT->Palette == Palette) && (p_LUT->IsothermCount == 0)) {
+        TailEnd = (p_LUT->End > End) ? (p_LUT->End + 1) : (End + 1);
+    } else {
+        TailEnd = PALETTE_LUT_SIZE;
+    }
+
+    for (uint32_t i = End + 1; i < TailEnd; i++) {
+        p_LUT->RGB565[i] = p_Colors[255];
+    }
+
+    /* The last band first, so the first band is on top */
+    for (uint8_t b = p_LUT->IsothermCount; b > 0; b--) {
+        const PaletteLUT_Isotherm_t *p_Isotherm = &p_LUT->Isotherms[b - 1];
+        uint32_t First;
+        uint32_t Last;
+
+        if (Isotherm_GetEntries(p_Isotherm->Low, p_Isotherm->High, Min, Shift, PALETTE_LUT_SIZE, &First, &Last)) {
+            for (uint32_t i = First; i <= Last; i++) {
+                p_LUT->RGB565[i] = p_Isotherm->Color;
+            }
+        }
+    }
+
+    p_LUT->Palette = Palette;
+    p_LUT->Min = Min;
+    p_LUT->Max = Max;
+    p_LUT->Shift = Shift;
+    p_LUT->End = End;
+    p_LUT->isValid = true;
+}
+
+esp_err_t PaletteLUT_Init(PaletteLUT_t *p_LUT, bool isSwapped)
+{
+    if (p_LUT == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(p_LUT, 0, sizeof(PaletteLUT_t));
+
+    /* The table is read once per displayed pixel, so keep it out of the PSRAM cache if possible */
+    p_LUT->RGB565 = reinterpret_cast<uint16_t *>(MemoryPlan_Alloc(MEMORY_REGION_FAST,
+                                                                  PALETTE_LUT_SIZE * sizeof(uint16_t), "palette_lut"));
+    if (p_LUT->RGB565 == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate lookup table!");
+        return ESP_ERR_NO_MEM;
+    }
+
+    p_LUT->isSwapped = isSwapped;
+
+    return ESP_OK;
+}
+
+void PaletteLUT_Deinit(PaletteLUT_t *p_LUT)
+{
+    if ((p_LUT == NULL) || (p_LUT->RGB565 == NULL)) {
+        return;
+    }
+
+    MemoryPlan_Free(p_LUT->RGB565);
+    p_LUT->RGB565 = NULL;
+    p_LUT->isValid = false;
+}
+
+esp_err_t PaletteLUT_SetIsotherms(PaletteLUT_t *p_LUT, const Isotherm_Band_t *p_Bands, uint8_t Count)
+{
+    if ((p_LUT == NULL) || (Count > ISOTHERM_MAX_BANDS) || ((Count > 0) && (p_Bands == NULL))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (uint8_t i = 0; i < Count; i++) {
+        uint16_t Color = PixelFormat_ToRGB565(p_Bands[i].Color[0], p_Bands[i].Color[1], p_Bands[i].Color[2]);
+
+        p_LUT->Isotherms[i].Low = p_Bands[i].Low;
+        p_LUT->Isotherms[i].High = p_Bands[i].High;
+        p_LUT->Isotherms[i].Color = p_LUT->isSwapped ? PixelFormat_Swap(Color) : Color;
+    }
+
+    /* The old bands are removed by the full rebuild */
+    if ((Count > 0) || (p_LUT->IsothermCount > 0)) {
+        p_LUT->isValid = false;
+    }
+
+    p_LUT->IsothermCount = Count;
+
+    return ESP_OK;
+}
+
+bool PaletteLUT_Update(PaletteLUT_t *p_LUT, PaletteLUT_Palette_t Palette, uint16_t Min, uint16_t Max)
+{
+    uint16_t Colors[256];
+    uint32_t Span;
+    uint32_t Step;
+    uint32_t Accumulator;
+    uint8_t Shift;
+    uint16_t End;
+
+    if ((p_LUT == NULL) || (p_LUT->RGB565 == NULL) || (Palette == NULL)) {
+        return false;
+    }
+
+    if (p_LUT->isValid && (p_LUT->isCurve == false) && (p_LUT->Palette == Palette) && (p_LUT->Min == Min) &&
+        (p_LUT->Max == Max)) {
+        return false;
+    }
+
+    PaletteLUT_Convert(p_LUT, Palette, Colors);
+
+    Span = (Max > Min) ? (Max - Min) : 1;
+    Shift = PaletteLUT_GetShift(Span);
+    End = Span >> Shift;
+
+    /* Palette index = Offset * 255 / Span in 16.16 fixed point, accumulated to avoid a division per entry */
+    Step = (255UL << 16) / Span;
+    Accumulator = 0;
+    for (uint32_t i = 0; i <= End; i++) {
+        uint32_t Index;
+
+        Index = Accumulator >> 16;
+        p_LUT->RGB565[i] = Colors[(Index < 255) ? Index : 255];
+        Accumulator += Step << Shift;
+    }
+
+    PaletteLUT_Finish(p_LUT, Palette, Colors, Min, Max, Shift, End);
+    p_LUT->isCurve = false;
+
+    return true;
+}
+
+bool PaletteLUT_UpdateCurve(PaletteLUT_t *p_LUT, PaletteLUT_Palette_t Palette, uint16_t Min, uint16_t Max,
+                            const uint16_t *p_Curve)
+{
+    uint16_t Colors[256];
+    uint32_t Span;
+    uint32_t Step;
+    uint32_t Accumulator;
+    uint8_t Shift;
+    uint16_t End;
+
+    if ((p_LUT == NULL) || (p_LUT->RGB565 == NULL) || (Palette == NULL) || (p_Curve == NULL)) {
+        return false;
+    }
+
+    PaletteLUT_Convert(p_LUT, Palette, Colors);
+
+    Span = (Max > Min) ? (Max - Min) : 1;
+    Shift = PaletteLUT_GetShift(Span);
+    End = Span >> Shift;
+
+    /* Curve position = Offset * 256 / Span in 16.16 fixed point. The upper 8 bits of the fraction interpolate
+       between two points of the curve */
+    Step = ((PALETTE_LUT_CURVE_POINTS - 1UL) << 16) / Span;
+    Accumulator = 0;
+    for (uint32_t i = 0; i <= End; i++) {
+        uint32_t Point;
+        int32_t Fraction;
+        int32_t Index;
+
+        Point = Accumulator >> 16;
+        if (Point >= (PALETTE_LUT_CURVE_POINTS - 1)) {
+            Index = p_Curve[PALETTE_LUT_CURVE_POINTS - 1];
+        } else {
+            Fraction = (Accumulator >> 8) & 0xFF;
+            Index = p_Curve[Point] + (((p_Curve[Point + 1] - p_Curve[Point]) * Fraction) >> 8);
+        }
+
+        Index >>= 8;
+        p_LUT->RGB565[i] = Colors[(Index < 255) ? Index : 255];
+        Accumulator += Step << Shift;
+    }
+
+    PaletteLUT_Finish(p_LUT, Palette, Colors, Min, Max, Shift, End);
+    p_LUT->isCurve = true;
+
+    return true;
+}
@@ -0,0 +1,141 @@
+/*
+ * paletteLUT.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: RAW14 to RGB565 palette lookup table.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef PALETTE_LUT_H_
+#define PALETTE_LUT_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "isotherm.h"
+
+/** @brief Number of index bits of the lookup table (one entry per RAW14 count).
+ */
+#define PALETTE_LUT_BITS                        14
+
+/** @brief Number of lookup table entries.
+ */
+#define PALETTE_LUT_SIZE                        (1 << PALETTE_LUT_BITS)
+
+/** @brief Number of points of a transfer curve. The points are spread evenly over the AGC window, point 0 is at Min
+ *         and the last point at Max.
+ */
+#define PALETTE_LUT_CURVE_POINTS                257
+
+/** @brief Palette with 256 RGB888 entries, index 0 is the coldest color.
+ */
+typedef const uint8_t (*PaletteLUT_Palette_t)[3];
+
+/** @brief Isotherm band of a lookup table.
+ */
+typedef struct {
+    uint16_t Low;                               /**< Lower end in raw counts. */
+    uint16_t High;                              /**< Upper end in raw counts. */
+    uint16_t Color;                             /**< RGB565 color in the byte order of the table. */
+} PaletteLUT_Isotherm_t;
+
+/** @brief RAW14 to RGB565 lookup table for one AGC window.
+ *         Entry n holds the color of the raw value Min + (n << Shift). Values below Min map to the first
+ *         entry and values above Max map to the last palette color. The entries inside an isotherm band hold
+ *         the color of the band.
+ */
+typedef struct {
+    bool isSwapped;                             /**< true when the entries are stored byte swapped (panel byte order). */
+    bool isValid;                               /**< true when the table matches Palette, Min and Max. */
+    bool isCurve;                               /**< true when the table was built from a transfer curve. */
+    uint8_t Shift;                              /**< Right shift applied to (Raw - Min) before the lookup. */
+    uint16_t Min;                               /**< Lower end of the AGC window in raw counts. */
+    uint16_t Max;                               /**< Upper end of the AGC window in raw counts. */
+    uint16_t End;                               /**< Last table entry inside the AGC window. */
+    PaletteLUT_Palette_t Palette;               /**< Palette the table was built from. */
+    uint8_t IsothermCount;
+    PaletteLUT_Isotherm_t Isotherms[ISOTHERM_MAX_BANDS];    /**< Bands patched after every rebuild, the first on
+                                                                 top. */
+    uint16_t *RGB565;                           /**< Table with PALETTE_LUT_SIZE entries. */
+} PaletteLUT_t;
+
+/** @brief              Allocate a lookup table. The table is placed in internal RAM when possible.
+ *  @param p_LUT        Pointer to the lookup table
+ *  @param isSwapped    true to store the entries byte swapped, false for the native LVGL RGB565 format
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if p_LUT is NULL
+ *                      ESP_ERR_NO_MEM if the table can not be allocated
+ */
+esp_err_t PaletteLUT_Init(PaletteLUT_t *p_LUT, bool isSwapped);
+
+/** @brief          Free a lookup table.
+ *  @param p_LUT    Pointer to the lookup table
+ */
+void PaletteLUT_Deinit(PaletteLUT_t *p_LUT);
+
+/** @brief              Rebuild the lookup table when the palette or the AGC window has changed.
+ *                      Only the entries inside the new window and the entries of the old window that are
+ *                      now above Max are written.
+ *  @param p_LUT        Pointer to the lookup table
+ *  @param Palette      Palette with 256 entries
+ *  @param Min          Lower end of the AGC window in raw counts
+ *  @param Max          Upper end of the AGC window in raw counts
+ *  @return             true when the table was rebuilt
+ */
+bool PaletteLUT_Update(PaletteLUT_t *p_LUT, PaletteLUT_Palette_t Palette, uint16_t Min, uint16_t Max);
+
+/** @brief              Rebuild the lookup table for a transfer curve, e.g. of a histogram equalization. The table
+ *                      is always rebuilt, the caller decides when the curve has changed enough.
+ *  @param p_LUT        Pointer to the lookup table
+ *  @param Palette      Palette with 256 entries
+ *  @param Min          Lower end of the AGC window in raw counts
+ *  @param Max          Upper end of the AGC window in raw counts
+ *  @param p_Curve      PALETTE_LUT_CURVE_POINTS rising palette indices in 8.8 fixed point, linearly interpolated
+ *                      between the points
+ *  @return             true when the table was rebuilt
+ */
+bool PaletteLUT_UpdateCurve(PaletteLUT_t *p_LUT, PaletteLUT_Palette_t Palette, uint16_t Min, uint16_t Max,
+                            const uint16_t *p_Curve);
+
+/** @brief          Set the isotherm bands of a lookup table. The table is rebuilt and patched with the next update.
+ *                  Only for tables indexed by raw values, not for the levels of the local contrast.
+ *  @param p_LUT    Pointer to the lookup table
+ *  @param p_Bands  Bands, can be NULL if Count is 0
+ *  @param Count    Number of bands
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if p_LUT is NULL or Count is too large
+ */
+esp_err_t PaletteLUT_SetIsotherms(PaletteLUT_t *p_LUT, const Isotherm_Band_t *p_Bands, uint8_t Count);
+
+/** @brief          Map a raw value to its RGB565 color.
+ *  @param p_LUT    Pointer to a valid lookup table
+ *  @param Raw      Raw value
+ *  @return         RGB565 color in the byte order of the table
+ */
+static inline uint16_t PaletteLUT_Map(const PaletteLUT_t *p_LUT, uint16_t Raw)
+{
+    uint32_t Index;
+
+    Index = (Raw > p_LUT->Min) ? (static_cast<uint32_t>(Raw - p_LUT->Min) >> p_LUT->Shift) : 0;
+
+    return p_LUT->RGB565[(Index < PALETTE_LUT_SIZE) ? Index : (PALETTE_LUT_SIZE - 1)];
+}
+
+#endif /* PALETTE_LUT_H_ */
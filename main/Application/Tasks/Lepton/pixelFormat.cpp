@@ -0,0 +1,49 @@
+/*
+ * pixelFormat.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: RGB565 and RGB888 pixel conversions.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_attr.h>
+
+#include "pixelFormat.h"
+
+void IRAM_ATTR PixelFormat_RGB888ToRGB565(const uint8_t *p_Src, uint16_t *p_Dst, size_t Count, bool isSwapped)
+{
+    if (isSwapped) {
+        for (size_t i = 0; i < Count; i++) {
+            p_Dst[i] = PixelFormat_Swap(PixelFormat_ToRGB565(p_Src[0], p_Src[1], p_Src[2]));
+            p_Src += 3;
+        }
+    } else {
+        for (size_t i = 0; i < Count; i++) {
+            p_Dst[i] = PixelFormat_ToRGB565(p_Src[0], p_Src[1], p_Src[2]);
+            p_Src += 3;
+        }
+    }
+}
+
+void IRAM_ATTR PixelFormat_RGB565ToRGB888(const uint16_t *p_Src, uint8_t *p_Dst, size_t Count, bool isSwapped)
+{
+    for (size_t i = 0; i < Count; i++) {
+        PixelFormat_ToRGB888(isSwapped ? PixelFormat_Swap(p_Src[i]) : p_Src[i], p_Dst);
+        p_Dst += 3;
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * pixelFormat.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: RGB565 and RGB888 pixel conversions.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef PIXEL_FORMAT_H_
+#define PIXEL_FORMAT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/** @brief          Pack a RGB888 color into RGB565. The low bits are truncated.
+ *  @param r        Red channel
+ *  @param g        Green channel
+ *  @param b        Blue channel
+ *  @return         RGB565 color in the native LVGL byte order
+ */
+static inline uint16_t PixelFormat_ToRGB565(uint32_t r, uint32_t g, uint32_t b)
+{
+    return static_cast<uint16_t>(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+/** @brief          Swap the bytes of a RGB565 color (panel byte order).
+ *  @param Color    RGB565 color
+ *  @return         Byte swapped color
+ */
+static inline uint16_t PixelFormat_Swap(uint16_t Color)
+{
+    return static_cast<uint16_t>((Color << 8) | (Color >> 8));
+}
+
+/** @brief          Unpack a RGB565 color into RGB888. The high bits are replicated into the low bits, so white
+ *                  stays white.
+ *  @param Color    RGB565 color in the native LVGL byte order
+ *  @param p_RGB    RGB888 output (3 bytes)
+ */
+static inline void PixelFormat_ToRGB888(uint16_t Color, uint8_t *p_RGB)
+{
+    uint32_t r = (Color >> 11) & 0x1F;
+    uint32_t g = (Color >> 5) & 0x3F;
+    uint32_t b = Color & 0x1F;
+
+    p_RGB[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+    p_RGB[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+    p_RGB[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+}
+
+/** @brief              Convert RGB888 pixels into RGB565.
+ *  @param p_Src        RGB888 pixels (3 * Count bytes)
+ *  @param p_Dst        RGB565 output (Count entries)
+ *  @param Count        Number of pixels
+ *  @param isSwapped    true to write the colors byte swapped
+ */
+void PixelFormat_RGB888ToRGB565(const uint8_t *p_Src, uint16_t *p_Dst, size_t Count, bool isSwapped);
+
+/** @brief              Convert RGB565 pixels into RGB888, e.g. a frame buffer for a screenshot.
+ *  @param p_Src        RGB565 pixels (Count entries)
+ *  @param p_Dst        RGB888 output (3 * Count bytes)
+ *  @param Count        Number of pixels
+ *  @param isSwapped    true when the colors are stored byte swapped
+ */
+void PixelFormat_RGB565ToRGB888(const uint16_t *p_Src, uint8_t *p_Dst, size_t Count, bool isSwapped);
+
+#endif /* PIXEL_FORMAT_H_ */
@@ -0,0 +1,504 @@
+/*
+ * roiEngine.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Software ROI engine evaluating user ROIs on the RAW14 frame.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include <math.h>
+#include <string.h>
+
+#include "roiEngine.h"
+#include "frameStatistics.h"
+#include "Application/Memory/memoryPlan.h"
+
+/* Pixels per block of the row min/max tables */
+#define ROI_ENGINE_BLOCK_SHIFT                  3
+#define ROI_ENGINE_BLOCK_SIZE                   (1 << ROI_ENGINE_BLOCK_SHIFT)
+
+/** @brief Horizontal run of ROI pixels on one row (x0 and x1 inclusive).
+ */
+typedef struct {
+    uint16_t y;
+    uint16_t x0;
+    uint16_t x1;
+} ROIEngine_Span_t;
+
+/** @brief Rasterized ROI.
+ */
+typedef struct {
+    bool isActive;
+    uint16_t SpanCount;
+    uint32_t Pixels;
+    ROIEngine_Span_t *Spans;
+} ROIEngine_Slot_t;
+
+typedef struct {
+    bool isInitialized;
+    uint16_t Width;
+    uint16_t Height;
+    uint16_t Blocks;                            /**< Number of min/max blocks per row. */
+    uint16_t MaxSpans;                          /**< Span capacity per ROI. */
+    uint32_t *SAT;                              /**< Summed-area table of the pixel values ((Width + 1) * (Height + 1)). */
+    uint64_t *SAT_Squares;                      /**< Summed-area table of the squared pixel values. */
+    uint16_t *BlockMin;                         /**< Minimum per block of ROI_ENGINE_BLOCK_SIZE pixels of a row. */
+    uint16_t *BlockMax;                         /**< Maximum per block of ROI_ENGINE_BLOCK_SIZE pixels of a row. */
+    ROIEngine_Slot_t Slots[ROI_ENGINE_MAX_ROIS];
+    SemaphoreHandle_t Mutex;
+} ROIEngine_State_t;
+
+static ROIEngine_State_t _ROIEngine_State;
+
+static const char *TAG = "roi_engine";
+
+/** @brief          Append a span to a slot, clipped to the frame.
+ *  @param p_Slot   Pointer to the slot
+ *  @param y        Row
+ *  @param x0       First column (may be outside of the frame)
+ *  @param x1       Last column (may be outside of the frame)
+ */
+static void ROIEngine_AddSpan(ROIEngine_Slot_t *p_Slot, int32_t y, int32_t x0, int32_t x1)
+{
+    if ((y < 0) || (y >= _ROIEngine_State.Height)) {
+        return;
+    }
+
+    if (x0 < 0) {
+        x0 = 0;
+    }
+
+    if (x1 >= _ROIEngine_State.Width) {
+        x1 = _ROIEngine_State.Width - 1;
+    }
+
+    if ((x1 < x0) || (p_Slot->SpanCount >= _ROIEngine_State.MaxSpans)) {
+        return;
+    }
+
+    p_Slot->Spans[p_Slot->SpanCount].y = y;
+    p_Slot->Spans[p_Slot->SpanCount].x0 = x0;
+    p_Slot->Spans[p_Slot->SpanCount].x1 = x1;
+    p_Slot->SpanCount++;
+    p_Slot->Pixels += x1 - x0 + 1;
+}
+
+/** @brief          Rasterize a polygon with the even-odd rule by sampling every row at the pixel center.
+ *                  The vertices are pixel corner coordinates, so (10,10)-(20,20) covers the pixels 10 to 19.
+ *  @param p_Slot   Pointer to the slot
+ *  @param p_ROI    Pointer to the polygon ROI
+ */
+static void ROIEngine_RasterizePolygon(ROIEngine_Slot_t *p_Slot, const ROIEngine_ROI_t *p_ROI)
+{
+    int32_t MinY = _ROIEngine_State.Height;
+    int32_t MaxY = 0;
+
+    for (uint8_t i = 0; i < p_ROI->PointCount; i++) {
+        MinY = (p_ROI->Points[i].y < MinY) ? p_ROI->Points[i].y : MinY;
+        MaxY = (p_ROI->Points[i].y > MaxY) ? p_ROI->Points[i].y : MaxY;
+    }
+
+    for (int32_t y = MinY; y < MaxY; y++) {
+        float Crossings[ROI_ENGINE_MAX_POINTS];
+        uint8_t CrossingCount = 0;
+        float Sample = y + 0.5f;
+
+        for (uint8_t i = 0; i < p_ROI->PointCount; i++) {
+            const ROIEngine_Point_t *a = &p_ROI->Points[i];
+            const ROIEngine_Point_t *b = &p_ROI->Points[(i + 1) % p_ROI->PointCount];
+            float ay = a->y;
+            float by = b->y;
+
+            if (((ay <= Sample) && (by > Sample)) || ((by <= Sample) && (ay > Sample))) {
+                Crossings[CrossingCount++] = a->x + ((Sample - ay) / (by - ay)) * (b->x - a->x);
+            }
+        }
+
+        /* Insertion sort, there are at most ROI_ENGINE_MAX_POINTS crossings */
+        for (uint8_t i = 1; i < CrossingCount; i++) {
+            float Value = Crossings[i];
+            int8_t j = i - 1;
+
+            while ((j >= 0) && (Crossings[j] > Value)) {
+                Crossings[j + 1] = Crossings[j];
+                j--;
+            }
+
+            Crossings[j + 1] = Value;
+        }
+
+        for (uint8_t i = 0; (i + 1) < CrossingCount; i += 2) {
+            /* A pixel is inside when its center lies in [Crossing0, Crossing1) */
+            ROIEngine_AddSpan(p_Slot, y, static_cast<int32_t>(ceilf(Crossings[i] - 0.5f)),
+                              static_cast<int32_t>(ceilf(Crossings[i + 1] - 0.5f)) - 1);
+        }
+    }
+}
+
+/** @brief          Rasterize an ROI into spans.
+ *  @param p_Slot   Pointer to the slot
+ *  @param p_ROI    Pointer to the ROI
+ */
+static void ROIEngine_Rasterize(ROIEngine_Slot_t *p_Slot, const ROIEngine_ROI_t *p_ROI)
+{
+    p_Slot->SpanCount = 0;
+    p_Slot->Pixels = 0;
+
+    switch (p_ROI->Shape) {
+        case ROI_SHAPE_RECT: {
+            for (int32_t y = p_ROI->y; y < (p_ROI->y + p_ROI->h); y++) {
+                ROIEngine_AddSpan(p_Slot, y, p_ROI->x, p_ROI->x + p_ROI->w - 1);
+            }
+
+            break;
+        }
+        case ROI_SHAPE_ELLIPSE: {
+            float cx = p_ROI->x + (p_ROI->w / 2.0f);
+            float cy = p_ROI->y + (p_ROI->h / 2.0f);
+            float rx = p_ROI->w / 2.0f;
+            float ry = p_ROI->h / 2.0f;
+
+            for (int32_t y = p_ROI->y; y < (p_ROI->y + p_ROI->h); y++) {
+                float dy = ((y + 0.5f) - cy) / ry;
+                float Half;
+
+                if ((dy * dy) > 1.0f) {
+                    continue;
+                }
+
+                Half = rx * sqrtf(1.0f - (dy * dy));
+                ROIEngine_AddSpan(p_Slot, y, static_cast<int32_t>(ceilf(cx - Half - 0.5f)),
+                                  static_cast<int32_t>(floorf(cx + Half - 0.5f)));
+            }
+
+            break;
+        }
+        case ROI_SHAPE_POLYGON: {
+            ROIEngine_RasterizePolygon(p_Slot, p_ROI);
+
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+/** @brief Build the summed-area tables and the block min/max tables of a frame in one pass.
+ *  @param p_RAW Pointer to the RAW14 pixel data
+ */
+static void ROIEngine_BuildTables(const uint16_t *p_RAW)
+{
+    uint32_t Stride = _ROIEngine_State.Width + 1;
+
+    for (uint16_t y = 0; y < _ROIEngine_State.Height; y++) {
+        const uint16_t *p_Row = &p_RAW[y * _ROIEngine_State.Width];
+        uint32_t *p_Above = &_ROIEngine_State.SAT[y * Stride];
+        uint32_t *p_Current = &_ROIEngine_State.SAT[(y + 1) * Stride];
+        uint64_t *p_AboveSquares = &_ROIEngine_State.SAT_Squares[y * Stride];
+        uint64_t *p_CurrentSquares = &_ROIEngine_State.SAT_Squares[(y + 1) * Stride];
+        uint16_t *p_BlockMin = &_ROIEngine_State.BlockMin[y * _ROIEngine_State.Blocks];
+        uint16_t *p_BlockMax = &_ROIEngine_State.BlockMax[y * _ROIEngine_State.Blocks];
+        uint32_t RowSum = 0;
+        uint64_t RowSquares = 0;
+
+        for (uint16_t b = 0; b < _ROIEngine_State.Blocks; b++) {
+            p_BlockMin[b] = 0xFFFF;
+            p_BlockMax[b] = 0;
+        }
+
+        for (uint16_t x = 0; x < _ROIEngine_State.Width; x++) {
+            uint32_t Value = p_Row[x];
+            uint16_t Block = x >> ROI_ENGINE_BLOCK_SHIFT;
+
+            RowSum += Value;
+            RowSquares += Value * Value;
+            p_Current[x + 1] = p_Above[x + 1] + RowSum;
+            p_CurrentSquares[x + 1] = p_AboveSquares[x + 1] + RowSquares;
+
+            p_BlockMin[Block] = (Value < p_BlockMin[Block]) ? Value : p_BlockMin[Block];
+            p_BlockMax[Block] = (Value > p_BlockMax[Block]) ? Value : p_BlockMax[Block];
+        }
+    }
+}
+
+/** @brief          Get the min and max of a span from the block tables. Only the partial blocks at both
+ *                  ends are scanned pixel by pixel.
+ *  @param p_RAW    Pointer to the RAW14 pixel data
+ *  @param p_Span   Pointer to the span
+ *  @param p_Min    Running minimum
+ *  @param p_Max    Running maximum
+ */
+static void ROIEngine_SpanExtrema(const uint16_t *p_RAW, const ROIEngine_Span_t *p_Span, uint32_t *p_Min, uint32_t *p_Max)
+{
+    const uint16_t *p_Row = &p_RAW[p_Span->y * _ROIEngine_State.Width];
+    uint32_t FirstBlock = (p_Span->x0 + ROI_ENGINE_BLOCK_SIZE - 1) >> ROI_ENGINE_BLOCK_SHIFT;
+    uint32_t EndBlock = (p_Span->x1 + 1) >> ROI_ENGINE_BLOCK_SHIFT;
+    uint32_t x = p_Span->x0;
+
+    if (FirstBlock < EndBlock) {
+        const uint16_t *p_BlockMin = &_ROIEngine_State.BlockMin[p_Span->y * _ROIEngine_State.Blocks];
+        const uint16_t *p_BlockMax = &_ROIEngine_State.BlockMax[p_Span->y * _ROIEngine_State.Blocks];
+
+        for (; x < (FirstBlock << ROI_ENGINE_BLOCK_SHIFT); x++) {
+            uint32_t Value = p_Row[x];
+            *p_Min = (Value < *p_Min) ? Value : *p_Min;
+            *p_Max = (Value > *p_Max) ? Value : *p_Max;
+        }
+
+        for (uint32_t b = FirstBlock; b < EndBlock; b++) {
+            *p_Min = (p_BlockMin[b] < *p_Min) ? p_BlockMin[b] : *p_Min;
+            *p_Max = (p_BlockMax[b] > *p_Max) ? p_BlockMax[b] : *p_Max;
+        }
+
+        x = EndBlock << ROI_ENGINE_BLOCK_SHIFT;
+    }
+
+    for (; x <= p_Span->x1; x++) {
+        uint32_t Value = p_Row[x];
+        *p_Min = (Value < *p_Min) ? Value : *p_Min;
+        *p_Max = (Value > *p_Max) ? Value : *p_Max;
+    }
+}
+
+esp_err_t ROIEngine_Init(uint16_t Width, uint16_t Height)
+{
+    ROIEngine_Span_t *Spans;
+    size_t TableSize;
+
+    if (_ROIEngine_State.isInitialized) {
+        ESP_LOGW(TAG, "Already initialized");
+        return ESP_OK;
+    }
+
+    if ((Width == 0) || (Height == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(&_ROIEngine_State, 0, sizeof(_ROIEngine_State));
+
+    _ROIEngine_State.Width = Width;
+    _ROIEngine_State.Height = Height;
+    _ROIEngine_State.Blocks = (Width + ROI_ENGINE_BLOCK_SIZE - 1) >> ROI_ENGINE_BLOCK_SHIFT;
+    _ROIEngine_State.MaxSpans = Height * (ROI_ENGINE_MAX_POINTS / 2);
+
+    _ROIEngine_State.Mutex = xSemaphoreCreateMutex();
+    if (_ROIEngine_State.Mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex!");
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* Row 0 and column 0 of the tables are the zero border and are never written */
+    TableSize = (Width + 1) * (Height + 1);
+    _ROIEngine_State.SAT = reinterpret_cast<uint32_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME,
+                                                                         TableSize * sizeof(uint32_t), "roi_sat"));
+    _ROIEngine_State.SAT_Squares = reinterpret_cast<uint64_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME,
+                                                                                 TableSize * sizeof(uint64_t),
+                                                                                 "roi_sat_squares"));
+    _ROIEngine_State.BlockMin = reinterpret_cast<uint16_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME,
+                                                                              _ROIEngine_State.Blocks * Height *
+                                                                              sizeof(uint16_t), "roi_block_min"));
+    _ROIEngine_State.BlockMax = reinterpret_cast<uint16_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME,
+                                                                              _ROIEngine_State.Blocks * Height *
+                                                                              sizeof(uint16_t), "roi_block_max"));
+
+    if ((_ROIEngine_State.SAT == NULL) || (_ROIEngine_State.SAT_Squares == NULL) || (_ROIEngine_State.BlockMin == NULL) ||
+        (_ROIEngine_State.BlockMax == NULL)) {
+        ESP_LOGE(TAG, "Failed to allocate ROI tables!");
+        _ROIEngine_State.isInitialized = true;
+        ROIEngine_Deinit();
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(_ROIEngine_State.SAT, 0, TableSize * sizeof(uint32_t));
+    memset(_ROIEngine_State.SAT_Squares, 0, TableSize * sizeof(uint64_t));
+
+    /* The span tables of all slots are one block, starting at the first slot */
+    Spans = reinterpret_cast<ROIEngine_Span_t *>(MemoryPlan_Alloc(MEMORY_REGION_FRAME, ROI_ENGINE_MAX_ROIS *
+                                                                  _ROIEngine_State.MaxSpans * sizeof(ROIEngine_Span_t),
+                                                                  "roi_spans"));
+    if (Spans == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate span tables!");
+        _ROIEngine_State.isInitialized = true;
+        ROIEngine_Deinit();
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (uint8_t i = 0; i < ROI_ENGINE_MAX_ROIS; i++) {
+        _ROIEngine_State.Slots[i].Spans = &Spans[i * _ROIEngine_State.MaxSpans];
+    }
+
+    _ROIEngine_State.isInitialized = true;
+
+    ESP_LOGD(TAG, "ROI engine initialized for %ux%u", Width, Height);
+
+    return ESP_OK;
+}
+
+void ROIEngine_Deinit(void)
+{
+    if (_ROIEngine_State.isInitialized == false) {
+        return;
+    }
+
+    MemoryPlan_Free(_ROIEngine_State.Slots[0].Spans);
+
+    for (uint8_t i = 0; i < ROI_ENGINE_MAX_ROIS; i++) {
+        _ROIEngine_State.Slots[i].Spans = NULL;
+        _ROIEngine_State.Slots[i].isActive = false;
+    }
+
+    MemoryPlan_Free(_ROIEngine_State.SAT);
+    MemoryPlan_Free(_ROIEngine_State.SAT_Squares);
+    MemoryPlan_Free(_ROIEngine_State.BlockMin);
+    MemoryPlan_Free(_ROIEngine_State.BlockMax);
+    _ROIEngine_State.SAT = NULL;
+    _ROIEngine_State.SAT_Squares = NULL;
+    _ROIEngine_State.BlockMin = NULL;
+    _ROIEngine_State.BlockMax = NULL;
+
+    if (_ROIEngine_State.Mutex != NULL) {
+        vSemaphoreDelete(_ROIEngine_State.Mutex);
+        _ROIEngine_State.Mutex = NULL;
+    }
+
+    _ROIEngine_State.isInitialized = false;
+}
+
+esp_err_t ROIEngine_SetROI(uint8_t Index, const ROIEngine_ROI_t *p_ROI)
+{
+    if ((Index >= ROI_ENGINE_MAX_ROIS) || (p_ROI == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_ROIEngine_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if ((p_ROI->Shape == ROI_SHAPE_POLYGON) && ((p_ROI->PointCount < 3) || (p_ROI->PointCount > ROI_ENGINE_MAX_POINTS))) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (((p_ROI->Shape == ROI_SHAPE_RECT) || (p_ROI->Shape == ROI_SHAPE_ELLIPSE)) &&
+               ((p_ROI->w == 0) || (p_ROI->h == 0))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(_ROIEngine_State.Mutex, portMAX_DELAY);
+    ROIEngine_Rasterize(&_ROIEngine_State.Slots[Index], p_ROI);
+    _ROIEngine_State.Slots[Index].isActive = (_ROIEngine_State.Slots[Index].Pixels > 0);
+    xSemaphoreGive(_ROIEngine_State.Mutex);
+
+    ESP_LOGD(TAG, "ROI %u set: shape %d, %u spans, %u pixels", Index, p_ROI->Shape,
+             _ROIEngine_State.Slots[Index].SpanCount, static_cast<unsigned int>(_ROIEngine_State.Slots[Index].Pixels));
+
+    return ESP_OK;
+}
+
+esp_err_t ROIEngine_ClearROI(uint8_t Index)
+{
+    if (Index >= ROI_ENGINE_MAX_ROIS) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_ROIEngine_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(_ROIEngine_State.Mutex, portMAX_DELAY);
+    _ROIEngine_State.Slots[Index].isActive = false;
+    _ROIEngine_State.Slots[Index].SpanCount = 0;
+    _ROIEngine_State.Slots[Index].Pixels = 0;
+    xSemaphoreGive(_ROIEngine_State.Mutex);
+
+    return ESP_OK;
+}
+
+esp_err_t ROIEngine_Process(const uint16_t *p_RAW, ROIEngine_Result_t *p_Results)
+{
+    bool hasActive = false;
+    uint32_t Stride;
+
+    if ((p_RAW == NULL) || (p_Results == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    } else if (_ROIEngine_State.isInitialized == false) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (xSemaphoreTake(_ROIEngine_State.Mutex, 10 / portTICK_PERIOD_MS) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    for (uint8_t i = 0; i < ROI_ENGINE_MAX_ROIS; i++) {
+        p_Results[i].isValid = false;
+        hasActive |= _ROIEngine_State.Slots[i].isActive;
+    }
+
+    /* Nothing to do, skip building the tables */
+    if (hasActive == false) {
+        xSemaphoreGive(_ROIEngine_State.Mutex);
+        return ESP_OK;
+    }
+
+    ROIEngine_BuildTables(p_RAW);
+
+    Stride = _ROIEngine_State.Width + 1;
+    for (uint8_t i = 0; i < ROI_ENGINE_MAX_ROIS; i++) {
+        ROIEngine_Slot_t *p_Slot = &_ROIEngine_State.Slots[i];
+        uint64_t Sum = 0;
+        uint64_t Squares = 0;
+        uint32_t Min = 0xFFFF;
+        uint32_t Max = 0;
+        float Mean;
+        float Variance;
+
+        if (p_Slot->isActive == false) {
+            continue;
+        }
+
+        for (uint16_t s = 0; s < p_Slot->SpanCount; s++) {
+            const ROIEngine_Span_t *p_Span = &p_Slot->Spans[s];
+            uint32_t Top = p_Span->y * Stride;
+            uint32_t Bottom = (p_Span->y + 1) * Stride;
+
+            /* A span is one row high, so the SAT lookup costs four reads independent of the span length */
+            Sum += (_ROIEngine_State.SAT[Bottom + p_Span->x1 + 1] - _ROIEngine_State.SAT[Top + p_Span->x1 + 1]) -
+                   (_ROIEngine_State.SAT[Bottom + p_Span->x0] - _ROIEngine_State.SAT[Top + p_Span->x0]);
+            Squares += (_ROIEngine_State.SAT_Squares[Bottom + p_Span->x1 + 1] - _ROIEngine_State.SAT_Squares[Top + p_Span->x1 + 1]) -
+                       (_ROIEngine_State.SAT_Squares[Bottom + p_Span->x0] - _ROIEngine_State.SAT_Squares[Top + p_Span->x0]);
+
+            ROIEngine_SpanExtrema(p_RAW, p_Span, &Min, &Max);
+        }
+
+        Mean = static_cast<float>(Sum) / p_Slot->Pixels;
+        Variance = static_cast<float>((p_Slot->Pixels * Squares) - (Sum * Sum)) /
+                   (static_cast<float>(p_Slot->Pixels) * static_cast<float>(p_Slot->Pixels));
+
+        p_Results[i].isValid = true;
+        p_Results[i].Pixels = p_Slot->Pixels;
+        p_Results[i].Min = FrameStatistics_RawToCelsius(Min);
+        p_Results[i].Max = FrameStatistics_RawToCelsius(Max);
+        p_Results[i].Mean = FrameStatistics_RawToCelsius(Mean);
+        p_Results[i].StdDev = sqrtf(Variance) * 0.01f;
+    }
+
+    xSemaphoreGive(_ROIEngine_State.Mutex);
+
+    return ESP_OK;
+}
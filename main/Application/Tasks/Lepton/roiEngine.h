@@ -0,0 +1,121 @@
+/*
+ * roiEngine.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Software ROI engine evaluating user ROIs on the RAW14 frame.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef ROI_ENGINE_H_
+#define ROI_ENGINE_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Maximum number of ROIs evaluated per frame.
+ *         The first four indices are used for the ROIs from the settings (see App_Settings_ROI_Type_t).
+ */
+#define ROI_ENGINE_MAX_ROIS                     16
+
+/** @brief Maximum number of vertices of a polygon ROI.
+ */
+#define ROI_ENGINE_MAX_POINTS                   8
+
+/** @brief ROI shapes.
+ */
+typedef enum {
+    ROI_SHAPE_NONE = 0,                         /**< ROI slot is unused. */
+    ROI_SHAPE_RECT,                             /**< Rectangle given by x, y, w, h. */
+    ROI_SHAPE_ELLIPSE,                          /**< Ellipse inscribed into the rectangle x, y, w, h. */
+    ROI_SHAPE_POLYGON,                          /**< Closed polygon given by Points (even-odd rule). */
+} ROIEngine_Shape_t;
+
+/** @brief ROI vertex in frame coordinates.
+ */
+typedef struct {
+    uint16_t x;                                 /**< Column. */
+    uint16_t y;                                 /**< Row. */
+} ROIEngine_Point_t;
+
+/** @brief ROI definition in frame coordinates.
+ */
+typedef struct {
+    ROIEngine_Shape_t Shape;                    /**< Shape of the ROI. */
+    uint16_t x;                                 /**< Left column of the bounding rectangle (rect and ellipse). */
+    uint16_t y;                                 /**< Top row of the bounding rectangle (rect and ellipse). */
+    uint16_t w;                                 /**< Width of the bounding rectangle (rect and ellipse). */
+    uint16_t h;                                 /**< Height of the bounding rectangle (rect and ellipse). */
+    uint8_t PointCount;                         /**< Number of valid entries in Points (polygon only). */
+    ROIEngine_Point_t Points[ROI_ENGINE_MAX_POINTS];  /**< Polygon vertices (polygon only). */
+} ROIEngine_ROI_t;
+
+/** @brief Result of a single ROI.
+ */
+typedef struct {
+    bool isValid;                               /**< true when the ROI is active and contains at least one pixel. */
+    uint32_t Pixels;                            /**< Number of pixels inside the ROI. */
+    float Min;                                  /**< Minimum temperature in Degree Celsius. */
+    float Max;                                  /**< Maximum temperature in Degree Celsius. */
+    float Mean;                                 /**< Mean temperature in Degree Celsius. */
+    float StdDev;                               /**< Standard deviation in Kelvin. */
+} ROIEngine_Result_t;
+
+/** @brief          Initialize the ROI engine and allocate the summed-area tables.
+ *  @param Width    Frame width in pixels
+ *  @param Height   Frame height in pixels
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if a parameter is invalid
+ *                  ESP_ERR_NO_MEM if the tables can not be allocated
+ */
+esp_err_t ROIEngine_Init(uint16_t Width, uint16_t Height);
+
+/** @brief Deinitialize the ROI engine.
+ */
+void ROIEngine_Deinit(void);
+
+/** @brief          Set or replace an ROI. The shape is rasterized once here, so processing a frame does
+ *                  not depend on the shape.
+ *  @param Index    ROI index (0 to ROI_ENGINE_MAX_ROIS - 1)
+ *  @param p_ROI    Pointer to the ROI definition
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if the index or the ROI is invalid
+ *                  ESP_ERR_INVALID_STATE if the engine is not initialized
+ */
+esp_err_t ROIEngine_SetROI(uint8_t Index, const ROIEngine_ROI_t *p_ROI);
+
+/** @brief          Remove an ROI.
+ *  @param Index    ROI index (0 to ROI_ENGINE_MAX_ROIS - 1)
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if the index is invalid
+ *                  ESP_ERR_INVALID_STATE if the engine is not initialized
+ */
+esp_err_t ROIEngine_ClearROI(uint8_t Index);
+
+/** @brief              Evaluate all active ROIs on a RAW14 frame.
+ *  @param p_RAW        Pointer to the RAW14 pixel data (Width * Height from ROIEngine_Init)
+ *  @param p_Results    Pointer to an array of ROI_ENGINE_MAX_ROIS results
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if a parameter is invalid
+ *                      ESP_ERR_INVALID_STATE if the engine is not initialized
+ *                      ESP_ERR_TIMEOUT if the ROI table is locked
+ */
+esp_err_t ROIEngine_Process(const uint16_t *p_RAW, ROIEngine_Result_t *p_Results);
+
+#endif /* ROI_ENGINE_H_ */
@@ -0,0 +1,481 @@
+/*
+ * spotTracker.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Hot and cold spot detection, tracking and alarms on RAW14 frames.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+#include <esp_attr.h>
+
+#include <string.h>
+
+#include "spotTracker.h"
+#include "Application/Memory/memoryPlan.h"
+
+static const char *TAG = "spot_tracker";
+
+/** @brief          Find the root run of a spot. Halves the path on the way, so later calls are shorter.
+ *  @param p_Runs   Runs of the frame
+ *  @param Index    Run
+ *  @return         Index of the root run
+ */
+static inline uint16_t SpotTracker_Find(SpotTracker_Run_t *p_Runs, uint16_t Index)
+{
+    while (p_Runs[Index].Parent != Index) {
+        p_Runs[Index].Parent = p_Runs[p_Runs[Index].Parent].Parent;
+        Index = p_Runs[Index].Parent;
+    }
+
+    return Index;
+}
+
+/** @brief          Join the spots of two runs. The run with the lower index stays the root, so every root is the
+ *                  first run of its spot.
+ *  @param p_Runs   Runs of the frame
+ *  @param a        First run
+ *  @param b        Second run
+ */
+static inline void SpotTracker_Union(SpotTracker_Run_t *p_Runs, uint16_t a, uint16_t b)
+{
+    a = SpotTracker_Find(p_Runs, a);
+    b = SpotTracker_Find(p_Runs, b);
+
+    if (a < b) {
+        p_Runs[b].Parent = a;
+    } else if (b < a) {
+        p_Runs[a].Parent = b;
+    }
+}
+
+/** @brief              Label the pixels of a kind and collect the most severe spots. The values are XORed with a
+ *                      mask, so a cold spot is a hot spot of the inverted frame for the labelling.
+ *  @param p_Tracker    Pointer to the tracker
+ *  @param p_RAW        RAW14 frame
+ *  @param Threshold    Threshold, XORed with the mask
+ *  @param Mask         0 for hot spots, 0xFFFF for cold spots
+ *  @param p_Spots      SPOT_TRACKER_MAX_SPOTS spots, sorted by the severity. Peak is XORed with the mask
+ *  @param p_Count      Number of spots
+ *  @return             true if the run limit was reached
+ */
+static IRAM_ATTR bool SpotTracker_Label(SpotTracker_t *p_Tracker, const uint16_t *p_RAW, uint16_t Threshold,
+                                        uint16_t Mask, SpotTracker_Spot_t *p_Spots, uint8_t *p_Count)
+{
+    SpotTracker_Run_t *p_Runs;
+    uint16_t Count;
+    uint16_t Previous;
+    bool isTruncated;
+
+    p_Runs = p_Tracker->Runs;
+    Count = 0;
+    Previous = 0;
+    isTruncated = false;
+    *p_Count = 0;
+
+    for (uint16_t y = 0; (y < p_Tracker->Height) && (isTruncated == false); y++) {
+        const uint16_t *p_Row = &p_RAW[y * p_Tracker->Width];
+        uint16_t RowStart = Count;
+        uint16_t x = 0;
+
+        while (x < p_Tracker->Width) {
+            SpotTracker_Run_t *p_Run;
+            uint16_t Value;
+
+            while ((x < p_Tracker->Width) && ((p_Row[x] ^ Mask) < Threshold)) {
+                x++;
+            }
+
+            if (x >= p_Tracker->Width) {
+                break;
+            }
+
+            if (Count >= SPOT_TRACKER_MAX_RUNS) {
+                isTruncated = true;
+                break;
+            }
+
+            p_Run = &p_Runs[Count];
+            p_Run->Parent = Count;
+            p_Run->Row = y;
+            p_Run->Start = x;
+            p_Run->Peak = 0;
+            p_Run->PeakX = x;
+
+            while ((x < p_Tracker->Width) && ((Value = (p_Row[x] ^ Mask)) >= Threshold)) {
+                if (Value > p_Run->Peak) {
+                    p_Run->Peak = Value;
+                    p_Run->PeakX = x;
+                }
+
+                x++;
+            }
+
+            p_Run->End = x - 1;
+
+            /* Runs of the previous row that end left of this run can not touch a later run of this row either */
+            while ((Previous < RowStart) && ((p_Runs[Previous].End + 1) < p_Run->Start)) {
+                Previous++;
+            }
+
+            /* 8-connectivity, a diagonal neighbour joins the spots */
+            for (uint16_t i = Previous; (i < RowStart) && (p_Runs[i].Start <= (p_Run->End + 1)); i++) {
+                SpotTracker_Union(p_Runs, i, Count);
+            }
+
+            Count++;
+        }
+
+        Previous = RowStart;
+    }
+
+    /* Every run is only read and written once more, the roots are always in front of their runs */
+    for (uint16_t i = 0; i < Count; i++) {
+        SpotTracker_Run_t *p_Run = &p_Runs[i];
+        uint16_t Length = p_Run->End - p_Run->Start + 1;
+        uint16_t Root = SpotTracker_Find(p_Runs, i);
+
+        if (Root == i) {
+            p_Run->Area = Length;
+            p_Run->Top = p_Run->Row;
+            p_Run->Bottom = p_Run->Row;
+            p_Run->PeakY = p_Run->Row;
+            p_Run->SumX = (static_cast<uint32_t>(p_Run->Start + p_Run->End) * Length) / 2;
+            p_Run->SumY = static_cast<uint32_t>(p_Run->Row) * Length;
+        } else {
+            SpotTracker_Run_t *p_Spot = &p_Runs[Root];
+
+            p_Spot->Area += Length;
+            p_Spot->Start = (p_Run->Start < p_Spot->Start) ? p_Run->Start : p_Spot->Start;
+            p_Spot->End = (p_Run->End > p_Spot->End) ? p_Run->End : p_Spot->End;
+            p_Spot->Bottom = p_Run->Row;
+            p_Spot->SumX += (static_cast<uint32_t>(p_Run->Start + p_Run->End) * Length) / 2;
+            p_Spot->SumY += static_cast<uint32_t>(p_Run->Row) * Length;
+
+            if (p_Run->Peak > p_Spot->Peak) {
+                p_Spot->Peak = p_Run->Peak;
+                p_Spot->PeakX = p_Run->PeakX;
+                p_Spot->PeakY = p_Run->Row;
+            }
+        }
+    }
+
+    /* Keep the most severe spots, sorted by the peak */
+    for (uint16_t i = 0; i < Count; i++) {
+        const SpotTracker_Run_t *p_Run = &p_Runs[i];
+        SpotTracker_Spot_t *p_Spot;
+        uint8_t Index;
+
+        if ((p_Run->Parent != i) || (p_Run->Area < p_Tracker->Config.MinArea)) {
+            continue;
+        }
+
+        Index = *p_Count;
+        while ((Index > 0) && (p_Spots[Index - 1].Peak < p_Run->Peak)) {
+            Index--;
+        }
+
+        if (Index >= SPOT_TRACKER_MAX_SPOTS) {
+            continue;
+        }
+
+        if (*p_Count < SPOT_TRACKER_MAX_SPOTS) {
+            (*p_Count)++;
+        }
+
+        memmove(&p_Spots[Index + 1], &p_Spots[Index], (*p_Count - Index - 1) * sizeof(SpotTracker_Spot_t));
+
+        p_Spot = &p_Spots[Index];
+        memset(p_Spot, 0, sizeof(SpotTracker_Spot_t));
+        p_Spot->X = p_Run->PeakX;
+        p_Spot->Y = p_Run->PeakY;
+        p_Spot->CenterX = (p_Run->SumX + (p_Run->Area / 2)) / p_Run->Area;
+        p_Spot->CenterY = (p_Run->SumY + (p_Run->Area / 2)) / p_Run->Area;
+        p_Spot->Left = p_Run->Start;
+        p_Spot->Top = p_Run->Top;
+        p_Spot->Right = p_Run->End;
+        p_Spot->Bottom = p_Run->Bottom;
+        p_Spot->Area = p_Run->Area;
+        p_Spot->Peak = p_Run->Peak;
+    }
+
+    return isTruncated;
+}
+
+/** @brief              Match the spots of a kind to its tracks. Every track takes the nearest free spot within the
+ *                      gate, the oldest track first. Spots without a track start a new one.
+ *  @param p_Tracker    Pointer to the tracker
+ *  @param Kind         Kind
+ *  @param p_Spots      Spots of the frame, sorted by the severity
+ *  @param Count        Number of spots
+ */
+static void SpotTracker_Track(SpotTracker_t *p_Tracker, SpotTracker_Kind_t Kind, const SpotTracker_Spot_t *p_Spots,
+                              uint8_t Count)
+{
+    bool isUsed[SPOT_TRACKER_MAX_SPOTS] = {false};
+    uint8_t Tracks;
+
+    Tracks = 0;
+    for (uint8_t i = 0; i < p_Tracker->Count; i++) {
+        SpotTracker_Spot_t *p_Track = &p_Tracker->Tracks[i];
+        uint32_t Best = (SPOT_TRACKER_GATE * SPOT_TRACKER_GATE) + 1;
+        int16_t Match = -1;
+
+        if (p_Track->Kind == Kind) {
+            /* The tracks of a disabled kind are removed at once */
+            if (p_Tracker->Config.Threshold[Kind] == 0) {
+                continue;
+            }
+
+            for (uint8_t j = 0; j < Count; j++) {
+                int32_t dx = static_cast<int32_t>(p_Spots[j].CenterX) - p_Track->CenterX;
+                int32_t dy = static_cast<int32_t>(p_Spots[j].CenterY) - p_Track->CenterY;
+                uint32_t Distance = static_cast<uint32_t>((dx * dx) + (dy * dy));
+
+                if ((isUsed[j] == false) && (Distance < Best)) {
+                    Best = Distance;
+                    Match = j;
+                }
+            }
+
+            if (Match >= 0) {
+                uint16_t ID = p_Track->ID;
+                uint8_t Age = p_Track->Age;
+
+                *p_Track = p_Spots[Match];
+                p_Track->ID = ID;
+                p_Track->Kind = Kind;
+                p_Track->Age = (Age < UINT8_MAX) ? (Age + 1) : Age;
+                isUsed[Match] = true;
+            } else {
+                p_Track->Missed++;
+            }
+
+            /* A lost track is removed, the order of the others is kept */
+            if (p_Track->Missed > SPOT_TRACKER_LOST_FRAMES) {
+                continue;
+            }
+        }
+
+        if (Tracks != i) {
+            p_Tracker->Tracks[Tracks] = *p_Track;
+        }
+
+        Tracks++;
+    }
+
+    p_Tracker->Count = Tracks;
+
+    for (uint8_t j = 0; (j < Count) && (p_Tracker->Count < SPOT_TRACKER_MAX_SPOTS); j++) {
+        SpotTracker_Spot_t *p_Track;
+
+        if (isUsed[j]) {
+            continue;
+        }
+
+        p_Track = &p_Tracker->Tracks[p_Tracker->Count++];
+        *p_Track = p_Spots[j];
+        p_Track->Kind = Kind;
+        p_Track->Age = 1;
+
+        p_Track->ID = p_Tracker->NextID++;
+        if (p_Tracker->NextID == 0) {
+            p_Tracker->NextID = 1;
+        }
+    }
+}
+
+/** @brief              Update the alarm of a kind.
+ *  @param p_Tracker    Pointer to the tracker
+ *  @param Kind         Kind
+ *  @param Mask         0 for hot spots, 0xFFFF for cold spots
+ *  @param Sequence     Sequence number of the frame
+ *  @param p_Event      Pointer to store the event
+ *  @return             true if the alarm changed
+ */
+static bool SpotTracker_Alarm(SpotTracker_t *p_Tracker, SpotTracker_Kind_t Kind, uint16_t Mask, uint32_t Sequence,
+                              SpotTracker_Event_t *p_Event)
+{
+    const SpotTracker_Spot_t *p_Worst;
+    uint8_t Confirm;
+
+    Confirm = (p_Tracker->Config.Confirm > 0) ? p_Tracker->Config.Confirm : 1;
+
+    p_Worst = NULL;
+    if (p_Tracker->Config.Threshold[Kind] != 0) {
+        for (uint8_t i = 0; i < p_Tracker->Count; i++) {
+            const SpotTracker_Spot_t *p_Track = &p_Tracker->Tracks[i];
+
+            if ((p_Track->Kind != Kind) || (p_Track->Missed > 0) || (p_Track->Age < Confirm)) {
+                continue;
+            }
+
+            if ((p_Worst == NULL) || ((p_Track->Peak ^ Mask) > (p_Worst->Peak ^ Mask))) {
+                p_Worst = p_Track;
+            }
+        }
+    }
+
+    if (p_Tracker->isAlarm[Kind] == false) {
+        if (p_Worst == NULL) {
+            return false;
+        }
+
+        memset(p_Event, 0, sizeof(SpotTracker_Event_t));
+        p_Event->Type = SPOT_TRACKER_EVENT_RAISED;
+        p_Event->ID = p_Worst->ID;
+        p_Event->X = p_Worst->X;
+        p_Event->Y = p_Worst->Y;
+        p_Event->Peak = p_Worst->Peak;
+
+        p_Tracker->isAlarm[Kind] = true;
+        p_Tracker->Quiet[Kind] = 0;
+    } else {
+        if (p_Worst != NULL) {
+            p_Tracker->Quiet[Kind] = 0;
+
+            return false;
+        }
+
+        /* A disabled kind is cleared at once, a missing spot only after Clear frames */
+        if (p_Tracker->Config.Threshold[Kind] != 0) {
+            p_Tracker->Quiet[Kind]++;
+
+            if (p_Tracker->Quiet[Kind] < p_Tracker->Config.Clear) {
+                return false;
+            }
+        }
+
+        memset(p_Event, 0, sizeof(SpotTracker_Event_t));
+        p_Event->Type = SPOT_TRACKER_EVENT_CLEARED;
+
+        p_Tracker->isAlarm[Kind] = false;
+    }
+
+    p_Event->Number = p_Tracker->Last.Number + 1;
+    p_Event->Sequence = Sequence;
+    p_Event->Kind = Kind;
+    p_Tracker->Last = *p_Event;
+
+    return true;
+}
+
+esp_err_t SpotTracker_Init(SpotTracker_t *p_Tracker, uint16_t Width, uint16_t Height,
+                           const SpotTracker_Config_t *p_Config)
+{
+    if ((p_Tracker == NULL) || (p_Config == NULL) || (Width == 0) || (Height == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(p_Tracker, 0, sizeof(SpotTracker_t));
+
+    /* Written and read back within a frame for every run, so it is kept in the internal RAM */
+    p_Tracker->Runs = reinterpret_cast<SpotTracker_Run_t *>(MemoryPlan_Alloc(MEMORY_REGION_FAST,
+                                                                              SPOT_TRACKER_MAX_RUNS *
+                                                                              sizeof(SpotTracker_Run_t),
+                                                                              "spot_runs"));
+    if (p_Tracker->Runs == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate runs!");
+        return ESP_ERR_NO_MEM;
+    }
+
+    p_Tracker->Config = *p_Config;
+    p_Tracker->Width = Width;
+    p_Tracker->Height = Height;
+    p_Tracker->NextID = 1;
+
+    return ESP_OK;
+}
+
+void SpotTracker_Deinit(SpotTracker_t *p_Tracker)
+{
+    if ((p_Tracker == NULL) || (p_Tracker->Runs == NULL)) {
+        return;
+    }
+
+    MemoryPlan_Free(p_Tracker->Runs);
+    p_Tracker->Runs = NULL;
+    p_Tracker->Count = 0;
+}
+
+esp_err_t SpotTracker_SetThreshold(SpotTracker_t *p_Tracker, SpotTracker_Kind_t Kind, uint16_t Threshold)
+{
+    if ((p_Tracker == NULL) || (Kind >= SPOT_TRACKER_KIND_COUNT)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    p_Tracker->Config.Threshold[Kind] = Threshold;
+
+    return ESP_OK;
+}
+
+uint8_t SpotTracker_Process(SpotTracker_t *p_Tracker, const uint16_t *p_RAW, const FrameStatistics_t *p_Statistics,
+                            uint32_t Sequence, SpotTracker_Result_t *p_Result, SpotTracker_Event_t *p_Events)
+{
+    uint8_t Events;
+
+    if ((p_Tracker == NULL) || (p_Tracker->Runs == NULL) || (p_RAW == NULL) || (p_Statistics == NULL) ||
+        (p_Result == NULL) || (p_Events == NULL)) {
+        return 0;
+    }
+
+    Events = 0;
+    p_Result->isTruncated = false;
+
+    for (uint8_t Kind = 0; Kind < SPOT_TRACKER_KIND_COUNT; Kind++) {
+        SpotTracker_Spot_t Spots[SPOT_TRACKER_MAX_SPOTS];
+        uint16_t Mask = (Kind == SPOT_TRACKER_HOT) ? 0 : 0xFFFF;
+        uint16_t Threshold = p_Tracker->Config.Threshold[Kind];
+        uint8_t Count = 0;
+
+        if (Threshold != 0) {
+            uint16_t Extreme = (Kind == SPOT_TRACKER_HOT) ? p_Statistics->Max : p_Statistics->Min;
+
+            /* The raised alarm holds on to a spot that cools down (warms up) a little */
+            Threshold ^= Mask;
+            if (p_Tracker->isAlarm[Kind]) {
+                Threshold = (Threshold > p_Tracker->Config.Hysteresis) ? (Threshold - p_Tracker->Config.Hysteresis) :
+                            1;
+            }
+
+            /* No pixel can reach the threshold, the frame is not read */
+            if ((Extreme ^ Mask) >= Threshold) {
+                p_Result->isTruncated |= SpotTracker_Label(p_Tracker, p_RAW, Threshold, Mask, Spots, &Count);
+
+                for (uint8_t i = 0; i < Count; i++) {
+                    Spots[i].Peak ^= Mask;
+                }
+            }
+        }
+
+        SpotTracker_Track(p_Tracker, static_cast<SpotTracker_Kind_t>(Kind), Spots, Count);
+
+        if (SpotTracker_Alarm(p_Tracker, static_cast<SpotTracker_Kind_t>(Kind), Mask, Sequence, &p_Events[Events])) {
+            Events++;
+        }
+
+        p_Result->isAlarm[Kind] = p_Tracker->isAlarm[Kind];
+    }
+
+    p_Result->Sequence = Sequence;
+    p_Result->Count = p_Tracker->Count;
+    memcpy(p_Result->Spots, p_Tracker->Tracks, p_Tracker->Count * sizeof(SpotTracker_Spot_t));
+    p_Result->Last = p_Tracker->Last;
+
+    return Events;
+}
@@ -0,0 +1,193 @@
+/*
+ * spotTracker.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Hot and cold spot detection, tracking and alarms on RAW14 frames.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef SPOT_TRACKER_H_
+#define SPOT_TRACKER_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "frameStatistics.h"
+
+/** @brief Maximum number of tracked spots of all kinds.
+ */
+#define SPOT_TRACKER_MAX_SPOTS                  8
+
+/** @brief Maximum number of pixel runs per kind and frame. A frame with more runs is labelled up to this limit, so
+ *         the time per frame is bounded.
+ */
+#define SPOT_TRACKER_MAX_RUNS                   256
+
+/** @brief Largest movement of a spot between two frames in pixels that keeps its ID.
+ */
+#define SPOT_TRACKER_GATE                       16
+
+/** @brief Number of frames a spot is kept after it was seen the last time.
+ */
+#define SPOT_TRACKER_LOST_FRAMES                3
+
+/** @brief Kind of a spot.
+ */
+typedef enum {
+    SPOT_TRACKER_HOT = 0,                       /**< Pixels above the hot threshold. */
+    SPOT_TRACKER_COLD,                          /**< Pixels below the cold threshold. */
+    SPOT_TRACKER_KIND_COUNT,
+} SpotTracker_Kind_t;
+
+/** @brief Alarm event type.
+ */
+typedef enum {
+    SPOT_TRACKER_EVENT_RAISED = 0,              /**< A spot was seen for Confirm frames. */
+    SPOT_TRACKER_EVENT_CLEARED,                 /**< No confirmed spot was seen for Clear frames. */
+} SpotTracker_EventType_t;
+
+/** @brief Tracker parameters. All temperatures are raw counts (centi-Kelvin in radiometric mode).
+ */
+typedef struct {
+    uint16_t Threshold[SPOT_TRACKER_KIND_COUNT];    /**< Threshold per kind, 0 disables the kind. */
+    uint16_t Hysteresis;                        /**< The threshold moves back by this value while the alarm of
+                                                     its kind is raised. */
+    uint16_t MinArea;                           /**< Smallest spot in pixels. */
+    uint8_t Confirm;                            /**< Frames a spot has to be seen before it raises the alarm. */
+    uint8_t Clear;                              /**< Frames without a confirmed spot before the alarm is cleared. */
+} SpotTracker_Config_t;
+
+/** @brief Tracked spot.
+ */
+typedef struct {
+    uint16_t ID;                                /**< Unique since the initialization, never 0. */
+    uint8_t Kind;                               /**< SpotTracker_Kind_t. */
+    uint8_t Age;                                /**< Number of frames the spot was seen, saturates at 255. */
+    uint16_t X;                                 /**< Column of the hottest (coldest) pixel. */
+    uint16_t Y;                                 /**< Row of the hottest (coldest) pixel. */
+    uint16_t CenterX;                           /**< Centroid column. */
+    uint16_t CenterY;                           /**< Centroid row. */
+    uint16_t Left;                              /**< Bounding box, inclusive. */
+    uint16_t Top;
+    uint16_t Right;
+    uint16_t Bottom;
+    uint16_t Area;                              /**< Number of pixels. */
+    uint16_t Peak;                              /**< Highest (hot) or lowest (cold) value. */
+    uint8_t Missed;                             /**< Frames since the spot was seen the last time. */
+} SpotTracker_Spot_t;
+
+/** @brief Alarm event.
+ */
+typedef struct {
+    uint32_t Number;                            /**< Number of the event since the initialization, starts with 1. */
+    uint32_t Sequence;                          /**< Frame of the event. */
+    uint8_t Type;                               /**< SpotTracker_EventType_t. */
+    uint8_t Kind;                               /**< SpotTracker_Kind_t. */
+    uint16_t ID;                                /**< Spot that raised the alarm, 0 for a cleared alarm. */
+    uint16_t X;                                 /**< Position of the peak of the spot. */
+    uint16_t Y;
+    uint16_t Peak;                              /**< Peak of the spot. */
+} SpotTracker_Event_t;
+
+/** @brief Result of a frame.
+ */
+typedef struct {
+    uint32_t Sequence;                          /**< Frame of the result. */
+    bool isAlarm[SPOT_TRACKER_KIND_COUNT];      /**< Alarm state per kind. */
+    bool isTruncated;                           /**< The run limit was reached, spots can be missing. */
+    uint8_t Count;                              /**< Number of spots, the oldest first. */
+    SpotTracker_Spot_t Spots[SPOT_TRACKER_MAX_SPOTS];
+    SpotTracker_Event_t Last;                   /**< Newest event, Number is 0 if there was none. */
+} SpotTracker_Result_t;
+
+/** @brief Pixel run of a row. The runs of a frame are labelled with a union find, the root run of a spot
+ *         accumulates the spot.
+ */
+typedef struct {
+    uint16_t Parent;                            /**< Index of the parent run, equal to the own index for a root. */
+    uint16_t Row;
+    uint16_t Start;                             /**< First column. */
+    uint16_t End;                               /**< Last column. */
+    uint16_t Peak;
+    uint16_t PeakX;
+    uint16_t PeakY;
+    uint16_t Area;
+    uint16_t Top;
+    uint16_t Bottom;
+    uint32_t SumX;                              /**< Sum of the columns of all pixels. */
+    uint32_t SumY;                              /**< Sum of the rows of all pixels. */
+} SpotTracker_Run_t;
+
+/** @brief Tracker state.
+ */
+typedef struct {
+    SpotTracker_Config_t Config;
+    uint16_t Width;
+    uint16_t Height;
+    uint16_t NextID;
+    uint8_t Count;                              /**< Number of tracks. */
+    bool isAlarm[SPOT_TRACKER_KIND_COUNT];
+    uint8_t Quiet[SPOT_TRACKER_KIND_COUNT];     /**< Frames without a confirmed spot while the alarm is raised. */
+    SpotTracker_Event_t Last;
+    SpotTracker_Spot_t Tracks[SPOT_TRACKER_MAX_SPOTS];  /**< Oldest track first. */
+    SpotTracker_Run_t *Runs;                    /**< SPOT_TRACKER_MAX_RUNS runs. */
+} SpotTracker_t;
+
+/** @brief              Allocate the tracker.
+ *  @param p_Tracker    Pointer to the tracker
+ *  @param Width        Frame width in pixels
+ *  @param Height       Frame height in pixels
+ *  @param p_Config     Parameters
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if a parameter is invalid
+ *                      ESP_ERR_NO_MEM if the runs can not be allocated
+ */
+esp_err_t SpotTracker_Init(SpotTracker_t *p_Tracker, uint16_t Width, uint16_t Height,
+                           const SpotTracker_Config_t *p_Config);
+
+/** @brief              Free the tracker.
+ *  @param p_Tracker    Pointer to the tracker
+ */
+void SpotTracker_Deinit(SpotTracker_t *p_Tracker);
+
+/** @brief              Change the threshold of a kind. The tracks and the alarm of the kind are kept, a disabled
+ *                      kind clears its alarm with the next frame.
+ *  @param p_Tracker    Pointer to the tracker
+ *  @param Kind         Kind
+ *  @param Threshold    Threshold in raw counts, 0 to disable the kind
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if a parameter is invalid
+ */
+esp_err_t SpotTracker_SetThreshold(SpotTracker_t *p_Tracker, SpotTracker_Kind_t Kind, uint16_t Threshold);
+
+/** @brief              Detect the spots of a frame, track them and update the alarms. A kind whose threshold is
+ *                      outside the range of the frame statistics does not read the pixels.
+ *  @param p_Tracker    Pointer to the tracker
+ *  @param p_RAW        RAW14 frame
+ *  @param p_Statistics Statistics of the frame
+ *  @param Sequence     Sequence number of the frame
+ *  @param p_Result     Pointer to store the result
+ *  @param p_Events     SPOT_TRACKER_KIND_COUNT events to store the alarm changes of the frame
+ *  @return             Number of events
+ */
+uint8_t SpotTracker_Process(SpotTracker_t *p_Tracker, const uint16_t *p_RAW, const FrameStatistics_t *p_Statistics,
+                            uint32_t Sequence, SpotTracker_Result_t *p_Result, SpotTracker_Event_t *p_Events);
+
+#endif /* SPOT_TRACKER_H_ */
@@ -33,6 +33,8 @@
 #include <string.h>
 
 #include "networkTask.h"
+#include "Application/Boot/boot.h"
+#include "Application/Topology/topology.h"
 #include "Application/Manager/managers.h"
 #include "Application/Tasks/GUI/guiTask.h"
 
@@ -45,13 +47,23 @@
 #define NETWORK_TASK_PROV_TIMEOUT               BIT6
 #define NETWORK_TASK_SNTP_TIMEZONE_SET          BIT7
 #define NETWORK_TASK_WIFI_CREDENTIALS_UPDATED   BIT8
+#define NETWORK_TASK_APP_STARTED                BIT9
+
+/* Requests that wake up the task loop. NETWORK_TASK_APP_STARTED stays set and must not be part of it */
+#define NETWORK_TASK_REQUESTS                   (NETWORK_TASK_STOP_REQUEST | NETWORK_TASK_PROV_SUCCESS | \
+                                                 NETWORK_TASK_WIFI_CONNECTED | NETWORK_TASK_WIFI_DISCONNECTED | \
+                                                 NETWORK_TASK_OPEN_WIFI_REQUEST | NETWORK_TASK_PROV_TIMEOUT | \
+                                                 NETWORK_TASK_SNTP_TIMEZONE_SET | \
+                                                 NETWORK_TASK_WIFI_CREDENTIALS_UPDATED)
+
+/* Longest time the task sleeps without a request, so the task watchdog is fed */
+#define NETWORK_TASK_IDLE_MS                    1000
 
 typedef struct {
     bool isInitialized;
     bool isConnected;
     bool Running;
     bool RunTask;
-    bool ApplicationStarted;
     TaskHandle_t TaskHandle;
     EventGroupHandle_t EventGroup;
     uint32_t StartTime;
@@ -167,7 +179,7 @@ static void on_GUI_Event_Handler(void *p_HandlerArgs, esp_event_base_t Base, int
         case GUI_EVENT_APP_STARTED: {
             ESP_LOGD(TAG, "Application started event received");
 
-            _NetworkTask_State.ApplicationStarted = true;
+            xEventGroupSetBits(_NetworkTask_State.EventGroup, NETWORK_TASK_APP_STARTED);
 
             break;
         }
@@ -183,14 +195,15 @@ static void on_GUI_Event_Handler(void *p_HandlerArgs, esp_event_base_t Base, int
 static void Task_Network(void *p_Parameters)
 {
     App_Settings_WiFi_t WiFiSettings;
+    uint32_t Wait;
 
     esp_task_wdt_add(NULL);
 
     ESP_LOGD(TAG, "Network task started on core %d", xPortGetCoreID());
 
-    while (_NetworkTask_State.ApplicationStarted == false) {
+    while ((xEventGroupWaitBits(_NetworkTask_State.EventGroup, NETWORK_TASK_APP_STARTED, pdFALSE, pdFALSE,
+                                NETWORK_TASK_IDLE_MS / portTICK_PERIOD_MS) & NETWORK_TASK_APP_STARTED) == 0) {
         esp_task_wdt_reset();
-        vTaskDelay(100 / portTICK_PERIOD_MS);
     }
 
     SettingsManager_GetWiFi(&WiFiSettings);
@@ -217,13 +230,18 @@ static void Task_Network(void *p_Parameters)
         _NetworkTask_State.State = NETWORK_STATE_IDLE;
     }
 
+    Wait = 0;
+
     _NetworkTask_State.RunTask = true;
     while (_NetworkTask_State.RunTask) {
         EventBits_t EventBits;
 
         esp_task_wdt_reset();
 
-        EventBits = xEventGroupGetBits(_NetworkTask_State.EventGroup);
+        /* Sleep until a request arrives or the power profile is due. The bits are cleared when they are handled.
+           The wait is rounded up to full ticks, so a short deadline does not end in a busy loop */
+        EventBits = xEventGroupWaitBits(_NetworkTask_State.EventGroup, NETWORK_TASK_REQUESTS, pdFALSE, pdFALSE,
+                                        (Wait + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS);
         if (EventBits & NETWORK_TASK_STOP_REQUEST) {
             ESP_LOGD(TAG, "Stop request received");
 
@@ -245,6 +263,7 @@ static void Task_Network(void *p_Parameters)
             if (NetworkManager_StartServer(&_NetworkTask_State.AppContext->Server_Config) == ESP_OK) {
                 ESP_LOGD(TAG, "HTTP/WebSocket server started on port %d",
                          _NetworkTask_State.AppContext->Server_Config.HTTP_Server.Port);
+                Boot_Mark(BOOT_PHASE_SERVER);
                 esp_event_post(NETWORK_EVENTS, NETWORK_EVENT_SERVER_STARTED, NULL, 0, portMAX_DELAY);
             } else {
                 ESP_LOGE(TAG, "Failed to start HTTP/WebSocket server");
@@ -303,7 +322,6 @@ static void Task_Network(void *p_Parameters)
             TimeManager_SetTimezone(SystemSettings.Timezone);
 
             SettingsManager_UpdateSystem(&SystemSettings);
-            SettingsManager_Save();
 
             xEventGroupClearBits(_NetworkTask_State.EventGroup, NETWORK_TASK_SNTP_TIMEZONE_SET);
         } else if (EventBits & NETWORK_TASK_OPEN_WIFI_REQUEST) {
@@ -335,12 +353,14 @@ static void Task_Network(void *p_Parameters)
             memcpy(WiFiSettings.Password, _NetworkTask_State.Password, sizeof(WiFiSettings.Password));
 
             SettingsManager_UpdateWiFi(&WiFiSettings);
-            SettingsManager_Save();
 
             xEventGroupClearBits(_NetworkTask_State.EventGroup, NETWORK_TASK_WIFI_CREDENTIALS_UPDATED);
         }
 
-        vTaskDelay(10 / portTICK_PERIOD_MS);
+        Wait = NetworkManager_UpdatePowerProfile();
+        if (Wait > NETWORK_TASK_IDLE_MS) {
+            Wait = NETWORK_TASK_IDLE_MS;
+        }
     }
 
     ESP_LOGD(TAG, "Network task shutting down");
@@ -357,9 +377,7 @@ static void Task_Network(void *p_Parameters)
 esp_err_t Network_Task_Init(App_Context_t *p_AppContext)
 {
     esp_err_t Error;
-    App_Settings_WiFi_t WiFiSettings;
-    App_Settings_Provisioning_t ProvisioningSettings;
-    App_Settings_VISA_Server_t VISASettings;
+    const App_Settings_t *p_Settings;
 
     if (p_AppContext == NULL) {
         return ESP_ERR_INVALID_ARG;
@@ -400,25 +418,33 @@ esp_err_t Network_Task_Init(App_Context_t *p_AppContext)
         return Error;
     }
 
-    /* Copy the required WiFi settings from settings to network config */
-    SettingsManager_GetWiFi(&WiFiSettings);
-    strncpy(_NetworkTask_State.AppContext->STA_Config.Credentials.SSID, WiFiSettings.SSID,
+    /* Copy the required settings from one consistent settings snapshot to the network config */
+    p_Settings = SettingsManager_Acquire(NULL);
+    if (p_Settings == NULL) {
+        ESP_LOGE(TAG, "Settings not available!");
+
+        esp_event_handler_unregister(NETWORK_EVENTS, ESP_EVENT_ANY_ID, on_Network_Event_Handler);
+        esp_event_handler_unregister(GUI_EVENTS, ESP_EVENT_ANY_ID, on_GUI_Event_Handler);
+        vEventGroupDelete(_NetworkTask_State.EventGroup);
+
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    strncpy(_NetworkTask_State.AppContext->STA_Config.Credentials.SSID, p_Settings->WiFi.SSID,
             sizeof(_NetworkTask_State.AppContext->STA_Config.Credentials.SSID) - 1);
-    strncpy(_NetworkTask_State.AppContext->STA_Config.Credentials.Password, WiFiSettings.Password,
+    strncpy(_NetworkTask_State.AppContext->STA_Config.Credentials.Password, p_Settings->WiFi.Password,
             sizeof(_NetworkTask_State.AppContext->STA_Config.Credentials.Password) - 1);
-    _NetworkTask_State.AppContext->STA_Config.MaxRetries = WiFiSettings.MaxRetries;
-    _NetworkTask_State.AppContext->STA_Config.RetryInterval = WiFiSettings.RetryInterval;
+    _NetworkTask_State.AppContext->STA_Config.MaxRetries = p_Settings->WiFi.MaxRetries;
+    _NetworkTask_State.AppContext->STA_Config.RetryInterval = p_Settings->WiFi.RetryInterval;
 
-    /* Copy the required VISA settings from settings to network config */
-    SettingsManager_GetVISAServer(&VISASettings);
-    _NetworkTask_State.AppContext->Server_Config.VISA_Server.Port = VISASettings.Port;
+    _NetworkTask_State.AppContext->Server_Config.VISA_Server.Port = p_Settings->VISAServer.Port;
 
-    /* Copy the required Provisioning settings from settings to network config */
-    SettingsManager_GetProvisioning(&ProvisioningSettings);
     strncpy(_NetworkTask_State.AppContext->Prov_Config.Name,
-            ProvisioningSettings.Name,
+            p_Settings->Provisioning.Name,
             sizeof(_NetworkTask_State.AppContext->Prov_Config.Name) - 1);
-    _NetworkTask_State.AppContext->Prov_Config.Timeout = ProvisioningSettings.Timeout;
+    _NetworkTask_State.AppContext->Prov_Config.Timeout = p_Settings->Provisioning.Timeout;
+
+    SettingsManager_Release(p_Settings);
 
     Error = NetworkManager_Init(&_NetworkTask_State.AppContext->STA_Config);
     if (Error != ESP_OK) {
@@ -471,7 +497,7 @@ void Network_Task_Deinit(void)
 
 esp_err_t Network_Task_Start(void)
 {
-    BaseType_t Ret;
+    esp_err_t Error;
 
     if (_NetworkTask_State.isInitialized == false) {
         return ESP_ERR_INVALID_STATE;
@@ -481,19 +507,10 @@ esp_err_t Network_Task_Start(void)
     }
 
     ESP_LOGD(TAG, "Starting Network Task");
-    Ret = xTaskCreatePinnedToCore(
-              Task_Network,
-              "Task_Network",
-              CONFIG_NETWORK_TASK_STACKSIZE,
-              NULL,
-              CONFIG_NETWORK_TASK_PRIO,
-              &_NetworkTask_State.TaskHandle,
-              CONFIG_NETWORK_TASK_CORE
-          );
-
-    if (Ret != pdPASS) {
+    Error = Topology_CreateTask(TOPOLOGY_TASK_NETWORK, Task_Network, NULL, &_NetworkTask_State.TaskHandle);
+    if (Error != ESP_OK) {
         ESP_LOGE(TAG, "Failed to create network task!");
-        return ESP_ERR_NO_MEM;
+        return Error;
     }
 
     _NetworkTask_State.Running = true;
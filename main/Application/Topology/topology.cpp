@@ -0,0 +1,210 @@
+/*
+ * topology.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Task topology with the core, the priority and the stack of the long lived application tasks.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <esp_log.h>
+
+#include <cstdio>
+
+#include <sdkconfig.h>
+
+#include "topology.h"
+#include "Application/Manager/Settings/settingsManager.h"
+
+/** @brief Smallest stack of a settings override in bytes. Smaller values are ignored.
+ */
+#define TOPOLOGY_MIN_STACKSIZE              2048
+
+/** @brief Kconfig defaults of a task. A core below 0 does not pin the task.
+ */
+typedef struct {
+    const char *Name;
+    int Core;
+    UBaseType_t Priority;
+    uint32_t StackSize;
+} Topology_Default_t;
+
+/** @brief Defaults in the order of Topology_Task_t. The names are the task names, so the report finds the tasks.
+ */
+static const Topology_Default_t _Topology_Defaults[TOPOLOGY_TASK_COUNT] = {
+    {"Task_Lepton",     CONFIG_LEPTON_TASK_CORE,            CONFIG_LEPTON_TASK_PRIO,
+     CONFIG_LEPTON_TASK_STACKSIZE},
+    {"Task_GUI",        CONFIG_GUI_TASK_CORE,               CONFIG_GUI_TASK_PRIO,
+     CONFIG_GUI_TASK_STACKSIZE},
+    {"Task_Network",    CONFIG_NETWORK_TASK_CORE,           CONFIG_NETWORK_TASK_PRIO,
+     CONFIG_NETWORK_TASK_STACKSIZE},
+    {"Task_Devices",    CONFIG_DEVICES_TASK_CORE,           CONFIG_DEVICES_TASK_PRIO,
+     CONFIG_DEVICES_TASK_STACKSIZE},
+    {"WS_Broadcast",    CONFIG_NETWORK_WS_TASK_CORE,        CONFIG_NETWORK_WS_TASK_PRIO,
+     CONFIG_NETWORK_WS_TASK_STACKSIZE},
+#ifdef CONFIG_NETWORK_ENCODER_PIPELINE
+    {"WS_Encode",       CONFIG_NETWORK_ENCODER_TASK_CORE,   CONFIG_NETWORK_ENCODER_TASK_PRIO,
+     CONFIG_NETWORK_ENCODER_TASK_STACKSIZE},
+#else
+    /* Not created, the broadcast task encodes the frames itself */
+    {"WS_Encode",       -1,                                 0,                                  0},
+#endif
+    {"visa_server",     CONFIG_NETWORK_VISA_TASK_CORE,      CONFIG_NETWORK_VISA_TASK_PRIO,
+     CONFIG_NETWORK_VISA_TASK_STACKSIZE},
+    {"DNS_Server",      CONFIG_NETWORK_DNS_TASK_CORE,       CONFIG_NETWORK_DNS_TASK_PRIO,
+     CONFIG_NETWORK_DNS_TASK_STACKSIZE},
+    {"HTTP_Wait",       CONFIG_NETWORK_HTTP_WAIT_TASK_CORE, CONFIG_NETWORK_HTTP_WAIT_TASK_PRIO,
+     CONFIG_NETWORK_HTTP_WAIT_TASK_STACKSIZE},
+    {"HTTP_Stream",     CONFIG_NETWORK_HTTP_STREAM_TASK_CORE,   CONFIG_NETWORK_HTTP_STREAM_TASK_PRIO,
+     CONFIG_NETWORK_HTTP_STREAM_TASK_STACKSIZE},
+    {"HTTP_Download",   CONFIG_NETWORK_DOWNLOAD_SEND_TASK_CORE, CONFIG_NETWORK_DOWNLOAD_SEND_TASK_PRIO,
+     CONFIG_NETWORK_DOWNLOAD_SEND_TASK_STACKSIZE},
+    {"SD_TimeLapse",    CONFIG_SD_TIMELAPSE_TASK_CORE,      CONFIG_SD_TIMELAPSE_TASK_PRIO,
+     CONFIG_SD_TIMELAPSE_TASK_STACKSIZE},
+};
+
+static_assert(TOPOLOGY_TASK_COUNT <= SETTINGS_TASKS_MAX, "Tasks settings section too small for the topology!");
+
+static const char *TAG = "topology";
+
+/** @brief          Replace the defaults of a layout by the values of a settings override that are set and valid.
+ *  @param Task     Task
+ *  @param p_Layout Layout with the defaults
+ */
+static void Topology_ApplySettings(Topology_Task_t Task, Topology_Layout_t *p_Layout)
+{
+#ifdef CONFIG_TOPOLOGY_SETTINGS
+    const App_Settings_t *p_Settings;
+    App_Settings_Task_t Override;
+
+    /* Without settings, e.g. in the wake up of a time-lapse, the tasks run with the defaults */
+    p_Settings = SettingsManager_Acquire(NULL);
+    if (p_Settings == NULL) {
+        return;
+    }
+
+    Override = p_Settings->Tasks.Task[Task];
+    SettingsManager_Release(p_Settings);
+
+    if (Override.Core == SETTINGS_TASK_CORE_ANY) {
+        p_Layout->Core = tskNO_AFFINITY;
+        p_Layout->isOverridden = true;
+    } else if ((Override.Core != SETTINGS_TASK_DEFAULT) && (Override.Core <= portNUM_PROCESSORS)) {
+        p_Layout->Core = Override.Core - 1;
+        p_Layout->isOverridden = true;
+    } else if (Override.Core != SETTINGS_TASK_DEFAULT) {
+        ESP_LOGW(TAG, "Invalid core %u of %s ignored!", Override.Core, p_Layout->Name);
+    }
+
+    if ((Override.Priority != SETTINGS_TASK_DEFAULT) && (Override.Priority < configMAX_PRIORITIES)) {
+        p_Layout->Priority = Override.Priority;
+        p_Layout->isOverridden = true;
+    } else if (Override.Priority != SETTINGS_TASK_DEFAULT) {
+        ESP_LOGW(TAG, "Invalid priority %u of %s ignored!", Override.Priority, p_Layout->Name);
+    }
+
+    if (Override.StackSize >= TOPOLOGY_MIN_STACKSIZE) {
+        p_Layout->StackSize = Override.StackSize;
+        p_Layout->isOverridden = true;
+    } else if (Override.StackSize != SETTINGS_TASK_DEFAULT) {
+        ESP_LOGW(TAG, "Stack of %u bytes for %s ignored!", Override.StackSize, p_Layout->Name);
+    }
+#endif
+}
+
+esp_err_t Topology_GetLayout(Topology_Task_t Task, Topology_Layout_t *p_Layout)
+{
+    const Topology_Default_t *p_Default;
+
+    if ((Task >= TOPOLOGY_TASK_COUNT) || (p_Layout == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    p_Default = &_Topology_Defaults[Task];
+
+    p_Layout->Name = p_Default->Name;
+    p_Layout->Core = (p_Default->Core < 0) ? tskNO_AFFINITY : p_Default->Core;
+    p_Layout->Priority = p_Default->Priority;
+    p_Layout->StackSize = p_Default->StackSize;
+    p_Layout->isOverridden = false;
+
+    Topology_ApplySettings(Task, p_Layout);
+
+    return ESP_OK;
+}
+
+esp_err_t Topology_CreateTask(Topology_Task_t Task, TaskFunction_t Function, void *p_Param, TaskHandle_t *p_Handle)
+{
+    Topology_Layout_t Layout;
+
+    if ((Function == NULL) || (Topology_GetLayout(Task, &Layout) != ESP_OK)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (xTaskCreatePinnedToCore(Function, Layout.Name, Layout.StackSize, p_Param, Layout.Priority, p_Handle,
+                                Layout.Core) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create %s with %lu bytes stack!", Layout.Name,
+                 static_cast<unsigned long>(Layout.StackSize));
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGD(TAG, "%s created on core %d with priority %u", Layout.Name,
+             (Layout.Core == tskNO_AFFINITY) ? -1 : static_cast<int>(Layout.Core),
+             static_cast<unsigned int>(Layout.Priority));
+
+    return ESP_OK;
+}
+
+const char *Topology_GetName(Topology_Task_t Task)
+{
+    return (Task < TOPOLOGY_TASK_COUNT) ? _Topology_Defaults[Task].Name : "unknown";
+}
+
+void Topology_Report(void)
+{
+    ESP_LOGI(TAG, "Task topology:");
+
+    for (uint8_t i = 0; i < TOPOLOGY_TASK_COUNT; i++) {
+        Topology_Layout_t Layout;
+        TaskHandle_t Handle;
+        char Core[8];
+
+        Topology_GetLayout(static_cast<Topology_Task_t>(i), &Layout);
+
+        if (Layout.Core == tskNO_AFFINITY) {
+            snprintf(Core, sizeof(Core), "any");
+        } else {
+            snprintf(Core, sizeof(Core), "%d", static_cast<int>(Layout.Core));
+        }
+
+        /* The network servers are started later by the network task */
+        Handle = xTaskGetHandle(Layout.Name);
+        if (Handle == NULL) {
+            ESP_LOGI(TAG, "  %-16s core %-3s prio %2u stack %6lu%s, not running", Layout.Name, Core,
+                     static_cast<unsigned int>(Layout.Priority), static_cast<unsigned long>(Layout.StackSize),
+                     Layout.isOverridden ? " (settings)" : "");
+
+            continue;
+        }
+
+        ESP_LOGI(TAG, "  %-16s core %-3s prio %2u stack %6lu%s, %lu bytes free", Layout.Name, Core,
+                 static_cast<unsigned int>(Layout.Priority), static_cast<unsigned long>(Layout.StackSize),
+                 Layout.isOverridden ? " (settings)" : "",
+                 static_cast<unsigned long>(uxTaskGetStackHighWaterMark(Handle) * sizeof(StackType_t)));
+    }
+}
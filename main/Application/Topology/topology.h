@@ -0,0 +1,94 @@
+/*
+ * topology.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Task topology with the core, the priority and the stack of the long lived application tasks.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef TOPOLOGY_H_
+#define TOPOLOGY_H_
+
+#include <esp_err.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Tasks of the topology. The order is the index of the task in the tasks settings section, so new tasks are
+ *         only appended.
+ */
+typedef enum {
+    TOPOLOGY_TASK_LEPTON = 0,                   /**< VoSPI capture and frame processing. */
+    TOPOLOGY_TASK_GUI,                          /**< LVGL and the display. */
+    TOPOLOGY_TASK_NETWORK,                      /**< WiFi, provisioning and the servers. */
+    TOPOLOGY_TASK_DEVICES,                      /**< Battery, sensors and the other devices. */
+    TOPOLOGY_TASK_WS_BROADCAST,                 /**< WebSocket frame and telemetry broadcast. */
+    TOPOLOGY_TASK_WS_ENCODE,                    /**< Pipelined encoding of the WebSocket stream. */
+    TOPOLOGY_TASK_VISA,                         /**< VISA / SCPI server. */
+    TOPOLOGY_TASK_DNS,                          /**< Captive portal DNS server. */
+    TOPOLOGY_TASK_HTTP_WAIT,                    /**< Long polls of the image endpoint. */
+    TOPOLOGY_TASK_HTTP_STREAM,                  /**< MJPEG multipart streams, one task per stream. */
+    TOPOLOGY_TASK_HTTP_DOWNLOAD,                /**< SD card file downloads, one task per download. */
+    TOPOLOGY_TASK_TIMELAPSE,                    /**< Start of a time-lapse. */
+    TOPOLOGY_TASK_COUNT,
+} Topology_Task_t;
+
+/** @brief Layout of a task.
+ */
+typedef struct {
+    const char *Name;                           /**< Task name. */
+    BaseType_t Core;                            /**< Core of the task, tskNO_AFFINITY if it is not pinned. */
+    UBaseType_t Priority;                       /**< Task priority. */
+    uint32_t StackSize;                         /**< Stack size in bytes. */
+    bool isOverridden;                          /**< At least one value comes from the settings. */
+} Topology_Layout_t;
+
+/** @brief          Get the layout of a task. The Kconfig defaults are replaced by the values of the tasks settings
+ *                  section that are not 0, so the settings must be loaded before the task is created.
+ *  @param Task     Task
+ *  @param p_Layout Pointer to store the layout
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if Task is invalid or p_Layout is NULL
+ */
+esp_err_t Topology_GetLayout(Topology_Task_t Task, Topology_Layout_t *p_Layout);
+
+/** @brief              Create a task with its layout from Topology_GetLayout.
+ *  @param Task         Task
+ *  @param Function     Task function
+ *  @param p_Param      Parameter of the task function
+ *  @param p_Handle     Pointer to store the task handle. Can be NULL.
+ *  @return             ESP_OK on success
+ *                      ESP_ERR_INVALID_ARG if Task is invalid or Function is NULL
+ *                      ESP_ERR_NO_MEM if the task can not be created
+ */
+esp_err_t Topology_CreateTask(Topology_Task_t Task, TaskFunction_t Function, void *p_Param, TaskHandle_t *p_Handle);
+
+/** @brief          Get the name of a task.
+ *  @param Task     Task
+ *  @return         Task name or "unknown"
+ */
+const char *Topology_GetName(Topology_Task_t Task);
+
+/** @brief Log the layout of every task with the free stack of the tasks that are running.
+ */
+void Topology_Report(void);
+
+#endif /* TOPOLOGY_H_ */
@@ -0,0 +1,358 @@
+/*
+ * trace.cpp
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Lock-free event trace ring with a Chrome trace export.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#include <sdkconfig.h>
+
+#ifdef CONFIG_TRACE
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <esp_cpu.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "trace.h"
+
+static_assert((CONFIG_TRACE_RECORDS & (CONFIG_TRACE_RECORDS - 1)) == 0, "CONFIG_TRACE_RECORDS must be a power of two!");
+
+/** @brief Maximum number of task names of an export.
+ */
+#define TRACE_MAX_TASKS                     48
+
+/** @brief Size of the buffer for the parts of an export.
+ */
+#define TRACE_EXPORT_CHUNK                  1024
+
+/** @brief Record of the trace ring.
+ */
+typedef struct {
+    uint32_t Sequence;                          /**< Ring index + 1, written last. 0 while the slot is written. */
+    uint32_t Timestamp;                         /**< Time since boot in us (lower 32 bits). */
+    uint32_t Task;                              /**< Handle of the recording task. */
+    uint16_t Arg;
+    uint8_t Event;                              /**< Trace_Event_t */
+    uint8_t Info;                               /**< Trace_Phase_t in bits 1..7, core in bit 0. */
+} Trace_Entry_t;
+
+static_assert(sizeof(Trace_Entry_t) == 16, "Trace_Entry_t must be 16 bytes!");
+
+/** @brief Name of a task of an export.
+ */
+typedef struct {
+    uint32_t Handle;
+    char Name[configMAX_TASK_NAME_LEN];
+} Trace_Task_t;
+
+typedef struct {
+    Trace_Entry_t *Ring;                        /**< Ring in the PSRAM, NULL until Trace_Init. */
+    uint32_t Head;                              /**< Index of the next record, only changed atomically. */
+    SemaphoreHandle_t Mutex;                    /**< Protects the copy. */
+    Trace_Entry_t *Copy;                        /**< Copy of the last trigger. */
+    uint32_t CopyCount;                         /**< Records in Copy, oldest first. */
+    int64_t CopyTime;                           /**< Time of the trigger in us. */
+    uint8_t TaskCount;
+    Trace_Task_t Tasks[TRACE_MAX_TASKS];        /**< Names of the tasks that were alive at the trigger. */
+} Trace_State_t;
+
+static Trace_State_t _Trace_State;
+
+static const char *_Trace_EventNames[TRACE_EVENT_COUNT] = {
+    "capture",
+    "cci",
+    "scale",
+    "encode",
+    "ws_send",
+    "sd_write",
+    "lvgl_render",
+    "lvgl_flush",
+};
+
+/* Chrome trace event phases of Trace_Phase_t */
+static const char _Trace_Phases[] = {'B', 'E', 'b', 'e', 'i'};
+
+static const char *TAG = "trace";
+
+/** @brief Collect the names of the live tasks. The handles of deleted tasks must not be dereferenced, so names
+ *         are only taken from the task list of the kernel.
+ */
+static void Trace_CollectTasks(void)
+{
+    _Trace_State.TaskCount = 0;
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+    TaskStatus_t *Status;
+    UBaseType_t Capacity;
+    UBaseType_t Count;
+
+    Capacity = uxTaskGetNumberOfTasks() + 4;
+    Status = reinterpret_cast<TaskStatus_t *>(malloc(Capacity * sizeof(TaskStatus_t)));
+    if (Status == NULL) {
+        return;
+    }
+
+    Count = uxTaskGetSystemState(Status, Capacity, NULL);
+    for (UBaseType_t i = 0; (i < Count) && (_Trace_State.TaskCount < TRACE_MAX_TASKS); i++) {
+        Trace_Task_t *Task = &_Trace_State.Tasks[_Trace_State.TaskCount++];
+
+        Task->Handle = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(Status[i].xHandle));
+        strncpy(Task->Name, Status[i].pcTaskName, sizeof(Task->Name) - 1);
+        Task->Name[sizeof(Task->Name) - 1] = '\0';
+
+        /* The name is copied into JSON without escaping */
+        for (char *p = Task->Name; *p != '\0'; p++) {
+            *p = ((*p == '"') || (*p == '\\') || (*p < ' ')) ? '_' : *p;
+        }
+    }
+
+    free(Status);
+#endif
+}
+
+/** @brief          Pass the export buffer to the callback when it is almost full.
+ *  @param p_Buffer Export buffer with TRACE_EXPORT_CHUNK bytes
+ *  @param p_Length Fill level of the buffer
+ *  @param isFlush  true to pass the buffer to the callback in any case
+ *  @param Write    Callback
+ *  @param p_Arg    Argument of the callback
+ *  @return         ESP_OK on success
+ */
+static esp_err_t Trace_Flush(char *p_Buffer, size_t *p_Length, bool isFlush, Trace_Write_t Write, void *p_Arg)
+{
+    esp_err_t Error;
+
+    /* One record needs less than 192 bytes */
+    if (((isFlush == false) && (*p_Length < (TRACE_EXPORT_CHUNK - 192))) || (*p_Length == 0)) {
+        return ESP_OK;
+    }
+
+    Error = Write(p_Buffer, *p_Length, p_Arg);
+    *p_Length = 0;
+
+    return Error;
+}
+
+esp_err_t Trace_Init(void)
+{
+    if (_Trace_State.Ring != NULL) {
+        return ESP_OK;
+    }
+
+    _Trace_State.Mutex = xSemaphoreCreateMutex();
+    if (_Trace_State.Mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex!");
+        return ESP_ERR_NO_MEM;
+    }
+
+    _Trace_State.Ring = reinterpret_cast<Trace_Entry_t *>(heap_caps_calloc(CONFIG_TRACE_RECORDS,
+                                                                           sizeof(Trace_Entry_t),
+                                                                           MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+    if (_Trace_State.Ring == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate trace ring!");
+
+        vSemaphoreDelete(_Trace_State.Mutex);
+        _Trace_State.Mutex = NULL;
+
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGD(TAG, "Trace ring with %u records", CONFIG_TRACE_RECORDS);
+
+    return ESP_OK;
+}
+
+void Trace_Record(Trace_Event_t Event, Trace_Phase_t Phase, uint16_t Arg)
+{
+    Trace_Entry_t *Entry;
+    uint32_t Index;
+
+    if (_Trace_State.Ring == NULL) {
+        return;
+    }
+
+    /* Every caller gets its own slot, the slots are never locked */
+    Index = __atomic_fetch_add(&_Trace_State.Head, 1, __ATOMIC_RELAXED);
+    Entry = &_Trace_State.Ring[Index & (CONFIG_TRACE_RECORDS - 1)];
+
+    __atomic_store_n(&Entry->Sequence, 0, __ATOMIC_RELAXED);
+    Entry->Timestamp = static_cast<uint32_t>(esp_timer_get_time());
+    Entry->Task = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(xTaskGetCurrentTaskHandle()));
+    Entry->Arg = Arg;
+    Entry->Event = static_cast<uint8_t>(Event);
+    Entry->Info = static_cast<uint8_t>((Phase << 1) | (esp_cpu_get_core_id() & 0x01));
+    __atomic_store_n(&Entry->Sequence, Index + 1, __ATOMIC_RELEASE);
+}
+
+esp_err_t Trace_Trigger(void)
+{
+    uint32_t Head;
+    uint32_t First;
+    uint32_t Count;
+
+    if (_Trace_State.Ring == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(_Trace_State.Mutex, portMAX_DELAY);
+
+    if (_Trace_State.Copy == NULL) {
+        _Trace_State.Copy = reinterpret_cast<Trace_Entry_t *>(heap_caps_malloc(CONFIG_TRACE_RECORDS *
+                                                                               sizeof(Trace_Entry_t),
+                                                                               MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+        if (_Trace_State.Copy == NULL) {
+            xSemaphoreGive(_Trace_State.Mutex);
+
+            ESP_LOGE(TAG, "Failed to allocate trace copy!");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    _Trace_State.CopyTime = esp_timer_get_time();
+    Head = __atomic_load_n(&_Trace_State.Head, __ATOMIC_ACQUIRE);
+    First = (Head > CONFIG_TRACE_RECORDS) ? (Head - CONFIG_TRACE_RECORDS) : 0;
+
+    /* Recording continues during the copy. A slot only counts if it still holds the record of the expected
+       index, which skips slots that are written right now or were overwritten by newer records */
+    Count = 0;
+    for (uint32_t Index = First; Index < Head; Index++) {
+        const Trace_Entry_t *Entry = &_Trace_State.Ring[Index & (CONFIG_TRACE_RECORDS - 1)];
+        Trace_Entry_t Record;
+
+        if (__atomic_load_n(&Entry->Sequence, __ATOMIC_ACQUIRE) != (Index + 1)) {
+            continue;
+        }
+
+        memcpy(&Record, Entry, sizeof(Trace_Entry_t));
+
+        if (__atomic_load_n(&Entry->Sequence, __ATOMIC_ACQUIRE) == (Index + 1)) {
+            _Trace_State.Copy[Count++] = Record;
+        }
+    }
+
+    _Trace_State.CopyCount = Count;
+
+    Trace_CollectTasks();
+
+    xSemaphoreGive(_Trace_State.Mutex);
+
+    ESP_LOGI(TAG, "Trace triggered with %lu records", static_cast<unsigned long>(Count));
+
+    return ESP_OK;
+}
+
+uint32_t Trace_GetCount(void)
+{
+    return _Trace_State.CopyCount;
+}
+
+esp_err_t Trace_Export(Trace_Write_t Write, void *p_Arg)
+{
+    char *Buffer;
+    size_t Length;
+    uint32_t Now;
+    esp_err_t Error;
+
+    if ((Write == NULL) || (_Trace_State.Ring == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(_Trace_State.Mutex, portMAX_DELAY);
+
+    if (_Trace_State.Copy == NULL) {
+        xSemaphoreGive(_Trace_State.Mutex);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    Buffer = reinterpret_cast<char *>(malloc(TRACE_EXPORT_CHUNK));
+    if (Buffer == NULL) {
+        xSemaphoreGive(_Trace_State.Mutex);
+        return ESP_ERR_NO_MEM;
+    }
+
+    Length = snprintf(Buffer, TRACE_EXPORT_CHUNK, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":["
+                      "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"PyroVision\"}}");
+
+    Error = ESP_OK;
+    for (uint8_t i = 0; (i < _Trace_State.TaskCount) && (Error == ESP_OK); i++) {
+        Length += snprintf(Buffer + Length, TRACE_EXPORT_CHUNK - Length,
+                           ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}",
+                           static_cast<unsigned long>(_Trace_State.Tasks[i].Handle), _Trace_State.Tasks[i].Name);
+        Error = Trace_Flush(Buffer, &Length, false, Write, p_Arg);
+    }
+
+    /* The records only hold the lower 32 bits of the time, which are extended with the time of the trigger */
+    Now = static_cast<uint32_t>(_Trace_State.CopyTime);
+
+    for (uint32_t i = 0; (i < _Trace_State.CopyCount) && (Error == ESP_OK); i++) {
+        const Trace_Entry_t *Entry = &_Trace_State.Copy[i];
+        uint8_t Phase = Entry->Info >> 1;
+        int64_t Timestamp;
+
+        if ((Entry->Event >= TRACE_EVENT_COUNT) || (Phase >= sizeof(_Trace_Phases))) {
+            continue;
+        }
+
+        Timestamp = _Trace_State.CopyTime - static_cast<uint32_t>(Now - Entry->Timestamp);
+
+        Length += snprintf(Buffer + Length, TRACE_EXPORT_CHUNK - Length,
+                           ",{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lld,\"pid\":1,\"tid\":%lu",
+                           _Trace_EventNames[Entry->Event], _Trace_Phases[Phase], static_cast<long long>(Timestamp),
+                           static_cast<unsigned long>(Entry->Task));
+
+        if ((Phase == TRACE_PHASE_ASYNC_BEGIN) || (Phase == TRACE_PHASE_ASYNC_END)) {
+            /* Asynchronous slices are matched by category and ID */
+            Length += snprintf(Buffer + Length, TRACE_EXPORT_CHUNK - Length, ",\"cat\":\"%s\",\"id\":%u",
+                               _Trace_EventNames[Entry->Event], Entry->Arg);
+        } else if (Phase == TRACE_PHASE_INSTANT) {
+            Length += snprintf(Buffer + Length, TRACE_EXPORT_CHUNK - Length, ",\"s\":\"t\"");
+        }
+
+        if (Phase != TRACE_PHASE_END) {
+            Length += snprintf(Buffer + Length, TRACE_EXPORT_CHUNK - Length, ",\"args\":{\"core\":%u,\"arg\":%u}}",
+                               Entry->Info & 0x01, Entry->Arg);
+        } else {
+            Length += snprintf(Buffer + Length, TRACE_EXPORT_CHUNK - Length, "}");
+        }
+
+        Error = Trace_Flush(Buffer, &Length, false, Write, p_Arg);
+    }
+
+    if (Error == ESP_OK) {
+        Length += snprintf(Buffer + Length, TRACE_EXPORT_CHUNK - Length, "]}");
+        Error = Trace_Flush(Buffer, &Length, true, Write, p_Arg);
+    }
+
+    free(Buffer);
+
+    xSemaphoreGive(_Trace_State.Mutex);
+
+    return Error;
+}
+
+#endif /* CONFIG_TRACE */
@@ -0,0 +1,147 @@
+/*
+ * trace.h
+ *
+ *  Copyright (C) Daniel Kampert, 2026
+ *  Website: www.kampis-elektroecke.de
+ *  File info: Lock-free event trace ring with a Chrome trace export.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <esp_err.h>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <sdkconfig.h>
+
+/** @brief Traced code paths. Every path is shown as a named slice in the trace viewer.
+ */
+typedef enum {
+    TRACE_EVENT_CAPTURE = 0,                    /**< Processing of a VoSPI frame up to its publication. */
+    TRACE_EVENT_CCI,                            /**< CCI command of the CCI worker, the argument is the command. */
+    TRACE_EVENT_SCALE,                          /**< Scaling of the thermal image for the display. */
+    TRACE_EVENT_ENCODE,                         /**< Image encoding, including cache hits. */
+    TRACE_EVENT_WS_SEND,                        /**< Asynchronous WebSocket send, the argument is the client slot. */
+    TRACE_EVENT_SD_WRITE,                       /**< Write to the SD card. */
+    TRACE_EVENT_LVGL_RENDER,                    /**< LVGL timer handler with the rendering. */
+    TRACE_EVENT_LVGL_FLUSH,                     /**< Handover of a rendered area to the display driver. */
+    TRACE_EVENT_COUNT,
+} Trace_Event_t;
+
+/** @brief Phases of a trace record, see the Chrome trace event format.
+ */
+typedef enum {
+    TRACE_PHASE_BEGIN = 0,                      /**< Begin of a slice of the current task. */
+    TRACE_PHASE_END,                            /**< End of a slice of the current task. */
+    TRACE_PHASE_ASYNC_BEGIN,                    /**< Begin of an operation that ends in another task. */
+    TRACE_PHASE_ASYNC_END,                      /**< End of an asynchronous operation with the same argument. */
+    TRACE_PHASE_INSTANT,                        /**< Single point in time. */
+} Trace_Phase_t;
+
+#ifdef CONFIG_TRACE
+
+/** @brief  Allocate the trace ring in the PSRAM and start recording.
+ *  @return ESP_OK on success
+ *          ESP_ERR_NO_MEM if the ring can not be allocated
+ */
+esp_err_t Trace_Init(void);
+
+/** @brief          Record an event. Lock-free and safe to call from every task on both cores, but not from an
+ *                  interrupt. Does nothing before Trace_Init.
+ *  @param Event    Traced code path
+ *  @param Phase    Phase of the record
+ *  @param Arg      Argument of the record, identifies asynchronous operations
+ */
+void Trace_Record(Trace_Event_t Event, Trace_Phase_t Phase, uint16_t Arg);
+
+/** @brief  Copy the current ring into the export buffer. The previous copy is replaced, recording continues.
+ *  @return ESP_OK on success
+ *          ESP_ERR_INVALID_STATE if the trace is not initialized
+ *          ESP_ERR_NO_MEM if the export buffer can not be allocated
+ */
+esp_err_t Trace_Trigger(void);
+
+/** @brief  Get the number of records of the last Trace_Trigger.
+ *  @return Number of records, 0 if there is no copy
+ */
+uint32_t Trace_GetCount(void);
+
+/** @brief          Callback to write a part of the export.
+ *  @param p_Data   Data
+ *  @param Length   Length of the data in bytes
+ *  @param p_Arg    Argument of Trace_Export
+ *  @return         ESP_OK to continue
+ */
+typedef esp_err_t (*Trace_Write_t)(const char *p_Data, size_t Length, void *p_Arg);
+
+/** @brief          Export the copy of the last Trace_Trigger as Chrome trace JSON, which can be opened with
+ *                  ui.perfetto.dev or chrome://tracing.
+ *  @param Write    Callback for the parts of the export
+ *  @param p_Arg    Argument of the callback
+ *  @return         ESP_OK on success
+ *                  ESP_ERR_INVALID_ARG if Write is NULL or the trace is not initialized
+ *                  ESP_ERR_NOT_FOUND if Trace_Trigger was never called
+ *                  Error of the callback
+ */
+esp_err_t Trace_Export(Trace_Write_t Write, void *p_Arg);
+
+#ifdef __cplusplus
+/** @brief Records the begin of a slice when it is created and the end when it goes out of scope.
+ */
+class Trace_Scope_t {
+public:
+    explicit Trace_Scope_t(Trace_Event_t Event, uint16_t Arg = 0) : _Event(Event), _Arg(Arg)
+    {
+        Trace_Record(_Event, TRACE_PHASE_BEGIN, _Arg);
+    }
+
+    ~Trace_Scope_t()
+    {
+        Trace_Record(_Event, TRACE_PHASE_END, _Arg);
+    }
+
+private:
+    Trace_Event_t _Event;
+    uint16_t _Arg;
+};
+#endif
+
+#define TRACE_BEGIN(Event)                  Trace_Record((Event), TRACE_PHASE_BEGIN, 0)
+#define TRACE_BEGIN_ARG(Event, Arg)         Trace_Record((Event), TRACE_PHASE_BEGIN, (Arg))
+#define TRACE_END(Event)                    Trace_Record((Event), TRACE_PHASE_END, 0)
+#define TRACE_ASYNC_BEGIN(Event, ID)        Trace_Record((Event), TRACE_PHASE_ASYNC_BEGIN, (ID))
+#define TRACE_ASYNC_END(Event, ID)          Trace_Record((Event), TRACE_PHASE_ASYNC_END, (ID))
+#define TRACE_INSTANT(Event, Arg)           Trace_Record((Event), TRACE_PHASE_INSTANT, (Arg))
+#define TRACE_SCOPE(Event, Arg)             Trace_Scope_t _Trace_Scope((Event), (Arg))
+
+#else
+
+#define TRACE_BEGIN(Event)
+#define TRACE_BEGIN_ARG(Event, Arg)
+#define TRACE_END(Event)
+#define TRACE_ASYNC_BEGIN(Event, ID)
+#define TRACE_ASYNC_END(Event, ID)
+#define TRACE_INSTANT(Event, Arg)
+#define TRACE_SCOPE(Event, Arg)
+
+#endif /* CONFIG_TRACE */
+
+#endif /* TRACE_H_ */
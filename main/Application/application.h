@@ -27,6 +27,7 @@
 #include <freertos/task.h>
 
 #include "Manager/managers.h"
+#include "Tasks/Lepton/framePool.h"
 
 #include <sdkconfig.h>
 
@@ -35,36 +36,29 @@ ESP_EVENT_DECLARE_BASE(DEVICE_EVENTS);
 ESP_EVENT_DECLARE_BASE(GUI_EVENTS);
 ESP_EVENT_DECLARE_BASE(SD_EVENTS);
 
-/** @brief Lepton camera event identifiers.
+/** @brief Lepton camera event identifiers. The camera results are published on the message bus
+ *         (Application/Bus), see BUS_TOPIC_LEPTON_*.
  */
 enum {
-    LEPTON_EVENT_CAMERA_READY,                  /**< Lepton camera is ready. */
-    LEPTON_EVENT_CAMERA_ERROR,                  /**< Lepton camera error occurred.
-                                                     Data is transmitted in a App_Lepton_Device_t structure. */
-    LEPTON_EVENT_RESPONSE_FPA_AUX_TEMP,         /**< FPA and AUX temperatures are ready.
-                                                     Data is transmitted in a App_Lepton_Temperatures_t structure. */
-    LEPTON_EVENT_RESPONSE_SPOTMETER,            /**< Spotmeter data is ready.
-                                                     Data is transmitted in a App_Lepton_Spotmeter_t structure. */
-    LEPTON_EVENT_RESPONSE_UPTIME,               /**< Uptime data is ready.
-                                                     Data is transmitted as a uint32_t representing uptime in milliseconds. */
-    LEPTON_EVENT_RESPONSE_PIXEL_TEMPERATURE,    /**< Pixel temperature data is ready.
-                                                     Data is transmitted as a float. */
-    LEPTON_EVENT_RESPONSE_SCENE_STATISTICS,     /**< Scene statistics data is ready.
-                                                     Data is transmitted in a App_Lepton_SceneStatistics_t structure. */
+    LEPTON_EVENT_CAMERA_ERROR,                  /**< Lepton camera error occurred. No data. */
+    LEPTON_EVENT_SPOT_ALARM,                    /**< A spot alarm was raised or cleared.
+                                                     Data is transmitted in a SpotTracker_Event_t structure. */
+    LEPTON_EVENT_FFC,                           /**< The camera started or finished a flat field correction.
+                                                     Data is transmitted in a App_Lepton_FFC_t structure. */
 };
 
-/** @brief Device status event identifiers.
+/** @brief Device status event identifiers. The battery reading is published on the message bus, see
+ *         BUS_TOPIC_BATTERY.
  */
 enum {
-    DEVICE_EVENT_RESPONSE_BATTERY_VOLTAGE,      /**< New battery voltage reading available.
-                                                     Data is transmitted in a App_Devices_Battery_t structure. */
     DEVICE_EVENT_RESPONSE_CHARGING,             /**< Charging state changed.
                                                      Data is transmitted as a bool. */
     DEVICE_EVENT_RESPONSE_TIME,                 /**< Device RTC time has been updated.
                                                      Data is transmitted in a struct tm structure. */
 };
 
-/** @brief GUI event identifiers.
+/** @brief GUI event identifiers. The GUI_EVENT_REQUEST_* identifiers are sent to the Lepton task as Bus_Request_t
+ *         on BUS_CHANNEL_LEPTON_REQUEST instead of the event loop.
  */
 enum {
     GUI_EVENT_INIT_DONE,                        /**< GUI task initialization done. */
@@ -74,23 +68,12 @@ enum {
     GUI_EVENT_REQUEST_FPA_AUX_TEMP,             /**< Request update of the FPA and AUX temperature. */
     GUI_EVENT_REQUEST_UPTIME,                   /**< Request update of the uptime. */
     GUI_EVENT_UPDATE_INFO,                      /**< Update the information screen. */
-    GUI_EVENT_REQUEST_PIXEL_TEMPERATURE,        /**< Request update of pixel temperature.
-                                                     Data is transmitted in a App_GUI_Screenposition_t structure. */
     GUI_EVENT_REQUEST_SPOTMETER,                /**< Request update of spotmeter data. */
     GUI_EVENT_REQUEST_SCENE_STATISTICS,         /**< Request update of scene statistics data. */
     GUI_EVENT_REQUEST_EMISSIVITY,               /**< Request update of the emissivity setting.
                                                      Data is transmitted as a uint16_t (Emissivity multiplied by 100). */
 };
 
-/** @brief Structure representing a screen position.
- */
-typedef struct {
-    int16_t x;                                  /**< X coordinate (0 to 159). */
-    int16_t y;                                  /**< Y coordinate (0 to 119). */
-    int32_t Width;                              /**< Width of the screen element where the position is related to. */
-    int32_t Height;                             /**< Height of the screen element where the position is related to. */
-} App_GUI_Screenposition_t;
-
 /** @brief Structure representing battery information.
  */
 typedef struct {
@@ -99,8 +82,10 @@ typedef struct {
 } App_Devices_Battery_t;
 
 /** @brief Structure representing a ready frame from the Lepton camera.
+ *         The receiver owns one reference on Frame and must return it with FramePool_Release when done.
  */
 typedef struct {
+    FramePool_Frame_t *Frame;                   /**< Frame pool slot holding the RAW14, telemetry and RGB data. */
     uint8_t *Buffer;                            /**< Pointer to the image buffer (Width * Height * Channels). */
     uint32_t Width;                             /**< Width of the frame in pixels. */
     uint32_t Height;                            /**< Height of the frame in pixels. */
@@ -134,6 +119,31 @@ typedef struct {
     };
 } App_Lepton_ROI_Result_t;
 
+/** @brief Structure representing a flat field correction of the Lepton camera. The camera repeats its last frame
+ *         while the shutter is closed, the repeated frames are dropped before the frame pool.
+ */
+typedef struct {
+    bool isActive;                              /**< true while the camera repeats its frames. */
+    uint32_t Number;                            /**< Number of the correction since the boot, starting at 1. */
+    uint32_t Sequence;                          /**< Last frame before the correction while it is active, the first
+                                                     frame after it when it finished. */
+    uint32_t Frames;                            /**< Repeated frames of the correction. */
+    uint32_t Duration;                          /**< Time without a new frame in ms. */
+    uint32_t Dropped;                           /**< Repeated frames dropped since the boot. */
+} App_Lepton_FFC_t;
+
+/** @brief Structure representing the health of the VoSPI stream of the Lepton camera.
+ */
+typedef struct {
+    bool isLost;                                /**< true while the stream is interrupted. */
+    uint32_t Frames;                            /**< Frames received from the VoSPI capture. */
+    uint32_t Timeouts;                          /**< Waits of CONFIG_LEPTON_CAPTURE_TIMEOUT without a frame. */
+    uint32_t Resyncs;                           /**< Interruptions that ended with a new frame. */
+    uint32_t SyncTime;                          /**< Capture start to the first frame in ms. */
+    uint32_t LastResync;                        /**< Time without a frame of the last interruption in ms. */
+    uint32_t MaxResync;                         /**< Longest interruption in ms. */
+} App_Lepton_Capture_t;
+
 /** @brief Application context aggregating shared resources.
  */
 typedef struct {
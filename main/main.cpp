@@ -27,36 +27,69 @@
 
 #include "Application/Tasks/tasks.h"
 #include "Application/application.h"
+#include "Application/Boot/boot.h"
+#include "Application/Trace/trace.h"
+#include "Application/Memory/memoryPlan.h"
+#include "Application/Bus/messageBus.h"
+#include "Application/Stripe/stripe.h"
+#include "Application/Topology/topology.h"
+#include "Application/Benchmark/benchmark.h"
 #include "Application/Manager/Time/timeManager.h"
 #include "Application/Manager/Devices/devicesManager.h"
 #include "Application/Manager/SD/sdManager.h"
+#include "Application/Manager/SD/sdRecorder.h"
+#include "Application/Manager/SD/sdTimeLapse.h"
+#include "Application/Manager/Flash/flashLog.h"
 
 static App_Context_t _App_Context;
 
 static const char *TAG = "main";
 
-/** @brief Main application entry point.
- *         Initializes all managers, tasks, and starts the application.
+/** @brief Index of the boot steps in _Main_BootSteps.
  */
-extern "C" void app_main(void)
-{
-    i2c_master_dev_handle_t RtcHandle = NULL;
+enum {
+    MAIN_STEP_SETTINGS = 0,
+    MAIN_STEP_DEVICES,
+    MAIN_STEP_TIME,
+    MAIN_STEP_GUI_INIT,
+    MAIN_STEP_SD,
+    MAIN_STEP_LEPTON_INIT,
+    MAIN_STEP_NETWORK_INIT,
+#ifdef BENCHMARK
+    MAIN_STEP_BENCHMARK,
+#endif
+    MAIN_STEP_LEPTON_START,
+    MAIN_STEP_GUI_START,
+    MAIN_STEP_DEVICES_START,
+    MAIN_STEP_NETWORK_START,
+};
 
-    ESP_ERROR_CHECK(esp_event_loop_create_default());
-
-    _App_Context.Lepton_FrameEventQueue = xQueueCreate(1, sizeof(App_Lepton_FrameReady_t));
-    if (_App_Context.Lepton_FrameEventQueue == NULL) {
-        ESP_LOGE(TAG, "Failed to create frame queue!");
-        return;
-    }
-
-    ESP_ERROR_CHECK(SettingsManager_Init());
+#ifdef BENCHMARK
+/** @brief The tasks of the benchmark firmware start after the benchmark suite.
+ */
+#define MAIN_AFTER_BENCHMARK                BOOT_STEP(MAIN_STEP_BENCHMARK)
+#else
+#define MAIN_AFTER_BENCHMARK                0
+#endif
 
+static void Main_Boot_Settings(void *p_Arg)
+{
     ESP_LOGI(TAG, "Loading settings...");
+    ESP_ERROR_CHECK(SettingsManager_Init());
+}
 
-    ESP_LOGI(TAG, "Initializing application tasks...");
+static void Main_Boot_Devices(void *p_Arg)
+{
     ESP_ERROR_CHECK(DevicesTask_Init());
 
+    /* Any other boot ends a time-lapse schedule */
+    SDTimeLapse_Init();
+}
+
+static void Main_Boot_Time(void *p_Arg)
+{
+    i2c_master_dev_handle_t RtcHandle = NULL;
+
     /* Initialize Time Manager (requires RTC from DevicesManager) */
     if (DevicesManager_GetRTCHandle(&RtcHandle) == ESP_OK) {
         if (TimeManager_Init(RtcHandle) == ESP_OK) {
@@ -70,21 +103,173 @@ extern "C" void app_main(void)
     } else {
         ESP_LOGW(TAG, "RTC not available, Time Manager initialization skipped");
     }
+}
 
-    //SDManager_Init();
+static void Main_Boot_SD(void *p_Arg)
+{
+    /* The device also works without a SD card */
+    if (SDManager_Init() != ESP_OK) {
+        ESP_LOGW(TAG, "SD card not available!");
+    }
+
+    if (SDRecorder_Init(160, 120) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to initialize SD recorder!");
+    }
 
+#ifdef CONFIG_FLASH_LOG
+    /* After the SD card, so the records of a previous session are copied to the card of this boot */
+    if (FlashLog_Init(160, 120) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to initialize flash log!");
+    }
+#endif
+}
+
+static void Main_Boot_GUIInit(void *p_Arg)
+{
     ESP_ERROR_CHECK(GUI_Task_Init());
+}
+
+static void Main_Boot_LeptonInit(void *p_Arg)
+{
     ESP_ERROR_CHECK(Lepton_Task_Init());
-    ESP_ERROR_CHECK(Network_Task_Init(&_App_Context));
-    ESP_LOGI(TAG, " Initialization successful");
+}
+
+static void Main_Boot_NetworkInit(void *p_Arg)
+{
+    ESP_ERROR_CHECK(Network_Task_Init(reinterpret_cast<App_Context_t *>(p_Arg)));
+}
 
-    ESP_LOGI(TAG, "Starting tasks...");
-    ESP_ERROR_CHECK(DevicesTask_Start(&_App_Context));
-    ESP_ERROR_CHECK(GUI_Task_Start(&_App_Context));
-    ESP_ERROR_CHECK(Lepton_Task_Start(&_App_Context));
+static void Main_Boot_LeptonStart(void *p_Arg)
+{
+    ESP_ERROR_CHECK(Lepton_Task_Start(reinterpret_cast<App_Context_t *>(p_Arg)));
+}
+
+static void Main_Boot_GUIStart(void *p_Arg)
+{
+    ESP_ERROR_CHECK(GUI_Task_Start(reinterpret_cast<App_Context_t *>(p_Arg)));
+}
+
+static void Main_Boot_DevicesStart(void *p_Arg)
+{
+    ESP_ERROR_CHECK(DevicesTask_Start(reinterpret_cast<App_Context_t *>(p_Arg)));
+}
+
+static void Main_Boot_NetworkStart(void *p_Arg)
+{
     ESP_ERROR_CHECK(Network_Task_Start());
+}
+
+#ifdef BENCHMARK
+static void Main_Boot_Benchmark(void *p_Arg)
+{
+    /* The firmware also starts when a benchmark can not run */
+    if (Benchmark_Run() != ESP_OK) {
+        ESP_LOGW(TAG, "Benchmark failed!");
+    }
+}
+#endif
+
+/** @brief Boot graph of the application. The Lepton is started as soon as the devices and the GUI event handlers
+ *         are ready, so the VoSPI synchronization overlaps with the SD card and the network. The event handlers
+ *         between the tasks are registered in the init functions, so every start waits for the init of the tasks
+ *         whose events it posts. The SD card shares the SPI bus with the display and is added after it. Every
+ *         task start waits for the settings, which hold the task topology.
+ */
+static const Boot_Step_t _Main_BootSteps[] = {
+    [MAIN_STEP_SETTINGS] = {
+        "Boot_Settings", Main_Boot_Settings, 0, 0, BOOT_PHASE_SETTINGS
+    },
+    [MAIN_STEP_DEVICES] = {
+        "Boot_Devices", Main_Boot_Devices, 0, 1, BOOT_PHASE_DEVICES
+    },
+    [MAIN_STEP_TIME] = {
+        "Boot_Time", Main_Boot_Time, BOOT_STEP(MAIN_STEP_SETTINGS) | BOOT_STEP(MAIN_STEP_DEVICES), 0, BOOT_PHASE_TIME
+    },
+    [MAIN_STEP_GUI_INIT] = {
+        "Boot_GUI", Main_Boot_GUIInit, BOOT_STEP(MAIN_STEP_DEVICES), 0, BOOT_PHASE_GUI
+    },
+    [MAIN_STEP_SD] = {
+        "Boot_SD", Main_Boot_SD, BOOT_STEP(MAIN_STEP_GUI_INIT), 0, BOOT_PHASE_SD
+    },
+    [MAIN_STEP_LEPTON_INIT] = {
+        "Boot_Lepton", Main_Boot_LeptonInit, BOOT_STEP(MAIN_STEP_DEVICES), 1, BOOT_PHASE_LEPTON
+    },
+    [MAIN_STEP_NETWORK_INIT] = {
+        "Boot_Network", Main_Boot_NetworkInit, BOOT_STEP(MAIN_STEP_SETTINGS), 1, BOOT_PHASE_NETWORK
+    },
+#ifdef BENCHMARK
+    /* Runs on the idle system: the tasks, the display refresh and the CCI worker are not started yet */
+    [MAIN_STEP_BENCHMARK] = {
+        "Boot_Benchmark", Main_Boot_Benchmark,
+        BOOT_STEP(MAIN_STEP_TIME) | BOOT_STEP(MAIN_STEP_SD) | BOOT_STEP(MAIN_STEP_LEPTON_INIT) |
+        BOOT_STEP(MAIN_STEP_NETWORK_INIT), 0, -1
+    },
+#endif
+    [MAIN_STEP_LEPTON_START] = {
+        "Boot_LeptonRun", Main_Boot_LeptonStart,
+        BOOT_STEP(MAIN_STEP_LEPTON_INIT) | BOOT_STEP(MAIN_STEP_GUI_INIT) | BOOT_STEP(MAIN_STEP_SETTINGS) |
+        MAIN_AFTER_BENCHMARK, 1, -1
+    },
+    [MAIN_STEP_GUI_START] = {
+        "Boot_GUIRun", Main_Boot_GUIStart,
+        BOOT_STEP(MAIN_STEP_GUI_INIT) | BOOT_STEP(MAIN_STEP_SETTINGS) | MAIN_AFTER_BENCHMARK, 0, -1
+    },
+    [MAIN_STEP_DEVICES_START] = {
+        "Boot_DevicesRun", Main_Boot_DevicesStart,
+        BOOT_STEP(MAIN_STEP_DEVICES) | BOOT_STEP(MAIN_STEP_GUI_INIT) | BOOT_STEP(MAIN_STEP_SETTINGS) |
+        MAIN_AFTER_BENCHMARK, 0, -1
+    },
+    [MAIN_STEP_NETWORK_START] = {
+        "Boot_NetworkRun", Main_Boot_NetworkStart,
+        BOOT_STEP(MAIN_STEP_NETWORK_INIT) | BOOT_STEP(MAIN_STEP_LEPTON_INIT) | BOOT_STEP(MAIN_STEP_GUI_INIT) |
+        MAIN_AFTER_BENCHMARK, 1, -1
+    },
+};
+
+/** @brief Main application entry point.
+ *         Initializes all managers, tasks, and starts the application.
+ */
+extern "C" void app_main(void)
+{
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+
+    /* The channels of the message bus are used by the init functions already */
+    ESP_ERROR_CHECK(Bus_Init());
+
+#ifdef CONFIG_STRIPE
+    /* Without the workers every kernel runs on the core of its caller */
+    if (Stripe_Init() != ESP_OK) {
+        ESP_LOGW(TAG, "Running without stripe executor!");
+    }
+#endif
+
+    _App_Context.Lepton_FrameEventQueue = xQueueCreate(1, sizeof(App_Lepton_FrameReady_t));
+    if (_App_Context.Lepton_FrameEventQueue == NULL) {
+        ESP_LOGE(TAG, "Failed to create frame queue!");
+        return;
+    }
+
+    /* A wake up of a time-lapse schedule only takes the shot and sleeps again. Settings, GUI and network stay off */
+    if (SDTimeLapse_isWakeup()) {
+        SDTimeLapse_Run(&_App_Context);
+    }
+
+#ifdef CONFIG_TRACE
+    /* The trace is only a diagnostic, the application also runs without it */
+    if (Trace_Init() != ESP_OK) {
+        ESP_LOGW(TAG, "Running without event trace!");
+    }
+#endif
+
+    ESP_LOGI(TAG, "Initializing application...");
+    ESP_ERROR_CHECK(Boot_Run(_Main_BootSteps, sizeof(_Main_BootSteps) / sizeof(_Main_BootSteps[0]), &_App_Context));
+    Boot_Mark(BOOT_PHASE_TASKS);
     ESP_LOGI(TAG, " Tasks started");
 
+    /* All long lived buffers are allocated by the init functions */
+    MemoryPlan_Report();
+    Topology_Report();
+
     /* Main task can now be deleted - no need to remove from watchdog as it was never added */
     vTaskDelete(NULL);
-}
\ No newline at end of file
+}
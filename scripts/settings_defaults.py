@@ -0,0 +1,326 @@
+"""
+settings_defaults.py
+
+Copyright (C) Daniel Kampert, 2026
+Website: www.kampis-elektroecke.de
+File info: Converts the default settings JSON into a constant App_Settings_t image in flash.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+
+Usage: python settings_defaults.py <default_settings.json> <output.cpp>
+"""
+
+import json
+import sys
+
+# Sizes of the character arrays and the preset table in settingsTypes.h
+EMISSIVITY_PRESETS = 128
+EMISSIVITY_DESCRIPTION = 32
+WIFI_SSID = 33
+WIFI_PASSWORD = 65
+PROVISIONING_NAME = 32
+SYSTEM_TIMEZONE = 32
+SYSTEM_DEVICENAME = 32
+TASKS_MAX = 16
+
+# JSON names of the tasks, ordered by Topology_Task_t
+TASK_NAMES = [
+    "lepton",
+    "gui",
+    "network",
+    "devices",
+    "ws-broadcast",
+    "ws-encode",
+    "visa",
+    "dns",
+]
+
+# Encoding of the task core in App_Settings_Task_t
+TASK_CORE_ANY = 0xFF
+TASK_CORES = 2
+
+# JSON name and enum of the ROIs, ordered by App_Settings_ROI_Type_t
+ROI_TYPES = [
+    ("spotmeter", "ROI_TYPE_SPOTMETER"),
+    ("scene", "ROI_TYPE_SCENE"),
+    ("agc", "ROI_TYPE_AGC"),
+    ("video-focus", "ROI_TYPE_VIDEO_FOCUS"),
+]
+
+# Used for ROIs that are missing in the JSON (x, y, w, h)
+ROI_DEFAULTS = {
+    "spotmeter": (60, 40, 40, 40),
+    "scene": (0, 0, 160, 120),
+    "agc": (0, 0, 160, 120),
+    "video-focus": (1, 1, 157, 117),
+}
+
+
+class Macro(str):
+    """Name of a default from settingsLoader.h, which is used when the key is missing in the JSON."""
+
+
+def fail(message):
+    sys.stderr.write("settings_defaults.py: error: {}\n".format(message))
+    sys.exit(1)
+
+
+def get(section, keys, default):
+    """Return the value of the first existing key of a section or the default."""
+    for key in keys:
+        if key in section:
+            return section[key]
+
+    return default
+
+
+def c_string(value, size, name):
+    if isinstance(value, Macro):
+        return value
+
+    if not isinstance(value, str):
+        fail("{} must be a string".format(name))
+
+    data = value.encode("utf-8")
+    if len(data) > (size - 1):
+        fail("{} is longer than {} bytes".format(name, size - 1))
+
+    escaped = "".join(chr(c) if (32 <= c < 127) and (chr(c) not in "\"\\?") else "\\{:03o}".format(c) for c in data)
+
+    return "\"{}\"".format(escaped)
+
+
+def c_value(value):
+    if isinstance(value, Macro):
+        return value
+
+    if isinstance(value, bool):
+        return "true" if value else "false"
+
+    return str(value)
+
+
+def integer(value, minimum, maximum, name):
+    if isinstance(value, Macro):
+        return value
+
+    if isinstance(value, bool) or not isinstance(value, int) or (value < minimum) or (value > maximum):
+        fail("{} must be an integer between {} and {}".format(name, minimum, maximum))
+
+    return str(value)
+
+
+def lepton(settings):
+    lines = []
+    section = settings.get("lepton", {})
+
+    rois = {}
+    for roi in section.get("roi", []):
+        rois[roi.get("name")] = roi
+
+    lines.append("    .Lepton = {")
+    lines.append("        .ROI = {")
+    for name, enum in ROI_TYPES:
+        x, y, w, h = ROI_DEFAULTS[name]
+        roi = rois.get(name, {})
+        lines.append("            {{.Type = {}, .x = {}, .y = {}, .w = {}, .h = {}}},".format(
+            enum,
+            integer(roi.get("x", x), 0, 159, "roi x"),
+            integer(roi.get("y", y), 0, 119, "roi y"),
+            integer(roi.get("width", w), 1, 160, "roi width"),
+            integer(roi.get("height", h), 1, 120, "roi height")))
+    lines.append("        },")
+
+    presets = section.get("emissivity", [{"name": "Unknown", "value": 100.0}])
+    if len(presets) > EMISSIVITY_PRESETS:
+        fail("more than {} emissivity presets".format(EMISSIVITY_PRESETS))
+
+    lines.append("        .EmissivityPresets = {")
+    for preset in presets:
+        value = preset.get("value")
+        if isinstance(value, bool) or not isinstance(value, (int, float)):
+            fail("emissivity value of {} must be a number".format(preset.get("name")))
+
+        value = min(max(float(value), 0.0), 100.0)
+        lines.append("            {{.Value = {!r}f, .Description = {}}},".format(
+            value, c_string(preset.get("name", ""), EMISSIVITY_DESCRIPTION, "emissivity name")))
+    lines.append("        },")
+    lines.append("        .EmissivityCount = {},".format(len(presets)))
+    lines.append("    },")
+
+    return lines
+
+
+def wifi(settings):
+    section = settings.get("wifi", {})
+
+    return [
+        "    .WiFi = {",
+        "        .SSID = {},".format(c_string(get(section, ["ssid"], ""), WIFI_SSID, "wifi ssid")),
+        "        .Password = {},".format(c_string(get(section, ["password"], ""), WIFI_PASSWORD, "wifi password")),
+        "        .AutoConnect = {},".format(c_value(get(section, ["autoConnect"],
+                                                        Macro("SETTINGS_WIFI_DEFAULT_AUTOCONNECT")))),
+        "        .MaxRetries = {},".format(integer(get(section, ["maxRetries"],
+                                                       Macro("SETTINGS_WIFI_DEFAULT_MAX_RETRIES")),
+                                                   0, 255, "wifi maxRetries")),
+        "        .RetryInterval = {},".format(integer(get(section, ["retryInterval"],
+                                                          Macro("SETTINGS_WIFI_DEFAULT_RETRY_INTERVAL")),
+                                                      0, 65535, "wifi retryInterval")),
+        "    },",
+    ]
+
+
+def provisioning(settings):
+    section = settings.get("provisioning", {})
+
+    return [
+        "    .Provisioning = {",
+        "        .Name = {},".format(c_string(get(section, ["name"], Macro("SETTINGS_PROVISIONING_DEFAULT_NAME")),
+                                              PROVISIONING_NAME, "provisioning name")),
+        "        .Timeout = {},".format(integer(get(section, ["timeout"],
+                                                    Macro("SETTINGS_PROVISIONING_DEFAULT_TIMEOUT")),
+                                                0, 0xFFFFFFFF, "provisioning timeout")),
+        "    },",
+    ]
+
+
+def display(settings):
+    section = settings.get("display", {})
+
+    return [
+        "    .Display = {",
+        "        .Brightness = {},".format(integer(get(section, ["brightness"],
+                                                       Macro("SETTINGS_DISPLAY_DEFAULT_BRIGHTNESS")),
+                                                   0, 100, "display brightness")),
+        "        .Timeout = {},".format(integer(get(section, ["timeout"], Macro("SETTINGS_DISPLAY_DEFAULT_TIMEOUT")),
+                                                0, 65535, "display timeout")),
+        "    },",
+    ]
+
+
+def http_server(settings):
+    section = settings.get("http-server", {})
+
+    return [
+        "    .HTTPServer = {",
+        "        .Port = {},".format(integer(get(section, ["port"], Macro("SETTINGS_DEFAULT_HTTP_PORT")), 1, 65535,
+                                             "http-server port")),
+        "        .WSPingIntervalSec = {},".format(integer(get(section, ["ws-ping-interval", "wsPingIntervalSec"],
+                                                              Macro("SETTINGS_DEFAULT_WS_PING_INTERVAL")),
+                                                          0, 65535, "http-server ws-ping-interval")),
+        "        .MaxClients = {},".format(integer(get(section, ["max-clients", "maxClients"],
+                                                       Macro("SETTINGS_DEFAULT_HTTP_MAX_CLIENTS")),
+                                                   1, 255, "http-server max-clients")),
+        "    },",
+    ]
+
+
+def visa_server(settings):
+    section = settings.get("visa-server", {})
+
+    return [
+        "    .VISAServer = {",
+        "        .Port = {},".format(integer(get(section, ["port"], Macro("SETTINGS_DEFAULT_VISA_PORT")), 1, 65535,
+                                             "visa-server port")),
+        "    },",
+    ]
+
+
+def system(settings):
+    section = settings.get("system", {})
+
+    # An empty device name is replaced by a name with the MAC address at runtime
+    return [
+        "    .System = {",
+        "        .SDCard_AutoMount = {},".format(c_value(get(section, ["sdcardAutoMount"], True))),
+        "        .Timezone = {},".format(c_string(get(section, ["timezone"], Macro("SETTINGS_SYSTEM_DEFAULT_TIMEZONE")),
+                                                  SYSTEM_TIMEZONE, "system timezone")),
+        "        .DeviceName = {},".format(c_string(get(section, ["devicename"], ""), SYSTEM_DEVICENAME,
+                                                    "system devicename")),
+        "        .Reserved = {},",
+        "    },",
+    ]
+
+
+def tasks(settings):
+    lines = []
+    section = settings.get("tasks", {})
+
+    if len(TASK_NAMES) > TASKS_MAX:
+        fail("more than {} tasks".format(TASKS_MAX))
+
+    for name in section:
+        if name not in TASK_NAMES:
+            fail("unknown task {}".format(name))
+
+    # Every value that is missing or 0 keeps the Kconfig default of the task
+    lines.append("    .Tasks = {")
+    lines.append("        .Task = {")
+    for name in TASK_NAMES:
+        task = section.get(name, {})
+
+        core = task.get("core", None)
+        if core is None:
+            core = 0
+        elif core == "any":
+            core = TASK_CORE_ANY
+        else:
+            core = int(integer(core, 0, TASK_CORES - 1, "{} core".format(name))) + 1
+
+        lines.append("            {{.Core = {}, .Priority = {}, .StackSize = {}}},".format(
+            core,
+            integer(task.get("priority", 0), 0, 24, "{} priority".format(name)),
+            integer(task.get("stack", 0), 0, 65535, "{} stack".format(name))))
+    lines.append("        },")
+    lines.append("    },")
+
+    return lines
+
+
+def main():
+    if len(sys.argv) != 3:
+        fail("usage: settings_defaults.py <default_settings.json> <output.cpp>")
+
+    try:
+        with open(sys.argv[1], "r", encoding="utf-8") as file:
+            settings = json.load(file)
+    except (OSError, ValueError) as e:
+        fail("can not read {}: {}".format(sys.argv[1], e))
+
+    lines = [
+        "/* Generated by scripts/settings_defaults.py from data/default_settings.json. Do not edit. */",
+        "",
+        "#include \"Application/Manager/Settings/Private/settingsLoader.h\"",
+        "",
+        "constexpr App_Settings_t SettingsManager_Defaults = {",
+        "    .Info = {},",
+    ]
+    lines += lepton(settings)
+    lines += wifi(settings)
+    lines += provisioning(settings)
+    lines += display(settings)
+    lines += http_server(settings)
+    lines += visa_server(settings)
+    lines += system(settings)
+    lines += tasks(settings)
+    lines += ["};", ""]
+
+    with open(sys.argv[2], "w", encoding="utf-8") as file:
+        file.write("\n".join(lines))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,174 @@
+"""
+ui_assets.py
+
+Copyright (C) Daniel Kampert, 2026
+Website: www.kampis-elektroecke.de
+File info: Compresses the bitmaps of the fonts and images exported by SquareLine Studio for the lazy decoder of the GUI.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+
+Usage: python ui_assets.py <input.c> <output.c>
+
+The input is a font (lv_font_conv, no compression) or an image (C array) of main/Application/Tasks/GUI/Export. The
+output replaces the bitmap with a zlib stream that guiAssets.cpp inflates into the PSRAM when it is drawn first.
+"""
+
+import os
+import re
+import sys
+import zlib
+
+INCLUDES = [
+    "#include \"Application/Tasks/GUI/Export/ui.h\"",
+    "#include \"Application/Tasks/GUI/Private/guiAssets.h\"",
+]
+
+
+def fail(message):
+    sys.stderr.write("ui_assets.py: error: {}\n".format(message))
+    sys.exit(1)
+
+
+def array(source, pattern):
+    """Return the match of the array definition and its content as bytes."""
+    match = re.search(pattern + r"\s*=\s*\{(?P<body>.*?)\};", source, re.S)
+    if match is None:
+        fail("no array matches {}".format(pattern))
+
+    # The font converter puts the code point of every glyph into a comment
+    body = re.sub(r"/\*.*?\*/", "", match.group("body"), flags=re.S)
+    try:
+        data = bytes(int(value, 0) for value in re.findall(r"0x[0-9A-Fa-f]+|\b\d+\b", body))
+    except ValueError as e:
+        fail("invalid array content: {}".format(e))
+
+    return match, data
+
+
+def replace(source, old, new):
+    """Replace a text that must exist exactly once, so a changed exporter fails the build instead of the decoder."""
+    if source.count(old) != 1:
+        fail("expected exactly one \"{}\"".format(old))
+
+    return source.replace(old, new)
+
+
+def c_array(name, data):
+    lines = ["static const uint8_t {}[] = {{".format(name)]
+    for i in range(0, len(data), 16):
+        lines.append("    " + " ".join("0x{:02x},".format(c) for c in data[i:i + 16]))
+    lines.append("};")
+
+    return "\n".join(lines)
+
+
+def font(name, source):
+    match, data = array(source, r"static LV_ATTRIBUTE_LARGE_CONST const uint8_t glyph_bitmap\[\]")
+    compressed = zlib.compress(data, 9)
+
+    block = "\n".join([
+        "/*Compressed image of the glyphs: {} bytes, {} bytes compressed*/".format(len(data), len(compressed)),
+        c_array("glyph_bitmap_zlib", compressed),
+        "",
+        "static GUI_Assets_Asset_t glyph_bitmap_asset = {",
+        "    .Name = \"{}\",".format(name),
+        "    .Data = glyph_bitmap_zlib,",
+        "    .Length = sizeof(glyph_bitmap_zlib),",
+        "    .Size = {},".format(len(data)),
+        "};",
+    ])
+    source = source[:match.start()] + block + source[match.end():]
+
+    # The bitmap pointer of the descriptor is set by the decoder, so the descriptor moves from flash to RAM
+    source = replace(source, "static const lv_font_fmt_txt_dsc_t font_dsc", "static lv_font_fmt_txt_dsc_t font_dsc")
+    source = replace(source, ".glyph_bitmap = glyph_bitmap,", ".glyph_bitmap = NULL,")
+    source = replace(source, ".get_glyph_bitmap = lv_font_get_bitmap_fmt_txt,",
+                     ".get_glyph_bitmap = GUI_Assets_GetGlyphBitmap,")
+    source = replace(source, ".user_data = NULL,", ".user_data = &glyph_bitmap_asset,")
+
+    return source, len(data), len(compressed)
+
+
+def image(name, source):
+    _, data = array(source, r"uint8_t {}_data\[\]".format(name))
+    compressed = zlib.compress(data, 9)
+
+    header = {}
+    for field in ("w", "h", "cf"):
+        match = re.search(r"\.header\.{}\s*=\s*(\w+)".format(field), source)
+        if match is None:
+            fail("no header.{} in {}".format(field, name))
+        header[field] = match.group(1)
+
+    block = "\n".join([
+        "/* {} bytes, {} bytes compressed */".format(len(data), len(compressed)),
+        c_array("{}_zlib".format(name), compressed),
+        "",
+        "static GUI_Assets_Image_t {}_asset = {{".format(name),
+        "    .Asset = {",
+        "        .Name = \"{}\",".format(name),
+        "        .Data = {}_zlib,".format(name),
+        "        .Length = sizeof({}_zlib),".format(name),
+        "        .Size = {},".format(len(data)),
+        "    },",
+        "};",
+        "",
+        "const lv_image_dsc_t {} = {{".format(name),
+        "    .header.w = {},".format(header["w"]),
+        "    .header.h = {},".format(header["h"]),
+        "    .header.cf = {},".format(header["cf"]),
+        "    .header.flags = GUI_ASSETS_IMAGE_FLAG,",
+        "    .header.magic = LV_IMAGE_HEADER_MAGIC,",
+        "    .data_size = sizeof({}_asset),".format(name),
+        "    .data = (const uint8_t *)&{}_asset,".format(name),
+        "};",
+        "",
+    ])
+
+    return "\n".join(INCLUDES) + "\n\n" + block, len(data), len(compressed)
+
+
+def main():
+    if len(sys.argv) != 3:
+        fail("usage: ui_assets.py <input.c> <output.c>")
+
+    path = sys.argv[1]
+    name = os.path.splitext(os.path.basename(path))[0]
+
+    try:
+        with open(path, "r", encoding="utf-8") as file:
+            source = file.read()
+    except OSError as e:
+        fail("can not read {}: {}".format(path, e))
+
+    if "lv_font_fmt_txt_dsc_t" in source:
+        output, size, length = font(name, source)
+        output = replace(output, "#include \"../ui.h\"", "\n".join(INCLUDES))
+    elif "lv_image_dsc_t" in source:
+        output, size, length = image(name, source)
+    else:
+        fail("{} is neither a font nor an image".format(path))
+
+    output = "/* Generated by scripts/ui_assets.py from {}. Do not edit. */\n\n".format(os.path.basename(path)) + output
+
+    with open(sys.argv[2], "w", encoding="utf-8") as file:
+        file.write(output)
+
+    print("ui_assets.py: {} {} -> {} bytes".format(name, size, length))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,113 @@
+"""
+web_assets.py
+
+Copyright (C) Daniel Kampert, 2026
+Website: www.kampis-elektroecke.de
+File info: Compresses the files of the web interface into a constant gzip asset table in flash.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+Errors and commissions should be reported to DanielKampert@kampis-elektroecke.de
+
+Usage: python web_assets.py <output.cpp> <file> [<file> ...]
+"""
+
+import gzip
+import hashlib
+import os
+import sys
+
+# Content type of the supported file extensions
+TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+}
+
+
+def fail(message):
+    sys.stderr.write("web_assets.py: error: {}\n".format(message))
+    sys.exit(1)
+
+
+def c_identifier(name):
+    return "".join(c if c.isalnum() else "_" for c in name)
+
+
+def asset(path):
+    """Return the URI, the content type, the ETag and the compressed content of a file."""
+    name = os.path.basename(path)
+    extension = os.path.splitext(name)[1].lower()
+    if extension not in TYPES:
+        fail("unsupported file type of {}".format(path))
+
+    try:
+        with open(path, "rb") as file:
+            content = file.read()
+    except OSError as e:
+        fail("can not read {}: {}".format(path, e))
+
+    # A fixed mtime keeps the output, and with it the firmware image, reproducible
+    data = gzip.compress(content, compresslevel=9, mtime=0)
+
+    # The ETag only changes with the content, so an unchanged page stays cached over firmware updates
+    etag = "\"{}\"".format(hashlib.sha1(content).hexdigest()[:16])
+
+    return "/" + name, TYPES[extension], etag, content, data
+
+
+def main():
+    if len(sys.argv) < 3:
+        fail("usage: web_assets.py <output.cpp> <file> [<file> ...]")
+
+    assets = [asset(path) for path in sorted(sys.argv[2:])]
+
+    lines = [
+        "/* Generated by scripts/web_assets.py from the files in webserver/. Do not edit. */",
+        "",
+        "#include \"Application/Manager/Network/Server/WebAssets/webAssets.h\"",
+        "",
+    ]
+
+    for uri, _, _, content, data in assets:
+        lines.append("/* {}: {} bytes, {} bytes compressed */".format(uri, len(content), len(data)))
+        lines.append("static const uint8_t _WebAssets_{}[] = {{".format(c_identifier(uri[1:])))
+        for i in range(0, len(data), 16):
+            lines.append("    " + " ".join("0x{:02x},".format(c) for c in data[i:i + 16]))
+        lines.append("};")
+        lines.append("")
+
+    lines.append("const WebAssets_Asset_t WebAssets_Table[] = {")
+    for uri, content_type, etag, _, _ in assets:
+        identifier = "_WebAssets_{}".format(c_identifier(uri[1:]))
+        lines.append("    {{\"{}\", \"{}\", \"{}\", {}, sizeof({})}},".format(
+            uri, content_type, etag.replace("\"", "\\\""), identifier, identifier))
+    lines.append("};")
+    lines.append("")
+    lines.append("const size_t WebAssets_Count = sizeof(WebAssets_Table) / sizeof(WebAssets_Table[0]);")
+    lines.append("")
+
+    with open(sys.argv[1], "w", encoding="utf-8") as file:
+        file.write("\n".join(lines))
+
+    for uri, _, _, content, data in assets:
+        print("web_assets.py: {} {} -> {} bytes".format(uri, len(content), len(data)))
+
+
+if __name__ == "__main__":
+    main()